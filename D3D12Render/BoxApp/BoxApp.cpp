@@ -1,10 +1,20 @@
 #include "../Common/d3dApp.h"
 #include "../Common/MathHelper.h"
 #include "../Common/UploadBuffer.h"
-#include "DoubleVertexBuffer.h"
+#include "../Common/GeometryPool.h"
+#include "../Common/PipelineCache.h"
+#include "../Common/FrameResource.h"
+#include "../Common/ParallelCommandLists.h"
+#include "../Common/D3D12TimestampQueries.h"
+#include "../Common/D3DFrameGraph.h"
 
 using namespace DirectX;
 
+//并行录制绘制命令的命令列表数量
+const UINT gRecordListCount = 2;
+//每帧最多测量的GPU区间数
+const UINT gGpuZoneCount = 8;
+
 struct ConstantObject
 {
     DirectX::XMFLOAT4X4 mWorldViewProj = MathHelper::Identity4x4();
@@ -18,13 +28,11 @@ struct ConstantObject
 //    DirectX::XMFLOAT4 Color;
 //};
 
-//利用两个顶点缓冲区以及输入槽来输入顶点数据
-struct VPosData
+//利用两个顶点缓冲区以及输入槽来输入顶点数据：
+//顶点仍按交错的结构体编写，由VertexLayout拆分为位置流(输入槽0)与颜色流(输入槽1)
+struct BoxVertex
 {
     DirectX::XMFLOAT3 Pos;
-};
-struct VColorData
-{
     DirectX::XMFLOAT4 Color;
 };
 
@@ -66,11 +74,22 @@ private:
     //创建流水线状态对象PSO
     void BuildPSO();
 
+    //录制绘制列表中[begin, end)的绘制，经由RenderBackend的命令列表接口，D3D12与空后端都可以执行
+    //每个列表都要重新设置全部的渲染状态
+    void RecordScene(IRenderCommandList& list, size_t begin, size_t end,
+        uint64_t rtv, uint64_t dsv, uint64_t cbvTable);
+
 private:
     //相关数据变量以及对象指针变量
 
     //流水线状态PSO
     Microsoft::WRL::ComPtr<ID3D12PipelineState> mPSO = nullptr;
+    //PSO的描述与键，PSO在后台线程中创建，初始化命令提交之后再取回
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC mPSODesc;
+    uint64_t mPSOKey = 0;
+
+    //根签名与PSO的缓存，PSO的驱动缓存保存在PipelineCache目录中
+    std::unique_ptr<PipelineCache> mPipelineCache = nullptr;
 
     //根签名，用于指示各种资源应绑定到哪个输入槽上
     Microsoft::WRL::ComPtr<ID3D12RootSignature> mRootSignature = nullptr;
@@ -82,8 +101,14 @@ private:
 
     //常量缓冲区资源
     std::unique_ptr<UploadBuffer<ConstantObject>> mCBObj = nullptr;
+    //Update计算出的常量(渲染快照)，Draw开始时再写入常量缓冲区；流水线模式下两者同时执行，所以每个阶段使用自己的一份
+    ConstantObject mFrameConstants[FramePipeline::SlotCount];
     //常量缓冲区描述符堆
-    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> mCBViewHeap = nullptr;
+    //Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> mCBViewHeap = nullptr;
+    //描述符先创建在非着色器可见的堆中(持久分配)，每帧拷贝到着色器可见的环形堆中组成描述符表
+    std::unique_ptr<DescriptorHeapAllocator> mCbvSrvUavAllocator = nullptr;
+    std::unique_ptr<FrameDescriptorRing> mFrameDescriptors = nullptr;
+    DescriptorAllocation mCBView;
 
     //还需要相应的顶点缓冲区与索引缓冲区，那么要创建对应的顶点结构体，输入布局描述
     //顶点缓冲区中的数据一般只供GPU读取，要放在默认堆中
@@ -95,12 +120,20 @@ private:
     //一个MeshGeometry中可以容纳多个图形的顶点以及索引数据，单个图形的顶点以及索引数据可以利用相应的偏移量来从MeshGeometry中取得
     //那么，就可以利用基址以及相应偏移量来表示一个个特定的图元，这些基址以及偏移量数据组织在SubMeshGeometry结构体中
 
-    //顶点输入布局
+    //顶点布局(各成员所属的流)，以及由它生成的顶点输入布局
+    VertexLayout mVertexLayout;
     std::vector<D3D12_INPUT_ELEMENT_DESC> mInputLayout;
 
     //待绘制图形数据
     //std::unique_ptr<MeshGeometry> mBoxGeo = nullptr;
-    std::unique_ptr<DVBMeshGeometry> mBoxGeo = nullptr;
+    //所有网格共用的几何池，立方体与四棱锥是其中的两段子分配
+    std::unique_ptr<GeometryPool> mGeometryPool = nullptr;
+    GeometryAllocation mBoxAllocation;
+    GeometryAllocation mPyramidAllocation;
+    SubmeshArray mDrawArgs;
+
+    //每帧需要绘制的子网格，构建几何体时解析好
+    std::vector<SubmeshHandle> mDrawList;
 
     //同样，我们还需要对应的编译好的Shader代码，此代码以ID3DBlob格式存储
 
@@ -121,6 +154,16 @@ private:
     //float mPhi = DirectX::XM_PIDIV4;        //从原点指向视点的向量与xOy平面的法线量的夹角，弧度制
     float mPhi = 0.0f;
 
+    //帧资源，提供主命令列表与各录制线程的命令分配器(每帧都会刷新命令队列，所以只需要一份)
+    std::unique_ptr<FrameResource> mFrameResource = nullptr;
+    //绘制命令切块后在这些列表中并行录制，各块作为任务在mJobSystem中执行
+    std::unique_ptr<ParallelCommandLists> mRecordLists = nullptr;
+    //GPU区间的时间戳测量，结果并入Profiler的时间线
+    std::unique_ptr<D3D12TimestampQueries> mTimestampQueries = nullptr;
+    std::unique_ptr<GpuProfiler> mGpuProfiler = nullptr;
+    //每帧声明的渲染图，拓扑不变时复用上一帧的编译结果(状态转换与执行顺序)
+    D3DFrameGraph mFrameGraph;
+
     //上一帧时鼠标的位置
     POINT mLastMousePos;
     
@@ -133,7 +176,12 @@ BoxApp::BoxApp(HINSTANCE hInst) :D3DApp(hInst)
 
 BoxApp::~BoxApp()
 {
-
+    //几何池的缓冲区先于基类释放，等待两个队列都不再使用它们
+    if (md3dDevice != nullptr)
+    {
+        FlushCommandQueue();
+        mCopyQueue->Flush();
+    }
 }
 
 bool BoxApp::Initialize()
@@ -147,6 +195,20 @@ bool BoxApp::Initialize()
     //重置命令列表，复用相应内存资源
     ThrowIfFailed(mCommandList->Reset(mDirectCmdListAlloc.Get(),nullptr));
 
+    mPipelineCache = std::make_unique<PipelineCache>(md3dDevice.Get(), L"PipelineCache", mJobSystem);
+
+    //Update只写入快照，可以与Draw并行
+    SetPipelinedFrames(true);
+
+    mFrameResource = std::make_unique<FrameResource>(md3dDevice.Get(), 1, 1, gRecordListCount,
+        GpuProfiler::GetTimestampsPerSlot(gGpuZoneCount));
+    mRecordLists = std::make_unique<ParallelCommandLists>(md3dDevice.Get(), mFrameResource->WorkerCmdListAllocators);
+    //只有一份帧资源，所以只有一个slot
+    mTimestampQueries = std::make_unique<D3D12TimestampQueries>(md3dDevice.Get(), mCommandQueue.Get(),
+        GpuProfiler::GetTimestampsPerSlot(gGpuZoneCount), 1);
+    mTimestampQueries->SetReadback(0, mFrameResource->TimestampReadback.Get());
+    mGpuProfiler = std::make_unique<GpuProfiler>(*mTimestampQueries, 1, gGpuZoneCount);
+
     BuildDescriptorHeap();
     BuildConstantBuffer();
     BuildRootSignature();
@@ -158,6 +220,9 @@ bool BoxApp::Initialize()
     ID3D12CommandList* cmdList[] = { mCommandList.Get() };
     mCommandQueue->ExecuteCommandLists(_countof(cmdList), cmdList);
 
+    //GPU执行上传命令的同时等待后台的PSO创建完成
+    mPSO = mPipelineCache->GetGraphicsPipeline(mPSOKey, mPSODesc);
+
     //刷新命令队列
     FlushCommandQueue();
 
@@ -167,12 +232,20 @@ bool BoxApp::Initialize()
 void BoxApp::BuildDescriptorHeap()
 {
     //填写描述结构体，然后直接创建即可
-    D3D12_DESCRIPTOR_HEAP_DESC cbvHeapDesc;
-    cbvHeapDesc.NumDescriptors = 1;
-    cbvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-    cbvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-    cbvHeapDesc.NodeMask = 0;
-    ThrowIfFailed(md3dDevice->CreateDescriptorHeap(&cbvHeapDesc, IID_PPV_ARGS(mCBViewHeap.GetAddressOf())));
+    //D3D12_DESCRIPTOR_HEAP_DESC cbvHeapDesc;
+    //cbvHeapDesc.NumDescriptors = 1;
+    //cbvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    //cbvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    //cbvHeapDesc.NodeMask = 0;
+    //ThrowIfFailed(md3dDevice->CreateDescriptorHeap(&cbvHeapDesc, IID_PPV_ARGS(mCBViewHeap.GetAddressOf())));
+
+    //现在由分配器管理，之后加入的纹理、材质等描述符也从这里分配
+    mCbvSrvUavAllocator = std::make_unique<DescriptorHeapAllocator>(md3dDevice.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 256);
+    mFrameDescriptors = std::make_unique<FrameDescriptorRing>(md3dDevice.Get(), 1024);
+    if (!mCbvSrvUavAllocator->Allocate(1, mCBView))
+    {
+        ThrowIfFailed(E_OUTOFMEMORY);
+    }
 }
 
 void BoxApp::BuildConstantBuffer()
@@ -194,7 +267,7 @@ void BoxApp::BuildConstantBuffer()
     cbvDesc.BufferLocation = ConstantBufferAddress;
     cbvDesc.SizeInBytes = cbvobjSizeInBytes;
     //创建对应描述符
-    md3dDevice->CreateConstantBufferView(&cbvDesc, mCBViewHeap->GetCPUDescriptorHandleForHeapStart());
+    md3dDevice->CreateConstantBufferView(&cbvDesc, mCBView.Cpu());
 }
 
 void BoxApp::BuildRootSignature()
@@ -225,19 +298,8 @@ void BoxApp::BuildRootSignature()
     //CD3DX12_ROOT_SIGNATURE_DESC rootSignature(2, slotRootParameter, 0, nullptr, D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
 
     //根签名描述完毕，但是要真正创建，需要将其序列化，序列化的数据以ID3DBlob来表示
-    Microsoft::WRL::ComPtr<ID3DBlob> SerializedRootSig = nullptr;
-    Microsoft::WRL::ComPtr<ID3DBlob> ErrBlob = nullptr;
-    //序列化
-    HRESULT hr = D3D12SerializeRootSignature(&rootSignature, D3D_ROOT_SIGNATURE_VERSION_1, SerializedRootSig.GetAddressOf(), ErrBlob.GetAddressOf());
-    //当出现异常，输出异常信息
-    if (ErrBlob != nullptr)
-    {
-        OutputDebugStringA((char*)ErrBlob->GetBufferPointer());
-    }
-    ThrowIfFailed(hr);
-
-    //创建根签名
-    ThrowIfFailed(md3dDevice->CreateRootSignature(0, SerializedRootSig->GetBufferPointer(), SerializedRootSig->GetBufferSize(), IID_PPV_ARGS(&mRootSignature)));
+    //序列化与创建由PipelineCache完成，内容相同的根签名只会创建一次
+    mRootSignature = mPipelineCache->GetRootSignature(rootSignature);
 }
 
 void BoxApp::BuildShadersAndInputLayout()
@@ -252,8 +314,18 @@ void BoxApp::BuildShadersAndInputLayout()
     //mPSByteCode = d3dUtil::LoadBinary(L"e:\\D3D12Render\\D3D12Render\\Shader\\BoxApp\\PS.cso");
 
     //相对路径写法
-    mVSByteCode = d3dUtil::LoadBinary(L"Shader\\BoxApp\\VS.cso");
-    mPSByteCode = d3dUtil::LoadBinary(L"Shader\\BoxApp\\PS.cso");
+    //mVSByteCode = d3dUtil::LoadBinary(L"Shader\\BoxApp\\VS.cso");
+    //mPSByteCode = d3dUtil::LoadBinary(L"Shader\\BoxApp\\PS.cso");
+
+    //运行时编译并缓存Shader，源文件未修改时直接读取ShaderCache目录中的字节码
+    //VS与PS作为一批提交，在后台线程中并行编译
+    auto shaders = d3dUtil::CompileShaderBatch(
+    {
+        d3dUtil::MakeShaderDesc(L"Shader\\BoxApp\\VS.hlsl", nullptr, "VS", "vs_5_0"),
+        d3dUtil::MakeShaderDesc(L"Shader\\BoxApp\\PS.hlsl", nullptr, "PS", "ps_5_0")
+    });
+    mVSByteCode = d3dUtil::ToBlob(shaders[0].get());
+    mPSByteCode = d3dUtil::ToBlob(shaders[1].get());
 
     //运行时编译Shader
     //mVSByteCode = d3dUtil::CompileShader(L"e:\\D3D12Render\\D3D12Render\\Shader\\BoxApp\\VS.hlsl", nullptr, "VS", "vs_5_0");
@@ -267,11 +339,18 @@ void BoxApp::BuildShadersAndInputLayout()
     //};
 
     //使用两个顶点缓冲区及输入槽时，输入布局描述需要修改
-    mInputLayout =
-    {
-        {"POSITION",0,DXGI_FORMAT_R32G32B32_FLOAT,0,0,D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,0},
-        {"COLOR",0,DXGI_FORMAT_R32G32B32A32_FLOAT,1,0,D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,0}
-    };
+    //mInputLayout =
+    //{
+    //    {"POSITION",0,DXGI_FORMAT_R32G32B32_FLOAT,0,0,D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,0},
+    //    {"COLOR",0,DXGI_FORMAT_R32G32B32A32_FLOAT,1,0,D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA,0}
+    //};
+
+    //现在由顶点布局生成，格式与偏移由成员类型推导，POSITION在输入槽0，COLOR在输入槽1
+    mVertexLayout = VertexLayout::For<BoxVertex>()
+        .Add(&BoxVertex::Pos, "POSITION", 0)
+        .Add(&BoxVertex::Color, "COLOR", 1)
+        .Build();
+    mInputLayout = d3dUtil::MakeInputLayout(mVertexLayout);
 }
 
 void BoxApp::BuildMeshGeometry()
@@ -293,38 +372,21 @@ void BoxApp::BuildMeshGeometry()
             *7------*6
     */
 
-    std::array<VPosData, 13> posVertices =
-    {
-        VPosData({DirectX::XMFLOAT3(-1.0f,-1.0f,+1.0f)}),
-        VPosData({DirectX::XMFLOAT3(+1.0f,-1.0f,+1.0f)}),
-        VPosData({DirectX::XMFLOAT3(+1.0f,+1.0f,+1.0f)}),
-        VPosData({DirectX::XMFLOAT3(-1.0f,+1.0f,+1.0f)}),
-        VPosData({DirectX::XMFLOAT3(-1.0f,-1.0f,-1.0f)}),
-        VPosData({DirectX::XMFLOAT3(+1.0f,-1.0f,-1.0f)}),
-        VPosData({DirectX::XMFLOAT3(+1.0f,+1.0f,-1.0f)}),
-        VPosData({DirectX::XMFLOAT3(-1.0f,+1.0f,-1.0f)}),
-        VPosData({DirectX::XMFLOAT3(0.0f,0.0f,3.1f)}),
-        VPosData({DirectX::XMFLOAT3(-1.0f,-1.0f,1.1f)}),
-        VPosData({DirectX::XMFLOAT3(+1.0f,-1.0f,1.1f)}),
-        VPosData({DirectX::XMFLOAT3(+1.0f,+1.0f,1.1f)}),
-        VPosData({DirectX::XMFLOAT3(-1.0f,+1.0f,1.1f)})
-    };
-
-    std::array<VColorData, 13> colorVertices =
+    std::array<BoxVertex, 13> vertices =
     {
-        VColorData({DirectX::XMFLOAT4(DirectX::Colors::Black)}),
-        VColorData({DirectX::XMFLOAT4(DirectX::Colors::White)}),
-        VColorData({DirectX::XMFLOAT4(DirectX::Colors::Red)}),
-        VColorData({DirectX::XMFLOAT4(DirectX::Colors::Green)}),
-        VColorData({DirectX::XMFLOAT4(DirectX::Colors::Blue)}),
-        VColorData({DirectX::XMFLOAT4(DirectX::Colors::Yellow)}),
-        VColorData({DirectX::XMFLOAT4(DirectX::Colors::Cyan)}),
-        VColorData({DirectX::XMFLOAT4(DirectX::Colors::Magenta)}),
-        VColorData({DirectX::XMFLOAT4(DirectX::Colors::Red)}),
-        VColorData({DirectX::XMFLOAT4(DirectX::Colors::Green)}),
-        VColorData({DirectX::XMFLOAT4(DirectX::Colors::Green)}),
-        VColorData({DirectX::XMFLOAT4(DirectX::Colors::Green)}),
-        VColorData({DirectX::XMFLOAT4(DirectX::Colors::Green)})
+        BoxVertex({DirectX::XMFLOAT3(-1.0f,-1.0f,+1.0f),DirectX::XMFLOAT4(DirectX::Colors::Black)}),
+        BoxVertex({DirectX::XMFLOAT3(+1.0f,-1.0f,+1.0f),DirectX::XMFLOAT4(DirectX::Colors::White)}),
+        BoxVertex({DirectX::XMFLOAT3(+1.0f,+1.0f,+1.0f),DirectX::XMFLOAT4(DirectX::Colors::Red)}),
+        BoxVertex({DirectX::XMFLOAT3(-1.0f,+1.0f,+1.0f),DirectX::XMFLOAT4(DirectX::Colors::Green)}),
+        BoxVertex({DirectX::XMFLOAT3(-1.0f,-1.0f,-1.0f),DirectX::XMFLOAT4(DirectX::Colors::Blue)}),
+        BoxVertex({DirectX::XMFLOAT3(+1.0f,-1.0f,-1.0f),DirectX::XMFLOAT4(DirectX::Colors::Yellow)}),
+        BoxVertex({DirectX::XMFLOAT3(+1.0f,+1.0f,-1.0f),DirectX::XMFLOAT4(DirectX::Colors::Cyan)}),
+        BoxVertex({DirectX::XMFLOAT3(-1.0f,+1.0f,-1.0f),DirectX::XMFLOAT4(DirectX::Colors::Magenta)}),
+        BoxVertex({DirectX::XMFLOAT3(0.0f,0.0f,3.1f),DirectX::XMFLOAT4(DirectX::Colors::Red)}),
+        BoxVertex({DirectX::XMFLOAT3(-1.0f,-1.0f,1.1f),DirectX::XMFLOAT4(DirectX::Colors::Green)}),
+        BoxVertex({DirectX::XMFLOAT3(+1.0f,-1.0f,1.1f),DirectX::XMFLOAT4(DirectX::Colors::Green)}),
+        BoxVertex({DirectX::XMFLOAT3(+1.0f,+1.0f,1.1f),DirectX::XMFLOAT4(DirectX::Colors::Green)}),
+        BoxVertex({DirectX::XMFLOAT3(-1.0f,+1.0f,1.1f),DirectX::XMFLOAT4(DirectX::Colors::Green)})
     };
 
 
@@ -370,70 +432,63 @@ void BoxApp::BuildMeshGeometry()
         1,3,2
     };
 
-    //计算资源大小
-    const UINT vbpByteSize = (UINT)posVertices.size() * sizeof(VPosData);
-    const UINT vbcByteSize = (UINT)colorVertices.size() * sizeof(VColorData);
-    const UINT ibByteSize = (UINT)indices.size() * sizeof(std::uint16_t);
+    //计算资源大小(现在由几何池按顶点数与索引数分配)
     //const UINT vbByteSize = (UINT)vertices.size() * sizeof(Vertex);
     //const UINT ibByteSize = (UINT)indices.size() * sizeof(std::uint16_t);
 
-    //创建资源存储对象
-    mBoxGeo = std::make_unique<DVBMeshGeometry>();
-    //mBoxGeo = std::make_unique<MeshGeometry>();
-    mBoxGeo->Name = "BoxGeo";
-
-    //创建内存块并将数据复制到对应内存块
-    ThrowIfFailed(D3DCreateBlob(vbpByteSize, &mBoxGeo->VertexPosBufferCPU));
-    ThrowIfFailed(D3DCreateBlob(vbcByteSize, &mBoxGeo->VertexColorBufferCPU));
-    ThrowIfFailed(D3DCreateBlob(ibByteSize, &mBoxGeo->IndexBufferCPU));
-    CopyMemory(mBoxGeo->VertexPosBufferCPU->GetBufferPointer(), posVertices.data(), vbpByteSize);
-    CopyMemory(mBoxGeo->VertexColorBufferCPU->GetBufferPointer(), colorVertices.data(), vbcByteSize);
-    CopyMemory(mBoxGeo->IndexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize);
-    //ThrowIfFailed(D3DCreateBlob(vbByteSize, &mBoxGeo->VertexBufferCPU));
-    //ThrowIfFailed(D3DCreateBlob(ibByteSize, &mBoxGeo->IndexBufferCPU));
-    //CopyMemory(mBoxGeo->VertexBufferCPU->GetBufferPointer(), vertices.data(), vbByteSize);
-    //CopyMemory(mBoxGeo->IndexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize);
-    
+    //按顶点布局把交错的顶点拆分为位置流与颜色流
+    std::vector<std::vector<uint8_t>> streams;
+    mVertexLayout.Split(vertices.data(), vertices.size(), streams);
 
-    //创建对应的GPU资源，用到了d3dUtil::CreateDefaultBuffer方法
-    mBoxGeo->VertexPosBufferGPU = d3dUtil::CreateDefaultBuffer(
-        md3dDevice.Get(), mCommandList.Get(), mBoxGeo->VertexPosBufferCPU->GetBufferPointer(), vbpByteSize, mBoxGeo->VertexPosBufferUploader);
-    mBoxGeo->VertexColorBufferGPU = d3dUtil::CreateDefaultBuffer(
-        md3dDevice.Get(), mCommandList.Get(), mBoxGeo->VertexColorBufferCPU->GetBufferPointer(), vbcByteSize, mBoxGeo->VertexColorBufferUploader);
-    mBoxGeo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(
-        md3dDevice.Get(), mCommandList.Get(), mBoxGeo->IndexBufferCPU->GetBufferPointer(), ibByteSize, mBoxGeo->IndexBufferUploader);
+    //创建对应的GPU资源，之前用d3dUtil::CreateDefaultBuffer逐个创建(每个缓冲区各需一个默认堆与一个上传堆资源)
     //mBoxGeo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(
     //    md3dDevice.Get(), mCommandList.Get(), mBoxGeo->VertexBufferCPU->GetBufferPointer(), vbByteSize, mBoxGeo->VertexBufferUploader);
     //mBoxGeo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(
     //    md3dDevice.Get(), mCommandList.Get(), mBoxGeo->IndexBufferCPU->GetBufferPointer(), ibByteSize, mBoxGeo->IndexBufferUploader);
 
-    mBoxGeo->VertexPosByteStride = sizeof(VPosData);
-    mBoxGeo->VertexPosBufferByteSize = vbpByteSize;
-    mBoxGeo->VertexColorByteStride = sizeof(VColorData);
-    mBoxGeo->VertexColorBufferByteSize = vbcByteSize;
-    mBoxGeo->IndexBufferByteSize = ibByteSize;
-    mBoxGeo->IndexFormat = DXGI_FORMAT_R16_UINT;
+    //现在每个网格是几何池中的一段子分配，所有网格共用每个流一个顶点缓冲区与一个索引缓冲区
+    std::vector<UINT> strides;
+    for (UINT stream = 0; stream < mVertexLayout.GetStreamCount(); ++stream)
+    {
+        strides.push_back(mVertexLayout.GetStreamStride(stream));
+    }
+    mGeometryPool = std::make_unique<GeometryPool>(md3dDevice.Get(), mStateTracker, strides, 1024, 4096);
+
+    //立方体为前8个顶点与前36个索引，四棱锥为后5个顶点与后18个索引(索引相对于各自的第一个顶点)
+    const UINT boxVertexCount = 8;
+    const UINT boxIndexCount = 36;
+    if (!mGeometryPool->Allocate(boxVertexCount, boxIndexCount, mBoxAllocation) ||
+        !mGeometryPool->Allocate((UINT)vertices.size() - boxVertexCount, (UINT)indices.size() - boxIndexCount, mPyramidAllocation))
+    {
+        ThrowIfFailed(E_OUTOFMEMORY);
+    }
+
+    std::vector<const void*> boxStreams;
+    std::vector<const void*> pyramidStreams;
+    for (UINT stream = 0; stream < mVertexLayout.GetStreamCount(); ++stream)
+    {
+        const uint8_t* data = streams[stream].data();
+        boxStreams.push_back(data);
+        pyramidStreams.push_back(data + boxVertexCount * strides[stream]);
+    }
+    mGeometryPool->Write(mBoxAllocation, boxStreams.data(), indices.data());
+    mGeometryPool->Write(mPyramidAllocation, pyramidStreams.data(), indices.data() + boxIndexCount);
 
-    //mBoxGeo->VertexByteStride = sizeof(Vertex);
-    //mBoxGeo->VertexBufferByteSize = vbByteSize;
-    //mBoxGeo->IndexBufferByteSize = ibByteSize;
-    //mBoxGeo->IndexFormat = DXGI_FORMAT_R16_UINT;
+    //复制命令在COPY队列上执行，不占用graphics队列；第一次绘制时graphics队列才等待复制完成
+    //上传缓冲区由复制队列在fence到达后释放
+    mGeometryPool->Upload(*mCopyQueue);
 
     //次表面索引
-    SubmeshGeometry submesh;
     //submesh.IndexCount = (UINT)indices.size();
-    submesh.IndexCount = 36;
-    submesh.BaseVertexLocation = 0;
-    submesh.StartIndexLocation = 0;
-
-    mBoxGeo->DrawArgs["Box"] = submesh;
+    mDrawArgs.Add("Box", GeometryPool::MakeSubmesh(mBoxAllocation, 0, boxIndexCount));
 
     //习题4，绘制四棱锥
-    SubmeshGeometry PyramidMesh;
-    PyramidMesh.IndexCount = 18;
-    PyramidMesh.BaseVertexLocation = 8;
-    PyramidMesh.StartIndexLocation = 36;
-    mBoxGeo->DrawArgs["Pyramid"] = PyramidMesh;
+    mDrawArgs.Add("Pyramid", GeometryPool::MakeSubmesh(mPyramidAllocation, 0, (UINT)indices.size() - boxIndexCount));
+
+    //名字只在这里解析一次，绘制时直接遍历句柄数组(习题7,立方体与四棱锥同时绘制出来)
+    mDrawList.clear();
+    mDrawList.push_back(mDrawArgs.Find("Box"));
+    mDrawList.push_back(mDrawArgs.Find("Pyramid"));
 }
 
 void BoxApp::BuildPSO()
@@ -480,7 +535,10 @@ void BoxApp::BuildPSO()
     PSODesc.DSVFormat = mDepthStencilFormat;
 
     //创建PSO
-    ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&PSODesc, IID_PPV_ARGS(&mPSO)));
+    //ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&PSODesc, IID_PPV_ARGS(&mPSO)));
+    //提交到后台线程创建，与网格数据的上传重叠；描述引用的数据都是成员变量，取回PSO时仍然有效
+    mPSODesc = PSODesc;
+    mPSOKey = mPipelineCache->Precompile(PSODesc);
 }
 
 void BoxApp::OnResize()
@@ -512,12 +570,12 @@ void BoxApp::Update(const GameTimer& gt)
     DirectX::XMMATRIX P = DirectX::XMLoadFloat4x4(&mProj);
     DirectX::XMMATRIX WorldViewProj = W * V * P;
 
-    //更新到常量缓冲区
-    ConstantObject constObj;
+    //更新到本帧的快照中，Draw时再写入常量缓冲区(GPU可能还在读取上一帧的常量)
+    ConstantObject& constObj = mFrameConstants[UpdateSlot()];
     constObj.gTime = gt.TotalTime();
     DirectX::XMStoreFloat4x4(&constObj.mWorldViewProj, XMMatrixTranspose(WorldViewProj)); //矩阵要转置！天坑！
 
-    mCBObj->CopyData(0, constObj);
+    //mCBObj->CopyData(0, constObj);
 }
 
 void BoxApp::Draw(const GameTimer& gt)
@@ -527,48 +585,63 @@ void BoxApp::Draw(const GameTimer& gt)
 
     //先要做好各种渲染准备
 
+    //上一帧的命令已经执行完毕(Draw结尾刷新了命令队列)，可以写入本帧的常量
+    mCBObj->CopyData(0, mFrameConstants[DrawSlot()]);
+
     //重置命令分配器
-    ThrowIfFailed(mDirectCmdListAlloc->Reset());
+    //ThrowIfFailed(mDirectCmdListAlloc->Reset());
+    ThrowIfFailed(mFrameResource->CmdListAllocator->Reset());
     //重置命令列表,将命令列表绑定到对应的PSO上
-    ThrowIfFailed(mCommandList->Reset(mDirectCmdListAlloc.Get(), mPSO.Get()));
-    //设置视口与裁剪矩形
-    mCommandList->RSSetViewports(1, &mScreenViewport);
-    mCommandList->RSSetScissorRects(1, &mScissorRect);
-    //修改后台缓冲区的状态，从呈现修改为渲染目标状态
-    mCommandList->ResourceBarrier(1, 
-        &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET));
-    //清除后台缓冲与深度缓冲
-    mCommandList->ClearRenderTargetView(CurrentBackBufferView(), DirectX::Colors::LightSteelBlue, 0, nullptr);
-    mCommandList->ClearDepthStencilView(DepthStencilView(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
-    //设置渲染目标
-    mCommandList->OMSetRenderTargets(1, &CurrentBackBufferView(), true, &DepthStencilView());
-    //设置常量缓冲区描述符堆
-    ID3D12DescriptorHeap* descriptorHeaps[] = { mCBViewHeap.Get() };
-    mCommandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
-    //设置根签名
-    mCommandList->SetGraphicsRootSignature(mRootSignature.Get());
-    //设置顶点缓冲区
-    mCommandList->IASetVertexBuffers(0, 1, &mBoxGeo->GetVertexPosBufferView());
-    mCommandList->IASetVertexBuffers(1, 1, &mBoxGeo->GetVertexColorBufferView());
-    //mCommandList->IASetVertexBuffers(0, 1, &mBoxGeo->VertexBufferView());
-    //设置索引缓冲区
-    mCommandList->IASetIndexBuffer(&mBoxGeo->GetIndexBufferView());
-    //mCommandList->IASetIndexBuffer(&mBoxGeo->IndexBufferView());
-    //设置图元拓扑
-    mCommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    //mCommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_POINTLIST);
-    //设置描述符表
-    mCommandList->SetGraphicsRootDescriptorTable(0, mCBViewHeap->GetGPUDescriptorHandleForHeapStart());
+    ThrowIfFailed(mCommandList->Reset(mFrameResource->CmdListAllocator.Get(), mPSO.Get()));
+    //上一帧的GPU时间戳已经可以读取(Draw结尾刷新了命令队列)，之后开始记录本帧
+    mTimestampQueries->SetCommandList(mCommandList.Get());
+    mGpuProfiler->BeginFrame(0);
+    //把本帧用到的描述符拷贝到着色器可见的环形堆中，所有表的拷贝一次完成(在录制线程开始之前完成)
+    DescriptorAllocation cbvTable = mFrameDescriptors->StageTable(&mCBView.CpuHandle, 1);
+    mFrameDescriptors->FlushCopies();
+    mRecordLists->Reset(mFrameResource->WorkerCmdListAllocators, mPSO.Get());
+
+    //声明本帧的渲染图：pass声明读写的资源，状态转换由渲染图在pass之前插入
+    //导入资源的初始状态取自mStateTracker，图中对它们的转换也经由mStateTracker产生(后台缓冲区在图结束时转换回呈现状态)
+    const D3D12_CPU_DESCRIPTOR_HANDLE rtv = CurrentBackBufferView();
+    const D3D12_CPU_DESCRIPTOR_HANDLE dsv = DepthStencilView();
+    mFrameGraph.Reset();
+    const uint32_t backBuffer = mFrameGraph.ImportResource("BackBuffer", CurrentBackBuffer(),
+        mStateTracker.GetState(CurrentBackBuffer()), D3D12_RESOURCE_STATE_PRESENT);
+    const uint32_t depthStencil = mFrameGraph.ImportResource("DepthStencil", mDepthStencilBuffer.Get(),
+        mStateTracker.GetState(mDepthStencilBuffer.Get()), mStateTracker.GetState(mDepthStencilBuffer.Get()));
 
-    //多传入一个常量参数
-    //mCommandList->SetGraphicsRoot32BitConstant(1, gt.TotalTime(), 0);
-
-    //绘制
-    mCommandList->DrawIndexedInstanced(mBoxGeo->DrawArgs["Box"].IndexCount, 1, 0, 0, 0);
-    //习题4，绘制四棱锥
-    mCommandList->DrawIndexedInstanced(
-        mBoxGeo->DrawArgs["Pyramid"].IndexCount, 1, mBoxGeo->DrawArgs["Pyramid"].StartIndexLocation, mBoxGeo->DrawArgs["Pyramid"].BaseVertexLocation, 0);
-    //习题7,立方体与四棱锥同时绘制出来
+    //清除后台缓冲与深度缓冲
+    mFrameGraph.AddPass("Clear",
+        { { backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET, true }, { depthStencil, D3D12_RESOURCE_STATE_DEPTH_WRITE, true } },
+        [&](D3DFrameGraphContext& context)
+    {
+        mGpuProfiler->BeginZone("Clear");
+        D3D12RenderCommandList list(context.CmdList);
+        list.ClearRenderTargetView(rtv.ptr, DirectX::Colors::LightSteelBlue);
+        list.ClearDepthStencilView(dsv.ptr, D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0);
+        mGpuProfiler->EndZone();
+    });
+
+    //绘制命令切块并行录制到mRecordLists，每个列表都要重新设置全部的渲染状态
+    //绘制区间从主列表末尾开始，到最后一个录制列表末尾结束(同一次提交中按顺序执行)
+    mFrameGraph.AddPass("Scene",
+        { { backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET, true }, { depthStencil, D3D12_RESOURCE_STATE_DEPTH_WRITE, true } },
+        [&](D3DFrameGraphContext&)
+    {
+        mGpuProfiler->BeginZone("Draw");
+        mRecordLists->Record(mJobSystem, mDrawList.size(),
+            [&](ID3D12GraphicsCommandList* cmdList, size_t, size_t begin, size_t end)
+        {
+            D3D12RenderCommandList list(cmdList);
+            RecordScene(list, begin, end, rtv.ptr, dsv.ptr, cbvTable.Gpu().ptr);
+        });
+    });
+
+    mFrameGraph.Compile();
+    D3DFrameGraphContext mainContext(mCommandList.Get(), &mStateTracker);
+    mFrameGraph.Execute(mainContext);
+    ThrowIfFailed(mCommandList->Close());
 
     //习题3，绘制各种
     //点列表
@@ -582,20 +655,72 @@ void BoxApp::Draw(const GameTimer& gt)
     //mCommandList->DrawInstanced(8, 1, 0, 0);
 
 
-    //转换资源状态为呈现状态
-    mCommandList->ResourceBarrier(1, 
-        &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT));
+    //转换资源状态为呈现状态，记录在最后一个列表的末尾
+    ID3D12GraphicsCommandList* lastList = mRecordLists->GetList(mRecordLists->GetListCount() - 1);
+    mTimestampQueries->SetCommandList(lastList);
+    mGpuProfiler->EndZone();
+    D3DFrameGraphContext lastContext(lastList, &mStateTracker);
+    mFrameGraph.RecordFinalTransitions(lastContext);
+    mGpuProfiler->EndFrame();
     //绘制命令记录完毕，关闭
-    ThrowIfFailed(mCommandList->Close());
-    //向命令队列提交命令
-    ID3D12CommandList* cmdLists[] = { mCommandList.Get() };
-    mCommandQueue->ExecuteCommandLists(_countof(cmdLists), cmdLists);
+    mRecordLists->Close();
+    //几何池第一次被使用时，graphics队列在GPU端等待复制队列完成上传；之后的帧不再等待
+    mGeometryPool->WaitForUse(*mCopyQueue, mCommandQueue.Get());
+
+    //向命令队列提交命令，主列表在前，各块按顺序在后，一次提交
+    std::vector<ID3D12CommandList*> cmdLists = { mCommandList.Get() };
+    mRecordLists->AppendTo(cmdLists);
+    mCommandQueue->ExecuteCommandLists((UINT)cmdLists.size(), cmdLists.data());
 
     //交换前后台缓冲区
     ThrowIfFailed(mdxgiSwapChain->Present(0, 0));
     mCurrentBackBuffer = (mCurrentBackBuffer + 1) % SwapChainBufferCount;
 
     FlushCommandQueue();
+
+    //本帧的描述符表在mCurrentFence到达后回收
+    mFrameDescriptors->FinishFrame(mCurrentFence);
+    mFrameDescriptors->Reclaim(md3dFence->GetCompletedValue());
+}
+
+void BoxApp::RecordScene(IRenderCommandList& list, size_t begin, size_t end,
+    uint64_t rtv, uint64_t dsv, uint64_t cbvTable)
+{
+    PROFILE_SCOPE("RecordChunk");
+    //设置视口与裁剪矩形(RenderViewport/RenderRect与D3D12的结构布局一致)
+    list.RSSetViewports(1, reinterpret_cast<const RenderViewport*>(&mScreenViewport));
+    list.RSSetScissorRects(1, reinterpret_cast<const RenderRect*>(&mScissorRect));
+    //设置渲染目标
+    list.OMSetRenderTargets(1, &rtv, &dsv);
+    //设置常量缓冲区描述符堆
+    const RenderHandle descriptorHeaps[] = { ToRenderHandle(mFrameDescriptors->GetHeap()) };
+    list.SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+    //设置根签名
+    list.SetGraphicsRootSignature(ToRenderHandle(mRootSignature.Get()));
+    //设置顶点缓冲区与索引缓冲区(绑定布局中的每个流；只需位置的pass可以传入mVertexLayout.Select({"POSITION"}))
+    mGeometryPool->Bind(list);
+    //mCommandList->IASetVertexBuffers(0, 1, &mBoxGeo->VertexBufferView());
+    //mCommandList->IASetIndexBuffer(&mBoxGeo->IndexBufferView());
+    //设置图元拓扑
+    list.IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    //mCommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_POINTLIST);
+    //设置描述符表
+    list.SetGraphicsRootDescriptorTable(0, cbvTable);
+
+    //多传入一个常量参数
+    //mCommandList->SetGraphicsRoot32BitConstant(1, gt.TotalTime(), 0);
+
+    //绘制(立方体，以及习题4的四棱锥)
+    uint64_t triangles = 0;
+    for (size_t i = begin; i < end; ++i)
+    {
+        const SubmeshGeometry& submesh = mDrawArgs[mDrawList[i]];
+        list.DrawIndexedInstanced(submesh.IndexCount, 1, submesh.StartIndexLocation, submesh.BaseVertexLocation, 0);
+        triangles += submesh.IndexCount / 3;
+    }
+    Profiler::Get().AddCounter(ProfileCounter::Draws, end - begin);
+    Profiler::Get().AddCounter(ProfileCounter::Instances, end - begin);
+    Profiler::Get().AddCounter(ProfileCounter::Triangles, triangles);
 }
 
 void BoxApp::OnMouseDown(WPARAM btnState, int x, int y)
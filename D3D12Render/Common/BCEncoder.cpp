@@ -0,0 +1,568 @@
+#include "BCEncoder.h"
+#include "JobSystem.h"
+
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace DirectX;
+
+namespace
+{
+    //并行压缩时每个任务负责的块行数
+    const size_t BlockRowsPerTask = 4;
+
+    XMVECTOR LoadPixel(const uint8_t* p)
+    {
+        return XMVectorSet(p[0], p[1], p[2], p[3]);
+    }
+
+    //----------------------------------------------------------------------------
+    //BC1颜色块
+    //----------------------------------------------------------------------------
+
+    uint16_t PackRGB565(XMVECTOR c)
+    {
+        int r = static_cast<int>(XMVectorGetX(c) * (31.0f / 255.0f) + 0.5f);
+        int g = static_cast<int>(XMVectorGetY(c) * (63.0f / 255.0f) + 0.5f);
+        int b = static_cast<int>(XMVectorGetZ(c) * (31.0f / 255.0f) + 0.5f);
+        r = std::min(std::max(r, 0), 31);
+        g = std::min(std::max(g, 0), 63);
+        b = std::min(std::max(b, 0), 31);
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    XMVECTOR UnpackRGB565(uint16_t c)
+    {
+        int r = (c >> 11) & 31;
+        int g = (c >> 5) & 63;
+        int b = c & 31;
+        return XMVectorSet(float((r << 3) | (r >> 2)), float((g << 2) | (g >> 4)), float((b << 3) | (b >> 2)), 255.0f);
+    }
+
+    //对颜色做主成分分析，返回协方差矩阵最大特征值对应的方向(幂迭代法)
+    XMVECTOR PrincipalAxis(const XMVECTOR* colors, const bool* mask, int count, XMVECTOR mean, bool useAlpha)
+    {
+        float cov[4][4] = {};
+        for (int i = 0; i < count; ++i)
+        {
+            if (mask && !mask[i])
+            {
+                continue;
+            }
+            XMFLOAT4 d;
+            XMStoreFloat4(&d, XMVectorSubtract(colors[i], mean));
+            float v[4] = { d.x, d.y, d.z, useAlpha ? d.w : 0.0f };
+            for (int r = 0; r < 4; ++r)
+            {
+                for (int c = 0; c < 4; ++c)
+                {
+                    cov[r][c] += v[r] * v[c];
+                }
+            }
+        }
+
+        float axis[4] = { 1.0f, 1.0f, 1.0f, useAlpha ? 1.0f : 0.0f };
+        for (int iter = 0; iter < 8; ++iter)
+        {
+            float next[4] = {};
+            for (int r = 0; r < 4; ++r)
+            {
+                for (int c = 0; c < 4; ++c)
+                {
+                    next[r] += cov[r][c] * axis[c];
+                }
+            }
+            float len = sqrtf(next[0] * next[0] + next[1] * next[1] + next[2] * next[2] + next[3] * next[3]);
+            if (len < 1e-6f)
+            {
+                break;
+            }
+            for (int r = 0; r < 4; ++r)
+            {
+                axis[r] = next[r] / len;
+            }
+        }
+        return XMVectorSet(axis[0], axis[1], axis[2], axis[3]);
+    }
+
+    //沿主轴方向找到投影的两个极值，作为端点的初始值
+    void FindEndpoints(const XMVECTOR* colors, const bool* mask, int count, bool useAlpha, XMVECTOR& e0, XMVECTOR& e1)
+    {
+        XMVECTOR mean = XMVectorZero();
+        int used = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            if (mask && !mask[i])
+            {
+                continue;
+            }
+            mean = XMVectorAdd(mean, colors[i]);
+            ++used;
+        }
+        if (used == 0)
+        {
+            e0 = e1 = XMVectorZero();
+            return;
+        }
+        mean = XMVectorScale(mean, 1.0f / used);
+
+        XMVECTOR axis = PrincipalAxis(colors, mask, count, mean, useAlpha);
+        float minT = 1e30f;
+        float maxT = -1e30f;
+        for (int i = 0; i < count; ++i)
+        {
+            if (mask && !mask[i])
+            {
+                continue;
+            }
+            float t = XMVectorGetX(XMVector4Dot(XMVectorSubtract(colors[i], mean), axis));
+            minT = std::min(minT, t);
+            maxT = std::max(maxT, t);
+        }
+
+        //端点向内收缩1/16，减小两端颜色的量化误差
+        float inset = (maxT - minT) / 16.0f;
+        minT += inset;
+        maxT -= inset;
+
+        const XMVECTOR lo = XMVectorZero();
+        const XMVECTOR hi = XMVectorReplicate(255.0f);
+        e0 = XMVectorClamp(XMVectorMultiplyAdd(axis, XMVectorReplicate(maxT), mean), lo, hi);
+        e1 = XMVectorClamp(XMVectorMultiplyAdd(axis, XMVectorReplicate(minT), mean), lo, hi);
+    }
+
+    //根据两个565端点生成调色板，返回每个像素的索引以及总误差
+    float FitColorIndices(const XMVECTOR* colors, uint16_t c0, uint16_t c1, bool threeColor, const bool* transparent, uint32_t& indices)
+    {
+        XMVECTOR palette[4];
+        palette[0] = UnpackRGB565(c0);
+        palette[1] = UnpackRGB565(c1);
+        if (threeColor)
+        {
+            palette[2] = XMVectorScale(XMVectorAdd(palette[0], palette[1]), 0.5f);
+            palette[3] = XMVectorZero();
+        }
+        else
+        {
+            palette[2] = XMVectorScale(XMVectorAdd(XMVectorScale(palette[0], 2.0f), palette[1]), 1.0f / 3.0f);
+            palette[3] = XMVectorScale(XMVectorAdd(palette[0], XMVectorScale(palette[1], 2.0f)), 1.0f / 3.0f);
+        }
+        const int paletteSize = threeColor ? 3 : 4;
+
+        indices = 0;
+        float totalError = 0.0f;
+        for (int i = 0; i < 16; ++i)
+        {
+            if (transparent && transparent[i])
+            {
+                indices |= 3u << (2 * i);
+                continue;
+            }
+            int best = 0;
+            float bestError = 1e30f;
+            for (int p = 0; p < paletteSize; ++p)
+            {
+                float err = XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(colors[i], palette[p])));
+                if (err < bestError)
+                {
+                    bestError = err;
+                    best = p;
+                }
+            }
+            indices |= uint32_t(best) << (2 * i);
+            totalError += bestError;
+        }
+        return totalError;
+    }
+
+    //已知索引时，用最小二乘法求解最优端点(仅用于4色模式)
+    bool RefineEndpoints(const XMVECTOR* colors, uint32_t indices, XMVECTOR& e0, XMVECTOR& e1)
+    {
+        static const float weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        XMVECTOR ax = XMVectorZero();
+        XMVECTOR bx = XMVectorZero();
+        for (int i = 0; i < 16; ++i)
+        {
+            float t = weights[(indices >> (2 * i)) & 3];
+            float s = 1.0f - t;
+            aa += s * s;
+            ab += s * t;
+            bb += t * t;
+            ax = XMVectorMultiplyAdd(colors[i], XMVectorReplicate(s), ax);
+            bx = XMVectorMultiplyAdd(colors[i], XMVectorReplicate(t), bx);
+        }
+
+        float det = aa * bb - ab * ab;
+        if (fabsf(det) < 1e-6f)
+        {
+            return false;
+        }
+        float invDet = 1.0f / det;
+
+        const XMVECTOR lo = XMVectorZero();
+        const XMVECTOR hi = XMVectorReplicate(255.0f);
+        e0 = XMVectorClamp(XMVectorScale(XMVectorSubtract(XMVectorScale(ax, bb), XMVectorScale(bx, ab)), invDet), lo, hi);
+        e1 = XMVectorClamp(XMVectorScale(XMVectorSubtract(XMVectorScale(bx, aa), XMVectorScale(ax, ab)), invDet), lo, hi);
+        return true;
+    }
+
+    void WriteColorBlock(uint8_t* out, uint16_t c0, uint16_t c1, uint32_t indices)
+    {
+        out[0] = static_cast<uint8_t>(c0 & 0xff);
+        out[1] = static_cast<uint8_t>(c0 >> 8);
+        out[2] = static_cast<uint8_t>(c1 & 0xff);
+        out[3] = static_cast<uint8_t>(c1 >> 8);
+        out[4] = static_cast<uint8_t>(indices & 0xff);
+        out[5] = static_cast<uint8_t>((indices >> 8) & 0xff);
+        out[6] = static_cast<uint8_t>((indices >> 16) & 0xff);
+        out[7] = static_cast<uint8_t>(indices >> 24);
+    }
+
+    void EncodeColorBlock(const uint8_t* rgba, uint8_t* out, bool allowPunchThrough)
+    {
+        XMVECTOR colors[16];
+        bool transparent[16];
+        bool anyTransparent = false;
+        bool opaque[16];
+        for (int i = 0; i < 16; ++i)
+        {
+            colors[i] = LoadPixel(rgba + i * 4);
+            transparent[i] = allowPunchThrough && rgba[i * 4 + 3] < 128;
+            opaque[i] = !transparent[i];
+            anyTransparent = anyTransparent || transparent[i];
+        }
+
+        XMVECTOR e0, e1;
+        FindEndpoints(colors, opaque, 16, false, e0, e1);
+        uint16_t c0 = PackRGB565(e0);
+        uint16_t c1 = PackRGB565(e1);
+
+        if (anyTransparent)
+        {
+            //3色+透明模式要求c0 <= c1
+            if (c0 > c1)
+            {
+                std::swap(c0, c1);
+            }
+            uint32_t indices = 0;
+            FitColorIndices(colors, c0, c1, true, transparent, indices);
+            WriteColorBlock(out, c0, c1, indices);
+            return;
+        }
+
+        //4色模式要求c0 > c1，两者相等时整个块只用一种颜色
+        if (c0 < c1)
+        {
+            std::swap(c0, c1);
+        }
+        if (c0 == c1)
+        {
+            WriteColorBlock(out, c0, c1, 0);
+            return;
+        }
+
+        uint32_t indices = 0;
+        float error = FitColorIndices(colors, c0, c1, false, nullptr, indices);
+
+        //一次最小二乘优化，误差更小时才采用
+        XMVECTOR r0, r1;
+        if (RefineEndpoints(colors, indices, r0, r1))
+        {
+            uint16_t rc0 = PackRGB565(r0);
+            uint16_t rc1 = PackRGB565(r1);
+            if (rc0 < rc1)
+            {
+                std::swap(rc0, rc1);
+            }
+            if (rc0 != rc1)
+            {
+                uint32_t refinedIndices = 0;
+                float refinedError = FitColorIndices(colors, rc0, rc1, false, nullptr, refinedIndices);
+                if (refinedError < error)
+                {
+                    c0 = rc0;
+                    c1 = rc1;
+                    indices = refinedIndices;
+                }
+            }
+        }
+
+        WriteColorBlock(out, c0, c1, indices);
+    }
+
+    //----------------------------------------------------------------------------
+    //BC7 mode 6
+    //----------------------------------------------------------------------------
+
+    //按位写入128位块
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(uint8_t* out) : mOut(out)
+        {
+            memset(mOut, 0, 16);
+        }
+
+        void Write(uint32_t value, uint32_t bitCount)
+        {
+            for (uint32_t i = 0; i < bitCount; ++i, ++mPos)
+            {
+                if (value & (1u << i))
+                {
+                    mOut[mPos >> 3] |= static_cast<uint8_t>(1u << (mPos & 7));
+                }
+            }
+        }
+
+    private:
+        uint8_t* mOut;
+        uint32_t mPos = 0;
+    };
+
+    //将8位端点量化为7位+共享p位，返回重建后的8位颜色
+    void QuantizeEndpointMode6(XMVECTOR e, uint32_t q[4], uint32_t& pbit, XMVECTOR& recon)
+    {
+        XMFLOAT4 v;
+        XMStoreFloat4(&v, e);
+        const float c[4] = { v.x, v.y, v.z, v.w };
+
+        float bestError = 1e30f;
+        for (uint32_t p = 0; p < 2; ++p)
+        {
+            uint32_t cand[4];
+            float r[4];
+            float err = 0.0f;
+            for (int i = 0; i < 4; ++i)
+            {
+                int qi = static_cast<int>(floorf((c[i] - p) * 0.5f + 0.5f));
+                qi = std::min(std::max(qi, 0), 127);
+                cand[i] = static_cast<uint32_t>(qi);
+                r[i] = float((qi << 1) | p);
+                err += (r[i] - c[i]) * (r[i] - c[i]);
+            }
+            if (err < bestError)
+            {
+                bestError = err;
+                pbit = p;
+                memcpy(q, cand, sizeof(cand));
+                recon = XMVectorSet(r[0], r[1], r[2], r[3]);
+            }
+        }
+    }
+}
+
+bool BCEncoder::IsSupportedFormat(DXGI_FORMAT format)
+{
+    return BlockByteSize(format) != 0;
+}
+
+size_t BCEncoder::BlockByteSize(DXGI_FORMAT format)
+{
+    switch (format)
+    {
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+    case DXGI_FORMAT_BC4_UNORM:
+        return 8;
+
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+    case DXGI_FORMAT_BC5_UNORM:
+    case DXGI_FORMAT_BC7_UNORM:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        return 16;
+
+    default:
+        return 0;
+    }
+}
+
+void BCEncoder::EncodeBC1Block(const uint8_t* rgba, uint8_t* out, bool allowPunchThrough)
+{
+    EncodeColorBlock(rgba, out, allowPunchThrough);
+}
+
+void BCEncoder::EncodeBC3Block(const uint8_t* rgba, uint8_t* out)
+{
+    EncodeBC4Block(rgba, 3, out);
+    EncodeColorBlock(rgba, out + 8, false);
+}
+
+void BCEncoder::EncodeBC4Block(const uint8_t* rgba, int channel, uint8_t* out)
+{
+    int minV = 255;
+    int maxV = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        int v = rgba[i * 4 + channel];
+        minV = std::min(minV, v);
+        maxV = std::max(maxV, v);
+    }
+
+    //使用8值模式(a0 > a1)：索引0为a0，索引1为a1，索引2~7为两者之间的插值
+    out[0] = static_cast<uint8_t>(maxV);
+    out[1] = static_cast<uint8_t>(minV);
+
+    uint64_t indices = 0;
+    if (maxV > minV)
+    {
+        float scale = 7.0f / float(maxV - minV);
+        for (int i = 0; i < 16; ++i)
+        {
+            //k为在[a1,a0]之间的位置，0对应a1，7对应a0
+            int k = static_cast<int>((rgba[i * 4 + channel] - minV) * scale + 0.5f);
+            uint64_t index = (k == 7) ? 0 : (k == 0) ? 1 : uint64_t(8 - k);
+            indices |= index << (3 * i);
+        }
+    }
+
+    for (int i = 0; i < 6; ++i)
+    {
+        out[2 + i] = static_cast<uint8_t>((indices >> (8 * i)) & 0xff);
+    }
+}
+
+void BCEncoder::EncodeBC5Block(const uint8_t* rgba, uint8_t* out)
+{
+    EncodeBC4Block(rgba, 0, out);
+    EncodeBC4Block(rgba, 1, out + 8);
+}
+
+void BCEncoder::EncodeBC7Block(const uint8_t* rgba, uint8_t* out)
+{
+    static const uint32_t weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    XMVECTOR colors[16];
+    for (int i = 0; i < 16; ++i)
+    {
+        colors[i] = LoadPixel(rgba + i * 4);
+    }
+
+    XMVECTOR e0, e1;
+    FindEndpoints(colors, nullptr, 16, true, e0, e1);
+
+    uint32_t q0[4], q1[4];
+    uint32_t p0 = 0, p1 = 0;
+    XMVECTOR r0, r1;
+    QuantizeEndpointMode6(e0, q0, p0, r0);
+    QuantizeEndpointMode6(e1, q1, p1, r1);
+
+    //把像素投影到重建后的端点连线上，选择最近的插值权重
+    uint32_t indices[16];
+    XMVECTOR dir = XMVectorSubtract(r1, r0);
+    float lenSq = XMVectorGetX(XMVector4LengthSq(dir));
+    for (int i = 0; i < 16; ++i)
+    {
+        if (lenSq <= 0.0f)
+        {
+            indices[i] = 0;
+            continue;
+        }
+        float t = XMVectorGetX(XMVector4Dot(XMVectorSubtract(colors[i], r0), dir)) / lenSq;
+        t = std::min(std::max(t, 0.0f), 1.0f) * 64.0f;
+        uint32_t best = 0;
+        float bestDist = 1e30f;
+        for (uint32_t w = 0; w < 16; ++w)
+        {
+            float d = fabsf(float(weights[w]) - t);
+            if (d < bestDist)
+            {
+                bestDist = d;
+                best = w;
+            }
+        }
+        indices[i] = best;
+    }
+
+    //第一个像素是锚点，其索引的最高位隐含为0，需要时交换两个端点
+    if (indices[0] & 8)
+    {
+        std::swap(q0, q1);
+        std::swap(p0, p1);
+        for (int i = 0; i < 16; ++i)
+        {
+            indices[i] = 15 - indices[i];
+        }
+    }
+
+    BitWriter writer(out);
+    writer.Write(1u << 6, 7);               //mode 6
+    for (int c = 0; c < 4; ++c)
+    {
+        writer.Write(q0[c], 7);
+        writer.Write(q1[c], 7);
+    }
+    writer.Write(p0, 1);
+    writer.Write(p1, 1);
+    writer.Write(indices[0], 3);
+    for (int i = 1; i < 16; ++i)
+    {
+        writer.Write(indices[i], 4);
+    }
+}
+
+bool BCEncoder::CompressImage(const MipLevel& src, DXGI_FORMAT format, std::vector<uint8_t>& blocks,
+    bool bc1PunchThrough)
+{
+    const size_t blockSize = BlockByteSize(format);
+    if (blockSize == 0 || src.Width == 0 || src.Height == 0 || src.Pixels.size() < src.RowPitch * src.Height)
+    {
+        return false;
+    }
+
+    const uint32_t blocksWide = (src.Width + 3) / 4;
+    const uint32_t blocksHigh = (src.Height + 3) / 4;
+    const size_t rowBytes = blocksWide * blockSize;
+    blocks.resize(rowBytes * blocksHigh);
+
+    JobSystem::GetDefault().ParallelFor(blocksHigh, BlockRowsPerTask, [&](size_t begin, size_t end)
+    {
+        uint8_t texels[64];
+        for (size_t by = begin; by < end; ++by)
+        {
+            uint8_t* outRow = blocks.data() + by * rowBytes;
+            for (uint32_t bx = 0; bx < blocksWide; ++bx)
+            {
+                //取出4x4块，越界的像素复制边缘像素
+                for (uint32_t py = 0; py < 4; ++py)
+                {
+                    uint32_t y = std::min(static_cast<uint32_t>(by) * 4 + py, src.Height - 1);
+                    const uint8_t* row = src.Pixels.data() + y * src.RowPitch;
+                    for (uint32_t px = 0; px < 4; ++px)
+                    {
+                        uint32_t x = std::min(bx * 4 + px, src.Width - 1);
+                        memcpy(texels + (py * 4 + px) * 4, row + x * 4, 4);
+                    }
+                }
+
+                uint8_t* out = outRow + bx * blockSize;
+                switch (format)
+                {
+                case DXGI_FORMAT_BC1_UNORM:
+                case DXGI_FORMAT_BC1_UNORM_SRGB:
+                    EncodeBC1Block(texels, out, bc1PunchThrough);
+                    break;
+                case DXGI_FORMAT_BC3_UNORM:
+                case DXGI_FORMAT_BC3_UNORM_SRGB:
+                    EncodeBC3Block(texels, out);
+                    break;
+                case DXGI_FORMAT_BC4_UNORM:
+                    EncodeBC4Block(texels, 0, out);
+                    break;
+                case DXGI_FORMAT_BC5_UNORM:
+                    EncodeBC5Block(texels, out);
+                    break;
+                default:
+                    EncodeBC7Block(texels, out);
+                    break;
+                }
+            }
+        }
+    });
+
+    return true;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <dxgiformat.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "MipGenerator.h"
+
+//CPU端的BC块压缩编码器，输入为RGBA8数据
+//支持BC1/BC3/BC4/BC5(UNORM)以及BC7(只使用单子集的mode 6)，sRGB格式与对应的UNORM格式使用相同的编码方式
+//每个4x4块的颜色运算使用DirectXMath(SIMD)完成，整张图像按块行在JobSystem::GetDefault()中并行压缩
+class BCEncoder
+{
+public:
+    static bool IsSupportedFormat(DXGI_FORMAT format);
+
+    //每个4x4块压缩后的字节数(8或16)，不支持的格式返回0
+    static size_t BlockByteSize(DXGI_FORMAT format);
+
+    //以下函数的输入均为按行排列的4x4个RGBA8像素(64字节)
+    //allowPunchThrough为true时，alpha小于128的像素会使用BC1的3色+透明模式编码
+    static void EncodeBC1Block(const uint8_t* rgba, uint8_t* out, bool allowPunchThrough);
+    static void EncodeBC3Block(const uint8_t* rgba, uint8_t* out);
+    //channel指定使用RGBA中的哪一个通道(0~3)
+    static void EncodeBC4Block(const uint8_t* rgba, int channel, uint8_t* out);
+    static void EncodeBC5Block(const uint8_t* rgba, uint8_t* out);
+    static void EncodeBC7Block(const uint8_t* rgba, uint8_t* out);
+
+    //压缩一整级RGBA8图像，尺寸不是4的倍数时边缘块用复制边缘像素的方式补齐
+    //bc1PunchThrough只影响BC1：默认忽略alpha按不透明编码，为true时alpha小于128的像素编码为透明
+    static bool CompressImage(const MipLevel& src, DXGI_FORMAT format, std::vector<uint8_t>& blocks,
+        bool bc1PunchThrough = false);
+};
@@ -0,0 +1,86 @@
+#include "BlobStore.h"
+
+#include <cstring>
+#include "FileUtil.h"
+#include "MappedFile.h"
+
+namespace
+{
+    //文件头，之后紧跟数据
+    struct BlobFileHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint64_t Key;
+        uint64_t Size;
+    };
+}
+
+BlobStore::BlobStore(const std::wstring& directory, const std::wstring& extension, uint32_t magic, uint32_t version) :
+    mDirectory(directory),
+    mExtension(extension),
+    mMagic(magic),
+    mVersion(version)
+{
+}
+
+std::wstring BlobStore::GetPath(uint64_t key) const
+{
+    const wchar_t* digits = L"0123456789abcdef";
+    std::wstring name(16, L'0');
+    for (int i = 15; i >= 0; --i, key >>= 4)
+    {
+        name[i] = digits[key & 0xf];
+    }
+    return mDirectory + L"/" + name + mExtension;
+}
+
+bool BlobStore::Load(uint64_t key, std::vector<uint8_t>& data) const
+{
+    if (mDirectory.empty())
+    {
+        return false;
+    }
+
+    MappedFile file;
+    if (!file.Open(GetPath(key)) || file.GetSize() < sizeof(BlobFileHeader))
+    {
+        return false;
+    }
+
+    BlobFileHeader header;
+    memcpy(&header, file.GetData(), sizeof(header));
+    if (header.Magic != mMagic ||
+        header.Version != mVersion ||
+        header.Key != key ||
+        header.Size != file.GetSize() - sizeof(header))
+    {
+        return false;
+    }
+
+    const uint8_t* begin = file.GetData() + sizeof(header);
+    data.assign(begin, begin + header.Size);
+    return true;
+}
+
+bool BlobStore::Save(uint64_t key, const void* data, size_t size) const
+{
+    if (mDirectory.empty() || !FileUtil::EnsureDirectory(mDirectory))
+    {
+        return false;
+    }
+
+    BlobFileHeader header;
+    header.Magic = mMagic;
+    header.Version = mVersion;
+    header.Key = key;
+    header.Size = size;
+
+    std::vector<uint8_t> file(sizeof(header) + size);
+    memcpy(file.data(), &header, sizeof(header));
+    if (size > 0)
+    {
+        memcpy(file.data() + sizeof(header), data, size);
+    }
+    return FileUtil::WriteAllBytes(GetPath(key), file.data(), file.size());
+}
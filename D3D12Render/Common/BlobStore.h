@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//磁盘上按64位键保存的二进制数据，每个键一个文件：<directory>/<键的16位十六进制><extension>
+//文件头记录magic、版本、键与数据长度，任何一项不符都视为未命中，因此格式变化后旧文件会被自然忽略
+//读取通过只读映射完成，写入先写临时文件再重命名，多个线程可以同时读写不同的键
+class BlobStore
+{
+public:
+    //directory为空时不读写磁盘，Load总是未命中
+    BlobStore(const std::wstring& directory, const std::wstring& extension, uint32_t magic, uint32_t version);
+
+    bool Load(uint64_t key, std::vector<uint8_t>& data) const;
+
+    //写入失败时返回false(不影响调用者的结果，下次运行重新生成)
+    bool Save(uint64_t key, const void* data, size_t size) const;
+
+    const std::wstring& GetDirectory() const { return mDirectory; }
+
+private:
+    std::wstring GetPath(uint64_t key) const;
+
+private:
+    std::wstring mDirectory;
+    std::wstring mExtension;
+    uint32_t mMagic = 0;
+    uint32_t mVersion = 0;
+};
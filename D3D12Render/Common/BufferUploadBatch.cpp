@@ -0,0 +1,147 @@
+#include "BufferUploadBatch.h"
+
+#include "Profiler.h"
+
+using Microsoft::WRL::ComPtr;
+
+BufferUploadBatch::BufferUploadBatch(ID3D12Device* device, ResourceStateTracker& stateTracker) :
+    mDevice(device),
+    mStateTracker(stateTracker)
+{
+}
+
+size_t BufferUploadBatch::Add(const void* data, UINT64 byteSize, D3D12_RESOURCE_STATES finalState)
+{
+    assert(!mRecorded);
+    assert(byteSize > 0);
+
+    Entry entry;
+    entry.Data = data;
+    entry.Size = byteSize;
+    entry.FinalState = finalState;
+    mEntries.push_back(entry);
+    return mEntries.size() - 1;
+}
+
+void BufferUploadBatch::Record(ID3D12GraphicsCommandList* cmdList)
+{
+    assert(!mRecorded);
+    mRecorded = true;
+
+    if (mEntries.empty())
+    {
+        return;
+    }
+
+    //先向设备查询每个缓冲区的实际占用与对齐，再统一计算布局
+    std::vector<BufferUploadItem> items(mEntries.size());
+    for (size_t i = 0; i < mEntries.size(); ++i)
+    {
+        D3D12_RESOURCE_ALLOCATION_INFO info = mDevice->GetResourceAllocationInfo(0, 1,
+            &CD3DX12_RESOURCE_DESC::Buffer(mEntries[i].Size));
+        items[i].Size = mEntries[i].Size;
+        items[i].AllocationSize = info.SizeInBytes;
+        items[i].Alignment = info.Alignment;
+    }
+
+    BufferUploadPlan plan;
+    if (!BufferUploadPlanner::Build(items, plan))
+    {
+        ThrowIfFailed(E_INVALIDARG);
+    }
+
+    //ALLOW_ONLY_BUFFERS使资源堆层级1的硬件也能使用
+    CD3DX12_HEAP_DESC heapDesc(plan.HeapSize, D3D12_HEAP_TYPE_DEFAULT, plan.HeapAlignment,
+        D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS);
+    ThrowIfFailed(mDevice->CreateHeap(&heapDesc, IID_PPV_ARGS(mHeap.GetAddressOf())));
+
+    ThrowIfFailed(mDevice->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer(plan.StagingSize),
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(mStaging.GetAddressOf())));
+
+    //上传缓冲区只写不读，Map时读取范围为空
+    BYTE* mapped = nullptr;
+    CD3DX12_RANGE readRange(0, 0);
+    ThrowIfFailed(mStaging->Map(0, &readRange, reinterpret_cast<void**>(&mapped)));
+
+    for (size_t i = 0; i < mEntries.size(); ++i)
+    {
+        Entry& entry = mEntries[i];
+        const BufferUploadPlacement& placement = plan.Placements[i];
+
+        ThrowIfFailed(mDevice->CreatePlacedResource(
+            mHeap.Get(),
+            placement.HeapOffset,
+            &CD3DX12_RESOURCE_DESC::Buffer(entry.Size),
+            D3D12_RESOURCE_STATE_COMMON,
+            nullptr,
+            IID_PPV_ARGS(entry.Buffer.GetAddressOf())));
+
+        memcpy(mapped + placement.StagingOffset, entry.Data, (size_t)entry.Size);
+        Profiler::Get().AddCounter(ProfileCounter::BytesUploaded, entry.Size);
+
+        mStateTracker.Register(entry.Buffer.Get(), 1, D3D12_RESOURCE_STATE_COMMON);
+    }
+
+    mStaging->Unmap(0, nullptr);
+
+    //复制队列上不能转换到VERTEX_AND_CONSTANT_BUFFER等状态：缓冲区在COMMON状态下复制(隐式提升为COPY_DEST)，
+    //执行完成后衰减回COMMON，再由使用它的队列隐式提升为最终状态，因此tracker中的状态保持为COMMON
+    const bool copyQueue = cmdList->GetType() == D3D12_COMMAND_LIST_TYPE_COPY;
+    D3DBarrierRecorder barriers(cmdList);
+
+    if (!copyQueue)
+    {
+        for (const Entry& entry : mEntries)
+        {
+            mStateTracker.Transition(entry.Buffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST);
+        }
+        mStateTracker.Flush(barriers);
+    }
+    for (size_t i = 0; i < mEntries.size(); ++i)
+    {
+        cmdList->CopyBufferRegion(mEntries[i].Buffer.Get(), 0,
+            mStaging.Get(), plan.Placements[i].StagingOffset, mEntries[i].Size);
+    }
+    if (!copyQueue)
+    {
+        for (const Entry& entry : mEntries)
+        {
+            mStateTracker.Transition(entry.Buffer.Get(), entry.FinalState);
+        }
+        mStateTracker.Flush(barriers);
+    }
+
+    //录制完成后不再需要调用者的数据
+    for (auto& entry : mEntries)
+    {
+        entry.Data = nullptr;
+    }
+}
+
+void BufferUploadBatch::SetReleaseFence(ID3D12Fence* fence, UINT64 fenceValue)
+{
+    mReleaseFence = fence;
+    mReleaseFenceValue = fenceValue;
+}
+
+bool BufferUploadBatch::TryReleaseStaging()
+{
+    if (mStaging == nullptr)
+    {
+        return true;
+    }
+
+    if (mReleaseFence == nullptr || mReleaseFence->GetCompletedValue() < mReleaseFenceValue)
+    {
+        return false;
+    }
+
+    mStaging = nullptr;
+    mReleaseFence = nullptr;
+    return true;
+}
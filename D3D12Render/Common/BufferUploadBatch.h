@@ -0,0 +1,54 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "BufferUploadPlan.h"
+
+//成批创建带初始数据的默认堆缓冲区，代替逐个调用d3dUtil::CreateDefaultBuffer：
+//所有缓冲区作为placed resource放在同一个默认堆中，初始数据打包进同一个上传缓冲区，
+//复制前后的状态转换由ResourceStateTracker产生，各用一次ResourceBarrier提交，命令执行完成(一个fence)后统一释放上传缓冲区
+class BufferUploadBatch
+{
+public:
+    //创建的缓冲区登记到stateTracker中并保持登记，之后的状态转换也经由它；使用者释放缓冲区前需要Unregister
+    BufferUploadBatch(ID3D12Device* device, ResourceStateTracker& stateTracker);
+    BufferUploadBatch(const BufferUploadBatch& rhs) = delete;
+    BufferUploadBatch& operator=(const BufferUploadBatch& rhs) = delete;
+
+    //登记一个缓冲区，返回其序号。data在Record之前必须保持有效
+    size_t Add(const void* data, UINT64 byteSize,
+        D3D12_RESOURCE_STATES finalState = D3D12_RESOURCE_STATE_GENERIC_READ);
+
+    //创建堆、上传缓冲区与所有缓冲区，并把复制命令与状态转换录制到cmdList中，只能调用一次
+    //cmdList为COPY类型时不记录状态转换，缓冲区在复制完成后处于COMMON状态，第一次使用时隐式提升为finalState
+    void Record(ID3D12GraphicsCommandList* cmdList);
+
+    //Record之后有效。缓冲区不持有堆的引用，使用期间需要同时保存GetHeap()
+    Microsoft::WRL::ComPtr<ID3D12Resource> GetBuffer(size_t index) const { return mEntries[index].Buffer; }
+    Microsoft::WRL::ComPtr<ID3D12Heap> GetHeap() const { return mHeap; }
+
+    //提交命令列表并Signal之后调用，fence到达fenceValue后上传缓冲区即可释放
+    void SetReleaseFence(ID3D12Fence* fence, UINT64 fenceValue);
+
+    //fence已到达时释放上传缓冲区，返回上传缓冲区是否已经释放
+    bool TryReleaseStaging();
+
+private:
+    struct Entry
+    {
+        const void* Data = nullptr;
+        UINT64 Size = 0;
+        D3D12_RESOURCE_STATES FinalState = D3D12_RESOURCE_STATE_GENERIC_READ;
+        Microsoft::WRL::ComPtr<ID3D12Resource> Buffer;
+    };
+
+    ID3D12Device* mDevice = nullptr;
+    ResourceStateTracker& mStateTracker;
+    std::vector<Entry> mEntries;
+    bool mRecorded = false;
+
+    Microsoft::WRL::ComPtr<ID3D12Heap> mHeap;
+    Microsoft::WRL::ComPtr<ID3D12Resource> mStaging;
+
+    Microsoft::WRL::ComPtr<ID3D12Fence> mReleaseFence;
+    UINT64 mReleaseFenceValue = 0;
+};
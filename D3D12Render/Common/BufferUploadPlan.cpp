@@ -0,0 +1,71 @@
+#include "BufferUploadPlan.h"
+
+#include <algorithm>
+
+namespace
+{
+    bool IsPowerOfTwo(uint64_t value)
+    {
+        return value != 0 && (value & (value - 1)) == 0;
+    }
+
+    //向上对齐，溢出时返回false
+    bool AlignUp(uint64_t value, uint64_t alignment, uint64_t& out)
+    {
+        const uint64_t mask = alignment - 1;
+        if (value > UINT64_MAX - mask)
+        {
+            return false;
+        }
+        out = (value + mask) & ~mask;
+        return true;
+    }
+
+    bool Add(uint64_t a, uint64_t b, uint64_t& out)
+    {
+        if (a > UINT64_MAX - b)
+        {
+            return false;
+        }
+        out = a + b;
+        return true;
+    }
+}
+
+bool BufferUploadPlanner::Build(const std::vector<BufferUploadItem>& items, BufferUploadPlan& plan)
+{
+    plan = BufferUploadPlan();
+    plan.Placements.resize(items.size());
+    plan.HeapAlignment = 1;
+
+    uint64_t heapCursor = 0;
+    uint64_t stagingCursor = 0;
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        const BufferUploadItem& item = items[i];
+        if (!IsPowerOfTwo(item.Alignment) || item.AllocationSize < item.Size)
+        {
+            return false;
+        }
+
+        //按提交顺序依次放置，调用者需要的缓冲区通常很少，不值得为减少对齐空洞而排序
+        BufferUploadPlacement& placement = plan.Placements[i];
+        if (!AlignUp(heapCursor, item.Alignment, placement.HeapOffset) ||
+            !Add(placement.HeapOffset, item.AllocationSize, heapCursor) ||
+            !AlignUp(stagingCursor, StagingAlignment, placement.StagingOffset) ||
+            !Add(placement.StagingOffset, item.Size, stagingCursor))
+        {
+            return false;
+        }
+
+        plan.HeapAlignment = std::max(plan.HeapAlignment, item.Alignment);
+    }
+
+    //堆的大小需要是其对齐值的整数倍
+    if (!AlignUp(heapCursor, plan.HeapAlignment, plan.HeapSize))
+    {
+        return false;
+    }
+    plan.StagingSize = stagingCursor;
+    return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+//BufferUploadBatch的布局计算部分，不依赖D3D设备
+//所有缓冲区放置在同一个默认堆中，初始数据打包进同一个上传缓冲区
+
+#include <cstdint>
+#include <vector>
+
+struct BufferUploadItem
+{
+    uint64_t Size = 0;              //初始数据的字节数
+    uint64_t AllocationSize = 0;    //资源在堆中占用的字节数(GetResourceAllocationInfo的SizeInBytes)
+    uint64_t Alignment = 0;         //资源在堆中的对齐要求(GetResourceAllocationInfo的Alignment)
+};
+
+struct BufferUploadPlacement
+{
+    uint64_t HeapOffset = 0;        //placed resource在堆中的偏移
+    uint64_t StagingOffset = 0;     //初始数据在上传缓冲区中的偏移
+};
+
+struct BufferUploadPlan
+{
+    std::vector<BufferUploadPlacement> Placements;  //与items一一对应
+    uint64_t HeapSize = 0;
+    uint64_t HeapAlignment = 0;
+    uint64_t StagingSize = 0;
+};
+
+class BufferUploadPlanner
+{
+public:
+    //上传缓冲区中每段数据的起始位置按该值对齐
+    static const uint64_t StagingAlignment = 16;
+
+    //对齐要求不是2的幂或总大小溢出时返回false
+    static bool Build(const std::vector<BufferUploadItem>& items, BufferUploadPlan& plan);
+};
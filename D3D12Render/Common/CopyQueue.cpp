@@ -0,0 +1,139 @@
+#include "CopyQueue.h"
+
+using Microsoft::WRL::ComPtr;
+
+CopyQueue::CopyQueue(ID3D12Device* device) :
+    mDevice(device)
+{
+    D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+    ThrowIfFailed(mDevice->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(mQueue.GetAddressOf())));
+    ThrowIfFailed(mDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(mFence.GetAddressOf())));
+}
+
+CopyQueue::~CopyQueue()
+{
+    Flush();
+}
+
+CopyJob CopyQueue::Begin()
+{
+    CopyJob job;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        RetireLocked(mFence->GetCompletedValue());
+
+        //先取fence已经完成的分配器，没有时再创建
+        mAllocators.Acquire(mFence->GetCompletedValue(), job.Allocator);
+        if (!mFreeLists.empty())
+        {
+            job.List = mFreeLists.back();
+            mFreeLists.pop_back();
+        }
+    }
+
+    if (job.Allocator == nullptr)
+    {
+        ThrowIfFailed(mDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY,
+            IID_PPV_ARGS(job.Allocator.GetAddressOf())));
+    }
+    else
+    {
+        ThrowIfFailed(job.Allocator->Reset());
+    }
+
+    if (job.List == nullptr)
+    {
+        ThrowIfFailed(mDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, job.Allocator.Get(), nullptr,
+            IID_PPV_ARGS(job.List.GetAddressOf())));
+    }
+    else
+    {
+        ThrowIfFailed(job.List->Reset(job.Allocator.Get(), nullptr));
+    }
+
+    job.CmdList = job.List.Get();
+    return job;
+}
+
+UINT64 CopyQueue::Submit(CopyJob& job, ID3D12Resource* const* targets, size_t count)
+{
+    ThrowIfFailed(job.List->Close());
+
+    std::vector<TransferScheduler::ResourceId> ids(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        ids[i] = reinterpret_cast<TransferScheduler::ResourceId>(targets[i]);
+    }
+
+    UINT64 fenceValue = 0;
+    {
+        //提交与Signal在锁内完成，保证fence值与提交顺序一致
+        std::lock_guard<std::mutex> lock(mMutex);
+        ID3D12CommandList* lists[] = { job.List.Get() };
+        mQueue->ExecuteCommandLists(_countof(lists), lists);
+        fenceValue = ++mLastSubmitted;
+        ThrowIfFailed(mQueue->Signal(mFence.Get(), fenceValue));
+
+        mAllocators.Release(job.Allocator, fenceValue);
+        mFreeLists.push_back(job.List);
+    }
+    mScheduler.OnSubmitted(fenceValue, ids.data(), ids.size());
+
+    job = CopyJob();
+    return fenceValue;
+}
+
+void CopyQueue::ReleaseAfter(UINT64 fenceValue, ComPtr<IUnknown> object)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    //按fence值顺序登记，早于已登记的值时按最后的值处理(晚一些释放没有问题)
+    mPendingReleases.Release(std::move(object), std::max<UINT64>(fenceValue, mLastSubmitted));
+}
+
+void CopyQueue::WaitForUse(ID3D12CommandQueue* queue, ID3D12Resource* const* resources, size_t count)
+{
+    std::vector<TransferScheduler::ResourceId> ids(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        ids[i] = reinterpret_cast<TransferScheduler::ResourceId>(resources[i]);
+    }
+
+    const UINT64 waitValue = mScheduler.AcquireForUse(ids.data(), ids.size(), mFence->GetCompletedValue());
+    if (waitValue != 0)
+    {
+        //GPU端等待，不阻塞CPU
+        ThrowIfFailed(queue->Wait(mFence.Get(), waitValue));
+    }
+}
+
+void CopyQueue::Retire()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    RetireLocked(mFence->GetCompletedValue());
+}
+
+void CopyQueue::RetireLocked(UINT64 completedValue)
+{
+    mPendingReleases.Trim(completedValue);
+    mScheduler.Trim(completedValue);
+}
+
+void CopyQueue::Flush()
+{
+    UINT64 lastSubmitted = 0;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        lastSubmitted = mLastSubmitted;
+    }
+
+    if (mFence->GetCompletedValue() < lastSubmitted)
+    {
+        HANDLE eventHandle = CreateEventEx(nullptr, false, false, EVENT_ALL_ACCESS);
+        ThrowIfFailed(mFence->SetEventOnCompletion(lastSubmitted, eventHandle));
+        WaitForSingleObject(eventHandle, INFINITE);
+        CloseHandle(eventHandle);
+    }
+    Retire();
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "TransferScheduler.h"
+
+//一次传输任务：从CopyQueue取得的命令列表，只能记录复制命令
+//目标资源在COMMON状态下使用即可，复制队列上会隐式提升为COPY_DEST，执行完后衰减回COMMON，
+//之后graphics队列第一次使用时再隐式提升为需要的只读状态，所以不需要(也不能)在复制队列上记录其他状态的转换
+struct CopyJob
+{
+    ID3D12GraphicsCommandList* CmdList = nullptr;
+
+    Microsoft::WRL::ComPtr<ID3D12CommandAllocator> Allocator;
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> List;
+};
+
+//独立的COPY队列，有自己的命令分配器与fence，大块的网格与纹理上传不再占用graphics队列
+//跨队列的等待只在资源第一次被使用时插入(WaitForUse)，没有使用新上传资源的帧不会等待复制队列
+//Begin/Submit可以在多个线程中同时调用(如后台的流式加载线程)
+class CopyQueue
+{
+public:
+    explicit CopyQueue(ID3D12Device* device);
+    CopyQueue(const CopyQueue& rhs) = delete;
+    CopyQueue& operator=(const CopyQueue& rhs) = delete;
+    //等待所有传输完成
+    ~CopyQueue();
+
+    //开始一个传输任务
+    CopyJob Begin();
+
+    //提交传输任务，返回完成时的fence值；targets为本次写入的资源，使用之前需要经过WaitForUse
+    UINT64 Submit(CopyJob& job, ID3D12Resource* const* targets, size_t count);
+
+    //fence到达fenceValue之后释放object(如上传缓冲区)
+    void ReleaseAfter(UINT64 fenceValue, Microsoft::WRL::ComPtr<IUnknown> object);
+
+    //在queue上提交使用这些资源的命令之前调用：其中还在传输的资源会让queue在GPU端等待复制队列，已经完成的不会等待
+    void WaitForUse(ID3D12CommandQueue* queue, ID3D12Resource* const* resources, size_t count);
+
+    //回收已经完成的命令分配器与待释放的对象
+    void Retire();
+
+    //CPU端等待所有已提交的传输完成
+    void Flush();
+
+    ID3D12CommandQueue* GetQueue() const { return mQueue.Get(); }
+    ID3D12Fence* GetFence() const { return mFence.Get(); }
+    const TransferScheduler& GetScheduler() const { return mScheduler; }
+
+private:
+    void RetireLocked(UINT64 completedValue);
+
+private:
+    ID3D12Device* mDevice = nullptr;
+    Microsoft::WRL::ComPtr<ID3D12CommandQueue> mQueue;
+    Microsoft::WRL::ComPtr<ID3D12Fence> mFence;
+
+    std::mutex mMutex;
+    UINT64 mLastSubmitted = 0;
+    FencedPool<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>> mAllocators;
+    FencedPool<Microsoft::WRL::ComPtr<IUnknown>> mPendingReleases;
+    //关闭后的命令列表可以立即用另一个分配器重置，不需要等待fence
+    std::vector<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>> mFreeLists;
+
+    TransferScheduler mScheduler;
+};
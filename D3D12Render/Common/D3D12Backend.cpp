@@ -0,0 +1,262 @@
+#include "D3D12Backend.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+    template<typename T>
+    T* FromHandle(RenderHandle handle)
+    {
+        return reinterpret_cast<T*>(static_cast<uintptr_t>(handle));
+    }
+}
+
+D3D12RenderCommandList::D3D12RenderCommandList(ID3D12Device* device, D3D12_COMMAND_LIST_TYPE type) :
+    mBarriers(nullptr)
+{
+    ThrowIfFailed(device->CreateCommandAllocator(type, IID_PPV_ARGS(&mAllocator)));
+    ThrowIfFailed(device->CreateCommandList(0, type, mAllocator.Get(), nullptr, IID_PPV_ARGS(&mList)));
+    ThrowIfFailed(mList->Close());
+    mBarriers = D3DBarrierRecorder(mList.Get());
+}
+
+D3D12RenderCommandList::D3D12RenderCommandList(ID3D12GraphicsCommandList* list) :
+    mList(list),
+    mBarriers(list)
+{
+}
+
+void D3D12RenderCommandList::Reset(RenderHandle initialState)
+{
+    assert(mAllocator != nullptr && "D3D12RenderCommandList: wrapped lists are reset by their owner");
+    ThrowIfFailed(mAllocator->Reset());
+    ThrowIfFailed(mList->Reset(mAllocator.Get(), FromHandle<ID3D12PipelineState>(initialState)));
+}
+
+void D3D12RenderCommandList::Close()
+{
+    ThrowIfFailed(mList->Close());
+}
+
+void D3D12RenderCommandList::SetPipelineState(RenderHandle pso)
+{
+    mList->SetPipelineState(FromHandle<ID3D12PipelineState>(pso));
+}
+
+void D3D12RenderCommandList::SetGraphicsRootSignature(RenderHandle rootSignature)
+{
+    mList->SetGraphicsRootSignature(FromHandle<ID3D12RootSignature>(rootSignature));
+}
+
+void D3D12RenderCommandList::SetGraphicsRootDescriptorTable(uint32_t rootParameterIndex, uint64_t gpuDescriptor)
+{
+    D3D12_GPU_DESCRIPTOR_HANDLE handle;
+    handle.ptr = gpuDescriptor;
+    mList->SetGraphicsRootDescriptorTable(rootParameterIndex, handle);
+}
+
+void D3D12RenderCommandList::SetDescriptorHeaps(uint32_t numHeaps, const RenderHandle* heaps)
+{
+    //每种着色器可见的堆(CBV_SRV_UAV与SAMPLER)最多各设置一个
+    ID3D12DescriptorHeap* nativeHeaps[2];
+    assert(numHeaps <= _countof(nativeHeaps));
+    for (uint32_t i = 0; i < numHeaps; ++i)
+    {
+        nativeHeaps[i] = FromHandle<ID3D12DescriptorHeap>(heaps[i]);
+    }
+    mList->SetDescriptorHeaps(numHeaps, nativeHeaps);
+}
+
+void D3D12RenderCommandList::RSSetViewports(uint32_t numViewports, const RenderViewport* viewports)
+{
+    static_assert(sizeof(RenderViewport) == sizeof(D3D12_VIEWPORT), "layout mismatch");
+    mList->RSSetViewports(numViewports, reinterpret_cast<const D3D12_VIEWPORT*>(viewports));
+}
+
+void D3D12RenderCommandList::RSSetScissorRects(uint32_t numRects, const RenderRect* rects)
+{
+    static_assert(sizeof(RenderRect) == sizeof(D3D12_RECT), "layout mismatch");
+    mList->RSSetScissorRects(numRects, reinterpret_cast<const D3D12_RECT*>(rects));
+}
+
+void D3D12RenderCommandList::OMSetRenderTargets(uint32_t numRenderTargets, const uint64_t* rtvCpuDescriptors,
+    const uint64_t* dsvCpuDescriptor)
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE rtvs[D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT];
+    assert(numRenderTargets <= D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT);
+    for (uint32_t i = 0; i < numRenderTargets; ++i)
+    {
+        rtvs[i].ptr = static_cast<SIZE_T>(rtvCpuDescriptors[i]);
+    }
+    D3D12_CPU_DESCRIPTOR_HANDLE dsv;
+    if (dsvCpuDescriptor != nullptr)
+    {
+        dsv.ptr = static_cast<SIZE_T>(*dsvCpuDescriptor);
+    }
+    mList->OMSetRenderTargets(numRenderTargets, rtvs, false, dsvCpuDescriptor != nullptr ? &dsv : nullptr);
+}
+
+void D3D12RenderCommandList::IASetVertexBuffers(uint32_t startSlot, uint32_t numViews, const RenderVertexBufferView* views)
+{
+    static_assert(sizeof(RenderVertexBufferView) == sizeof(D3D12_VERTEX_BUFFER_VIEW), "layout mismatch");
+    mList->IASetVertexBuffers(startSlot, numViews, reinterpret_cast<const D3D12_VERTEX_BUFFER_VIEW*>(views));
+}
+
+void D3D12RenderCommandList::IASetIndexBuffer(const RenderIndexBufferView* view)
+{
+    static_assert(sizeof(RenderIndexBufferView) == sizeof(D3D12_INDEX_BUFFER_VIEW), "layout mismatch");
+    mList->IASetIndexBuffer(reinterpret_cast<const D3D12_INDEX_BUFFER_VIEW*>(view));
+}
+
+void D3D12RenderCommandList::IASetPrimitiveTopology(uint32_t topology)
+{
+    mList->IASetPrimitiveTopology(static_cast<D3D12_PRIMITIVE_TOPOLOGY>(topology));
+}
+
+void D3D12RenderCommandList::ClearRenderTargetView(uint64_t cpuDescriptor, const float color[4])
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE handle;
+    handle.ptr = static_cast<SIZE_T>(cpuDescriptor);
+    mList->ClearRenderTargetView(handle, color, 0, nullptr);
+}
+
+void D3D12RenderCommandList::ClearDepthStencilView(uint64_t cpuDescriptor, uint32_t clearFlags, float depth,
+    uint8_t stencil)
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE handle;
+    handle.ptr = static_cast<SIZE_T>(cpuDescriptor);
+    mList->ClearDepthStencilView(handle, static_cast<D3D12_CLEAR_FLAGS>(clearFlags), depth, stencil, 0, nullptr);
+}
+
+void D3D12RenderCommandList::DrawInstanced(uint32_t vertexCountPerInstance, uint32_t instanceCount,
+    uint32_t startVertexLocation, uint32_t startInstanceLocation)
+{
+    mList->DrawInstanced(vertexCountPerInstance, instanceCount, startVertexLocation, startInstanceLocation);
+}
+
+void D3D12RenderCommandList::DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount,
+    uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation)
+{
+    mList->DrawIndexedInstanced(indexCountPerInstance, instanceCount, startIndexLocation, baseVertexLocation,
+        startInstanceLocation);
+}
+
+void D3D12RenderCommandList::CopyBufferRegion(RenderHandle dest, uint64_t destOffset, RenderHandle source,
+    uint64_t sourceOffset, uint64_t numBytes)
+{
+    mList->CopyBufferRegion(FromHandle<ID3D12Resource>(dest), destOffset, FromHandle<ID3D12Resource>(source),
+        sourceOffset, numBytes);
+}
+
+void D3D12RenderCommandList::EndQuery(RenderHandle queryHeap, uint32_t type, uint32_t index)
+{
+    mList->EndQuery(FromHandle<ID3D12QueryHeap>(queryHeap), static_cast<D3D12_QUERY_TYPE>(type), index);
+}
+
+void D3D12RenderCommandList::ResourceBarrier(uint32_t count, const ResourceTransition* transitions)
+{
+    mBarriers.ResourceBarrier(count, transitions);
+}
+
+D3D12RenderFence::D3D12RenderFence(ComPtr<ID3D12Fence> fence) :
+    mFence(fence)
+{
+    mEvent = CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS);
+    if (mEvent == nullptr)
+    {
+        ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+    }
+}
+
+D3D12RenderFence::~D3D12RenderFence()
+{
+    CloseHandle(mEvent);
+}
+
+uint64_t D3D12RenderFence::GetCompletedValue() const
+{
+    return mFence->GetCompletedValue();
+}
+
+void D3D12RenderFence::WaitForValue(uint64_t value)
+{
+    if (mFence->GetCompletedValue() < value)
+    {
+        ThrowIfFailed(mFence->SetEventOnCompletion(value, mEvent));
+        WaitForSingleObject(mEvent, INFINITE);
+    }
+}
+
+D3D12RenderQueue::D3D12RenderQueue(ComPtr<ID3D12CommandQueue> queue) :
+    mQueue(queue)
+{
+}
+
+void D3D12RenderQueue::ExecuteCommandLists(uint32_t count, IRenderCommandList* const* lists)
+{
+    mLists.resize(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        mLists[i] = static_cast<D3D12RenderCommandList*>(lists[i])->GetNative();
+    }
+    mQueue->ExecuteCommandLists(count, mLists.data());
+}
+
+void D3D12RenderQueue::Signal(IRenderFence& fence, uint64_t value)
+{
+    ThrowIfFailed(mQueue->Signal(static_cast<D3D12RenderFence&>(fence).GetNative(), value));
+}
+
+void D3D12RenderQueue::Wait(IRenderFence& fence, uint64_t value)
+{
+    ThrowIfFailed(mQueue->Wait(static_cast<D3D12RenderFence&>(fence).GetNative(), value));
+}
+
+D3D12RenderDevice::D3D12RenderDevice(ComPtr<ID3D12Device> device) :
+    mDevice(device)
+{
+}
+
+std::unique_ptr<IRenderQueue> D3D12RenderDevice::CreateQueue(RenderQueueType type)
+{
+    D3D12_COMMAND_QUEUE_DESC desc = {};
+    desc.Type = static_cast<D3D12_COMMAND_LIST_TYPE>(type);
+    desc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+    ComPtr<ID3D12CommandQueue> queue;
+    ThrowIfFailed(mDevice->CreateCommandQueue(&desc, IID_PPV_ARGS(&queue)));
+    return std::make_unique<D3D12RenderQueue>(queue);
+}
+
+std::unique_ptr<IRenderCommandList> D3D12RenderDevice::CreateCommandList(RenderQueueType type)
+{
+    return std::make_unique<D3D12RenderCommandList>(mDevice.Get(), static_cast<D3D12_COMMAND_LIST_TYPE>(type));
+}
+
+std::unique_ptr<IRenderFence> D3D12RenderDevice::CreateFence(uint64_t initialValue)
+{
+    ComPtr<ID3D12Fence> fence;
+    ThrowIfFailed(mDevice->CreateFence(initialValue, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence)));
+    return std::make_unique<D3D12RenderFence>(fence);
+}
+
+void D3D12RenderDevice::CopyDescriptorsSimple(uint32_t count, uint64_t destCpuDescriptor, uint64_t sourceCpuDescriptor,
+    uint32_t heapType)
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE dest;
+    dest.ptr = static_cast<SIZE_T>(destCpuDescriptor);
+    D3D12_CPU_DESCRIPTOR_HANDLE source;
+    source.ptr = static_cast<SIZE_T>(sourceCpuDescriptor);
+    mDevice->CopyDescriptorsSimple(count, dest, source, static_cast<D3D12_DESCRIPTOR_HEAP_TYPE>(heapType));
+}
+
+void D3D12RenderDevice::WriteUploadBuffer(RenderHandle buffer, uint64_t offset, const void* data, size_t size)
+{
+    ID3D12Resource* resource = FromHandle<ID3D12Resource>(buffer);
+    //CPU不读取，读取范围为空
+    CD3DX12_RANGE readRange(0, 0);
+    uint8_t* mapped = nullptr;
+    ThrowIfFailed(resource->Map(0, &readRange, reinterpret_cast<void**>(&mapped)));
+    memcpy(mapped + offset, data, size);
+    CD3DX12_RANGE writtenRange(static_cast<SIZE_T>(offset), static_cast<SIZE_T>(offset + size));
+    resource->Unmap(0, &writtenRange);
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "RenderBackend.h"
+
+//RenderBackend的D3D12实现，各对象直接转发给包装的D3D12接口
+//RenderHandle为对应接口的指针(ID3D12PipelineState*、ID3D12RootSignature*、ID3D12Resource*)
+
+template<typename T>
+inline RenderHandle ToRenderHandle(T* object)
+{
+    return static_cast<RenderHandle>(reinterpret_cast<uintptr_t>(object));
+}
+
+class D3D12RenderCommandList : public IRenderCommandList
+{
+public:
+    //自带一个命令分配器，创建后处于关闭状态
+    D3D12RenderCommandList(ID3D12Device* device, D3D12_COMMAND_LIST_TYPE type);
+    //包装一个已有的、处于录制状态的命令列表(如并行录制中每块的列表)，Reset与Close由列表的所有者负责
+    explicit D3D12RenderCommandList(ID3D12GraphicsCommandList* list);
+
+    virtual void Reset(RenderHandle initialState) override;
+    virtual void Close() override;
+
+    virtual void SetPipelineState(RenderHandle pso) override;
+    virtual void SetGraphicsRootSignature(RenderHandle rootSignature) override;
+    virtual void SetGraphicsRootDescriptorTable(uint32_t rootParameterIndex, uint64_t gpuDescriptor) override;
+    virtual void SetDescriptorHeaps(uint32_t numHeaps, const RenderHandle* heaps) override;
+    virtual void RSSetViewports(uint32_t numViewports, const RenderViewport* viewports) override;
+    virtual void RSSetScissorRects(uint32_t numRects, const RenderRect* rects) override;
+    virtual void OMSetRenderTargets(uint32_t numRenderTargets, const uint64_t* rtvCpuDescriptors,
+        const uint64_t* dsvCpuDescriptor) override;
+    virtual void IASetVertexBuffers(uint32_t startSlot, uint32_t numViews, const RenderVertexBufferView* views) override;
+    virtual void IASetIndexBuffer(const RenderIndexBufferView* view) override;
+    virtual void IASetPrimitiveTopology(uint32_t topology) override;
+    virtual void ClearRenderTargetView(uint64_t cpuDescriptor, const float color[4]) override;
+    virtual void ClearDepthStencilView(uint64_t cpuDescriptor, uint32_t clearFlags, float depth, uint8_t stencil) override;
+    virtual void DrawInstanced(uint32_t vertexCountPerInstance, uint32_t instanceCount,
+        uint32_t startVertexLocation, uint32_t startInstanceLocation) override;
+    virtual void DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount,
+        uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation) override;
+    virtual void CopyBufferRegion(RenderHandle dest, uint64_t destOffset, RenderHandle source, uint64_t sourceOffset,
+        uint64_t numBytes) override;
+    virtual void EndQuery(RenderHandle queryHeap, uint32_t type, uint32_t index) override;
+    virtual void ResourceBarrier(uint32_t count, const ResourceTransition* transitions) override;
+
+    ID3D12GraphicsCommandList* GetNative() const { return mList.Get(); }
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12CommandAllocator> mAllocator;
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> mList;
+    D3DBarrierRecorder mBarriers;
+};
+
+class D3D12RenderFence : public IRenderFence
+{
+public:
+    //包装已有的fence(如D3DApp的md3dFence)
+    explicit D3D12RenderFence(Microsoft::WRL::ComPtr<ID3D12Fence> fence);
+    D3D12RenderFence(const D3D12RenderFence& rhs) = delete;
+    D3D12RenderFence& operator=(const D3D12RenderFence& rhs) = delete;
+    ~D3D12RenderFence();
+
+    virtual uint64_t GetCompletedValue() const override;
+    virtual void WaitForValue(uint64_t value) override;
+
+    ID3D12Fence* GetNative() const { return mFence.Get(); }
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12Fence> mFence;
+    HANDLE mEvent = nullptr;
+};
+
+class D3D12RenderQueue : public IRenderQueue
+{
+public:
+    explicit D3D12RenderQueue(Microsoft::WRL::ComPtr<ID3D12CommandQueue> queue);
+
+    //lists需要都是D3D12RenderCommandList
+    virtual void ExecuteCommandLists(uint32_t count, IRenderCommandList* const* lists) override;
+    //fence需要是D3D12RenderFence
+    virtual void Signal(IRenderFence& fence, uint64_t value) override;
+    virtual void Wait(IRenderFence& fence, uint64_t value) override;
+
+    ID3D12CommandQueue* GetNative() const { return mQueue.Get(); }
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12CommandQueue> mQueue;
+    std::vector<ID3D12CommandList*> mLists;
+};
+
+class D3D12RenderDevice : public IRenderDevice
+{
+public:
+    explicit D3D12RenderDevice(Microsoft::WRL::ComPtr<ID3D12Device> device);
+
+    virtual std::unique_ptr<IRenderQueue> CreateQueue(RenderQueueType type) override;
+    virtual std::unique_ptr<IRenderCommandList> CreateCommandList(RenderQueueType type) override;
+    virtual std::unique_ptr<IRenderFence> CreateFence(uint64_t initialValue) override;
+
+    virtual void CopyDescriptorsSimple(uint32_t count, uint64_t destCpuDescriptor, uint64_t sourceCpuDescriptor,
+        uint32_t heapType) override;
+    //buffer需要位于上传堆
+    virtual void WriteUploadBuffer(RenderHandle buffer, uint64_t offset, const void* data, size_t size) override;
+
+    ID3D12Device* GetNative() const { return mDevice.Get(); }
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12Device> mDevice;
+};
@@ -0,0 +1,51 @@
+#include "D3D12TimestampQueries.h"
+
+D3D12TimestampQueries::D3D12TimestampQueries(ID3D12Device* device, ID3D12CommandQueue* queue, UINT queryCount,
+    UINT slotCount) :
+    mQueue(queue),
+    mReadbacks(slotCount, nullptr)
+{
+    D3D12_QUERY_HEAP_DESC desc = {};
+    desc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+    desc.Count = queryCount;
+    desc.NodeMask = 0;
+    ThrowIfFailed(device->CreateQueryHeap(&desc, IID_PPV_ARGS(&mQueryHeap)));
+}
+
+void D3D12TimestampQueries::WriteTimestamp(uint32_t query)
+{
+    assert(mCmdList != nullptr);
+    mCmdList->EndQuery(mQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, query);
+}
+
+void D3D12TimestampQueries::ResolveTimestamps(uint32_t slot, uint32_t firstQuery, uint32_t count)
+{
+    assert(mCmdList != nullptr && mReadbacks[slot] != nullptr);
+    mCmdList->ResolveQueryData(mQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, firstQuery, count, mReadbacks[slot], 0);
+}
+
+void D3D12TimestampQueries::ReadTimestamps(uint32_t slot, uint32_t count, uint64_t* timestamps)
+{
+    //只读取解析过的部分，CPU不写入，写入范围为空
+    CD3DX12_RANGE readRange(0, count * sizeof(uint64_t));
+    void* mapped = nullptr;
+    ThrowIfFailed(mReadbacks[slot]->Map(0, &readRange, &mapped));
+    memcpy(timestamps, mapped, count * sizeof(uint64_t));
+    CD3DX12_RANGE writtenRange(0, 0);
+    mReadbacks[slot]->Unmap(0, &writtenRange);
+}
+
+GpuClockCalibration D3D12TimestampQueries::GetCalibration()
+{
+    GpuClockCalibration calibration;
+    UINT64 gpuTimestamp = 0;
+    UINT64 cpuTicks = 0;
+    ThrowIfFailed(mQueue->GetTimestampFrequency(&calibration.GpuFrequency));
+    ThrowIfFailed(mQueue->GetClockCalibration(&gpuTimestamp, &cpuTicks));
+    calibration.GpuTimestamp = gpuTimestamp;
+    calibration.CpuTicks = static_cast<int64_t>(cpuTicks);
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    calibration.CpuFrequency = frequency.QuadPart;
+    return calibration;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "GpuProfiler.h"
+
+//GpuProfiler的D3D12后端：时间戳查询堆由本类持有，回读缓冲区由各帧资源持有(FrameResource::TimestampReadback)
+//只能在DIRECT或COMPUTE队列的命令列表上使用(COPY队列需要额外的特性支持)
+class D3D12TimestampQueries : public IGpuTimestampBackend
+{
+public:
+    D3D12TimestampQueries(ID3D12Device* device, ID3D12CommandQueue* queue, UINT queryCount, UINT slotCount);
+
+    //之后的时间戳记录到cmdList中，同一帧内可以切换到按提交顺序执行的另一个列表
+    void SetCommandList(ID3D12GraphicsCommandList* cmdList) { mCmdList = cmdList; }
+    //slot的回读缓冲区，需要位于READBACK堆并处于COPY_DEST状态
+    void SetReadback(UINT slot, ID3D12Resource* readback) { mReadbacks[slot] = readback; }
+
+    virtual void WriteTimestamp(uint32_t query) override;
+    virtual void ResolveTimestamps(uint32_t slot, uint32_t firstQuery, uint32_t count) override;
+    virtual void ReadTimestamps(uint32_t slot, uint32_t count, uint64_t* timestamps) override;
+    virtual GpuClockCalibration GetCalibration() override;
+
+private:
+    ID3D12CommandQueue* mQueue = nullptr;
+    Microsoft::WRL::ComPtr<ID3D12QueryHeap> mQueryHeap;
+    ID3D12GraphicsCommandList* mCmdList = nullptr;
+    std::vector<ID3D12Resource*> mReadbacks;
+};
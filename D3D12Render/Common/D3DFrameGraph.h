@@ -0,0 +1,59 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "FrameGraph.h"
+#include "Profiler.h"
+
+//FrameGraph在D3D12中录制pass的对象：pass之前的状态转换与aliasing barrier都记录到CmdList
+//传入tracker时，已在其中注册的(导入)资源经由tracker转换，使它记录的状态在帧之间保持正确；
+//tracker不是线程安全的，并行录制的多个context不能共用同一个tracker
+struct D3DFrameGraphContext
+{
+    explicit D3DFrameGraphContext(ID3D12GraphicsCommandList* cmdList, ResourceStateTracker* tracker = nullptr) :
+        CmdList(cmdList), Barriers(cmdList), Tracker(tracker) {}
+
+    void ResourceBarrier(uint32_t count, const ResourceTransition* transitions)
+    {
+        if (Tracker == nullptr)
+        {
+            Barriers.ResourceBarrier(count, transitions);
+            return;
+        }
+
+        Untracked.clear();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const ResourceTransition& transition = transitions[i];
+            if (Tracker->IsRegistered(transition.Resource))
+            {
+                assert(Tracker->GetState(transition.Resource) == transition.StateBefore);
+                Tracker->Transition(transition.Resource, transition.StateAfter, transition.Subresource);
+            }
+            else
+            {
+                Untracked.push_back(transition);
+            }
+        }
+        Tracker->Flush(Barriers);
+        if (!Untracked.empty())
+        {
+            Barriers.ResourceBarrier(static_cast<uint32_t>(Untracked.size()), Untracked.data());
+        }
+    }
+
+    void AliasingBarrier(const void* before, const void* after)
+    {
+        const D3D12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Aliasing(
+            static_cast<ID3D12Resource*>(const_cast<void*>(before)), static_cast<ID3D12Resource*>(const_cast<void*>(after)));
+        CmdList->ResourceBarrier(1, &barrier);
+        Profiler::Get().AddCounter(ProfileCounter::Barriers, 1);
+    }
+
+    ID3D12GraphicsCommandList* CmdList = nullptr;
+    D3DBarrierRecorder Barriers;
+    ResourceStateTracker* Tracker = nullptr;
+    //图内的临时资源没有注册到Tracker，直接提交
+    std::vector<ResourceTransition> Untracked;
+};
+
+typedef FrameGraph<D3DFrameGraphContext> D3DFrameGraph;
@@ -0,0 +1,77 @@
+#pragma once
+
+//DXGI格式相关的辅助函数，不依赖D3D设备，DDS加载器与离线纹理工具共用
+//DDS文件头的解析也放在这里，所有读取文件数据的位置都先做边界与溢出检查(文件内容不可信)
+
+#include <dxgiformat.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "DDS.h"
+
+enum class DDSParseResult
+{
+    Ok,
+    InvalidData,    //文件内容不合法(数据不足、字段矛盾等)
+    NotSupported    //文件合法，但格式或尺寸不受支持
+};
+
+//由DDS文件头得到的纹理描述
+struct DDSTextureDesc
+{
+    uint32_t Dimension = 0;     //DDS_DIMENSION_TEXTURE1D/2D/3D
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    uint32_t Depth = 0;
+    uint32_t MipCount = 0;
+    uint32_t ArraySize = 0;     //立方体贴图时为面的总数(6的倍数)
+    DXGI_FORMAT Format = DXGI_FORMAT_UNKNOWN;
+    bool IsCubeMap = false;
+};
+
+//一个子资源在像素数据中的位置，子资源按数组切片优先的顺序排列
+struct DDSSubresourceLayout
+{
+    size_t Offset = 0;
+    size_t RowPitch = 0;
+    size_t SlicePitch = 0;      //一个深度切片的字节数
+    size_t NumRows = 0;         //BC格式以块为单位计
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    uint32_t Depth = 0;
+};
+
+class DDSFormat
+{
+public:
+    //每个像素占用的位数，BC格式按平均值计算，未知格式返回0
+    static size_t BitsPerPixel(DXGI_FORMAT fmt);
+
+    //计算指定尺寸的一个表面所占用的总字节数、每行字节数以及行数(BC格式以块为单位计)
+    static void GetSurfaceInfo(size_t width,
+                               size_t height,
+                               DXGI_FORMAT fmt,
+                               size_t* outNumBytes,
+                               size_t* outRowBytes,
+                               size_t* outNumRows);
+
+    static bool IsCompressed(DXGI_FORMAT fmt);
+
+    //把非DX10文件头中的像素格式映射为DXGI格式，无法映射时返回DXGI_FORMAT_UNKNOWN
+    static DXGI_FORMAT GetDXGIFormat(const DDS_PIXELFORMAT& ddpf);
+
+    //校验magic以及文件头(含DX10扩展头)是否完整，成功时返回文件头与像素数据在ddsData中的位置
+    static bool ParseHeader(const uint8_t* ddsData,
+                            size_t ddsDataSize,
+                            const DDS_HEADER** outHeader,
+                            size_t* outBitOffset);
+
+    //由文件头得到纹理描述，尺寸限制与D3D12的硬件要求一致
+    //header必须来自ParseHeader，保证DX10扩展头在数据范围内
+    static DDSParseResult GetTextureDesc(const DDS_HEADER* header, DDSTextureDesc& desc);
+
+    //计算每个子资源在像素数据中的位置，像素数据不足或尺寸溢出时返回false
+    static bool ComputeLayout(const DDSTextureDesc& desc,
+                              size_t bitSize,
+                              std::vector<DDSSubresourceLayout>& layouts);
+};
@@ -21,9 +21,17 @@
 #include <assert.h>
 #include <algorithm>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 #include <wrl.h>
 
 #include "DDSTextureLoader.h" 
+#include "DDS.h"
+#include "DDSFormat.h"
+#include "DDSTranscoder.h"
+#include "MappedFile.h"
+#include "MipGenerator.h"
 
 using namespace Microsoft::WRL;
 
@@ -33,103 +41,10 @@ using namespace Microsoft::WRL;
 
 using namespace DirectX;
 
-//--------------------------------------------------------------------------------------
-// Macros
-//--------------------------------------------------------------------------------------
-#ifndef MAKEFOURCC
-    #define MAKEFOURCC(ch0, ch1, ch2, ch3)                              \
-                ((uint32_t)(uint8_t)(ch0) | ((uint32_t)(uint8_t)(ch1) << 8) |       \
-                ((uint32_t)(uint8_t)(ch2) << 16) | ((uint32_t)(uint8_t)(ch3) << 24 ))
-#endif /* defined(MAKEFOURCC) */
-
-//--------------------------------------------------------------------------------------
-// DDS file structure definitions
-//
-// See DDS.h in the 'Texconv' sample and the 'DirectXTex' library
-//--------------------------------------------------------------------------------------
-#pragma pack(push,1)
-
-const uint32_t DDS_MAGIC = 0x20534444; // "DDS "
-
-struct DDS_PIXELFORMAT
-{
-    uint32_t    size;
-    uint32_t    flags;
-    uint32_t    fourCC;
-    uint32_t    RGBBitCount;
-    uint32_t    RBitMask;
-    uint32_t    GBitMask;
-    uint32_t    BBitMask;
-    uint32_t    ABitMask;
-};
-
-#define DDS_FOURCC      0x00000004  // DDPF_FOURCC
-#define DDS_RGB         0x00000040  // DDPF_RGB
-#define DDS_LUMINANCE   0x00020000  // DDPF_LUMINANCE
-#define DDS_ALPHA       0x00000002  // DDPF_ALPHA
-
-#define DDS_HEADER_FLAGS_VOLUME         0x00800000  // DDSD_DEPTH
-
-#define DDS_HEIGHT 0x00000002 // DDSD_HEIGHT
-#define DDS_WIDTH  0x00000004 // DDSD_WIDTH
-
-#define DDS_CUBEMAP_POSITIVEX 0x00000600 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEX
-#define DDS_CUBEMAP_NEGATIVEX 0x00000a00 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEX
-#define DDS_CUBEMAP_POSITIVEY 0x00001200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEY
-#define DDS_CUBEMAP_NEGATIVEY 0x00002200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEY
-#define DDS_CUBEMAP_POSITIVEZ 0x00004200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEZ
-#define DDS_CUBEMAP_NEGATIVEZ 0x00008200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEZ
-
-#define DDS_CUBEMAP_ALLFACES ( DDS_CUBEMAP_POSITIVEX | DDS_CUBEMAP_NEGATIVEX |\
-                               DDS_CUBEMAP_POSITIVEY | DDS_CUBEMAP_NEGATIVEY |\
-                               DDS_CUBEMAP_POSITIVEZ | DDS_CUBEMAP_NEGATIVEZ )
-
-#define DDS_CUBEMAP 0x00000200 // DDSCAPS2_CUBEMAP
-
-enum DDS_MISC_FLAGS2
-{
-    DDS_MISC_FLAGS2_ALPHA_MODE_MASK = 0x7L,
-};
-
-struct DDS_HEADER
-{
-    uint32_t        size;
-    uint32_t        flags;
-    uint32_t        height;
-    uint32_t        width;
-    uint32_t        pitchOrLinearSize;
-    uint32_t        depth; // only if DDS_HEADER_FLAGS_VOLUME is set in flags
-    uint32_t        mipMapCount;
-    uint32_t        reserved1[11];
-    DDS_PIXELFORMAT ddspf;
-    uint32_t        caps;
-    uint32_t        caps2;
-    uint32_t        caps3;
-    uint32_t        caps4;
-    uint32_t        reserved2;
-};
-
-struct DDS_HEADER_DXT10
-{
-    DXGI_FORMAT     dxgiFormat;
-    uint32_t        resourceDimension;
-    uint32_t        miscFlag; // see D3D11_RESOURCE_MISC_FLAG
-    uint32_t        arraySize;
-    uint32_t        miscFlags2;
-};
-
-#pragma pack(pop)
-
 //--------------------------------------------------------------------------------------
 namespace
 {
 
-struct handle_closer { void operator()(HANDLE h) { if (h) CloseHandle(h); } };
-
-typedef public std::unique_ptr<void, handle_closer> ScopedHandle;
-
-inline HANDLE safe_handle( HANDLE h ) { return (h == INVALID_HANDLE_VALUE) ? 0 : h; }
-
 template<UINT TNameLength>
 inline void SetDebugObjectName(_In_ ID3D11DeviceChild* resource, _In_ const char (&name)[TNameLength])
 {
@@ -143,11 +58,22 @@ inline void SetDebugObjectName(_In_ ID3D11DeviceChild* resource, _In_ const char
 
 };
 
+// 旧格式DDS转码结果的缓存目录，为空时只在内存中转码
+// 纹理可能在多个线程中加载，读写都要持有g_transcodeCacheMutex，读取时复制一份再使用
+static std::mutex g_transcodeCacheMutex;
+static std::wstring g_transcodeCacheDir;
+
+static std::wstring GetTranscodeCacheDirectory()
+{
+	std::lock_guard<std::mutex> lock(g_transcodeCacheMutex);
+	return g_transcodeCacheDir;
+}
+
 //--------------------------------------------------------------------------------------
 static HRESULT LoadTextureDataFromFile( _In_z_ const wchar_t* fileName,
-                                        std::unique_ptr<uint8_t[]>& ddsData,
-                                        DDS_HEADER** header,
-                                        uint8_t** bitData,
+                                        MappedFile& ddsFile,
+                                        const DDS_HEADER** header,
+                                        const uint8_t** bitData,
                                         size_t* bitSize
                                       )
 {
@@ -156,615 +82,35 @@ static HRESULT LoadTextureDataFromFile( _In_z_ const wchar_t* fileName,
         return E_POINTER;
     }
 
-    // open the file
-#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
-    ScopedHandle hFile( safe_handle( CreateFile2( fileName,
-                                                  GENERIC_READ,
-                                                  FILE_SHARE_READ,
-                                                  OPEN_EXISTING,
-                                                  nullptr ) ) );
-#else
-    ScopedHandle hFile( safe_handle( CreateFileW( fileName,
-                                                  GENERIC_READ,
-                                                  FILE_SHARE_READ,
-                                                  nullptr,
-                                                  OPEN_EXISTING,
-                                                  FILE_ATTRIBUTE_NORMAL,
-                                                  nullptr ) ) );
-#endif
-
-    if ( !hFile )
-    {
-        return HRESULT_FROM_WIN32( GetLastError() );
-    }
-
-    // Get the file size
-    LARGE_INTEGER FileSize = { 0 };
-
-#if (_WIN32_WINNT >= _WIN32_WINNT_VISTA)
-    FILE_STANDARD_INFO fileInfo;
-    if ( !GetFileInformationByHandleEx( hFile.get(), FileStandardInfo, &fileInfo, sizeof(fileInfo) ) )
-    {
-        return HRESULT_FROM_WIN32( GetLastError() );
-    }
-    FileSize = fileInfo.EndOfFile;
-#else
-    GetFileSizeEx( hFile.get(), &FileSize );
-#endif
-
-    // File is too big for 32-bit allocation, so reject read
-    if (FileSize.HighPart > 0)
+    // map the file read-only, the pixel data is consumed directly from the view
+    if (!ddsFile.Open( fileName ))
     {
-        return E_FAIL;
+        return ddsFile.GetError() ? HRESULT_FROM_WIN32( ddsFile.GetError() ) : E_FAIL;
     }
 
     // Need at least enough data to fill the header and magic number to be a valid DDS
-    if (FileSize.LowPart < ( sizeof(DDS_HEADER) + sizeof(uint32_t) ) )
-    {
-        return E_FAIL;
-    }
-
-    // create enough space for the file data
-    ddsData.reset( new (std::nothrow) uint8_t[ FileSize.LowPart ] );
-    if (!ddsData)
-    {
-        return E_OUTOFMEMORY;
-    }
-
-    // read the data in
-    DWORD BytesRead = 0;
-    if (!ReadFile( hFile.get(),
-                   ddsData.get(),
-                   FileSize.LowPart,
-                   &BytesRead,
-                   nullptr
-                 ))
-    {
-        return HRESULT_FROM_WIN32( GetLastError() );
-    }
-
-    if (BytesRead < FileSize.LowPart)
-    {
-        return E_FAIL;
-    }
-
-    // DDS files always start with the same magic number ("DDS ")
-    uint32_t dwMagicNumber = *( const uint32_t* )( ddsData.get() );
-    if (dwMagicNumber != DDS_MAGIC)
+    if (ddsFile.GetSize() < ( sizeof(DDS_HEADER) + sizeof(uint32_t) ) )
     {
         return E_FAIL;
     }
 
-    auto hdr = reinterpret_cast<DDS_HEADER*>( ddsData.get() + sizeof( uint32_t ) );
-
-    // Verify header to validate DDS file
-    if (hdr->size != sizeof(DDS_HEADER) ||
-        hdr->ddspf.size != sizeof(DDS_PIXELFORMAT))
+    // DDS files always start with the same magic number ("DDS "), the headers are validated by DDSFormat
+    const DDS_HEADER* hdr = nullptr;
+    size_t offset = 0;
+    if (!DDSFormat::ParseHeader( ddsFile.GetData(), ddsFile.GetSize(), &hdr, &offset ))
     {
         return E_FAIL;
     }
 
-    // Check for DX10 extension
-    bool bDXT10Header = false;
-    if ((hdr->ddspf.flags & DDS_FOURCC) &&
-        (MAKEFOURCC( 'D', 'X', '1', '0' ) == hdr->ddspf.fourCC))
-    {
-        // Must be long enough for both headers and magic value
-        if (FileSize.LowPart < ( sizeof(DDS_HEADER) + sizeof(uint32_t) + sizeof(DDS_HEADER_DXT10) ) )
-        {
-            return E_FAIL;
-        }
-
-        bDXT10Header = true;
-    }
-
     // setup the pointers in the process request
     *header = hdr;
-    ptrdiff_t offset = sizeof( uint32_t ) + sizeof( DDS_HEADER )
-                       + (bDXT10Header ? sizeof( DDS_HEADER_DXT10 ) : 0);
-    *bitData = ddsData.get() + offset;
-    *bitSize = FileSize.LowPart - offset;
+    *bitData = ddsFile.GetData() + offset;
+    *bitSize = ddsFile.GetSize() - offset;
 
     return S_OK;
 }
 
 
-//--------------------------------------------------------------------------------------
-// Return the BPP for a particular format
-//--------------------------------------------------------------------------------------
-static size_t BitsPerPixel( _In_ DXGI_FORMAT fmt )
-{
-    switch( fmt )
-    {
-    case DXGI_FORMAT_R32G32B32A32_TYPELESS:
-    case DXGI_FORMAT_R32G32B32A32_FLOAT:
-    case DXGI_FORMAT_R32G32B32A32_UINT:
-    case DXGI_FORMAT_R32G32B32A32_SINT:
-        return 128;
-
-    case DXGI_FORMAT_R32G32B32_TYPELESS:
-    case DXGI_FORMAT_R32G32B32_FLOAT:
-    case DXGI_FORMAT_R32G32B32_UINT:
-    case DXGI_FORMAT_R32G32B32_SINT:
-        return 96;
-
-    case DXGI_FORMAT_R16G16B16A16_TYPELESS:
-    case DXGI_FORMAT_R16G16B16A16_FLOAT:
-    case DXGI_FORMAT_R16G16B16A16_UNORM:
-    case DXGI_FORMAT_R16G16B16A16_UINT:
-    case DXGI_FORMAT_R16G16B16A16_SNORM:
-    case DXGI_FORMAT_R16G16B16A16_SINT:
-    case DXGI_FORMAT_R32G32_TYPELESS:
-    case DXGI_FORMAT_R32G32_FLOAT:
-    case DXGI_FORMAT_R32G32_UINT:
-    case DXGI_FORMAT_R32G32_SINT:
-    case DXGI_FORMAT_R32G8X24_TYPELESS:
-    case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
-    case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
-    case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
-    case DXGI_FORMAT_Y416:
-    case DXGI_FORMAT_Y210:
-    case DXGI_FORMAT_Y216:
-        return 64;
-
-    case DXGI_FORMAT_R10G10B10A2_TYPELESS:
-    case DXGI_FORMAT_R10G10B10A2_UNORM:
-    case DXGI_FORMAT_R10G10B10A2_UINT:
-    case DXGI_FORMAT_R11G11B10_FLOAT:
-    case DXGI_FORMAT_R8G8B8A8_TYPELESS:
-    case DXGI_FORMAT_R8G8B8A8_UNORM:
-    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
-    case DXGI_FORMAT_R8G8B8A8_UINT:
-    case DXGI_FORMAT_R8G8B8A8_SNORM:
-    case DXGI_FORMAT_R8G8B8A8_SINT:
-    case DXGI_FORMAT_R16G16_TYPELESS:
-    case DXGI_FORMAT_R16G16_FLOAT:
-    case DXGI_FORMAT_R16G16_UNORM:
-    case DXGI_FORMAT_R16G16_UINT:
-    case DXGI_FORMAT_R16G16_SNORM:
-    case DXGI_FORMAT_R16G16_SINT:
-    case DXGI_FORMAT_R32_TYPELESS:
-    case DXGI_FORMAT_D32_FLOAT:
-    case DXGI_FORMAT_R32_FLOAT:
-    case DXGI_FORMAT_R32_UINT:
-    case DXGI_FORMAT_R32_SINT:
-    case DXGI_FORMAT_R24G8_TYPELESS:
-    case DXGI_FORMAT_D24_UNORM_S8_UINT:
-    case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
-    case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
-    case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
-    case DXGI_FORMAT_R8G8_B8G8_UNORM:
-    case DXGI_FORMAT_G8R8_G8B8_UNORM:
-    case DXGI_FORMAT_B8G8R8A8_UNORM:
-    case DXGI_FORMAT_B8G8R8X8_UNORM:
-    case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
-    case DXGI_FORMAT_B8G8R8A8_TYPELESS:
-    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
-    case DXGI_FORMAT_B8G8R8X8_TYPELESS:
-    case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
-    case DXGI_FORMAT_AYUV:
-    case DXGI_FORMAT_Y410:
-    case DXGI_FORMAT_YUY2:
-        return 32;
-
-    case DXGI_FORMAT_P010:
-    case DXGI_FORMAT_P016:
-        return 24;
-
-    case DXGI_FORMAT_R8G8_TYPELESS:
-    case DXGI_FORMAT_R8G8_UNORM:
-    case DXGI_FORMAT_R8G8_UINT:
-    case DXGI_FORMAT_R8G8_SNORM:
-    case DXGI_FORMAT_R8G8_SINT:
-    case DXGI_FORMAT_R16_TYPELESS:
-    case DXGI_FORMAT_R16_FLOAT:
-    case DXGI_FORMAT_D16_UNORM:
-    case DXGI_FORMAT_R16_UNORM:
-    case DXGI_FORMAT_R16_UINT:
-    case DXGI_FORMAT_R16_SNORM:
-    case DXGI_FORMAT_R16_SINT:
-    case DXGI_FORMAT_B5G6R5_UNORM:
-    case DXGI_FORMAT_B5G5R5A1_UNORM:
-    case DXGI_FORMAT_A8P8:
-    case DXGI_FORMAT_B4G4R4A4_UNORM:
-        return 16;
-
-    case DXGI_FORMAT_NV12:
-    case DXGI_FORMAT_420_OPAQUE:
-    case DXGI_FORMAT_NV11:
-        return 12;
-
-    case DXGI_FORMAT_R8_TYPELESS:
-    case DXGI_FORMAT_R8_UNORM:
-    case DXGI_FORMAT_R8_UINT:
-    case DXGI_FORMAT_R8_SNORM:
-    case DXGI_FORMAT_R8_SINT:
-    case DXGI_FORMAT_A8_UNORM:
-    case DXGI_FORMAT_AI44:
-    case DXGI_FORMAT_IA44:
-    case DXGI_FORMAT_P8:
-        return 8;
-
-    case DXGI_FORMAT_R1_UNORM:
-        return 1;
-
-    case DXGI_FORMAT_BC1_TYPELESS:
-    case DXGI_FORMAT_BC1_UNORM:
-    case DXGI_FORMAT_BC1_UNORM_SRGB:
-    case DXGI_FORMAT_BC4_TYPELESS:
-    case DXGI_FORMAT_BC4_UNORM:
-    case DXGI_FORMAT_BC4_SNORM:
-        return 4;
-
-    case DXGI_FORMAT_BC2_TYPELESS:
-    case DXGI_FORMAT_BC2_UNORM:
-    case DXGI_FORMAT_BC2_UNORM_SRGB:
-    case DXGI_FORMAT_BC3_TYPELESS:
-    case DXGI_FORMAT_BC3_UNORM:
-    case DXGI_FORMAT_BC3_UNORM_SRGB:
-    case DXGI_FORMAT_BC5_TYPELESS:
-    case DXGI_FORMAT_BC5_UNORM:
-    case DXGI_FORMAT_BC5_SNORM:
-    case DXGI_FORMAT_BC6H_TYPELESS:
-    case DXGI_FORMAT_BC6H_UF16:
-    case DXGI_FORMAT_BC6H_SF16:
-    case DXGI_FORMAT_BC7_TYPELESS:
-    case DXGI_FORMAT_BC7_UNORM:
-    case DXGI_FORMAT_BC7_UNORM_SRGB:
-        return 8;
-
-    default:
-        return 0;
-    }
-}
-
-
-//--------------------------------------------------------------------------------------
-// Get surface information for a particular format
-//--------------------------------------------------------------------------------------
-static void GetSurfaceInfo( _In_ size_t width,
-                            _In_ size_t height,
-                            _In_ DXGI_FORMAT fmt,
-                            _Out_opt_ size_t* outNumBytes,
-                            _Out_opt_ size_t* outRowBytes,
-                            _Out_opt_ size_t* outNumRows )
-{
-    size_t numBytes = 0;
-    size_t rowBytes = 0;
-    size_t numRows = 0;
-
-    bool bc = false;
-    bool packed = false;
-    bool planar = false;
-    size_t bpe = 0;
-    switch (fmt)
-    {
-    case DXGI_FORMAT_BC1_TYPELESS:
-    case DXGI_FORMAT_BC1_UNORM:
-    case DXGI_FORMAT_BC1_UNORM_SRGB:
-    case DXGI_FORMAT_BC4_TYPELESS:
-    case DXGI_FORMAT_BC4_UNORM:
-    case DXGI_FORMAT_BC4_SNORM:
-        bc=true;
-        bpe = 8;
-        break;
-
-    case DXGI_FORMAT_BC2_TYPELESS:
-    case DXGI_FORMAT_BC2_UNORM:
-    case DXGI_FORMAT_BC2_UNORM_SRGB:
-    case DXGI_FORMAT_BC3_TYPELESS:
-    case DXGI_FORMAT_BC3_UNORM:
-    case DXGI_FORMAT_BC3_UNORM_SRGB:
-    case DXGI_FORMAT_BC5_TYPELESS:
-    case DXGI_FORMAT_BC5_UNORM:
-    case DXGI_FORMAT_BC5_SNORM:
-    case DXGI_FORMAT_BC6H_TYPELESS:
-    case DXGI_FORMAT_BC6H_UF16:
-    case DXGI_FORMAT_BC6H_SF16:
-    case DXGI_FORMAT_BC7_TYPELESS:
-    case DXGI_FORMAT_BC7_UNORM:
-    case DXGI_FORMAT_BC7_UNORM_SRGB:
-        bc = true;
-        bpe = 16;
-        break;
-
-    case DXGI_FORMAT_R8G8_B8G8_UNORM:
-    case DXGI_FORMAT_G8R8_G8B8_UNORM:
-    case DXGI_FORMAT_YUY2:
-        packed = true;
-        bpe = 4;
-        break;
-
-    case DXGI_FORMAT_Y210:
-    case DXGI_FORMAT_Y216:
-        packed = true;
-        bpe = 8;
-        break;
-
-    case DXGI_FORMAT_NV12:
-    case DXGI_FORMAT_420_OPAQUE:
-        planar = true;
-        bpe = 2;
-        break;
-
-    case DXGI_FORMAT_P010:
-    case DXGI_FORMAT_P016:
-        planar = true;
-        bpe = 4;
-        break;
-    }
-
-    if (bc)
-    {
-        size_t numBlocksWide = 0;
-        if (width > 0)
-        {
-            numBlocksWide = std::max<size_t>( 1, (width + 3) / 4 );
-        }
-        size_t numBlocksHigh = 0;
-        if (height > 0)
-        {
-            numBlocksHigh = std::max<size_t>( 1, (height + 3) / 4 );
-        }
-        rowBytes = numBlocksWide * bpe;
-        numRows = numBlocksHigh;
-        numBytes = rowBytes * numBlocksHigh;
-    }
-    else if (packed)
-    {
-        rowBytes = ( ( width + 1 ) >> 1 ) * bpe;
-        numRows = height;
-        numBytes = rowBytes * height;
-    }
-    else if ( fmt == DXGI_FORMAT_NV11 )
-    {
-        rowBytes = ( ( width + 3 ) >> 2 ) * 4;
-        numRows = height * 2; // Direct3D makes this simplifying assumption, although it is larger than the 4:1:1 data
-        numBytes = rowBytes * numRows;
-    }
-    else if (planar)
-    {
-        rowBytes = ( ( width + 1 ) >> 1 ) * bpe;
-        numBytes = ( rowBytes * height ) + ( ( rowBytes * height + 1 ) >> 1 );
-        numRows = height + ( ( height + 1 ) >> 1 );
-    }
-    else
-    {
-        size_t bpp = BitsPerPixel( fmt );
-        rowBytes = ( width * bpp + 7 ) / 8; // round up to nearest byte
-        numRows = height;
-        numBytes = rowBytes * height;
-    }
-
-    if (outNumBytes)
-    {
-        *outNumBytes = numBytes;
-    }
-    if (outRowBytes)
-    {
-        *outRowBytes = rowBytes;
-    }
-    if (outNumRows)
-    {
-        *outNumRows = numRows;
-    }
-}
-
-
-//--------------------------------------------------------------------------------------
-#define ISBITMASK( r,g,b,a ) ( ddpf.RBitMask == r && ddpf.GBitMask == g && ddpf.BBitMask == b && ddpf.ABitMask == a )
-
-static DXGI_FORMAT GetDXGIFormat( const DDS_PIXELFORMAT& ddpf )
-{
-    if (ddpf.flags & DDS_RGB)
-    {
-        // Note that sRGB formats are written using the "DX10" extended header
-
-        switch (ddpf.RGBBitCount)
-        {
-        case 32:
-            if (ISBITMASK(0x000000ff,0x0000ff00,0x00ff0000,0xff000000))
-            {
-                return DXGI_FORMAT_R8G8B8A8_UNORM;
-            }
-
-            if (ISBITMASK(0x00ff0000,0x0000ff00,0x000000ff,0xff000000))
-            {
-                return DXGI_FORMAT_B8G8R8A8_UNORM;
-            }
-
-            if (ISBITMASK(0x00ff0000,0x0000ff00,0x000000ff,0x00000000))
-            {
-                return DXGI_FORMAT_B8G8R8X8_UNORM;
-            }
-
-            // No DXGI format maps to ISBITMASK(0x000000ff,0x0000ff00,0x00ff0000,0x00000000) aka D3DFMT_X8B8G8R8
-
-            // Note that many common DDS reader/writers (including D3DX) swap the
-            // the RED/BLUE masks for 10:10:10:2 formats. We assume
-            // below that the 'backwards' header mask is being used since it is most
-            // likely written by D3DX. The more robust solution is to use the 'DX10'
-            // header extension and specify the DXGI_FORMAT_R10G10B10A2_UNORM format directly
-
-            // For 'correct' writers, this should be 0x000003ff,0x000ffc00,0x3ff00000 for RGB data
-            if (ISBITMASK(0x3ff00000,0x000ffc00,0x000003ff,0xc0000000))
-            {
-                return DXGI_FORMAT_R10G10B10A2_UNORM;
-            }
-
-            // No DXGI format maps to ISBITMASK(0x000003ff,0x000ffc00,0x3ff00000,0xc0000000) aka D3DFMT_A2R10G10B10
-
-            if (ISBITMASK(0x0000ffff,0xffff0000,0x00000000,0x00000000))
-            {
-                return DXGI_FORMAT_R16G16_UNORM;
-            }
-
-            if (ISBITMASK(0xffffffff,0x00000000,0x00000000,0x00000000))
-            {
-                // Only 32-bit color channel format in D3D9 was R32F
-                return DXGI_FORMAT_R32_FLOAT; // D3DX writes this out as a FourCC of 114
-            }
-            break;
-
-        case 24:
-            // No 24bpp DXGI formats aka D3DFMT_R8G8B8
-            break;
-
-        case 16:
-            if (ISBITMASK(0x7c00,0x03e0,0x001f,0x8000))
-            {
-                return DXGI_FORMAT_B5G5R5A1_UNORM;
-            }
-            if (ISBITMASK(0xf800,0x07e0,0x001f,0x0000))
-            {
-                return DXGI_FORMAT_B5G6R5_UNORM;
-            }
-
-            // No DXGI format maps to ISBITMASK(0x7c00,0x03e0,0x001f,0x0000) aka D3DFMT_X1R5G5B5
-
-            if (ISBITMASK(0x0f00,0x00f0,0x000f,0xf000))
-            {
-                return DXGI_FORMAT_B4G4R4A4_UNORM;
-            }
-
-            // No DXGI format maps to ISBITMASK(0x0f00,0x00f0,0x000f,0x0000) aka D3DFMT_X4R4G4B4
-
-            // No 3:3:2, 3:3:2:8, or paletted DXGI formats aka D3DFMT_A8R3G3B2, D3DFMT_R3G3B2, D3DFMT_P8, D3DFMT_A8P8, etc.
-            break;
-        }
-    }
-    else if (ddpf.flags & DDS_LUMINANCE)
-    {
-        if (8 == ddpf.RGBBitCount)
-        {
-            if (ISBITMASK(0x000000ff,0x00000000,0x00000000,0x00000000))
-            {
-                return DXGI_FORMAT_R8_UNORM; // D3DX10/11 writes this out as DX10 extension
-            }
-
-            // No DXGI format maps to ISBITMASK(0x0f,0x00,0x00,0xf0) aka D3DFMT_A4L4
-        }
-
-        if (16 == ddpf.RGBBitCount)
-        {
-            if (ISBITMASK(0x0000ffff,0x00000000,0x00000000,0x00000000))
-            {
-                return DXGI_FORMAT_R16_UNORM; // D3DX10/11 writes this out as DX10 extension
-            }
-            if (ISBITMASK(0x000000ff,0x00000000,0x00000000,0x0000ff00))
-            {
-                return DXGI_FORMAT_R8G8_UNORM; // D3DX10/11 writes this out as DX10 extension
-            }
-        }
-    }
-    else if (ddpf.flags & DDS_ALPHA)
-    {
-        if (8 == ddpf.RGBBitCount)
-        {
-            return DXGI_FORMAT_A8_UNORM;
-        }
-    }
-    else if (ddpf.flags & DDS_FOURCC)
-    {
-        if (MAKEFOURCC( 'D', 'X', 'T', '1' ) == ddpf.fourCC)
-        {
-            return DXGI_FORMAT_BC1_UNORM;
-        }
-        if (MAKEFOURCC( 'D', 'X', 'T', '3' ) == ddpf.fourCC)
-        {
-            return DXGI_FORMAT_BC2_UNORM;
-        }
-        if (MAKEFOURCC( 'D', 'X', 'T', '5' ) == ddpf.fourCC)
-        {
-            return DXGI_FORMAT_BC3_UNORM;
-        }
-
-        // While pre-multiplied alpha isn't directly supported by the DXGI formats,
-        // they are basically the same as these BC formats so they can be mapped
-        if (MAKEFOURCC( 'D', 'X', 'T', '2' ) == ddpf.fourCC)
-        {
-            return DXGI_FORMAT_BC2_UNORM;
-        }
-        if (MAKEFOURCC( 'D', 'X', 'T', '4' ) == ddpf.fourCC)
-        {
-            return DXGI_FORMAT_BC3_UNORM;
-        }
-
-        if (MAKEFOURCC( 'A', 'T', 'I', '1' ) == ddpf.fourCC)
-        {
-            return DXGI_FORMAT_BC4_UNORM;
-        }
-        if (MAKEFOURCC( 'B', 'C', '4', 'U' ) == ddpf.fourCC)
-        {
-            return DXGI_FORMAT_BC4_UNORM;
-        }
-        if (MAKEFOURCC( 'B', 'C', '4', 'S' ) == ddpf.fourCC)
-        {
-            return DXGI_FORMAT_BC4_SNORM;
-        }
-
-        if (MAKEFOURCC( 'A', 'T', 'I', '2' ) == ddpf.fourCC)
-        {
-            return DXGI_FORMAT_BC5_UNORM;
-        }
-        if (MAKEFOURCC( 'B', 'C', '5', 'U' ) == ddpf.fourCC)
-        {
-            return DXGI_FORMAT_BC5_UNORM;
-        }
-        if (MAKEFOURCC( 'B', 'C', '5', 'S' ) == ddpf.fourCC)
-        {
-            return DXGI_FORMAT_BC5_SNORM;
-        }
-
-        // BC6H and BC7 are written using the "DX10" extended header
-
-        if (MAKEFOURCC( 'R', 'G', 'B', 'G' ) == ddpf.fourCC)
-        {
-            return DXGI_FORMAT_R8G8_B8G8_UNORM;
-        }
-        if (MAKEFOURCC( 'G', 'R', 'G', 'B' ) == ddpf.fourCC)
-        {
-            return DXGI_FORMAT_G8R8_G8B8_UNORM;
-        }
-
-        if (MAKEFOURCC('Y','U','Y','2') == ddpf.fourCC)
-        {
-            return DXGI_FORMAT_YUY2;
-        }
-
-        // Check for D3DFORMAT enums being set here
-        switch( ddpf.fourCC )
-        {
-        case 36: // D3DFMT_A16B16G16R16
-            return DXGI_FORMAT_R16G16B16A16_UNORM;
-
-        case 110: // D3DFMT_Q16W16V16U16
-            return DXGI_FORMAT_R16G16B16A16_SNORM;
-
-        case 111: // D3DFMT_R16F
-            return DXGI_FORMAT_R16_FLOAT;
-
-        case 112: // D3DFMT_G16R16F
-            return DXGI_FORMAT_R16G16_FLOAT;
-
-        case 113: // D3DFMT_A16B16G16R16F
-            return DXGI_FORMAT_R16G16B16A16_FLOAT;
-
-        case 114: // D3DFMT_R32F
-            return DXGI_FORMAT_R32_FLOAT;
-
-        case 115: // D3DFMT_G32R32F
-            return DXGI_FORMAT_R32G32_FLOAT;
-
-        case 116: // D3DFMT_A32B32G32R32F
-            return DXGI_FORMAT_R32G32B32A32_FLOAT;
-        }
-    }
-
-    return DXGI_FORMAT_UNKNOWN;
-}
-
-
 //--------------------------------------------------------------------------------------
 static DXGI_FORMAT MakeSRGB( _In_ DXGI_FORMAT format )
 {
@@ -836,7 +182,7 @@ static HRESULT FillInitData( _In_ size_t width,
         size_t d = depth;
         for( size_t i = 0; i < mipCount; i++ )
         {
-            GetSurfaceInfo( w,
+            DDSFormat::GetSurfaceInfo( w,
                             h,
                             format,
                             &NumBytes,
@@ -894,23 +240,19 @@ static HRESULT FillInitData( _In_ size_t width,
     return (index > 0) ? S_OK : E_FAIL;
 }
 
-static HRESULT FillInitData12(_In_ size_t width,
-	_In_ size_t height,
-	_In_ size_t depth,
+static HRESULT FillInitData12(
+	_In_ const std::vector<DDSSubresourceLayout>& layouts,
 	_In_ size_t mipCount,
-	_In_ size_t arraySize,
-	_In_ DXGI_FORMAT format,
 	_In_ size_t maxsize,
-	_In_ size_t bitSize,
-	_In_reads_bytes_(bitSize) const uint8_t* bitData,
+	_In_ const uint8_t* bitData,
 	_Out_ size_t& twidth,
 	_Out_ size_t& theight,
 	_Out_ size_t& tdepth,
 	_Out_ size_t& skipMip,
-	_Out_writes_(mipCount*arraySize) D3D12_SUBRESOURCE_DATA* initData
+	_Out_writes_(layouts.size()) D3D12_SUBRESOURCE_DATA* initData
 	)
 {
-	if (!bitData || !initData)
+	if (!bitData || !initData || mipCount == 0)
 	{
 		return E_POINTER;
 	}
@@ -920,75 +262,82 @@ static HRESULT FillInitData12(_In_ size_t width,
 	theight = 0;
 	tdepth = 0;
 
-	size_t NumBytes = 0;
-	size_t RowBytes = 0;
-	const uint8_t* pSrcBits = bitData;
-	const uint8_t* pEndBits = bitData + bitSize;
-
+	// 子资源的位置与大小已经由DDSFormat::ComputeLayout检查过，这里不再做指针运算
 	size_t index = 0;
-	for (size_t j = 0; j < arraySize; j++)
+	for (size_t i = 0; i < layouts.size(); i++)
 	{
-		size_t w = width;
-		size_t h = height;
-		size_t d = depth;
-		for (size_t i = 0; i < mipCount; i++)
-		{
-			GetSurfaceInfo(w,
-				h,
-				format,
-				&NumBytes,
-				&RowBytes,
-				nullptr
-				);
+		const DDSSubresourceLayout& layout = layouts[i];
 
-			if ((mipCount <= 1) || !maxsize || (w <= maxsize && h <= maxsize && d <= maxsize))
-			{
-				if (!twidth)
-				{
-					twidth = w;
-					theight = h;
-					tdepth = d;
-				}
-
-				assert(index < mipCount * arraySize);
-				_Analysis_assume_(index < mipCount * arraySize);
-				initData[index]./*pSysMem*/pData = (const void*)pSrcBits;
-				initData[index]./*SysMemPitch*/RowPitch = static_cast<UINT>(RowBytes);
-				initData[index]./*SysMemSlicePitch*/SlicePitch = static_cast<UINT>(NumBytes);
-				++index;
-			}
-			else if (!j)
+		if ((mipCount <= 1) || !maxsize ||
+			(layout.Width <= maxsize && layout.Height <= maxsize && layout.Depth <= maxsize))
+		{
+			if (!twidth)
 			{
-				// Count number of skipped mipmaps (first item only)
-				++skipMip;
+				twidth = layout.Width;
+				theight = layout.Height;
+				tdepth = layout.Depth;
 			}
 
-			if (pSrcBits + (NumBytes*d) > pEndBits)
-			{
-				return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
-			}
+			initData[index].pData = bitData + layout.Offset;
+			initData[index].RowPitch = static_cast<LONG_PTR>(layout.RowPitch);
+			initData[index].SlicePitch = static_cast<LONG_PTR>(layout.SlicePitch);
+			++index;
+		}
+		else if (i < mipCount)
+		{
+			// Count number of skipped mipmaps (first item only)
+			++skipMip;
+		}
+	}
 
-			pSrcBits += NumBytes * d;
+	return (index > 0) ? S_OK : E_FAIL;
+}
 
-			w = w >> 1;
-			h = h >> 1;
-			d = d >> 1;
-			if (w == 0)
-			{
-				w = 1;
-			}
-			if (h == 0)
-			{
-				h = 1;
-			}
-			if (d == 0)
-			{
-				d = 1;
-			}
+//--------------------------------------------------------------------------------------
+// 文件中只有一级时在CPU端生成完整的mip链
+// 结果按DDS文件的布局排列(每个数组切片的所有mip依次存放)，之后可以直接交给FillInitData12处理
+static HRESULT GenerateMipChain12(_In_ size_t width,
+	_In_ size_t height,
+	_In_ size_t arraySize,
+	_In_ DXGI_FORMAT format,
+	_In_ size_t bitSize,
+	_In_reads_bytes_(bitSize) const uint8_t* bitData,
+	_Out_ std::vector<uint8_t>& mipData,
+	_Out_ size_t& mipCount
+	)
+{
+	mipData.clear();
+	mipCount = 0;
+
+	size_t numBytes = 0;
+	size_t rowBytes = 0;
+	DDSFormat::GetSurfaceInfo(width, height, format, &numBytes, &rowBytes, nullptr);
+	if (numBytes == 0 || bitSize / numBytes < arraySize)
+	{
+		return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+	}
+
+	for (size_t slice = 0; slice < arraySize; ++slice)
+	{
+		std::vector<MipLevel> levels = MipGenerator::Generate(
+			bitData + slice * numBytes,
+			static_cast<uint32_t>(width),
+			static_cast<uint32_t>(height),
+			rowBytes,
+			format);
+		if (levels.empty())
+		{
+			return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+		}
+
+		mipCount = levels.size();
+		for (const auto& level : levels)
+		{
+			mipData.insert(mipData.end(), level.Pixels.begin(), level.Pixels.end());
 		}
 	}
 
-	return (index > 0) ? S_OK : E_FAIL;
+	return S_OK;
 }
 
 //--------------------------------------------------------------------------------------
@@ -1302,14 +651,23 @@ static HRESULT CreateD3DResources12(
 			}
 			else
 			{
-				cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(),
-					D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST));
+				//在复制队列上录制时不做状态转换：纹理在COMMON状态下复制，之后由graphics队列隐式提升为PIXEL_SHADER_RESOURCE
+				const bool copyQueue = cmdList->GetType() == D3D12_COMMAND_LIST_TYPE_COPY;
+
+				if (!copyQueue)
+				{
+					cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(),
+						D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST));
+				}
 
 				// Use Heap-allocating UpdateSubresources implementation for variable number of subresources (which is the case for textures).
 				UpdateSubresources(cmdList, texture.Get(), textureUploadHeap.Get(), 0, 0, num2DSubresources, initData);
 
-				cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(),
-					D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+				if (!copyQueue)
+				{
+					cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(),
+						D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+				}
 			}
 		}
 	} break;
@@ -1371,7 +729,7 @@ static HRESULT CreateTextureFromDDS( _In_ ID3D11Device* d3dDevice,
             return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
 
         default:
-            if ( BitsPerPixel( d3d10ext->dxgiFormat ) == 0 )
+            if ( DDSFormat::BitsPerPixel( d3d10ext->dxgiFormat ) == 0 )
             {
                 return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
             }
@@ -1419,7 +777,7 @@ static HRESULT CreateTextureFromDDS( _In_ ID3D11Device* d3dDevice,
     }
     else
     {
-        format = GetDXGIFormat( header->ddspf );
+        format = DDSFormat::GetDXGIFormat( header->ddspf );
 
         if (format == DXGI_FORMAT_UNKNOWN)
         {
@@ -1450,7 +808,7 @@ static HRESULT CreateTextureFromDDS( _In_ ID3D11Device* d3dDevice,
             // Note there's no way for a legacy Direct3D 9 DDS to express a '1D' texture
         }
 
-        assert( BitsPerPixel( format ) != 0 );
+        assert( DDSFormat::BitsPerPixel( format ) != 0 );
     }
 
     // Bound sizes (for security purposes we don't trust DDS file metadata larger than the D3D 11.x hardware requirements)
@@ -1533,7 +891,7 @@ static HRESULT CreateTextureFromDDS( _In_ ID3D11Device* d3dDevice,
         {
             size_t numBytes = 0;
             size_t rowBytes = 0;
-            GetSurfaceInfo( width, height, format, &numBytes, &rowBytes, nullptr );
+            DDSFormat::GetSurfaceInfo( width, height, format, &numBytes, &rowBytes, nullptr );
 
             if ( numBytes > bitSize )
             {
@@ -1672,172 +1030,95 @@ static HRESULT CreateTextureFromDDS( _In_ ID3D11Device* d3dDevice,
 static HRESULT CreateTextureFromDDS12(
 	_In_ ID3D12Device* device,
 	_In_opt_ ID3D12GraphicsCommandList* cmdList,
+	_In_opt_z_ const wchar_t* fileName,
 	_In_ const DDS_HEADER* header,
 	_In_reads_bytes_(bitSize) const uint8_t* bitData,
 	_In_ size_t bitSize,
 	_In_ size_t maxsize,
 	_In_ bool forceSRGB,
+	_In_ bool generateMips,
 	ComPtr<ID3D12Resource>& texture,
 	ComPtr<ID3D12Resource>& textureUploadHeap)
 {
 	HRESULT hr = S_OK;
 
-	UINT width = header->width;
-	UINT height = header->height;
-	UINT depth = header->depth;
-
-	uint32_t resDim = D3D12_RESOURCE_DIMENSION_UNKNOWN;
-	UINT arraySize = 1;
-	DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
-	bool isCubeMap = false;
-
-	size_t mipCount = header->mipMapCount;
-	if (0 == mipCount) mipCount = 1;
-
-	if ((header->ddspf.flags & DDS_FOURCC) && (MAKEFOURCC('D', 'X', '1', '0') == header->ddspf.fourCC))
+	// 没有对应DXGI格式的旧格式(24位RGB、4位格式等)先转码为带DX10扩展头的DDS数据再创建纹理
+	// 从文件加载时转码结果按文件的路径、大小与修改时间缓存，从内存加载时每次都重新转码
+	const bool isDXT10Header = (header->ddspf.flags & DDS_FOURCC) &&
+		(MAKEFOURCC('D', 'X', '1', '0') == header->ddspf.fourCC);
+	if (!isDXT10Header &&
+		DDSFormat::GetDXGIFormat(header->ddspf) == DXGI_FORMAT_UNKNOWN &&
+		DDSTranscoder::GetTranscodedFormat(header->ddspf) != DXGI_FORMAT_UNKNOWN)
 	{
-		auto d3d10ext = reinterpret_cast<const DDS_HEADER_DXT10*>((const char*)header + sizeof(DDS_HEADER));
-
-		arraySize = d3d10ext->arraySize;
-		if (arraySize == 0)
+		DDSTranscodeResult transcoded;
+		if (!DDSTranscoder::TranscodeCached(GetTranscodeCacheDirectory(), fileName ? fileName : L"",
+			*header, bitData, bitSize, transcoded))
 			return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
 
-		switch (d3d10ext->dxgiFormat)
-		{
-		case DXGI_FORMAT_AI44:
-		case DXGI_FORMAT_IA44:
-		case DXGI_FORMAT_P8:
-		case DXGI_FORMAT_A8P8:
-			return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
-
-		default:
-			if (BitsPerPixel(d3d10ext->dxgiFormat) == 0)
-				return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
-		}
-
-		format = d3d10ext->dxgiFormat;
-
-		switch (d3d10ext->resourceDimension)
-		{
-		case D3D11_RESOURCE_DIMENSION_TEXTURE1D:
-			if ((header->flags & DDS_HEIGHT) && height != 1)
-				return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
-			height = depth = 1;
-			break;
-
-		case D3D11_RESOURCE_DIMENSION_TEXTURE2D:
-			if (d3d10ext->miscFlag & D3D11_RESOURCE_MISC_TEXTURECUBE)
-			{
-				arraySize *= 6;
-				isCubeMap = true;
-			}
-			depth = 1;
-			break;
-
-		case D3D11_RESOURCE_DIMENSION_TEXTURE3D:
-			if (!(header->flags & DDS_HEADER_FLAGS_VOLUME))
-				return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
-			if (arraySize > 1)
-				return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
-			break;
-
-		default:
-			return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
-		}
+		const DDS_HEADER* transcodedHeader = nullptr;
+		size_t offset = 0;
+		if (!DDSFormat::ParseHeader(transcoded.GetData(), transcoded.GetSize(), &transcodedHeader, &offset))
+			return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
 
-		switch (d3d10ext->resourceDimension)
-		{
-		case D3D11_RESOURCE_DIMENSION_TEXTURE1D:
-			resDim = D3D12_RESOURCE_DIMENSION_TEXTURE1D;
-			break;
-		case D3D11_RESOURCE_DIMENSION_TEXTURE2D:
-			resDim = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
-			break;
-		case D3D11_RESOURCE_DIMENSION_TEXTURE3D:
-			resDim = D3D12_RESOURCE_DIMENSION_TEXTURE3D;
-			break;
-		}
+		return CreateTextureFromDDS12(device, cmdList, nullptr, transcodedHeader,
+			transcoded.GetData() + offset, transcoded.GetSize() - offset,
+			maxsize, forceSRGB, generateMips, texture, textureUploadHeap);
 	}
-	else
-	{
-		format = GetDXGIFormat(header->ddspf);
-
-		if (format == DXGI_FORMAT_UNKNOWN)
-			return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
 
-		if (header->flags & DDS_HEADER_FLAGS_VOLUME)
-		{
-			resDim = D3D12_RESOURCE_DIMENSION_TEXTURE3D;
-		}
-		else
-		{
-			if (header->caps2 & DDS_CUBEMAP)
-			{
-				if ((header->caps2 & DDS_CUBEMAP_ALLFACES) != DDS_CUBEMAP_ALLFACES)
-					return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
-				arraySize = 6;
-				isCubeMap = true;
-			}
-
-			depth = 1;
-			resDim = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
-		}
+	// 文件头的解析与尺寸限制检查由DDSFormat完成
+	DDSTextureDesc desc;
+	switch (DDSFormat::GetTextureDesc(header, desc))
+	{
+	case DDSParseResult::Ok:
+		break;
 
-		assert(BitsPerPixel(format) != 0);
-	}
+	case DDSParseResult::InvalidData:
+		return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
 
-	// Bound sizes (for security purposes we don't trust DDS file metadata larger than the D3D 11.x hardware requirements)
-	if (mipCount > D3D12_REQ_MIP_LEVELS)
-	{
+	default:
 		return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
 	}
 
-	switch (resDim)
+	uint32_t resDim = D3D12_RESOURCE_DIMENSION_UNKNOWN;
+	switch (desc.Dimension)
 	{
-	case D3D12_RESOURCE_DIMENSION_TEXTURE1D:
-		if ((arraySize > D3D12_REQ_TEXTURE1D_ARRAY_AXIS_DIMENSION) ||
-			(width > D3D12_REQ_TEXTURE1D_U_DIMENSION))
-		{
-			return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
-		}
+	case DDS_DIMENSION_TEXTURE1D:
+		resDim = D3D12_RESOURCE_DIMENSION_TEXTURE1D;
 		break;
-
-	case D3D12_RESOURCE_DIMENSION_TEXTURE2D:
-		if (isCubeMap)
-		{
-			// This is the right bound because we set arraySize to (NumCubes*6) above
-			if ((arraySize > D3D12_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION) ||
-				(width > D3D12_REQ_TEXTURECUBE_DIMENSION) ||
-				(height > D3D12_REQ_TEXTURECUBE_DIMENSION))
-			{
-				return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
-			}
-		}
-		else if ((arraySize > D3D12_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION) ||
-			(width > D3D12_REQ_TEXTURE2D_U_OR_V_DIMENSION) ||
-			(height > D3D12_REQ_TEXTURE2D_U_OR_V_DIMENSION))
-		{
-			return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
-		}
+	case DDS_DIMENSION_TEXTURE2D:
+		resDim = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
 		break;
+	case DDS_DIMENSION_TEXTURE3D:
+		resDim = D3D12_RESOURCE_DIMENSION_TEXTURE3D;
+		break;
+	}
 
-	case D3D12_RESOURCE_DIMENSION_TEXTURE3D:
-		if ((arraySize > 1) ||
-			(width > D3D12_REQ_TEXTURE3D_U_V_OR_W_DIMENSION) ||
-			(height > D3D12_REQ_TEXTURE3D_U_V_OR_W_DIMENSION) ||
-			(depth > D3D12_REQ_TEXTURE3D_U_V_OR_W_DIMENSION))
+	// D3D12没有GenerateMips，文件中缺少mip链时在CPU端生成，避免缩小采样时纹理缓存命中率过低
+	std::vector<uint8_t> generatedBits;
+	if (generateMips && desc.MipCount == 1 &&
+		resDim == D3D12_RESOURCE_DIMENSION_TEXTURE2D &&
+		MipGenerator::IsSupportedFormat(desc.Format))
+	{
+		size_t mipCount = 0;
+		hr = GenerateMipChain12(desc.Width, desc.Height, desc.ArraySize, desc.Format, bitSize, bitData, generatedBits, mipCount);
+		if (FAILED(hr))
 		{
-			return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+			return hr;
 		}
-		break;
+		desc.MipCount = static_cast<uint32_t>(mipCount);
+		bitData = generatedBits.data();
+		bitSize = generatedBits.size();
+	}
 
-	default:
-		return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+	std::vector<DDSSubresourceLayout> layouts;
+	if (!DDSFormat::ComputeLayout(desc, bitSize, layouts))
+	{
+		return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
 	}
 
 	// Create the texture
 	std::unique_ptr<D3D12_SUBRESOURCE_DATA[]> initData(
-		new (std::nothrow) D3D12_SUBRESOURCE_DATA[mipCount * arraySize]
+		new (std::nothrow) D3D12_SUBRESOURCE_DATA[layouts.size()]
 		);
 
 	if (!initData)
@@ -1851,7 +1132,7 @@ static HRESULT CreateTextureFromDDS12(
 	size_t tdepth = 0;
 
 	hr = FillInitData12(
-		width, height, depth, mipCount, arraySize, format, maxsize, bitSize, bitData,
+		layouts, desc.MipCount, maxsize, bitData,
 		twidth, theight, tdepth, skipMip, initData.get()
 		);
 
@@ -1860,11 +1141,11 @@ static HRESULT CreateTextureFromDDS12(
 		hr = CreateD3DResources12(
 			device, cmdList,
 			resDim, twidth, theight, tdepth,
-			mipCount - skipMip,
-			arraySize,
-			format,
-			false, // forceSRGB
-			isCubeMap,
+			desc.MipCount - skipMip,
+			desc.ArraySize,
+			desc.Format,
+			forceSRGB,
+			desc.IsCubeMap,
 			initData.get(),
 			texture, 
 			textureUploadHeap);
@@ -1917,6 +1198,12 @@ HRESULT DirectX::CreateDDSTextureFromMemory( ID3D11Device* d3dDevice,
                                          texture, textureView, alphaMode );
 }
 
+void DirectX::SetDDSTranscodeCacheDirectory(const wchar_t* cacheDir)
+{
+	std::lock_guard<std::mutex> lock(g_transcodeCacheMutex);
+	g_transcodeCacheDir = cacheDir ? cacheDir : L"";
+}
+
 _Use_decl_annotations_
 HRESULT DirectX::CreateDDSTextureFromMemory12(
 	ID3D12Device* device,
@@ -1926,7 +1213,8 @@ HRESULT DirectX::CreateDDSTextureFromMemory12(
 	ComPtr<ID3D12Resource>& texture,
 	ComPtr<ID3D12Resource>& textureUploadHeap,
 	_In_ size_t maxsize,
-	_Out_opt_ DDS_ALPHA_MODE* alphaMode
+	_Out_opt_ DDS_ALPHA_MODE* alphaMode,
+	_In_ bool generateMips
 	)
 {
 	if (alphaMode)
@@ -1937,47 +1225,24 @@ HRESULT DirectX::CreateDDSTextureFromMemory12(
 		return E_INVALIDARG;
 	}
 
-	uint32_t dwMagicNumber = *(const uint32_t*)(ddsData);
-	if (dwMagicNumber != DDS_MAGIC)
+	// 先确认数据长度足够再读取magic与文件头
+	const DDS_HEADER* header = nullptr;
+	size_t offset = 0;
+	if (!DDSFormat::ParseHeader(ddsData, ddsDataSize, &header, &offset))
 	{
 		return E_FAIL;
 	}
 
-	auto header = reinterpret_cast<const DDS_HEADER*>(ddsData + sizeof(uint32_t));
-
-	// Verify header to validate DDS file
-	if (header->size != sizeof(DDS_HEADER) ||
-		header->ddspf.size != sizeof(DDS_PIXELFORMAT))
-	{
-		return E_FAIL;
-	}
-
-	// Check for DX10 extension
-	bool bDXT10Header = false;
-	if ((header->ddspf.flags & DDS_FOURCC) &&
-		(MAKEFOURCC('D', 'X', '1', '0') == header->ddspf.fourCC))
-	{
-		// Must be long enough for both headers and magic value
-		if (ddsDataSize < (sizeof(DDS_HEADER) + sizeof(uint32_t) + sizeof(DDS_HEADER_DXT10)))
-		{
-			return E_FAIL;
-		}
-
-		bDXT10Header = true;
-	}
-
-	ptrdiff_t offset = sizeof(uint32_t)
-		+ sizeof(DDS_HEADER)
-		+ (bDXT10Header ? sizeof(DDS_HEADER_DXT10) : 0);
-
 	HRESULT hr = CreateTextureFromDDS12(
 		device,
 		cmdList,
+		nullptr,
 		header,
 		ddsData + offset,
 		ddsDataSize - offset,
 		maxsize,
 		false,
+		generateMips,
 		texture,
 		textureUploadHeap
 		);
@@ -2140,7 +1405,8 @@ HRESULT DirectX::CreateDDSTextureFromFile12(_In_ ID3D12Device* device,
 	_Out_ ComPtr<ID3D12Resource>& texture,
 	_Out_ ComPtr<ID3D12Resource>& textureUploadHeap,
 	_In_ size_t maxsize,
-	_Out_opt_ DDS_ALPHA_MODE* alphaMode)
+	_Out_opt_ DDS_ALPHA_MODE* alphaMode,
+	_In_ bool generateMips)
 {
 	if (texture)
 	{
@@ -2160,19 +1426,19 @@ HRESULT DirectX::CreateDDSTextureFromFile12(_In_ ID3D12Device* device,
 		return E_INVALIDARG;
 	}
 
-	DDS_HEADER* header = nullptr;
-	uint8_t* bitData = nullptr;
+	const DDS_HEADER* header = nullptr;
+	const uint8_t* bitData = nullptr;
 	size_t bitSize = 0;
 
-	std::unique_ptr<uint8_t[]> ddsData;
-	HRESULT hr = LoadTextureDataFromFile(szFileName, ddsData, &header, &bitData, &bitSize);
+	MappedFile ddsFile;
+	HRESULT hr = LoadTextureDataFromFile(szFileName, ddsFile, &header, &bitData, &bitSize);
 	if (FAILED(hr))
 	{
 		return hr;
 	}
 
-	hr = CreateTextureFromDDS12(device, cmdList, header,
-		bitData, bitSize, maxsize, false, texture, textureUploadHeap);
+	hr = CreateTextureFromDDS12(device, cmdList, szFileName, header,
+		bitData, bitSize, maxsize, false, generateMips, texture, textureUploadHeap);
 
 	if (SUCCEEDED(hr))
 	{
@@ -2292,13 +1558,13 @@ HRESULT DirectX::CreateDDSTextureFromFileEx( ID3D11Device* d3dDevice,
         return E_INVALIDARG;
     }
 
-    DDS_HEADER* header = nullptr;
-    uint8_t* bitData = nullptr;
+    const DDS_HEADER* header = nullptr;
+    const uint8_t* bitData = nullptr;
     size_t bitSize = 0;
 
-    std::unique_ptr<uint8_t[]> ddsData;
+    MappedFile ddsFile;
     HRESULT hr = LoadTextureDataFromFile( fileName,
-                                          ddsData,
+                                          ddsFile,
                                           &header,
                                           &bitData,
                                           &bitSize
@@ -65,6 +65,11 @@ namespace DirectX
                                         _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
                                       );
 
+	// 设置旧格式DDS(24位RGB、A4L4等)转码结果的磁盘缓存目录，传入nullptr关闭缓存
+	// 可以与加载纹理的线程并发调用，正在进行的加载仍使用调用前的目录
+	void SetDDSTranscodeCacheDirectory(_In_opt_z_ const wchar_t* cacheDir);
+
+	// generateMips为true且文件中只有一级时，在CPU端为非压缩的2D纹理(含数组与立方体贴图)生成完整的mip链
 	HRESULT CreateDDSTextureFromMemory12(_In_ ID3D12Device* device,
 		                                 _In_ ID3D12GraphicsCommandList* cmdList,
 		                                 _In_reads_bytes_(ddsDataSize) const uint8_t* ddsData,
@@ -72,7 +77,8 @@ namespace DirectX
 		                                 _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
 		                                 _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& textureUploadHeap,
 		                                 _In_ size_t maxsize = 0,
-		                                 _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
+		                                 _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr,
+		                                 _In_ bool generateMips = false
 		                                 );
 
     HRESULT CreateDDSTextureFromFile( _In_ ID3D11Device* d3dDevice,
@@ -89,7 +95,8 @@ namespace DirectX
 		                               _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
 		                               _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& textureUploadHeap,
 		                               _In_ size_t maxsize = 0,
-		                               _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
+		                               _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr,
+		                               _In_ bool generateMips = false
 		                               );
 
     // Standard version with optional auto-gen mipmap support
@@ -0,0 +1,371 @@
+#include "DDSTranscoder.h"
+#include "DDSFormat.h"
+#include "FileUtil.h"
+#include "Hash.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    //转码结果的格式有变化时需要修改版本号，使旧的缓存文件失效
+    const uint64_t TranscoderVersion = 1;
+
+    //并行处理时每个任务负责的行数
+    const size_t RowsPerTask = 64;
+
+    enum class Conversion
+    {
+        ExpandUNorm8,   //按掩码把每个通道展开为8位
+        SetAlpha16,     //16位格式中未使用的X位填充为不透明的alpha
+        SwapRB1010102   //交换10:10:10:2格式的R与B通道
+    };
+
+    struct LegacyFormat
+    {
+        uint32_t Flags;
+        uint32_t BitCount;
+        uint32_t RMask;
+        uint32_t GMask;
+        uint32_t BMask;
+        uint32_t AMask;
+        DXGI_FORMAT Format;
+        Conversion Conv;
+    };
+
+    //GetDXGIFormat无法映射的旧格式
+    const LegacyFormat LegacyFormats[] =
+    {
+        // D3DFMT_R8G8B8
+        { DDS_RGB, 24, 0x00ff0000, 0x0000ff00, 0x000000ff, 0x00000000, DXGI_FORMAT_R8G8B8A8_UNORM, Conversion::ExpandUNorm8 },
+        // D3DFMT_X8B8G8R8
+        { DDS_RGB, 32, 0x000000ff, 0x0000ff00, 0x00ff0000, 0x00000000, DXGI_FORMAT_R8G8B8A8_UNORM, Conversion::ExpandUNorm8 },
+        // D3DFMT_A2R10G10B10，与GetDXGIFormat一样假定文件由D3DX写出，R与B的掩码是反的
+        { DDS_RGB, 32, 0x000003ff, 0x000ffc00, 0x3ff00000, 0xc0000000, DXGI_FORMAT_R10G10B10A2_UNORM, Conversion::SwapRB1010102 },
+        // D3DFMT_X1R5G5B5
+        { DDS_RGB, 16, 0x00007c00, 0x000003e0, 0x0000001f, 0x00000000, DXGI_FORMAT_B5G5R5A1_UNORM, Conversion::SetAlpha16 },
+        // D3DFMT_X4R4G4B4
+        { DDS_RGB, 16, 0x00000f00, 0x000000f0, 0x0000000f, 0x00000000, DXGI_FORMAT_B4G4R4A4_UNORM, Conversion::SetAlpha16 },
+        // D3DFMT_R3G3B2
+        { DDS_RGB, 8, 0x000000e0, 0x0000001c, 0x00000003, 0x00000000, DXGI_FORMAT_R8G8B8A8_UNORM, Conversion::ExpandUNorm8 },
+        // D3DFMT_A8R3G3B2
+        { DDS_RGB, 16, 0x000000e0, 0x0000001c, 0x00000003, 0x0000ff00, DXGI_FORMAT_R8G8B8A8_UNORM, Conversion::ExpandUNorm8 },
+        // D3DFMT_A4L4，与A8L8一样转为R8G8(亮度在R，alpha在G)
+        { DDS_LUMINANCE, 8, 0x0000000f, 0x00000000, 0x00000000, 0x000000f0, DXGI_FORMAT_R8G8_UNORM, Conversion::ExpandUNorm8 },
+    };
+
+    const LegacyFormat* FindLegacyFormat(const DDS_PIXELFORMAT& ddpf)
+    {
+        if (ddpf.flags & DDS_FOURCC)
+        {
+            return nullptr;
+        }
+
+        for (const LegacyFormat& legacy : LegacyFormats)
+        {
+            if ((ddpf.flags & legacy.Flags) &&
+                ddpf.RGBBitCount == legacy.BitCount &&
+                ddpf.RBitMask == legacy.RMask &&
+                ddpf.GBitMask == legacy.GMask &&
+                ddpf.BBitMask == legacy.BMask &&
+                ddpf.ABitMask == legacy.AMask)
+            {
+                return &legacy;
+            }
+        }
+        return nullptr;
+    }
+
+    //把掩码描述的一个通道展开为8位，使用查找表避免逐像素的除法
+    struct ChannelExpander
+    {
+        uint32_t Mask = 0;
+        uint32_t Shift = 0;
+        uint8_t Table[256];
+
+        void Init(uint32_t mask)
+        {
+            Mask = mask;
+            Shift = 0;
+            if (mask == 0)
+            {
+                //通道不存在时展开为255(alpha不透明)
+                memset(Table, 255, sizeof(Table));
+                return;
+            }
+
+            while (((mask >> Shift) & 1) == 0)
+            {
+                ++Shift;
+            }
+            const uint32_t maxValue = std::min<uint32_t>(mask >> Shift, 255);
+            for (uint32_t v = 0; v < 256; ++v)
+            {
+                Table[v] = static_cast<uint8_t>((std::min(v, maxValue) * 255 + maxValue / 2) / maxValue);
+            }
+        }
+
+        uint8_t Expand(uint32_t pixel) const
+        {
+            return Table[((pixel & Mask) >> Shift) & 0xff];
+        }
+    };
+
+    void ExpandUNorm8Row(const uint8_t* src, uint8_t* dst, uint32_t width, uint32_t srcBytes,
+                         const ChannelExpander* channels, uint32_t dstChannels)
+    {
+        for (uint32_t x = 0; x < width; ++x, src += srcBytes, dst += dstChannels)
+        {
+            uint32_t pixel = 0;
+            memcpy(&pixel, src, srcBytes);
+            for (uint32_t c = 0; c < dstChannels; ++c)
+            {
+                dst[c] = channels[c].Expand(pixel);
+            }
+        }
+    }
+
+    void SetAlpha16Row(const uint8_t* src, uint8_t* dst, uint32_t width, uint16_t alphaBits)
+    {
+        for (uint32_t x = 0; x < width; ++x, src += 2, dst += 2)
+        {
+            uint16_t v;
+            memcpy(&v, src, sizeof(v));
+            v = static_cast<uint16_t>(v | alphaBits);
+            memcpy(dst, &v, sizeof(v));
+        }
+    }
+
+    void SwapRB1010102Row(const uint8_t* src, uint8_t* dst, uint32_t width)
+    {
+        for (uint32_t x = 0; x < width; ++x, src += 4, dst += 4)
+        {
+            uint32_t v;
+            memcpy(&v, src, sizeof(v));
+            v = (v & 0xc00ffc00) | ((v & 0x3ff) << 20) | ((v >> 20) & 0x3ff);
+            memcpy(dst, &v, sizeof(v));
+        }
+    }
+
+    //转码时的一行，所有子资源的行展开后统一并行处理
+    struct RowJob
+    {
+        size_t Src;
+        size_t Dst;
+        uint32_t Width;
+    };
+
+    std::wstring ToHexString(uint64_t value)
+    {
+        const wchar_t* digits = L"0123456789abcdef";
+        std::wstring out(16, L'0');
+        for (int i = 15; i >= 0; --i, value >>= 4)
+        {
+            out[i] = digits[value & 0xf];
+        }
+        return out;
+    }
+
+    bool IsValidCacheEntry(const uint8_t* data, size_t size)
+    {
+        const size_t headerSize = sizeof(uint32_t) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10);
+        if (size < headerSize)
+        {
+            return false;
+        }
+
+        uint32_t magic;
+        memcpy(&magic, data, sizeof(magic));
+        return magic == DDS_MAGIC;
+    }
+}
+
+DXGI_FORMAT DDSTranscoder::GetTranscodedFormat(const DDS_PIXELFORMAT& ddpf)
+{
+    const LegacyFormat* legacy = FindLegacyFormat(ddpf);
+    return legacy ? legacy->Format : DXGI_FORMAT_UNKNOWN;
+}
+
+bool DDSTranscoder::Transcode(
+    const DDS_HEADER& header,
+    const uint8_t* bitData,
+    size_t bitSize,
+    std::vector<uint8_t>& ddsFile)
+{
+    const LegacyFormat* legacy = FindLegacyFormat(header.ddspf);
+    if (legacy == nullptr || bitData == nullptr || header.width == 0 || header.height == 0)
+    {
+        return false;
+    }
+
+    const bool volume = (header.flags & DDS_HEADER_FLAGS_VOLUME) != 0;
+    const bool cube = !volume && (header.caps2 & DDS_CUBEMAP) != 0;
+    if (cube && (header.caps2 & DDS_CUBEMAP_ALLFACES) != DDS_CUBEMAP_ALLFACES)
+    {
+        return false;
+    }
+
+    const uint32_t depth = volume ? std::max<uint32_t>(header.depth, 1) : 1;
+    const uint32_t mipCount = std::max<uint32_t>(header.mipMapCount, 1);
+    const uint32_t arraySize = cube ? 6 : 1;
+    const uint64_t srcBytesPerPixel = legacy->BitCount / 8;
+    const uint64_t dstBytesPerPixel = DDSFormat::BitsPerPixel(legacy->Format) / 8;
+
+    //计算每一行在源数据与目标数据中的位置，同时检查源数据是否足够
+    std::vector<RowJob> rows;
+    uint64_t srcOffset = 0;
+    uint64_t dstOffset = 0;
+    for (uint32_t slice = 0; slice < arraySize; ++slice)
+    {
+        uint32_t w = header.width;
+        uint32_t h = header.height;
+        uint32_t d = depth;
+        for (uint32_t mip = 0; mip < mipCount; ++mip)
+        {
+            const uint64_t rowCount = uint64_t(h) * d;
+            const uint64_t srcRowBytes = w * srcBytesPerPixel;
+            if (srcRowBytes > (bitSize - srcOffset) / rowCount)
+            {
+                return false;
+            }
+
+            for (uint64_t row = 0; row < rowCount; ++row)
+            {
+                RowJob job;
+                job.Src = static_cast<size_t>(srcOffset);
+                job.Dst = static_cast<size_t>(dstOffset);
+                job.Width = w;
+                rows.push_back(job);
+
+                srcOffset += srcRowBytes;
+                dstOffset += w * dstBytesPerPixel;
+            }
+
+            w = std::max<uint32_t>(w >> 1, 1);
+            h = std::max<uint32_t>(h >> 1, 1);
+            d = std::max<uint32_t>(d >> 1, 1);
+        }
+    }
+
+    const size_t headerSize = sizeof(uint32_t) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10);
+    ddsFile.resize(headerSize + static_cast<size_t>(dstOffset));
+
+    //新的文件头：保留尺寸、mip与立方体贴图等信息，像素格式改为DX10扩展头
+    DDS_HEADER newHeader = header;
+    newHeader.flags = (header.flags & ~DDS_HEADER_FLAGS_LINEARSIZE) | DDS_HEADER_FLAGS_PITCH;
+    newHeader.pitchOrLinearSize = static_cast<uint32_t>(header.width * dstBytesPerPixel);
+    memset(&newHeader.ddspf, 0, sizeof(newHeader.ddspf));
+    newHeader.ddspf.size = sizeof(DDS_PIXELFORMAT);
+    newHeader.ddspf.flags = DDS_FOURCC;
+    newHeader.ddspf.fourCC = MAKEFOURCC('D', 'X', '1', '0');
+
+    DDS_HEADER_DXT10 ext;
+    memset(&ext, 0, sizeof(ext));
+    ext.dxgiFormat = legacy->Format;
+    ext.resourceDimension = volume ? DDS_DIMENSION_TEXTURE3D : DDS_DIMENSION_TEXTURE2D;
+    ext.miscFlag = cube ? DDS_RESOURCE_MISC_TEXTURECUBE : 0;
+    ext.arraySize = 1;
+
+    uint8_t* dst = ddsFile.data();
+    memcpy(dst, &DDS_MAGIC, sizeof(uint32_t));
+    memcpy(dst + sizeof(uint32_t), &newHeader, sizeof(newHeader));
+    memcpy(dst + sizeof(uint32_t) + sizeof(newHeader), &ext, sizeof(ext));
+    dst += headerSize;
+
+    ChannelExpander channels[4];
+    uint32_t dstChannels = 0;
+    uint16_t alphaBits = 0;
+    if (legacy->Conv == Conversion::ExpandUNorm8)
+    {
+        if (legacy->Format == DXGI_FORMAT_R8G8_UNORM)
+        {
+            channels[0].Init(legacy->RMask);
+            channels[1].Init(legacy->AMask);
+            dstChannels = 2;
+        }
+        else
+        {
+            channels[0].Init(legacy->RMask);
+            channels[1].Init(legacy->GMask);
+            channels[2].Init(legacy->BMask);
+            channels[3].Init(legacy->AMask);
+            dstChannels = 4;
+        }
+    }
+    else if (legacy->Conv == Conversion::SetAlpha16)
+    {
+        //X位就是掩码之外的位
+        alphaBits = static_cast<uint16_t>(~(legacy->RMask | legacy->GMask | legacy->BMask));
+    }
+
+    JobSystem::GetDefault().ParallelFor(rows.size(), RowsPerTask, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const RowJob& job = rows[i];
+            const uint8_t* srcRow = bitData + job.Src;
+            uint8_t* dstRow = dst + job.Dst;
+
+            switch (legacy->Conv)
+            {
+            case Conversion::ExpandUNorm8:
+                ExpandUNorm8Row(srcRow, dstRow, job.Width, static_cast<uint32_t>(srcBytesPerPixel), channels, dstChannels);
+                break;
+            case Conversion::SetAlpha16:
+                SetAlpha16Row(srcRow, dstRow, job.Width, alphaBits);
+                break;
+            case Conversion::SwapRB1010102:
+                SwapRB1010102Row(srcRow, dstRow, job.Width);
+                break;
+            }
+        }
+    });
+
+    return true;
+}
+
+bool DDSTranscoder::TranscodeCached(
+    const std::wstring& cacheDir,
+    const std::wstring& sourcePath,
+    const DDS_HEADER& header,
+    const uint8_t* bitData,
+    size_t bitSize,
+    DDSTranscodeResult& result)
+{
+    result.Mapped.Close();
+    result.Owned.clear();
+
+    uint64_t sourceSize = 0;
+    uint64_t sourceTime = 0;
+    if (cacheDir.empty() || sourcePath.empty() ||
+        !FileUtil::GetFileStamp(sourcePath, sourceSize, sourceTime))
+    {
+        return Transcode(header, bitData, bitSize, result.Owned);
+    }
+
+    //源文件被替换时大小或修改时间会改变，旧的缓存文件不会再被命中
+    uint64_t key = Hash::Hash64(&header, sizeof(header), TranscoderVersion);
+    key = Hash::Hash64(sourcePath.data(), sourcePath.size() * sizeof(wchar_t), key);
+    key = Hash::Hash64(&sourceSize, sizeof(sourceSize), key);
+    key = Hash::Hash64(&sourceTime, sizeof(sourceTime), key);
+    const std::wstring path = cacheDir + L"/" + ToHexString(key) + L".dds";
+
+    if (result.Mapped.Open(path) && IsValidCacheEntry(result.Mapped.GetData(), result.Mapped.GetSize()))
+    {
+        return true;
+    }
+    result.Mapped.Close();
+
+    if (!Transcode(header, bitData, bitSize, result.Owned))
+    {
+        return false;
+    }
+
+    //写缓存失败不影响本次加载，下次再重新转码
+    if (FileUtil::EnsureDirectory(cacheDir))
+    {
+        FileUtil::WriteAllBytes(path, result.Owned.data(), result.Owned.size());
+    }
+    return true;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <dxgiformat.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "DDS.h"
+#include "MappedFile.h"
+
+//转码结果，命中磁盘缓存时为缓存文件的只读映射，否则为内存中刚转码的数据
+struct DDSTranscodeResult
+{
+    MappedFile Mapped;
+    std::vector<uint8_t> Owned;
+
+    const uint8_t* GetData() const { return Mapped.IsOpen() ? Mapped.GetData() : Owned.data(); }
+    size_t GetSize() const { return Mapped.IsOpen() ? Mapped.GetSize() : Owned.size(); }
+};
+
+//把没有对应DXGI格式的旧D3DFMT像素格式(24位RGB、X8B8G8R8、A2R10G10B10、X1R5G5B5、X4R4G4B4、A4L4、R3G3B2、A8R3G3B2)
+//转码为可以直接创建纹理的DXGI格式，输出为带DX10扩展头的DDS文件，数组/立方体贴图/体纹理以及mip链都原样保留
+class DDSTranscoder
+{
+public:
+    //需要转码时返回转码后的格式，否则返回DXGI_FORMAT_UNKNOWN
+    static DXGI_FORMAT GetTranscodedFormat(const DDS_PIXELFORMAT& ddpf);
+
+    //header之后的数据为bitData，转码结果为完整的DDS文件(含magic)
+    static bool Transcode(
+        const DDS_HEADER& header,
+        const uint8_t* bitData,
+        size_t bitSize,
+        std::vector<uint8_t>& ddsFile);
+
+    //与Transcode相同，但结果缓存在cacheDir中，以源文件的路径、大小、修改时间以及文件头为键
+    //命中时只映射缓存文件，不读取也不哈希源文件的像素数据
+    //cacheDir或sourcePath为空(例如从内存加载)时不使用缓存
+    static bool TranscodeCached(
+        const std::wstring& cacheDir,
+        const std::wstring& sourcePath,
+        const DDS_HEADER& header,
+        const uint8_t* bitData,
+        size_t bitSize,
+        DDSTranscodeResult& result);
+};
@@ -0,0 +1,105 @@
+#include "DDSWriter.h"
+#include "DDS.h"
+#include "DDSFormat.h"
+#include "FileUtil.h"
+
+#include <algorithm>
+#include <cstring>
+
+bool DDSWriter::WriteTexture2D(
+    DXGI_FORMAT format,
+    uint32_t width,
+    uint32_t height,
+    uint32_t arraySize,
+    uint32_t mipCount,
+    const std::vector<std::vector<uint8_t>>& subresources,
+    std::vector<uint8_t>& ddsFile)
+{
+    if (width == 0 || height == 0 || arraySize == 0 || mipCount == 0 ||
+        DDSFormat::BitsPerPixel(format) == 0 ||
+        subresources.size() != size_t(arraySize) * mipCount)
+    {
+        return false;
+    }
+
+    //校验每个子资源的大小，同时统计总大小
+    size_t dataSize = 0;
+    for (uint32_t slice = 0; slice < arraySize; ++slice)
+    {
+        uint32_t w = width;
+        uint32_t h = height;
+        for (uint32_t mip = 0; mip < mipCount; ++mip)
+        {
+            size_t numBytes = 0;
+            DDSFormat::GetSurfaceInfo(w, h, format, &numBytes, nullptr, nullptr);
+            if (subresources[slice * mipCount + mip].size() != numBytes)
+            {
+                return false;
+            }
+            dataSize += numBytes;
+
+            w = std::max<uint32_t>(w >> 1, 1);
+            h = std::max<uint32_t>(h >> 1, 1);
+        }
+    }
+
+    size_t topRowBytes = 0;
+    size_t topNumBytes = 0;
+    DDSFormat::GetSurfaceInfo(width, height, format, &topNumBytes, &topRowBytes, nullptr);
+    const bool compressed = DDSFormat::IsCompressed(format);
+
+    DDS_HEADER header;
+    memset(&header, 0, sizeof(header));
+    header.size = sizeof(DDS_HEADER);
+    header.flags = DDS_HEADER_FLAGS_TEXTURE |
+        (compressed ? DDS_HEADER_FLAGS_LINEARSIZE : DDS_HEADER_FLAGS_PITCH) |
+        (mipCount > 1 ? DDS_HEADER_FLAGS_MIPMAP : 0);
+    header.height = height;
+    header.width = width;
+    header.pitchOrLinearSize = static_cast<uint32_t>(compressed ? topNumBytes : topRowBytes);
+    header.mipMapCount = mipCount;
+    header.ddspf.size = sizeof(DDS_PIXELFORMAT);
+    header.ddspf.flags = DDS_FOURCC;
+    header.ddspf.fourCC = MAKEFOURCC('D', 'X', '1', '0');
+    header.caps = DDS_SURFACE_FLAGS_TEXTURE | (mipCount > 1 ? DDS_SURFACE_FLAGS_MIPMAP : 0);
+
+    DDS_HEADER_DXT10 ext;
+    memset(&ext, 0, sizeof(ext));
+    ext.dxgiFormat = format;
+    ext.resourceDimension = DDS_DIMENSION_TEXTURE2D;
+    ext.arraySize = arraySize;
+
+    ddsFile.resize(sizeof(uint32_t) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10) + dataSize);
+    uint8_t* dst = ddsFile.data();
+    memcpy(dst, &DDS_MAGIC, sizeof(uint32_t));
+    dst += sizeof(uint32_t);
+    memcpy(dst, &header, sizeof(header));
+    dst += sizeof(header);
+    memcpy(dst, &ext, sizeof(ext));
+    dst += sizeof(ext);
+
+    for (const auto& subresource : subresources)
+    {
+        memcpy(dst, subresource.data(), subresource.size());
+        dst += subresource.size();
+    }
+
+    return true;
+}
+
+bool DDSWriter::SaveTexture2D(
+    const std::wstring& path,
+    DXGI_FORMAT format,
+    uint32_t width,
+    uint32_t height,
+    uint32_t arraySize,
+    uint32_t mipCount,
+    const std::vector<std::vector<uint8_t>>& subresources)
+{
+    std::vector<uint8_t> ddsFile;
+    if (!WriteTexture2D(format, width, height, arraySize, mipCount, subresources, ddsFile))
+    {
+        return false;
+    }
+    return FileUtil::WriteAllBytes(path, ddsFile.data(), ddsFile.size());
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <dxgiformat.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//把纹理数据写成DDS文件，生成的文件可以直接由DDSTextureLoader加载
+//总是写入DX10扩展头，这样sRGB、BC7以及纹理数组都能被正确描述
+class DDSWriter
+{
+public:
+    //subresources按D3D12的子资源顺序排列：先遍历一个数组切片的全部mip，再到下一个切片
+    //每个子资源的数据必须紧密排列(行与行之间没有填充)，大小需与DDSFormat::GetSurfaceInfo的结果一致
+    static bool WriteTexture2D(
+        DXGI_FORMAT format,
+        uint32_t width,
+        uint32_t height,
+        uint32_t arraySize,
+        uint32_t mipCount,
+        const std::vector<std::vector<uint8_t>>& subresources,
+        std::vector<uint8_t>& ddsFile);
+
+    static bool SaveTexture2D(
+        const std::wstring& path,
+        DXGI_FORMAT format,
+        uint32_t width,
+        uint32_t height,
+        uint32_t arraySize,
+        uint32_t mipCount,
+        const std::vector<std::vector<uint8_t>>& subresources);
+};
@@ -0,0 +1,132 @@
+#include "DescriptorAllocator.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+    ComPtr<ID3D12DescriptorHeap> CreateHeap(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type,
+        UINT capacity, bool shaderVisible)
+    {
+        //RTV与DSV堆不能是着色器可见的
+        assert(!shaderVisible || type == D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV || type == D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER);
+
+        D3D12_DESCRIPTOR_HEAP_DESC desc;
+        desc.NumDescriptors = capacity;
+        desc.Type = type;
+        desc.Flags = shaderVisible ? D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE : D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+        desc.NodeMask = 0;
+
+        ComPtr<ID3D12DescriptorHeap> heap;
+        ThrowIfFailed(device->CreateDescriptorHeap(&desc, IID_PPV_ARGS(heap.GetAddressOf())));
+        return heap;
+    }
+
+    DescriptorHeapDesc GetHeapDesc(ID3D12DescriptorHeap* heap, UINT descriptorSize, UINT capacity, bool shaderVisible)
+    {
+        DescriptorHeapDesc desc;
+        desc.CpuStart = heap->GetCPUDescriptorHandleForHeapStart().ptr;
+        desc.GpuStart = shaderVisible ? heap->GetGPUDescriptorHandleForHeapStart().ptr : 0;
+        desc.DescriptorSize = descriptorSize;
+        desc.Capacity = capacity;
+        return desc;
+    }
+}
+
+DescriptorHeapAllocator::DescriptorHeapAllocator(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type,
+    UINT capacity, bool shaderVisible) :
+    mHeap(CreateHeap(device, type, capacity, shaderVisible)),
+    mType(type),
+    mDescriptorSize(device->GetDescriptorHandleIncrementSize(type)),
+    mFreeList(GetHeapDesc(mHeap.Get(), mDescriptorSize, capacity, shaderVisible))
+{
+}
+
+bool DescriptorHeapAllocator::Allocate(UINT count, DescriptorAllocation& allocation)
+{
+    allocation = DescriptorAllocation();
+
+    DescriptorRange range;
+    if (!mFreeList.Allocate(count, range))
+    {
+        return false;
+    }
+
+    allocation.Range = range;
+    allocation.Count = count;
+    allocation.DescriptorSize = mDescriptorSize;
+    allocation.CpuHandle.ptr = (SIZE_T)range.Cpu;
+    allocation.GpuHandle.ptr = range.Gpu;
+    return true;
+}
+
+void DescriptorHeapAllocator::Free(DescriptorAllocation& allocation)
+{
+    mFreeList.Free(allocation.Range);
+    allocation = DescriptorAllocation();
+}
+
+FrameDescriptorRing::FrameDescriptorRing(ID3D12Device* device, UINT capacity) :
+    mDevice(device),
+    mRing(capacity)
+{
+    mHeap = CreateHeap(device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, capacity, true);
+    mDescriptorSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+}
+
+DescriptorAllocation FrameDescriptorRing::Allocate(UINT count)
+{
+    const uint32_t offset = mRing.Allocate(count);
+    if (offset == RingAllocator::InvalidOffset)
+    {
+        ThrowIfFailed(E_OUTOFMEMORY);
+    }
+
+    DescriptorAllocation allocation;
+    allocation.Count = count;
+    allocation.DescriptorSize = mDescriptorSize;
+    allocation.CpuHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(mHeap->GetCPUDescriptorHandleForHeapStart(),
+        offset, mDescriptorSize);
+    allocation.GpuHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(mHeap->GetGPUDescriptorHandleForHeapStart(),
+        offset, mDescriptorSize);
+    return allocation;
+}
+
+DescriptorAllocation FrameDescriptorRing::StageTable(const D3D12_CPU_DESCRIPTOR_HANDLE* sources, UINT count)
+{
+    DescriptorAllocation table = Allocate(count);
+    mDestStarts.push_back(table.CpuHandle);
+    mDestSizes.push_back(count);
+    //源描述符不要求连续，每个作为长度为1的区间
+    mSources.insert(mSources.end(), sources, sources + count);
+    mSourceSizes.resize(mSources.size(), 1);
+    return table;
+}
+
+void FrameDescriptorRing::FlushCopies()
+{
+    if (mDestStarts.empty())
+    {
+        return;
+    }
+
+    mDevice->CopyDescriptors(
+        (UINT)mDestStarts.size(), mDestStarts.data(), mDestSizes.data(),
+        (UINT)mSources.size(), mSources.data(), mSourceSizes.data(),
+        D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+    mDestStarts.clear();
+    mDestSizes.clear();
+    mSources.clear();
+    mSourceSizes.clear();
+}
+
+void FrameDescriptorRing::FinishFrame(UINT64 fenceValue)
+{
+    assert(mDestStarts.empty());
+    mRing.FinishFrame(fenceValue);
+}
+
+void FrameDescriptorRing::Reclaim(UINT64 completedFenceValue)
+{
+    mRing.Reclaim(completedFenceValue);
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "DescriptorFreeList.h"
+#include "RingAllocator.h"
+
+//描述符堆中一段连续的描述符
+struct DescriptorAllocation
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE CpuHandle = {};
+    //只有着色器可见的堆才有GPU句柄
+    D3D12_GPU_DESCRIPTOR_HANDLE GpuHandle = {};
+    UINT Count = 0;
+    UINT DescriptorSize = 0;
+
+    //持久分配在堆中的区间，释放时使用
+    DescriptorRange Range;
+
+    bool IsValid() const { return Count != 0; }
+
+    D3D12_CPU_DESCRIPTOR_HANDLE Cpu(UINT index = 0) const
+    {
+        assert(index < Count);
+        return CD3DX12_CPU_DESCRIPTOR_HANDLE(CpuHandle, index, DescriptorSize);
+    }
+
+    D3D12_GPU_DESCRIPTOR_HANDLE Gpu(UINT index = 0) const
+    {
+        assert(index < Count);
+        return CD3DX12_GPU_DESCRIPTOR_HANDLE(GpuHandle, index, DescriptorSize);
+    }
+};
+
+//持久描述符的分配器：一个描述符堆，按连续区间子分配(DescriptorFreeList)，可以随时释放
+//RTV/DSV，以及作为拷贝源的CPU端CBV/SRV/UAV(非着色器可见)都从这里分配
+class DescriptorHeapAllocator
+{
+public:
+    DescriptorHeapAllocator(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type, UINT capacity, bool shaderVisible = false);
+    DescriptorHeapAllocator(const DescriptorHeapAllocator& rhs) = delete;
+    DescriptorHeapAllocator& operator=(const DescriptorHeapAllocator& rhs) = delete;
+
+    //空间不足时返回false
+    bool Allocate(UINT count, DescriptorAllocation& allocation);
+
+    //调用者需要保证GPU已不再使用这些描述符
+    void Free(DescriptorAllocation& allocation);
+
+    ID3D12DescriptorHeap* GetHeap() const { return mHeap.Get(); }
+    D3D12_DESCRIPTOR_HEAP_TYPE GetType() const { return mType; }
+    UINT GetDescriptorSize() const { return mDescriptorSize; }
+    const TLSFAllocator& GetAllocator() const { return mFreeList.GetAllocator(); }
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> mHeap;
+    D3D12_DESCRIPTOR_HEAP_TYPE mType;
+    UINT mDescriptorSize = 0;
+    DescriptorFreeList mFreeList;
+};
+
+//着色器可见的CBV/SRV/UAV堆，按帧线性分配临时的描述符表
+//描述符先在非着色器可见的堆中创建，绘制时用StageTable拷贝成连续的表，
+//同一批的拷贝在FlushCopies时用一次CopyDescriptors完成；整帧的表在fence到达后一起回收
+class FrameDescriptorRing
+{
+public:
+    FrameDescriptorRing(ID3D12Device* device, UINT capacity);
+    FrameDescriptorRing(const FrameDescriptorRing& rhs) = delete;
+    FrameDescriptorRing& operator=(const FrameDescriptorRing& rhs) = delete;
+
+    //分配count个连续的描述符，空间不足时抛出异常(说明容量太小或没有及时Reclaim)
+    DescriptorAllocation Allocate(UINT count);
+
+    //分配一个表，并登记把sources[0..count)拷贝进去，表在FlushCopies之后才能被GPU使用
+    DescriptorAllocation StageTable(const D3D12_CPU_DESCRIPTOR_HANDLE* sources, UINT count);
+
+    //把登记的拷贝用一次CopyDescriptors完成
+    void FlushCopies();
+
+    //本帧的命令提交并Signal之后调用
+    void FinishFrame(UINT64 fenceValue);
+    void Reclaim(UINT64 completedFenceValue);
+
+    ID3D12DescriptorHeap* GetHeap() const { return mHeap.Get(); }
+    UINT GetDescriptorSize() const { return mDescriptorSize; }
+    const RingAllocator& GetAllocator() const { return mRing; }
+
+private:
+    ID3D12Device* mDevice = nullptr;
+    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> mHeap;
+    UINT mDescriptorSize = 0;
+    RingAllocator mRing;
+
+    //待拷贝的目标区间与源描述符(每个源描述符作为一个长度为1的区间)
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> mDestStarts;
+    std::vector<UINT> mDestSizes;
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> mSources;
+    std::vector<UINT> mSourceSizes;
+};
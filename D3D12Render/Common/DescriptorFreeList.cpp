@@ -0,0 +1,40 @@
+#include "DescriptorFreeList.h"
+
+#include <cassert>
+
+DescriptorFreeList::DescriptorFreeList(const DescriptorHeapDesc& heap) :
+    mHeap(heap),
+    mAllocator(heap.Capacity)
+{
+    assert(heap.DescriptorSize > 0);
+}
+
+bool DescriptorFreeList::Allocate(uint32_t count, DescriptorRange& range)
+{
+    range = DescriptorRange();
+
+    TLSFAllocator::Allocation allocation = mAllocator.Allocate(count);
+    if (!allocation.IsValid())
+    {
+        return false;
+    }
+
+    const uint64_t offset = uint64_t(allocation.Offset) * mHeap.DescriptorSize;
+    range.Range = allocation;
+    range.Count = count;
+    range.Cpu = mHeap.CpuStart + offset;
+    if (mHeap.GpuStart != 0)
+    {
+        range.Gpu = mHeap.GpuStart + offset;
+    }
+    return true;
+}
+
+void DescriptorFreeList::Free(DescriptorRange& range)
+{
+    if (range.IsValid())
+    {
+        mAllocator.Free(range.Range);
+    }
+    range = DescriptorRange();
+}
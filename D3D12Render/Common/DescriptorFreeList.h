@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include "TLSFAllocator.h"
+
+//描述符堆的起始地址与描述符增量，与D3D12_CPU/GPU_DESCRIPTOR_HANDLE的ptr含义相同
+struct DescriptorHeapDesc
+{
+    uint64_t CpuStart = 0;
+    //非着色器可见的堆为0
+    uint64_t GpuStart = 0;
+    uint32_t DescriptorSize = 0;
+    uint32_t Capacity = 0;
+};
+
+//堆中一段连续描述符的地址
+struct DescriptorRange
+{
+    uint64_t Cpu = 0;
+    uint64_t Gpu = 0;
+    uint32_t Count = 0;
+
+    //在堆中的区间，释放时使用
+    TLSFAllocator::Allocation Range;
+
+    bool IsValid() const { return Count != 0; }
+};
+
+//持久描述符堆的空闲链表，只计算地址，不访问实际的堆，DescriptorHeapAllocator在它之上创建D3D12的句柄
+//区间由TLSF子分配，释放时立即与相邻的空闲区间合并
+class DescriptorFreeList
+{
+public:
+    explicit DescriptorFreeList(const DescriptorHeapDesc& heap);
+
+    //count为0或没有足够大的连续空间时返回false，range被重置
+    bool Allocate(uint32_t count, DescriptorRange& range);
+
+    //释放后range被重置，对无效的range不做任何事
+    void Free(DescriptorRange& range);
+
+    const DescriptorHeapDesc& GetHeapDesc() const { return mHeap; }
+    const TLSFAllocator& GetAllocator() const { return mAllocator; }
+
+private:
+    DescriptorHeapDesc mHeap;
+    TLSFAllocator mAllocator;
+};
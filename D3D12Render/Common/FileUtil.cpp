@@ -0,0 +1,198 @@
+#include "FileUtil.h"
+
+#include <cstdio>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    FILE* OpenStream(const std::wstring& path, bool write)
+    {
+#if defined(_WIN32)
+        FILE* file = nullptr;
+        if (_wfopen_s(&file, path.c_str(), write ? L"wb" : L"rb") != 0)
+        {
+            return nullptr;
+        }
+        return file;
+#else
+        return fopen(FileUtil::ToUtf8(path).c_str(), write ? "wb" : "rb");
+#endif
+    }
+
+    bool MoveOverFile(const std::wstring& from, const std::wstring& to)
+    {
+#if defined(_WIN32)
+        return MoveFileExW(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        return rename(FileUtil::ToUtf8(from).c_str(), FileUtil::ToUtf8(to).c_str()) == 0;
+#endif
+    }
+
+    //创建单级目录，已存在时视为成功
+    bool MakeDirectory(const std::wstring& path)
+    {
+#if defined(_WIN32)
+        return CreateDirectoryW(path.c_str(), nullptr) != 0 || GetLastError() == ERROR_ALREADY_EXISTS;
+#else
+        struct stat info;
+        return mkdir(FileUtil::ToUtf8(path).c_str(), 0755) == 0 ||
+            (stat(FileUtil::ToUtf8(path).c_str(), &info) == 0 && S_ISDIR(info.st_mode));
+#endif
+    }
+
+    void DeleteTempFile(const std::wstring& path)
+    {
+#if defined(_WIN32)
+        DeleteFileW(path.c_str());
+#else
+        unlink(FileUtil::ToUtf8(path).c_str());
+#endif
+    }
+}
+
+bool FileUtil::ReadAllBytes(const std::wstring& path, std::vector<uint8_t>& data)
+{
+    data.clear();
+
+    FILE* file = OpenStream(path, false);
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    bool ok = fseek(file, 0, SEEK_END) == 0;
+#if defined(_WIN32)
+    long long size = ok ? _ftelli64(file) : -1;
+#else
+    long long size = ok ? static_cast<long long>(ftello(file)) : -1;
+#endif
+    ok = ok && size >= 0 && fseek(file, 0, SEEK_SET) == 0;
+
+    if (ok)
+    {
+        data.resize(static_cast<size_t>(size));
+        ok = data.empty() || fread(data.data(), 1, data.size(), file) == data.size();
+    }
+
+    fclose(file);
+    if (!ok)
+    {
+        data.clear();
+    }
+    return ok;
+}
+
+bool FileUtil::WriteAllBytes(const std::wstring& path, const void* data, size_t size)
+{
+    const std::wstring tmpPath = path + L".tmp";
+
+    FILE* file = OpenStream(tmpPath, true);
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    bool ok = size == 0 || fwrite(data, 1, size, file) == size;
+    ok = (fclose(file) == 0) && ok;
+
+    if (ok)
+    {
+        ok = MoveOverFile(tmpPath, path);
+    }
+    if (!ok)
+    {
+        DeleteTempFile(tmpPath);
+    }
+    return ok;
+}
+
+bool FileUtil::EnsureDirectory(const std::wstring& path)
+{
+    if (path.empty())
+    {
+        return false;
+    }
+
+    //从前往后逐级创建，跳过开头的分隔符与盘符
+    for (size_t i = 1; i < path.size(); ++i)
+    {
+        if ((path[i] == L'/' || path[i] == L'\\') && path[i - 1] != L':')
+        {
+            MakeDirectory(path.substr(0, i));
+        }
+    }
+    return MakeDirectory(path);
+}
+
+bool FileUtil::GetFileStamp(const std::wstring& path, uint64_t& size, uint64_t& modifiedTime)
+{
+#if defined(_WIN32)
+    WIN32_FILE_ATTRIBUTE_DATA info;
+    if (!GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &info))
+    {
+        return false;
+    }
+    size = (static_cast<uint64_t>(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+    modifiedTime = (static_cast<uint64_t>(info.ftLastWriteTime.dwHighDateTime) << 32) | info.ftLastWriteTime.dwLowDateTime;
+#else
+    struct stat info;
+    if (stat(ToUtf8(path).c_str(), &info) != 0)
+    {
+        return false;
+    }
+    size = static_cast<uint64_t>(info.st_size);
+    modifiedTime = static_cast<uint64_t>(info.st_mtim.tv_sec) * 1000000000ull + static_cast<uint64_t>(info.st_mtim.tv_nsec);
+#endif
+    return true;
+}
+
+std::string FileUtil::ToUtf8(const std::wstring& path)
+{
+    std::string out;
+    out.reserve(path.size());
+    for (size_t i = 0; i < path.size(); ++i)
+    {
+        uint32_t c = static_cast<uint32_t>(path[i]);
+
+        //Windows上wchar_t为UTF-16，需要合并代理对
+        if (sizeof(wchar_t) == 2 && c >= 0xD800 && c <= 0xDBFF && i + 1 < path.size())
+        {
+            uint32_t low = static_cast<uint32_t>(path[i + 1]);
+            if (low >= 0xDC00 && low <= 0xDFFF)
+            {
+                c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+                ++i;
+            }
+        }
+
+        if (c < 0x80)
+        {
+            out.push_back(static_cast<char>(c));
+        }
+        else if (c < 0x800)
+        {
+            out.push_back(static_cast<char>(0xC0 | (c >> 6)));
+            out.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+        }
+        else if (c < 0x10000)
+        {
+            out.push_back(static_cast<char>(0xE0 | (c >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+        }
+        else
+        {
+            out.push_back(static_cast<char>(0xF0 | (c >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+        }
+    }
+    return out;
+}
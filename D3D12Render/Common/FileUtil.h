@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//简单的跨平台文件读写辅助函数，路径统一使用宽字符串(与项目中其他接口一致)
+class FileUtil
+{
+public:
+    //读取整个文件，失败时返回false
+    static bool ReadAllBytes(const std::wstring& path, std::vector<uint8_t>& data);
+
+    //先写入临时文件再重命名，保证其他进程不会读到只写了一半的文件
+    static bool WriteAllBytes(const std::wstring& path, const void* data, size_t size);
+
+    //创建目录(包括不存在的上级目录)，目录已存在时也返回true
+    static bool EnsureDirectory(const std::wstring& path);
+
+    //读取文件大小与最后修改时间(时间单位与平台相关，只用于比较是否变化)，文件不存在时返回false
+    static bool GetFileStamp(const std::wstring& path, uint64_t& size, uint64_t& modifiedTime);
+
+    //宽字符串路径转为UTF-8，供POSIX接口使用
+    static std::string ToUtf8(const std::wstring& path);
+};
@@ -0,0 +1,386 @@
+#include "FrameGraph.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include "Hash.h"
+
+void FrameGraphCompiler::Reset()
+{
+    mResources.clear();
+    mPasses.clear();
+    mAccesses.clear();
+}
+
+uint32_t FrameGraphCompiler::ImportResource(const char* name, const void* resource, uint32_t initialState, uint32_t finalState)
+{
+    Resource entry;
+    entry.Name = name;
+    entry.Pointer = resource;
+    entry.InitialState = initialState;
+    entry.FinalState = finalState;
+    mResources.push_back(entry);
+    return static_cast<uint32_t>(mResources.size() - 1);
+}
+
+uint32_t FrameGraphCompiler::CreateTransient(const char* name, const TransientResourceDesc& desc)
+{
+    Resource entry;
+    entry.Name = name;
+    entry.Transient = true;
+    entry.Desc = desc;
+    mResources.push_back(entry);
+    return static_cast<uint32_t>(mResources.size() - 1);
+}
+
+void FrameGraphCompiler::SetResource(uint32_t handle, const void* resource)
+{
+    assert(handle < mResources.size());
+    mResources[handle].Pointer = resource;
+}
+
+uint32_t FrameGraphCompiler::AddPassDeclaration(const char* name, const FrameGraphAccess* accesses, size_t count, bool sideEffects)
+{
+    Pass pass;
+    pass.Name = name;
+    pass.FirstAccess = static_cast<uint32_t>(mAccesses.size());
+    pass.AccessCount = static_cast<uint32_t>(count);
+    pass.SideEffects = sideEffects;
+    for (size_t i = 0; i < count; ++i)
+    {
+        assert(accesses[i].Resource < mResources.size());
+        mAccesses.push_back(accesses[i]);
+    }
+    mPasses.push_back(pass);
+    return static_cast<uint32_t>(mPasses.size() - 1);
+}
+
+uint64_t FrameGraphCompiler::ComputeKey() const
+{
+    //资源指针不参与比较：交换链缓冲区每帧不同，执行时才用到
+    uint64_t key = Hash::Combine(mResources.size(), mPasses.size());
+    for (const Resource& resource : mResources)
+    {
+        const uint64_t fields[] = { resource.Transient ? 1ull : 0ull, resource.Desc.Size, resource.Desc.Alignment,
+            resource.Desc.HeapKind, resource.InitialState, resource.FinalState };
+        key = Hash::Combine(key, Hash::Hash64(fields, sizeof(fields)));
+    }
+    for (const Pass& pass : mPasses)
+    {
+        //名字按内容比较，每帧可以传入不同地址的字符串
+        const size_t length = pass.Name != nullptr ? strlen(pass.Name) : 0;
+        key = Hash::Combine(key, Hash::Hash64(pass.Name, length, length));
+        key = Hash::Combine(key, (static_cast<uint64_t>(pass.AccessCount) << 1) | (pass.SideEffects ? 1 : 0));
+    }
+    for (const FrameGraphAccess& access : mAccesses)
+    {
+        const uint64_t packed = (static_cast<uint64_t>(access.Resource) << 33) |
+            (static_cast<uint64_t>(access.State) << 1) | (access.Write ? 1 : 0);
+        key = Hash::Combine(key, packed);
+    }
+    return key;
+}
+
+bool FrameGraphCompiler::MatchesCompiledDeclaration() const
+{
+    if (mResources.size() != mCompiledResources.size() || mPasses.size() != mCompiledPasses.size() ||
+        mAccesses.size() != mCompiledAccesses.size())
+    {
+        return false;
+    }
+
+    //比较的内容与ComputeKey相同，资源指针与资源名不参与比较
+    for (size_t i = 0; i < mResources.size(); ++i)
+    {
+        const Resource& a = mResources[i];
+        const Resource& b = mCompiledResources[i];
+        if (a.Transient != b.Transient || a.Desc.Size != b.Desc.Size || a.Desc.Alignment != b.Desc.Alignment ||
+            a.Desc.HeapKind != b.Desc.HeapKind || a.InitialState != b.InitialState || a.FinalState != b.FinalState)
+        {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < mPasses.size(); ++i)
+    {
+        const Pass& a = mPasses[i];
+        const Pass& b = mCompiledPasses[i];
+        if (a.AccessCount != b.AccessCount || a.SideEffects != b.SideEffects ||
+            mCompiledPassNames[i] != (a.Name != nullptr ? a.Name : ""))
+        {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < mAccesses.size(); ++i)
+    {
+        const FrameGraphAccess& a = mAccesses[i];
+        const FrameGraphAccess& b = mCompiledAccesses[i];
+        if (a.Resource != b.Resource || a.State != b.State || a.Write != b.Write)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FrameGraphCompiler::SaveCompiledDeclaration()
+{
+    mCompiledResources = mResources;
+    mCompiledPasses = mPasses;
+    mCompiledAccesses = mAccesses;
+    mCompiledPassNames.resize(mPasses.size());
+    for (size_t i = 0; i < mPasses.size(); ++i)
+    {
+        mCompiledPassNames[i] = mPasses[i].Name != nullptr ? mPasses[i].Name : "";
+    }
+}
+
+bool FrameGraphCompiler::Compile()
+{
+    const uint64_t key = ComputeKey();
+    if (mCompiled && key == mCompiledKey && MatchesCompiledDeclaration())
+    {
+        ++mStats.CacheHits;
+        return false;
+    }
+
+    Cull();
+    Schedule();
+    BuildTransitions();
+    PlanMemory();
+
+    mCompiled = true;
+    mCompiledKey = key;
+    SaveCompiledDeclaration();
+    ++mStats.Compiles;
+    return true;
+}
+
+void FrameGraphCompiler::Cull()
+{
+    //从后往前：有副作用、写入导入资源、或写入后面需要的资源的pass需要保留，它访问的资源也就需要了
+    std::vector<bool> neededResources(mResources.size(), false);
+    mNeeded.assign(mPasses.size(), false);
+    for (size_t index = mPasses.size(); index-- > 0;)
+    {
+        const Pass& pass = mPasses[index];
+        bool needed = pass.SideEffects;
+        for (uint32_t i = 0; i < pass.AccessCount && !needed; ++i)
+        {
+            const FrameGraphAccess& access = mAccesses[pass.FirstAccess + i];
+            needed = access.Write && (!mResources[access.Resource].Transient || neededResources[access.Resource]);
+        }
+        if (!needed)
+        {
+            continue;
+        }
+
+        mNeeded[index] = true;
+        for (uint32_t i = 0; i < pass.AccessCount; ++i)
+        {
+            neededResources[mAccesses[pass.FirstAccess + i].Resource] = true;
+        }
+    }
+}
+
+void FrameGraphCompiler::Schedule()
+{
+    //层数为依赖的pass的层数最大值加一，按声明顺序处理保证依赖先于使用者
+    const uint32_t noPass = ~0u;
+    std::vector<uint32_t> lastWriter(mResources.size(), noPass);
+    std::vector<std::vector<uint32_t>> readers(mResources.size());
+    std::vector<uint32_t> levels(mPasses.size(), 0);
+    mLevelCount = 0;
+    mOrder.clear();
+
+    for (uint32_t index = 0; index < mPasses.size(); ++index)
+    {
+        if (!mNeeded[index])
+        {
+            continue;
+        }
+
+        const Pass& pass = mPasses[index];
+        uint32_t level = 0;
+        auto dependOn = [&](uint32_t other)
+        {
+            if (other != noPass && other != index)
+            {
+                level = std::max(level, levels[other] + 1);
+            }
+        };
+
+        for (uint32_t i = 0; i < pass.AccessCount; ++i)
+        {
+            const FrameGraphAccess& access = mAccesses[pass.FirstAccess + i];
+            dependOn(lastWriter[access.Resource]);
+            if (access.Write)
+            {
+                for (uint32_t reader : readers[access.Resource])
+                {
+                    dependOn(reader);
+                }
+            }
+        }
+        levels[index] = level;
+        mLevelCount = std::max(mLevelCount, level + 1);
+
+        for (uint32_t i = 0; i < pass.AccessCount; ++i)
+        {
+            const FrameGraphAccess& access = mAccesses[pass.FirstAccess + i];
+            if (access.Write)
+            {
+                lastWriter[access.Resource] = index;
+                readers[access.Resource].clear();
+            }
+            else
+            {
+                readers[access.Resource].push_back(index);
+            }
+        }
+        mOrder.push_back(index);
+    }
+
+    std::stable_sort(mOrder.begin(), mOrder.end(), [&levels](uint32_t a, uint32_t b) { return levels[a] < levels[b]; });
+}
+
+void FrameGraphCompiler::BuildTransitions()
+{
+    const uint32_t unknownState = ~0u;
+    std::vector<uint32_t> states(mResources.size());
+    mInitialStates.assign(mResources.size(), 0);
+    for (size_t i = 0; i < mResources.size(); ++i)
+    {
+        states[i] = mResources[i].Transient ? unknownState : mResources[i].InitialState;
+        mInitialStates[i] = mResources[i].InitialState;
+    }
+
+    mTransitions.clear();
+    mTransitionRanges.clear();
+    std::vector<FrameGraphAccess> merged;
+    for (uint32_t index : mOrder)
+    {
+        //同一个pass对一个资源的多次读取合并为一个状态(只读状态可以按位组合)，有写入时使用写入的状态
+        const Pass& pass = mPasses[index];
+        merged.clear();
+        for (uint32_t i = 0; i < pass.AccessCount; ++i)
+        {
+            const FrameGraphAccess& access = mAccesses[pass.FirstAccess + i];
+            auto it = std::find_if(merged.begin(), merged.end(),
+                [&access](const FrameGraphAccess& other) { return other.Resource == access.Resource; });
+            if (it == merged.end())
+            {
+                merged.push_back(access);
+            }
+            else if (access.Write)
+            {
+                assert(!it->Write || it->State == access.State);
+                it->State = access.State;
+                it->Write = true;
+            }
+            else if (!it->Write)
+            {
+                it->State |= access.State;
+            }
+        }
+
+        mTransitionRanges.push_back(static_cast<uint32_t>(mTransitions.size()));
+        for (const FrameGraphAccess& access : merged)
+        {
+            uint32_t& state = states[access.Resource];
+            if (state == unknownState)
+            {
+                //临时资源以第一次访问的状态创建，不需要转换
+                mInitialStates[access.Resource] = access.State;
+            }
+            else if (state != access.State)
+            {
+                FrameGraphTransition transition;
+                transition.Resource = access.Resource;
+                transition.StateBefore = state;
+                transition.StateAfter = access.State;
+                mTransitions.push_back(transition);
+            }
+            state = access.State;
+        }
+    }
+    mTransitionRanges.push_back(static_cast<uint32_t>(mTransitions.size()));
+
+    mFinalTransitions.clear();
+    for (uint32_t handle = 0; handle < mResources.size(); ++handle)
+    {
+        const Resource& resource = mResources[handle];
+        if (!resource.Transient && states[handle] != resource.FinalState)
+        {
+            FrameGraphTransition transition;
+            transition.Resource = handle;
+            transition.StateBefore = states[handle];
+            transition.StateAfter = resource.FinalState;
+            mFinalTransitions.push_back(transition);
+        }
+    }
+}
+
+void FrameGraphCompiler::PlanMemory()
+{
+    //规划器只看到临时资源，结果再换回资源句柄；导入的资源Heap为NoHeap
+    const uint32_t notPlanned = ~0u;
+    std::vector<uint32_t> plannerIndex(mResources.size(), notPlanned);
+    std::vector<uint32_t> handles;
+    mPlanner.Clear();
+    for (uint32_t handle = 0; handle < mResources.size(); ++handle)
+    {
+        if (mResources[handle].Transient)
+        {
+            plannerIndex[handle] = mPlanner.AddResource(mResources[handle].Desc);
+            handles.push_back(handle);
+        }
+    }
+
+    std::vector<uint32_t> passResources;
+    for (uint32_t index : mOrder)
+    {
+        const Pass& pass = mPasses[index];
+        passResources.clear();
+        for (uint32_t i = 0; i < pass.AccessCount; ++i)
+        {
+            const uint32_t resource = plannerIndex[mAccesses[pass.FirstAccess + i].Resource];
+            if (resource != notPlanned)
+            {
+                passResources.push_back(resource);
+            }
+        }
+        mPlanner.AddPass(passResources.data(), passResources.size());
+    }
+
+    TransientMemoryPlan plan;
+    mPlanner.Build(plan);
+
+    mMemoryPlan.Heaps = plan.Heaps;
+    mMemoryPlan.TotalBytes = plan.TotalBytes;
+    mMemoryPlan.NaiveBytes = plan.NaiveBytes;
+    mMemoryPlan.Placements.assign(mResources.size(), TransientPlacement());
+    for (TransientPlacement& placement : mMemoryPlan.Placements)
+    {
+        placement.Heap = TransientMemoryPlan::NoHeap;
+    }
+    for (size_t i = 0; i < handles.size(); ++i)
+    {
+        mMemoryPlan.Placements[handles[i]] = plan.Placements[i];
+    }
+    mMemoryPlan.Barriers = plan.Barriers;
+    for (TransientAliasingBarrier& barrier : mMemoryPlan.Barriers)
+    {
+        if (barrier.Before != TransientAliasingBarrier::AnyResource)
+        {
+            barrier.Before = handles[barrier.Before];
+        }
+        barrier.After = handles[barrier.After];
+    }
+}
+
+void FrameGraphCompiler::GetTransitions(uint32_t position, const FrameGraphTransition*& transitions, size_t& count) const
+{
+    assert(position + 1 < mTransitionRanges.size());
+    transitions = mTransitions.data() + mTransitionRanges[position];
+    count = mTransitionRanges[position + 1] - mTransitionRanges[position];
+}
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <vector>
+#include "JobSystem.h"
+#include "ParallelRecord.h"
+#include "ResourceStateTracker.h"
+#include "TransientResourcePlanner.h"
+
+//pass对资源的一次访问，State与D3D12_RESOURCE_STATES一致
+//写入视为读-改-写：之前写入同一资源的pass也会被保留
+struct FrameGraphAccess
+{
+    uint32_t Resource = 0;
+    uint32_t State = 0;
+    bool Write = false;
+};
+
+//编译得到的状态转换，资源以句柄表示，执行时再换成资源指针(导入的资源如交换链缓冲区每帧不同)
+struct FrameGraphTransition
+{
+    uint32_t Resource = 0;
+    uint32_t StateBefore = 0;
+    uint32_t StateAfter = 0;
+};
+
+struct FrameGraphStats
+{
+    uint64_t Compiles = 0;
+    uint64_t CacheHits = 0;     //拓扑没有变化，直接使用上次的编译结果
+};
+
+//渲染图的声明与编译，与平台无关
+//每帧重新声明资源与pass(Reset后按期望的顺序添加)，Compile时：
+//  从有副作用的pass与写入导入资源的pass反向标记，剔除结果没有被使用的pass；
+//  按依赖(写后读、写后写、读后写)分层，同层的pass互不依赖，按层稳定排序得到执行顺序；
+//  按执行顺序模拟每个资源的状态，得到每个pass之前需要的状态转换，以及结束时导入资源到最终状态的转换；
+//  用TransientResourcePlanner规划临时资源的内存，得到aliasing barrier
+//声明的拓扑(pass、访问、资源描述、导入资源的状态)与上次编译相同时直接复用上次的结果：
+//先比较64位的键，键相同时再与保存的上次声明逐项比较，哈希冲突不会导致错误地复用
+class FrameGraphCompiler
+{
+public:
+    static const uint32_t InvalidHandle = ~0u;
+
+    //清空声明，保留上次的编译结果用于比较
+    void Reset();
+
+    //导入外部资源(交换链缓冲区、深度缓冲区等)：图开始时处于initialState，结束时转换到finalState
+    uint32_t ImportResource(const char* name, const void* resource, uint32_t initialState, uint32_t finalState);
+    //图内部的临时资源，内存由规划决定，创建后用SetResource设置资源指针
+    uint32_t CreateTransient(const char* name, const TransientResourceDesc& desc);
+    void SetResource(uint32_t handle, const void* resource);
+
+    //sideEffects为true的pass(如写入回读缓冲区)总是保留
+    uint32_t AddPassDeclaration(const char* name, const FrameGraphAccess* accesses, size_t count, bool sideEffects);
+
+    //返回true表示重新编译了(拓扑有变化)，临时资源需要按新的规划重新创建
+    bool Compile();
+
+    //按执行顺序排列的pass(声明时的序号)，被剔除的pass不在其中
+    const std::vector<uint32_t>& GetExecutionOrder() const { return mOrder; }
+    bool IsCulled(uint32_t pass) const { return !mNeeded[pass]; }
+    uint32_t GetLevelCount() const { return mLevelCount; }
+    const char* GetPassName(uint32_t pass) const { return mPasses[pass].Name; }
+
+    //执行顺序中第position个pass之前的状态转换
+    void GetTransitions(uint32_t position, const FrameGraphTransition*& transitions, size_t& count) const;
+    const std::vector<FrameGraphTransition>& GetFinalTransitions() const { return mFinalTransitions; }
+
+    //临时资源的规划，Placements/Barriers与资源句柄、执行顺序中的位置对应
+    const TransientMemoryPlan& GetMemoryPlan() const { return mMemoryPlan; }
+    //临时资源应当以第一次访问的状态创建
+    uint32_t GetTransientInitialState(uint32_t handle) const { return mInitialStates[handle]; }
+    bool IsTransient(uint32_t handle) const { return mResources[handle].Transient; }
+    const void* GetResource(uint32_t handle) const { return mResources[handle].Pointer; }
+    size_t GetResourceCount() const { return mResources.size(); }
+
+    const FrameGraphStats& GetStats() const { return mStats; }
+
+private:
+    struct Resource
+    {
+        const char* Name = nullptr;
+        const void* Pointer = nullptr;
+        bool Transient = false;
+        TransientResourceDesc Desc;
+        uint32_t InitialState = 0;
+        uint32_t FinalState = 0;
+    };
+
+    struct Pass
+    {
+        const char* Name = nullptr;
+        uint32_t FirstAccess = 0;   //mAccesses中的范围
+        uint32_t AccessCount = 0;
+        bool SideEffects = false;
+    };
+
+    uint64_t ComputeKey() const;
+    bool MatchesCompiledDeclaration() const;
+    void SaveCompiledDeclaration();
+    void Cull();
+    void Schedule();
+    void BuildTransitions();
+    void PlanMemory();
+
+private:
+    std::vector<Resource> mResources;
+    std::vector<Pass> mPasses;
+    std::vector<FrameGraphAccess> mAccesses;
+
+    //编译结果
+    bool mCompiled = false;
+    uint64_t mCompiledKey = 0;
+    std::vector<Resource> mCompiledResources;
+    std::vector<Pass> mCompiledPasses;
+    std::vector<std::string> mCompiledPassNames;    //名字指针每帧可能不同，保存内容
+    std::vector<FrameGraphAccess> mCompiledAccesses;
+    std::vector<bool> mNeeded;
+    std::vector<uint32_t> mOrder;
+    uint32_t mLevelCount = 0;
+    std::vector<uint32_t> mTransitionRanges;    //执行顺序中每个pass在mTransitions中的起点，最后多一个终点
+    std::vector<FrameGraphTransition> mTransitions;
+    std::vector<FrameGraphTransition> mFinalTransitions;
+    std::vector<uint32_t> mInitialStates;
+    TransientMemoryPlan mMemoryPlan;
+    TransientResourcePlanner mPlanner;
+
+    FrameGraphStats mStats;
+};
+
+//带执行函数的渲染图。Context为录制pass时传入的对象，需要提供：
+//  void ResourceBarrier(uint32_t count, const ResourceTransition* transitions);
+//  void AliasingBarrier(const void* before, const void* after);    //before为nullptr表示任意资源
+//状态转换在编译时已经全部确定，各pass的录制互不依赖，可以切块在多个命令列表中并行录制
+template<typename Context>
+class FrameGraph : public FrameGraphCompiler
+{
+public:
+    typedef std::function<void(Context&)> PassFunc;
+
+    void Reset()
+    {
+        FrameGraphCompiler::Reset();
+        mFuncs.clear();
+    }
+
+    uint32_t AddPass(const char* name, std::initializer_list<FrameGraphAccess> accesses, PassFunc execute,
+        bool sideEffects = false)
+    {
+        mFuncs.push_back(std::move(execute));
+        return AddPassDeclaration(name, accesses.begin(), accesses.size(), sideEffects);
+    }
+
+    //在一个列表中按顺序录制所有pass(不包括最终的状态转换)
+    void Execute(Context& context)
+    {
+        RecordRange(context, 0, GetExecutionOrder().size());
+    }
+
+    //执行顺序切成contextCount块并行录制，第i块录制到contexts[i]，按contexts的顺序提交即可
+    void Execute(JobSystem& jobs, Context* const* contexts, size_t contextCount)
+    {
+        ParallelRecord(jobs, contexts, contextCount, GetExecutionOrder().size(),
+            [this](Context& context, size_t, size_t begin, size_t end) { RecordRange(context, begin, end); });
+    }
+
+    //导入资源转换到最终状态，录制在最后提交的列表末尾
+    void RecordFinalTransitions(Context& context) const
+    {
+        std::vector<ResourceTransition> transitions;
+        ToResourceTransitions(GetFinalTransitions().data(), GetFinalTransitions().size(), transitions);
+        if (!transitions.empty())
+        {
+            context.ResourceBarrier(static_cast<uint32_t>(transitions.size()), transitions.data());
+        }
+    }
+
+private:
+    void RecordRange(Context& context, size_t begin, size_t end)
+    {
+        const TransientMemoryPlan& plan = GetMemoryPlan();
+        std::vector<ResourceTransition> transitions;
+        for (size_t position = begin; position < end; ++position)
+        {
+            //Barriers按Pass排序
+            auto barrier = std::lower_bound(plan.Barriers.begin(), plan.Barriers.end(), position,
+                [](const TransientAliasingBarrier& b, size_t value) { return b.Pass < value; });
+            for (; barrier != plan.Barriers.end() && barrier->Pass == position; ++barrier)
+            {
+                context.AliasingBarrier(
+                    barrier->Before == TransientAliasingBarrier::AnyResource ? nullptr : GetResource(barrier->Before),
+                    GetResource(barrier->After));
+            }
+
+            const FrameGraphTransition* passTransitions = nullptr;
+            size_t count = 0;
+            GetTransitions(static_cast<uint32_t>(position), passTransitions, count);
+            ToResourceTransitions(passTransitions, count, transitions);
+            if (!transitions.empty())
+            {
+                context.ResourceBarrier(static_cast<uint32_t>(transitions.size()), transitions.data());
+            }
+
+            mFuncs[GetExecutionOrder()[position]](context);
+        }
+    }
+
+    void ToResourceTransitions(const FrameGraphTransition* source, size_t count,
+        std::vector<ResourceTransition>& transitions) const
+    {
+        transitions.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            transitions[i].Resource = GetResource(source[i].Resource);
+            transitions[i].Subresource = ResourceStateTracker::AllSubresources;
+            transitions[i].StateBefore = source[i].StateBefore;
+            transitions[i].StateAfter = source[i].StateAfter;
+            transitions[i].Split = ResourceBarrierSplit::None;
+        }
+    }
+
+private:
+    std::vector<PassFunc> mFuncs;
+};
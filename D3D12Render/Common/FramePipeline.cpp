@@ -0,0 +1,59 @@
+#include "FramePipeline.h"
+
+FramePipeline::FramePipeline(JobSystem& jobs) :
+    mJobs(jobs)
+{
+}
+
+void FramePipeline::RunFrame(const StageFunc& simulate, const StageFunc& record)
+{
+    //串行模式，或流水线的第一帧：先模拟本帧
+    if (!mHasPending)
+    {
+        simulate(mFrame, SlotOf(mFrame));
+        mHasPending = true;
+    }
+
+    if (!mPipelined)
+    {
+        record(mFrame, SlotOf(mFrame));
+        mHasPending = false;
+        ++mFrame;
+        return;
+    }
+
+    //下一帧写入另一个快照，与本帧的录制互不干扰
+    const uint64_t next = mFrame + 1;
+    JobCounter simulated;
+    mJobs.Run(simulated, [&simulate, next]() { simulate(next, SlotOf(next)); });
+
+    //模拟任务引用了simulate，录制出错时也要等它结束
+    std::exception_ptr error;
+    try
+    {
+        record(mFrame, SlotOf(mFrame));
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+    try
+    {
+        mJobs.Wait(simulated);
+    }
+    catch (...)
+    {
+        //下一帧的快照不完整，重新模拟
+        mHasPending = false;
+        if (!error)
+        {
+            error = std::current_exception();
+        }
+    }
+
+    ++mFrame;
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
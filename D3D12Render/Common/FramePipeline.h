@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include "JobSystem.h"
+
+//帧的两个阶段：模拟(Update，产生渲染快照)与录制(Draw，读取快照录制并提交命令)，与平台无关
+//串行模式下每帧先模拟再录制；流水线模式下模拟第N+1帧与录制第N帧同时进行，
+//帧率由两者中较慢的一个决定，代价是输入到画面多一帧延迟
+//两个阶段之间通过双缓冲的快照传递数据：快照存放在调用者手中，下标为slot，
+//模拟阶段只能写入自己slot的快照，录制阶段只能读取自己slot的快照，除此之外两个阶段不能访问共享的可变状态
+class FramePipeline
+{
+public:
+    static const uint32_t SlotCount = 2;
+
+    //frame为帧序号，slot为本阶段使用的快照下标
+    typedef std::function<void(uint64_t frame, uint32_t slot)> StageFunc;
+
+    //模拟阶段作为任务在jobs中执行，录制阶段在调用线程中执行
+    explicit FramePipeline(JobSystem& jobs);
+    FramePipeline(const FramePipeline& rhs) = delete;
+    FramePipeline& operator=(const FramePipeline& rhs) = delete;
+
+    //切换模式在下一帧生效；从流水线切回串行时，已经模拟好的那一帧仍会被录制
+    void SetPipelined(bool pipelined) { mPipelined = pipelined; }
+    bool IsPipelined() const { return mPipelined; }
+
+    //执行一帧：录制第GetFrameIndex()帧，流水线模式下同时模拟下一帧
+    void RunFrame(const StageFunc& simulate, const StageFunc& record);
+
+    //丢弃已经模拟但尚未录制的帧(如窗口大小改变使快照失效)，下一帧重新模拟
+    void DiscardPending() { mHasPending = false; }
+
+    //下一次RunFrame录制的帧序号
+    uint64_t GetFrameIndex() const { return mFrame; }
+
+    static uint32_t SlotOf(uint64_t frame) { return static_cast<uint32_t>(frame % SlotCount); }
+
+private:
+    JobSystem& mJobs;
+    bool mPipelined = false;
+    //第mFrame帧的快照已经模拟好
+    bool mHasPending = false;
+    uint64_t mFrame = 0;
+};
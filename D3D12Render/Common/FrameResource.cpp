@@ -1,8 +1,23 @@
 #include "FrameResource.h"
 
-FrameResource::FrameResource(ID3D12Device* device, UINT passCount, UINT objectCount)
+FrameResource::FrameResource(ID3D12Device* device, UINT passCount, UINT objectCount, UINT workerCount, UINT timestampCount)
 {
     ThrowIfFailed(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&CmdListAllocator)));
+    WorkerCmdListAllocators.resize(workerCount);
+    for (auto& allocator : WorkerCmdListAllocators)
+    {
+        ThrowIfFailed(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(allocator.GetAddressOf())));
+    }
+    if (timestampCount > 0)
+    {
+        ThrowIfFailed(device->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer(timestampCount * sizeof(UINT64)),
+            D3D12_RESOURCE_STATE_COPY_DEST,
+            nullptr,
+            IID_PPV_ARGS(TimestampReadback.GetAddressOf())));
+    }
     ObjectCB = std::make_unique<UploadBuffer<ObjectConstants>>(device,objectCount,true);
     PassCB = std::make_unique<UploadBuffer<PassConstants>>(device, passCount, true);
 }
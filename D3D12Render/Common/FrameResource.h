@@ -50,13 +50,19 @@ public:
 
     //构造函数与析构函数
     //不希望帧资源可以被复制，所以把他们的复制构造函数与复制运算符都定义为delete
-    FrameResource(ID3D12Device* device, UINT passCount, UINT objectCount);
+    //workerCount为并行录制命令列表的线程数，每个线程一个命令分配器
+    //timestampCount为GPU时间戳回读缓冲区能容纳的时间戳个数(GpuProfiler::GetTimestampsPerSlot)，为0时不创建
+    FrameResource(ID3D12Device* device, UINT passCount, UINT objectCount, UINT workerCount = 0, UINT timestampCount = 0);
     FrameResource(const FrameResource& rhs) = delete;
     FrameResource& operator=(const FrameResource& rhs) = delete;
     ~FrameResource();
 
     //每个帧资源都应该有自己的命令分配器
     Microsoft::WRL::ComPtr<ID3D12CommandAllocator> CmdListAllocator;
+    //并行录制时每个工作线程的命令分配器，命令分配器不能被多个线程同时使用
+    std::vector<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>> WorkerCmdListAllocators;
+    //本帧GPU时间戳的回读缓冲区，与命令分配器一样在这一帧的命令执行完之后才能读取
+    Microsoft::WRL::ComPtr<ID3D12Resource> TimestampReadback;
 
     //帧资源中存储本帧绘制时渲染流水线所需要的常量缓冲区数据
     std::unique_ptr<UploadBuffer<ObjectConstants>> ObjectCB = nullptr;
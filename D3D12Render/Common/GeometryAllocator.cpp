@@ -0,0 +1,99 @@
+#include "GeometryAllocator.h"
+
+#include <cassert>
+#include <cstring>
+
+GeometryAllocator::GeometryAllocator(const std::vector<uint32_t>& vertexStrides,
+    uint32_t vertexCapacity,
+    uint32_t indexCapacity,
+    uint32_t indexSize) :
+    mStrides(vertexStrides),
+    mIndexSize(indexSize),
+    mVertexAllocator(vertexCapacity),
+    mIndexAllocator(indexCapacity)
+{
+    assert(indexSize == 2 || indexSize == 4);
+}
+
+bool GeometryAllocator::Allocate(uint32_t vertexCount, uint32_t indexCount, GeometryAllocation& allocation)
+{
+    allocation = GeometryAllocation();
+
+    //16位索引只能引用BaseVertexLocation之后的65536个顶点
+    if (mIndexSize == 2 && vertexCount > 65536)
+    {
+        return false;
+    }
+
+    allocation.Vertices = mVertexAllocator.Allocate(vertexCount);
+    if (!allocation.Vertices.IsValid())
+    {
+        return false;
+    }
+
+    allocation.Indices = mIndexAllocator.Allocate(indexCount);
+    if (!allocation.Indices.IsValid())
+    {
+        mVertexAllocator.Free(allocation.Vertices);
+        allocation = GeometryAllocation();
+        return false;
+    }
+    return true;
+}
+
+void GeometryAllocator::Free(GeometryAllocation& allocation)
+{
+    mVertexAllocator.Free(allocation.Vertices);
+    mIndexAllocator.Free(allocation.Indices);
+    allocation = GeometryAllocation();
+}
+
+void GeometryAllocator::Write(const GeometryAllocation& allocation, const void* const* streamData, const void* indexData)
+{
+    assert(allocation.IsValid());
+
+    for (uint32_t i = 0; i < GetStreamCount(); ++i)
+    {
+        const uint64_t stride = mStrides[i];
+        AddCopy(i, stride * allocation.Vertices.Offset, streamData[i], stride * allocation.Vertices.Size);
+    }
+    AddCopy(GetStreamCount(), (uint64_t)mIndexSize * allocation.Indices.Offset,
+        indexData, (uint64_t)mIndexSize * allocation.Indices.Size);
+}
+
+void GeometryAllocator::AddCopy(uint32_t target, uint64_t dstOffset, const void* data, uint64_t size)
+{
+    const size_t srcOffset = (mStagingData.size() + (size_t)StagingAlignment - 1) & ~((size_t)StagingAlignment - 1);
+    mStagingData.resize(srcOffset + (size_t)size);
+    memcpy(mStagingData.data() + srcOffset, data, (size_t)size);
+
+    GeometryCopy copy;
+    copy.Target = target;
+    copy.DstOffset = dstOffset;
+    copy.SrcOffset = srcOffset;
+    copy.Size = size;
+    mPendingCopies.push_back(copy);
+}
+
+std::vector<bool> GeometryAllocator::GetTouchedTargets() const
+{
+    std::vector<bool> touched(GetStreamCount() + 1, false);
+    for (const GeometryCopy& copy : mPendingCopies)
+    {
+        touched[copy.Target] = true;
+    }
+    return touched;
+}
+
+void GeometryAllocator::ClearPending()
+{
+    mPendingCopies.clear();
+    mStagingData.clear();
+}
+
+uint64_t GeometryAllocator::GetTargetSize(uint32_t target) const
+{
+    return target < GetStreamCount() ?
+        (uint64_t)mStrides[target] * mVertexAllocator.GetCapacity() :
+        (uint64_t)mIndexSize * mIndexAllocator.GetCapacity();
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+//GeometryPool的子分配与暂存部分，不依赖D3D设备
+//顶点与索引各用一个TLSFAllocator按个数分配，写入的数据先拷贝到暂存区，并记录每段数据要复制到哪个缓冲区的哪个位置
+
+#include <cstdint>
+#include <vector>
+#include "TLSFAllocator.h"
+
+//一个网格在几何池中的位置。所有顶点流共用同一段顶点区间，因此BaseVertexLocation对每个流都成立
+struct GeometryAllocation
+{
+    TLSFAllocator::Allocation Vertices;
+    TLSFAllocator::Allocation Indices;
+
+    bool IsValid() const { return Vertices.IsValid() && Indices.IsValid(); }
+
+    int32_t BaseVertexLocation() const { return (int32_t)Vertices.Offset; }
+    uint32_t StartIndexLocation() const { return Indices.Offset; }
+};
+
+//一段待复制的数据：从暂存区的SrcOffset复制Size字节到目标缓冲区的DstOffset
+//Target为顶点流序号，等于流数量时表示索引缓冲区
+struct GeometryCopy
+{
+    uint32_t Target = 0;
+    uint64_t DstOffset = 0;
+    uint64_t SrcOffset = 0;
+    uint64_t Size = 0;
+};
+
+class GeometryAllocator
+{
+public:
+    //暂存区中每段数据的起始位置按该值对齐
+    static const uint64_t StagingAlignment = 16;
+
+    //vertexStrides[i]为第i个顶点流的步长，indexSize为2(16位索引)或4(32位索引)
+    GeometryAllocator(const std::vector<uint32_t>& vertexStrides,
+        uint32_t vertexCapacity,
+        uint32_t indexCapacity,
+        uint32_t indexSize);
+
+    //空间不足、个数为0，或16位索引的网格超过65536个顶点时返回false
+    bool Allocate(uint32_t vertexCount, uint32_t indexCount, GeometryAllocation& allocation);
+
+    //调用者需要保证GPU已不再使用这段几何数据(等待对应的fence)
+    void Free(GeometryAllocation& allocation);
+
+    //写入网格数据：streamData[i]为第i个流的全部顶点，indexData为全部索引(相对于该网格的第一个顶点)
+    //数据立即拷贝到暂存区，之后由GetPendingCopies取出
+    void Write(const GeometryAllocation& allocation, const void* const* streamData, const void* indexData);
+
+    bool HasPendingCopies() const { return !mPendingCopies.empty(); }
+    const std::vector<GeometryCopy>& GetPendingCopies() const { return mPendingCopies; }
+    const std::vector<uint8_t>& GetStagingData() const { return mStagingData; }
+    //待复制的数据是否写入了target，下标与GeometryCopy::Target一致
+    std::vector<bool> GetTouchedTargets() const;
+    //待复制的数据已经录制，清空暂存区
+    void ClearPending();
+
+    uint32_t GetStreamCount() const { return (uint32_t)mStrides.size(); }
+    uint32_t GetStride(uint32_t stream) const { return mStrides[stream]; }
+    uint32_t GetIndexSize() const { return mIndexSize; }
+    //目标缓冲区的字节数
+    uint64_t GetTargetSize(uint32_t target) const;
+
+    const TLSFAllocator& GetVertexAllocator() const { return mVertexAllocator; }
+    const TLSFAllocator& GetIndexAllocator() const { return mIndexAllocator; }
+
+private:
+    void AddCopy(uint32_t target, uint64_t dstOffset, const void* data, uint64_t size);
+
+private:
+    std::vector<uint32_t> mStrides;
+    uint32_t mIndexSize = 2;
+
+    TLSFAllocator mVertexAllocator;
+    TLSFAllocator mIndexAllocator;
+
+    std::vector<uint8_t> mStagingData;
+    std::vector<GeometryCopy> mPendingCopies;
+};
@@ -0,0 +1,226 @@
+#include "GeometryPool.h"
+#include "CopyQueue.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+    ComPtr<ID3D12Resource> CreatePoolBuffer(ID3D12Device* device, UINT64 byteSize)
+    {
+        ComPtr<ID3D12Resource> buffer;
+        ThrowIfFailed(device->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer(byteSize),
+            D3D12_RESOURCE_STATE_COMMON,
+            nullptr,
+            IID_PPV_ARGS(buffer.GetAddressOf())));
+        return buffer;
+    }
+
+    std::vector<uint32_t> ToStrides(const std::vector<UINT>& vertexStrides)
+    {
+        return std::vector<uint32_t>(vertexStrides.begin(), vertexStrides.end());
+    }
+}
+
+GeometryPool::GeometryPool(ID3D12Device* device,
+    ResourceStateTracker& stateTracker,
+    const std::vector<UINT>& vertexStrides,
+    UINT vertexCapacity,
+    UINT indexCapacity,
+    DXGI_FORMAT indexFormat) :
+    mDevice(device),
+    mStateTracker(stateTracker),
+    mAllocator(ToStrides(vertexStrides), vertexCapacity, indexCapacity, indexFormat == DXGI_FORMAT_R32_UINT ? 4 : 2),
+    mIndexFormat(indexFormat)
+{
+    assert(indexFormat == DXGI_FORMAT_R16_UINT || indexFormat == DXGI_FORMAT_R32_UINT);
+
+    mBuffers.resize(GetStreamCount() + 1);
+    for (UINT target = 0; target < (UINT)mBuffers.size(); ++target)
+    {
+        //视图的SizeInBytes为UINT，单个缓冲区不能超过4GB
+        assert(mAllocator.GetTargetSize(target) <= UINT_MAX);
+        mBuffers[target] = CreatePoolBuffer(device, mAllocator.GetTargetSize(target));
+        mStateTracker.Register(mBuffers[target].Get(), 1, D3D12_RESOURCE_STATE_COMMON);
+    }
+}
+
+GeometryPool::~GeometryPool()
+{
+    for (auto& buffer : mBuffers)
+    {
+        mStateTracker.Unregister(buffer.Get());
+    }
+}
+
+ID3D12Resource* GeometryPool::GetTargetBuffer(UINT target) const
+{
+    return mBuffers[target].Get();
+}
+
+D3D12_RESOURCE_STATES GeometryPool::GetRestingState(UINT target) const
+{
+    return target < GetStreamCount() ? D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER : D3D12_RESOURCE_STATE_INDEX_BUFFER;
+}
+
+ComPtr<ID3D12Resource> GeometryPool::RecordCopies(ID3D12GraphicsCommandList* cmdList)
+{
+    const std::vector<uint8_t>& stagingData = mAllocator.GetStagingData();
+
+    ComPtr<ID3D12Resource> staging;
+    ThrowIfFailed(mDevice->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer(stagingData.size()),
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(staging.GetAddressOf())));
+
+    BYTE* mapped = nullptr;
+    CD3DX12_RANGE readRange(0, 0);
+    ThrowIfFailed(staging->Map(0, &readRange, reinterpret_cast<void**>(&mapped)));
+    memcpy(mapped, stagingData.data(), stagingData.size());
+    staging->Unmap(0, nullptr);
+
+    for (const GeometryCopy& copy : mAllocator.GetPendingCopies())
+    {
+        cmdList->CopyBufferRegion(GetTargetBuffer(copy.Target), copy.DstOffset,
+            staging.Get(), copy.SrcOffset, copy.Size);
+    }
+    return staging;
+}
+
+void GeometryPool::Record(ID3D12GraphicsCommandList* cmdList)
+{
+    if (!mAllocator.HasPendingCopies())
+    {
+        return;
+    }
+
+    //只转换本次写入涉及的缓冲区，其余缓冲区也转换到常驻状态，状态相同时tracker不产生转换
+    const std::vector<bool> touched = mAllocator.GetTouchedTargets();
+    for (UINT target = 0; target < (UINT)mBuffers.size(); ++target)
+    {
+        if (touched[target])
+        {
+            mStateTracker.Transition(GetTargetBuffer(target), D3D12_RESOURCE_STATE_COPY_DEST);
+        }
+    }
+    D3DBarrierRecorder barriers(cmdList);
+    mStateTracker.Flush(barriers);
+
+    InFlightStaging staging;
+    staging.Buffer = RecordCopies(cmdList);
+
+    for (UINT target = 0; target < (UINT)mBuffers.size(); ++target)
+    {
+        mStateTracker.Transition(GetTargetBuffer(target), GetRestingState(target));
+    }
+    mStateTracker.Flush(barriers);
+
+    mInFlight.push_back(staging);
+    mAllocator.ClearPending();
+}
+
+void GeometryPool::SetReleaseFence(ID3D12Fence* fence, UINT64 fenceValue)
+{
+    for (auto& staging : mInFlight)
+    {
+        if (staging.Fence == nullptr)
+        {
+            staging.Fence = fence;
+            staging.FenceValue = fenceValue;
+        }
+    }
+}
+
+void GeometryPool::ReleaseCompletedStaging()
+{
+    auto completed = [](const InFlightStaging& staging)
+    {
+        return staging.Fence != nullptr && staging.Fence->GetCompletedValue() >= staging.FenceValue;
+    };
+    mInFlight.erase(std::remove_if(mInFlight.begin(), mInFlight.end(), completed), mInFlight.end());
+}
+
+UINT64 GeometryPool::Upload(CopyQueue& copyQueue)
+{
+    if (!mAllocator.HasPendingCopies())
+    {
+        return 0;
+    }
+
+    const std::vector<bool> touched = mAllocator.GetTouchedTargets();
+    std::vector<ID3D12Resource*> targets;
+    for (UINT target = 0; target < (UINT)mBuffers.size(); ++target)
+    {
+        //复制队列上只能在COMMON状态下隐式提升为COPY_DEST
+        assert(mStateTracker.GetState(GetTargetBuffer(target)) == D3D12_RESOURCE_STATE_COMMON);
+        if (touched[target])
+        {
+            targets.push_back(GetTargetBuffer(target));
+        }
+    }
+
+    CopyJob job = copyQueue.Begin();
+    ComPtr<ID3D12Resource> staging = RecordCopies(job.CmdList);
+    const UINT64 fenceValue = copyQueue.Submit(job, targets.data(), targets.size());
+    copyQueue.ReleaseAfter(fenceValue, staging);
+
+    mAllocator.ClearPending();
+    return fenceValue;
+}
+
+void GeometryPool::WaitForUse(CopyQueue& copyQueue, ID3D12CommandQueue* queue) const
+{
+    std::vector<ID3D12Resource*> buffers;
+    for (auto& buffer : mBuffers)
+    {
+        buffers.push_back(buffer.Get());
+    }
+    copyQueue.WaitForUse(queue, buffers.data(), buffers.size());
+}
+
+void GeometryPool::Bind(IRenderCommandList& list) const
+{
+    //RenderVertexBufferView与RenderIndexBufferView的布局与D3D12的视图一致
+    std::vector<D3D12_VERTEX_BUFFER_VIEW> views(GetStreamCount());
+    for (UINT stream = 0; stream < GetStreamCount(); ++stream)
+    {
+        views[stream] = GetVertexBufferView(stream);
+    }
+    list.IASetVertexBuffers(0, GetStreamCount(), reinterpret_cast<const RenderVertexBufferView*>(views.data()));
+    D3D12_INDEX_BUFFER_VIEW ibv = GetIndexBufferView();
+    list.IASetIndexBuffer(reinterpret_cast<const RenderIndexBufferView*>(&ibv));
+}
+
+SubmeshGeometry GeometryPool::MakeSubmesh(const GeometryAllocation& allocation, UINT firstIndex, UINT indexCount)
+{
+    assert(firstIndex + indexCount <= allocation.Indices.Size);
+
+    SubmeshGeometry submesh;
+    submesh.IndexCount = indexCount;
+    submesh.StartIndexLocation = allocation.StartIndexLocation() + firstIndex;
+    submesh.BaseVertexLocation = allocation.BaseVertexLocation();
+    return submesh;
+}
+
+D3D12_VERTEX_BUFFER_VIEW GeometryPool::GetVertexBufferView(UINT stream) const
+{
+    D3D12_VERTEX_BUFFER_VIEW vbv;
+    vbv.BufferLocation = mBuffers[stream]->GetGPUVirtualAddress();
+    vbv.StrideInBytes = mAllocator.GetStride(stream);
+    vbv.SizeInBytes = (UINT)mAllocator.GetTargetSize(stream);
+    return vbv;
+}
+
+D3D12_INDEX_BUFFER_VIEW GeometryPool::GetIndexBufferView() const
+{
+    D3D12_INDEX_BUFFER_VIEW ibv;
+    ibv.BufferLocation = mBuffers[GetStreamCount()]->GetGPUVirtualAddress();
+    ibv.Format = mIndexFormat;
+    ibv.SizeInBytes = (UINT)mAllocator.GetTargetSize(GetStreamCount());
+    return ibv;
+}
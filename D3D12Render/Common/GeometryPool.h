@@ -0,0 +1,92 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "GeometryAllocator.h"
+
+class CopyQueue;
+
+//全局几何池：每个顶点流一个大顶点缓冲区，外加一个大索引缓冲区，网格在其中按顶点数/索引数子分配(TLSF)
+//所有网格共用同一组缓冲区，每帧只需绑定一次IASetVertexBuffers/IASetIndexBuffer，之后的绘制只改变偏移
+//子分配与暂存由GeometryAllocator完成，缓冲区的状态由ResourceStateTracker记录
+class GeometryPool
+{
+public:
+    //vertexStrides[i]为第i个顶点流(输入槽)的步长；缓冲区创建于COMMON状态并登记到stateTracker中
+    GeometryPool(ID3D12Device* device,
+        ResourceStateTracker& stateTracker,
+        const std::vector<UINT>& vertexStrides,
+        UINT vertexCapacity,
+        UINT indexCapacity,
+        DXGI_FORMAT indexFormat = DXGI_FORMAT_R16_UINT);
+    GeometryPool(const GeometryPool& rhs) = delete;
+    GeometryPool& operator=(const GeometryPool& rhs) = delete;
+    ~GeometryPool();
+
+    //空间不足时返回false
+    bool Allocate(UINT vertexCount, UINT indexCount, GeometryAllocation& allocation)
+    {
+        return mAllocator.Allocate(vertexCount, indexCount, allocation);
+    }
+
+    //调用者需要保证GPU已不再使用这段几何数据(等待对应的fence)
+    void Free(GeometryAllocation& allocation) { mAllocator.Free(allocation); }
+
+    //写入网格数据：streamData[i]为第i个流的vertexCount个顶点，indexData为indexCount个索引(相对于该网格的第一个顶点)
+    //数据立即拷贝到暂存区，Record或Upload时统一上传
+    void Write(const GeometryAllocation& allocation, const void* const* streamData, const void* indexData)
+    {
+        mAllocator.Write(allocation, streamData, indexData);
+    }
+
+    //在graphics命令列表上上传所有未上传的写入：复制前后的状态转换由stateTracker产生，各用一次ResourceBarrier提交，
+    //之后缓冲区停留在顶点/索引缓冲区状态
+    void Record(ID3D12GraphicsCommandList* cmdList);
+
+    //提交Record所在的命令列表并Signal之后调用，之前录制的上传缓冲区在fence到达fenceValue后释放
+    void SetReleaseFence(ID3D12Fence* fence, UINT64 fenceValue);
+    void ReleaseCompletedStaging();
+
+    //在复制队列上上传所有未上传的写入，返回完成时的fence值(没有写入时返回0)；上传缓冲区由copyQueue在完成后释放
+    //复制队列上不记录状态转换，缓冲区需要处于COMMON状态(即从未经过Record)，之后在graphics队列上隐式提升
+    UINT64 Upload(CopyQueue& copyQueue);
+
+    //在queue上提交使用几何池的命令之前调用，还在复制队列上传输时让queue在GPU端等待
+    void WaitForUse(CopyQueue& copyQueue, ID3D12CommandQueue* queue) const;
+
+    //绑定所有顶点流与索引缓冲区
+    void Bind(IRenderCommandList& list) const;
+
+    //allocation中的一段索引作为子网格，firstIndex与indexCount相对于该网格
+    static SubmeshGeometry MakeSubmesh(const GeometryAllocation& allocation, UINT firstIndex, UINT indexCount);
+
+    UINT GetStreamCount() const { return mAllocator.GetStreamCount(); }
+    D3D12_VERTEX_BUFFER_VIEW GetVertexBufferView(UINT stream) const;
+    D3D12_INDEX_BUFFER_VIEW GetIndexBufferView() const;
+
+    const TLSFAllocator& GetVertexAllocator() const { return mAllocator.GetVertexAllocator(); }
+    const TLSFAllocator& GetIndexAllocator() const { return mAllocator.GetIndexAllocator(); }
+
+private:
+    struct InFlightStaging
+    {
+        Microsoft::WRL::ComPtr<ID3D12Resource> Buffer;
+        Microsoft::WRL::ComPtr<ID3D12Fence> Fence;
+        UINT64 FenceValue = 0;
+    };
+
+    //把暂存区创建为上传缓冲区，并录制所有待复制的数据
+    Microsoft::WRL::ComPtr<ID3D12Resource> RecordCopies(ID3D12GraphicsCommandList* cmdList);
+    ID3D12Resource* GetTargetBuffer(UINT target) const;
+    D3D12_RESOURCE_STATES GetRestingState(UINT target) const;
+
+private:
+    ID3D12Device* mDevice = nullptr;
+    ResourceStateTracker& mStateTracker;
+
+    GeometryAllocator mAllocator;
+    //前GetStreamCount()个为顶点缓冲区，最后一个为索引缓冲区，与GeometryCopy::Target一致
+    std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> mBuffers;
+    DXGI_FORMAT mIndexFormat = DXGI_FORMAT_R16_UINT;
+
+    std::vector<InFlightStaging> mInFlight;
+};
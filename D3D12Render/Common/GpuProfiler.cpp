@@ -0,0 +1,125 @@
+#include "GpuProfiler.h"
+
+#include <cassert>
+#include "Profiler.h"
+
+int64_t GpuClockCalibration::ToCpuTicks(uint64_t gpuTimestamp) const
+{
+    if (GpuFrequency == 0)
+    {
+        return 0;
+    }
+    //差值可能为负(校准点之前的时间戳)，先转为有符号数；用double避免乘法溢出
+    const double gpuDelta = static_cast<double>(static_cast<int64_t>(gpuTimestamp - GpuTimestamp));
+    return CpuTicks + static_cast<int64_t>(gpuDelta * CpuFrequency / GpuFrequency);
+}
+
+GpuProfiler::GpuProfiler(IGpuTimestampBackend& backend, uint32_t slotCount, uint32_t maxZonesPerFrame) :
+    mBackend(backend),
+    mSlotCount(slotCount),
+    mMaxZones(maxZonesPerFrame + 1),
+    mTimestampsPerSlot(GetTimestampsPerSlot(maxZonesPerFrame)),
+    mSlots(slotCount)
+{
+    assert(slotCount > 0);
+    mTrack = Profiler::Get().RegisterTrack("GPU");
+}
+
+void GpuProfiler::BeginFrame(uint32_t slot)
+{
+    assert(slot < mSlotCount && !mRecording);
+    Collect(slot);
+
+    mCurrentSlot = slot;
+    mRecording = true;
+    mSlots[slot].Zones.clear();
+    mOpenZones.clear();
+    BeginZone("GPU Frame");
+}
+
+void GpuProfiler::BeginZone(const char* name)
+{
+    assert(mRecording);
+    Slot& slot = mSlots[mCurrentSlot];
+    if (slot.Zones.size() >= mMaxZones)
+    {
+        ++mDroppedZones;
+        mOpenZones.push_back(~0u);
+        return;
+    }
+
+    const uint32_t index = static_cast<uint32_t>(slot.Zones.size());
+    Zone zone;
+    zone.Name = name;
+    zone.Depth = static_cast<uint32_t>(mOpenZones.size());
+    slot.Zones.push_back(zone);
+    mOpenZones.push_back(index);
+    mBackend.WriteTimestamp(mCurrentSlot * mTimestampsPerSlot + index * 2);
+}
+
+void GpuProfiler::EndZone()
+{
+    assert(mRecording && !mOpenZones.empty());
+    const uint32_t index = mOpenZones.back();
+    mOpenZones.pop_back();
+    if (index != ~0u)
+    {
+        mBackend.WriteTimestamp(mCurrentSlot * mTimestampsPerSlot + index * 2 + 1);
+    }
+}
+
+void GpuProfiler::EndFrame()
+{
+    //只剩整帧区间
+    assert(mRecording && mOpenZones.size() == 1);
+    while (!mOpenZones.empty())
+    {
+        EndZone();
+    }
+
+    Slot& slot = mSlots[mCurrentSlot];
+    mBackend.ResolveTimestamps(mCurrentSlot, mCurrentSlot * mTimestampsPerSlot,
+        static_cast<uint32_t>(slot.Zones.size() * 2));
+    slot.Pending = true;
+    mRecording = false;
+}
+
+void GpuProfiler::Collect(uint32_t slotIndex)
+{
+    Slot& slot = mSlots[slotIndex];
+    if (!slot.Pending)
+    {
+        return;
+    }
+    slot.Pending = false;
+
+    const uint32_t count = static_cast<uint32_t>(slot.Zones.size() * 2);
+    mTimestamps.resize(count);
+    mBackend.ReadTimestamps(slotIndex, count, mTimestamps.data());
+
+    if (mCollectsSinceCalibration >= CalibrationInterval)
+    {
+        mCalibration = mBackend.GetCalibration();
+        mCollectsSinceCalibration = 0;
+    }
+    ++mCollectsSinceCalibration;
+
+    mLastResults.resize(slot.Zones.size());
+    std::vector<ProfileEvent> events(slot.Zones.size());
+    for (size_t i = 0; i < slot.Zones.size(); ++i)
+    {
+        GpuZoneResult& result = mLastResults[i];
+        result.Name = slot.Zones[i].Name;
+        result.Depth = slot.Zones[i].Depth;
+        result.Start = mCalibration.ToCpuTicks(mTimestamps[i * 2]);
+        result.End = mCalibration.ToCpuTicks(mTimestamps[i * 2 + 1]);
+
+        ProfileEvent& event = events[i];
+        event.Name = result.Name;
+        event.Start = result.Start;
+        event.End = result.End;
+        event.Thread = mTrack;
+        event.Depth = result.Depth;
+    }
+    Profiler::Get().SubmitEvents(events.data(), events.size());
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+//同一时刻的GPU时间戳与CPU计数(D3D12中由ID3D12CommandQueue::GetClockCalibration得到，CPU端为QueryPerformanceCounter，与GameTimer、ProfilerClock一致)
+struct GpuClockCalibration
+{
+    uint64_t GpuTimestamp = 0;
+    int64_t CpuTicks = 0;
+    uint64_t GpuFrequency = 0;
+    int64_t CpuFrequency = 0;
+
+    //把GPU时间戳换算为CPU计数
+    int64_t ToCpuTicks(uint64_t gpuTimestamp) const;
+};
+
+//时间戳查询的后端：D3D12中为查询堆与每个帧资源中的回读缓冲区，测试中可以换成生成假时间戳的实现
+class IGpuTimestampBackend
+{
+public:
+    virtual ~IGpuTimestampBackend() = default;
+
+    //在当前命令列表上记录一个时间戳到query
+    virtual void WriteTimestamp(uint32_t query) = 0;
+    //在当前命令列表上把[firstQuery, firstQuery + count)解析到slot的回读缓冲区开头
+    virtual void ResolveTimestamps(uint32_t slot, uint32_t firstQuery, uint32_t count) = 0;
+    //读取slot回读缓冲区中的前count个时间戳，调用时解析命令已经执行完毕
+    virtual void ReadTimestamps(uint32_t slot, uint32_t count, uint64_t* timestamps) = 0;
+    virtual GpuClockCalibration GetCalibration() = 0;
+};
+
+//换算到CPU时间线上的GPU区间
+struct GpuZoneResult
+{
+    const char* Name = nullptr;
+    int64_t Start = 0;      //ProfilerClock的计数
+    int64_t End = 0;
+    uint32_t Depth = 0;     //0为整帧
+};
+
+//按名称标记GPU区间，用时间戳查询测量，与平台无关
+//查询与回读缓冲区按帧资源分成slotCount份：某个slot的结果在下一次使用这个slot(BeginFrame)时读取，
+//此时这个slot上一帧的命令已经执行完毕(与帧资源的复用条件相同)，因此读取不会等待GPU
+//读到的区间换算为CPU计数后提交给Profiler，与CPU区间合并为一条时间线
+class GpuProfiler
+{
+public:
+    GpuProfiler(IGpuTimestampBackend& backend, uint32_t slotCount, uint32_t maxZonesPerFrame);
+    GpuProfiler(const GpuProfiler& rhs) = delete;
+    GpuProfiler& operator=(const GpuProfiler& rhs) = delete;
+
+    //每个slot需要的时间戳个数(回读缓冲区的大小为其8倍)，整帧区间也占用一个
+    static uint32_t GetTimestampsPerSlot(uint32_t maxZonesPerFrame) { return (maxZonesPerFrame + 1) * 2; }
+    uint32_t GetQueryCount() const { return mSlotCount * mTimestampsPerSlot; }
+
+    //先读取这个slot上一帧的结果，再开始记录新的一帧(并打开整帧区间)
+    void BeginFrame(uint32_t slot);
+    //name需要是静态生存期的字符串；超出maxZonesPerFrame的区间被丢弃
+    void BeginZone(const char* name);
+    void EndZone();
+    //关闭整帧区间并记录解析命令
+    void EndFrame();
+
+    //读取slot的结果，BeginFrame会自动调用；调用者已经确认GPU执行完毕时(如刷新了命令队列)也可以直接调用
+    void Collect(uint32_t slot);
+
+    //最近一次读取到的一帧，第一个为整帧区间
+    const std::vector<GpuZoneResult>& GetLastResults() const { return mLastResults; }
+    uint64_t GetDroppedZones() const { return mDroppedZones; }
+
+    //每隔多少次读取重新校准一次时钟(两个时钟会缓慢漂移)
+    static const uint32_t CalibrationInterval = 64;
+
+private:
+    struct Zone
+    {
+        const char* Name = nullptr;
+        uint32_t Depth = 0;
+    };
+
+    struct Slot
+    {
+        std::vector<Zone> Zones;    //第i个区间使用第2i、2i+1个时间戳
+        bool Pending = false;
+    };
+
+private:
+    IGpuTimestampBackend& mBackend;
+    uint32_t mSlotCount = 0;
+    uint32_t mMaxZones = 0;
+    uint32_t mTimestampsPerSlot = 0;
+
+    std::vector<Slot> mSlots;
+    uint32_t mCurrentSlot = 0;
+    bool mRecording = false;
+    std::vector<uint32_t> mOpenZones;   //打开的区间序号，超出容量的为~0u
+    uint64_t mDroppedZones = 0;
+
+    GpuClockCalibration mCalibration;
+    uint32_t mCollectsSinceCalibration = CalibrationInterval;
+    uint32_t mTrack = 0;
+    std::vector<uint64_t> mTimestamps;
+    std::vector<GpuZoneResult> mLastResults;
+};
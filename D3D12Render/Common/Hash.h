@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+//64位非加密哈希(算法与XXH64相同)，用于缓存的键值与内容校验
+class Hash
+{
+public:
+    static uint64_t Hash64(const void* data, size_t size, uint64_t seed = 0)
+    {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        const uint8_t* end = p + size;
+        uint64_t h;
+
+        if (size >= 32)
+        {
+            uint64_t v1 = seed + Prime1 + Prime2;
+            uint64_t v2 = seed + Prime2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - Prime1;
+
+            const uint8_t* limit = end - 32;
+            do
+            {
+                v1 = Round(v1, Read64(p));
+                v2 = Round(v2, Read64(p + 8));
+                v3 = Round(v3, Read64(p + 16));
+                v4 = Round(v4, Read64(p + 24));
+                p += 32;
+            } while (p <= limit);
+
+            h = Rotl(v1, 1) + Rotl(v2, 7) + Rotl(v3, 12) + Rotl(v4, 18);
+            h = MergeRound(h, v1);
+            h = MergeRound(h, v2);
+            h = MergeRound(h, v3);
+            h = MergeRound(h, v4);
+        }
+        else
+        {
+            h = seed + Prime5;
+        }
+
+        h += static_cast<uint64_t>(size);
+
+        while (p + 8 <= end)
+        {
+            h ^= Round(0, Read64(p));
+            h = Rotl(h, 27) * Prime1 + Prime4;
+            p += 8;
+        }
+        if (p + 4 <= end)
+        {
+            h ^= static_cast<uint64_t>(Read32(p)) * Prime1;
+            h = Rotl(h, 23) * Prime2 + Prime3;
+            p += 4;
+        }
+        while (p < end)
+        {
+            h ^= (*p) * Prime5;
+            h = Rotl(h, 11) * Prime1;
+            ++p;
+        }
+
+        h ^= h >> 33;
+        h *= Prime2;
+        h ^= h >> 29;
+        h *= Prime3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    //把value合并进已有的哈希值
+    static uint64_t Combine(uint64_t seed, uint64_t value)
+    {
+        return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+    }
+
+private:
+    static const uint64_t Prime1 = 11400714785074694791ull;
+    static const uint64_t Prime2 = 14029467366897019727ull;
+    static const uint64_t Prime3 = 1609587929392839161ull;
+    static const uint64_t Prime4 = 9650029242287828579ull;
+    static const uint64_t Prime5 = 2870177450012600261ull;
+
+    static uint64_t Rotl(uint64_t x, int r)
+    {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    static uint64_t Read64(const uint8_t* p)
+    {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    static uint32_t Read32(const uint8_t* p)
+    {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    static uint64_t Round(uint64_t acc, uint64_t input)
+    {
+        acc += input * Prime2;
+        acc = Rotl(acc, 31);
+        return acc * Prime1;
+    }
+
+    static uint64_t MergeRound(uint64_t acc, uint64_t val)
+    {
+        acc ^= Round(0, val);
+        return acc * Prime1 + Prime4;
+    }
+};
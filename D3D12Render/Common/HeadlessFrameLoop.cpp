@@ -0,0 +1,86 @@
+#include "HeadlessFrameLoop.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    double ToMs(Clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+}
+
+HeadlessFrameLoop::HeadlessFrameLoop(IRenderDevice& device, uint32_t framesInFlight) :
+    mDevice(device)
+{
+    assert(framesInFlight > 0);
+    mQueue = mDevice.CreateQueue(RenderQueueType::Direct);
+    mFence = mDevice.CreateFence(0);
+    for (uint32_t i = 0; i < framesInFlight; ++i)
+    {
+        mLists.push_back(mDevice.CreateCommandList(RenderQueueType::Direct));
+    }
+    mListFences.assign(framesInFlight, 0);
+}
+
+HeadlessFrameLoop::~HeadlessFrameLoop()
+{
+    Flush();
+}
+
+HeadlessFrameStats HeadlessFrameLoop::Run(uint32_t frameCount, const RecordFunc& record)
+{
+    HeadlessFrameStats stats;
+    std::vector<double> frameMs;
+    frameMs.reserve(frameCount);
+
+    for (uint32_t i = 0; i < frameCount; ++i, ++mFrame)
+    {
+        const size_t slot = static_cast<size_t>(mFrame % mLists.size());
+
+        //这个命令列表上次提交的帧完成之后才能复用
+        Clock::time_point waitStart = Clock::now();
+        mFence->WaitForValue(mListFences[slot]);
+        Clock::time_point start = Clock::now();
+        stats.WaitMs += ToMs(start - waitStart);
+
+        IRenderCommandList* list = mLists[slot].get();
+        list->Reset(0);
+        record(*list, mFrame);
+        list->Close();
+        mQueue->ExecuteCommandLists(1, &list);
+        mListFences[slot] = mFrame + 1;
+        mQueue->Signal(*mFence, mFrame + 1);
+
+        frameMs.push_back(ToMs(Clock::now() - start));
+    }
+
+    stats.FrameCount = frameCount;
+    if (frameCount > 0)
+    {
+        double total = 0.0;
+        for (double ms : frameMs)
+        {
+            total += ms;
+        }
+        stats.MeanMs = total / frameCount;
+
+        std::sort(frameMs.begin(), frameMs.end());
+        stats.P50Ms = frameMs[(frameCount - 1) / 2];
+        stats.P95Ms = frameMs[(frameCount - 1) * 95 / 100];
+        stats.MaxMs = frameMs.back();
+    }
+    return stats;
+}
+
+void HeadlessFrameLoop::Flush()
+{
+    if (mFrame > 0)
+    {
+        mFence->WaitForValue(mFrame);
+    }
+}
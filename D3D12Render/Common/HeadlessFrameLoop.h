@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "RenderBackend.h"
+
+struct HeadlessFrameStats
+{
+    uint32_t FrameCount = 0;
+    //每帧录制与提交的CPU耗时(不含等待GPU的时间)
+    double MeanMs = 0.0;
+    double P50Ms = 0.0;
+    double P95Ms = 0.0;
+    double MaxMs = 0.0;
+    //因在途帧数达到上限而等待GPU的总时间
+    double WaitMs = 0.0;
+};
+
+//不依赖窗口与交换链的帧循环：每帧录制一个命令列表并提交到队列，最多framesInFlight帧同时在途
+//与NullRenderDevice配合可以在没有显卡的环境(如CI)中测量每帧的CPU开销
+class HeadlessFrameLoop
+{
+public:
+    //录制一帧的命令，list已经Reset，返回后由帧循环Close并提交
+    typedef std::function<void(IRenderCommandList& list, uint64_t frame)> RecordFunc;
+
+    HeadlessFrameLoop(IRenderDevice& device, uint32_t framesInFlight = 2);
+    HeadlessFrameLoop(const HeadlessFrameLoop& rhs) = delete;
+    HeadlessFrameLoop& operator=(const HeadlessFrameLoop& rhs) = delete;
+    //等待所有提交的帧完成
+    ~HeadlessFrameLoop();
+
+    HeadlessFrameStats Run(uint32_t frameCount, const RecordFunc& record);
+
+    //等待所有提交的帧完成
+    void Flush();
+
+private:
+    IRenderDevice& mDevice;
+    std::unique_ptr<IRenderQueue> mQueue;
+    std::unique_ptr<IRenderFence> mFence;
+    std::vector<std::unique_ptr<IRenderCommandList>> mLists;
+    //每个命令列表最后一次提交时的fence值
+    std::vector<uint64_t> mListFences;
+    uint64_t mFrame = 0;
+};
@@ -0,0 +1,249 @@
+#include "JobSystem.h"
+
+#include "Profiler.h"
+
+namespace
+{
+    //当前线程所属的任务系统与队列，非工作线程为nullptr
+    thread_local const JobSystem* tCurrentSystem = nullptr;
+    thread_local uint32_t tCurrentQueue = 0;
+}
+
+JobSystem::JobSystem(uint32_t threadCount) :
+    mQueuedJobs(0),
+    mSleepers(0),
+    mExecuted(0),
+    mStolen(0)
+{
+    if (threadCount == 0)
+    {
+        const uint32_t hwThreads = std::thread::hardware_concurrency();
+        threadCount = std::max(hwThreads, 2u) - 1;
+    }
+
+    for (uint32_t i = 0; i < threadCount + 1; ++i)
+    {
+        mQueues.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    mThreads.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; ++i)
+    {
+        mThreads.emplace_back(&JobSystem::WorkerMain, this, i);
+    }
+}
+
+JobSystem& JobSystem::GetDefault()
+{
+    //工作线程会使用Profiler，先构造它，保证它在任务系统之后析构
+    Profiler::Get();
+    static JobSystem jobs;
+    return jobs;
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mStopping = true;
+    }
+    mWake.notify_all();
+
+    for (auto& t : mThreads)
+    {
+        t.join();
+    }
+}
+
+void JobSystem::Run(JobCounter& counter, std::function<void()> func)
+{
+    counter.mPending.fetch_add(1, std::memory_order_relaxed);
+
+    Job job;
+    job.Func = std::move(func);
+    job.Counter = &counter;
+    Push(std::move(job));
+}
+
+void JobSystem::Run(JobCounter& counter, std::function<void()> func, JobCounter& dependency)
+{
+    counter.mPending.fetch_add(1, std::memory_order_relaxed);
+
+    Job job;
+    job.Func = std::move(func);
+    job.Counter = &counter;
+    {
+        std::lock_guard<std::mutex> lock(dependency.mMutex);
+        if (dependency.mPending.load(std::memory_order_relaxed) != 0)
+        {
+            dependency.mWaiters.push_back(std::move(job));
+            return;
+        }
+    }
+    Push(std::move(job));
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+    const uint32_t queue = CurrentQueue();
+    while (!counter.IsDone())
+    {
+        if (!TryRunOne(queue))
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    //Complete在锁内递减，拿到锁之后它已经不再访问counter
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(counter.mMutex);
+        error = counter.mError;
+        counter.mError = nullptr;
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+JobSystemStats JobSystem::GetStats() const
+{
+    JobSystemStats stats;
+    stats.Executed = mExecuted.load(std::memory_order_relaxed);
+    stats.Stolen = mStolen.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void JobSystem::Push(Job&& job)
+{
+    WorkerQueue& queue = *mQueues[CurrentQueue()];
+    {
+        std::lock_guard<std::mutex> lock(queue.Mutex);
+        queue.Jobs.push_back(std::move(job));
+    }
+
+    //工作线程先登记mSleepers再检查mQueuedJobs，这里先增加mQueuedJobs再检查mSleepers，两边至少有一方能看到对方
+    mQueuedJobs.fetch_add(1);
+    if (mSleepers.load() > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mSleepMutex);
+        }
+        mWake.notify_one();
+    }
+}
+
+bool JobSystem::TryRunOne(uint32_t queueIndex)
+{
+    Job job;
+    bool found = false;
+    {
+        //自己的队列从尾部取
+        WorkerQueue& own = *mQueues[queueIndex];
+        std::lock_guard<std::mutex> lock(own.Mutex);
+        if (!own.Jobs.empty())
+        {
+            job = std::move(own.Jobs.back());
+            own.Jobs.pop_back();
+            found = true;
+        }
+    }
+
+    //其他队列从头部窃取，从相邻的队列开始，避免所有线程都去窃取同一个队列
+    const uint32_t queueCount = static_cast<uint32_t>(mQueues.size());
+    for (uint32_t i = 1; !found && i < queueCount; ++i)
+    {
+        WorkerQueue& victim = *mQueues[(queueIndex + i) % queueCount];
+        std::lock_guard<std::mutex> lock(victim.Mutex);
+        if (!victim.Jobs.empty())
+        {
+            job = std::move(victim.Jobs.front());
+            victim.Jobs.pop_front();
+            found = true;
+            mStolen.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    if (!found)
+    {
+        return false;
+    }
+    mQueuedJobs.fetch_sub(1);
+    Execute(job);
+    return true;
+}
+
+void JobSystem::Execute(Job& job)
+{
+    std::exception_ptr error;
+    try
+    {
+        job.Func();
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+    //先释放任务捕获的数据，再通知等待者
+    job.Func = nullptr;
+    mExecuted.fetch_add(1, std::memory_order_relaxed);
+    Complete(*job.Counter, error);
+}
+
+void JobSystem::Complete(JobCounter& counter, std::exception_ptr error)
+{
+    std::vector<Job> released;
+    {
+        std::lock_guard<std::mutex> lock(counter.mMutex);
+        if (error && !counter.mError)
+        {
+            counter.mError = error;
+        }
+        if (counter.mPending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            released.swap(counter.mWaiters);
+        }
+    }
+
+    //依赖已经满足的任务进入队列
+    for (Job& job : released)
+    {
+        Push(std::move(job));
+    }
+}
+
+uint32_t JobSystem::CurrentQueue() const
+{
+    if (tCurrentSystem == this)
+    {
+        return tCurrentQueue;
+    }
+    return static_cast<uint32_t>(mQueues.size() - 1);
+}
+
+void JobSystem::WorkerMain(uint32_t index)
+{
+    tCurrentSystem = this;
+    tCurrentQueue = index;
+    Profiler::Get().SetThreadName("JobWorker");
+
+    for (;;)
+    {
+        if (TryRunOne(index))
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mSleepers.fetch_add(1);
+        mWake.wait(lock, [this]() { return mStopping || mQueuedJobs.load() > 0; });
+        mSleepers.fetch_sub(1);
+
+        //停止时仍要把队列中剩余的任务执行完，否则等待计数的线程会永远阻塞
+        if (mStopping && mQueuedJobs.load() == 0)
+        {
+            return;
+        }
+    }
+}
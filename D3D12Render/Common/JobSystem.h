@@ -0,0 +1,185 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobCounter;
+
+struct JobSystemStats
+{
+    uint64_t Executed = 0;
+    uint64_t Stolen = 0;        //从其他线程的队列中窃取执行的任务数
+};
+
+//每帧引擎工作(更新、剔除、填充常量缓冲区、录制命令)的任务调度器，与平台无关
+//每个工作线程有自己的双端队列：自己从尾部取(后进先出，缓存友好)，空闲线程从其他队列的头部窃取(先进先出，窃取到的是较大的任务)
+//非工作线程(如主线程)提交的任务放在一个共享队列中
+//fork/join通过JobCounter完成：Run时计数加一，任务结束时减一，Wait等待计数归零，等待期间调用线程也执行任务
+//任务中可以再派生任务并等待，不会因为等待而占住线程
+class JobSystem
+{
+public:
+    //threadCount为0时使用硬件线程数减一(至少为1)，为调用线程留出一个核心
+    explicit JobSystem(uint32_t threadCount = 0);
+    JobSystem(const JobSystem& rhs) = delete;
+    JobSystem& operator=(const JobSystem& rhs) = delete;
+    //执行完已经进入队列的任务后退出；等待依赖的任务如果依赖始终没有完成则不会执行
+    ~JobSystem();
+
+    //进程内共享的任务系统：D3DApp的每帧工作、纹理处理(mip生成、BC压缩、格式转换)与着色器批量编译都在其中执行，
+    //不再各自创建线程，避免线程数超过核心数
+    static JobSystem& GetDefault();
+
+    //派生一个任务，完成时counter减一
+    void Run(JobCounter& counter, std::function<void()> func);
+    //dependency归零之后才开始执行；只看调用时dependency中已经派生的任务，所以要先派生被依赖的任务
+    void Run(JobCounter& counter, std::function<void()> func, JobCounter& dependency);
+
+    //等待counter归零，期间执行其他任务；任务抛出的第一个异常在这里重新抛出
+    void Wait(JobCounter& counter);
+
+    //把[0,count)递归二分，每块不超过grain个，并行执行func(begin, end)，返回时全部完成
+    template<typename Func>
+    void ParallelFor(size_t count, size_t grain, Func&& func);
+
+    //派生一个有返回值的任务，结果(或异常)通过future取得，counter用法与Run相同
+    //future只应在非工作线程中等待；任务中需要等待其他任务时用JobCounter与Wait
+    template<typename Func>
+    std::future<typename std::result_of<Func()>::type> Submit(JobCounter& counter, Func&& func);
+
+    uint32_t GetThreadCount() const { return static_cast<uint32_t>(mThreads.size()); }
+    JobSystemStats GetStats() const;
+
+private:
+    friend class JobCounter;
+
+    struct Job
+    {
+        std::function<void()> Func;
+        JobCounter* Counter = nullptr;
+    };
+
+    struct WorkerQueue
+    {
+        std::mutex Mutex;
+        std::deque<Job> Jobs;
+    };
+
+    template<typename Func>
+    void SplitRange(JobCounter& counter, size_t begin, size_t end, size_t grain, Func& func);
+
+    void Push(Job&& job);
+    bool TryRunOne(uint32_t queueIndex);
+    void Execute(Job& job);
+    void Complete(JobCounter& counter, std::exception_ptr error);
+    uint32_t CurrentQueue() const;
+    void WorkerMain(uint32_t index);
+
+private:
+    //前GetThreadCount()个属于工作线程，最后一个由非工作线程共享
+    std::vector<std::unique_ptr<WorkerQueue>> mQueues;
+    std::vector<std::thread> mThreads;
+
+    std::atomic<int64_t> mQueuedJobs;
+    std::atomic<uint32_t> mSleepers;
+    std::mutex mSleepMutex;
+    std::condition_variable mWake;
+    bool mStopping = false;
+
+    std::atomic<uint64_t> mExecuted;
+    std::atomic<uint64_t> mStolen;
+};
+
+//一组任务的完成计数，可以在Wait返回后重复使用；销毁前需要等待它归零
+class JobCounter
+{
+public:
+    JobCounter() : mPending(0) {}
+    JobCounter(const JobCounter& rhs) = delete;
+    JobCounter& operator=(const JobCounter& rhs) = delete;
+
+    bool IsDone() const { return mPending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+
+    std::atomic<uint32_t> mPending;
+    //计数的递减也在锁内完成，保证Wait返回之后没有线程再访问这个对象
+    std::mutex mMutex;
+    //等待本计数归零的任务
+    std::vector<JobSystem::Job> mWaiters;
+    std::exception_ptr mError;
+};
+
+template<typename Func>
+void JobSystem::ParallelFor(size_t count, size_t grain, Func&& func)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+
+    //已派生的任务引用了counter与func，出错时也要等它们结束
+    JobCounter counter;
+    std::exception_ptr error;
+    try
+    {
+        SplitRange(counter, 0, count, grain, func);
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+    try
+    {
+        Wait(counter);
+    }
+    catch (...)
+    {
+        if (!error)
+        {
+            error = std::current_exception();
+        }
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+template<typename Func>
+std::future<typename std::result_of<Func()>::type> JobSystem::Submit(JobCounter& counter, Func&& func)
+{
+    typedef typename std::result_of<Func()>::type Result;
+
+    //std::function要求可拷贝，packaged_task只能移动，因此放在shared_ptr中；异常由packaged_task交给future
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Func>(func));
+    std::future<Result> future = task->get_future();
+    Run(counter, [task]() { (*task)(); });
+    return future;
+}
+
+template<typename Func>
+void JobSystem::SplitRange(JobCounter& counter, size_t begin, size_t end, size_t grain, Func& func)
+{
+    //右半部分派生为任务，左半部分在当前线程继续二分；空闲线程从队列头部窃取到的是最大的一块
+    while (end - begin > grain)
+    {
+        const size_t mid = begin + (end - begin) / 2;
+        Run(counter, [this, &counter, mid, end, grain, &func]() { SplitRange(counter, mid, end, grain, func); });
+        end = mid;
+    }
+    func(begin, end);
+}
@@ -0,0 +1,188 @@
+#include "MappedFile.h"
+#include "FileUtil.h"
+
+#include <utility>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(MappedFile&& rhs) :
+    mData(rhs.mData),
+    mSize(rhs.mSize),
+    mError(rhs.mError),
+    mOpen(rhs.mOpen)
+{
+    rhs.mData = nullptr;
+    rhs.mSize = 0;
+    rhs.mOpen = false;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs)
+{
+    if (this != &rhs)
+    {
+        Close();
+        std::swap(mData, rhs.mData);
+        std::swap(mSize, rhs.mSize);
+        std::swap(mError, rhs.mError);
+        std::swap(mOpen, rhs.mOpen);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::Open(const std::wstring& path)
+{
+    Close();
+
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        mError = GetLastError();
+        return false;
+    }
+
+    LARGE_INTEGER fileSize = {};
+    if (!GetFileSizeEx(file, &fileSize))
+    {
+        mError = GetLastError();
+        CloseHandle(file);
+        return false;
+    }
+
+    //32位程序无法映射超过地址空间的文件
+    if (static_cast<unsigned long long>(fileSize.QuadPart) > static_cast<unsigned long long>(SIZE_MAX))
+    {
+        mError = ERROR_FILE_TOO_LARGE;
+        CloseHandle(file);
+        return false;
+    }
+
+    //长度为0的文件无法创建映射
+    if (fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        mError = 0;
+        mOpen = true;
+        return true;
+    }
+
+    //视图会保持映射对象有效，因此文件与映射的句柄可以立即关闭
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+        mError = GetLastError();
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr)
+    {
+        mError = GetLastError();
+    }
+    CloseHandle(mapping);
+    CloseHandle(file);
+    if (view == nullptr)
+    {
+        return false;
+    }
+
+    mData = static_cast<const uint8_t*>(view);
+    mSize = static_cast<size_t>(fileSize.QuadPart);
+    mError = 0;
+    mOpen = true;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (mData != nullptr)
+    {
+        UnmapViewOfFile(mData);
+    }
+    mData = nullptr;
+    mSize = 0;
+    mOpen = false;
+}
+
+#else
+
+bool MappedFile::Open(const std::wstring& path)
+{
+    Close();
+
+    int fd = open(FileUtil::ToUtf8(path).c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        mError = static_cast<uint32_t>(errno);
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        mError = static_cast<uint32_t>(errno);
+        close(fd);
+        return false;
+    }
+
+    if (static_cast<unsigned long long>(info.st_size) > static_cast<unsigned long long>(SIZE_MAX))
+    {
+        mError = EFBIG;
+        close(fd);
+        return false;
+    }
+
+    if (info.st_size == 0)
+    {
+        close(fd);
+        mError = 0;
+        mOpen = true;
+        return true;
+    }
+
+    //映射建立后文件描述符即可关闭
+    const size_t size = static_cast<size_t>(info.st_size);
+    void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view == MAP_FAILED)
+    {
+        mError = static_cast<uint32_t>(errno);
+        close(fd);
+        return false;
+    }
+    close(fd);
+
+    mData = static_cast<const uint8_t*>(view);
+    mSize = size;
+    mError = 0;
+    mOpen = true;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (mData != nullptr)
+    {
+        munmap(const_cast<uint8_t*>(mData), mSize);
+    }
+    mData = nullptr;
+    mSize = 0;
+    mOpen = false;
+}
+
+#endif
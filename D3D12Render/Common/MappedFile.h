@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//只读的文件内存映射，文件内容由操作系统按需调入，读取时不经过额外的缓冲区拷贝
+//映射区域是只读的，写入会导致访问违规
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile& rhs) = delete;
+    MappedFile& operator=(const MappedFile& rhs) = delete;
+    MappedFile(MappedFile&& rhs);
+    MappedFile& operator=(MappedFile&& rhs);
+    ~MappedFile();
+
+    //失败时返回false，GetError()为系统错误码(Windows上为GetLastError()的值，其他平台为errno)
+    //空文件可以成功打开，此时GetData()为nullptr
+    bool Open(const std::wstring& path);
+    void Close();
+
+    bool IsOpen() const { return mOpen; }
+    const uint8_t* GetData() const { return mData; }
+    size_t GetSize() const { return mSize; }
+    uint32_t GetError() const { return mError; }
+
+private:
+    const uint8_t* mData = nullptr;
+    size_t mSize = 0;
+    uint32_t mError = 0;
+    bool mOpen = false;
+};
@@ -0,0 +1,681 @@
+#include "MipGenerator.h"
+#include "JobSystem.h"
+
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using namespace DirectX;
+
+namespace
+{
+    //浮点图像，存储线性空间的RGBA数据
+    struct FloatImage
+    {
+        uint32_t Width = 0;
+        uint32_t Height = 0;
+        std::vector<XMFLOAT4> Texels;
+
+        XMFLOAT4* Row(uint32_t y) { return Texels.data() + size_t(y) * Width; }
+        const XMFLOAT4* Row(uint32_t y) const { return Texels.data() + size_t(y) * Width; }
+    };
+
+    //并行处理时每个任务负责的行数
+    const size_t RowsPerTask = 16;
+
+    float SRGBToLinear(float c)
+    {
+        return (c <= 0.04045f) ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+    }
+
+    float LinearToSRGB(float c)
+    {
+        return (c <= 0.0031308f) ? c * 12.92f : 1.055f * powf(c, 1.0f / 2.4f) - 0.055f;
+    }
+
+    //sRGB与线性空间互相转换的查找表，避免每个像素都调用powf
+    struct SRGBTables
+    {
+        static const int EncodeTableSize = 4096;
+
+        float Decode[256];
+        uint8_t Encode[EncodeTableSize + 1];
+
+        SRGBTables()
+        {
+            for (int i = 0; i < 256; ++i)
+            {
+                Decode[i] = SRGBToLinear(i / 255.0f);
+            }
+            for (int i = 0; i <= EncodeTableSize; ++i)
+            {
+                float s = LinearToSRGB(float(i) / EncodeTableSize);
+                Encode[i] = static_cast<uint8_t>(std::min(255.0f, s * 255.0f + 0.5f));
+            }
+        }
+    };
+
+    const SRGBTables& GetSRGBTables()
+    {
+        static const SRGBTables tables;
+        return tables;
+    }
+
+    float ClampUNorm(float v)
+    {
+        return std::min(1.0f, std::max(0.0f, v));
+    }
+
+    uint8_t EncodeUNorm8(float v)
+    {
+        return static_cast<uint8_t>(ClampUNorm(v) * 255.0f + 0.5f);
+    }
+
+    uint8_t EncodeSRGB8(float v)
+    {
+        return GetSRGBTables().Encode[static_cast<int>(ClampUNorm(v) * SRGBTables::EncodeTableSize + 0.5f)];
+    }
+
+    //把[0,1]的浮点数量化为bits位的UNORM整数
+    uint32_t QuantizeUNorm(float v, uint32_t bits)
+    {
+        const float scale = float((1u << bits) - 1);
+        return static_cast<uint32_t>(ClampUNorm(v) * scale + 0.5f);
+    }
+
+    //各格式的单行解码/编码函数
+    //解码时缺失的颜色通道填0，缺失的alpha通道填1，与GPU采样的行为一致
+    typedef void(*DecodeRowFunc)(const uint8_t* src, uint32_t width, XMFLOAT4* out);
+    typedef void(*EncodeRowFunc)(const XMFLOAT4* in, uint32_t width, uint8_t* dst);
+
+    struct FormatCodec
+    {
+        size_t BytesPerPixel = 0;
+        DecodeRowFunc Decode = nullptr;
+        EncodeRowFunc Encode = nullptr;
+        //UNORM格式的滤波结果需要截断到[0,1]，浮点格式保留原值
+        bool Saturate = true;
+    };
+
+    //8位4通道格式：RGBA/BGRA/BGRX，可选sRGB
+    template<bool SRGB, bool BGR, bool NoAlpha>
+    void DecodeRGBA8Row(const uint8_t* src, uint32_t width, XMFLOAT4* out)
+    {
+        const SRGBTables& tables = GetSRGBTables();
+        const float inv255 = 1.0f / 255.0f;
+        const int r = BGR ? 2 : 0;
+        const int b = BGR ? 0 : 2;
+
+        for (uint32_t x = 0; x < width; ++x, src += 4)
+        {
+            float a = NoAlpha ? 1.0f : src[3] * inv255;
+            if (SRGB)
+            {
+                out[x] = XMFLOAT4(tables.Decode[src[r]], tables.Decode[src[1]], tables.Decode[src[b]], a);
+            }
+            else
+            {
+                out[x] = XMFLOAT4(src[r] * inv255, src[1] * inv255, src[b] * inv255, a);
+            }
+        }
+    }
+
+    template<bool SRGB, bool BGR, bool NoAlpha>
+    void EncodeRGBA8Row(const XMFLOAT4* in, uint32_t width, uint8_t* dst)
+    {
+        const int r = BGR ? 2 : 0;
+        const int b = BGR ? 0 : 2;
+
+        for (uint32_t x = 0; x < width; ++x, dst += 4)
+        {
+            if (SRGB)
+            {
+                dst[r] = EncodeSRGB8(in[x].x);
+                dst[1] = EncodeSRGB8(in[x].y);
+                dst[b] = EncodeSRGB8(in[x].z);
+            }
+            else
+            {
+                dst[r] = EncodeUNorm8(in[x].x);
+                dst[1] = EncodeUNorm8(in[x].y);
+                dst[b] = EncodeUNorm8(in[x].z);
+            }
+            dst[3] = NoAlpha ? 255 : EncodeUNorm8(in[x].w);
+        }
+    }
+
+    //每通道为T类型UNORM整数的格式(R8/R8G8/R16/R16G16/R16G16B16A16)
+    template<typename T, int Channels>
+    void DecodeUNormRow(const uint8_t* src, uint32_t width, XMFLOAT4* out)
+    {
+        const float inv = 1.0f / float(std::numeric_limits<T>::max());
+        for (uint32_t x = 0; x < width; ++x, src += sizeof(T) * Channels)
+        {
+            T c[4] = {};
+            memcpy(c, src, sizeof(T) * Channels);
+            out[x] = XMFLOAT4(
+                c[0] * inv,
+                Channels > 1 ? c[1] * inv : 0.0f,
+                Channels > 2 ? c[2] * inv : 0.0f,
+                Channels > 3 ? c[3] * inv : 1.0f);
+        }
+    }
+
+    template<typename T, int Channels>
+    void EncodeUNormRow(const XMFLOAT4* in, uint32_t width, uint8_t* dst)
+    {
+        const uint32_t bits = sizeof(T) * 8;
+        for (uint32_t x = 0; x < width; ++x, dst += sizeof(T) * Channels)
+        {
+            const float v[4] = { in[x].x, in[x].y, in[x].z, in[x].w };
+            T c[4];
+            for (int i = 0; i < Channels; ++i)
+            {
+                c[i] = static_cast<T>(QuantizeUNorm(v[i], bits));
+            }
+            memcpy(dst, c, sizeof(T) * Channels);
+        }
+    }
+
+    void DecodeA8Row(const uint8_t* src, uint32_t width, XMFLOAT4* out)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            out[x] = XMFLOAT4(0.0f, 0.0f, 0.0f, src[x] / 255.0f);
+        }
+    }
+
+    void EncodeA8Row(const XMFLOAT4* in, uint32_t width, uint8_t* dst)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            dst[x] = EncodeUNorm8(in[x].w);
+        }
+    }
+
+    //32位浮点格式(R32/R32G32/R32G32B32/R32G32B32A32)
+    template<int Channels>
+    void DecodeFloatRow(const uint8_t* src, uint32_t width, XMFLOAT4* out)
+    {
+        for (uint32_t x = 0; x < width; ++x, src += sizeof(float) * Channels)
+        {
+            float c[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+            memcpy(c, src, sizeof(float) * Channels);
+            out[x] = XMFLOAT4(c[0], c[1], c[2], c[3]);
+        }
+    }
+
+    template<int Channels>
+    void EncodeFloatRow(const XMFLOAT4* in, uint32_t width, uint8_t* dst)
+    {
+        for (uint32_t x = 0; x < width; ++x, dst += sizeof(float) * Channels)
+        {
+            memcpy(dst, &in[x], sizeof(float) * Channels);
+        }
+    }
+
+    //16位浮点格式(R16/R16G16/R16G16B16A16)
+    template<int Channels>
+    void DecodeHalfRow(const uint8_t* src, uint32_t width, XMFLOAT4* out)
+    {
+        for (uint32_t x = 0; x < width; ++x, src += sizeof(PackedVector::HALF) * Channels)
+        {
+            PackedVector::HALF h[4] = {};
+            memcpy(h, src, sizeof(PackedVector::HALF) * Channels);
+            float c[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+            for (int i = 0; i < Channels; ++i)
+            {
+                c[i] = PackedVector::XMConvertHalfToFloat(h[i]);
+            }
+            out[x] = XMFLOAT4(c[0], c[1], c[2], c[3]);
+        }
+    }
+
+    template<int Channels>
+    void EncodeHalfRow(const XMFLOAT4* in, uint32_t width, uint8_t* dst)
+    {
+        for (uint32_t x = 0; x < width; ++x, dst += sizeof(PackedVector::HALF) * Channels)
+        {
+            const float v[4] = { in[x].x, in[x].y, in[x].z, in[x].w };
+            PackedVector::HALF h[4];
+            for (int i = 0; i < Channels; ++i)
+            {
+                h[i] = PackedVector::XMConvertFloatToHalf(v[i]);
+            }
+            memcpy(dst, h, sizeof(PackedVector::HALF) * Channels);
+        }
+    }
+
+    //打包格式，Shifts/Bits按R,G,B,A的顺序给出，Bits为0表示没有该通道
+    template<uint32_t RShift, uint32_t RBits, uint32_t GShift, uint32_t GBits,
+             uint32_t BShift, uint32_t BBits, uint32_t AShift, uint32_t ABits, typename T>
+    void DecodePackedRow(const uint8_t* src, uint32_t width, XMFLOAT4* out)
+    {
+        const uint32_t shifts[4] = { RShift, GShift, BShift, AShift };
+        const uint32_t bits[4] = { RBits, GBits, BBits, ABits };
+
+        for (uint32_t x = 0; x < width; ++x, src += sizeof(T))
+        {
+            T packed;
+            memcpy(&packed, src, sizeof(T));
+            float c[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+            for (int i = 0; i < 4; ++i)
+            {
+                if (bits[i] != 0)
+                {
+                    const uint32_t mask = (1u << bits[i]) - 1;
+                    c[i] = float((uint32_t(packed) >> shifts[i]) & mask) / float(mask);
+                }
+            }
+            out[x] = XMFLOAT4(c[0], c[1], c[2], c[3]);
+        }
+    }
+
+    template<uint32_t RShift, uint32_t RBits, uint32_t GShift, uint32_t GBits,
+             uint32_t BShift, uint32_t BBits, uint32_t AShift, uint32_t ABits, typename T>
+    void EncodePackedRow(const XMFLOAT4* in, uint32_t width, uint8_t* dst)
+    {
+        const uint32_t shifts[4] = { RShift, GShift, BShift, AShift };
+        const uint32_t bits[4] = { RBits, GBits, BBits, ABits };
+
+        for (uint32_t x = 0; x < width; ++x, dst += sizeof(T))
+        {
+            const float v[4] = { in[x].x, in[x].y, in[x].z, in[x].w };
+            uint32_t packed = 0;
+            for (int i = 0; i < 4; ++i)
+            {
+                if (bits[i] != 0)
+                {
+                    packed |= QuantizeUNorm(v[i], bits[i]) << shifts[i];
+                }
+            }
+            T value = static_cast<T>(packed);
+            memcpy(dst, &value, sizeof(T));
+        }
+    }
+
+    FormatCodec MakeCodec(size_t bytesPerPixel, DecodeRowFunc decode, EncodeRowFunc encode, bool saturate = true)
+    {
+        FormatCodec codec;
+        codec.BytesPerPixel = bytesPerPixel;
+        codec.Decode = decode;
+        codec.Encode = encode;
+        codec.Saturate = saturate;
+        return codec;
+    }
+
+    bool GetFormatCodec(DXGI_FORMAT format, FormatCodec& codec)
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+            codec = MakeCodec(4, DecodeRGBA8Row<false, false, false>, EncodeRGBA8Row<false, false, false>);
+            return true;
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+            codec = MakeCodec(4, DecodeRGBA8Row<true, false, false>, EncodeRGBA8Row<true, false, false>);
+            return true;
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+            codec = MakeCodec(4, DecodeRGBA8Row<false, true, false>, EncodeRGBA8Row<false, true, false>);
+            return true;
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            codec = MakeCodec(4, DecodeRGBA8Row<true, true, false>, EncodeRGBA8Row<true, true, false>);
+            return true;
+        case DXGI_FORMAT_B8G8R8X8_UNORM:
+            codec = MakeCodec(4, DecodeRGBA8Row<false, true, true>, EncodeRGBA8Row<false, true, true>);
+            return true;
+        case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+            codec = MakeCodec(4, DecodeRGBA8Row<true, true, true>, EncodeRGBA8Row<true, true, true>);
+            return true;
+
+        case DXGI_FORMAT_R8_UNORM:
+            codec = MakeCodec(1, DecodeUNormRow<uint8_t, 1>, EncodeUNormRow<uint8_t, 1>);
+            return true;
+        case DXGI_FORMAT_R8G8_UNORM:
+            codec = MakeCodec(2, DecodeUNormRow<uint8_t, 2>, EncodeUNormRow<uint8_t, 2>);
+            return true;
+        case DXGI_FORMAT_A8_UNORM:
+            codec = MakeCodec(1, DecodeA8Row, EncodeA8Row);
+            return true;
+        case DXGI_FORMAT_R16_UNORM:
+            codec = MakeCodec(2, DecodeUNormRow<uint16_t, 1>, EncodeUNormRow<uint16_t, 1>);
+            return true;
+        case DXGI_FORMAT_R16G16_UNORM:
+            codec = MakeCodec(4, DecodeUNormRow<uint16_t, 2>, EncodeUNormRow<uint16_t, 2>);
+            return true;
+        case DXGI_FORMAT_R16G16B16A16_UNORM:
+            codec = MakeCodec(8, DecodeUNormRow<uint16_t, 4>, EncodeUNormRow<uint16_t, 4>);
+            return true;
+
+        case DXGI_FORMAT_R10G10B10A2_UNORM:
+            codec = MakeCodec(4,
+                DecodePackedRow<0, 10, 10, 10, 20, 10, 30, 2, uint32_t>,
+                EncodePackedRow<0, 10, 10, 10, 20, 10, 30, 2, uint32_t>);
+            return true;
+        case DXGI_FORMAT_B5G6R5_UNORM:
+            codec = MakeCodec(2,
+                DecodePackedRow<11, 5, 5, 6, 0, 5, 0, 0, uint16_t>,
+                EncodePackedRow<11, 5, 5, 6, 0, 5, 0, 0, uint16_t>);
+            return true;
+        case DXGI_FORMAT_B5G5R5A1_UNORM:
+            codec = MakeCodec(2,
+                DecodePackedRow<10, 5, 5, 5, 0, 5, 15, 1, uint16_t>,
+                EncodePackedRow<10, 5, 5, 5, 0, 5, 15, 1, uint16_t>);
+            return true;
+        case DXGI_FORMAT_B4G4R4A4_UNORM:
+            codec = MakeCodec(2,
+                DecodePackedRow<8, 4, 4, 4, 0, 4, 12, 4, uint16_t>,
+                EncodePackedRow<8, 4, 4, 4, 0, 4, 12, 4, uint16_t>);
+            return true;
+
+        case DXGI_FORMAT_R16_FLOAT:
+            codec = MakeCodec(2, DecodeHalfRow<1>, EncodeHalfRow<1>, false);
+            return true;
+        case DXGI_FORMAT_R16G16_FLOAT:
+            codec = MakeCodec(4, DecodeHalfRow<2>, EncodeHalfRow<2>, false);
+            return true;
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+            codec = MakeCodec(8, DecodeHalfRow<4>, EncodeHalfRow<4>, false);
+            return true;
+        case DXGI_FORMAT_R32_FLOAT:
+            codec = MakeCodec(4, DecodeFloatRow<1>, EncodeFloatRow<1>, false);
+            return true;
+        case DXGI_FORMAT_R32G32_FLOAT:
+            codec = MakeCodec(8, DecodeFloatRow<2>, EncodeFloatRow<2>, false);
+            return true;
+        case DXGI_FORMAT_R32G32B32_FLOAT:
+            codec = MakeCodec(12, DecodeFloatRow<3>, EncodeFloatRow<3>, false);
+            return true;
+        case DXGI_FORMAT_R32G32B32A32_FLOAT:
+            codec = MakeCodec(16, DecodeFloatRow<4>, EncodeFloatRow<4>, false);
+            return true;
+
+        default:
+            return false;
+        }
+    }
+
+    void DecodeImage(const uint8_t* pixels, size_t rowPitch, const FormatCodec& codec, FloatImage& dst)
+    {
+        JobSystem::GetDefault().ParallelFor(dst.Height, RowsPerTask, [&](size_t begin, size_t end)
+        {
+            for (size_t y = begin; y < end; ++y)
+            {
+                codec.Decode(pixels + y * rowPitch, dst.Width, dst.Row(static_cast<uint32_t>(y)));
+            }
+        });
+    }
+
+    void EncodeImage(const FloatImage& src, const FormatCodec& codec, MipLevel& dst)
+    {
+        dst.Width = src.Width;
+        dst.Height = src.Height;
+        dst.RowPitch = size_t(src.Width) * codec.BytesPerPixel;
+        dst.Pixels.resize(dst.RowPitch * src.Height);
+
+        JobSystem::GetDefault().ParallelFor(src.Height, RowsPerTask, [&](size_t begin, size_t end)
+        {
+            for (size_t y = begin; y < end; ++y)
+            {
+                codec.Encode(src.Row(static_cast<uint32_t>(y)), src.Width, dst.Pixels.data() + y * dst.RowPitch);
+            }
+        });
+    }
+
+    //2x2盒式滤波降采样，奇数尺寸时边缘像素做截断处理
+    void DownsampleBox(const FloatImage& src, FloatImage& dst)
+    {
+        const XMVECTOR quarter = XMVectorReplicate(0.25f);
+
+        JobSystem::GetDefault().ParallelFor(dst.Height, RowsPerTask, [&](size_t begin, size_t end)
+        {
+            for (size_t y = begin; y < end; ++y)
+            {
+                uint32_t y0 = std::min<uint32_t>(static_cast<uint32_t>(y) * 2, src.Height - 1);
+                uint32_t y1 = std::min<uint32_t>(y0 + 1, src.Height - 1);
+                const XMFLOAT4* row0 = src.Row(y0);
+                const XMFLOAT4* row1 = src.Row(y1);
+                XMFLOAT4* out = dst.Row(static_cast<uint32_t>(y));
+
+                for (uint32_t x = 0; x < dst.Width; ++x)
+                {
+                    uint32_t x0 = std::min(x * 2, src.Width - 1);
+                    uint32_t x1 = std::min(x0 + 1, src.Width - 1);
+
+                    XMVECTOR sum = XMVectorAdd(XMLoadFloat4(&row0[x0]), XMLoadFloat4(&row0[x1]));
+                    sum = XMVectorAdd(sum, XMLoadFloat4(&row1[x0]));
+                    sum = XMVectorAdd(sum, XMLoadFloat4(&row1[x1]));
+                    XMStoreFloat4(&out[x], XMVectorMultiply(sum, quarter));
+                }
+            }
+        });
+    }
+
+    //第一类零阶修正贝塞尔函数，用于计算Kaiser窗口
+    float BesselI0(float x)
+    {
+        float sum = 1.0f;
+        float term = 1.0f;
+        float halfX = x * 0.5f;
+        for (int k = 1; k < 32; ++k)
+        {
+            term *= (halfX / k) * (halfX / k);
+            sum += term;
+            if (term < sum * 1e-8f)
+            {
+                break;
+            }
+        }
+        return sum;
+    }
+
+    //2:1降采样的Kaiser滤波核，半径为3个源像素，共6个对称的采样点
+    const int KaiserTaps = 6;
+
+    struct KaiserKernel
+    {
+        float Weights[KaiserTaps];
+
+        KaiserKernel()
+        {
+            const float radius = 3.0f;
+            const float alpha = 4.0f;
+            const float pi = 3.14159265358979f;
+
+            float total = 0.0f;
+            for (int i = 0; i < KaiserTaps; ++i)
+            {
+                //采样点相对目标像素中心的偏移(以源像素为单位)：-2.5,-1.5,...,2.5
+                float t = float(i) - 2.5f;
+                //截止频率为源图像的一半，故sinc的参数要除以2
+                float s = t * 0.5f;
+                float sinc = (s == 0.0f) ? 1.0f : sinf(pi * s) / (pi * s);
+                float r = t / radius;
+                float window = BesselI0(alpha * sqrtf(std::max(0.0f, 1.0f - r * r))) / BesselI0(alpha);
+                Weights[i] = sinc * window;
+                total += Weights[i];
+            }
+            for (int i = 0; i < KaiserTaps; ++i)
+            {
+                Weights[i] /= total;
+            }
+        }
+    };
+
+    const KaiserKernel& GetKaiserKernel()
+    {
+        static const KaiserKernel kernel;
+        return kernel;
+    }
+
+    //可分离的Kaiser滤波降采样：先水平方向，再竖直方向
+    void DownsampleKaiser(const FloatImage& src, FloatImage& dst, bool saturate)
+    {
+        const KaiserKernel& kernel = GetKaiserKernel();
+
+        //水平方向，结果尺寸为dst.Width x src.Height
+        FloatImage tmp;
+        tmp.Width = dst.Width;
+        tmp.Height = src.Height;
+        tmp.Texels.resize(size_t(tmp.Width) * tmp.Height);
+
+        JobSystem::GetDefault().ParallelFor(tmp.Height, RowsPerTask, [&](size_t begin, size_t end)
+        {
+            for (size_t y = begin; y < end; ++y)
+            {
+                const XMFLOAT4* in = src.Row(static_cast<uint32_t>(y));
+                XMFLOAT4* out = tmp.Row(static_cast<uint32_t>(y));
+                for (uint32_t x = 0; x < tmp.Width; ++x)
+                {
+                    if (src.Width == 1)
+                    {
+                        out[x] = in[0];
+                        continue;
+                    }
+                    XMVECTOR sum = XMVectorZero();
+                    for (int i = 0; i < KaiserTaps; ++i)
+                    {
+                        int sx = int(x * 2) + i - 2;
+                        sx = std::min(std::max(sx, 0), int(src.Width) - 1);
+                        sum = XMVectorMultiplyAdd(XMLoadFloat4(&in[sx]), XMVectorReplicate(kernel.Weights[i]), sum);
+                    }
+                    XMStoreFloat4(&out[x], sum);
+                }
+            }
+        });
+
+        //竖直方向
+        JobSystem::GetDefault().ParallelFor(dst.Height, RowsPerTask, [&](size_t begin, size_t end)
+        {
+            for (size_t y = begin; y < end; ++y)
+            {
+                XMFLOAT4* out = dst.Row(static_cast<uint32_t>(y));
+                if (tmp.Height == 1)
+                {
+                    memcpy(out, tmp.Row(0), sizeof(XMFLOAT4) * dst.Width);
+                    continue;
+                }
+
+                const XMFLOAT4* rows[KaiserTaps];
+                for (int i = 0; i < KaiserTaps; ++i)
+                {
+                    int sy = int(y * 2) + i - 2;
+                    sy = std::min(std::max(sy, 0), int(tmp.Height) - 1);
+                    rows[i] = tmp.Row(static_cast<uint32_t>(sy));
+                }
+
+                for (uint32_t x = 0; x < dst.Width; ++x)
+                {
+                    XMVECTOR sum = XMVectorZero();
+                    for (int i = 0; i < KaiserTaps; ++i)
+                    {
+                        sum = XMVectorMultiplyAdd(XMLoadFloat4(&rows[i][x]), XMVectorReplicate(kernel.Weights[i]), sum);
+                    }
+                    //sinc滤波会产生负瓣，UNORM格式的结果需要截断到合法范围
+                    XMStoreFloat4(&out[x], saturate ? XMVectorSaturate(sum) : sum);
+                }
+            }
+        });
+    }
+}
+
+uint32_t MipGenerator::CalcMipCount(uint32_t width, uint32_t height)
+{
+    uint32_t count = 1;
+    while (width > 1 || height > 1)
+    {
+        width = std::max<uint32_t>(width >> 1, 1);
+        height = std::max<uint32_t>(height >> 1, 1);
+        ++count;
+    }
+    return count;
+}
+
+bool MipGenerator::IsSupportedFormat(DXGI_FORMAT format)
+{
+    FormatCodec codec;
+    return GetFormatCodec(format, codec);
+}
+
+std::vector<MipLevel> MipGenerator::Generate(
+    const uint8_t* pixels,
+    uint32_t width,
+    uint32_t height,
+    size_t rowPitch,
+    DXGI_FORMAT format,
+    MipFilter filter,
+    uint32_t maxLevels)
+{
+    std::vector<MipLevel> levels;
+    FormatCodec codec;
+    if (pixels == nullptr || width == 0 || height == 0 || !GetFormatCodec(format, codec))
+    {
+        return levels;
+    }
+
+    uint32_t levelCount = CalcMipCount(width, height);
+    if (maxLevels != 0)
+    {
+        levelCount = std::min(levelCount, maxLevels);
+    }
+    levels.resize(levelCount);
+
+    //第0级直接拷贝原图(去除行间的填充)
+    MipLevel& base = levels[0];
+    base.Width = width;
+    base.Height = height;
+    base.RowPitch = size_t(width) * codec.BytesPerPixel;
+    base.Pixels.resize(base.RowPitch * height);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        memcpy(base.Pixels.data() + y * base.RowPitch, pixels + y * rowPitch, base.RowPitch);
+    }
+    if (levelCount == 1)
+    {
+        return levels;
+    }
+
+    FloatImage prev;
+    prev.Width = width;
+    prev.Height = height;
+    prev.Texels.resize(size_t(width) * height);
+    DecodeImage(pixels, rowPitch, codec, prev);
+
+    for (uint32_t level = 1; level < levelCount; ++level)
+    {
+        FloatImage cur;
+        cur.Width = std::max<uint32_t>(prev.Width >> 1, 1);
+        cur.Height = std::max<uint32_t>(prev.Height >> 1, 1);
+        cur.Texels.resize(size_t(cur.Width) * cur.Height);
+
+        if (filter == MipFilter::Kaiser)
+        {
+            DownsampleKaiser(prev, cur, codec.Saturate);
+        }
+        else
+        {
+            DownsampleBox(prev, cur);
+        }
+
+        EncodeImage(cur, codec, levels[level]);
+        prev = std::move(cur);
+    }
+
+    return levels;
+}
+
+std::vector<MipLevel> MipGenerator::GenerateRGBA8(
+    const uint8_t* pixels,
+    uint32_t width,
+    uint32_t height,
+    size_t rowPitch,
+    bool srgb,
+    MipFilter filter,
+    uint32_t maxLevels)
+{
+    return Generate(pixels, width, height, rowPitch,
+        srgb ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM,
+        filter, maxLevels);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <dxgiformat.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//降采样时使用的滤波器
+enum class MipFilter
+{
+    Box,        //2x2盒式滤波，速度快
+    Kaiser      //Kaiser窗口化的sinc滤波，画质更好，细节保留更多
+};
+
+//mip链中的一级，像素按行紧密排列
+struct MipLevel
+{
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    size_t RowPitch = 0;
+    std::vector<uint8_t> Pixels;
+};
+
+//CPU端的mip链生成器，可在烘焙期或加载期使用
+//滤波在线性空间的浮点数据上进行(sRGB数据先解码到线性空间再滤波)，每一级都由上一级的浮点结果生成，避免量化误差累积
+class MipGenerator
+{
+public:
+    //完整mip链的级数
+    static uint32_t CalcMipCount(uint32_t width, uint32_t height);
+
+    //是否支持该格式(只支持非压缩的颜色格式)
+    static bool IsSupportedFormat(DXGI_FORMAT format);
+
+    //由任意支持的非压缩格式图像生成mip链，每一级都保持原格式，行紧密排列(即DDS文件中的布局)
+    //返回结果的第0级为原图拷贝，格式不支持时返回空
+    static std::vector<MipLevel> Generate(
+        const uint8_t* pixels,
+        uint32_t width,
+        uint32_t height,
+        size_t rowPitch,
+        DXGI_FORMAT format,
+        MipFilter filter = MipFilter::Box,
+        uint32_t maxLevels = 0);
+
+    //由RGBA8图像生成mip链，返回结果的第0级为原图拷贝
+    //maxLevels为0时生成完整mip链
+    static std::vector<MipLevel> GenerateRGBA8(
+        const uint8_t* pixels,
+        uint32_t width,
+        uint32_t height,
+        size_t rowPitch,
+        bool srgb,
+        MipFilter filter = MipFilter::Box,
+        uint32_t maxLevels = 0);
+};
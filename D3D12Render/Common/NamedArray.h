@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "StringTable.h"
+
+//NamedArray中元素的句柄，Tag用于区分不同种类的句柄(子网格、材质、纹理)，避免混用
+template<typename Tag>
+struct Handle
+{
+    static const uint32_t InvalidIndex = 0xffffffff;
+
+    uint32_t Index = InvalidIndex;
+
+    bool IsValid() const { return Index != InvalidIndex; }
+    bool operator==(const Handle& rhs) const { return Index == rhs.Index; }
+    bool operator!=(const Handle& rhs) const { return Index != rhs.Index; }
+};
+
+struct SubmeshTag {};
+struct MaterialTag {};
+struct TextureTag {};
+
+typedef Handle<SubmeshTag> SubmeshHandle;
+typedef Handle<MaterialTag> MaterialHandle;
+typedef Handle<TextureTag> TextureHandle;
+
+//按名字登记、按句柄访问的连续数组
+//名字只在构建资源时解析一次得到句柄，之后每帧通过句柄直接下标访问，或者直接遍历连续的元素
+//元素只增不删，句柄一直有效
+template<typename T, typename Tag>
+class NamedArray
+{
+public:
+    typedef Handle<Tag> HandleType;
+
+    //同名的元素已存在时覆盖其值，句柄保持不变
+    HandleType Add(StringId name, const T& value)
+    {
+        HandleType handle = Find(name);
+        if (handle.IsValid())
+        {
+            mItems[handle.Index] = value;
+            return handle;
+        }
+
+        handle.Index = static_cast<uint32_t>(mItems.size());
+        mItems.push_back(value);
+        mNames.push_back(name);
+        mLookup.emplace(name, handle.Index);
+        return handle;
+    }
+
+    HandleType Add(const std::string& name, const T& value)
+    {
+        return Add(StringTable::Intern(name), value);
+    }
+
+    //找不到时返回无效的句柄
+    HandleType Find(StringId name) const
+    {
+        HandleType handle;
+        auto it = mLookup.find(name);
+        if (it != mLookup.end())
+        {
+            handle.Index = it->second;
+        }
+        return handle;
+    }
+
+    HandleType Find(const std::string& name) const
+    {
+        StringId id = StringTable::Find(name);
+        return id.IsValid() ? Find(id) : HandleType();
+    }
+
+    T& operator[](HandleType handle)
+    {
+        assert(handle.Index < mItems.size());
+        return mItems[handle.Index];
+    }
+
+    const T& operator[](HandleType handle) const
+    {
+        assert(handle.Index < mItems.size());
+        return mItems[handle.Index];
+    }
+
+    StringId GetName(HandleType handle) const { return mNames[handle.Index]; }
+
+    size_t Size() const { return mItems.size(); }
+    bool Empty() const { return mItems.empty(); }
+
+    typename std::vector<T>::iterator begin() { return mItems.begin(); }
+    typename std::vector<T>::iterator end() { return mItems.end(); }
+    typename std::vector<T>::const_iterator begin() const { return mItems.begin(); }
+    typename std::vector<T>::const_iterator end() const { return mItems.end(); }
+
+private:
+    std::vector<T> mItems;
+    std::vector<StringId> mNames;
+    std::unordered_map<StringId, uint32_t> mLookup;
+};
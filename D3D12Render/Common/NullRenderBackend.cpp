@@ -0,0 +1,326 @@
+#include "NullRenderBackend.h"
+
+#include <algorithm>
+#include <cassert>
+#include <thread>
+
+NullRenderCommandList::NullRenderCommandList(uint32_t callCostNs) :
+    mRecording(callCostNs)
+{
+    mRecording.Close();
+}
+
+void NullRenderCommandList::Reset(RenderHandle initialState)
+{
+    mRecording.Reset();
+    mStats = RenderBackendStats();
+    if (initialState != 0)
+    {
+        SetPipelineState(initialState);
+    }
+}
+
+void NullRenderCommandList::Close()
+{
+    mRecording.Close();
+}
+
+void NullRenderCommandList::SetPipelineState(RenderHandle pso)
+{
+    ++mStats.Calls;
+    mRecording.SetPipelineState(static_cast<uint32_t>(pso));
+}
+
+void NullRenderCommandList::SetGraphicsRootSignature(RenderHandle rootSignature)
+{
+    ++mStats.Calls;
+    mRecording.SetGraphicsRootSignature(static_cast<uint32_t>(rootSignature));
+}
+
+void NullRenderCommandList::SetGraphicsRootDescriptorTable(uint32_t rootParameterIndex, uint64_t gpuDescriptor)
+{
+    ++mStats.Calls;
+    mRecording.SetGraphicsRootDescriptorTable(rootParameterIndex, static_cast<uint32_t>(gpuDescriptor));
+}
+
+void NullRenderCommandList::SetDescriptorHeaps(uint32_t numHeaps, const RenderHandle*)
+{
+    ++mStats.Calls;
+    mRecording.SetDescriptorHeaps(numHeaps);
+}
+
+void NullRenderCommandList::RSSetViewports(uint32_t numViewports, const RenderViewport*)
+{
+    ++mStats.Calls;
+    mRecording.RSSetViewports(numViewports);
+}
+
+void NullRenderCommandList::RSSetScissorRects(uint32_t numRects, const RenderRect*)
+{
+    ++mStats.Calls;
+    mRecording.RSSetScissorRects(numRects);
+}
+
+void NullRenderCommandList::OMSetRenderTargets(uint32_t numRenderTargets, const uint64_t*,
+    const uint64_t* dsvCpuDescriptor)
+{
+    ++mStats.Calls;
+    mRecording.OMSetRenderTargets(numRenderTargets,
+        dsvCpuDescriptor != nullptr ? static_cast<uint32_t>(*dsvCpuDescriptor) : 0);
+}
+
+void NullRenderCommandList::IASetVertexBuffers(uint32_t startSlot, uint32_t numViews, const RenderVertexBufferView*)
+{
+    ++mStats.Calls;
+    mRecording.IASetVertexBuffers(startSlot, numViews);
+}
+
+void NullRenderCommandList::IASetIndexBuffer(const RenderIndexBufferView* view)
+{
+    ++mStats.Calls;
+    mRecording.IASetIndexBuffer(view != nullptr ? static_cast<uint32_t>(view->BufferLocation) : 0);
+}
+
+void NullRenderCommandList::IASetPrimitiveTopology(uint32_t topology)
+{
+    ++mStats.Calls;
+    mRecording.IASetPrimitiveTopology(topology);
+}
+
+void NullRenderCommandList::ClearRenderTargetView(uint64_t cpuDescriptor, const float*)
+{
+    ++mStats.Calls;
+    mRecording.ClearRenderTargetView(static_cast<uint32_t>(cpuDescriptor));
+}
+
+void NullRenderCommandList::ClearDepthStencilView(uint64_t cpuDescriptor, uint32_t clearFlags, float, uint8_t)
+{
+    ++mStats.Calls;
+    mRecording.ClearDepthStencilView(static_cast<uint32_t>(cpuDescriptor), clearFlags);
+}
+
+void NullRenderCommandList::DrawInstanced(uint32_t vertexCountPerInstance, uint32_t instanceCount,
+    uint32_t startVertexLocation, uint32_t startInstanceLocation)
+{
+    ++mStats.Calls;
+    ++mStats.Draws;
+    mRecording.DrawInstanced(vertexCountPerInstance, instanceCount, startVertexLocation, startInstanceLocation);
+}
+
+void NullRenderCommandList::DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount,
+    uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation)
+{
+    ++mStats.Calls;
+    ++mStats.Draws;
+    mRecording.DrawIndexedInstanced(indexCountPerInstance, instanceCount, startIndexLocation, baseVertexLocation,
+        startInstanceLocation);
+}
+
+void NullRenderCommandList::CopyBufferRegion(RenderHandle dest, uint64_t, RenderHandle source, uint64_t,
+    uint64_t numBytes)
+{
+    ++mStats.Calls;
+    mStats.BytesCopied += numBytes;
+    mRecording.CopyBufferRegion(static_cast<uint32_t>(dest), static_cast<uint32_t>(source), numBytes);
+}
+
+void NullRenderCommandList::EndQuery(RenderHandle queryHeap, uint32_t type, uint32_t index)
+{
+    ++mStats.Calls;
+    mRecording.EndQuery(static_cast<uint32_t>(queryHeap), type, index);
+}
+
+void NullRenderCommandList::ResourceBarrier(uint32_t count, const ResourceTransition*)
+{
+    ++mStats.Calls;
+    ++mStats.BarrierCalls;
+    mStats.Barriers += count;
+    mRecording.ResourceBarrier(count);
+}
+
+NullRenderFence::NullRenderFence(uint64_t initialValue) :
+    mCompleted(initialValue)
+{
+}
+
+uint64_t NullRenderFence::GetCompletedValue() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    Advance(Clock::now());
+    return mCompleted;
+}
+
+void NullRenderFence::WaitForValue(uint64_t value)
+{
+    Clock::time_point time;
+    if (!GetCompletionTime(value, time))
+    {
+        //从未Signal过的值永远不会完成，真实设备上这里会死锁
+        assert(false && "NullRenderFence: waiting for a value that was never signaled");
+        return;
+    }
+    std::this_thread::sleep_until(time);
+    std::lock_guard<std::mutex> lock(mMutex);
+    Advance(std::max(Clock::now(), time));
+}
+
+void NullRenderFence::Schedule(uint64_t value, Clock::time_point time)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    //同一队列上的完成时刻单调递增，保持按时刻排序
+    auto it = std::upper_bound(mPending.begin(), mPending.end(), time,
+        [](Clock::time_point t, const std::pair<uint64_t, Clock::time_point>& entry) { return t < entry.second; });
+    mPending.insert(it, std::make_pair(value, time));
+}
+
+bool NullRenderFence::GetCompletionTime(uint64_t value, Clock::time_point& time) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    Advance(Clock::now());
+    if (mCompleted >= value)
+    {
+        time = Clock::time_point();
+        return true;
+    }
+    for (const auto& entry : mPending)
+    {
+        if (entry.first >= value)
+        {
+            time = entry.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+void NullRenderFence::Advance(Clock::time_point now) const
+{
+    size_t done = 0;
+    while (done < mPending.size() && mPending[done].second <= now)
+    {
+        mCompleted = std::max(mCompleted, mPending[done].first);
+        ++done;
+    }
+    mPending.erase(mPending.begin(), mPending.begin() + done);
+}
+
+NullRenderQueue::NullRenderQueue(NullRenderDevice& device, const NullRenderConfig& config) :
+    mDevice(device),
+    mConfig(config)
+{
+}
+
+void NullRenderQueue::ExecuteCommandLists(uint32_t count, IRenderCommandList* const* lists)
+{
+    RenderBackendStats total;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        //同一个后端的对象才能一起使用
+        const NullRenderCommandList* list = static_cast<const NullRenderCommandList*>(lists[i]);
+        assert(list->GetRecording().IsClosed());
+        const RenderBackendStats& stats = list->GetStats();
+        total.Calls += stats.Calls;
+        total.Draws += stats.Draws;
+        total.Barriers += stats.Barriers;
+        total.BarrierCalls += stats.BarrierCalls;
+        total.BytesCopied += stats.BytesCopied;
+    }
+    total.CommandListsExecuted = count;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mBusyUntil = std::max(mBusyUntil, NullRenderFence::Clock::now()) +
+            std::chrono::nanoseconds(total.Draws * mConfig.GpuNsPerDraw);
+    }
+    mDevice.Accumulate(total);
+}
+
+void NullRenderQueue::Signal(IRenderFence& fence, uint64_t value)
+{
+    NullRenderFence::Clock::time_point time;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        time = std::max(mBusyUntil, NullRenderFence::Clock::now()) + std::chrono::nanoseconds(mConfig.FenceLatencyNs);
+    }
+    static_cast<NullRenderFence&>(fence).Schedule(value, time);
+
+    RenderBackendStats stats;
+    stats.Signals = 1;
+    mDevice.Accumulate(stats);
+}
+
+void NullRenderQueue::Wait(IRenderFence& fence, uint64_t value)
+{
+    NullRenderFence::Clock::time_point time;
+    const bool known = static_cast<NullRenderFence&>(fence).GetCompletionTime(value, time);
+    assert(known && "NullRenderQueue: waiting for a value that was never signaled");
+    if (known)
+    {
+        //之后提交的命令在fence完成之后才开始执行
+        std::lock_guard<std::mutex> lock(mMutex);
+        mBusyUntil = std::max(mBusyUntil, time);
+    }
+
+    RenderBackendStats stats;
+    stats.QueueWaits = 1;
+    mDevice.Accumulate(stats);
+}
+
+NullRenderDevice::NullRenderDevice(const NullRenderConfig& config) :
+    mConfig(config)
+{
+}
+
+std::unique_ptr<IRenderQueue> NullRenderDevice::CreateQueue(RenderQueueType)
+{
+    return std::make_unique<NullRenderQueue>(*this, mConfig);
+}
+
+std::unique_ptr<IRenderCommandList> NullRenderDevice::CreateCommandList(RenderQueueType)
+{
+    return std::make_unique<NullRenderCommandList>(mConfig.CallCostNs);
+}
+
+std::unique_ptr<IRenderFence> NullRenderDevice::CreateFence(uint64_t initialValue)
+{
+    return std::make_unique<NullRenderFence>(initialValue);
+}
+
+void NullRenderDevice::CopyDescriptorsSimple(uint32_t count, uint64_t, uint64_t, uint32_t)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats.DescriptorWrites += count;
+}
+
+void NullRenderDevice::WriteUploadBuffer(RenderHandle, uint64_t, const void*, size_t size)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats.BytesUploaded += size;
+}
+
+RenderBackendStats NullRenderDevice::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+void NullRenderDevice::ResetStats()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats = RenderBackendStats();
+}
+
+void NullRenderDevice::Accumulate(const RenderBackendStats& stats)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats.CommandListsExecuted += stats.CommandListsExecuted;
+    mStats.Calls += stats.Calls;
+    mStats.Draws += stats.Draws;
+    mStats.Barriers += stats.Barriers;
+    mStats.BarrierCalls += stats.BarrierCalls;
+    mStats.DescriptorWrites += stats.DescriptorWrites;
+    mStats.BytesUploaded += stats.BytesUploaded;
+    mStats.BytesCopied += stats.BytesCopied;
+    mStats.Signals += stats.Signals;
+    mStats.QueueWaits += stats.QueueWaits;
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include "RenderBackend.h"
+#include "RecordingCommandList.h"
+
+struct NullRenderConfig
+{
+    //每次命令列表调用模拟的CPU开销(忙等)
+    uint32_t CallCostNs = 0;
+    //模拟的GPU执行时间：每个Draw的耗时，以及Signal之后fence完成前的额外延迟
+    uint32_t GpuNsPerDraw = 0;
+    uint64_t FenceLatencyNs = 0;
+};
+
+struct RenderBackendStats
+{
+    uint64_t CommandListsExecuted = 0;
+    uint64_t Calls = 0;                 //已提交的命令列表中的全部调用
+    uint64_t Draws = 0;
+    uint64_t Barriers = 0;              //状态转换的个数
+    uint64_t BarrierCalls = 0;          //ResourceBarrier的调用次数
+    uint64_t DescriptorWrites = 0;
+    uint64_t BytesUploaded = 0;         //写入上传堆的字节数
+    uint64_t BytesCopied = 0;           //CopyBufferRegion复制的字节数
+    uint64_t Signals = 0;
+    uint64_t QueueWaits = 0;
+};
+
+class NullRenderDevice;
+
+//只记录调用的命令列表，命令保存在RecordingCommandList中，可以检查录制的内容
+class NullRenderCommandList : public IRenderCommandList
+{
+public:
+    explicit NullRenderCommandList(uint32_t callCostNs);
+
+    virtual void Reset(RenderHandle initialState) override;
+    virtual void Close() override;
+
+    virtual void SetPipelineState(RenderHandle pso) override;
+    virtual void SetGraphicsRootSignature(RenderHandle rootSignature) override;
+    virtual void SetGraphicsRootDescriptorTable(uint32_t rootParameterIndex, uint64_t gpuDescriptor) override;
+    virtual void SetDescriptorHeaps(uint32_t numHeaps, const RenderHandle* heaps) override;
+    virtual void RSSetViewports(uint32_t numViewports, const RenderViewport* viewports) override;
+    virtual void RSSetScissorRects(uint32_t numRects, const RenderRect* rects) override;
+    virtual void OMSetRenderTargets(uint32_t numRenderTargets, const uint64_t* rtvCpuDescriptors,
+        const uint64_t* dsvCpuDescriptor) override;
+    virtual void IASetVertexBuffers(uint32_t startSlot, uint32_t numViews, const RenderVertexBufferView* views) override;
+    virtual void IASetIndexBuffer(const RenderIndexBufferView* view) override;
+    virtual void IASetPrimitiveTopology(uint32_t topology) override;
+    virtual void ClearRenderTargetView(uint64_t cpuDescriptor, const float color[4]) override;
+    virtual void ClearDepthStencilView(uint64_t cpuDescriptor, uint32_t clearFlags, float depth, uint8_t stencil) override;
+    virtual void DrawInstanced(uint32_t vertexCountPerInstance, uint32_t instanceCount,
+        uint32_t startVertexLocation, uint32_t startInstanceLocation) override;
+    virtual void DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount,
+        uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation) override;
+    virtual void CopyBufferRegion(RenderHandle dest, uint64_t destOffset, RenderHandle source, uint64_t sourceOffset,
+        uint64_t numBytes) override;
+    virtual void EndQuery(RenderHandle queryHeap, uint32_t type, uint32_t index) override;
+    virtual void ResourceBarrier(uint32_t count, const ResourceTransition* transitions) override;
+
+    const RecordingCommandList& GetRecording() const { return mRecording; }
+    //本次录制的统计，提交时累加到设备上
+    const RenderBackendStats& GetStats() const { return mStats; }
+
+private:
+    RecordingCommandList mRecording;
+    RenderBackendStats mStats;
+};
+
+//模拟的fence：Signal时由队列算出完成的时刻，时间到达后GetCompletedValue才返回该值
+class NullRenderFence : public IRenderFence
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    explicit NullRenderFence(uint64_t initialValue);
+
+    virtual uint64_t GetCompletedValue() const override;
+    virtual void WaitForValue(uint64_t value) override;
+
+    //value在time时刻完成
+    void Schedule(uint64_t value, Clock::time_point time);
+    //value完成的时刻，已经完成时返回time_point()，从未Signal过时返回false
+    bool GetCompletionTime(uint64_t value, Clock::time_point& time) const;
+
+private:
+    void Advance(Clock::time_point now) const;
+
+private:
+    mutable std::mutex mMutex;
+    mutable uint64_t mCompleted = 0;
+    //按完成时刻排序的待完成值
+    mutable std::vector<std::pair<uint64_t, Clock::time_point>> mPending;
+};
+
+//模拟的队列：命令列表按提交顺序在一个虚拟的GPU时间线上执行
+class NullRenderQueue : public IRenderQueue
+{
+public:
+    NullRenderQueue(NullRenderDevice& device, const NullRenderConfig& config);
+
+    virtual void ExecuteCommandLists(uint32_t count, IRenderCommandList* const* lists) override;
+    virtual void Signal(IRenderFence& fence, uint64_t value) override;
+    virtual void Wait(IRenderFence& fence, uint64_t value) override;
+
+private:
+    NullRenderDevice& mDevice;
+    NullRenderConfig mConfig;
+    std::mutex mMutex;
+    //虚拟GPU执行完已提交命令的时刻
+    NullRenderFence::Clock::time_point mBusyUntil;
+};
+
+//空后端：不需要显卡与窗口，用于无界面的基准测试(测量每帧的CPU开销)
+class NullRenderDevice : public IRenderDevice
+{
+public:
+    explicit NullRenderDevice(const NullRenderConfig& config = NullRenderConfig());
+
+    virtual std::unique_ptr<IRenderQueue> CreateQueue(RenderQueueType type) override;
+    virtual std::unique_ptr<IRenderCommandList> CreateCommandList(RenderQueueType type) override;
+    virtual std::unique_ptr<IRenderFence> CreateFence(uint64_t initialValue) override;
+
+    virtual void CopyDescriptorsSimple(uint32_t count, uint64_t destCpuDescriptor, uint64_t sourceCpuDescriptor,
+        uint32_t heapType) override;
+    virtual void WriteUploadBuffer(RenderHandle buffer, uint64_t offset, const void* data, size_t size) override;
+
+    RenderBackendStats GetStats() const;
+    void ResetStats();
+
+private:
+    friend class NullRenderQueue;
+    void Accumulate(const RenderBackendStats& stats);
+
+private:
+    NullRenderConfig mConfig;
+    mutable std::mutex mMutex;
+    RenderBackendStats mStats;
+};
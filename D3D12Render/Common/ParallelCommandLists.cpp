@@ -0,0 +1,40 @@
+#include "ParallelCommandLists.h"
+
+using Microsoft::WRL::ComPtr;
+
+ParallelCommandLists::ParallelCommandLists(ID3D12Device* device, const std::vector<ComPtr<ID3D12CommandAllocator>>& allocators,
+    D3D12_COMMAND_LIST_TYPE type)
+{
+    mLists.resize(allocators.size());
+    for (size_t i = 0; i < allocators.size(); ++i)
+    {
+        ThrowIfFailed(device->CreateCommandList(0, type, allocators[i].Get(), nullptr,
+            IID_PPV_ARGS(mLists[i].GetAddressOf())));
+        //创建后处于打开状态，先关闭，每帧由Reset打开
+        ThrowIfFailed(mLists[i]->Close());
+        mRawLists.push_back(mLists[i].Get());
+    }
+}
+
+void ParallelCommandLists::Reset(const std::vector<ComPtr<ID3D12CommandAllocator>>& allocators, ID3D12PipelineState* initialState)
+{
+    assert(allocators.size() == mLists.size());
+    for (size_t i = 0; i < mLists.size(); ++i)
+    {
+        ThrowIfFailed(allocators[i]->Reset());
+        ThrowIfFailed(mLists[i]->Reset(allocators[i].Get(), initialState));
+    }
+}
+
+void ParallelCommandLists::Close()
+{
+    for (auto& list : mLists)
+    {
+        ThrowIfFailed(list->Close());
+    }
+}
+
+void ParallelCommandLists::AppendTo(std::vector<ID3D12CommandList*>& submission) const
+{
+    submission.insert(submission.end(), mRawLists.begin(), mRawLists.end());
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "ParallelRecord.h"
+
+//一组用于并行录制的命令列表，第i个列表录制第i块绘制，使用帧资源中的第i个工作线程命令分配器
+//各列表之间不共享任何状态，每个列表都需要自己设置视口、渲染目标、描述符堆、根签名等
+//资源状态转换不在工作线程中记录，由主线程在这些列表之前或之后的列表中统一完成
+class ParallelCommandLists
+{
+public:
+    //列表数量与allocators相同，创建后处于关闭状态
+    ParallelCommandLists(ID3D12Device* device, const std::vector<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>>& allocators,
+        D3D12_COMMAND_LIST_TYPE type = D3D12_COMMAND_LIST_TYPE_DIRECT);
+    ParallelCommandLists(const ParallelCommandLists& rhs) = delete;
+    ParallelCommandLists& operator=(const ParallelCommandLists& rhs) = delete;
+
+    //重置分配器与列表，调用者需要保证GPU已经执行完这些分配器上次记录的命令
+    void Reset(const std::vector<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>>& allocators, ID3D12PipelineState* initialState);
+
+    //把[0,itemCount)切块并行录制：record(ID3D12GraphicsCommandList* list, size_t listIndex, size_t begin, size_t end)
+    //录制之后列表仍是打开的，可以继续在其中记录(如最后一个列表中的资源状态转换)，再调用Close
+    template<typename Func>
+    void Record(JobSystem& jobs, size_t itemCount, Func&& record)
+    {
+        ParallelRecord(jobs, mRawLists.data(), mRawLists.size(), itemCount,
+            [&record](ID3D12GraphicsCommandList& list, size_t index, size_t begin, size_t end)
+        {
+            record(&list, index, begin, end);
+        });
+    }
+
+    void Close();
+
+    //按块的顺序追加到submission，与其他列表一起用一次ExecuteCommandLists提交
+    void AppendTo(std::vector<ID3D12CommandList*>& submission) const;
+
+    ID3D12GraphicsCommandList* GetList(UINT index) const { return mRawLists[index]; }
+    UINT GetListCount() const { return static_cast<UINT>(mRawLists.size()); }
+
+private:
+    std::vector<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>> mLists;
+    std::vector<ID3D12GraphicsCommandList*> mRawLists;
+};
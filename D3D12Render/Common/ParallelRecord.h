@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "JobSystem.h"
+
+//把[0,itemCount)按顺序均匀地切成listCount块，第i块用lists[i]录制：record(*lists[i], i, begin, end)
+//块在JobSystem中执行，等待期间调用线程也参与录制；函数返回时所有块都已录制完毕
+//块与列表一一对应，按列表的顺序提交即可得到与单线程录制相同的命令顺序，与各线程完成的先后无关
+//List只需要record能够使用，可以是ID3D12GraphicsCommandList，也可以是RecordingCommandList等替身
+template<typename List, typename Func>
+void ParallelRecord(JobSystem& jobs, List* const* lists, size_t listCount, size_t itemCount, Func&& record)
+{
+    jobs.ParallelFor(listCount, 1, [&](size_t first, size_t last)
+    {
+        for (size_t i = first; i < last; ++i)
+        {
+            const size_t begin = static_cast<size_t>(static_cast<uint64_t>(itemCount) * i / listCount);
+            const size_t end = static_cast<size_t>(static_cast<uint64_t>(itemCount) * (i + 1) / listCount);
+            record(*lists[i], i, begin, end);
+        }
+    });
+}
@@ -0,0 +1,265 @@
+#include "PipelineCache.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+    void AddShader(PipelineKeyBuilder& key, const D3D12_SHADER_BYTECODE& shader)
+    {
+        key.AddBytes(shader.pShaderBytecode, shader.pShaderBytecode != nullptr ? shader.BytecodeLength : 0);
+    }
+
+    ComPtr<ID3D12PipelineState> CreatePipeline(ID3D12Device* device, D3D12_GRAPHICS_PIPELINE_STATE_DESC desc,
+        const std::vector<uint8_t>& cachedBlob, std::vector<uint8_t>& newBlob)
+    {
+        ComPtr<ID3D12PipelineState> pso;
+        bool fromCache = false;
+        if (!cachedBlob.empty())
+        {
+            desc.CachedPSO.pCachedBlob = cachedBlob.data();
+            desc.CachedPSO.CachedBlobSizeInBytes = cachedBlob.size();
+            //驱动或显卡变化后缓存会被拒绝(D3D12_ERROR_DRIVER_VERSION_MISMATCH等)，此时不用缓存重新创建
+            fromCache = SUCCEEDED(device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(pso.GetAddressOf())));
+            desc.CachedPSO = {};
+        }
+        if (!fromCache)
+        {
+            ThrowIfFailed(device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(pso.ReleaseAndGetAddressOf())));
+        }
+
+        //从缓存创建时保留原来的内容，避免每次运行都重写文件
+        if (fromCache)
+        {
+            newBlob = cachedBlob;
+        }
+        else
+        {
+            ComPtr<ID3DBlob> blob;
+            if (SUCCEEDED(pso->GetCachedBlob(blob.GetAddressOf())) && blob != nullptr)
+            {
+                const uint8_t* data = static_cast<const uint8_t*>(blob->GetBufferPointer());
+                newBlob.assign(data, data + blob->GetBufferSize());
+            }
+        }
+        return pso;
+    }
+}
+
+OwnedPipelineDesc::OwnedPipelineDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc) :
+    Desc(desc),
+    RootSignature(desc.pRootSignature)
+{
+    D3D12_SHADER_BYTECODE* shaders[] = { &Desc.VS, &Desc.PS, &Desc.DS, &Desc.HS, &Desc.GS };
+    for (size_t i = 0; i < _countof(shaders); ++i)
+    {
+        const uint8_t* code = static_cast<const uint8_t*>(shaders[i]->pShaderBytecode);
+        if (code != nullptr)
+        {
+            Shaders[i].assign(code, code + shaders[i]->BytecodeLength);
+            shaders[i]->pShaderBytecode = Shaders[i].data();
+        }
+    }
+
+    //语义名字符串一起拷贝，先占好位置，避免扩容后指针失效
+    SemanticNames.reserve(desc.InputLayout.NumElements + desc.StreamOutput.NumEntries);
+
+    InputElements.assign(desc.InputLayout.pInputElementDescs,
+        desc.InputLayout.pInputElementDescs + desc.InputLayout.NumElements);
+    for (D3D12_INPUT_ELEMENT_DESC& element : InputElements)
+    {
+        SemanticNames.push_back(element.SemanticName != nullptr ? element.SemanticName : "");
+        element.SemanticName = SemanticNames.back().c_str();
+    }
+    Desc.InputLayout.pInputElementDescs = InputElements.data();
+
+    if (desc.StreamOutput.NumEntries > 0)
+    {
+        SODeclarations.assign(desc.StreamOutput.pSODeclaration,
+            desc.StreamOutput.pSODeclaration + desc.StreamOutput.NumEntries);
+        for (D3D12_SO_DECLARATION_ENTRY& entry : SODeclarations)
+        {
+            if (entry.SemanticName != nullptr)
+            {
+                SemanticNames.push_back(entry.SemanticName);
+                entry.SemanticName = SemanticNames.back().c_str();
+            }
+        }
+        Desc.StreamOutput.pSODeclaration = SODeclarations.data();
+    }
+    if (desc.StreamOutput.NumStrides > 0)
+    {
+        SOStrides.assign(desc.StreamOutput.pBufferStrides,
+            desc.StreamOutput.pBufferStrides + desc.StreamOutput.NumStrides);
+        Desc.StreamOutput.pBufferStrides = SOStrides.data();
+    }
+
+    //PSO的缓存由PipelineLibrary提供
+    Desc.CachedPSO = {};
+}
+
+PipelineCache::PipelineCache(ID3D12Device* device, const std::wstring& cacheDir, JobSystem& jobs) :
+    mDevice(device),
+    mLibrary(cacheDir),
+    mJobs(jobs)
+{
+}
+
+PipelineCache::~PipelineCache()
+{
+    //后台任务引用了mLibrary与mDevice，先等它们完成(创建失败的异常已经交给了future，Wait不会抛出)
+    mJobs.Wait(mPrecompileJobs);
+}
+
+ComPtr<ID3D12RootSignature> PipelineCache::GetRootSignature(const D3D12_ROOT_SIGNATURE_DESC& desc)
+{
+    ComPtr<ID3DBlob> serialized = nullptr;
+    ComPtr<ID3DBlob> errors = nullptr;
+    HRESULT hr = D3D12SerializeRootSignature(&desc, D3D_ROOT_SIGNATURE_VERSION_1, serialized.GetAddressOf(), errors.GetAddressOf());
+    if (errors != nullptr)
+    {
+        OutputDebugStringA((char*)errors->GetBufferPointer());
+    }
+    ThrowIfFailed(hr);
+
+    const uint64_t key = Hash::Hash64(serialized->GetBufferPointer(), serialized->GetBufferSize());
+
+    std::lock_guard<std::mutex> lock(mRootSignatureMutex);
+    auto it = mRootSignatures.find(key);
+    if (it != mRootSignatures.end())
+    {
+        return it->second;
+    }
+
+    ComPtr<ID3D12RootSignature> rootSignature;
+    ThrowIfFailed(mDevice->CreateRootSignature(0, serialized->GetBufferPointer(), serialized->GetBufferSize(),
+        IID_PPV_ARGS(rootSignature.GetAddressOf())));
+    mRootSignatures.emplace(key, rootSignature);
+    mRootSignatureKeys.emplace(rootSignature.Get(), key);
+    return rootSignature;
+}
+
+uint64_t PipelineCache::ComputeKey(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc) const
+{
+    return ComputeKey(desc, nullptr);
+}
+
+uint64_t PipelineCache::ComputeKey(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, std::vector<uint8_t>* fields) const
+{
+    PipelineKeyBuilder key(0, fields);
+
+    {
+        std::lock_guard<std::mutex> lock(mRootSignatureMutex);
+        auto it = mRootSignatureKeys.find(desc.pRootSignature);
+        if (it != mRootSignatureKeys.end())
+        {
+            key.Add<uint32_t>(1).Add(it->second);
+        }
+        else
+        {
+            key.Add<uint32_t>(0).Add(reinterpret_cast<uintptr_t>(desc.pRootSignature));
+        }
+    }
+
+    AddShader(key, desc.VS);
+    AddShader(key, desc.PS);
+    AddShader(key, desc.DS);
+    AddShader(key, desc.HS);
+    AddShader(key, desc.GS);
+
+    key.Add(desc.StreamOutput.NumEntries);
+    for (UINT i = 0; i < desc.StreamOutput.NumEntries; ++i)
+    {
+        const D3D12_SO_DECLARATION_ENTRY& entry = desc.StreamOutput.pSODeclaration[i];
+        key.Add(entry.Stream).AddString(entry.SemanticName).Add(entry.SemanticIndex)
+            .Add(entry.StartComponent).Add(entry.ComponentCount).Add(entry.OutputSlot);
+    }
+    key.Add(desc.StreamOutput.NumStrides);
+    for (UINT i = 0; i < desc.StreamOutput.NumStrides; ++i)
+    {
+        key.Add(desc.StreamOutput.pBufferStrides[i]);
+    }
+    key.Add(desc.StreamOutput.RasterizedStream);
+
+    //BlendState中有BOOL与UINT8混排，逐字段加入
+    const D3D12_BLEND_DESC& blend = desc.BlendState;
+    key.Add(blend.AlphaToCoverageEnable).Add(blend.IndependentBlendEnable);
+    for (const D3D12_RENDER_TARGET_BLEND_DESC& rt : blend.RenderTarget)
+    {
+        key.Add(rt.BlendEnable).Add(rt.LogicOpEnable)
+            .Add(rt.SrcBlend).Add(rt.DestBlend).Add(rt.BlendOp)
+            .Add(rt.SrcBlendAlpha).Add(rt.DestBlendAlpha).Add(rt.BlendOpAlpha)
+            .Add(rt.LogicOp).Add(rt.RenderTargetWriteMask);
+    }
+    key.Add(desc.SampleMask);
+
+    const D3D12_RASTERIZER_DESC& raster = desc.RasterizerState;
+    key.Add(raster.FillMode).Add(raster.CullMode).Add(raster.FrontCounterClockwise)
+        .Add(raster.DepthBias).Add(raster.DepthBiasClamp).Add(raster.SlopeScaledDepthBias)
+        .Add(raster.DepthClipEnable).Add(raster.MultisampleEnable).Add(raster.AntialiasedLineEnable)
+        .Add(raster.ForcedSampleCount).Add(raster.ConservativeRaster);
+
+    const D3D12_DEPTH_STENCIL_DESC& depth = desc.DepthStencilState;
+    key.Add(depth.DepthEnable).Add(depth.DepthWriteMask).Add(depth.DepthFunc)
+        .Add(depth.StencilEnable).Add(depth.StencilReadMask).Add(depth.StencilWriteMask);
+    for (const D3D12_DEPTH_STENCILOP_DESC* face : { &depth.FrontFace, &depth.BackFace })
+    {
+        key.Add(face->StencilFailOp).Add(face->StencilDepthFailOp).Add(face->StencilPassOp).Add(face->StencilFunc);
+    }
+
+    key.Add(desc.InputLayout.NumElements);
+    for (UINT i = 0; i < desc.InputLayout.NumElements; ++i)
+    {
+        const D3D12_INPUT_ELEMENT_DESC& element = desc.InputLayout.pInputElementDescs[i];
+        key.AddString(element.SemanticName).Add(element.SemanticIndex).Add(element.Format)
+            .Add(element.InputSlot).Add(element.AlignedByteOffset)
+            .Add(element.InputSlotClass).Add(element.InstanceDataStepRate);
+    }
+
+    key.Add(desc.IBStripCutValue).Add(desc.PrimitiveTopologyType).Add(desc.NumRenderTargets);
+    for (UINT i = 0; i < desc.NumRenderTargets; ++i)
+    {
+        key.Add(desc.RTVFormats[i]);
+    }
+    key.Add(desc.DSVFormat).Add(desc.SampleDesc.Count).Add(desc.SampleDesc.Quality)
+        .Add(desc.NodeMask).Add(desc.Flags);
+
+    return key.GetKey();
+}
+
+std::shared_ptr<const OwnedPipelineDesc> PipelineCache::Describe(
+    const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t& key) const
+{
+    auto owned = std::make_shared<OwnedPipelineDesc>(desc);
+    key = ComputeKey(desc, &owned->Fields);
+    return owned;
+}
+
+PipelineCache::Library::CreateFunc PipelineCache::MakeCreateFunc() const
+{
+    ID3D12Device* device = mDevice;
+    return [device](const OwnedPipelineDesc& owned, const std::vector<uint8_t>& cachedBlob, std::vector<uint8_t>& newBlob)
+    {
+        return CreatePipeline(device, owned.Desc, cachedBlob, newBlob);
+    };
+}
+
+ComPtr<ID3D12PipelineState> PipelineCache::GetGraphicsPipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc)
+{
+    return GetGraphicsPipeline(ComputeKey(desc), desc);
+}
+
+ComPtr<ID3D12PipelineState> PipelineCache::GetGraphicsPipeline(uint64_t key, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc)
+{
+    //key与desc不对应时两者的字段不同，按碰撞处理
+    uint64_t descKey = 0;
+    std::shared_ptr<const OwnedPipelineDesc> owned = Describe(desc, descKey);
+    return mLibrary.Get(key, owned, MakeCreateFunc());
+}
+
+uint64_t PipelineCache::Precompile(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc)
+{
+    uint64_t key = 0;
+    std::shared_ptr<const OwnedPipelineDesc> owned = Describe(desc, key);
+    mLibrary.Precompile(key, owned, MakeCreateFunc(), mJobs, mPrecompileJobs);
+    return key;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "PipelineLibrary.h"
+
+//PSO的完整描述，自己持有所有指针指向的数据，调用返回后仍可以在后台线程中使用
+//Fields为计算键时按顺序记录的全部字段，键相同时比较它与根签名对象，排除哈希碰撞
+struct OwnedPipelineDesc
+{
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC Desc;
+    Microsoft::WRL::ComPtr<ID3D12RootSignature> RootSignature;
+    std::vector<uint8_t> Shaders[5];
+    std::vector<D3D12_INPUT_ELEMENT_DESC> InputElements;
+    std::vector<D3D12_SO_DECLARATION_ENTRY> SODeclarations;
+    std::vector<UINT> SOStrides;
+    std::vector<std::string> SemanticNames;
+    std::vector<uint8_t> Fields;
+
+    explicit OwnedPipelineDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc);
+    //Desc中的指针指向自己的成员，不能拷贝
+    OwnedPipelineDesc(const OwnedPipelineDesc& rhs) = delete;
+    OwnedPipelineDesc& operator=(const OwnedPipelineDesc& rhs) = delete;
+
+    bool operator==(const OwnedPipelineDesc& rhs) const
+    {
+        return RootSignature == rhs.RootSignature && Fields == rhs.Fields;
+    }
+};
+
+//根签名与图形PSO的缓存
+//根签名按序列化后的内容去重，相同布局的根签名只创建一次
+//PSO以完整描述(着色器字节码、输入布局、各项状态、根签名内容)的哈希为键，键命中时再比较完整描述，驱动生成的缓存(CachedPSO)保存在磁盘上，
+//下次运行时直接交给驱动，省去着色器的二次编译；驱动更新导致缓存失效时自动重新创建并覆盖
+class PipelineCache
+{
+public:
+    //cacheDir为空时只在内存中缓存
+    //jobs用于Precompile的后台创建
+    PipelineCache(ID3D12Device* device, const std::wstring& cacheDir, JobSystem& jobs);
+    PipelineCache(const PipelineCache& rhs) = delete;
+    PipelineCache& operator=(const PipelineCache& rhs) = delete;
+    ~PipelineCache();
+
+    //内容相同的根签名返回同一个对象
+    Microsoft::WRL::ComPtr<ID3D12RootSignature> GetRootSignature(const D3D12_ROOT_SIGNATURE_DESC& desc);
+
+    //根签名需要是由GetRootSignature创建的，否则只能按指针区分(同一布局的不同对象会得到不同的键)
+    uint64_t ComputeKey(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc) const;
+
+    //第一次使用时才创建，创建失败时抛出异常
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> GetGraphicsPipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc);
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> GetGraphicsPipeline(uint64_t key, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc);
+
+    //在后台线程中提前创建，desc会被完整拷贝，调用返回后即可释放其引用的数据；返回PSO的键
+    //之后用同一个键调用GetGraphicsPipeline会等待后台创建完成
+    uint64_t Precompile(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc);
+
+    PipelineLibraryStats GetStats() const { return mLibrary.GetStats(); }
+
+private:
+    typedef PipelineLibrary<Microsoft::WRL::ComPtr<ID3D12PipelineState>, OwnedPipelineDesc> Library;
+
+    //fields不为空时记录参与计算的全部字段
+    uint64_t ComputeKey(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, std::vector<uint8_t>* fields) const;
+    //拷贝描述并记录其字段，key输出描述的键
+    std::shared_ptr<const OwnedPipelineDesc> Describe(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t& key) const;
+    Library::CreateFunc MakeCreateFunc() const;
+
+private:
+    ID3D12Device* mDevice = nullptr;
+
+    mutable std::mutex mRootSignatureMutex;
+    std::unordered_map<uint64_t, Microsoft::WRL::ComPtr<ID3D12RootSignature>> mRootSignatures;
+    //根签名对象到其内容哈希，计算PSO的键时使用
+    std::unordered_map<ID3D12RootSignature*, uint64_t> mRootSignatureKeys;
+
+    Library mLibrary;
+    JobSystem& mJobs;
+    //Precompile派生的任务，析构时先等它们完成
+    JobCounter mPrecompileJobs;
+};
@@ -0,0 +1,308 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "BlobStore.h"
+#include "Hash.h"
+#include "JobSystem.h"
+
+//逐个字段累积流水线描述的哈希。只接受标量，结构体需要逐字段加入，避免把填充字节算进键里
+//record不为空时同时把加入的字段按顺序记录下来，键相同时比较记录的内容即可排除哈希碰撞
+class PipelineKeyBuilder
+{
+public:
+    explicit PipelineKeyBuilder(uint64_t seed = 0, std::vector<uint8_t>* record = nullptr) :
+        mKey(seed),
+        mRecord(record)
+    {
+    }
+
+    template<typename T>
+    PipelineKeyBuilder& Add(T value)
+    {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "PipelineKeyBuilder: add structs field by field");
+        mKey = Hash::Combine(mKey, Hash::Hash64(&value, sizeof(value)));
+        Record(&value, sizeof(value));
+        return *this;
+    }
+
+    //先混入长度，避免相邻的两段数据交换边界后得到相同的键
+    PipelineKeyBuilder& AddBytes(const void* data, size_t size)
+    {
+        mKey = Hash::Combine(mKey, Hash::Hash64(data, size, size));
+        const uint64_t length = size;
+        Record(&length, sizeof(length));
+        Record(data, size);
+        return *this;
+    }
+
+    //nullptr与空字符串视为不同
+    PipelineKeyBuilder& AddString(const char* str)
+    {
+        if (str == nullptr)
+        {
+            return Add<uint64_t>(~0ull);
+        }
+        return AddBytes(str, strlen(str));
+    }
+
+    uint64_t GetKey() const { return mKey; }
+
+private:
+    void Record(const void* data, size_t size)
+    {
+        if (mRecord != nullptr && size > 0)
+        {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            mRecord->insert(mRecord->end(), bytes, bytes + size);
+        }
+    }
+
+private:
+    uint64_t mKey = 0;
+    std::vector<uint8_t>* mRecord = nullptr;
+};
+
+struct PipelineLibraryStats
+{
+    uint64_t MemoryHits = 0;
+    uint64_t DiskHits = 0;          //使用了磁盘上保存的驱动缓存创建
+    uint64_t Created = 0;           //没有可用的缓存，从头创建
+    uint64_t CreateFailures = 0;
+    uint64_t Deduplicated = 0;      //与其他线程正在创建的同一键合并的次数
+    uint64_t KeyCollisions = 0;     //键相同而描述不同，这些对象不进入缓存
+};
+
+//按键缓存流水线对象(PSO等)，与平台无关：对象由调用者提供的create函数创建，
+//create收到磁盘上保存的驱动缓存(没有时为空)，并可输出新的驱动缓存，由库写回磁盘供下次运行使用
+//对象在第一次Get时才创建，也可以提前用Precompile在JobSystem中创建；同一个键同时只会创建一次
+//键只用于查找，每个对象同时保存它的完整描述，键命中时用operator==比较描述，不相同时视为哈希碰撞
+//T需要可拷贝，并可以转换为bool表示是否创建成功(如ComPtr、shared_ptr)；Desc需要支持operator==
+template<typename T, typename Desc>
+class PipelineLibrary
+{
+public:
+    typedef std::shared_ptr<const Desc> DescPtr;
+    //cachedBlob为磁盘上的驱动缓存(可能为空，也可能已经因驱动更新而失效)，newBlob输出需要保存的驱动缓存(为空时不保存)
+    typedef std::function<T(const Desc& desc, const std::vector<uint8_t>& cachedBlob, std::vector<uint8_t>& newBlob)> CreateFunc;
+
+    //cacheDir为空时只使用内存缓存
+    explicit PipelineLibrary(const std::wstring& cacheDir) :
+        mStore(cacheDir, L".pso", 0x4f535050 /*"PPSO"*/, 1)
+    {
+    }
+    PipelineLibrary(const PipelineLibrary& rhs) = delete;
+    PipelineLibrary& operator=(const PipelineLibrary& rhs) = delete;
+
+    //返回键对应的对象，尚未创建时在当前线程创建，失败时返回T()
+    //其他线程正在创建同一个对象时等待它完成，因此只应在非工作线程中调用，任务中使用Precompile
+    T Get(uint64_t key, const DescPtr& desc, const CreateFunc& create)
+    {
+        std::promise<T> promise;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            auto it = mEntries.find(key);
+            if (it != mEntries.end())
+            {
+                if (*it->second.Description == *desc)
+                {
+                    ++mStats.MemoryHits;
+                    return it->second.Value;
+                }
+                ++mStats.KeyCollisions;
+                lock.unlock();
+                return CreateUncached(*desc, create);
+            }
+
+            auto pending = mPending.find(key);
+            if (pending != mPending.end())
+            {
+                if (*pending->second.Description == *desc)
+                {
+                    ++mStats.Deduplicated;
+                    std::shared_future<T> future = pending->second.Future;
+                    lock.unlock();
+                    return future.get();
+                }
+                ++mStats.KeyCollisions;
+                lock.unlock();
+                return CreateUncached(*desc, create);
+            }
+
+            mPending.emplace(key, PendingEntry{ desc, promise.get_future().share() });
+        }
+        return CreateMiss(key, desc, create, promise);
+    }
+
+    //作为jobs中的任务提前创建，已经创建或正在创建时不重复提交
+    //是否命中在调用线程中判断，任务中不会等待其他任务的结果
+    //create在工作线程中调用，其引用的数据需要保持有效直到future完成；销毁库之前要先jobs.Wait(counter)
+    std::shared_future<T> Precompile(uint64_t key, const DescPtr& desc, CreateFunc create, JobSystem& jobs, JobCounter& counter)
+    {
+        auto promise = std::make_shared<std::promise<T>>();
+        std::shared_future<T> future = promise->get_future().share();
+        bool collision = false;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            auto it = mEntries.find(key);
+            auto pending = mPending.find(key);
+            if (it != mEntries.end() && *it->second.Description == *desc)
+            {
+                promise->set_value(it->second.Value);
+                return future;
+            }
+            if (pending != mPending.end() && *pending->second.Description == *desc)
+            {
+                return pending->second.Future;
+            }
+
+            collision = it != mEntries.end() || pending != mPending.end();
+            if (collision)
+            {
+                ++mStats.KeyCollisions;
+            }
+            else
+            {
+                mPending.emplace(key, PendingEntry{ desc, future });
+            }
+        }
+
+        if (collision)
+        {
+            return jobs.Submit(counter, [this, desc, create]() { return CreateUncached(*desc, create); }).share();
+        }
+        jobs.Run(counter, [this, key, desc, create, promise]()
+        {
+            try
+            {
+                CreateMiss(key, desc, create, *promise);
+            }
+            catch (...)
+            {
+                //异常已经交给了future
+            }
+        });
+        return future;
+    }
+
+    //只查找已经创建好的对象，不阻塞
+    bool TryGet(uint64_t key, const Desc& desc, T& value) const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mEntries.find(key);
+        if (it == mEntries.end() || !(*it->second.Description == desc))
+        {
+            return false;
+        }
+        value = it->second.Value;
+        return true;
+    }
+
+    PipelineLibraryStats GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mStats;
+    }
+
+private:
+    struct Entry
+    {
+        DescPtr Description;
+        T Value;
+    };
+
+    struct PendingEntry
+    {
+        DescPtr Description;
+        std::shared_future<T> Future;
+    };
+
+    //调用者已在mPending中登记key，读取驱动缓存并创建，写回缓存、移除登记并兑现promise
+    T CreateMiss(uint64_t key, const DescPtr& desc, const CreateFunc& create, std::promise<T>& promise)
+    {
+        T value;
+        bool fromDisk = false;
+        try
+        {
+            std::vector<uint8_t> cachedBlob;
+            fromDisk = mStore.Load(key, cachedBlob);
+
+            std::vector<uint8_t> newBlob;
+            value = create(*desc, cachedBlob, newBlob);
+
+            //驱动缓存失效时create会重新生成，内容不同才写回
+            if (value && !newBlob.empty() && newBlob != cachedBlob)
+            {
+                fromDisk = false;
+                mStore.Save(key, newBlob.data(), newBlob.size());
+            }
+        }
+        catch (...)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mPending.erase(key);
+            }
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (!value)
+            {
+                ++mStats.CreateFailures;
+            }
+            else
+            {
+                if (fromDisk)
+                {
+                    ++mStats.DiskHits;
+                }
+                else
+                {
+                    ++mStats.Created;
+                }
+                mEntries[key] = Entry{ desc, value };
+            }
+            mPending.erase(key);
+        }
+
+        promise.set_value(value);
+        return value;
+    }
+
+    //键已被另一个描述占用：不读写该键的驱动缓存，结果也不进入缓存
+    T CreateUncached(const Desc& desc, const CreateFunc& create)
+    {
+        std::vector<uint8_t> newBlob;
+        T value = create(desc, std::vector<uint8_t>(), newBlob);
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (value)
+        {
+            ++mStats.Created;
+        }
+        else
+        {
+            ++mStats.CreateFailures;
+        }
+        return value;
+    }
+
+private:
+    BlobStore mStore;
+
+    mutable std::mutex mMutex;
+    std::unordered_map<uint64_t, Entry> mEntries;
+    std::unordered_map<uint64_t, PendingEntry> mPending;
+    PipelineLibraryStats mStats;
+};
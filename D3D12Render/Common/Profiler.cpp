@@ -0,0 +1,383 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <unordered_map>
+#include "FileUtil.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+int64_t ProfilerClock::Now()
+{
+#ifdef _WIN32
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return counter.QuadPart;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+int64_t ProfilerClock::Frequency()
+{
+#ifdef _WIN32
+    static const int64_t frequency = []()
+    {
+        LARGE_INTEGER value;
+        QueryPerformanceFrequency(&value);
+        return value.QuadPart;
+    }();
+    return frequency;
+#else
+    return 1000000000;
+#endif
+}
+
+double ProfileFrame::GetCpuMs() const
+{
+    return (End - Start) * 1000.0 / ProfilerClock::Frequency();
+}
+
+//每个线程一个，只有所属线程写入Events/Write，只有收集的线程(持有mThreadsMutex)写入Read
+struct Profiler::ThreadBuffer
+{
+    static const uint32_t Capacity = 8192;
+
+    ProfileEvent Events[Capacity];
+    std::atomic<uint32_t> Write{ 0 };
+    std::atomic<uint32_t> Read{ 0 };
+    std::atomic<uint64_t> Counters[(size_t)ProfileCounter::Count];
+    std::atomic<uint64_t> Dropped{ 0 };
+
+    uint32_t Index = 0;
+    const char* Name = nullptr;
+    uint32_t Depth = 0;     //只由所属线程访问
+};
+
+thread_local Profiler::ThreadBuffer* Profiler::tThreadBuffer = nullptr;
+
+namespace
+{
+    void AppendEscaped(std::string& out, const char* text)
+    {
+        for (const char* c = text; *c != '\0'; ++c)
+        {
+            if (*c == '"' || *c == '\\')
+            {
+                out += '\\';
+                out += *c;
+            }
+            else if (static_cast<unsigned char>(*c) < 0x20)
+            {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(*c));
+                out += escaped;
+            }
+            else
+            {
+                out += *c;
+            }
+        }
+    }
+}
+
+Profiler& Profiler::Get()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler() :
+    mEnabled(true)
+{
+}
+
+Profiler::~Profiler()
+{
+}
+
+Profiler::ThreadBuffer& Profiler::GetThreadBuffer()
+{
+    if (tThreadBuffer == nullptr)
+    {
+        std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer());
+        for (auto& counter : buffer->Counters)
+        {
+            counter.store(0, std::memory_order_relaxed);
+        }
+
+        std::lock_guard<std::mutex> lock(mThreadsMutex);
+        buffer->Index = static_cast<uint32_t>(mThreads.size());
+        tThreadBuffer = buffer.get();
+        mThreads.push_back(std::move(buffer));
+    }
+    return *tThreadBuffer;
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+    ThreadBuffer& buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(mThreadsMutex);
+    buffer.Name = name;
+}
+
+void Profiler::SetHistorySize(size_t frameCount)
+{
+    std::lock_guard<std::mutex> lock(mFramesMutex);
+    mHistorySize = std::max<size_t>(frameCount, 1);
+    while (mFrames.size() > mHistorySize)
+    {
+        mFrames.pop_front();
+    }
+}
+
+void Profiler::BeginFrame()
+{
+    mFrameStart = ProfilerClock::Now();
+}
+
+void Profiler::EndFrame()
+{
+    ProfileFrame frame;
+    frame.FrameIndex = mFrameIndex++;
+    frame.Start = mFrameStart;
+    frame.End = ProfilerClock::Now();
+
+    {
+        std::lock_guard<std::mutex> lock(mThreadsMutex);
+        for (auto& buffer : mThreads)
+        {
+            const uint32_t write = buffer->Write.load(std::memory_order_acquire);
+            const uint32_t read = buffer->Read.load(std::memory_order_relaxed);
+            for (uint32_t i = read; i != write; ++i)
+            {
+                frame.Events.push_back(buffer->Events[i % ThreadBuffer::Capacity]);
+            }
+            //之后所属线程才可以覆盖这些位置
+            buffer->Read.store(write, std::memory_order_release);
+
+            for (size_t c = 0; c < (size_t)ProfileCounter::Count; ++c)
+            {
+                frame.Counters[c] += buffer->Counters[c].exchange(0, std::memory_order_relaxed);
+            }
+            frame.DroppedEvents += buffer->Dropped.exchange(0, std::memory_order_relaxed);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mTracksMutex);
+        frame.Events.insert(frame.Events.end(), mSubmitted.begin(), mSubmitted.end());
+        mSubmitted.clear();
+    }
+
+    std::sort(frame.Events.begin(), frame.Events.end(),
+        [](const ProfileEvent& a, const ProfileEvent& b) { return a.Start < b.Start; });
+
+    std::lock_guard<std::mutex> lock(mFramesMutex);
+    mFrames.push_back(std::move(frame));
+    while (mFrames.size() > mHistorySize)
+    {
+        mFrames.pop_front();
+    }
+}
+
+void Profiler::AddCounter(ProfileCounter counter, uint64_t value)
+{
+    if (!IsEnabled())
+    {
+        return;
+    }
+    GetThreadBuffer().Counters[(size_t)counter].fetch_add(value, std::memory_order_relaxed);
+}
+
+uint32_t Profiler::RegisterTrack(const char* name)
+{
+    std::lock_guard<std::mutex> lock(mTracksMutex);
+    mTrackNames.push_back(name);
+    return TrackBase + static_cast<uint32_t>(mTrackNames.size() - 1);
+}
+
+void Profiler::SubmitEvents(const ProfileEvent* events, size_t count)
+{
+    if (!IsEnabled())
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mTracksMutex);
+    mSubmitted.insert(mSubmitted.end(), events, events + count);
+}
+
+uint32_t Profiler::EnterZone()
+{
+    return GetThreadBuffer().Depth++;
+}
+
+void Profiler::LeaveZone(const char* name, int64_t start)
+{
+    ThreadBuffer& buffer = GetThreadBuffer();
+    assert(buffer.Depth > 0);
+    --buffer.Depth;
+
+    const uint32_t write = buffer.Write.load(std::memory_order_relaxed);
+    const uint32_t read = buffer.Read.load(std::memory_order_acquire);
+    if (write - read >= ThreadBuffer::Capacity)
+    {
+        buffer.Dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    ProfileEvent& event = buffer.Events[write % ThreadBuffer::Capacity];
+    event.Name = name;
+    event.Start = start;
+    event.End = ProfilerClock::Now();
+    event.Thread = buffer.Index;
+    event.Depth = buffer.Depth;
+    buffer.Write.store(write + 1, std::memory_order_release);
+}
+
+bool Profiler::GetLastFrame(ProfileFrame& frame) const
+{
+    std::lock_guard<std::mutex> lock(mFramesMutex);
+    if (mFrames.empty())
+    {
+        return false;
+    }
+    frame = mFrames.back();
+    return true;
+}
+
+std::vector<ProfileZoneTotal> Profiler::SummarizeZones(const ProfileFrame& frame)
+{
+    //区间名是静态字符串，按指针归并即可
+    std::unordered_map<const char*, size_t> indices;
+    std::vector<ProfileZoneTotal> totals;
+    const double msPerTick = 1000.0 / ProfilerClock::Frequency();
+    for (const ProfileEvent& event : frame.Events)
+    {
+        auto result = indices.emplace(event.Name, totals.size());
+        if (result.second)
+        {
+            totals.emplace_back();
+            totals.back().Name = event.Name;
+        }
+        ProfileZoneTotal& total = totals[result.first->second];
+        total.TotalMs += (event.End - event.Start) * msPerTick;
+        ++total.Calls;
+    }
+    std::sort(totals.begin(), totals.end(),
+        [](const ProfileZoneTotal& a, const ProfileZoneTotal& b) { return a.TotalMs > b.TotalMs; });
+    return totals;
+}
+
+const char* Profiler::GetCounterName(ProfileCounter counter)
+{
+    static const char* names[] = { "Draws", "Instances", "Triangles", "Barriers", "BytesUploaded" };
+    static_assert(sizeof(names) / sizeof(names[0]) == (size_t)ProfileCounter::Count, "counter name missing");
+    return names[(size_t)counter];
+}
+
+std::string Profiler::ExportChromeTrace() const
+{
+    //时间以第一帧开始为零点，单位为微秒；帧与计数器放在单独的一行
+    const uint32_t frameTrack = 0xffff;
+    std::string out = "{\"traceEvents\":[\n";
+    char line[256];
+    bool first = true;
+    auto separator = [&]()
+    {
+        if (!first)
+        {
+            out += ",\n";
+        }
+        first = false;
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(mThreadsMutex);
+        for (const auto& buffer : mThreads)
+        {
+            separator();
+            snprintf(line, sizeof(line), "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"",
+                buffer->Index);
+            out += line;
+            if (buffer->Name != nullptr)
+            {
+                AppendEscaped(out, buffer->Name);
+            }
+            else
+            {
+                snprintf(line, sizeof(line), "Thread %u", buffer->Index);
+                out += line;
+            }
+            out += "\"}}";
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mTracksMutex);
+        for (size_t i = 0; i < mTrackNames.size(); ++i)
+        {
+            separator();
+            snprintf(line, sizeof(line), "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"",
+                TrackBase + static_cast<uint32_t>(i));
+            out += line;
+            AppendEscaped(out, mTrackNames[i]);
+            out += "\"}}";
+        }
+    }
+    separator();
+    snprintf(line, sizeof(line), "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"Frames\"}}",
+        frameTrack);
+    out += line;
+
+    std::lock_guard<std::mutex> lock(mFramesMutex);
+    if (mFrames.empty())
+    {
+        out += "\n]}\n";
+        return out;
+    }
+
+    const int64_t origin = mFrames.front().Start;
+    const double usPerTick = 1000000.0 / ProfilerClock::Frequency();
+    for (const ProfileFrame& frame : mFrames)
+    {
+        separator();
+        snprintf(line, sizeof(line), "{\"ph\":\"X\",\"name\":\"Frame %llu\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+            (unsigned long long)frame.FrameIndex, frameTrack, (frame.Start - origin) * usPerTick, (frame.End - frame.Start) * usPerTick);
+        out += line;
+
+        separator();
+        snprintf(line, sizeof(line), "{\"ph\":\"C\",\"name\":\"Counters\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"args\":{",
+            frameTrack, (frame.Start - origin) * usPerTick);
+        out += line;
+        for (size_t c = 0; c < (size_t)ProfileCounter::Count; ++c)
+        {
+            snprintf(line, sizeof(line), "%s\"%s\":%llu", c == 0 ? "" : ",", GetCounterName((ProfileCounter)c),
+                (unsigned long long)frame.Counters[c]);
+            out += line;
+        }
+        out += "}}";
+
+        for (const ProfileEvent& event : frame.Events)
+        {
+            separator();
+            out += "{\"ph\":\"X\",\"name\":\"";
+            AppendEscaped(out, event.Name);
+            snprintf(line, sizeof(line), "\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                event.Thread, (event.Start - origin) * usPerTick, (event.End - event.Start) * usPerTick);
+            out += line;
+        }
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+bool Profiler::WriteChromeTrace(const std::wstring& path) const
+{
+    const std::string trace = ExportChromeTrace();
+    return FileUtil::WriteAllBytes(path, trace.data(), trace.size());
+}
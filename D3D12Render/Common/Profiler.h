@@ -0,0 +1,168 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//性能分析使用的时钟，Windows上为QueryPerformanceCounter(与GameTimer相同)，其他平台为steady_clock的纳秒
+class ProfilerClock
+{
+public:
+    static int64_t Now();
+    static int64_t Frequency();
+};
+
+//每帧统计的计数器
+enum class ProfileCounter : uint32_t
+{
+    Draws,
+    Instances,
+    Triangles,
+    Barriers,
+    BytesUploaded,
+    Count
+};
+
+//一个已经结束的计时区间，时间为ProfilerClock的计数
+struct ProfileEvent
+{
+    const char* Name = nullptr;     //需要是静态生存期的字符串(如字面量)
+    int64_t Start = 0;
+    int64_t End = 0;
+    uint32_t Thread = 0;            //Profiler中的线程序号
+    uint32_t Depth = 0;             //同一线程上嵌套的层数，0为最外层
+};
+
+struct ProfileFrame
+{
+    uint64_t FrameIndex = 0;
+    int64_t Start = 0;
+    int64_t End = 0;
+    //本帧结束时收集到的区间，按开始时间排序；流水线模式下也包含与本帧重叠执行的下一帧Update中已经结束的区间
+    std::vector<ProfileEvent> Events;
+    uint64_t Counters[(size_t)ProfileCounter::Count] = {};
+    uint64_t DroppedEvents = 0;     //线程缓冲区满时丢弃的区间数
+
+    double GetCpuMs() const;
+};
+
+//同名区间在一帧内的合计，用于在画面或标题栏中显示
+struct ProfileZoneTotal
+{
+    const char* Name = nullptr;
+    double TotalMs = 0.0;
+    uint32_t Calls = 0;
+};
+
+//CPU性能分析器，与平台无关
+//区间记录在每个线程自己的环形缓冲区中(单生产者单消费者，记录时无锁)，EndFrame时由主线程收集
+//计数器同样按线程累加，EndFrame时取出清零；最近若干帧保存在历史中，可以导出为Chrome trace格式(chrome://tracing、Perfetto)
+class Profiler
+{
+public:
+    static Profiler& Get();
+
+    Profiler(const Profiler& rhs) = delete;
+    Profiler& operator=(const Profiler& rhs) = delete;
+
+    //关闭时区间与计数器都不记录，开销只剩一次原子读取
+    void SetEnabled(bool enabled) { mEnabled.store(enabled, std::memory_order_relaxed); }
+    bool IsEnabled() const { return mEnabled.load(std::memory_order_relaxed); }
+
+    //导出时显示的线程名，name需要是静态生存期的字符串
+    void SetThreadName(const char* name);
+
+    //保存最近多少帧，默认300
+    void SetHistorySize(size_t frameCount);
+
+    //只能在同一个线程(主线程)中调用
+    void BeginFrame();
+    void EndFrame();
+
+    void AddCounter(ProfileCounter counter, uint64_t value);
+
+    //登记一条不属于任何线程的时间线(如GPU队列)，返回作为ProfileEvent::Thread使用的序号，name需要是静态生存期的字符串
+    uint32_t RegisterTrack(const char* name);
+    //提交已经换算为ProfilerClock计数的区间(如GPU时间戳)，在下一次EndFrame时并入当前帧
+    void SubmitEvents(const ProfileEvent* events, size_t count);
+
+    //最近一帧(没有时返回false)
+    bool GetLastFrame(ProfileFrame& frame) const;
+    //按合计时间从大到小排列
+    static std::vector<ProfileZoneTotal> SummarizeZones(const ProfileFrame& frame);
+    static const char* GetCounterName(ProfileCounter counter);
+
+    //把历史中的帧导出为Chrome trace的JSON
+    std::string ExportChromeTrace() const;
+    bool WriteChromeTrace(const std::wstring& path) const;
+
+    //由ProfileScope调用
+    uint32_t EnterZone();
+    void LeaveZone(const char* name, int64_t start);
+
+private:
+    struct ThreadBuffer;
+
+    Profiler();
+    ~Profiler();
+
+    ThreadBuffer& GetThreadBuffer();
+
+private:
+    static thread_local ThreadBuffer* tThreadBuffer;
+
+    std::atomic<bool> mEnabled;
+
+    mutable std::mutex mThreadsMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> mThreads;
+
+    //额外时间线的序号从TrackBase开始，与线程序号分开
+    static const uint32_t TrackBase = 0x8000;
+    mutable std::mutex mTracksMutex;
+    std::vector<const char*> mTrackNames;
+    std::vector<ProfileEvent> mSubmitted;
+
+    uint64_t mFrameIndex = 0;
+    int64_t mFrameStart = 0;
+
+    mutable std::mutex mFramesMutex;
+    std::deque<ProfileFrame> mFrames;
+    size_t mHistorySize = 300;
+};
+
+//作用域内的计时区间，可以嵌套
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* name) :
+        mName(name)
+    {
+        if (Profiler::Get().IsEnabled())
+        {
+            Profiler::Get().EnterZone();
+            mStart = ProfilerClock::Now();
+        }
+    }
+    ~ProfileScope()
+    {
+        if (mStart != 0)
+        {
+            Profiler::Get().LeaveZone(mName, mStart);
+        }
+    }
+    ProfileScope(const ProfileScope& rhs) = delete;
+    ProfileScope& operator=(const ProfileScope& rhs) = delete;
+
+private:
+    const char* mName = nullptr;
+    int64_t mStart = 0;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
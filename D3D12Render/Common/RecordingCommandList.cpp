@@ -0,0 +1,126 @@
+#include "RecordingCommandList.h"
+
+#include <cassert>
+#include <chrono>
+
+RecordingCommandList::RecordingCommandList(uint32_t callCostNs) :
+    mCallCostNs(callCostNs)
+{
+}
+
+void RecordingCommandList::Reset()
+{
+    mCommands.clear();
+    mClosed = false;
+}
+
+void RecordingCommandList::Close()
+{
+    assert(!mClosed);
+    mClosed = true;
+}
+
+void RecordingCommandList::SetPipelineState(uint32_t pso)
+{
+    Record(Op::SetPipelineState, pso);
+}
+
+void RecordingCommandList::SetGraphicsRootSignature(uint32_t rootSignature)
+{
+    Record(Op::SetGraphicsRootSignature, rootSignature);
+}
+
+void RecordingCommandList::SetGraphicsRootDescriptorTable(uint32_t rootParameterIndex, uint32_t table)
+{
+    Record(Op::SetGraphicsRootDescriptorTable, rootParameterIndex, table);
+}
+
+void RecordingCommandList::SetDescriptorHeaps(uint32_t numHeaps)
+{
+    Record(Op::SetDescriptorHeaps, numHeaps);
+}
+
+void RecordingCommandList::RSSetViewports(uint32_t numViewports)
+{
+    Record(Op::RSSetViewports, numViewports);
+}
+
+void RecordingCommandList::RSSetScissorRects(uint32_t numRects)
+{
+    Record(Op::RSSetScissorRects, numRects);
+}
+
+void RecordingCommandList::OMSetRenderTargets(uint32_t numRenderTargets, uint32_t depthStencil)
+{
+    Record(Op::OMSetRenderTargets, numRenderTargets, depthStencil);
+}
+
+void RecordingCommandList::IASetVertexBuffers(uint32_t startSlot, uint32_t numViews)
+{
+    Record(Op::IASetVertexBuffers, startSlot, numViews);
+}
+
+void RecordingCommandList::IASetIndexBuffer(uint32_t indexBuffer)
+{
+    Record(Op::IASetIndexBuffer, indexBuffer);
+}
+
+void RecordingCommandList::IASetPrimitiveTopology(uint32_t topology)
+{
+    Record(Op::IASetPrimitiveTopology, topology);
+}
+
+void RecordingCommandList::ClearRenderTargetView(uint32_t renderTarget)
+{
+    Record(Op::ClearRenderTargetView, renderTarget);
+}
+
+void RecordingCommandList::ClearDepthStencilView(uint32_t depthStencil, uint32_t clearFlags)
+{
+    Record(Op::ClearDepthStencilView, depthStencil, clearFlags);
+}
+
+void RecordingCommandList::DrawInstanced(uint32_t vertexCountPerInstance, uint32_t instanceCount,
+    uint32_t startVertexLocation, uint32_t startInstanceLocation)
+{
+    Record(Op::DrawInstanced, vertexCountPerInstance, instanceCount, startVertexLocation, startInstanceLocation);
+}
+
+void RecordingCommandList::DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount,
+    uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation)
+{
+    Record(Op::DrawIndexedInstanced, indexCountPerInstance, instanceCount, startIndexLocation,
+        static_cast<uint32_t>(baseVertexLocation), startInstanceLocation);
+}
+
+void RecordingCommandList::ResourceBarrier(uint32_t numBarriers)
+{
+    Record(Op::ResourceBarrier, numBarriers);
+}
+
+void RecordingCommandList::CopyBufferRegion(uint32_t dest, uint32_t source, uint64_t numBytes)
+{
+    Record(Op::CopyBufferRegion, dest, source, static_cast<uint32_t>(numBytes), static_cast<uint32_t>(numBytes >> 32));
+}
+
+void RecordingCommandList::EndQuery(uint32_t queryHeap, uint32_t type, uint32_t index)
+{
+    Record(Op::EndQuery, queryHeap, type, index);
+}
+
+void RecordingCommandList::Record(Op type, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3, uint32_t a4)
+{
+    assert(!mClosed && "RecordingCommandList: recording into a closed list");
+
+    Command command = { type, { a0, a1, a2, a3, a4 } };
+    mCommands.push_back(command);
+
+    //忙等而不是休眠，和真实驱动一样占用录制线程的CPU时间
+    if (mCallCostNs > 0)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(mCallCostNs);
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+        }
+    }
+}
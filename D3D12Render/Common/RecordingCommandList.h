@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//命令列表的替身，与平台无关：只把调用记录下来，并在每次调用时按设定的时间忙等，
+//模拟驱动在录制阶段的CPU开销(状态校验与命令编码)，用于在没有D3D12的平台上测量并行录制的扩展性
+//资源与状态对象用整数标识
+class RecordingCommandList
+{
+public:
+    enum class Op : uint32_t
+    {
+        SetPipelineState,
+        SetGraphicsRootSignature,
+        SetGraphicsRootDescriptorTable,
+        IASetVertexBuffers,
+        IASetIndexBuffer,
+        IASetPrimitiveTopology,
+        ClearRenderTargetView,
+        DrawInstanced,
+        DrawIndexedInstanced,
+        ResourceBarrier,
+        CopyBufferRegion,
+        SetDescriptorHeaps,
+        RSSetViewports,
+        RSSetScissorRects,
+        OMSetRenderTargets,
+        ClearDepthStencilView,
+        EndQuery,
+    };
+
+    struct Command
+    {
+        Op Type;
+        uint32_t Args[5];
+    };
+
+    //callCostNs为每次调用模拟的开销，为0时只记录
+    explicit RecordingCommandList(uint32_t callCostNs = 0);
+
+    //清空已记录的命令，重新开始录制
+    void Reset();
+    void Close();
+    bool IsClosed() const { return mClosed; }
+
+    void SetPipelineState(uint32_t pso);
+    void SetGraphicsRootSignature(uint32_t rootSignature);
+    void SetGraphicsRootDescriptorTable(uint32_t rootParameterIndex, uint32_t table);
+    void SetDescriptorHeaps(uint32_t numHeaps);
+    void RSSetViewports(uint32_t numViewports);
+    void RSSetScissorRects(uint32_t numRects);
+    //depthStencil为0时不绑定深度/模板缓冲区
+    void OMSetRenderTargets(uint32_t numRenderTargets, uint32_t depthStencil);
+    void IASetVertexBuffers(uint32_t startSlot, uint32_t numViews);
+    void IASetIndexBuffer(uint32_t indexBuffer);
+    void IASetPrimitiveTopology(uint32_t topology);
+    void ClearRenderTargetView(uint32_t renderTarget);
+    void ClearDepthStencilView(uint32_t depthStencil, uint32_t clearFlags);
+    void DrawInstanced(uint32_t vertexCountPerInstance, uint32_t instanceCount,
+        uint32_t startVertexLocation, uint32_t startInstanceLocation);
+    void DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount,
+        uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation);
+    void ResourceBarrier(uint32_t numBarriers);
+    void CopyBufferRegion(uint32_t dest, uint32_t source, uint64_t numBytes);
+    void EndQuery(uint32_t queryHeap, uint32_t type, uint32_t index);
+
+    const std::vector<Command>& GetCommands() const { return mCommands; }
+    uint32_t GetCallCost() const { return mCallCostNs; }
+
+private:
+    void Record(Op type, uint32_t a0 = 0, uint32_t a1 = 0, uint32_t a2 = 0, uint32_t a3 = 0, uint32_t a4 = 0);
+
+private:
+    uint32_t mCallCostNs = 0;
+    bool mClosed = false;
+    std::vector<Command> mCommands;
+};
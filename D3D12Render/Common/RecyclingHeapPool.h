@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+struct RecyclingHeapPoolStats
+{
+    uint64_t Reused = 0;
+    uint64_t Created = 0;
+    uint64_t BytesCreated = 0;
+};
+
+//按容量回收的堆，与平台无关：释放的堆在登记的fence值完成之后才能再次取出
+//申请时在同一类(key，如对齐与堆标志)中选择能容纳的最小空闲堆；需要新建时容量按growth放大，
+//连续小幅增长(如拖动窗口边框时的每次调整)可以落在已有的余量之内，不必每次都重新分配显存
+template<typename Heap>
+class RecyclingHeapPool
+{
+public:
+    //growth为新建堆相对于请求大小的放大倍数；granularity为容量的取整单位；
+    //空闲堆的容量超过请求的maxWaste倍时不复用，避免缩小后长期占用过大的堆
+    explicit RecyclingHeapPool(double growth = 1.25, uint64_t granularity = 64 * 1024, double maxWaste = 4.0) :
+        mGrowth(growth),
+        mGranularity(granularity),
+        mMaxWaste(maxWaste)
+    {
+    }
+
+    //有可用的空闲堆时取出并返回true；否则返回false，capacity为调用者应当新建的容量
+    //新建的容量按granularity与alignment中较大的一个取整，保证是堆对齐(如多重采样的4MB)的整数倍
+    bool Acquire(uint32_t key, uint64_t size, uint64_t alignment, uint64_t completedValue, Heap& heap, uint64_t& capacity)
+    {
+        size_t best = mEntries.size();
+        for (size_t i = 0; i < mEntries.size(); ++i)
+        {
+            const Entry& entry = mEntries[i];
+            if (entry.Key != key || entry.FenceValue > completedValue || entry.Capacity < size ||
+                entry.Capacity > size * mMaxWaste)
+            {
+                continue;
+            }
+            if (best == mEntries.size() || entry.Capacity < mEntries[best].Capacity)
+            {
+                best = i;
+            }
+        }
+
+        if (best != mEntries.size())
+        {
+            heap = std::move(mEntries[best].Item);
+            capacity = mEntries[best].Capacity;
+            mEntries.erase(mEntries.begin() + best);
+            ++mStats.Reused;
+            return true;
+        }
+
+        capacity = RoundUp(static_cast<uint64_t>(size * mGrowth), alignment);
+        ++mStats.Created;
+        mStats.BytesCreated += capacity;
+        return false;
+    }
+
+    //fence到达fenceValue之后heap才能再次取出
+    void Release(uint32_t key, Heap heap, uint64_t capacity, uint64_t fenceValue)
+    {
+        Entry entry;
+        entry.Key = key;
+        entry.Item = std::move(heap);
+        entry.Capacity = capacity;
+        entry.FenceValue = fenceValue;
+        mEntries.push_back(std::move(entry));
+    }
+
+    //丢弃fence已经完成的空闲堆，直到空闲容量不超过maxIdleBytes(先丢弃最大的)
+    void Trim(uint64_t completedValue, uint64_t maxIdleBytes)
+    {
+        uint64_t idle = GetIdleBytes();
+        while (idle > maxIdleBytes)
+        {
+            size_t largest = mEntries.size();
+            for (size_t i = 0; i < mEntries.size(); ++i)
+            {
+                if (mEntries[i].FenceValue <= completedValue &&
+                    (largest == mEntries.size() || mEntries[i].Capacity > mEntries[largest].Capacity))
+                {
+                    largest = i;
+                }
+            }
+            if (largest == mEntries.size())
+            {
+                break;
+            }
+            idle -= mEntries[largest].Capacity;
+            mEntries.erase(mEntries.begin() + largest);
+        }
+    }
+
+    uint64_t GetIdleBytes() const
+    {
+        uint64_t bytes = 0;
+        for (const Entry& entry : mEntries)
+        {
+            bytes += entry.Capacity;
+        }
+        return bytes;
+    }
+    size_t GetIdleCount() const { return mEntries.size(); }
+    const RecyclingHeapPoolStats& GetStats() const { return mStats; }
+
+private:
+    uint64_t RoundUp(uint64_t size, uint64_t alignment) const
+    {
+        const uint64_t unit = alignment > mGranularity ? alignment : mGranularity;
+        return (size + unit - 1) / unit * unit;
+    }
+
+private:
+    struct Entry
+    {
+        uint32_t Key = 0;
+        Heap Item;
+        uint64_t Capacity = 0;
+        uint64_t FenceValue = 0;
+    };
+
+    double mGrowth = 1.25;
+    uint64_t mGranularity = 64 * 1024;
+    double mMaxWaste = 4.0;
+    std::vector<Entry> mEntries;
+    RecyclingHeapPoolStats mStats;
+};
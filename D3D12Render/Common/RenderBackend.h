@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "ResourceStateTracker.h"
+
+//设备、队列、命令列表的一层薄抽象，与平台无关
+//D3D12后端(D3D12Backend)直接转发给对应的D3D12对象，空后端(NullRenderBackend)只记录调用与统计，可以在没有显卡与窗口的环境中运行
+//对象(PSO、根签名、资源)以RenderHandle表示，由后端解释：D3D12后端中就是对应接口的指针
+//GPU虚拟地址、描述符句柄等数值与D3D12中的含义相同，枚举值(图元拓扑、格式、描述符堆类型)也与D3D12一致
+
+typedef uint64_t RenderHandle;
+
+//与D3D12_VERTEX_BUFFER_VIEW的布局一致
+struct RenderVertexBufferView
+{
+    uint64_t BufferLocation = 0;
+    uint32_t SizeInBytes = 0;
+    uint32_t StrideInBytes = 0;
+};
+
+//与D3D12_INDEX_BUFFER_VIEW的布局一致
+struct RenderIndexBufferView
+{
+    uint64_t BufferLocation = 0;
+    uint32_t SizeInBytes = 0;
+    uint32_t Format = 0;
+};
+
+//与D3D12_VIEWPORT的布局一致
+struct RenderViewport
+{
+    float TopLeftX = 0.0f;
+    float TopLeftY = 0.0f;
+    float Width = 0.0f;
+    float Height = 0.0f;
+    float MinDepth = 0.0f;
+    float MaxDepth = 1.0f;
+};
+
+//与D3D12_RECT的布局一致
+struct RenderRect
+{
+    int32_t Left = 0;
+    int32_t Top = 0;
+    int32_t Right = 0;
+    int32_t Bottom = 0;
+};
+
+enum class RenderQueueType : uint32_t
+{
+    Direct = 0,     //与D3D12_COMMAND_LIST_TYPE_DIRECT一致
+    Copy = 3        //与D3D12_COMMAND_LIST_TYPE_COPY一致
+};
+
+class IRenderCommandList
+{
+public:
+    virtual ~IRenderCommandList() = default;
+
+    //开始录制，调用者需要保证这个列表上次提交的命令已经执行完毕(后端会复用其命令内存)
+    virtual void Reset(RenderHandle initialState) = 0;
+    virtual void Close() = 0;
+
+    virtual void SetPipelineState(RenderHandle pso) = 0;
+    virtual void SetGraphicsRootSignature(RenderHandle rootSignature) = 0;
+    virtual void SetGraphicsRootDescriptorTable(uint32_t rootParameterIndex, uint64_t gpuDescriptor) = 0;
+    virtual void SetDescriptorHeaps(uint32_t numHeaps, const RenderHandle* heaps) = 0;
+    virtual void RSSetViewports(uint32_t numViewports, const RenderViewport* viewports) = 0;
+    virtual void RSSetScissorRects(uint32_t numRects, const RenderRect* rects) = 0;
+    //dsvCpuDescriptor为nullptr时不绑定深度/模板缓冲区
+    virtual void OMSetRenderTargets(uint32_t numRenderTargets, const uint64_t* rtvCpuDescriptors,
+        const uint64_t* dsvCpuDescriptor) = 0;
+    virtual void IASetVertexBuffers(uint32_t startSlot, uint32_t numViews, const RenderVertexBufferView* views) = 0;
+    virtual void IASetIndexBuffer(const RenderIndexBufferView* view) = 0;
+    virtual void IASetPrimitiveTopology(uint32_t topology) = 0;
+    virtual void ClearRenderTargetView(uint64_t cpuDescriptor, const float color[4]) = 0;
+    //clearFlags与D3D12_CLEAR_FLAGS一致
+    virtual void ClearDepthStencilView(uint64_t cpuDescriptor, uint32_t clearFlags, float depth, uint8_t stencil) = 0;
+    virtual void DrawInstanced(uint32_t vertexCountPerInstance, uint32_t instanceCount,
+        uint32_t startVertexLocation, uint32_t startInstanceLocation) = 0;
+    virtual void DrawIndexedInstanced(uint32_t indexCountPerInstance, uint32_t instanceCount,
+        uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation) = 0;
+    virtual void CopyBufferRegion(RenderHandle dest, uint64_t destOffset, RenderHandle source, uint64_t sourceOffset,
+        uint64_t numBytes) = 0;
+    //type与D3D12_QUERY_TYPE一致
+    virtual void EndQuery(RenderHandle queryHeap, uint32_t type, uint32_t index) = 0;
+
+    //签名与ResourceStateTracker::Flush要求的一致，可以直接作为它的目标
+    virtual void ResourceBarrier(uint32_t count, const ResourceTransition* transitions) = 0;
+};
+
+class IRenderFence
+{
+public:
+    virtual ~IRenderFence() = default;
+
+    virtual uint64_t GetCompletedValue() const = 0;
+    //CPU端阻塞直到完成值不小于value
+    virtual void WaitForValue(uint64_t value) = 0;
+};
+
+class IRenderQueue
+{
+public:
+    virtual ~IRenderQueue() = default;
+
+    virtual void ExecuteCommandLists(uint32_t count, IRenderCommandList* const* lists) = 0;
+    //之前提交的命令执行完后把fence设为value
+    virtual void Signal(IRenderFence& fence, uint64_t value) = 0;
+    //GPU端等待fence到达value之后再执行之后提交的命令
+    virtual void Wait(IRenderFence& fence, uint64_t value) = 0;
+};
+
+class IRenderDevice
+{
+public:
+    virtual ~IRenderDevice() = default;
+
+    virtual std::unique_ptr<IRenderQueue> CreateQueue(RenderQueueType type) = 0;
+    virtual std::unique_ptr<IRenderCommandList> CreateCommandList(RenderQueueType type) = 0;
+    virtual std::unique_ptr<IRenderFence> CreateFence(uint64_t initialValue) = 0;
+
+    //把count个描述符从source拷贝到dest(CPU句柄)，heapType与D3D12_DESCRIPTOR_HEAP_TYPE一致
+    virtual void CopyDescriptorsSimple(uint32_t count, uint64_t destCpuDescriptor, uint64_t sourceCpuDescriptor,
+        uint32_t heapType) = 0;
+
+    //向上传堆中的缓冲区写入数据
+    virtual void WriteUploadBuffer(RenderHandle buffer, uint64_t offset, const void* data, size_t size) = 0;
+};
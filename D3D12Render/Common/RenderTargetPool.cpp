@@ -0,0 +1,59 @@
+#include "RenderTargetPool.h"
+
+using Microsoft::WRL::ComPtr;
+
+RenderTargetPool::RenderTargetPool(ID3D12Device* device) :
+    mDevice(device)
+{
+}
+
+PooledRenderTarget RenderTargetPool::Create(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState,
+    const D3D12_CLEAR_VALUE* clearValue, UINT64 completedValue)
+{
+    assert(desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL));
+
+    //多重采样资源需要4MB对齐的堆，按对齐分类
+    D3D12_RESOURCE_ALLOCATION_INFO info = mDevice->GetResourceAllocationInfo(0, 1, &desc);
+    PooledRenderTarget target;
+    target.Key = static_cast<UINT>(info.Alignment);
+
+    HeapItem item;
+    if (!mPool.Acquire(target.Key, info.SizeInBytes, info.Alignment, completedValue, item, target.Capacity))
+    {
+        D3D12_HEAP_DESC heapDesc = {};
+        heapDesc.SizeInBytes = target.Capacity;
+        heapDesc.Properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+        heapDesc.Alignment = info.Alignment;
+        //资源堆第一层级的硬件上渲染目标与深度缓冲区只能放在专用的堆中
+        heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+        ThrowIfFailed(mDevice->CreateHeap(&heapDesc, IID_PPV_ARGS(&item.Heap)));
+    }
+    target.Heap = item.Heap;
+
+    ThrowIfFailed(mDevice->CreatePlacedResource(
+        target.Heap.Get(),
+        0,
+        &desc,
+        initialState,
+        clearValue,
+        IID_PPV_ARGS(&target.Resource)));
+    return target;
+}
+
+void RenderTargetPool::Release(PooledRenderTarget& target, UINT64 fenceValue)
+{
+    if (target.Heap == nullptr)
+    {
+        return;
+    }
+    HeapItem item;
+    item.Heap = target.Heap;
+    item.LastResource = target.Resource;
+    mPool.Release(target.Key, item, target.Capacity, fenceValue);
+    target = PooledRenderTarget();
+}
+
+void RenderTargetPool::Trim(UINT64 completedValue, UINT64 maxIdleBytes)
+{
+    mPool.Trim(completedValue, maxIdleBytes);
+}
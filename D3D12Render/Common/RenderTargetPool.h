@@ -0,0 +1,46 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "RecyclingHeapPool.h"
+
+//从RenderTargetPool取得的渲染目标/深度缓冲区：放在池中的堆上的placed resource
+struct PooledRenderTarget
+{
+    Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+    Microsoft::WRL::ComPtr<ID3D12Heap> Heap;
+    UINT64 Capacity = 0;
+    UINT Key = 0;
+};
+
+//渲染目标与深度缓冲区的堆池，代替每次OnResize都用CreateCommittedResource重新分配：
+//旧资源释放后其堆在fence完成时回到池中，新的尺寸能放进已有的堆时只创建placed resource，不分配显存
+class RenderTargetPool
+{
+public:
+    explicit RenderTargetPool(ID3D12Device* device);
+    RenderTargetPool(const RenderTargetPool& rhs) = delete;
+    RenderTargetPool& operator=(const RenderTargetPool& rhs) = delete;
+
+    //desc需要带ALLOW_RENDER_TARGET或ALLOW_DEPTH_STENCIL标志；completedValue为fence已经完成的值
+    PooledRenderTarget Create(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState,
+        const D3D12_CLEAR_VALUE* clearValue, UINT64 completedValue);
+
+    //资源与堆保留到fence到达fenceValue(GPU不再使用)，之后堆可以被再次使用；target被清空
+    void Release(PooledRenderTarget& target, UINT64 fenceValue);
+
+    //释放空闲的堆，直到空闲容量不超过maxIdleBytes
+    void Trim(UINT64 completedValue, UINT64 maxIdleBytes);
+
+    const RecyclingHeapPoolStats& GetStats() const { return mPool.GetStats(); }
+
+private:
+    //等待回收的堆，同时持有最后一个放在其上的资源，GPU用完之前不能释放
+    struct HeapItem
+    {
+        Microsoft::WRL::ComPtr<ID3D12Heap> Heap;
+        Microsoft::WRL::ComPtr<ID3D12Resource> LastResource;
+    };
+
+    ID3D12Device* mDevice = nullptr;
+    RecyclingHeapPool<HeapItem> mPool;
+};
@@ -0,0 +1,203 @@
+#include "ResourceStateTracker.h"
+
+void ResourceStateTracker::Register(const void* resource, uint32_t subresourceCount, uint32_t state)
+{
+    assert(resource != nullptr && subresourceCount > 0);
+
+    TrackedResource tracked;
+    tracked.SubresourceCount = subresourceCount;
+    tracked.State = state;
+    mResources[resource] = tracked;
+}
+
+void ResourceStateTracker::Unregister(const void* resource)
+{
+    mResources.erase(resource);
+
+    //已经没有意义的转换也一并去掉，避免提交时引用已释放的资源
+    for (size_t i = 0; i < mPending.size();)
+    {
+        if (mPending[i].Resource == resource)
+        {
+            mPending.erase(mPending.begin() + i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+ResourceStateTracker::TrackedResource& ResourceStateTracker::GetResource(const void* resource)
+{
+    auto it = mResources.find(resource);
+    assert(it != mResources.end());
+    return it->second;
+}
+
+uint32_t ResourceStateTracker::GetState(const void* resource, uint32_t subresource) const
+{
+    auto it = mResources.find(resource);
+    assert(it != mResources.end());
+
+    const TrackedResource& tracked = it->second;
+    if (tracked.SubresourceStates.empty())
+    {
+        return tracked.State;
+    }
+    assert(subresource < tracked.SubresourceCount);
+    return tracked.SubresourceStates[subresource];
+}
+
+void ResourceStateTracker::Transition(const void* resource, uint32_t state, uint32_t subresource)
+{
+    TrackedResource& tracked = GetResource(resource);
+    assert(!tracked.SplitPending);
+    ++mStats.Requested;
+
+    if (subresource == AllSubresources)
+    {
+        if (tracked.SubresourceStates.empty())
+        {
+            if (tracked.State == state)
+            {
+                ++mStats.Skipped;
+                return;
+            }
+            AddTransition(resource, AllSubresources, tracked.State, state);
+        }
+        else
+        {
+            //各子资源状态不同时逐个转换，之后恢复为统一的状态
+            for (uint32_t i = 0; i < tracked.SubresourceCount; ++i)
+            {
+                if (tracked.SubresourceStates[i] != state)
+                {
+                    AddTransition(resource, i, tracked.SubresourceStates[i], state);
+                }
+            }
+            tracked.SubresourceStates.clear();
+        }
+        tracked.State = state;
+        return;
+    }
+
+    if (GetState(resource, subresource) == state)
+    {
+        ++mStats.Skipped;
+        return;
+    }
+    AddTransition(resource, subresource, GetState(resource, subresource), state);
+    SetSubresourceState(tracked, subresource, state);
+}
+
+void ResourceStateTracker::SetSubresourceState(TrackedResource& tracked, uint32_t subresource, uint32_t state)
+{
+    assert(subresource < tracked.SubresourceCount);
+
+    if (tracked.SubresourceCount == 1)
+    {
+        tracked.State = state;
+        return;
+    }
+
+    if (tracked.SubresourceStates.empty())
+    {
+        tracked.SubresourceStates.assign(tracked.SubresourceCount, tracked.State);
+    }
+    tracked.SubresourceStates[subresource] = state;
+
+    //所有子资源又回到同一状态时合并，之后整体转换只需一个屏障
+    for (uint32_t i = 1; i < tracked.SubresourceCount; ++i)
+    {
+        if (tracked.SubresourceStates[i] != tracked.SubresourceStates[0])
+        {
+            return;
+        }
+    }
+    tracked.State = tracked.SubresourceStates[0];
+    tracked.SubresourceStates.clear();
+}
+
+void ResourceStateTracker::AddTransition(const void* resource, uint32_t subresource, uint32_t before, uint32_t after)
+{
+    //只看同一资源在批次中的最后一个转换，子资源完全相同才合并，保证转换的先后顺序不变
+    for (size_t i = mPending.size(); i-- > 0;)
+    {
+        ResourceTransition& last = mPending[i];
+        if (last.Resource != resource)
+        {
+            continue;
+        }
+        if (last.Subresource == subresource && last.Split == ResourceBarrierSplit::None)
+        {
+            assert(last.StateAfter == before);
+            ++mStats.Merged;
+            if (last.StateBefore == after)
+            {
+                mPending.erase(mPending.begin() + i);
+            }
+            else
+            {
+                last.StateAfter = after;
+            }
+            return;
+        }
+        break;
+    }
+
+    ResourceTransition transition;
+    transition.Resource = resource;
+    transition.Subresource = subresource;
+    transition.StateBefore = before;
+    transition.StateAfter = after;
+    mPending.push_back(transition);
+}
+
+void ResourceStateTracker::BeginTransition(const void* resource, uint32_t state, uint32_t subresource)
+{
+    TrackedResource& tracked = GetResource(resource);
+    assert(!tracked.SplitPending);
+    ++mStats.Requested;
+
+    //整体的拆分转换要求所有子资源状态相同
+    assert(subresource != AllSubresources || tracked.SubresourceStates.empty());
+    const uint32_t before = GetState(resource, subresource == AllSubresources ? 0 : subresource);
+    if (before == state)
+    {
+        ++mStats.Skipped;
+        return;
+    }
+
+    tracked.SplitPending = true;
+    tracked.Split.Resource = resource;
+    tracked.Split.Subresource = subresource;
+    tracked.Split.StateBefore = before;
+    tracked.Split.StateAfter = state;
+    tracked.Split.Split = ResourceBarrierSplit::BeginOnly;
+    mPending.push_back(tracked.Split);
+}
+
+void ResourceStateTracker::EndTransition(const void* resource)
+{
+    TrackedResource& tracked = GetResource(resource);
+    if (!tracked.SplitPending)
+    {
+        //BeginTransition时状态已经相同
+        return;
+    }
+
+    ResourceTransition transition = tracked.Split;
+    transition.Split = ResourceBarrierSplit::EndOnly;
+    mPending.push_back(transition);
+    tracked.SplitPending = false;
+
+    if (transition.Subresource == AllSubresources)
+    {
+        tracked.State = transition.StateAfter;
+    }
+    else
+    {
+        SetSubresourceState(tracked, transition.Subresource, transition.StateAfter);
+    }
+}
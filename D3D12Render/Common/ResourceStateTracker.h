@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+//与D3D12_RESOURCE_BARRIER_FLAGS的取值一致
+enum class ResourceBarrierSplit : uint32_t
+{
+    None = 0,
+    BeginOnly = 1,
+    EndOnly = 2
+};
+
+//一次状态转换，状态的取值与D3D12_RESOURCE_STATES一致
+struct ResourceTransition
+{
+    const void* Resource = nullptr;
+    uint32_t Subresource = 0;
+    uint32_t StateBefore = 0;
+    uint32_t StateAfter = 0;
+    ResourceBarrierSplit Split = ResourceBarrierSplit::None;
+};
+
+struct ResourceStateStats
+{
+    //调用Transition/BeginTransition的次数
+    uint64_t Requested = 0;
+    //状态已经相同而省略的转换
+    uint64_t Skipped = 0;
+    //与同一批次中同一子资源的转换合并(A->B->C合并为A->C，A->B->A直接消去)
+    uint64_t Merged = 0;
+    //实际提交的转换与ResourceBarrier调用次数
+    uint64_t Emitted = 0;
+    uint64_t BarrierCalls = 0;
+};
+
+//记录每个资源(及子资源)的当前状态，只在状态改变时产生转换，
+//两次Flush之间的转换先缓存起来，在Flush时用一次ResourceBarrier提交
+//约定：使用某个资源的命令必须在其转换Flush之后录制，因此同一批次中同一子资源的连续转换可以合并
+//资源以指针标识，不依赖D3D12，Flush通过模板参数的ResourceBarrier(count, transitions)提交，
+//D3D12中使用D3DBarrierRecorder，也可以换成只记录调用的替身
+class ResourceStateTracker
+{
+public:
+    //与D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES一致
+    static const uint32_t AllSubresources = 0xffffffff;
+
+    //开始跟踪资源，所有子资源的初始状态为state。资源释放前必须Unregister，否则新资源可能复用同一地址
+    void Register(const void* resource, uint32_t subresourceCount, uint32_t state);
+    void Unregister(const void* resource);
+    bool IsRegistered(const void* resource) const { return mResources.count(resource) != 0; }
+
+    //把资源(或其中一个子资源)转换到state，状态相同时不产生转换
+    void Transition(const void* resource, uint32_t state, uint32_t subresource = AllSubresources);
+
+    //拆分屏障：BeginTransition在当前批次中开始转换，中间可以录制与该资源无关的命令，
+    //之后的某个批次中EndTransition完成转换。同一资源同时只能有一个未完成的拆分转换
+    void BeginTransition(const void* resource, uint32_t state, uint32_t subresource = AllSubresources);
+    void EndTransition(const void* resource);
+
+    uint32_t GetState(const void* resource, uint32_t subresource = 0) const;
+
+    size_t GetPendingCount() const { return mPending.size(); }
+    const ResourceStateStats& GetStats() const { return mStats; }
+
+    //把缓存的转换用一次cmdList.ResourceBarrier(count, transitions)提交，没有转换时不调用
+    template<typename CommandList>
+    void Flush(CommandList& cmdList)
+    {
+        if (mPending.empty())
+        {
+            return;
+        }
+        cmdList.ResourceBarrier((uint32_t)mPending.size(), mPending.data());
+        mStats.Emitted += mPending.size();
+        ++mStats.BarrierCalls;
+        mPending.clear();
+    }
+
+private:
+    struct TrackedResource
+    {
+        uint32_t SubresourceCount = 1;
+
+        //SubresourceStates为空时所有子资源的状态都为State
+        uint32_t State = 0;
+        std::vector<uint32_t> SubresourceStates;
+
+        //未完成的拆分转换
+        bool SplitPending = false;
+        ResourceTransition Split;
+    };
+
+    TrackedResource& GetResource(const void* resource);
+
+    void SetSubresourceState(TrackedResource& tracked, uint32_t subresource, uint32_t state);
+
+    //加入当前批次，能与同一子资源的前一个转换合并时直接修改它
+    void AddTransition(const void* resource, uint32_t subresource, uint32_t before, uint32_t after);
+
+    std::unordered_map<const void*, TrackedResource> mResources;
+    std::vector<ResourceTransition> mPending;
+    ResourceStateStats mStats;
+};
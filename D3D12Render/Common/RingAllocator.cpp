@@ -0,0 +1,86 @@
+#include "RingAllocator.h"
+
+#include <cassert>
+
+RingAllocator::RingAllocator(uint32_t capacity) :
+    mCapacity(capacity)
+{
+    assert(capacity > 0);
+}
+
+uint32_t RingAllocator::Allocate(uint32_t count)
+{
+    if (count == 0 || count > mCapacity)
+    {
+        return InvalidOffset;
+    }
+
+    //环为空时从头开始，尽量保留最大的连续空间
+    if (mUsed == 0)
+    {
+        mHead = 0;
+        mTail = 0;
+    }
+
+    uint32_t offset = InvalidOffset;
+    if (mUsed == 0 || mHead > mTail)
+    {
+        //已用部分为[tail, head)，空闲部分为[head, capacity)与[0, tail)
+        if (mCapacity - mHead >= count)
+        {
+            offset = mHead;
+        }
+        else if (mTail >= count)
+        {
+            //跳过尾部，跳过的空间计入当前帧
+            const uint32_t skipped = mCapacity - mHead;
+            mUsed += skipped;
+            mCurrentFrameSize += skipped;
+            offset = 0;
+        }
+    }
+    else if (mTail - mHead >= count)
+    {
+        //已经绕回，空闲部分为[head, tail)
+        offset = mHead;
+    }
+
+    if (offset == InvalidOffset)
+    {
+        return InvalidOffset;
+    }
+
+    mHead = offset + count;
+    if (mHead == mCapacity)
+    {
+        mHead = 0;
+    }
+    mUsed += count;
+    mCurrentFrameSize += count;
+    return offset;
+}
+
+void RingAllocator::FinishFrame(uint64_t fenceValue)
+{
+    if (mCurrentFrameSize == 0)
+    {
+        return;
+    }
+
+    Frame frame;
+    frame.FenceValue = fenceValue;
+    frame.End = mHead;
+    frame.Size = mCurrentFrameSize;
+    mFrames.push_back(frame);
+    mCurrentFrameSize = 0;
+}
+
+void RingAllocator::Reclaim(uint64_t completedFenceValue)
+{
+    while (!mFrames.empty() && mFrames.front().FenceValue <= completedFenceValue)
+    {
+        mTail = mFrames.front().End;
+        mUsed -= mFrames.front().Size;
+        mFrames.pop_front();
+    }
+}
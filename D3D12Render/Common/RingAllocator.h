@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+//按帧回收的线性环形分配器，只管理[0, capacity)范围内的偏移，不持有实际内存
+//每帧的分配在环中线性向前推进，帧结束时记下该帧提交后Signal的fence值，GPU完成后整帧一起回收，
+//分配与回收都是O(1)。分配总是连续的：尾部放不下时跳过尾部从0开始，跳过的部分随该帧一起回收
+//用于每帧临时的描述符表、常量等
+class RingAllocator
+{
+public:
+    static const uint32_t InvalidOffset = 0xffffffff;
+
+    explicit RingAllocator(uint32_t capacity);
+
+    //返回连续count个元素的起始偏移，空间不足(GPU仍在使用)时返回InvalidOffset
+    uint32_t Allocate(uint32_t count);
+
+    //当前帧的分配全部完成，它们在fence到达fenceValue之后可以回收
+    void FinishFrame(uint64_t fenceValue);
+
+    //回收fence值不大于completedFenceValue的帧
+    void Reclaim(uint64_t completedFenceValue);
+
+    uint32_t GetCapacity() const { return mCapacity; }
+
+    //包括尚未回收的帧以及当前帧的分配(含跳过的尾部)
+    uint32_t GetUsedSize() const { return mUsed; }
+
+private:
+    struct Frame
+    {
+        uint64_t FenceValue = 0;
+        uint32_t End = 0;
+        uint32_t Size = 0;
+    };
+
+    uint32_t mCapacity = 0;
+    uint32_t mHead = 0;
+    uint32_t mTail = 0;
+    uint32_t mUsed = 0;
+    uint32_t mCurrentFrameSize = 0;
+    std::deque<Frame> mFrames;
+};
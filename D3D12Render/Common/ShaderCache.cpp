@@ -0,0 +1,534 @@
+#include "ShaderCache.h"
+#include "FileUtil.h"
+#include "Hash.h"
+#include "MappedFile.h"
+
+#include <cstring>
+#include <set>
+#include <thread>
+
+namespace
+{
+    //缓存文件格式或键的计算方式改变时递增，旧的缓存文件自动失效
+    const uint32_t ShaderCacheVersion = 1;
+    const uint32_t ShaderCacheMagic = 0x43444853; //"SHDC"
+
+    //磁盘缓存文件头，之后紧跟字节码
+    struct ShaderCacheFileHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint64_t Key;
+        uint64_t ByteCodeSize;
+    };
+
+    //#include最多展开的层数，防止异常的源文件导致过深的递归
+    const int MaxIncludeDepth = 32;
+
+    std::wstring ToHexString(uint64_t value)
+    {
+        const wchar_t* digits = L"0123456789abcdef";
+        std::wstring out(16, L'0');
+        for (int i = 15; i >= 0; --i, value >>= 4)
+        {
+            out[i] = digits[value & 0xf];
+        }
+        return out;
+    }
+
+    uint64_t HashString(const std::string& str, uint64_t seed)
+    {
+        //先混入长度，避免"ab"+"c"与"a"+"bc"得到相同的键
+        return Hash::Hash64(str.data(), str.size(), Hash::Combine(seed, str.size()));
+    }
+
+    //除源文件内容以外影响编译结果的选项
+    uint64_t HashOptions(const ShaderCompileDesc& desc, uint64_t seed)
+    {
+        uint64_t key = Hash::Combine(seed, desc.Flags);
+        key = HashString(desc.EntryPoint, key);
+        key = HashString(desc.Target, key);
+
+        key = Hash::Combine(key, desc.Defines.size());
+        for (const ShaderDefine& define : desc.Defines)
+        {
+            key = HashString(define.Name, key);
+            key = HashString(define.Definition, key);
+        }
+        return key;
+    }
+
+    std::wstring GetDirectory(const std::wstring& path)
+    {
+        size_t pos = path.find_last_of(L"/\\");
+        return pos == std::wstring::npos ? std::wstring() : path.substr(0, pos + 1);
+    }
+
+    //#include中的文件名按UTF-8处理
+    std::wstring FromUtf8(const std::string& str)
+    {
+        std::wstring out;
+        out.reserve(str.size());
+        for (size_t i = 0; i < str.size();)
+        {
+            uint8_t c = static_cast<uint8_t>(str[i]);
+            uint32_t code = c;
+            size_t extra = 0;
+            if (c >= 0xF0) { code = c & 0x07; extra = 3; }
+            else if (c >= 0xE0) { code = c & 0x0F; extra = 2; }
+            else if (c >= 0xC0) { code = c & 0x1F; extra = 1; }
+            ++i;
+            for (; extra > 0 && i < str.size(); --extra, ++i)
+            {
+                code = (code << 6) | (static_cast<uint8_t>(str[i]) & 0x3F);
+            }
+
+            if (sizeof(wchar_t) == 2 && code >= 0x10000)
+            {
+                code -= 0x10000;
+                out.push_back(static_cast<wchar_t>(0xD800 + (code >> 10)));
+                out.push_back(static_cast<wchar_t>(0xDC00 + (code & 0x3FF)));
+            }
+            else
+            {
+                out.push_back(static_cast<wchar_t>(code));
+            }
+        }
+        return out;
+    }
+
+    //找出源文件中所有#include的文件名
+    //不处理条件编译，#if 0中的#include也会被计入键，只会让缓存更保守
+    void FindIncludes(const std::vector<uint8_t>& source, std::vector<std::string>& includes)
+    {
+        const char* text = reinterpret_cast<const char*>(source.data());
+        const size_t size = source.size();
+        bool inBlockComment = false;
+
+        size_t lineBegin = 0;
+        while (lineBegin < size)
+        {
+            size_t lineEnd = lineBegin;
+            while (lineEnd < size && text[lineEnd] != '\n')
+            {
+                ++lineEnd;
+            }
+
+            size_t i = lineBegin;
+            if (inBlockComment)
+            {
+                while (i + 1 < lineEnd && !(text[i] == '*' && text[i + 1] == '/'))
+                {
+                    ++i;
+                }
+                if (i + 1 < lineEnd)
+                {
+                    inBlockComment = false;
+                    i += 2;
+                }
+                else
+                {
+                    i = lineEnd;
+                }
+            }
+
+            while (i < lineEnd && (text[i] == ' ' || text[i] == '\t'))
+            {
+                ++i;
+            }
+
+            if (i < lineEnd && text[i] == '#')
+            {
+                ++i;
+                while (i < lineEnd && (text[i] == ' ' || text[i] == '\t'))
+                {
+                    ++i;
+                }
+                if (lineEnd - i > 7 && strncmp(text + i, "include", 7) == 0)
+                {
+                    i += 7;
+                    while (i < lineEnd && (text[i] == ' ' || text[i] == '\t'))
+                    {
+                        ++i;
+                    }
+                    if (i < lineEnd && (text[i] == '"' || text[i] == '<'))
+                    {
+                        const char close = text[i] == '"' ? '"' : '>';
+                        size_t nameEnd = i + 1;
+                        while (nameEnd < lineEnd && text[nameEnd] != close)
+                        {
+                            ++nameEnd;
+                        }
+                        if (nameEnd < lineEnd)
+                        {
+                            includes.emplace_back(text + i + 1, nameEnd - i - 1);
+                        }
+                    }
+                }
+            }
+
+            //记录该行结束时是否处于块注释中(忽略字符串中的"/*")
+            for (; i < lineEnd; ++i)
+            {
+                if (!inBlockComment && text[i] == '/' && i + 1 < lineEnd && text[i + 1] == '/')
+                {
+                    break;
+                }
+                if (!inBlockComment && text[i] == '/' && i + 1 < lineEnd && text[i + 1] == '*')
+                {
+                    inBlockComment = true;
+                    ++i;
+                }
+                else if (inBlockComment && text[i] == '*' && i + 1 < lineEnd && text[i + 1] == '/')
+                {
+                    inBlockComment = false;
+                    ++i;
+                }
+            }
+
+            lineBegin = lineEnd + 1;
+        }
+    }
+
+    //把包含的文件递归地混入键中，查找顺序与D3D_COMPILE_STANDARD_FILE_INCLUDE一致：
+    //先在包含者所在的目录查找，再在根源文件所在的目录查找
+    uint64_t HashIncludes(
+        const std::vector<uint8_t>& source,
+        const std::wstring& fileDir,
+        const std::wstring& rootDir,
+        std::set<std::wstring>& visited,
+        int depth,
+        uint64_t key)
+    {
+        if (depth >= MaxIncludeDepth)
+        {
+            return key;
+        }
+
+        std::vector<std::string> includes;
+        FindIncludes(source, includes);
+
+        for (const std::string& name : includes)
+        {
+            key = HashString(name, key);
+
+            const std::wstring wideName = FromUtf8(name);
+            std::wstring path = fileDir + wideName;
+            std::vector<uint8_t> content;
+            bool found = FileUtil::ReadAllBytes(path, content);
+            if (!found && fileDir != rootDir)
+            {
+                path = rootDir + wideName;
+                found = FileUtil::ReadAllBytes(path, content);
+            }
+
+            //找不到的文件只计入名字，由编译器报告错误
+            if (!found)
+            {
+                key = Hash::Combine(key, 0);
+                continue;
+            }
+
+            //带包含保护的头文件只需计入一次
+            if (!visited.insert(path).second)
+            {
+                continue;
+            }
+
+            key = Hash::Hash64(content.data(), content.size(), Hash::Combine(key, content.size()));
+            key = HashIncludes(content, GetDirectory(path), rootDir, visited, depth + 1, key);
+        }
+        return key;
+    }
+}
+
+ShaderCache::ShaderCache(IShaderCompiler* compiler, const std::wstring& cacheDir) :
+    mCompiler(compiler),
+    mCacheDir(cacheDir)
+{
+}
+
+ShaderCache::~ShaderCache()
+{
+    //任务引用了this；任务系统析构前会执行完已提交的任务，所以无论两者谁先析构，这里都能等到计数归零
+    while (!mBatchJobs.IsDone())
+    {
+        std::this_thread::yield();
+    }
+}
+
+bool ShaderCache::ComputeKey(const ShaderCompileDesc& desc, std::vector<uint8_t>& source, uint64_t& key)
+{
+    if (!FileUtil::ReadAllBytes(desc.Path, source))
+    {
+        return false;
+    }
+
+    key = HashOptions(desc, ShaderCacheVersion);
+    key = Hash::Hash64(source.data(), source.size(), Hash::Combine(key, source.size()));
+
+    const std::wstring rootDir = GetDirectory(desc.Path);
+    std::set<std::wstring> visited;
+    visited.insert(desc.Path);
+    key = HashIncludes(source, rootDir, rootDir, visited, 0, key);
+    return true;
+}
+
+ShaderByteCode ShaderCache::Compile(const ShaderCompileDesc& desc, std::string* errors)
+{
+    ShaderCompileResult result = CompileOne(desc);
+    if (errors != nullptr)
+    {
+        *errors = std::move(result.Errors);
+    }
+    return result.ByteCode;
+}
+
+std::vector<std::shared_future<ShaderCompileResult>> ShaderCache::CompileBatch(
+    const std::vector<ShaderCompileDesc>& permutations,
+    JobSystem& jobs)
+{
+    std::vector<std::shared_future<ShaderCompileResult>> futures;
+    futures.reserve(permutations.size());
+
+    //描述完全相同的排列只提交一次，共享同一个future
+    std::unordered_map<uint64_t, size_t> submitted;
+    for (size_t i = 0; i < permutations.size(); ++i)
+    {
+        const ShaderCompileDesc& desc = permutations[i];
+        const std::string path = FileUtil::ToUtf8(desc.Path);
+        const uint64_t descKey = HashOptions(desc, Hash::Hash64(path.data(), path.size()));
+
+        auto it = submitted.find(descKey);
+        if (it != submitted.end())
+        {
+            futures.push_back(futures[it->second]);
+            std::lock_guard<std::mutex> lock(mMutex);
+            ++mStats.Deduplicated;
+            continue;
+        }
+        submitted.emplace(descKey, i);
+
+        //缓存键在提交时算出，命中或与正在编译的键合并都在这里完成，任务中不再等待其他任务的future
+        auto source = std::make_shared<std::vector<uint8_t>>();
+        uint64_t key = 0;
+        if (!ComputeKey(desc, *source, key))
+        {
+            futures.push_back(MakeReadyResult(ReadFailure(desc)));
+            continue;
+        }
+
+        auto promise = std::make_shared<std::promise<ShaderCompileResult>>();
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            auto entry = mEntries.find(key);
+            if (entry != mEntries.end())
+            {
+                ++mStats.MemoryHits;
+                ShaderCompileResult result;
+                result.ByteCode = entry->second;
+                futures.push_back(MakeReadyResult(std::move(result)));
+                continue;
+            }
+
+            auto pending = mPending.find(key);
+            if (pending != mPending.end())
+            {
+                ++mStats.Deduplicated;
+                futures.push_back(pending->second);
+                continue;
+            }
+
+            futures.push_back(promise->get_future().share());
+            mPending.emplace(key, futures.back());
+        }
+
+        jobs.Run(mBatchJobs, [this, desc, source, key, promise]()
+        {
+            try
+            {
+                CompileMiss(desc, *source, key, *promise);
+            }
+            catch (...)
+            {
+                //异常已经交给了promise，由等待future的一方处理
+            }
+        });
+    }
+    return futures;
+}
+
+ShaderCompileResult ShaderCache::CompileOne(const ShaderCompileDesc& desc)
+{
+    std::vector<uint8_t> source;
+    uint64_t key = 0;
+    if (!ComputeKey(desc, source, key))
+    {
+        return ReadFailure(desc);
+    }
+
+    //同一个键只允许一个线程编译，其余线程等待它的结果
+    //这里会阻塞在其他线程的future上，因此Compile只应在非工作线程中调用，任务中使用CompileBatch
+    std::promise<ShaderCompileResult> promise;
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        auto it = mEntries.find(key);
+        if (it != mEntries.end())
+        {
+            ++mStats.MemoryHits;
+            ShaderCompileResult result;
+            result.ByteCode = it->second;
+            return result;
+        }
+
+        auto pending = mPending.find(key);
+        if (pending != mPending.end())
+        {
+            ++mStats.Deduplicated;
+            std::shared_future<ShaderCompileResult> future = pending->second;
+            lock.unlock();
+            return future.get();
+        }
+
+        mPending.emplace(key, promise.get_future().share());
+    }
+
+    return CompileMiss(desc, source, key, promise);
+}
+
+ShaderCompileResult ShaderCache::CompileMiss(
+    const ShaderCompileDesc& desc,
+    const std::vector<uint8_t>& source,
+    uint64_t key,
+    std::promise<ShaderCompileResult>& promise)
+{
+    ShaderCompileResult result;
+    bool fromDisk = false;
+    try
+    {
+        result.ByteCode = LoadFromDisk(key);
+        fromDisk = result.ByteCode != nullptr;
+        if (!fromDisk && mCompiler != nullptr)
+        {
+            std::vector<uint8_t> compiled;
+            if (mCompiler->Compile(desc, source, compiled, result.Errors))
+            {
+                SaveToDisk(key, compiled);
+                result.ByteCode = std::make_shared<const std::vector<uint8_t>>(std::move(compiled));
+            }
+        }
+    }
+    catch (...)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mPending.erase(key);
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (fromDisk)
+        {
+            ++mStats.DiskHits;
+        }
+        else
+        {
+            ++mStats.Misses;
+        }
+        if (result.ByteCode != nullptr)
+        {
+            mEntries[key] = result.ByteCode;
+        }
+        else
+        {
+            ++mStats.CompileFailures;
+        }
+        mPending.erase(key);
+    }
+
+    promise.set_value(result);
+    return result;
+}
+
+ShaderCompileResult ShaderCache::ReadFailure(const ShaderCompileDesc& desc)
+{
+    ShaderCompileResult result;
+    result.Errors = "failed to read shader source: " + FileUtil::ToUtf8(desc.Path);
+    std::lock_guard<std::mutex> lock(mMutex);
+    ++mStats.CompileFailures;
+    return result;
+}
+
+std::shared_future<ShaderCompileResult> ShaderCache::MakeReadyResult(ShaderCompileResult result)
+{
+    std::promise<ShaderCompileResult> promise;
+    promise.set_value(std::move(result));
+    return promise.get_future().share();
+}
+
+ShaderCacheStats ShaderCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+void ShaderCache::ClearMemory()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mEntries.clear();
+}
+
+ShaderByteCode ShaderCache::LoadFromDisk(uint64_t key)
+{
+    if (mCacheDir.empty())
+    {
+        return nullptr;
+    }
+
+    //映射后只把字节码拷贝一次到缓存中
+    MappedFile file;
+    if (!file.Open(mCacheDir + L"/" + ToHexString(key) + L".cso") ||
+        file.GetSize() < sizeof(ShaderCacheFileHeader))
+    {
+        return nullptr;
+    }
+
+    ShaderCacheFileHeader header;
+    memcpy(&header, file.GetData(), sizeof(header));
+    if (header.Magic != ShaderCacheMagic ||
+        header.Version != ShaderCacheVersion ||
+        header.Key != key ||
+        header.ByteCodeSize != file.GetSize() - sizeof(header))
+    {
+        return nullptr;
+    }
+
+    const uint8_t* byteCode = file.GetData() + sizeof(header);
+    return std::make_shared<const std::vector<uint8_t>>(byteCode, byteCode + header.ByteCodeSize);
+}
+
+void ShaderCache::SaveToDisk(uint64_t key, const std::vector<uint8_t>& byteCode)
+{
+    //写缓存失败不影响本次编译结果，下次启动时重新编译
+    if (mCacheDir.empty() || !FileUtil::EnsureDirectory(mCacheDir))
+    {
+        return;
+    }
+
+    ShaderCacheFileHeader header;
+    header.Magic = ShaderCacheMagic;
+    header.Version = ShaderCacheVersion;
+    header.Key = key;
+    header.ByteCodeSize = byteCode.size();
+
+    std::vector<uint8_t> file(sizeof(header) + byteCode.size());
+    memcpy(file.data(), &header, sizeof(header));
+    if (!byteCode.empty())
+    {
+        memcpy(file.data() + sizeof(header), byteCode.data(), byteCode.size());
+    }
+    FileUtil::WriteAllBytes(mCacheDir + L"/" + ToHexString(key) + L".cso", file.data(), file.size());
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+//着色器字节码缓存，与具体的编译器无关(编译器通过IShaderCompiler接入)，在没有D3DCompiler的平台上也能使用
+//缓存键为以下内容的哈希：源文件以及递归展开的#include文件内容、宏定义、入口函数、目标、编译选项
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "JobSystem.h"
+
+struct ShaderDefine
+{
+    std::string Name;
+    std::string Definition;
+};
+
+struct ShaderCompileDesc
+{
+    std::wstring Path;
+    std::vector<ShaderDefine> Defines;
+    std::string EntryPoint;
+    std::string Target;
+    uint32_t Flags = 0;
+};
+
+typedef std::shared_ptr<const std::vector<uint8_t>> ShaderByteCode;
+
+struct ShaderCompileResult
+{
+    ShaderByteCode ByteCode;    //失败时为nullptr
+    std::string Errors;         //编译器输出的错误与警告
+};
+
+//实际的编译器，source为Path指向的文件内容(缓存计算键时读取的那一份)
+class IShaderCompiler
+{
+public:
+    virtual ~IShaderCompiler() = default;
+
+    virtual bool Compile(
+        const ShaderCompileDesc& desc,
+        const std::vector<uint8_t>& source,
+        std::vector<uint8_t>& byteCode,
+        std::string& errors) = 0;
+};
+
+struct ShaderCacheStats
+{
+    uint64_t MemoryHits = 0;
+    uint64_t DiskHits = 0;
+    uint64_t Misses = 0;            //实际调用了编译器的次数
+    uint64_t CompileFailures = 0;
+    uint64_t Deduplicated = 0;      //与批量中相同的排列或其他线程正在编译的同一键合并的次数
+};
+
+class ShaderCache
+{
+public:
+    //cacheDir为空时只使用内存缓存
+    ShaderCache(IShaderCompiler* compiler, const std::wstring& cacheDir);
+    ShaderCache(const ShaderCache& rhs) = delete;
+    ShaderCache& operator=(const ShaderCache& rhs) = delete;
+    //等待CompileBatch提交的任务结束
+    ~ShaderCache();
+
+    //依次查找内存缓存、磁盘缓存，都未命中时调用编译器并写回两级缓存
+    //失败(源文件无法读取或编译出错)时返回nullptr，errors中为错误信息
+    //可以在多个线程中同时调用，同一个键同时只会编译一次
+    //其他线程正在编译同一个键时会等待它的结果，因此只应在非工作线程中调用，任务中使用CompileBatch
+    ShaderByteCode Compile(const ShaderCompileDesc& desc, std::string* errors = nullptr);
+
+    //把一组排列作为jobs中的任务并行编译，返回的future与permutations一一对应，完全相同的排列共享同一个future
+    //缓存键在调用线程中计算，命中缓存或与正在编译的同一个键合并时直接返回，任务中不会等待其他任务
+    std::vector<std::shared_future<ShaderCompileResult>> CompileBatch(
+        const std::vector<ShaderCompileDesc>& permutations,
+        JobSystem& jobs);
+
+    ShaderCacheStats GetStats() const;
+
+    //只清空内存缓存，磁盘缓存保留
+    void ClearMemory();
+
+    //计算缓存键，源文件无法读取时返回false
+    static bool ComputeKey(const ShaderCompileDesc& desc, std::vector<uint8_t>& source, uint64_t& key);
+
+private:
+    ShaderCompileResult CompileOne(const ShaderCompileDesc& desc);
+    //调用者已在mPending中登记key，读取磁盘缓存或调用编译器，写回缓存、移除登记并兑现promise
+    ShaderCompileResult CompileMiss(
+        const ShaderCompileDesc& desc,
+        const std::vector<uint8_t>& source,
+        uint64_t key,
+        std::promise<ShaderCompileResult>& promise);
+    ShaderCompileResult ReadFailure(const ShaderCompileDesc& desc);
+    static std::shared_future<ShaderCompileResult> MakeReadyResult(ShaderCompileResult result);
+    ShaderByteCode LoadFromDisk(uint64_t key);
+    void SaveToDisk(uint64_t key, const std::vector<uint8_t>& byteCode);
+
+private:
+    IShaderCompiler* mCompiler = nullptr;
+    std::wstring mCacheDir;
+
+    mutable std::mutex mMutex;
+    std::unordered_map<uint64_t, ShaderByteCode> mEntries;
+    std::unordered_map<uint64_t, std::shared_future<ShaderCompileResult>> mPending;
+    ShaderCacheStats mStats;
+
+    //CompileBatch派生的任务
+    JobCounter mBatchJobs;
+};
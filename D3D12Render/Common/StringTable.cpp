@@ -0,0 +1,67 @@
+#include "StringTable.h"
+
+#include <cassert>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace
+{
+    struct StringTableData
+    {
+        std::mutex Mutex;
+
+        //deque在尾部插入时不会移动已有元素，GetString返回的引用因此保持有效
+        std::deque<std::string> Strings;
+        std::unordered_map<std::string, uint32_t> Lookup;
+    };
+
+    //函数内的静态对象，保证在其他全局对象的构造函数中也能使用
+    StringTableData& GetData()
+    {
+        static StringTableData data;
+        return data;
+    }
+}
+
+StringId StringTable::Intern(const std::string& name)
+{
+    StringTableData& data = GetData();
+    std::lock_guard<std::mutex> lock(data.Mutex);
+
+    StringId id;
+    auto it = data.Lookup.find(name);
+    if (it != data.Lookup.end())
+    {
+        id.Value = it->second;
+        return id;
+    }
+
+    id.Value = static_cast<uint32_t>(data.Strings.size());
+    data.Strings.push_back(name);
+    data.Lookup.emplace(name, id.Value);
+    return id;
+}
+
+StringId StringTable::Find(const std::string& name)
+{
+    StringTableData& data = GetData();
+    std::lock_guard<std::mutex> lock(data.Mutex);
+
+    StringId id;
+    auto it = data.Lookup.find(name);
+    if (it != data.Lookup.end())
+    {
+        id.Value = it->second;
+    }
+    return id;
+}
+
+const std::string& StringTable::GetString(StringId id)
+{
+    StringTableData& data = GetData();
+    std::lock_guard<std::mutex> lock(data.Mutex);
+
+    assert(id.Value < data.Strings.size());
+    return data.Strings[id.Value];
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+//驻留字符串的整数句柄，相同的字符串总是得到相同的值，在程序运行期间保持不变
+struct StringId
+{
+    static const uint32_t InvalidValue = 0xffffffff;
+
+    uint32_t Value = InvalidValue;
+
+    bool IsValid() const { return Value != InvalidValue; }
+    bool operator==(const StringId& rhs) const { return Value == rhs.Value; }
+    bool operator!=(const StringId& rhs) const { return Value != rhs.Value; }
+};
+
+namespace std
+{
+    template<>
+    struct hash<StringId>
+    {
+        size_t operator()(const StringId& id) const { return std::hash<uint32_t>()(id.Value); }
+    };
+}
+
+//全局的字符串驻留表，名字只在构建资源时转换一次，之后都通过StringId比较与查找，线程安全
+class StringTable
+{
+public:
+    //返回name的句柄，第一次出现时加入表中
+    static StringId Intern(const std::string& name);
+
+    //只查找不插入，name从未驻留过时返回无效的句柄
+    static StringId Find(const std::string& name);
+
+    //返回的引用在程序运行期间一直有效
+    static const std::string& GetString(StringId id);
+};
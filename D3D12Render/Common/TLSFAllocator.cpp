@@ -0,0 +1,303 @@
+#include "TLSFAllocator.h"
+
+#include <algorithm>
+#include <cassert>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+    //value必须非0
+    uint32_t HighestBit(uint32_t value)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse(&index, value);
+        return static_cast<uint32_t>(index);
+#else
+        return 31u - static_cast<uint32_t>(__builtin_clz(value));
+#endif
+    }
+
+    uint32_t LowestBit(uint32_t value)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, value);
+        return static_cast<uint32_t>(index);
+#else
+        return static_cast<uint32_t>(__builtin_ctz(value));
+#endif
+    }
+}
+
+TLSFAllocator::TLSFAllocator(uint32_t capacity) :
+    mCapacity(capacity)
+{
+    Reset();
+}
+
+void TLSFAllocator::Mapping(uint32_t size, uint32_t& fl, uint32_t& sl)
+{
+    //小于SLCount的大小全部放在第0级，每个大小一档
+    if (size < SLCount)
+    {
+        fl = 0;
+        sl = size;
+        return;
+    }
+
+    const uint32_t msb = HighestBit(size);
+    fl = msb - SLBits + 1;
+    sl = (size >> (msb - SLBits)) - SLCount;
+}
+
+void TLSFAllocator::Reset()
+{
+    mBlocks.clear();
+    mUnusedBlocks.clear();
+    mFLBitmap = 0;
+    for (uint32_t fl = 0; fl < FLCount; ++fl)
+    {
+        mSLBitmap[fl] = 0;
+        for (uint32_t sl = 0; sl < SLCount; ++sl)
+        {
+            mFreeHeads[fl][sl] = InvalidNode;
+        }
+    }
+
+    mFreeSize = 0;
+    mAllocationCount = 0;
+    mFreeBlockCount = 0;
+
+    if (mCapacity > 0)
+    {
+        const uint32_t node = NewBlock();
+        mBlocks[node].Offset = 0;
+        mBlocks[node].Size = mCapacity;
+        InsertFree(node);
+    }
+}
+
+TLSFAllocator::Allocation TLSFAllocator::Allocate(uint32_t size)
+{
+    Allocation allocation;
+    if (size == 0 || size > mFreeSize)
+    {
+        return allocation;
+    }
+
+    uint32_t node = InvalidNode;
+    uint32_t fl, sl;
+
+    //向上取整到下一档，保证该档及更高档中的任何空闲块都不小于size
+    const uint32_t round = size >= SLCount ? (1u << (HighestBit(size) - SLBits)) - 1 : 0;
+    if (size <= UINT32_MAX - round)
+    {
+        Mapping(size + round, fl, sl);
+
+        uint32_t slMap = mSLBitmap[fl] & (~0u << sl);
+        if (slMap == 0)
+        {
+            const uint32_t flMap = fl + 1 < FLCount ? mFLBitmap & (~0u << (fl + 1)) : 0;
+            if (flMap != 0)
+            {
+                fl = LowestBit(flMap);
+                slMap = mSLBitmap[fl];
+            }
+        }
+        if (slMap != 0)
+        {
+            node = mFreeHeads[fl][LowestBit(slMap)];
+        }
+    }
+
+    //更高的档中没有空闲块，size所在档中的块大小不一，其中仍可能有足够大的块
+    if (node == InvalidNode)
+    {
+        Mapping(size, fl, sl);
+        for (uint32_t candidate = mFreeHeads[fl][sl]; candidate != InvalidNode; candidate = mBlocks[candidate].NextFree)
+        {
+            if (mBlocks[candidate].Size >= size)
+            {
+                node = candidate;
+                break;
+            }
+        }
+        if (node == InvalidNode)
+        {
+            return allocation;
+        }
+    }
+
+    assert(mBlocks[node].Free && mBlocks[node].Size >= size);
+    RemoveFree(node);
+
+    //剩余部分拆分为新的空闲块
+    if (mBlocks[node].Size > size)
+    {
+        const uint32_t rest = NewBlock();
+        Block& block = mBlocks[node];
+        Block& restBlock = mBlocks[rest];
+        restBlock.Offset = block.Offset + size;
+        restBlock.Size = block.Size - size;
+        restBlock.PrevPhysical = node;
+        restBlock.NextPhysical = block.NextPhysical;
+        if (block.NextPhysical != InvalidNode)
+        {
+            mBlocks[block.NextPhysical].PrevPhysical = rest;
+        }
+        block.NextPhysical = rest;
+        block.Size = size;
+        InsertFree(rest);
+    }
+
+    ++mAllocationCount;
+    allocation.Offset = mBlocks[node].Offset;
+    allocation.Size = size;
+    allocation.Node = node;
+    return allocation;
+}
+
+void TLSFAllocator::Free(const Allocation& allocation)
+{
+    if (!allocation.IsValid())
+    {
+        return;
+    }
+
+    uint32_t node = allocation.Node;
+    assert(node < mBlocks.size() && !mBlocks[node].Free && mBlocks[node].Offset == allocation.Offset);
+    --mAllocationCount;
+
+    //与前一个空闲块合并
+    const uint32_t prev = mBlocks[node].PrevPhysical;
+    if (prev != InvalidNode && mBlocks[prev].Free)
+    {
+        RemoveFree(prev);
+        mBlocks[prev].Size += mBlocks[node].Size;
+        mBlocks[prev].NextPhysical = mBlocks[node].NextPhysical;
+        if (mBlocks[node].NextPhysical != InvalidNode)
+        {
+            mBlocks[mBlocks[node].NextPhysical].PrevPhysical = prev;
+        }
+        DeleteBlock(node);
+        node = prev;
+    }
+
+    //与后一个空闲块合并
+    const uint32_t next = mBlocks[node].NextPhysical;
+    if (next != InvalidNode && mBlocks[next].Free)
+    {
+        RemoveFree(next);
+        mBlocks[node].Size += mBlocks[next].Size;
+        mBlocks[node].NextPhysical = mBlocks[next].NextPhysical;
+        if (mBlocks[next].NextPhysical != InvalidNode)
+        {
+            mBlocks[mBlocks[next].NextPhysical].PrevPhysical = node;
+        }
+        DeleteBlock(next);
+    }
+
+    InsertFree(node);
+}
+
+uint32_t TLSFAllocator::GetLargestFreeBlock() const
+{
+    if (mFLBitmap == 0)
+    {
+        return 0;
+    }
+
+    //最大的块一定在最高的非空档中，但同一档内的大小不同，需要遍历该档的链表
+    const uint32_t fl = HighestBit(mFLBitmap);
+    const uint32_t sl = HighestBit(mSLBitmap[fl]);
+    uint32_t largest = 0;
+    for (uint32_t node = mFreeHeads[fl][sl]; node != InvalidNode; node = mBlocks[node].NextFree)
+    {
+        largest = std::max(largest, mBlocks[node].Size);
+    }
+    return largest;
+}
+
+uint32_t TLSFAllocator::NewBlock()
+{
+    uint32_t node;
+    if (!mUnusedBlocks.empty())
+    {
+        node = mUnusedBlocks.back();
+        mUnusedBlocks.pop_back();
+        mBlocks[node] = Block();
+    }
+    else
+    {
+        node = static_cast<uint32_t>(mBlocks.size());
+        mBlocks.emplace_back();
+    }
+    return node;
+}
+
+void TLSFAllocator::DeleteBlock(uint32_t node)
+{
+    mBlocks[node].Size = 0;
+    mBlocks[node].Free = false;
+    mUnusedBlocks.push_back(node);
+}
+
+void TLSFAllocator::InsertFree(uint32_t node)
+{
+    Block& block = mBlocks[node];
+    uint32_t fl, sl;
+    Mapping(block.Size, fl, sl);
+
+    block.Free = true;
+    block.PrevFree = InvalidNode;
+    block.NextFree = mFreeHeads[fl][sl];
+    if (block.NextFree != InvalidNode)
+    {
+        mBlocks[block.NextFree].PrevFree = node;
+    }
+    mFreeHeads[fl][sl] = node;
+
+    mFLBitmap |= 1u << fl;
+    mSLBitmap[fl] |= 1u << sl;
+    mFreeSize += block.Size;
+    ++mFreeBlockCount;
+}
+
+void TLSFAllocator::RemoveFree(uint32_t node)
+{
+    Block& block = mBlocks[node];
+    uint32_t fl, sl;
+    Mapping(block.Size, fl, sl);
+
+    if (block.PrevFree != InvalidNode)
+    {
+        mBlocks[block.PrevFree].NextFree = block.NextFree;
+    }
+    else
+    {
+        mFreeHeads[fl][sl] = block.NextFree;
+    }
+    if (block.NextFree != InvalidNode)
+    {
+        mBlocks[block.NextFree].PrevFree = block.PrevFree;
+    }
+
+    if (mFreeHeads[fl][sl] == InvalidNode)
+    {
+        mSLBitmap[fl] &= ~(1u << sl);
+        if (mSLBitmap[fl] == 0)
+        {
+            mFLBitmap &= ~(1u << fl);
+        }
+    }
+
+    block.Free = false;
+    block.PrevFree = InvalidNode;
+    block.NextFree = InvalidNode;
+    mFreeSize -= block.Size;
+    --mFreeBlockCount;
+}
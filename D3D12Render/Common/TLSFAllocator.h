@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+//两级分离适配(TLSF)的区间分配器，只管理[0, capacity)范围内的偏移，不持有实际内存，
+//用于在大缓冲区中子分配顶点、索引等。分配与释放都是O(1)，释放时立即与相邻的空闲块合并
+//第一级按大小的最高位分类，第二级把每一级再等分为SLCount份；查找时把请求向上取整到下一档，
+//因此找到的空闲块一定足够大，不需要遍历链表。更高的档中没有空闲块时，再遍历请求大小所在档的链表，
+//保证只要存在足够大的空闲块就能分配成功(例如分配整个容量)
+class TLSFAllocator
+{
+public:
+    static const uint32_t InvalidNode = 0xffffffff;
+
+    struct Allocation
+    {
+        uint32_t Offset = 0;
+        uint32_t Size = 0;
+        uint32_t Node = InvalidNode;
+
+        bool IsValid() const { return Node != InvalidNode; }
+    };
+
+    explicit TLSFAllocator(uint32_t capacity);
+
+    //size为0或没有足够大的连续空间时返回无效的Allocation
+    Allocation Allocate(uint32_t size);
+    void Free(const Allocation& allocation);
+
+    //释放全部分配
+    void Reset();
+
+    uint32_t GetCapacity() const { return mCapacity; }
+    uint32_t GetFreeSize() const { return mFreeSize; }
+    uint32_t GetAllocationCount() const { return mAllocationCount; }
+    uint32_t GetFreeBlockCount() const { return mFreeBlockCount; }
+
+    //最大的连续空闲块，可用来衡量碎片程度(与GetFreeSize()相差越大碎片越多)
+    uint32_t GetLargestFreeBlock() const;
+
+private:
+    static const uint32_t SLBits = 5;
+    static const uint32_t SLCount = 1u << SLBits;
+    static const uint32_t FLCount = 32 - SLBits + 1;
+
+    struct Block
+    {
+        uint32_t Offset = 0;
+        uint32_t Size = 0;
+        uint32_t PrevPhysical = InvalidNode;
+        uint32_t NextPhysical = InvalidNode;
+        uint32_t PrevFree = InvalidNode;
+        uint32_t NextFree = InvalidNode;
+        bool Free = false;
+    };
+
+    static void Mapping(uint32_t size, uint32_t& fl, uint32_t& sl);
+
+    uint32_t NewBlock();
+    void DeleteBlock(uint32_t node);
+    void InsertFree(uint32_t node);
+    void RemoveFree(uint32_t node);
+
+private:
+    uint32_t mCapacity = 0;
+    uint32_t mFreeSize = 0;
+    uint32_t mAllocationCount = 0;
+    uint32_t mFreeBlockCount = 0;
+
+    uint32_t mFLBitmap = 0;
+    uint32_t mSLBitmap[FLCount] = {};
+    uint32_t mFreeHeads[FLCount][SLCount];
+
+    std::vector<Block> mBlocks;
+    std::vector<uint32_t> mUnusedBlocks;
+};
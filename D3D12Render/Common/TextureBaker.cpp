@@ -0,0 +1,82 @@
+#include "TextureBaker.h"
+#include "BCEncoder.h"
+#include "DDSWriter.h"
+#include "FileUtil.h"
+
+bool TextureBaker::IsSRGBFormat(DXGI_FORMAT format)
+{
+    switch (format)
+    {
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+    case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+    case DXGI_FORMAT_BC2_UNORM_SRGB:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+bool TextureBaker::BakeRGBA8(
+    const uint8_t* pixels,
+    uint32_t width,
+    uint32_t height,
+    size_t rowPitch,
+    const TextureBakeOptions& options,
+    std::vector<uint8_t>& ddsFile)
+{
+    const bool uncompressed = options.Format == DXGI_FORMAT_R8G8B8A8_UNORM ||
+                              options.Format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+    if (!uncompressed && !BCEncoder::IsSupportedFormat(options.Format))
+    {
+        return false;
+    }
+
+    std::vector<MipLevel> mips = MipGenerator::GenerateRGBA8(
+        pixels, width, height, rowPitch,
+        IsSRGBFormat(options.Format),
+        options.Filter,
+        options.GenerateMips ? 0 : 1);
+    if (mips.empty())
+    {
+        return false;
+    }
+
+    std::vector<std::vector<uint8_t>> subresources(mips.size());
+    for (size_t i = 0; i < mips.size(); ++i)
+    {
+        if (uncompressed)
+        {
+            subresources[i] = std::move(mips[i].Pixels);
+        }
+        else if (!BCEncoder::CompressImage(mips[i], options.Format, subresources[i], options.BC1PunchThrough))
+        {
+            return false;
+        }
+    }
+
+    return DDSWriter::WriteTexture2D(
+        options.Format, width, height, 1,
+        static_cast<uint32_t>(subresources.size()),
+        subresources, ddsFile);
+}
+
+bool TextureBaker::BakeRGBA8ToFile(
+    const std::wstring& path,
+    const uint8_t* pixels,
+    uint32_t width,
+    uint32_t height,
+    size_t rowPitch,
+    const TextureBakeOptions& options)
+{
+    std::vector<uint8_t> ddsFile;
+    if (!BakeRGBA8(pixels, width, height, rowPitch, options, ddsFile))
+    {
+        return false;
+    }
+    return FileUtil::WriteAllBytes(path, ddsFile.data(), ddsFile.size());
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <dxgiformat.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MipGenerator.h"
+
+struct TextureBakeOptions
+{
+    //输出格式，可以是BCEncoder支持的BC格式，也可以是R8G8B8A8_UNORM(_SRGB)
+    //sRGB格式会在线性空间生成mip
+    DXGI_FORMAT Format = DXGI_FORMAT_BC7_UNORM_SRGB;
+
+    MipFilter Filter = MipFilter::Box;
+
+    //BC1时是否使用1位alpha(alpha小于128的像素透明)；默认按不透明纹理编码，alpha通道被忽略
+    bool BC1PunchThrough = false;
+
+    //为false时只输出第0级
+    bool GenerateMips = true;
+};
+
+//离线纹理烘焙：RGBA8原图 -> 生成mip链 -> BC压缩 -> DDS文件
+//用来替代内容管线中只能在Windows上运行的外部压缩工具
+class TextureBaker
+{
+public:
+    static bool BakeRGBA8(
+        const uint8_t* pixels,
+        uint32_t width,
+        uint32_t height,
+        size_t rowPitch,
+        const TextureBakeOptions& options,
+        std::vector<uint8_t>& ddsFile);
+
+    static bool BakeRGBA8ToFile(
+        const std::wstring& path,
+        const uint8_t* pixels,
+        uint32_t width,
+        uint32_t height,
+        size_t rowPitch,
+        const TextureBakeOptions& options);
+
+    static bool IsSRGBFormat(DXGI_FORMAT format);
+};
@@ -0,0 +1,411 @@
+#include "TexturePacker.h"
+#include "DDSFormat.h"
+#include "DDSWriter.h"
+#include "FileUtil.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <tuple>
+
+using namespace DirectX;
+
+namespace
+{
+    //解析后的输入纹理
+    struct PackSource
+    {
+        size_t Input = 0;
+        DDSTextureDesc Desc;
+        const uint8_t* Bits = nullptr;
+        std::vector<DDSSubresourceLayout> Layouts;
+
+        //在图集中占用的区域(包含保护边)
+        uint32_t SlotX = 0;
+        uint32_t SlotY = 0;
+        uint32_t SlotWidth = 0;
+        uint32_t SlotHeight = 0;
+    };
+
+    uint32_t AlignUp(uint32_t value, uint32_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    //只打包每个元素(像素或BC块)占整数字节、且可以按元素拷贝的格式
+    bool IsPackableFormat(DXGI_FORMAT format)
+    {
+        const size_t bpp = DDSFormat::BitsPerPixel(format);
+        if (bpp == 0 || (!DDSFormat::IsCompressed(format) && bpp % 8 != 0))
+        {
+            return false;
+        }
+
+        switch (format)
+        {
+        case DXGI_FORMAT_R8G8_B8G8_UNORM:
+        case DXGI_FORMAT_G8R8_G8B8_UNORM:
+        case DXGI_FORMAT_YUY2:
+        case DXGI_FORMAT_Y210:
+        case DXGI_FORMAT_Y216:
+            return false;
+
+        default:
+            return true;
+        }
+    }
+
+    //元素为像素或4x4的BC块
+    uint32_t ElementDim(DXGI_FORMAT format)
+    {
+        return DDSFormat::IsCompressed(format) ? 4 : 1;
+    }
+
+    size_t ElementBytes(DXGI_FORMAT format)
+    {
+        size_t rowBytes = 0;
+        DDSFormat::GetSurfaceInfo(1, 1, format, nullptr, &rowBytes, nullptr);
+        return rowBytes;
+    }
+
+    //把一级mip拷贝到图集的对应位置，并把边缘元素复制到保护边中
+    void BlitWithGutter(
+        const uint8_t* src, size_t srcRowPitch, uint32_t srcCols, uint32_t srcRows,
+        uint8_t* dst, size_t dstRowPitch, uint32_t dstX, uint32_t dstY, uint32_t gutter,
+        size_t elementBytes)
+    {
+        for (int64_t y = -int64_t(gutter); y < int64_t(srcRows) + gutter; ++y)
+        {
+            const int64_t sy = std::min<int64_t>(std::max<int64_t>(y, 0), srcRows - 1);
+            const uint8_t* srcRow = src + size_t(sy) * srcRowPitch;
+            uint8_t* dstRow = dst + size_t(dstY + y) * dstRowPitch + size_t(dstX) * elementBytes;
+
+            //左侧保护边、内容、右侧保护边
+            for (uint32_t x = 0; x < gutter; ++x)
+            {
+                memcpy(dstRow - (x + 1) * elementBytes, srcRow, elementBytes);
+                memcpy(dstRow + (srcCols + x) * elementBytes, srcRow + (srcCols - 1) * elementBytes, elementBytes);
+            }
+            memcpy(dstRow, srcRow, srcCols * elementBytes);
+        }
+    }
+
+    bool BuildArrayPage(const std::vector<PackSource*>& slices, TexturePackPage& page)
+    {
+        const DDSTextureDesc& desc = slices[0]->Desc;
+        page.Format = desc.Format;
+        page.Width = desc.Width;
+        page.Height = desc.Height;
+        page.ArraySize = static_cast<uint32_t>(slices.size());
+        page.MipCount = desc.MipCount;
+        page.IsAtlas = false;
+
+        std::vector<std::vector<uint8_t>> subresources;
+        subresources.reserve(slices.size() * desc.MipCount);
+        for (const PackSource* source : slices)
+        {
+            for (const DDSSubresourceLayout& layout : source->Layouts)
+            {
+                const uint8_t* begin = source->Bits + layout.Offset;
+                subresources.emplace_back(begin, begin + layout.SlicePitch);
+            }
+        }
+
+        return DDSWriter::WriteTexture2D(page.Format, page.Width, page.Height, page.ArraySize, page.MipCount,
+            subresources, page.DdsFile);
+    }
+
+    bool BuildAtlasPage(const std::vector<PackSource*>& entries, uint32_t width, uint32_t height,
+                        uint32_t mipCount, uint32_t padding, TexturePackPage& page)
+    {
+        const DXGI_FORMAT format = entries[0]->Desc.Format;
+        const uint32_t dim = ElementDim(format);
+        const size_t elementBytes = ElementBytes(format);
+
+        page.Format = format;
+        page.Width = width;
+        page.Height = height;
+        page.ArraySize = 1;
+        page.MipCount = mipCount;
+        page.IsAtlas = true;
+
+        std::vector<std::vector<uint8_t>> subresources(mipCount);
+        for (uint32_t mip = 0; mip < mipCount; ++mip)
+        {
+            size_t numBytes = 0;
+            size_t rowPitch = 0;
+            DDSFormat::GetSurfaceInfo(std::max<uint32_t>(width >> mip, 1), std::max<uint32_t>(height >> mip, 1),
+                format, &numBytes, &rowPitch, nullptr);
+            subresources[mip].assign(numBytes, 0);
+
+            //保护边与槽位都按最低一级mip对齐，所以每一级的位置都能整除元素尺寸
+            const uint32_t gutter = (padding >> mip) / dim;
+            for (const PackSource* entry : entries)
+            {
+                const DDSSubresourceLayout& layout = entry->Layouts[mip];
+                const uint32_t cols = static_cast<uint32_t>(layout.RowPitch / elementBytes);
+                const uint32_t rows = static_cast<uint32_t>(layout.NumRows);
+                BlitWithGutter(
+                    entry->Bits + layout.Offset, layout.RowPitch, cols, rows,
+                    subresources[mip].data(), rowPitch,
+                    ((entry->SlotX + padding) >> mip) / dim,
+                    ((entry->SlotY + padding) >> mip) / dim,
+                    gutter, elementBytes);
+            }
+        }
+
+        return DDSWriter::WriteTexture2D(format, width, height, 1, mipCount, subresources, page.DdsFile);
+    }
+}
+
+bool TexturePacker::Pack(
+    const std::vector<TexturePackInput>& inputs,
+    const TexturePackOptions& options,
+    std::vector<TexturePackPage>& pages,
+    std::vector<TexturePackRemap>& remap)
+{
+    pages.clear();
+    remap.assign(inputs.size(), TexturePackRemap());
+
+    //解析输入，只保留可以打包的小尺寸2D纹理，按格式分组
+    std::vector<PackSource> sources;
+    sources.reserve(inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        const std::vector<uint8_t>& file = inputs[i].DdsFile;
+        const DDS_HEADER* header = nullptr;
+        size_t offset = 0;
+
+        PackSource source;
+        source.Input = i;
+        if (!DDSFormat::ParseHeader(file.data(), file.size(), &header, &offset) ||
+            DDSFormat::GetTextureDesc(header, source.Desc) != DDSParseResult::Ok ||
+            source.Desc.Dimension != DDS_DIMENSION_TEXTURE2D ||
+            source.Desc.IsCubeMap || source.Desc.ArraySize != 1 ||
+            source.Desc.Width > options.MaxEntrySize || source.Desc.Height > options.MaxEntrySize ||
+            !IsPackableFormat(source.Desc.Format) ||
+            !DDSFormat::ComputeLayout(source.Desc, file.size() - offset, source.Layouts))
+        {
+            continue;
+        }
+
+        source.Bits = file.data() + offset;
+        sources.push_back(std::move(source));
+    }
+
+    std::map<DXGI_FORMAT, std::vector<PackSource*>> byFormat;
+    for (PackSource& source : sources)
+    {
+        byFormat[source.Desc.Format].push_back(&source);
+    }
+
+    for (auto& formatGroup : byFormat)
+    {
+        //尺寸与mip数相同的纹理合并为纹理数组
+        std::map<std::tuple<uint32_t, uint32_t, uint32_t>, std::vector<PackSource*>> bySize;
+        for (PackSource* source : formatGroup.second)
+        {
+            bySize[std::make_tuple(source->Desc.Width, source->Desc.Height, source->Desc.MipCount)].push_back(source);
+        }
+
+        std::vector<PackSource*> atlasEntries;
+        for (auto& sizeGroup : bySize)
+        {
+            std::vector<PackSource*>& group = sizeGroup.second;
+            if (group.size() < std::max<uint32_t>(options.MinArraySize, 2))
+            {
+                atlasEntries.insert(atlasEntries.end(), group.begin(), group.end());
+                continue;
+            }
+
+            const size_t maxSlices = std::max<uint32_t>(options.MaxArraySize, 1);
+            for (size_t first = 0; first < group.size(); first += maxSlices)
+            {
+                std::vector<PackSource*> slices(group.begin() + first,
+                    group.begin() + std::min(group.size(), first + maxSlices));
+
+                pages.emplace_back();
+                if (!BuildArrayPage(slices, pages.back()))
+                {
+                    return false;
+                }
+                for (uint32_t slice = 0; slice < slices.size(); ++slice)
+                {
+                    TexturePackRemap& entry = remap[slices[slice]->Input];
+                    entry.Page = static_cast<int32_t>(pages.size() - 1);
+                    entry.Slice = slice;
+                }
+            }
+        }
+
+        //只有一张时没有合并的意义，仍单独加载
+        if (atlasEntries.size() < 2)
+        {
+            continue;
+        }
+
+        //剩下的纹理放入图集：所有槽位与保护边都对齐到最低一级mip的一个元素，保证每一级mip中纹理边界都落在元素边界上
+        const uint32_t dim = ElementDim(formatGroup.first);
+        uint32_t mipCount = std::max<uint32_t>(options.MaxAtlasMipLevels, 1);
+        for (const PackSource* entry : atlasEntries)
+        {
+            mipCount = std::min(mipCount, entry->Desc.MipCount);
+        }
+        const uint32_t alignment = dim << (mipCount - 1);
+        const uint32_t padding = AlignUp(options.Padding, alignment);
+        const uint32_t maxAtlasSize = options.MaxAtlasSize / alignment * alignment;
+
+        for (PackSource* entry : atlasEntries)
+        {
+            entry->SlotWidth = AlignUp(entry->Desc.Width, alignment) + padding * 2;
+            entry->SlotHeight = AlignUp(entry->Desc.Height, alignment) + padding * 2;
+        }
+
+        //按高度从大到小排序后逐行(shelf)排列
+        std::stable_sort(atlasEntries.begin(), atlasEntries.end(), [](const PackSource* a, const PackSource* b)
+        {
+            return a->SlotHeight > b->SlotHeight;
+        });
+
+        size_t next = 0;
+        while (next < atlasEntries.size())
+        {
+            std::vector<PackSource*> placed;
+            uint32_t shelfX = 0;
+            uint32_t shelfY = 0;
+            uint32_t shelfHeight = 0;
+            uint32_t usedWidth = 0;
+
+            for (; next < atlasEntries.size(); ++next)
+            {
+                PackSource* entry = atlasEntries[next];
+                if (entry->SlotWidth > maxAtlasSize || entry->SlotHeight > maxAtlasSize)
+                {
+                    continue;
+                }
+
+                if (shelfX + entry->SlotWidth > maxAtlasSize)
+                {
+                    shelfY += shelfHeight;
+                    shelfX = 0;
+                    shelfHeight = 0;
+                }
+                if (shelfY + entry->SlotHeight > maxAtlasSize)
+                {
+                    break;
+                }
+
+                entry->SlotX = shelfX;
+                entry->SlotY = shelfY;
+                shelfX += entry->SlotWidth;
+                shelfHeight = std::max(shelfHeight, entry->SlotHeight);
+                usedWidth = std::max(usedWidth, shelfX);
+                placed.push_back(entry);
+            }
+
+            if (placed.empty())
+            {
+                break;
+            }
+
+            const uint32_t atlasWidth = usedWidth;
+            const uint32_t atlasHeight = shelfY + shelfHeight;
+
+            pages.emplace_back();
+            if (!BuildAtlasPage(placed, atlasWidth, atlasHeight, mipCount, padding, pages.back()))
+            {
+                return false;
+            }
+
+            for (const PackSource* entry : placed)
+            {
+                TexturePackRemap& r = remap[entry->Input];
+                r.Page = static_cast<int32_t>(pages.size() - 1);
+                r.Slice = 0;
+                r.Scale = XMFLOAT2(float(entry->Desc.Width) / atlasWidth, float(entry->Desc.Height) / atlasHeight);
+                r.Offset = XMFLOAT2(float(entry->SlotX + padding) / atlasWidth, float(entry->SlotY + padding) / atlasHeight);
+            }
+        }
+    }
+    return true;
+}
+
+bool TexturePacker::SaveRemapTable(
+    const std::wstring& path,
+    const std::vector<TexturePackInput>& inputs,
+    const std::vector<TexturePackRemap>& remap)
+{
+    if (inputs.size() != remap.size())
+    {
+        return false;
+    }
+
+    std::ostringstream out;
+    out.precision(9);
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        const TexturePackRemap& r = remap[i];
+        out << inputs[i].Name << '\t' << r.Page << '\t' << r.Slice << '\t'
+            << r.Scale.x << '\t' << r.Scale.y << '\t' << r.Offset.x << '\t' << r.Offset.y << '\n';
+    }
+
+    const std::string text = out.str();
+    return FileUtil::WriteAllBytes(path, text.data(), text.size());
+}
+
+bool TexturePacker::LoadRemapTable(
+    const std::wstring& path,
+    std::vector<std::string>& names,
+    std::vector<TexturePackRemap>& remap)
+{
+    names.clear();
+    remap.clear();
+
+    std::vector<uint8_t> data;
+    if (!FileUtil::ReadAllBytes(path, data))
+    {
+        return false;
+    }
+
+    std::istringstream in(std::string(data.begin(), data.end()));
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (line.empty())
+        {
+            continue;
+        }
+
+        const size_t tab = line.find('\t');
+        if (tab == std::string::npos)
+        {
+            return false;
+        }
+
+        TexturePackRemap r;
+        std::istringstream fields(line.substr(tab + 1));
+        if (!(fields >> r.Page >> r.Slice >> r.Scale.x >> r.Scale.y >> r.Offset.x >> r.Offset.y))
+        {
+            return false;
+        }
+
+        names.push_back(line.substr(0, tab));
+        remap.push_back(r);
+    }
+    return true;
+}
+
+XMFLOAT4X4 TexturePacker::MakeUVTransform(const TexturePackRemap& remap)
+{
+    //行向量约定：uv' = [u v 0 1] * M
+    XMFLOAT4X4 m;
+    memset(&m, 0, sizeof(m));
+    m._11 = remap.Scale.x;
+    m._22 = remap.Scale.y;
+    m._33 = 1.0f;
+    m._44 = 1.0f;
+    m._41 = remap.Offset.x;
+    m._42 = remap.Offset.y;
+    return m;
+}
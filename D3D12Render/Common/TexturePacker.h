@@ -0,0 +1,81 @@
+#pragma once
+
+#include <dxgiformat.h>
+#include <DirectXMath.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//待打包的一张DDS纹理
+struct TexturePackInput
+{
+    std::string Name;
+    std::vector<uint8_t> DdsFile;
+};
+
+struct TexturePackOptions
+{
+    //宽高都不超过该值的2D纹理才参与打包
+    uint32_t MaxEntrySize = 256;
+
+    //图集的最大边长
+    uint32_t MaxAtlasSize = 2048;
+
+    //图集中每张纹理四周的保护边(第0级的像素数)，会向上对齐到最低一级mip仍能按像素(BC格式按块)对齐的大小
+    uint32_t Padding = 4;
+
+    //图集最多保留的mip级数，级数越多保护边对齐后越宽
+    uint32_t MaxAtlasMipLevels = 4;
+
+    //尺寸与mip数完全相同的纹理达到该数量时打包为纹理数组，否则放入图集
+    uint32_t MinArraySize = 2;
+    uint32_t MaxArraySize = 256;
+};
+
+//打包结果中的一页：一个纹理数组或一张图集
+struct TexturePackPage
+{
+    DXGI_FORMAT Format = DXGI_FORMAT_UNKNOWN;
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    uint32_t ArraySize = 1;
+    uint32_t MipCount = 1;
+    bool IsAtlas = false;
+    std::vector<uint8_t> DdsFile;
+};
+
+//每个输入纹理在打包结果中的位置，材质用它来改写纹理坐标：uv' = uv * Scale + Offset，并在Slice上采样
+struct TexturePackRemap
+{
+    //Page为-1表示该纹理没有被打包(尺寸过大、格式不支持等)，仍按单独的纹理加载
+    int32_t Page = -1;
+    uint32_t Slice = 0;
+    DirectX::XMFLOAT2 Scale = { 1.0f, 1.0f };
+    DirectX::XMFLOAT2 Offset = { 0.0f, 0.0f };
+};
+
+//烘焙期的纹理打包工具：把格式相同的小纹理合并为纹理数组或带保护边的图集，减少描述符数量与资源碎片
+class TexturePacker
+{
+public:
+    //remap与inputs一一对应；写出某一页的DDS数据失败时返回false
+    static bool Pack(
+        const std::vector<TexturePackInput>& inputs,
+        const TexturePackOptions& options,
+        std::vector<TexturePackPage>& pages,
+        std::vector<TexturePackRemap>& remap);
+
+    //重映射表为文本文件，每行依次为：名字、页、切片、Scale.x、Scale.y、Offset.x、Offset.y，以制表符分隔
+    static bool SaveRemapTable(
+        const std::wstring& path,
+        const std::vector<TexturePackInput>& inputs,
+        const std::vector<TexturePackRemap>& remap);
+
+    static bool LoadRemapTable(
+        const std::wstring& path,
+        std::vector<std::string>& names,
+        std::vector<TexturePackRemap>& remap);
+
+    //转换为可以直接写入Material::MatTransform的纹理坐标变换矩阵
+    static DirectX::XMFLOAT4X4 MakeUVTransform(const TexturePackRemap& remap);
+};
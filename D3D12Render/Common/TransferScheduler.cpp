@@ -0,0 +1,84 @@
+#include "TransferScheduler.h"
+
+#include <algorithm>
+#include <cassert>
+
+void TransferScheduler::OnSubmitted(uint64_t fenceValue, const ResourceId* targets, size_t count)
+{
+    assert(fenceValue > 0);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (size_t i = 0; i < count; ++i)
+    {
+        //同一个资源多次传输时以最后一次为准
+        uint64_t& ready = mReadyValues[targets[i]];
+        ready = std::max(ready, fenceValue);
+    }
+}
+
+uint64_t TransferScheduler::AcquireForUse(const ResourceId* resources, size_t count, uint64_t completedValue)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mReadyValues.empty())
+    {
+        return 0;
+    }
+
+    uint64_t waitValue = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto it = mReadyValues.find(resources[i]);
+        if (it == mReadyValues.end())
+        {
+            continue;
+        }
+        //已经完成，或者使用者已经等待过更大的值
+        if (it->second > completedValue && it->second > mWaitedValue)
+        {
+            waitValue = std::max(waitValue, it->second);
+        }
+        mReadyValues.erase(it);
+    }
+
+    if (waitValue == 0)
+    {
+        return 0;
+    }
+    mWaitedValue = waitValue;
+    ++mWaitCount;
+    return waitValue;
+}
+
+void TransferScheduler::Trim(uint64_t completedValue)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (auto it = mReadyValues.begin(); it != mReadyValues.end();)
+    {
+        if (it->second <= completedValue)
+        {
+            it = mReadyValues.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+bool TransferScheduler::IsPending(ResourceId resource) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mReadyValues.find(resource) != mReadyValues.end();
+}
+
+uint64_t TransferScheduler::GetWaitedValue() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mWaitedValue;
+}
+
+uint64_t TransferScheduler::GetWaitCount() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mWaitCount;
+}
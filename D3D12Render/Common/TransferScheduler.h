@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+//复制队列与使用者(graphics队列)之间的同步记录，与平台无关，只处理fence值
+//每次传输提交后登记目标资源在复制队列的哪个fence值之后可用；
+//使用者第一次使用某个资源之前调用AcquireForUse，得到需要在GPU端等待的fence值(不需要等待时为0)
+//复制队列的fence单调递增，等待过一个值之后，不大于它的资源都不再需要等待，所以等待只发生在真正需要的地方且不会重复
+//使用者只能是一个队列；可以在多个线程中使用
+class TransferScheduler
+{
+public:
+    typedef uintptr_t ResourceId;
+
+    //targets在复制队列的fence到达fenceValue之后可以使用
+    void OnSubmitted(uint64_t fenceValue, const ResourceId* targets, size_t count);
+
+    //返回使用这些资源之前需要等待的fence值(多个资源合并为一次等待)，0表示不需要等待
+    //completedValue为复制队列fence当前已完成的值；返回非0时调用者必须在提交使用它们的命令之前让使用者等待该值
+    uint64_t AcquireForUse(const ResourceId* resources, size_t count, uint64_t completedValue);
+
+    //丢弃已经完成、但一直没有被使用的资源的记录
+    void Trim(uint64_t completedValue);
+
+    //资源是否还有未被使用者等待过的传输
+    bool IsPending(ResourceId resource) const;
+
+    //使用者已经等待过的最大fence值
+    uint64_t GetWaitedValue() const;
+
+    //等待的次数，用于确认没有多余的跨队列等待
+    uint64_t GetWaitCount() const;
+
+private:
+    mutable std::mutex mMutex;
+    std::unordered_map<ResourceId, uint64_t> mReadyValues;
+    uint64_t mWaitedValue = 0;
+    uint64_t mWaitCount = 0;
+};
+
+//按fence回收的对象池(命令分配器、上传缓冲区等)：对象在fence到达登记的值之后才能再次取出
+//fence值需要按登记的顺序单调递增
+template<typename T>
+class FencedPool
+{
+public:
+    void Release(T item, uint64_t fenceValue)
+    {
+        mItems.push_back(std::make_pair(fenceValue, std::move(item)));
+    }
+
+    //取出一个fence已经完成的对象，没有时返回false
+    bool Acquire(uint64_t completedValue, T& item)
+    {
+        if (mItems.empty() || mItems.front().first > completedValue)
+        {
+            return false;
+        }
+        item = std::move(mItems.front().second);
+        mItems.pop_front();
+        return true;
+    }
+
+    //丢弃所有fence已经完成的对象
+    void Trim(uint64_t completedValue)
+    {
+        while (!mItems.empty() && mItems.front().first <= completedValue)
+        {
+            mItems.pop_front();
+        }
+    }
+
+    size_t GetSize() const { return mItems.size(); }
+
+private:
+    std::deque<std::pair<uint64_t, T>> mItems;
+};
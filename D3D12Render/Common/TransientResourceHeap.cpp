@@ -0,0 +1,123 @@
+#include "TransientResourceHeap.h"
+
+#include <algorithm>
+
+using Microsoft::WRL::ComPtr;
+
+TransientResourceHeap::TransientResourceHeap(ID3D12Device* device) :
+    mDevice(device)
+{
+}
+
+TransientResourceDesc TransientResourceHeap::Describe(const D3D12_RESOURCE_DESC& desc) const
+{
+    D3D12_RESOURCE_ALLOCATION_INFO info = mDevice->GetResourceAllocationInfo(0, 1, &desc);
+    TransientResourceDesc result;
+    result.Size = info.SizeInBytes;
+    result.Alignment = info.Alignment;
+    if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+    {
+        result.HeapKind = BufferHeap;
+    }
+    else if (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL))
+    {
+        result.HeapKind = desc.SampleDesc.Count > 1 ? MsaaRenderTargetHeap : RenderTargetHeap;
+    }
+    else
+    {
+        result.HeapKind = TextureHeap;
+    }
+    return result;
+}
+
+void TransientResourceHeap::Realize(const TransientMemoryPlan& plan, const std::vector<TransientTextureDesc>& resources)
+{
+    assert(plan.Placements.size() == resources.size());
+    mResources.clear();
+    mResources.resize(resources.size());
+
+    std::vector<ID3D12Heap*> heaps(plan.Heaps.size(), nullptr);
+    for (size_t i = 0; i < plan.Heaps.size(); ++i)
+    {
+        const TransientHeapDesc& heapDesc = plan.Heaps[i];
+        if (mHeaps.size() <= heapDesc.HeapKind)
+        {
+            mHeaps.resize(heapDesc.HeapKind + 1);
+        }
+
+        ComPtr<ID3D12Heap>& heap = mHeaps[heapDesc.HeapKind];
+        if (heap == nullptr || heap->GetDesc().SizeInBytes < heapDesc.Size ||
+            heap->GetDesc().Alignment < heapDesc.Alignment)
+        {
+            D3D12_HEAP_DESC desc = {};
+            desc.SizeInBytes = heapDesc.Size;
+            desc.Properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+            desc.Alignment = heapDesc.Alignment;
+            switch (heapDesc.HeapKind)
+            {
+            case BufferHeap:
+                desc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+                break;
+            case TextureHeap:
+                desc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+                break;
+            default:
+                desc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+                break;
+            }
+            heap = nullptr;
+            ThrowIfFailed(mDevice->CreateHeap(&desc, IID_PPV_ARGS(&heap)));
+        }
+        heaps[i] = heap.Get();
+    }
+
+    for (size_t i = 0; i < resources.size(); ++i)
+    {
+        const TransientPlacement& placement = plan.Placements[i];
+        //没有被任何pass使用的资源不创建
+        if (placement.Heap == TransientMemoryPlan::NoHeap)
+        {
+            continue;
+        }
+        const TransientTextureDesc& resource = resources[i];
+        ThrowIfFailed(mDevice->CreatePlacedResource(
+            heaps[placement.Heap],
+            placement.Offset,
+            &resource.Desc,
+            resource.InitialState,
+            resource.HasClearValue ? &resource.ClearValue : nullptr,
+            IID_PPV_ARGS(&mResources[i])));
+    }
+}
+
+void TransientResourceHeap::RecordAliasingBarriers(ID3D12GraphicsCommandList* cmdList, const TransientMemoryPlan& plan,
+    uint32_t pass)
+{
+    //Barriers按Pass排序
+    auto first = std::lower_bound(plan.Barriers.begin(), plan.Barriers.end(), pass,
+        [](const TransientAliasingBarrier& barrier, uint32_t value) { return barrier.Pass < value; });
+
+    mBarriers.clear();
+    for (auto it = first; it != plan.Barriers.end() && it->Pass == pass; ++it)
+    {
+        ID3D12Resource* before = it->Before == TransientAliasingBarrier::AnyResource ? nullptr : mResources[it->Before].Get();
+        mBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Aliasing(before, mResources[it->After].Get()));
+    }
+    if (!mBarriers.empty())
+    {
+        cmdList->ResourceBarrier((UINT)mBarriers.size(), mBarriers.data());
+    }
+}
+
+UINT64 TransientResourceHeap::GetHeapBytes() const
+{
+    UINT64 bytes = 0;
+    for (const auto& heap : mHeaps)
+    {
+        if (heap != nullptr)
+        {
+            bytes += heap->GetDesc().SizeInBytes;
+        }
+    }
+    return bytes;
+}
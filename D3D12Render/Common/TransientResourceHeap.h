@@ -0,0 +1,52 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "TransientResourcePlanner.h"
+
+struct TransientTextureDesc
+{
+    D3D12_RESOURCE_DESC Desc = {};
+    D3D12_RESOURCE_STATES InitialState = D3D12_RESOURCE_STATE_COMMON;
+    bool HasClearValue = false;
+    D3D12_CLEAR_VALUE ClearValue = {};
+};
+
+//按TransientMemoryPlan创建临时资源：每类一个堆，资源作为placed resource放在规划好的偏移上
+//重叠的资源共享内存，第一次使用前需要录制aliasing barrier，并且渲染目标/深度必须先Clear或Discard
+class TransientResourceHeap
+{
+public:
+    //资源堆第一层级的硬件要求渲染目标/深度、其他纹理、缓冲区分别放在不同的堆中，多重采样资源另外分开(4MB对齐)
+    enum HeapKind : uint32_t
+    {
+        RenderTargetHeap = 0,
+        TextureHeap = 1,
+        BufferHeap = 2,
+        MsaaRenderTargetHeap = 3,
+    };
+
+    explicit TransientResourceHeap(ID3D12Device* device);
+    TransientResourceHeap(const TransientResourceHeap& rhs) = delete;
+    TransientResourceHeap& operator=(const TransientResourceHeap& rhs) = delete;
+
+    //资源的内存需求，用于TransientResourcePlanner::AddResource
+    TransientResourceDesc Describe(const D3D12_RESOURCE_DESC& desc) const;
+
+    //按plan创建堆与资源，已有的堆足够大时复用；之前创建的资源被释放，调用者需要保证GPU已经不再使用它们
+    void Realize(const TransientMemoryPlan& plan, const std::vector<TransientTextureDesc>& resources);
+
+    ID3D12Resource* GetResource(uint32_t index) const { return mResources[index].Get(); }
+
+    //录制pass开始前的aliasing barrier
+    void RecordAliasingBarriers(ID3D12GraphicsCommandList* cmdList, const TransientMemoryPlan& plan, uint32_t pass);
+
+    //所有堆的大小之和
+    UINT64 GetHeapBytes() const;
+
+private:
+    ID3D12Device* mDevice = nullptr;
+    //按HeapKind下标
+    std::vector<Microsoft::WRL::ComPtr<ID3D12Heap>> mHeaps;
+    std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> mResources;
+    std::vector<D3D12_RESOURCE_BARRIER> mBarriers;
+};
@@ -0,0 +1,178 @@
+#include "TransientResourcePlanner.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+    uint64_t AlignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    bool LifetimesOverlap(const TransientPlacement& a, const TransientPlacement& b)
+    {
+        return a.FirstPass <= b.LastPass && b.FirstPass <= a.LastPass;
+    }
+
+    bool RangesOverlap(uint64_t offsetA, uint64_t sizeA, uint64_t offsetB, uint64_t sizeB)
+    {
+        return offsetA < offsetB + sizeB && offsetB < offsetA + sizeA;
+    }
+}
+
+uint32_t TransientResourcePlanner::AddResource(const TransientResourceDesc& desc)
+{
+    assert(desc.Size > 0 && desc.Alignment > 0);
+    mResources.push_back(desc);
+    TransientPlacement lifetime;
+    lifetime.Heap = TransientMemoryPlan::NoHeap;
+    lifetime.FirstPass = ~0u;
+    lifetime.LastPass = 0;
+    mLifetimes.push_back(lifetime);
+    return static_cast<uint32_t>(mResources.size() - 1);
+}
+
+uint32_t TransientResourcePlanner::AddPass(const uint32_t* resources, size_t count)
+{
+    const uint32_t pass = mPassCount++;
+    for (size_t i = 0; i < count; ++i)
+    {
+        assert(resources[i] < mLifetimes.size());
+        TransientPlacement& lifetime = mLifetimes[resources[i]];
+        lifetime.FirstPass = std::min(lifetime.FirstPass, pass);
+        lifetime.LastPass = std::max(lifetime.LastPass, pass);
+    }
+    return pass;
+}
+
+void TransientResourcePlanner::Clear()
+{
+    mResources.clear();
+    mLifetimes.clear();
+    mPassCount = 0;
+}
+
+void TransientResourcePlanner::Build(TransientMemoryPlan& plan) const
+{
+    const uint32_t count = static_cast<uint32_t>(mResources.size());
+    plan.Placements = mLifetimes;
+    plan.Heaps.clear();
+    plan.Barriers.clear();
+    plan.TotalBytes = 0;
+    plan.NaiveBytes = 0;
+
+    //大的先放，相同大小时先开始的先放，结果与添加顺序无关
+    std::vector<uint32_t> order;
+    order.reserve(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (mLifetimes[i].FirstPass != ~0u)
+        {
+            order.push_back(i);
+            plan.NaiveBytes += mResources[i].Size;
+        }
+    }
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b)
+    {
+        if (mResources[a].Size != mResources[b].Size)
+        {
+            return mResources[a].Size > mResources[b].Size;
+        }
+        if (mLifetimes[a].FirstPass != mLifetimes[b].FirstPass)
+        {
+            return mLifetimes[a].FirstPass < mLifetimes[b].FirstPass;
+        }
+        return a < b;
+    });
+
+    //每类资源已经放置的资源，按类分开查找
+    std::vector<std::vector<uint32_t>> placedByHeap;
+    std::vector<std::pair<uint64_t, uint64_t>> busy;
+    for (uint32_t index : order)
+    {
+        const TransientResourceDesc& desc = mResources[index];
+        TransientPlacement& placement = plan.Placements[index];
+
+        uint32_t heap = 0;
+        while (heap < plan.Heaps.size() && plan.Heaps[heap].HeapKind != desc.HeapKind)
+        {
+            ++heap;
+        }
+        if (heap == plan.Heaps.size())
+        {
+            TransientHeapDesc heapDesc;
+            heapDesc.HeapKind = desc.HeapKind;
+            plan.Heaps.push_back(heapDesc);
+            placedByHeap.emplace_back();
+        }
+
+        //与当前资源同时存活的资源占用的区间，按偏移排序后找第一个放得下的空隙
+        busy.clear();
+        for (uint32_t other : placedByHeap[heap])
+        {
+            if (LifetimesOverlap(plan.Placements[other], placement))
+            {
+                busy.push_back(std::make_pair(plan.Placements[other].Offset, mResources[other].Size));
+            }
+        }
+        std::sort(busy.begin(), busy.end());
+
+        uint64_t offset = 0;
+        for (const auto& range : busy)
+        {
+            if (AlignUp(offset, desc.Alignment) + desc.Size <= range.first)
+            {
+                break;
+            }
+            offset = std::max(offset, range.first + range.second);
+        }
+        offset = AlignUp(offset, desc.Alignment);
+
+        placement.Heap = heap;
+        placement.Offset = offset;
+        placedByHeap[heap].push_back(index);
+
+        TransientHeapDesc& heapDesc = plan.Heaps[heap];
+        heapDesc.Size = std::max(heapDesc.Size, offset + desc.Size);
+        heapDesc.Alignment = std::max(heapDesc.Alignment, desc.Alignment);
+    }
+
+    for (const TransientHeapDesc& heap : plan.Heaps)
+    {
+        plan.TotalBytes += heap.Size;
+    }
+
+    //资源第一次使用前，与之内存重叠、已经不再使用的资源需要失效：只有一个时写明，多个时用AnyResource
+    for (uint32_t index : order)
+    {
+        const TransientPlacement& placement = plan.Placements[index];
+        uint32_t before = TransientAliasingBarrier::AnyResource;
+        uint32_t predecessors = 0;
+        for (uint32_t other : placedByHeap[placement.Heap])
+        {
+            const TransientPlacement& otherPlacement = plan.Placements[other];
+            if (other != index && otherPlacement.LastPass < placement.FirstPass &&
+                RangesOverlap(placement.Offset, mResources[index].Size, otherPlacement.Offset, mResources[other].Size))
+            {
+                before = other;
+                ++predecessors;
+            }
+        }
+        if (predecessors == 0)
+        {
+            continue;
+        }
+
+        TransientAliasingBarrier barrier;
+        barrier.Pass = placement.FirstPass;
+        barrier.Before = predecessors == 1 ? before : TransientAliasingBarrier::AnyResource;
+        barrier.After = index;
+        plan.Barriers.push_back(barrier);
+    }
+    std::sort(plan.Barriers.begin(), plan.Barriers.end(),
+        [](const TransientAliasingBarrier& a, const TransientAliasingBarrier& b)
+    {
+        return a.Pass != b.Pass ? a.Pass < b.Pass : a.After < b.After;
+    });
+}
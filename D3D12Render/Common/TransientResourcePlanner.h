@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//一个帧内临时资源(后处理的中间渲染目标等)的内存需求
+struct TransientResourceDesc
+{
+    uint64_t Size = 0;          //D3D12中为GetResourceAllocationInfo返回的大小与对齐
+    uint64_t Alignment = 65536;
+    //只有同一类的资源才能放在同一个堆中(如渲染目标/深度与其他纹理、缓冲区分开，多重采样资源单独一类)
+    uint32_t HeapKind = 0;
+};
+
+struct TransientPlacement
+{
+    uint32_t Heap = 0;          //TransientMemoryPlan::Heaps中的下标
+    uint64_t Offset = 0;
+    uint32_t FirstPass = 0;     //生存期[FirstPass, LastPass]，没有被任何pass使用时Heap为NoHeap
+    uint32_t LastPass = 0;
+};
+
+//在pass开始前插入：After开始使用之前与其内存重叠、已经不再使用的资源
+struct TransientAliasingBarrier
+{
+    static const uint32_t AnyResource = ~0u;
+
+    uint32_t Pass = 0;
+    uint32_t Before = AnyResource;  //唯一的前一个占用者；有多个时为AnyResource(对应D3D12中pResourceBefore为空)
+    uint32_t After = 0;
+};
+
+struct TransientHeapDesc
+{
+    uint32_t HeapKind = 0;
+    uint64_t Size = 0;
+    uint64_t Alignment = 0;     //放在其中的资源对齐的最大值
+};
+
+struct TransientMemoryPlan
+{
+    static const uint32_t NoHeap = ~0u;
+
+    std::vector<TransientPlacement> Placements;         //与资源一一对应
+    std::vector<TransientHeapDesc> Heaps;               //每类一个
+    std::vector<TransientAliasingBarrier> Barriers;     //按Pass排序
+    uint64_t TotalBytes = 0;    //所有堆的大小之和
+    uint64_t NaiveBytes = 0;    //每个资源单独分配时的大小之和
+};
+
+//帧图的内存规划，与平台无关：按pass列表计算每个临时资源的生存期，
+//生存期不重叠的资源在同一个堆中分配重叠的偏移，并给出复用内存时需要的aliasing barrier
+//按大小从大到小依次放置，每个资源放在与其生存期重叠的资源之间最低的空隙中
+class TransientResourcePlanner
+{
+public:
+    uint32_t AddResource(const TransientResourceDesc& desc);
+    //按执行顺序添加pass，resources为它读写的临时资源
+    uint32_t AddPass(const uint32_t* resources, size_t count);
+
+    void Clear();
+
+    void Build(TransientMemoryPlan& plan) const;
+
+    size_t GetResourceCount() const { return mResources.size(); }
+    size_t GetPassCount() const { return mPassCount; }
+
+private:
+    std::vector<TransientResourceDesc> mResources;
+    std::vector<TransientPlacement> mLifetimes;
+    uint32_t mPassCount = 0;
+};
@@ -0,0 +1,146 @@
+#include "VertexLayout.h"
+
+#include <cstring>
+
+const VertexElement* VertexLayout::FindElement(StringId semantic, uint32_t semanticIndex) const
+{
+    for (const VertexElement& element : mElements)
+    {
+        if (element.Semantic == semantic && element.SemanticIndex == semanticIndex)
+        {
+            return &element;
+        }
+    }
+    return nullptr;
+}
+
+void VertexLayout::AddElement(StringId semantic, uint32_t semanticIndex, DXGI_FORMAT format,
+    uint32_t size, uint32_t sourceOffset, uint32_t stream)
+{
+    assert(stream < MaxStreams);
+    assert(FindElement(semantic, semanticIndex) == nullptr);
+
+    VertexElement element;
+    element.Semantic = semantic;
+    element.SemanticIndex = semanticIndex;
+    element.Format = format;
+    element.Size = size;
+    element.SourceOffset = sourceOffset;
+    element.Stream = stream;
+    mElements.push_back(element);
+}
+
+void VertexLayout::Finalize(uint32_t sourceStride)
+{
+    mSourceStride = sourceStride;
+    mStreamStrides.clear();
+    mStreamMask = 0;
+
+    for (VertexElement& element : mElements)
+    {
+        if (element.Stream >= mStreamStrides.size())
+        {
+            mStreamStrides.resize(element.Stream + 1, 0);
+        }
+        element.StreamOffset = mStreamStrides[element.Stream];
+        mStreamStrides[element.Stream] += element.Size;
+        mStreamMask |= 1u << element.Stream;
+    }
+    BuildRuns();
+}
+
+void VertexLayout::BuildRuns()
+{
+    mRuns.clear();
+    for (const VertexElement& element : mElements)
+    {
+        if (!mRuns.empty())
+        {
+            CopyRun& last = mRuns.back();
+            if (last.Stream == element.Stream &&
+                last.SourceOffset + last.Size == element.SourceOffset &&
+                last.StreamOffset + last.Size == element.StreamOffset)
+            {
+                last.Size += element.Size;
+                continue;
+            }
+        }
+
+        CopyRun run;
+        run.SourceOffset = element.SourceOffset;
+        run.Stream = element.Stream;
+        run.StreamOffset = element.StreamOffset;
+        run.Size = element.Size;
+        mRuns.push_back(run);
+    }
+}
+
+void VertexLayout::Split(const void* vertices, size_t count, std::vector<std::vector<uint8_t>>& streams) const
+{
+    const uint32_t streamCount = GetStreamCount();
+    streams.resize(streamCount);
+
+    std::vector<uint8_t*> dst(streamCount, nullptr);
+    for (uint32_t i = 0; i < streamCount; ++i)
+    {
+        //子布局中未使用的部分保持为0
+        streams[i].assign((size_t)mStreamStrides[i] * count, 0);
+        dst[i] = streams[i].data();
+    }
+
+    const uint8_t* src = static_cast<const uint8_t*>(vertices);
+    for (size_t v = 0; v < count; ++v)
+    {
+        const uint8_t* vertex = src + v * mSourceStride;
+        for (const CopyRun& run : mRuns)
+        {
+            memcpy(dst[run.Stream] + v * mStreamStrides[run.Stream] + run.StreamOffset,
+                vertex + run.SourceOffset, run.Size);
+        }
+    }
+}
+
+void VertexLayout::Interleave(const void* const* streams, size_t count, void* vertices) const
+{
+    uint8_t* dst = static_cast<uint8_t*>(vertices);
+    for (size_t v = 0; v < count; ++v)
+    {
+        uint8_t* vertex = dst + v * mSourceStride;
+        for (const CopyRun& run : mRuns)
+        {
+            const uint8_t* stream = static_cast<const uint8_t*>(streams[run.Stream]);
+            assert(stream != nullptr);
+            memcpy(vertex + run.SourceOffset,
+                stream + v * mStreamStrides[run.Stream] + run.StreamOffset, run.Size);
+        }
+    }
+}
+
+VertexLayout VertexLayout::Select(std::initializer_list<const char*> semantics) const
+{
+    VertexLayout layout;
+    layout.mSourceStride = mSourceStride;
+    layout.mStreamStrides = mStreamStrides;
+
+    for (const VertexElement& element : mElements)
+    {
+        const std::string& name = StringTable::GetString(element.Semantic);
+        for (const char* semantic : semantics)
+        {
+            if (name == semantic)
+            {
+                layout.mElements.push_back(element);
+                layout.mStreamMask |= 1u << element.Stream;
+                break;
+            }
+        }
+    }
+
+    //末尾不再使用的流去掉，中间的保留步长以保持流索引不变
+    while (!layout.mStreamStrides.empty() && !layout.UsesStream((uint32_t)layout.mStreamStrides.size() - 1))
+    {
+        layout.mStreamStrides.pop_back();
+    }
+    layout.BuildRuns();
+    return layout;
+}
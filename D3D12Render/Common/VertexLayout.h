@@ -0,0 +1,168 @@
+#pragma once
+
+#include <dxgiformat.h>
+#include <DirectXMath.h>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <type_traits>
+#include <vector>
+#include "StringTable.h"
+
+//顶点成员类型到DXGI格式的映射，未特化的类型在编译期报错
+template<typename T>
+struct VertexFormatTraits
+{
+    static_assert(sizeof(T) == 0, "VertexFormatTraits: unsupported vertex member type");
+};
+
+#define VERTEX_FORMAT_TRAITS(type, format) \
+    template<> struct VertexFormatTraits<type> { static const DXGI_FORMAT Format = format; }
+
+VERTEX_FORMAT_TRAITS(float, DXGI_FORMAT_R32_FLOAT);
+VERTEX_FORMAT_TRAITS(DirectX::XMFLOAT2, DXGI_FORMAT_R32G32_FLOAT);
+VERTEX_FORMAT_TRAITS(DirectX::XMFLOAT3, DXGI_FORMAT_R32G32B32_FLOAT);
+VERTEX_FORMAT_TRAITS(DirectX::XMFLOAT4, DXGI_FORMAT_R32G32B32A32_FLOAT);
+VERTEX_FORMAT_TRAITS(uint32_t, DXGI_FORMAT_R32_UINT);
+VERTEX_FORMAT_TRAITS(DirectX::XMUINT2, DXGI_FORMAT_R32G32_UINT);
+VERTEX_FORMAT_TRAITS(DirectX::XMUINT3, DXGI_FORMAT_R32G32B32_UINT);
+VERTEX_FORMAT_TRAITS(DirectX::XMUINT4, DXGI_FORMAT_R32G32B32A32_UINT);
+VERTEX_FORMAT_TRAITS(int32_t, DXGI_FORMAT_R32_SINT);
+VERTEX_FORMAT_TRAITS(DirectX::XMINT2, DXGI_FORMAT_R32G32_SINT);
+VERTEX_FORMAT_TRAITS(DirectX::XMINT3, DXGI_FORMAT_R32G32B32_SINT);
+VERTEX_FORMAT_TRAITS(DirectX::XMINT4, DXGI_FORMAT_R32G32B32A32_SINT);
+
+#undef VERTEX_FORMAT_TRAITS
+
+//顶点结构体中的一个成员，以及它在拆分后所属的流
+struct VertexElement
+{
+    StringId Semantic;
+    uint32_t SemanticIndex = 0;
+    DXGI_FORMAT Format = DXGI_FORMAT_UNKNOWN;
+    uint32_t Size = 0;
+
+    //在交错的顶点结构体中的偏移
+    uint32_t SourceOffset = 0;
+
+    //所属的流(输入槽)以及在该流的一个顶点中的偏移
+    uint32_t Stream = 0;
+    uint32_t StreamOffset = 0;
+};
+
+template<typename V>
+class VertexLayoutBuilder;
+
+//声明式的多流顶点布局：由交错的顶点结构体描述每个成员的语义与所属的流，
+//用于生成输入布局、把交错的顶点数据拆分为多个流(或反过来合并)，以及为只需部分语义的pass生成子布局
+//例如位置单独一个流，深度预pass与阴影pass只绑定位置流，顶点读取的带宽只有完整顶点的一部分
+class VertexLayout
+{
+public:
+    //D3D12的输入槽数量
+    static const uint32_t MaxStreams = 16;
+
+    //VertexLayout::For<Vertex>().Add(&Vertex::Pos, "POSITION", 0).Add(&Vertex::Color, "COLOR", 1).Build()
+    template<typename V>
+    static VertexLayoutBuilder<V> For();
+
+    //流的数量为用到的最大流索引加一，中间未使用的流步长为0(Select得到的子布局保留原来的步长)
+    uint32_t GetStreamCount() const { return (uint32_t)mStreamStrides.size(); }
+    uint32_t GetStreamStride(uint32_t stream) const { return stream < mStreamStrides.size() ? mStreamStrides[stream] : 0; }
+    bool UsesStream(uint32_t stream) const { return (mStreamMask >> stream) & 1; }
+
+    //交错的顶点结构体的大小
+    uint32_t GetSourceStride() const { return mSourceStride; }
+
+    const std::vector<VertexElement>& GetElements() const { return mElements; }
+
+    //找不到时返回nullptr
+    const VertexElement* FindElement(StringId semantic, uint32_t semanticIndex = 0) const;
+
+    //把count个交错的顶点拆分到各个流中，streams[i]的大小为GetStreamStride(i) * count
+    void Split(const void* vertices, size_t count, std::vector<std::vector<uint8_t>>& streams) const;
+
+    //Split的逆操作，streams[i]为第i个流的数据(未使用的流可以为nullptr)，结果写入count个交错的顶点
+    void Interleave(const void* const* streams, size_t count, void* vertices) const;
+
+    //只保留给定语义的子布局，元素的流索引、流内偏移以及流的步长都保持不变，
+    //因此可以直接绑定完整布局拆分出的缓冲区，只是未用到的流不再绑定
+    VertexLayout Select(std::initializer_list<const char*> semantics) const;
+
+private:
+    template<typename V>
+    friend class VertexLayoutBuilder;
+
+    void AddElement(StringId semantic, uint32_t semanticIndex, DXGI_FORMAT format,
+        uint32_t size, uint32_t sourceOffset, uint32_t stream);
+
+    //按添加顺序计算各元素在流中的偏移以及流的步长
+    void Finalize(uint32_t sourceStride);
+
+    //把源与目标都连续的相邻元素合并为一次拷贝
+    void BuildRuns();
+
+    //Split/Interleave中的一次内存拷贝
+    struct CopyRun
+    {
+        uint32_t SourceOffset = 0;
+        uint32_t Stream = 0;
+        uint32_t StreamOffset = 0;
+        uint32_t Size = 0;
+    };
+
+    std::vector<VertexElement> mElements;
+    std::vector<CopyRun> mRuns;
+    std::vector<uint32_t> mStreamStrides;
+    uint32_t mStreamMask = 0;
+    uint32_t mSourceStride = 0;
+};
+
+//由顶点结构体的成员指针在编译期确定每个元素的格式与大小
+template<typename V>
+class VertexLayoutBuilder
+{
+    static_assert(std::is_standard_layout<V>::value, "VertexLayout: vertex type must be standard layout");
+    static_assert(std::is_default_constructible<V>::value, "VertexLayout: vertex type must be default constructible");
+
+public:
+    //元素在流中按添加顺序依次排列
+    template<typename M>
+    VertexLayoutBuilder& Add(M V::* member, const char* semantic, uint32_t stream = 0, uint32_t semanticIndex = 0)
+    {
+        mLayout.AddElement(StringTable::Intern(semantic), semanticIndex, VertexFormatTraits<M>::Format,
+            (uint32_t)sizeof(M), MemberOffset(member), stream);
+        return *this;
+    }
+
+    VertexLayout Build()
+    {
+        mLayout.Finalize((uint32_t)sizeof(V));
+        return mLayout;
+    }
+
+private:
+    //在一个构造好的V对象上取成员地址(成员指针不能用于offsetof)
+    template<typename M>
+    static uint32_t MemberOffset(M V::* member)
+    {
+        const V& object = GetInstance();
+        const char* base = reinterpret_cast<const char*>(&object);
+        return (uint32_t)(reinterpret_cast<const char*>(&(object.*member)) - base);
+    }
+
+    static const V& GetInstance()
+    {
+        static const V instance{};
+        return instance;
+    }
+
+    VertexLayout mLayout;
+};
+
+template<typename V>
+VertexLayoutBuilder<V> VertexLayout::For()
+{
+    return VertexLayoutBuilder<V>();
+}
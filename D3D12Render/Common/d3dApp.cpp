@@ -2,7 +2,7 @@
 #include "d3dApp.h"
 
 D3DApp* D3DApp::mApp = nullptr;
-D3DApp::D3DApp(HINSTANCE hInstance) :mhAppInst(hInstance)
+D3DApp::D3DApp(HINSTANCE hInstance) :mhAppInst(hInstance), mJobSystem(JobSystem::GetDefault()), mFramePipeline(mJobSystem)
 {
     assert(mApp == nullptr);
     mApp = this;
@@ -134,6 +134,13 @@ void D3DApp::CreateCommandObject()
     ThrowIfFailed(md3dDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&mDirectCmdListAlloc)));
     ThrowIfFailed(md3dDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, mDirectCmdListAlloc.Get(), nullptr, IID_PPV_ARGS(&mCommandList)));
     ThrowIfFailed(mCommandList->Close());
+
+    mCopyQueue = std::make_unique<CopyQueue>(md3dDevice.Get());
+
+    mRenderQueue = std::make_unique<D3D12RenderQueue>(mCommandQueue);
+    mRenderFence = std::make_unique<D3D12RenderFence>(md3dFence);
+
+    mRenderTargetPool = std::make_unique<RenderTargetPool>(md3dDevice.Get());
 }
 
 void D3DApp::CreateSwapChain()
@@ -160,35 +167,45 @@ void D3DApp::CreateSwapChain()
 
 void D3DApp::CreateRtvAndDsvDescriptorHeap()
 {
-    D3D12_DESCRIPTOR_HEAP_DESC RtvHeapDesc;
-    RtvHeapDesc.NumDescriptors = SwapChainBufferCount;
-    RtvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
-    RtvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
-    RtvHeapDesc.NodeMask = 0;
-    ThrowIfFailed(md3dDevice->CreateDescriptorHeap(&RtvHeapDesc, IID_PPV_ARGS(&mRtvHeap)));
-
-    D3D12_DESCRIPTOR_HEAP_DESC DsvHeapDesc;
-    DsvHeapDesc.NumDescriptors = 1;
-    DsvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_DSV;
-    DsvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
-    DsvHeapDesc.NodeMask = 0;
-    ThrowIfFailed(md3dDevice->CreateDescriptorHeap(&DsvHeapDesc, IID_PPV_ARGS(&mDsvHeap)));
+    mRtvAllocator = std::make_unique<DescriptorHeapAllocator>(md3dDevice.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_RTV, RtvHeapCapacity);
+    mDsvAllocator = std::make_unique<DescriptorHeapAllocator>(md3dDevice.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_DSV, DsvHeapCapacity);
+
+    //交换链与主深度缓冲区的描述符在整个程序运行期间保持不变，OnResize时只重新创建视图
+    if (!mRtvAllocator->Allocate(SwapChainBufferCount, mSwapChainRtvs) ||
+        !mDsvAllocator->Allocate(1, mDepthStencilDsv))
+    {
+        ThrowIfFailed(E_OUTOFMEMORY);
+    }
 }
 
 void D3DApp::FlushCommandQueue()
 {
     ++mCurrentFence;
 
-    ThrowIfFailed(mCommandQueue->Signal(md3dFence.Get(), mCurrentFence));
+    mRenderQueue->Signal(*mRenderFence, mCurrentFence);
+    mRenderFence->WaitForValue(mCurrentFence);
+}
 
-    if (md3dFence->GetCompletedValue() < mCurrentFence)
-    {
-        HANDLE eventHandle = CreateEventEx(nullptr, false, false, EVENT_ALL_ACCESS);
+void D3DApp::WaitForFramesInFlight()
+{
+    mRenderFence->WaitForValue(mCurrentFence);
+}
 
-        ThrowIfFailed(md3dFence->SetEventOnCompletion(mCurrentFence, eventHandle));
-        WaitForSingleObject(eventHandle, INFINITE);
-        CloseHandle(eventHandle);
+void D3DApp::ApplyPendingResize()
+{
+    mResizePending = false;
+    //拖动过程中可能回到原来的大小，或者只是移动了窗口
+    if (mClientWidth == mAppliedWidth && mClientHeight == mAppliedHeight && m4xMsaaState == mApplied4xMsaa)
+    {
+        return;
     }
+    OnResize();
+}
+
+void D3DApp::FlushBarriers()
+{
+    D3DBarrierRecorder barriers(mCommandList.Get());
+    mStateTracker.Flush(barriers);
 }
 
 D3DApp* D3DApp::GetApp()
@@ -232,6 +249,7 @@ int D3DApp::Run()
     MSG msg = { 0 };
     
     mTimer.Reset();
+    Profiler::Get().SetThreadName("Main");
 
     while (msg.message != WM_QUIT)
     {
@@ -246,9 +264,20 @@ int D3DApp::Run()
 
             if (!mAppPaused)
             {
+                //消息已经处理完，这一帧之前收到的所有WM_SIZE合并为一次调整
+                if (mResizePending)
+                {
+                    ApplyPendingResize();
+                }
                 CalculateFrameStats();
-                Update(mTimer);
-                Draw(mTimer);
+                Profiler::Get().BeginFrame();
+                //Update(mTimer);
+                //Draw(mTimer);
+                //串行模式下依次执行，流水线模式下下一帧的Update作为任务与本帧的Draw同时执行
+                mFramePipeline.RunFrame(
+                    [this](uint64_t, uint32_t slot) { PROFILE_SCOPE("Update"); mUpdateSlot = slot; Update(mTimer); },
+                    [this](uint64_t, uint32_t slot) { PROFILE_SCOPE("Draw"); mDrawSlot = slot; Draw(mTimer); });
+                Profiler::Get().EndFrame();
             }
             else
             {
@@ -265,20 +294,31 @@ void D3DApp::OnResize()
     assert(mdxgiSwapChain);
     assert(mDirectCmdListAlloc);
 
-    //重置之前确保命令队列中没有未执行的命令
-    FlushCommandQueue();
+    //交换链缓冲区在ResizeBuffers之前不能再被GPU使用：等待已经提交的帧完成即可，不需要再Signal一次
+    WaitForFramesInFlight();
+    mResizePending = false;
+    mAppliedWidth = mClientWidth;
+    mAppliedHeight = mClientHeight;
+    mApplied4xMsaa = m4xMsaaState;
+
+    //已经模拟好的下一帧使用的是旧的窗口大小，重新模拟
+    mFramePipeline.DiscardPending();
 
     //一定别忘记重置命令列表与命令分配器,打开命令列表，让其接受命令
     ThrowIfFailed(mDirectCmdListAlloc->Reset());
     ThrowIfFailed(mCommandList->Reset(mDirectCmdListAlloc.Get(), nullptr));
 
 
-    //重置所有相关资源
+    //重置所有相关资源，新资源可能复用旧资源的地址，先取消状态跟踪
     for (size_t i = 0;i != SwapChainBufferCount;++i)
     {
+        mStateTracker.Unregister(mSwapChainBuffer[i].Get());
         mSwapChainBuffer[i].Reset();
     }
+    mStateTracker.Unregister(mDepthStencilBuffer.Get());
     mDepthStencilBuffer.Reset();
+    //已经提交的帧都执行完了，旧深度缓冲区的堆可以立即复用
+    mRenderTargetPool->Release(mDepthStencilTarget, mCurrentFence);
 
     //重新设置交换链后台缓冲区大小
     ThrowIfFailed(mdxgiSwapChain->ResizeBuffers(
@@ -290,14 +330,13 @@ void D3DApp::OnResize()
     mCurrentBackBuffer = 0;
 
     //重新创建后台缓冲区描述符
-    CD3DX12_CPU_DESCRIPTOR_HANDLE RtvDescriptorHeapHandle(mRtvHeap->GetCPUDescriptorHandleForHeapStart());
     for (UINT i = 0;i != SwapChainBufferCount;++i)
     {
         //获取缓冲区资源
         ThrowIfFailed(mdxgiSwapChain->GetBuffer(i, IID_PPV_ARGS(&mSwapChainBuffer[i])));
+        mStateTracker.Register(mSwapChainBuffer[i].Get(), 1, D3D12_RESOURCE_STATE_PRESENT);
         //创建Rtv
-        md3dDevice->CreateRenderTargetView(mSwapChainBuffer[i].Get(), nullptr, RtvDescriptorHeapHandle);
-        RtvDescriptorHeapHandle.Offset(1, mRtvDescriptorSize);
+        md3dDevice->CreateRenderTargetView(mSwapChainBuffer[i].Get(), nullptr, mSwapChainRtvs.Cpu(i));
     }
 
     //创建深度/模板缓冲区及描述符
@@ -318,26 +357,37 @@ void D3DApp::OnResize()
     optClear.Format = mDepthStencilFormat;
     optClear.DepthStencil.Depth = 1.f;
     optClear.DepthStencil.Stencil = 0;
-    ThrowIfFailed(md3dDevice->CreateCommittedResource(
-        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT), 
-        D3D12_HEAP_FLAG_NONE, 
-        &DepthStencilBufferDesc, 
-        D3D12_RESOURCE_STATE_COMMON,
-        &optClear,
-        IID_PPV_ARGS(&mDepthStencilBuffer)));
+    //ThrowIfFailed(md3dDevice->CreateCommittedResource(
+    //    &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT), 
+    //    D3D12_HEAP_FLAG_NONE, 
+    //    &DepthStencilBufferDesc, 
+    //    D3D12_RESOURCE_STATE_DEPTH_WRITE,
+    //    &optClear,
+    //    IID_PPV_ARGS(&mDepthStencilBuffer)));
+    //放在池中的堆上，新大小能放进之前的堆时不分配显存；
+    //复用的堆上残留旧内容，placed的深度缓冲区第一次使用前必须清除(Draw每帧开始时都会清除)
+    mDepthStencilTarget = mRenderTargetPool->Create(DepthStencilBufferDesc, D3D12_RESOURCE_STATE_DEPTH_WRITE, &optClear,
+        md3dFence->GetCompletedValue());
+    mDepthStencilBuffer = mDepthStencilTarget.Resource;
+    //拖动时留下的空闲堆最多保留一个深度缓冲区的大小
+    mRenderTargetPool->Trim(md3dFence->GetCompletedValue(), mDepthStencilTarget.Capacity);
+    mStateTracker.Register(mDepthStencilBuffer.Get(), 1, D3D12_RESOURCE_STATE_DEPTH_WRITE);
 
     md3dDevice->CreateDepthStencilView(mDepthStencilBuffer.Get(), nullptr,DepthStencilView());
 
-    //转换资源状态
-    mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
-        mDepthStencilBuffer.Get(), D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_DEPTH_WRITE));
+    //转换资源状态(深度缓冲区直接以DEPTH_WRITE状态创建，不再需要COMMON到DEPTH_WRITE的转换)
+    //mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
+    //    mDepthStencilBuffer.Get(), D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_DEPTH_WRITE));
+    FlushBarriers();
     //将命令提交到命令队列，提交前要关闭命令列表
     ThrowIfFailed(mCommandList->Close());
     ID3D12CommandList* cmdsLists[] = { mCommandList.Get() };
     mCommandQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
 
-    //刷新队列，确保执行
-    FlushCommandQueue();
+    //不再刷新队列：之后的帧在同一个队列上按顺序执行；下一次OnResize重置mDirectCmdListAlloc之前会等待这个fence值
+    //FlushCommandQueue();
+    ++mCurrentFence;
+    mRenderQueue->Signal(*mRenderFence, mCurrentFence);
 
     //重置视口与裁剪矩形大小
     mScreenViewport.TopLeftX = 0;
@@ -366,6 +416,8 @@ bool D3DApp::Initialize()
 
     //进行一次OnResize以进行相关初始化
     OnResize();
+    //派生类的初始化会重置mDirectCmdListAlloc，等待初始化命令执行完毕
+    FlushCommandQueue();
 
     return true;
 }
@@ -407,24 +459,24 @@ LRESULT D3DApp::MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
                 mAppPaused = false;
                 mMinimized = false;
                 mMaximized = true;
-                OnResize();
+                RequestResize();
             }
             //如果窗口恢复大小
-            else if (wParam = SIZE_RESTORED)
+            else if (wParam == SIZE_RESTORED)
             {
                 //是否从最小化恢复
                 if (mMinimized)
                 {
                     mAppPaused = false;
                     mMinimized = false;
-                    OnResize();
+                    RequestResize();
                 }
                 //是否从最大化恢复
                 else if (mMaximized)
                 {
                     mAppPaused = false;
                     mMaximized = false;
-                    OnResize();
+                    RequestResize();
                 }
                 //是否正在调整窗口大小
                 else if (mResizing)
@@ -433,7 +485,7 @@ LRESULT D3DApp::MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
                 }
                 else
                 {
-                    OnResize();
+                    RequestResize();
                 }
             }
         }
@@ -449,7 +501,7 @@ LRESULT D3DApp::MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
         mAppPaused = false;
         mResizing = false;
         mTimer.Start();
-        OnResize();
+        RequestResize();
         return 0;
     case WM_DESTROY:
         PostQuitMessage(0);
@@ -486,12 +538,34 @@ LRESULT D3DApp::MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
         {
             Set4xMsaaState(!m4xMsaaState);
         }
+        else if ((int)wParam == VK_F3)
+        {
+            //导出最近若干帧的CPU时间线，用chrome://tracing或Perfetto打开
+            const std::wstring path = GetProfileTracePath();
+            const bool written = Profiler::Get().WriteChromeTrace(path);
+            OutputDebugString(((written ? L"***Profile trace: " : L"***Failed to write profile trace: ") + path + L"\n").c_str());
+        }
         return 0;
     }
     return DefWindowProc(hwnd,msg,wParam,lParam);
 }
 
 
+std::wstring D3DApp::GetProfileTracePath() const
+{
+    wchar_t modulePath[MAX_PATH] = {};
+    const DWORD length = GetModuleFileName(nullptr, modulePath, MAX_PATH);
+    //取不到或路径被截断时退回当前目录
+    std::wstring directory;
+    if (length != 0 && length < MAX_PATH)
+    {
+        directory.assign(modulePath, length);
+        const size_t slash = directory.find_last_of(L"\\/");
+        directory.resize(slash == std::wstring::npos ? 0 : slash + 1);
+    }
+    return directory + L"profile.json";
+}
+
 void D3DApp::CalculateFrameStats()
 {
     static int FrameCount = 0;
@@ -509,6 +583,16 @@ void D3DApp::CalculateFrameStats()
 
         std::wstring WindowText = mMainWindowCaption + L"  fps:  " + fpsStr + L"  mspf:  " + mspfStr;
 
+        //最近一帧的提交统计
+        ProfileFrame frame;
+        if (Profiler::Get().GetLastFrame(frame))
+        {
+            WindowText += L"  cpu:  " + std::to_wstring(frame.GetCpuMs()) +
+                L"  draws:  " + std::to_wstring(frame.Counters[(size_t)ProfileCounter::Draws]) +
+                L"  tris:  " + std::to_wstring(frame.Counters[(size_t)ProfileCounter::Triangles]) +
+                L"  barriers:  " + std::to_wstring(frame.Counters[(size_t)ProfileCounter::Barriers]);
+        }
+
         SetWindowText(mhMainWnd, WindowText.c_str());
 
         FrameCount = 0;
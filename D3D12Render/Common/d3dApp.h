@@ -7,6 +7,13 @@
 
 #include "d3dUtil.h"
 #include "GameTimer.h"
+#include "JobSystem.h"
+#include "FramePipeline.h"
+#include "DescriptorAllocator.h"
+#include "CopyQueue.h"
+#include "RenderTargetPool.h"
+#include "Profiler.h"
+#include "D3D12Backend.h"
 #include <Windowsx.h>
 
 //链接需要的D3D12库
@@ -40,6 +47,9 @@ public:
     bool Get4xMsaaState() const;
     void Set4xMsaaState(bool value);
 
+    //开启后Update(N+1)与Draw(N)并行执行，Update只能写入UpdateSlot()的快照，Draw只能读取DrawSlot()的快照
+    void SetPipelinedFrames(bool value) { mFramePipeline.SetPipelined(value); }
+
     //消息循环函数
     int Run();
 
@@ -66,6 +76,15 @@ protected:
     void CreateSwapChain();
 
     void FlushCommandQueue();
+    //等待已经提交的帧执行完毕，不再额外Signal
+    void WaitForFramesInFlight();
+
+    //记录需要按当前窗口大小调整缓冲区，在下一帧开始前统一执行一次(多次WM_SIZE合并为一次)
+    void RequestResize() { mResizePending = true; }
+    void ApplyPendingResize();
+
+    //把mStateTracker中缓存的状态转换用一次ResourceBarrier录制到mCommandList
+    void FlushBarriers();
 
     //获取当前后台缓冲区
     ID3D12Resource* CurrentBackBuffer() const 
@@ -76,16 +95,23 @@ protected:
     //获取当前后台缓冲区描述符
     D3D12_CPU_DESCRIPTOR_HANDLE CurrentBackBufferView() const
     {
-        return CD3DX12_CPU_DESCRIPTOR_HANDLE(mRtvHeap->GetCPUDescriptorHandleForHeapStart(), mCurrentBackBuffer, mRtvDescriptorSize);
+        return mSwapChainRtvs.Cpu(mCurrentBackBuffer);
     }
 
     D3D12_CPU_DESCRIPTOR_HANDLE DepthStencilView() const
     {
-        return mDsvHeap->GetCPUDescriptorHandleForHeapStart();
+        return mDepthStencilDsv.Cpu();
     }
 
     void CalculateFrameStats();
 
+    //F3导出的CPU时间线的路径：可执行文件所在目录下的profile.json，与启动时的当前目录无关
+    std::wstring GetProfileTracePath() const;
+
+    //本次Update写入、本次Draw读取的快照下标，取值范围[0, FramePipeline::SlotCount)
+    UINT UpdateSlot() const { return mUpdateSlot; }
+    UINT DrawSlot() const { return mDrawSlot; }
+
     void LogAdapters();
     void LogAdapterOutputs(IDXGIAdapter* adapter);
     void LogOutputDisplayModes(IDXGIOutput* Output, DXGI_FORMAT format);
@@ -100,11 +126,19 @@ protected:
     bool mMaximized = false;                    //应用程序是否最大化
     bool mResizing = false;                     //是否正在拖动窗口调整栏
     bool mFullscreenState = false;              //是否开启全屏模式
+    bool mResizePending = false;                //是否有尚未执行的缓冲区大小调整
 
     bool m4xMsaaState = false;                  //是否开启4X MSAA
     UINT m4xMsaaQuality = 0;                    //4X MSAA的质量级别
 
     GameTimer mTimer;
+    //每帧工作的任务调度器，Update/Draw中可以用它派生任务或ParallelFor
+    //使用进程内共享的JobSystem::GetDefault()，纹理处理与着色器编译也在其中执行
+    JobSystem& mJobSystem;
+    //Update与Draw两个阶段的调度(串行或流水线)
+    FramePipeline mFramePipeline;
+    UINT mUpdateSlot = 0;
+    UINT mDrawSlot = 0;
 
     Microsoft::WRL::ComPtr<IDXGIFactory4> mdxgiFactory;
     Microsoft::WRL::ComPtr<IDXGISwapChain> mdxgiSwapChain;
@@ -117,15 +151,35 @@ protected:
     Microsoft::WRL::ComPtr<ID3D12CommandQueue> mCommandQueue;
     Microsoft::WRL::ComPtr<ID3D12CommandAllocator> mDirectCmdListAlloc;
     Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> mCommandList;
+    //上传用的COPY队列，与mCommandQueue并行执行
+    std::unique_ptr<CopyQueue> mCopyQueue;
+    //mCommandQueue与md3dFence在RenderBackend抽象下的包装；命令录制经由D3D12RenderCommandList包装各自的命令列表
+    std::unique_ptr<D3D12RenderQueue> mRenderQueue;
+    std::unique_ptr<D3D12RenderFence> mRenderFence;
 
     static const int SwapChainBufferCount = 2;
     int mCurrentBackBuffer = 0;
     Microsoft::WRL::ComPtr<ID3D12Resource> mSwapChainBuffer[SwapChainBufferCount];
     Microsoft::WRL::ComPtr<ID3D12Resource> mDepthStencilBuffer;
+    //深度缓冲区从池中分配，调整大小时复用之前的堆
+    std::unique_ptr<RenderTargetPool> mRenderTargetPool;
+    PooledRenderTarget mDepthStencilTarget;
+    //上一次OnResize使用的大小与MSAA设置，没有变化时跳过
+    int mAppliedWidth = 0;
+    int mAppliedHeight = 0;
+    bool mApplied4xMsaa = false;
+
+    //交换链缓冲区与深度缓冲区的当前状态，OnResize中登记
+    ResourceStateTracker mStateTracker;
 
     //缓冲区描述符堆
-    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> mRtvHeap;      //渲染目标描述符堆
-    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> mDsvHeap;      //深度/模板缓冲区描述符堆
+    //容量留有余量，交换链之外的渲染目标(离屏、阴影图等)也从中分配
+    static const UINT RtvHeapCapacity = 64;
+    static const UINT DsvHeapCapacity = 16;
+    std::unique_ptr<DescriptorHeapAllocator> mRtvAllocator;     //渲染目标描述符堆
+    std::unique_ptr<DescriptorHeapAllocator> mDsvAllocator;     //深度/模板缓冲区描述符堆
+    DescriptorAllocation mSwapChainRtvs;                        //交换链各缓冲区的RTV
+    DescriptorAllocation mDepthStencilDsv;
 
     //Viewport
     D3D12_VIEWPORT mScreenViewport;
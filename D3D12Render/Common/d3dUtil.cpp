@@ -1,10 +1,81 @@
 ﻿#include "d3dUtil.h"
 
 #include <comdef.h>
-#include <fstream>
+#include "MappedFile.h"
+#include "Profiler.h"
 
 using Microsoft::WRL::ComPtr;
 
+namespace
+{
+    //引用外部内存(文件映射、缓存中的字节码等)的只读ID3DBlob，owner保证内存在blob释放之前有效
+    class ViewBlob : public ID3DBlob
+    {
+    public:
+        ViewBlob(std::shared_ptr<const void> owner, const void* data, size_t size) :
+            mOwner(std::move(owner)),
+            mData(data),
+            mSize(size)
+        {
+        }
+
+        virtual ~ViewBlob() = default;
+
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** object) override
+        {
+            if (object == nullptr)
+                return E_POINTER;
+
+            if (riid == __uuidof(IUnknown) || riid == __uuidof(ID3D10Blob))
+            {
+                *object = static_cast<ID3DBlob*>(this);
+                AddRef();
+                return S_OK;
+            }
+
+            *object = nullptr;
+            return E_NOINTERFACE;
+        }
+
+        ULONG STDMETHODCALLTYPE AddRef() override
+        {
+            return static_cast<ULONG>(InterlockedIncrement(&mRefCount));
+        }
+
+        ULONG STDMETHODCALLTYPE Release() override
+        {
+            ULONG count = static_cast<ULONG>(InterlockedDecrement(&mRefCount));
+            if (count == 0)
+                delete this;
+            return count;
+        }
+
+        //接口要求返回非const指针，但内存是只读的(文件映射写入会导致访问违规)
+        LPVOID STDMETHODCALLTYPE GetBufferPointer() override
+        {
+            return const_cast<void*>(mData);
+        }
+
+        SIZE_T STDMETHODCALLTYPE GetBufferSize() override
+        {
+            return mSize;
+        }
+
+    private:
+        volatile LONG mRefCount = 1;
+        std::shared_ptr<const void> mOwner;
+        const void* mData = nullptr;
+        size_t mSize = 0;
+    };
+
+    ComPtr<ID3DBlob> CreateViewBlob(std::shared_ptr<const void> owner, const void* data, size_t size)
+    {
+        ComPtr<ID3DBlob> blob;
+        blob.Attach(new ViewBlob(std::move(owner), data, size));
+        return blob;
+    }
+}
+
 DxException::DxException(HRESULT hr, const std::wstring& functionName, const std::wstring& filename, int lineNumber) :
     ErrorCode(hr),
     FunctionName(functionName),
@@ -20,24 +91,21 @@ bool d3dUtil::IsKeyDown(int vkeyCode)
 
 ComPtr<ID3DBlob> d3dUtil::LoadBinary(const std::wstring& filename)
 {
-    std::ifstream fin(filename, std::ios::binary);
-
-    fin.seekg(0, std::ios_base::end);
-    std::ifstream::pos_type size = (int)fin.tellg();
-    fin.seekg(0, std::ios_base::beg);
-
-    ComPtr<ID3DBlob> blob;
-    ThrowIfFailed(D3DCreateBlob(size, blob.GetAddressOf()));
+    auto file = std::make_shared<MappedFile>();
+    if (!file->Open(filename))
+    {
+        ThrowIfFailed(HRESULT_FROM_WIN32(file->GetError()));
+    }
 
-    fin.read((char*)blob->GetBufferPointer(), size);
-    fin.close();
-
-    return blob;
+    const void* data = file->GetData();
+    const size_t size = file->GetSize();
+    return CreateViewBlob(std::move(file), data, size);
 }
 
 Microsoft::WRL::ComPtr<ID3D12Resource> d3dUtil::CreateDefaultBuffer(
     ID3D12Device* device,
     ID3D12GraphicsCommandList* cmdList,
+    ResourceStateTracker& stateTracker,
     const void* initData,
     UINT64 byteSize,
     Microsoft::WRL::ComPtr<ID3D12Resource>& uploadBuffer)
@@ -73,11 +141,16 @@ Microsoft::WRL::ComPtr<ID3D12Resource> d3dUtil::CreateDefaultBuffer(
     // Schedule to copy the data to the default buffer resource.  At a high level, the helper function UpdateSubresources
     // will copy the CPU memory into the intermediate upload heap.  Then, using ID3D12CommandList::CopySubresourceRegion,
     // the intermediate upload heap data will be copied to mBuffer.
-    cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(defaultBuffer.Get(),
-        D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST));
+    //两次状态转换都由调用者的ResourceStateTracker产生，不依赖COMMON到COPY_DEST的隐式提升，
+    //缓冲区保持登记，之后的转换从GENERIC_READ开始
+    D3DBarrierRecorder barriers(cmdList);
+    stateTracker.Register(defaultBuffer.Get(), 1, D3D12_RESOURCE_STATE_COMMON);
+    stateTracker.Transition(defaultBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST);
+    stateTracker.Flush(barriers);
     UpdateSubresources<1>(cmdList, defaultBuffer.Get(), uploadBuffer.Get(), 0, 0, 1, &subResourceData);
-    cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(defaultBuffer.Get(),
-        D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ));
+    Profiler::Get().AddCounter(ProfileCounter::BytesUploaded, byteSize);
+    stateTracker.Transition(defaultBuffer.Get(), D3D12_RESOURCE_STATE_GENERIC_READ);
+    stateTracker.Flush(barriers);
 
     // Note: uploadBuffer has to be kept alive after the above function calls because
     // the command list has not been executed yet that performs the actual copy.
@@ -113,6 +186,134 @@ ComPtr<ID3DBlob> d3dUtil::CompileShader(
     return byteCode;
 }
 
+ComPtr<ID3DBlob> d3dUtil::CompileShaderCached(
+    const std::wstring& filename,
+    const D3D_SHADER_MACRO* defines,
+    const std::string& entrypoint,
+    const std::string& target)
+{
+    ShaderCompileResult result;
+    result.ByteCode = GetShaderCache().Compile(MakeShaderDesc(filename, defines, entrypoint, target), &result.Errors);
+    return ToBlob(result);
+}
+
+std::vector<std::shared_future<ShaderCompileResult>> d3dUtil::CompileShaderBatch(
+    const std::vector<ShaderCompileDesc>& permutations)
+{
+    return GetShaderCache().CompileBatch(permutations, JobSystem::GetDefault());
+}
+
+ShaderCompileDesc d3dUtil::MakeShaderDesc(
+    const std::wstring& filename,
+    const D3D_SHADER_MACRO* defines,
+    const std::string& entrypoint,
+    const std::string& target)
+{
+    ShaderCompileDesc desc;
+    desc.Path = filename;
+    desc.EntryPoint = entrypoint;
+    desc.Target = target;
+#if defined(DEBUG) || defined(_DEBUG)  
+    desc.Flags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#endif
+    for (const D3D_SHADER_MACRO* define = defines; define != nullptr && define->Name != nullptr; ++define)
+    {
+        desc.Defines.push_back({ define->Name, define->Definition != nullptr ? define->Definition : "" });
+    }
+    return desc;
+}
+
+ComPtr<ID3DBlob> d3dUtil::ToBlob(const ShaderCompileResult& result)
+{
+    if (!result.Errors.empty())
+        OutputDebugStringA(result.Errors.c_str());
+
+    if (result.ByteCode == nullptr)
+        ThrowIfFailed(E_FAIL);
+
+    return CreateViewBlob(result.ByteCode, result.ByteCode->data(), result.ByteCode->size());
+}
+
+ShaderCache& d3dUtil::GetShaderCache()
+{
+    static D3DShaderCompiler compiler;
+    static ShaderCache cache(&compiler, L"ShaderCache");
+    return cache;
+}
+
+std::vector<D3D12_INPUT_ELEMENT_DESC> d3dUtil::MakeInputLayout(const VertexLayout& layout)
+{
+    std::vector<D3D12_INPUT_ELEMENT_DESC> inputLayout;
+    inputLayout.reserve(layout.GetElements().size());
+    for (const VertexElement& element : layout.GetElements())
+    {
+        D3D12_INPUT_ELEMENT_DESC desc;
+        desc.SemanticName = StringTable::GetString(element.Semantic).c_str();
+        desc.SemanticIndex = element.SemanticIndex;
+        desc.Format = element.Format;
+        desc.InputSlot = element.Stream;
+        desc.AlignedByteOffset = element.StreamOffset;
+        desc.InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA;
+        desc.InstanceDataStepRate = 0;
+        inputLayout.push_back(desc);
+    }
+    return inputLayout;
+}
+
+void D3DBarrierRecorder::ResourceBarrier(uint32_t count, const ResourceTransition* transitions)
+{
+    static_assert(ResourceStateTracker::AllSubresources == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, "subresource mismatch");
+    static_assert((UINT)ResourceBarrierSplit::BeginOnly == D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY, "flag mismatch");
+    static_assert((UINT)ResourceBarrierSplit::EndOnly == D3D12_RESOURCE_BARRIER_FLAG_END_ONLY, "flag mismatch");
+
+    mBarriers.resize(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const ResourceTransition& transition = transitions[i];
+        mBarriers[i] = CD3DX12_RESOURCE_BARRIER::Transition(
+            static_cast<ID3D12Resource*>(const_cast<void*>(transition.Resource)),
+            static_cast<D3D12_RESOURCE_STATES>(transition.StateBefore),
+            static_cast<D3D12_RESOURCE_STATES>(transition.StateAfter),
+            transition.Subresource,
+            static_cast<D3D12_RESOURCE_BARRIER_FLAGS>(transition.Split));
+    }
+    mCmdList->ResourceBarrier(count, mBarriers.data());
+    Profiler::Get().AddCounter(ProfileCounter::Barriers, count);
+}
+
+bool D3DShaderCompiler::Compile(
+    const ShaderCompileDesc& desc,
+    const std::vector<uint8_t>& source,
+    std::vector<uint8_t>& byteCode,
+    std::string& errors)
+{
+    std::vector<D3D_SHADER_MACRO> macros;
+    for (const ShaderDefine& define : desc.Defines)
+    {
+        macros.push_back({ define.Name.c_str(), define.Definition.c_str() });
+    }
+    macros.push_back({ nullptr, nullptr });
+
+    //标准的include处理以sourceName所在的目录为基准查找包含文件
+    char sourceName[MAX_PATH] = {};
+    WideCharToMultiByte(CP_ACP, 0, desc.Path.c_str(), -1, sourceName, MAX_PATH, nullptr, nullptr);
+
+    ComPtr<ID3DBlob> code;
+    ComPtr<ID3DBlob> errorBlob;
+    HRESULT hr = D3DCompile(source.data(), source.size(), sourceName, macros.data(), D3D_COMPILE_STANDARD_FILE_INCLUDE,
+        desc.EntryPoint.c_str(), desc.Target.c_str(), desc.Flags, 0, &code, &errorBlob);
+
+    if (errorBlob != nullptr)
+        errors.assign((const char*)errorBlob->GetBufferPointer(), errorBlob->GetBufferSize());
+
+    if (FAILED(hr) || code == nullptr)
+        return false;
+
+    const uint8_t* data = (const uint8_t*)code->GetBufferPointer();
+    byteCode.assign(data, data + code->GetBufferSize());
+    return true;
+}
+
 std::wstring DxException::ToString()const
 {
     // Get the string description of the error code.
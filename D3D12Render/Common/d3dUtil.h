@@ -29,6 +29,11 @@
 #include "d3dx12.h"
 #include "DDSTextureLoader.h"
 #include "MathHelper.h"
+#include "ShaderCache.h"
+#include "NamedArray.h"
+#include "VertexLayout.h"
+#include "ResourceStateTracker.h"
+#include "RenderBackend.h"
 
 extern const int gNumFrameResources;
 
@@ -113,11 +118,14 @@ public:
         return (byteSize + 255) & ~255;
     }
 
+    //以只读内存映射的方式读取文件，返回的blob直接引用映射区域(不能写入)，打开或映射失败时抛出异常
     static Microsoft::WRL::ComPtr<ID3DBlob> LoadBinary(const std::wstring& filename);
 
+    //返回的缓冲区登记在stateTracker中，处于GENERIC_READ状态；使用者释放缓冲区前需要Unregister
     static Microsoft::WRL::ComPtr<ID3D12Resource> CreateDefaultBuffer(
         ID3D12Device* device,
         ID3D12GraphicsCommandList* cmdList,
+        ResourceStateTracker& stateTracker,
         const void* initData,
         UINT64 byteSize,
         Microsoft::WRL::ComPtr<ID3D12Resource>& uploadBuffer);
@@ -127,6 +135,58 @@ public:
         const D3D_SHADER_MACRO* defines,
         const std::string& entrypoint,
         const std::string& target);
+
+    //与CompileShader相同，但字节码以源文件(含#include)、宏、入口、目标与编译选项的哈希为键缓存在内存与磁盘上
+    //源文件未改变时之后的启动只需读取一次缓存文件
+    static Microsoft::WRL::ComPtr<ID3DBlob> CompileShaderCached(
+        const std::wstring& filename,
+        const D3D_SHADER_MACRO* defines,
+        const std::string& entrypoint,
+        const std::string& target);
+
+    //在JobSystem::GetDefault()中并行编译一组着色器排列(材质、光照等宏的组合)，结果同样经过缓存，相同的排列只编译一次
+    static std::vector<std::shared_future<ShaderCompileResult>> CompileShaderBatch(
+        const std::vector<ShaderCompileDesc>& permutations);
+
+    //由D3D_SHADER_MACRO列表生成ShaderCache使用的编译描述，编译选项与CompileShader一致
+    static ShaderCompileDesc MakeShaderDesc(
+        const std::wstring& filename,
+        const D3D_SHADER_MACRO* defines,
+        const std::string& entrypoint,
+        const std::string& target);
+
+    //把编译结果包装为ID3DBlob(引用缓存中的字节码，不拷贝)，有错误信息时输出到调试窗口，编译失败时抛出异常
+    static Microsoft::WRL::ComPtr<ID3DBlob> ToBlob(const ShaderCompileResult& result);
+
+    //CompileShaderCached使用的缓存，磁盘缓存目录默认为工作目录下的ShaderCache
+    static ShaderCache& GetShaderCache();
+
+    //由顶点布局生成输入布局，InputSlot为元素所属的流。语义名指向StringTable中的字符串，一直有效
+    static std::vector<D3D12_INPUT_ELEMENT_DESC> MakeInputLayout(const VertexLayout& layout);
+};
+
+//基于D3DCompile的编译器，供ShaderCache使用
+class D3DShaderCompiler : public IShaderCompiler
+{
+public:
+    virtual bool Compile(
+        const ShaderCompileDesc& desc,
+        const std::vector<uint8_t>& source,
+        std::vector<uint8_t>& byteCode,
+        std::string& errors) override;
+};
+
+//ResourceStateTracker::Flush的D3D12实现：把一批转换换成D3D12_RESOURCE_BARRIER，用一次ResourceBarrier提交
+class D3DBarrierRecorder
+{
+public:
+    explicit D3DBarrierRecorder(ID3D12GraphicsCommandList* cmdList) : mCmdList(cmdList) {}
+
+    void ResourceBarrier(uint32_t count, const ResourceTransition* transitions);
+
+private:
+    ID3D12GraphicsCommandList* mCmdList = nullptr;
+    std::vector<D3D12_RESOURCE_BARRIER> mBarriers;
 };
 
 class DxException
@@ -158,6 +218,9 @@ struct SubmeshGeometry
     DirectX::BoundingBox Bounds;
 };
 
+//子网格按名字登记一次，之后通过SubmeshHandle访问
+typedef NamedArray<SubmeshGeometry, SubmeshTag> SubmeshArray;
+
 struct MeshGeometry
 {
     // Give it a name so we can look it up by name.
@@ -182,8 +245,8 @@ struct MeshGeometry
 
     // A MeshGeometry may store multiple geometries in one vertex/index buffer.
     // Use this container to define the Submesh geometries so we can draw
-    // the Submeshes individually.
-    std::unordered_map<std::string, SubmeshGeometry> DrawArgs;
+    // the Submeshes individually.  Resolve names to handles once at build time.
+    SubmeshArray DrawArgs;
 
     D3D12_VERTEX_BUFFER_VIEW VertexBufferView()const
     {
@@ -213,6 +276,107 @@ struct MeshGeometry
     }
 };
 
+//顶点按VertexLayout拆分为多个流的网格，每个流一个顶点缓冲区
+//只需部分语义的pass(深度预pass、阴影)用Layout.Select得到的子布局绑定，只读取用到的流
+struct StreamMeshGeometry
+{
+    std::string Name;
+
+    VertexLayout Layout;
+
+    //按流索引，子布局与完整布局共用这些缓冲区
+    std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> VertexBufferGPU;
+    Microsoft::WRL::ComPtr<ID3D12Resource> IndexBufferGPU = nullptr;
+
+    //由BufferUploadBatch创建时，所有缓冲区是同一个堆中的placed resource，需要持有堆
+    Microsoft::WRL::ComPtr<ID3D12Heap> BufferHeap = nullptr;
+
+    UINT VertexCount = 0;
+    DXGI_FORMAT IndexFormat = DXGI_FORMAT_R16_UINT;
+    UINT IndexBufferByteSize = 0;
+
+    //构建时按名字登记，绘制时通过SubmeshHandle访问
+    SubmeshArray DrawArgs;
+
+    D3D12_VERTEX_BUFFER_VIEW VertexBufferView(UINT stream) const
+    {
+        D3D12_VERTEX_BUFFER_VIEW vbv;
+        vbv.BufferLocation = VertexBufferGPU[stream]->GetGPUVirtualAddress();
+        vbv.StrideInBytes = Layout.GetStreamStride(stream);
+        vbv.SizeInBytes = Layout.GetStreamStride(stream) * VertexCount;
+
+        return vbv;
+    }
+
+    D3D12_INDEX_BUFFER_VIEW IndexBufferView() const
+    {
+        D3D12_INDEX_BUFFER_VIEW ibv;
+        ibv.BufferLocation = IndexBufferGPU->GetGPUVirtualAddress();
+        ibv.Format = IndexFormat;
+        ibv.SizeInBytes = IndexBufferByteSize;
+
+        return ibv;
+    }
+
+    //layout用到的流中，每段连续的输入槽调用一次setVertexBuffers(first, count, views)
+    template<typename Func>
+    void ForEachStreamRange(const VertexLayout& layout, Func&& setVertexBuffers) const
+    {
+        D3D12_VERTEX_BUFFER_VIEW views[VertexLayout::MaxStreams];
+        UINT first = 0;
+        UINT count = 0;
+        for (UINT stream = 0; stream <= layout.GetStreamCount(); ++stream)
+        {
+            if (stream < layout.GetStreamCount() && layout.UsesStream(stream))
+            {
+                assert(layout.GetStreamStride(stream) == Layout.GetStreamStride(stream));
+                if (count == 0)
+                {
+                    first = stream;
+                }
+                views[count++] = VertexBufferView(stream);
+            }
+            else if (count > 0)
+            {
+                setVertexBuffers(first, count, views);
+                count = 0;
+            }
+        }
+    }
+
+    //绑定layout用到的流以及索引缓冲区，连续的输入槽合并为一次IASetVertexBuffers
+    void Bind(ID3D12GraphicsCommandList* cmdList, const VertexLayout& layout) const
+    {
+        ForEachStreamRange(layout, [cmdList](UINT first, UINT count, const D3D12_VERTEX_BUFFER_VIEW* views)
+        {
+            cmdList->IASetVertexBuffers(first, count, views);
+        });
+        D3D12_INDEX_BUFFER_VIEW ibv = IndexBufferView();
+        cmdList->IASetIndexBuffer(&ibv);
+    }
+
+    void Bind(ID3D12GraphicsCommandList* cmdList) const
+    {
+        Bind(cmdList, Layout);
+    }
+
+    //经由RenderBackend录制时使用，RenderVertexBufferView与RenderIndexBufferView的布局与D3D12的视图一致
+    void Bind(IRenderCommandList& list, const VertexLayout& layout) const
+    {
+        ForEachStreamRange(layout, [&list](UINT first, UINT count, const D3D12_VERTEX_BUFFER_VIEW* views)
+        {
+            list.IASetVertexBuffers(first, count, reinterpret_cast<const RenderVertexBufferView*>(views));
+        });
+        D3D12_INDEX_BUFFER_VIEW ibv = IndexBufferView();
+        list.IASetIndexBuffer(reinterpret_cast<const RenderIndexBufferView*>(&ibv));
+    }
+
+    void Bind(IRenderCommandList& list) const
+    {
+        Bind(list, Layout);
+    }
+};
+
 struct Light
 {
     DirectX::XMFLOAT3 Strength = { 0.5f, 0.5f, 0.5f };
@@ -275,6 +439,10 @@ struct Texture
     Microsoft::WRL::ComPtr<ID3D12Resource> UploadHeap = nullptr;
 };
 
+//材质与纹理同样按名字登记、按句柄访问
+typedef NamedArray<Material, MaterialTag> MaterialArray;
+typedef NamedArray<Texture, TextureTag> TextureArray;
+
 #ifndef ThrowIfFailed
 #define ThrowIfFailed(x)                                              \
 {                                                                     \
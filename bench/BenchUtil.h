@@ -0,0 +1,55 @@
+#pragma once
+
+//基准程序共用的计时与输出
+//每个基准都接受--quick参数，只运行很少的迭代次数，由ctest运行以保证基准程序本身可用
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include "Profiler.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+inline bool IsQuickRun(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--quick") == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+//返回func执行一次所用的秒数
+template<typename Func>
+double MeasureSeconds(Func&& func)
+{
+    const int64_t start = ProfilerClock::Now();
+    func();
+    const int64_t end = ProfilerClock::Now();
+    return double(end - start) / double(ProfilerClock::Frequency());
+}
+
+//输出一行结果：名称、总数、耗时以及每秒的数量
+inline void PrintRate(const char* name, double count, double seconds, const char* unit)
+{
+    const double rate = seconds > 0.0 ? count / seconds : 0.0;
+    std::printf("%-40s %12.0f %-10s %10.3f ms %14.0f %s/s\n", name, count, unit, seconds * 1000.0, rate, unit);
+}
+
+//阻止编译器把基准中的计算当作无用代码删除：value必须在这里存在于内存中，且之前的写入不能省略
+template<typename T>
+inline void DoNotOptimize(const T& value)
+{
+#if defined(_MSC_VER)
+    //MSVC的x64不支持内联汇编，改为对value做一次volatile读取，并阻止编译器跨过这里重排内存访问
+    static_cast<void>(*reinterpret_cast<const volatile char*>(&value));
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "r"(&value) : "memory");
+#endif
+}
@@ -0,0 +1,106 @@
+//DDS文件头解析与子资源布局计算的吞吐量，以及旧格式转码的速度
+
+#include <vector>
+#include "BenchUtil.h"
+#include "DDSFormat.h"
+#include "DDSTestFiles.h"
+#include "DDSTranscoder.h"
+
+namespace
+{
+    struct BenchFile
+    {
+        const char* Name;
+        std::vector<uint8_t> Data;
+    };
+
+    void BenchParse(const BenchFile& file, uint32_t iterations)
+    {
+        const DDS_HEADER* header = nullptr;
+        size_t offset = 0;
+        DDSTextureDesc desc;
+        size_t accepted = 0;
+
+        const double headerSeconds = MeasureSeconds([&]()
+        {
+            for (uint32_t i = 0; i < iterations; ++i)
+            {
+                if (DDSFormat::ParseHeader(file.Data.data(), file.Data.size(), &header, &offset) &&
+                    DDSFormat::GetTextureDesc(header, desc) == DDSParseResult::Ok)
+                {
+                    ++accepted;
+                }
+            }
+        });
+        DoNotOptimize(accepted);
+
+        std::vector<DDSSubresourceLayout> layouts;
+        size_t subresources = 0;
+        const double layoutSeconds = MeasureSeconds([&]()
+        {
+            for (uint32_t i = 0; i < iterations; ++i)
+            {
+                if (DDSFormat::ComputeLayout(desc, file.Data.size() - offset, layouts))
+                {
+                    subresources += layouts.size();
+                }
+            }
+        });
+        DoNotOptimize(subresources);
+
+        std::printf("%s (%zu bytes, %zu subresources)\n", file.Name, file.Data.size(), layouts.size());
+        PrintRate("  ParseHeader + GetTextureDesc", double(iterations), headerSeconds, "headers");
+        PrintRate("  ComputeLayout", double(iterations), layoutSeconds, "layouts");
+        PrintRate("  ComputeLayout subresources", double(subresources), layoutSeconds, "subres");
+    }
+
+    void BenchTranscode(const BenchFile& file, uint32_t iterations)
+    {
+        const DDS_HEADER* header = nullptr;
+        size_t offset = 0;
+        if (!DDSFormat::ParseHeader(file.Data.data(), file.Data.size(), &header, &offset))
+        {
+            return;
+        }
+
+        std::vector<uint8_t> transcoded;
+        const double seconds = MeasureSeconds([&]()
+        {
+            for (uint32_t i = 0; i < iterations; ++i)
+            {
+                DDSTranscoder::Transcode(*header, file.Data.data() + offset, file.Data.size() - offset, transcoded);
+            }
+        });
+        DoNotOptimize(transcoded);
+
+        std::printf("%s (%zu bytes)\n", file.Name, file.Data.size());
+        PrintRate("  Transcode", double(file.Data.size() - offset) * iterations / (1024.0 * 1024.0), seconds, "MB");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const bool quick = IsQuickRun(argc, argv);
+    const uint32_t parseIterations = quick ? 1000 : 2000000;
+    const uint32_t transcodeIterations = quick ? 1 : 20;
+
+    std::vector<BenchFile> files;
+    files.push_back({ "DX10 BC1 2048x2048 full mip chain",
+                      DDSTestFiles::MakeTexture2D(DXGI_FORMAT_BC1_UNORM, 2048, 2048, 1, 12) });
+    files.push_back({ "DX10 RGBA8 256x256 array[16]",
+                      DDSTestFiles::MakeTexture2D(DXGI_FORMAT_R8G8B8A8_UNORM, 256, 256, 16, 9) });
+    files.push_back({ "Legacy DXT1 cube 512",
+                      DDSTestFiles::MakeLegacyFile(DDSTestFiles::MakeFourCCFormat(MAKEFOURCC('D', 'X', 'T', '1')),
+                                                   512, 512, 1, 10, true, 0) });
+
+    for (const BenchFile& file : files)
+    {
+        BenchParse(file, parseIterations);
+    }
+
+    const BenchFile rgb24 = { "Legacy RGB24 1024x1024 full mip chain",
+        DDSTestFiles::MakeLegacyFile(DDSTestFiles::MakeRGBFormat(24, 0xff0000, 0x00ff00, 0x0000ff, 0),
+                                     1024, 1024, 1, 11, false, 24) };
+    BenchTranscode(rgb24, transcodeIterations);
+    return 0;
+}
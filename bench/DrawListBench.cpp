@@ -0,0 +1,129 @@
+//每帧构建绘制列表的开销：BoxApp原来的DrawArgs["name"]字符串查找、预先解析的句柄以及直接遍历连续数组
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "BenchUtil.h"
+#include "NamedArray.h"
+
+namespace
+{
+    //与d3dUtil.h中的SubmeshGeometry相同的字段
+    struct Submesh
+    {
+        uint32_t IndexCount = 0;
+        uint32_t StartIndexLocation = 0;
+        int BaseVertexLocation = 0;
+        float Bounds[6] = {};
+    };
+
+    struct DrawItem
+    {
+        uint32_t IndexCount;
+        uint32_t StartIndexLocation;
+        int BaseVertexLocation;
+    };
+
+    void Report(const char* name, uint32_t frames, uint32_t submeshCount, double seconds)
+    {
+        PrintRate(name, double(frames) * submeshCount, seconds, "draws");
+        std::printf("%-40s %10.1f ns/frame\n", "", seconds * 1e9 / frames);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const bool quick = IsQuickRun(argc, argv);
+    const uint32_t frames = quick ? 100 : 50000;
+    const uint32_t submeshCounts[] = { 4, 256 };
+
+    for (uint32_t submeshCount : submeshCounts)
+    {
+        std::unordered_map<std::string, Submesh> drawArgs;
+        NamedArray<Submesh, SubmeshTag> submeshes;
+        std::vector<std::string> names;
+        for (uint32_t i = 0; i < submeshCount; ++i)
+        {
+            //名字长度超过短字符串优化的范围，与实际资源名相近
+            names.push_back("Submesh_" + std::to_string(i) + "_StandardMaterial");
+            Submesh submesh;
+            submesh.IndexCount = 36 + i;
+            submesh.StartIndexLocation = i * 36;
+            submesh.BaseVertexLocation = int(i * 8);
+            drawArgs[names.back()] = submesh;
+            submeshes.Add(names.back(), submesh);
+        }
+
+        //构建时解析一次
+        std::vector<SubmeshHandle> handles;
+        for (const std::string& name : names)
+        {
+            handles.push_back(submeshes.Find(name));
+        }
+
+        std::vector<DrawItem> drawList;
+        drawList.reserve(submeshCount);
+        std::printf("%u submeshes per frame, %u frames\n", submeshCount, frames);
+
+        //BoxApp::Draw原来的写法：每个字段都用operator[]查找一次
+        double seconds = MeasureSeconds([&]()
+        {
+            for (uint32_t frame = 0; frame < frames; ++frame)
+            {
+                drawList.clear();
+                for (const std::string& name : names)
+                {
+                    drawList.push_back({ drawArgs[name].IndexCount, drawArgs[name].StartIndexLocation,
+                                         drawArgs[name].BaseVertexLocation });
+                }
+                DoNotOptimize(drawList.back());
+            }
+        });
+        Report("  DrawArgs[name] x3 per draw", frames, submeshCount, seconds);
+
+        seconds = MeasureSeconds([&]()
+        {
+            for (uint32_t frame = 0; frame < frames; ++frame)
+            {
+                drawList.clear();
+                for (const std::string& name : names)
+                {
+                    const Submesh& submesh = drawArgs.at(name);
+                    drawList.push_back({ submesh.IndexCount, submesh.StartIndexLocation, submesh.BaseVertexLocation });
+                }
+                DoNotOptimize(drawList.back());
+            }
+        });
+        Report("  DrawArgs.at(name) once per draw", frames, submeshCount, seconds);
+
+        seconds = MeasureSeconds([&]()
+        {
+            for (uint32_t frame = 0; frame < frames; ++frame)
+            {
+                drawList.clear();
+                for (SubmeshHandle handle : handles)
+                {
+                    const Submesh& submesh = submeshes[handle];
+                    drawList.push_back({ submesh.IndexCount, submesh.StartIndexLocation, submesh.BaseVertexLocation });
+                }
+                DoNotOptimize(drawList.back());
+            }
+        });
+        Report("  resolved SubmeshHandle", frames, submeshCount, seconds);
+
+        seconds = MeasureSeconds([&]()
+        {
+            for (uint32_t frame = 0; frame < frames; ++frame)
+            {
+                drawList.clear();
+                for (const Submesh& submesh : submeshes)
+                {
+                    drawList.push_back({ submesh.IndexCount, submesh.StartIndexLocation, submesh.BaseVertexLocation });
+                }
+                DoNotOptimize(drawList.back());
+            }
+        });
+        Report("  dense NamedArray iteration", frames, submeshCount, seconds);
+    }
+    return 0;
+}
@@ -0,0 +1,100 @@
+//FrameGraph在100个以上pass时的每帧开销：声明、完整编译，以及拓扑不变时声明加命中缓存的编译
+//每个pass读取前一个与一半位置的临时资源，写入自己的临时资源，最后一个pass写入后台缓冲区
+
+#include <string>
+#include <vector>
+#include "BenchUtil.h"
+#include "FrameGraph.h"
+
+namespace
+{
+    const uint32_t StatePresent = 0;
+    const uint32_t StateRenderTarget = 0x4;
+    const uint32_t StateDepthWrite = 0x10;
+    const uint32_t StateShaderResource = 0x40 | 0x80;
+
+    struct NullContext
+    {
+        void ResourceBarrier(uint32_t, const ResourceTransition*) {}
+        void AliasingBarrier(const void*, const void*) {}
+    };
+
+    typedef FrameGraph<NullContext> Graph;
+
+    void Declare(Graph& graph, const std::vector<std::string>& names, const void* backBuffer, const void* depthBuffer)
+    {
+        const int passCount = static_cast<int>(names.size());
+        graph.Reset();
+        const uint32_t back = graph.ImportResource("BackBuffer", backBuffer, StatePresent, StatePresent);
+        const uint32_t depth = graph.ImportResource("DepthStencil", depthBuffer, StateDepthWrite, StateDepthWrite);
+        std::vector<uint32_t> targets;
+        for (int i = 0; i < passCount; ++i)
+        {
+            TransientResourceDesc desc;
+            desc.Size = static_cast<uint64_t>(1 + i % 7) << 20;
+            targets.push_back(graph.CreateTransient("Target", desc));
+        }
+        for (int i = 0; i < passCount; ++i)
+        {
+            const char* name = names[i].c_str();
+            if (i == 0)
+            {
+                graph.AddPass(name, { { targets[0], StateRenderTarget, true }, { depth, StateDepthWrite, true } }, [](NullContext&) {});
+            }
+            else if (i == passCount - 1)
+            {
+                graph.AddPass(name, { { targets[i - 1], StateShaderResource, false }, { targets[i / 2], StateShaderResource, false },
+                    { back, StateRenderTarget, true } }, [](NullContext&) {});
+            }
+            else
+            {
+                graph.AddPass(name, { { targets[i - 1], StateShaderResource, false }, { targets[i / 2], StateShaderResource, false },
+                    { depth, StateDepthWrite, false }, { targets[i], StateRenderTarget, true } }, [](NullContext&) {});
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const bool quick = IsQuickRun(argc, argv);
+    const int iterations = quick ? 5 : 200;
+    int backBuffer = 0;
+    int depthBuffer = 0;
+
+    for (int passCount : { 128, 256, 1024 })
+    {
+        std::vector<std::string> names;
+        for (int i = 0; i < passCount; ++i)
+        {
+            names.push_back("Pass" + std::to_string(i));
+        }
+
+        Graph graph;
+        double declareSeconds = 0.0;
+        double compileSeconds = 0.0;
+        double cachedSeconds = 0.0;
+        for (int i = 0; i < iterations; ++i)
+        {
+            //先编译一个不同的图，使下一次编译不能命中缓存
+            graph.Reset();
+            graph.ImportResource("Other", &backBuffer, StateRenderTarget, StateRenderTarget);
+            graph.Compile();
+
+            declareSeconds += MeasureSeconds([&]() { Declare(graph, names, &backBuffer, &depthBuffer); });
+            compileSeconds += MeasureSeconds([&]() { graph.Compile(); });
+            cachedSeconds += MeasureSeconds([&]()
+            {
+                Declare(graph, names, &backBuffer, &depthBuffer);
+                graph.Compile();
+            });
+        }
+
+        std::printf("%4d passes: declare %8.1f us, compile %8.1f us, declare + cached compile %8.1f us, memory %llu of %llu MB, %llu cache hits\n",
+                    passCount, declareSeconds * 1e6 / iterations, compileSeconds * 1e6 / iterations, cachedSeconds * 1e6 / iterations,
+                    static_cast<unsigned long long>(graph.GetMemoryPlan().TotalBytes >> 20),
+                    static_cast<unsigned long long>(graph.GetMemoryPlan().NaiveBytes >> 20),
+                    static_cast<unsigned long long>(graph.GetStats().CacheHits));
+    }
+    return 0;
+}
@@ -0,0 +1,32 @@
+//串行与流水线模式的帧时间：模拟与录制各4ms(sleep模拟，不占用CPU)，流水线模式的帧时间应接近两者中较大的一个
+
+#include <chrono>
+#include <thread>
+#include "BenchUtil.h"
+#include "FramePipeline.h"
+
+int main(int argc, char** argv)
+{
+    const bool quick = IsQuickRun(argc, argv);
+    const int frames = quick ? 5 : 60;
+    const std::chrono::microseconds simulateCost(4000);
+    const std::chrono::microseconds recordCost(4000);
+
+    JobSystem jobs(2);
+    for (int pipelined = 0; pipelined < 2; ++pipelined)
+    {
+        FramePipeline pipeline(jobs);
+        pipeline.SetPipelined(pipelined != 0);
+        const double seconds = MeasureSeconds([&]()
+        {
+            for (int i = 0; i < frames; ++i)
+            {
+                pipeline.RunFrame([&](uint64_t, uint32_t) { std::this_thread::sleep_for(simulateCost); },
+                                  [&](uint64_t, uint32_t) { std::this_thread::sleep_for(recordCost); });
+            }
+        });
+        PrintRate(pipelined ? "pipelined Update/Draw" : "serial Update/Draw", frames, seconds, "frames");
+        std::printf("%-40s %10.2f ms/frame\n", "", seconds * 1000.0 / frames);
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+//JobSystem的微基准：派生空任务的开销、ParallelFor相对串行的加速以及负载不均衡时的窃取
+
+#include "BenchUtil.h"
+#include "JobSystem.h"
+
+namespace
+{
+    //忙等ns纳秒，模拟一段计算
+    void Spin(int64_t ns)
+    {
+        const int64_t end = ProfilerClock::Now() + ns * ProfilerClock::Frequency() / 1000000000;
+        while (ProfilerClock::Now() < end)
+        {
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const bool quick = IsQuickRun(argc, argv);
+    JobSystem jobs;
+    std::printf("%u worker threads\n", jobs.GetThreadCount());
+
+    {
+        const uint32_t count = quick ? 10000 : 200000;
+        JobCounter counter;
+        const double seconds = MeasureSeconds([&]()
+        {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                jobs.Run(counter, []() {});
+            }
+            jobs.Wait(counter);
+        });
+        PrintRate("Run + Wait (empty job)", count, seconds, "jobs");
+        std::printf("%-40s %10.1f ns/job\n", "", seconds * 1e9 / count);
+    }
+
+    {
+        //每项500ns，grain为64
+        const size_t count = quick ? 1000 : 20000;
+        const double serial = MeasureSeconds([&]()
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                Spin(500);
+            }
+        });
+        const double parallel = MeasureSeconds([&]()
+        {
+            jobs.ParallelFor(count, 64, [](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; ++i)
+                {
+                    Spin(500);
+                }
+            });
+        });
+        PrintRate("serial loop (500ns items)", double(count), serial, "items");
+        PrintRate("ParallelFor (500ns items)", double(count), parallel, "items");
+        std::printf("%-40s %10.2fx speedup\n", "", serial / parallel);
+    }
+
+    {
+        //前32项各200us，其余各1us：一个线程拿到的大块由空闲线程窃取分担
+        const size_t count = 1024;
+        const int64_t heavyNs = quick ? 20000 : 200000;
+        const uint64_t stolenBefore = jobs.GetStats().Stolen;
+        const double seconds = MeasureSeconds([&]()
+        {
+            jobs.ParallelFor(count, 1, [&](size_t begin, size_t) { Spin(begin < 32 ? heavyNs : 1000); });
+        });
+        const double serial = (32.0 * heavyNs + (count - 32) * 1000.0) / 1e9;
+        PrintRate("imbalanced ParallelFor", double(count), seconds, "items");
+        std::printf("%-40s %10.2fx speedup over %.1f ms serial, %llu jobs stolen\n", "", serial / seconds, serial * 1000.0,
+                    static_cast<unsigned long long>(jobs.GetStats().Stolen - stolenBefore));
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+//并行录制的扩展性：RecordingCommandList模拟每次调用的驱动开销，比较1/2/4/8个列表录制同样数量绘制的耗时
+
+#include <memory>
+#include <vector>
+#include "BenchUtil.h"
+#include "ParallelRecord.h"
+#include "RecordingCommandList.h"
+
+namespace
+{
+    void RecordDraws(RecordingCommandList& list, size_t begin, size_t end)
+    {
+        list.SetPipelineState(1);
+        list.SetGraphicsRootSignature(2);
+        list.IASetVertexBuffers(0, 1);
+        list.IASetIndexBuffer(3);
+        for (size_t i = begin; i < end; ++i)
+        {
+            list.SetGraphicsRootDescriptorTable(0, static_cast<uint32_t>(i));
+            list.DrawIndexedInstanced(36, 1, static_cast<uint32_t>(i) * 36, 0, 0);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const bool quick = IsQuickRun(argc, argv);
+    const size_t drawCount = quick ? 500 : 5000;
+    const int frames = quick ? 2 : 20;
+    //每次调用约200ns，与D3D12驱动中一次绘制的录制开销相当
+    const uint32_t callCostNs = 200;
+
+    JobSystem jobs;
+    std::printf("%u worker threads, %zu draws per frame\n", jobs.GetThreadCount(), drawCount);
+
+    double serialSeconds = 0.0;
+    for (size_t listCount : { 1u, 2u, 4u, 8u })
+    {
+        std::vector<std::unique_ptr<RecordingCommandList>> lists;
+        std::vector<RecordingCommandList*> raw;
+        for (size_t i = 0; i < listCount; ++i)
+        {
+            lists.emplace_back(new RecordingCommandList(callCostNs));
+            raw.push_back(lists.back().get());
+        }
+
+        const double seconds = MeasureSeconds([&]()
+        {
+            for (int frame = 0; frame < frames; ++frame)
+            {
+                for (RecordingCommandList* list : raw)
+                {
+                    list->Reset();
+                }
+                ParallelRecord(jobs, raw.data(), raw.size(), drawCount,
+                    [](RecordingCommandList& list, size_t, size_t begin, size_t end) { RecordDraws(list, begin, end); });
+            }
+        });
+        if (listCount == 1)
+        {
+            serialSeconds = seconds;
+        }
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "ParallelRecord %zu lists", listCount);
+        PrintRate(name, double(drawCount) * frames, seconds, "draws");
+        std::printf("%-40s %10.2f ms/frame, speedup %.2fx\n", "", seconds * 1000.0 / frames, serialSeconds / seconds);
+    }
+    return 0;
+}
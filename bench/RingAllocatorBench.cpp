@@ -0,0 +1,60 @@
+//每帧描述符表的分配：RingAllocator与TLSFAllocator(分配+释放)的吞吐量对比
+//请求为1到4个描述符，环在放不下时结束一帧并立即回收，模拟GPU已经完成的情况
+
+#include <vector>
+#include "BenchUtil.h"
+#include "RingAllocator.h"
+#include "TLSFAllocator.h"
+
+int main(int argc, char** argv)
+{
+    const bool quick = IsQuickRun(argc, argv);
+    const uint32_t iterations = quick ? 100000 : 10000000;
+    const uint32_t capacity = 1u << 16;
+
+    {
+        RingAllocator ring(capacity);
+        uint64_t fence = 0;
+        uint64_t sum = 0;
+        const double seconds = MeasureSeconds([&]()
+        {
+            for (uint32_t i = 0; i < iterations; ++i)
+            {
+                uint32_t offset = ring.Allocate(1 + (i & 3));
+                if (offset == RingAllocator::InvalidOffset)
+                {
+                    ring.FinishFrame(++fence);
+                    ring.Reclaim(fence);
+                    offset = ring.Allocate(1 + (i & 3));
+                }
+                sum += offset;
+            }
+        });
+        DoNotOptimize(sum);
+        PrintRate("RingAllocator::Allocate", iterations, seconds, "allocs");
+    }
+
+    {
+        //TLSF每4096个分配整体释放一次，相当于一帧的描述符表
+        TLSFAllocator allocator(capacity);
+        std::vector<TLSFAllocator::Allocation> live;
+        live.reserve(4096);
+        const double seconds = MeasureSeconds([&]()
+        {
+            for (uint32_t i = 0; i < iterations; ++i)
+            {
+                live.push_back(allocator.Allocate(1 + (i & 3)));
+                if (live.size() == 4096)
+                {
+                    for (const TLSFAllocator::Allocation& allocation : live)
+                    {
+                        allocator.Free(allocation);
+                    }
+                    live.clear();
+                }
+            }
+        });
+        PrintRate("TLSFAllocator::Allocate + Free", iterations, seconds, "allocs");
+    }
+    return 0;
+}
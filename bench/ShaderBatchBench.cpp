@@ -0,0 +1,119 @@
+//着色器排列的批量编译与逐个串行编译的耗时对比，编译器为固定耗时的模拟编译器
+//模拟编译分为CPU计算与等待两部分，等待部分模拟D3DCompile中与核心数无关的耗时(文件读取等)
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include "BenchUtil.h"
+#include "ShaderCache.h"
+#include "TestFiles.h"
+
+namespace
+{
+    class MockCompiler : public IShaderCompiler
+    {
+    public:
+        MockCompiler(uint32_t spinMicroseconds, uint32_t sleepMicroseconds)
+            : mSpin(spinMicroseconds), mSleep(sleepMicroseconds)
+        {
+        }
+
+        bool Compile(const ShaderCompileDesc& desc,
+                     const std::vector<uint8_t>& source,
+                     std::vector<uint8_t>& byteCode,
+                     std::string& errors) override
+        {
+            ++Calls;
+            const int64_t end = ProfilerClock::Now() + int64_t(mSpin) * ProfilerClock::Frequency() / 1000000;
+            uint64_t hash = 0;
+            while (ProfilerClock::Now() < end)
+            {
+                for (uint8_t c : source)
+                {
+                    hash = hash * 31 + c;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(mSleep));
+            byteCode.assign(reinterpret_cast<const uint8_t*>(&hash), reinterpret_cast<const uint8_t*>(&hash) + sizeof(hash));
+            byteCode.push_back(static_cast<uint8_t>(desc.Defines.size()));
+            //模拟编译总是成功，没有错误信息
+            errors.clear();
+            return true;
+        }
+
+        std::atomic<int> Calls{ 0 };
+
+    private:
+        uint32_t mSpin;
+        uint32_t mSleep;
+    };
+}
+
+int main(int argc, char** argv)
+{
+    const bool quick = IsQuickRun(argc, argv);
+    const int uniqueCount = quick ? 8 : 128;
+    const uint32_t spinMicroseconds = quick ? 100 : 2000;
+    const uint32_t sleepMicroseconds = quick ? 100 : 2000;
+
+    const std::wstring dir = MakeTestDirectory(L"ShaderBatchBench");
+    const std::wstring path = dir + L"/lighting.hlsl";
+    WriteTextFile(path, "float4 PS() : SV_Target { return MaxLights * UseShadows; }\n");
+
+    //每种排列出现两次，批量编译时去重
+    std::vector<ShaderCompileDesc> permutations;
+    for (int repeat = 0; repeat < 2; ++repeat)
+    {
+        for (int i = 0; i < uniqueCount; ++i)
+        {
+            ShaderCompileDesc desc;
+            desc.Path = path;
+            desc.EntryPoint = "PS";
+            desc.Target = "ps_5_0";
+            desc.Defines.push_back({ "MaxLights", std::to_string(i / 2) });
+            desc.Defines.push_back({ "UseShadows", std::to_string(i % 2) });
+            permutations.push_back(desc);
+        }
+    }
+
+    std::printf("%d permutations (%d unique), %u us CPU + %u us wait per compile, %u hardware threads\n",
+                int(permutations.size()), uniqueCount, spinMicroseconds, sleepMicroseconds,
+                std::thread::hardware_concurrency());
+
+    //逐个调用Compile，重复的排列命中内存缓存
+    double serialSeconds = 0.0;
+    {
+        MockCompiler compiler(spinMicroseconds, sleepMicroseconds);
+        ShaderCache cache(&compiler, L"");
+        serialSeconds = MeasureSeconds([&]()
+        {
+            for (const ShaderCompileDesc& desc : permutations)
+            {
+                cache.Compile(desc);
+            }
+        });
+        PrintRate("serial Compile", double(compiler.Calls.load()), serialSeconds, "compiles");
+    }
+
+    const uint32_t threadCounts[] = { 1, 2, 4, 8 };
+    for (uint32_t threads : threadCounts)
+    {
+        JobSystem jobs(threads);
+        MockCompiler compiler(spinMicroseconds, sleepMicroseconds);
+        ShaderCache cache(&compiler, L"");
+        const double seconds = MeasureSeconds([&]()
+        {
+            std::vector<std::shared_future<ShaderCompileResult>> results = cache.CompileBatch(permutations, jobs);
+            for (const auto& result : results)
+            {
+                result.wait();
+            }
+        });
+
+        const std::string name = "CompileBatch, " + std::to_string(threads) + " worker(s)";
+        PrintRate(name.c_str(), double(compiler.Calls.load()), seconds, "compiles");
+        std::printf("%-40s %10.2fx vs serial\n", "", seconds > 0.0 ? serialSeconds / seconds : 0.0);
+    }
+    return 0;
+}
@@ -0,0 +1,112 @@
+//TLSFAllocator在类似网格流式加载的负载下的碎片程度与分配释放的耗时
+//请求大小为对数正态分布(大量小网格与少量大网格)，占用率维持在目标值附近反复分配释放
+//碎片程度 = 1 - 最大空闲块 / 空闲总量，0表示空闲空间完全连续
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "BenchUtil.h"
+#include "TLSFAllocator.h"
+
+namespace
+{
+    struct ChurnResult
+    {
+        uint64_t Operations = 0;
+        uint64_t Failures = 0;          //空闲总量足够但没有足够大的连续块
+        double Seconds = 0.0;
+        double AverageFragmentation = 0.0;
+        double WorstFragmentation = 0.0;
+        uint32_t FreeBlocks = 0;
+    };
+
+    ChurnResult RunChurn(uint32_t capacity, double targetOccupancy, double sizeMu, double sizeSigma, uint32_t iterations)
+    {
+        TLSFAllocator allocator(capacity);
+        std::mt19937 rng(35);
+        std::lognormal_distribution<double> sizes(sizeMu, sizeSigma);
+        std::vector<TLSFAllocator::Allocation> live;
+
+        //先生成全部操作，计时只包含分配器本身
+        std::vector<uint32_t> requests(iterations);
+        for (uint32_t& request : requests)
+        {
+            request = static_cast<uint32_t>(std::max(1.0, std::min(sizes(rng), capacity / 64.0)));
+        }
+
+        ChurnResult result;
+        uint64_t liveBytes = 0;
+        uint32_t samples = 0;
+        const uint32_t warmup = iterations / 10;
+        const uint32_t sampleInterval = std::max<uint32_t>(iterations / 1000, 1);
+
+        for (uint32_t i = 0; i < iterations; ++i)
+        {
+            const bool below = liveBytes < capacity * targetOccupancy;
+            const bool allocate = live.empty() || (rng() % 100) < (below ? 60u : 40u);
+
+            const int64_t start = ProfilerClock::Now();
+            if (allocate)
+            {
+                TLSFAllocator::Allocation allocation = allocator.Allocate(requests[i]);
+                result.Seconds += double(ProfilerClock::Now() - start) / double(ProfilerClock::Frequency());
+                if (allocation.IsValid())
+                {
+                    live.push_back(allocation);
+                    liveBytes += allocation.Size;
+                }
+                else if (allocator.GetFreeSize() >= requests[i])
+                {
+                    ++result.Failures;
+                }
+            }
+            else
+            {
+                const size_t index = rng() % live.size();
+                allocator.Free(live[index]);
+                result.Seconds += double(ProfilerClock::Now() - start) / double(ProfilerClock::Frequency());
+                liveBytes -= live[index].Size;
+                live[index] = live.back();
+                live.pop_back();
+            }
+            ++result.Operations;
+
+            if (i > warmup && i % sampleInterval == 0 && allocator.GetFreeSize() > 0)
+            {
+                const double fragmentation = 1.0 - double(allocator.GetLargestFreeBlock()) / allocator.GetFreeSize();
+                result.AverageFragmentation += fragmentation;
+                result.WorstFragmentation = std::max(result.WorstFragmentation, fragmentation);
+                ++samples;
+            }
+        }
+
+        result.AverageFragmentation = samples ? result.AverageFragmentation / samples : 0.0;
+        result.FreeBlocks = allocator.GetFreeBlockCount();
+        return result;
+    }
+
+    void Report(const char* name, const ChurnResult& result)
+    {
+        std::printf("%s\n", name);
+        PrintRate("  Allocate + Free", double(result.Operations), result.Seconds, "ops");
+        std::printf("  %.1f ns/op, fragmentation avg %.3f worst %.3f, %u free blocks, %llu failures despite enough free space\n",
+                    result.Operations ? result.Seconds * 1e9 / result.Operations : 0.0,
+                    result.AverageFragmentation, result.WorstFragmentation, result.FreeBlocks,
+                    static_cast<unsigned long long>(result.Failures));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const bool quick = IsQuickRun(argc, argv);
+    const uint32_t iterations = quick ? 20000 : 2000000;
+
+    //顶点池：64MB，网格大多为几KB，少量为几百KB
+    Report("vertex pool 64MB, ~70% occupied", RunChurn(64u << 20, 0.70, 9.0, 1.3, iterations));
+    Report("vertex pool 64MB, ~90% occupied", RunChurn(64u << 20, 0.90, 9.0, 1.3, iterations));
+    //索引池：16MB，请求更小更集中
+    Report("index pool 16MB, ~80% occupied", RunChurn(16u << 20, 0.80, 7.5, 0.8, iterations));
+    //描述符堆：以描述符个数计，多为1到十几个
+    Report("descriptor heap 65536, ~85% occupied", RunChurn(65536, 0.85, 1.0, 0.8, iterations));
+    return 0;
+}
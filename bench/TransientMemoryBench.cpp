@@ -0,0 +1,75 @@
+//TransientResourcePlanner在随机后处理链上的峰值内存与规划耗时
+//对比每个资源单独分配的大小、规划后的堆大小，以及每个pass存活资源大小的最大值(任何规划都不能低于它)
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "BenchUtil.h"
+#include "TransientResourcePlanner.h"
+
+int main(int argc, char** argv)
+{
+    const bool quick = IsQuickRun(argc, argv);
+    std::mt19937 rng(49);
+    //RGBA16F渲染目标的常见分辨率
+    const uint32_t resolutions[][2] = { { 1920, 1080 }, { 960, 540 }, { 480, 270 }, { 240, 135 }, { 3840, 2160 } };
+
+    for (uint32_t passCount : { 16u, 64u, 256u })
+    {
+        const uint32_t resourceCount = passCount * 2;
+        TransientResourcePlanner planner;
+        std::vector<TransientResourceDesc> descs;
+        std::vector<std::vector<uint32_t>> passes(passCount);
+        for (uint32_t r = 0; r < resourceCount; ++r)
+        {
+            const uint32_t* resolution = resolutions[rng() % 5];
+            TransientResourceDesc desc;
+            desc.Size = (uint64_t(resolution[0]) * resolution[1] * 8 + 65535) / 65536 * 65536;
+            desc.HeapKind = rng() % 4 == 0 ? 1 : 0;
+            descs.push_back(desc);
+            planner.AddResource(desc);
+
+            const uint32_t first = rng() % passCount;
+            const uint32_t last = std::min(passCount, first + 1 + static_cast<uint32_t>(rng() % 6));
+            for (uint32_t p = first; p < last; ++p)
+            {
+                passes[p].push_back(r);
+            }
+        }
+        for (const std::vector<uint32_t>& pass : passes)
+        {
+            planner.AddPass(pass.data(), pass.size());
+        }
+
+        TransientMemoryPlan plan;
+        const int iterations = quick ? 2 : (passCount <= 64 ? 200 : 20);
+        const double seconds = MeasureSeconds([&]()
+        {
+            for (int i = 0; i < iterations; ++i)
+            {
+                planner.Build(plan);
+            }
+        });
+
+        uint64_t livePeak = 0;
+        for (uint32_t p = 0; p < passCount; ++p)
+        {
+            uint64_t live = 0;
+            for (uint32_t r = 0; r < resourceCount; ++r)
+            {
+                const TransientPlacement& placement = plan.Placements[r];
+                if (placement.Heap != TransientMemoryPlan::NoHeap && placement.FirstPass <= p && placement.LastPass >= p)
+                {
+                    live += descs[r].Size;
+                }
+            }
+            livePeak = std::max(livePeak, live);
+        }
+
+        std::printf("%3u passes %3u resources: naive %7.1f MB, planned %7.1f MB (%3.0f%%), live peak %7.1f MB, %zu barriers, Build %.1f us\n",
+                    passCount, resourceCount, plan.NaiveBytes / 1048576.0, plan.TotalBytes / 1048576.0,
+                    100.0 * plan.TotalBytes / plan.NaiveBytes, livePeak / 1048576.0, plan.Barriers.size(),
+                    seconds * 1e6 / iterations);
+    }
+    return 0;
+}
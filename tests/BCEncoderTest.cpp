@@ -0,0 +1,350 @@
+//BCEncoder：BC1默认按不透明编码，只有显式要求时才使用3色+透明模式；BC3/BC4/BC5/BC7按规范解码后与原像素的误差在量化范围内
+
+#include <cstdlib>
+#include "BCEncoder.h"
+#include "TestCheck.h"
+
+namespace
+{
+    struct Texel
+    {
+        int R, G, B;
+        bool Transparent;
+    };
+
+    int Expand5(int v) { return (v << 3) | (v >> 2); }
+    int Expand6(int v) { return (v << 2) | (v >> 4); }
+
+    //按BC1规范解码一个块
+    void DecodeBC1(const uint8_t* block, Texel texels[16])
+    {
+        const int c0 = block[0] | (block[1] << 8);
+        const int c1 = block[2] | (block[3] << 8);
+        Texel palette[4];
+        palette[0] = { Expand5(c0 >> 11), Expand6((c0 >> 5) & 63), Expand5(c0 & 31), false };
+        palette[1] = { Expand5(c1 >> 11), Expand6((c1 >> 5) & 63), Expand5(c1 & 31), false };
+        if (c0 > c1)
+        {
+            palette[2] = { (2 * palette[0].R + palette[1].R) / 3, (2 * palette[0].G + palette[1].G) / 3,
+                           (2 * palette[0].B + palette[1].B) / 3, false };
+            palette[3] = { (palette[0].R + 2 * palette[1].R) / 3, (palette[0].G + 2 * palette[1].G) / 3,
+                           (palette[0].B + 2 * palette[1].B) / 3, false };
+        }
+        else
+        {
+            palette[2] = { (palette[0].R + palette[1].R) / 2, (palette[0].G + palette[1].G) / 2,
+                           (palette[0].B + palette[1].B) / 2, false };
+            palette[3] = { 0, 0, 0, true };
+        }
+
+        const uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | (uint32_t(block[7]) << 24);
+        for (int i = 0; i < 16; ++i)
+        {
+            texels[i] = palette[(indices >> (2 * i)) & 3];
+        }
+    }
+
+    //按BC4规范解码一个单通道块(BC3的alpha块与BC5的两个通道块格式相同)
+    void DecodeBC4(const uint8_t* block, int values[16])
+    {
+        int palette[8];
+        palette[0] = block[0];
+        palette[1] = block[1];
+        if (palette[0] > palette[1])
+        {
+            for (int i = 1; i < 7; ++i)
+            {
+                palette[i + 1] = ((7 - i) * palette[0] + i * palette[1]) / 7;
+            }
+        }
+        else
+        {
+            for (int i = 1; i < 5; ++i)
+            {
+                palette[i + 1] = ((5 - i) * palette[0] + i * palette[1]) / 5;
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+
+        uint64_t indices = 0;
+        for (int i = 0; i < 6; ++i)
+        {
+            indices |= uint64_t(block[2 + i]) << (8 * i);
+        }
+        for (int i = 0; i < 16; ++i)
+        {
+            values[i] = palette[(indices >> (3 * i)) & 7];
+        }
+    }
+
+    //按位读取BC7块
+    uint32_t ReadBits(const uint8_t* block, uint32_t& pos, uint32_t count)
+    {
+        uint32_t value = 0;
+        for (uint32_t i = 0; i < count; ++i, ++pos)
+        {
+            value |= uint32_t((block[pos >> 3] >> (pos & 7)) & 1) << i;
+        }
+        return value;
+    }
+
+    //按BC7规范解码一个mode 6的块(编码器只使用这一种模式)，不是mode 6时返回false
+    bool DecodeBC7Mode6(const uint8_t* block, int rgba[64])
+    {
+        static const int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+        uint32_t pos = 0;
+        if (ReadBits(block, pos, 7) != (1u << 6))
+        {
+            return false;
+        }
+        int e[2][4];
+        for (int c = 0; c < 4; ++c)
+        {
+            e[0][c] = (int)ReadBits(block, pos, 7);
+            e[1][c] = (int)ReadBits(block, pos, 7);
+        }
+        const int p0 = (int)ReadBits(block, pos, 1);
+        const int p1 = (int)ReadBits(block, pos, 1);
+        for (int c = 0; c < 4; ++c)
+        {
+            e[0][c] = (e[0][c] << 1) | p0;
+            e[1][c] = (e[1][c] << 1) | p1;
+        }
+        for (int i = 0; i < 16; ++i)
+        {
+            const int w = weights[ReadBits(block, pos, i == 0 ? 3 : 4)];
+            for (int c = 0; c < 4; ++c)
+            {
+                rgba[i * 4 + c] = ((64 - w) * e[0][c] + w * e[1][c] + 32) >> 6;
+            }
+        }
+        return true;
+    }
+
+    //一个4x4块：各通道随像素序号线性变化(颜色都在同一条线段上)，蓝色不变
+    void MakeGradientBlock(uint8_t rgba[64])
+    {
+        for (int i = 0; i < 16; ++i)
+        {
+            uint8_t* p = rgba + i * 4;
+            p[0] = (uint8_t)(40 + i * 12);
+            p[1] = (uint8_t)(200 - i * 10);
+            p[2] = 90;
+            p[3] = (uint8_t)(255 - i * 12);
+        }
+    }
+
+    //左半部分红色不透明，右半部分绿色且alpha为0
+    MipLevel MakeImage(uint32_t width, uint32_t height)
+    {
+        MipLevel image;
+        image.Width = width;
+        image.Height = height;
+        image.RowPitch = width * 4;
+        image.Pixels.resize(image.RowPitch * height);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                uint8_t* p = &image.Pixels[y * image.RowPitch + x * 4];
+                const bool left = x < width / 2;
+                p[0] = left ? 255 : 0;
+                p[1] = left ? 0 : 255;
+                p[2] = 0;
+                p[3] = left ? 255 : 0;
+            }
+        }
+        return image;
+    }
+
+    void TestOpaqueByDefault()
+    {
+        const MipLevel image = MakeImage(8, 8);
+        std::vector<uint8_t> blocks;
+        CHECK(BCEncoder::CompressImage(image, DXGI_FORMAT_BC1_UNORM, blocks));
+        CHECK_EQ(blocks.size(), 4u * 8);
+
+        //alpha被忽略，透明区域的颜色保留
+        for (size_t b = 0; b < 4; ++b)
+        {
+            Texel texels[16];
+            DecodeBC1(&blocks[b * 8], texels);
+            const bool left = (b % 2) == 0;
+            for (const Texel& texel : texels)
+            {
+                CHECK(!texel.Transparent);
+                CHECK(std::abs(texel.R - (left ? 255 : 0)) <= 8);
+                CHECK(std::abs(texel.G - (left ? 0 : 255)) <= 8);
+            }
+        }
+    }
+
+    void TestPunchThrough()
+    {
+        const MipLevel image = MakeImage(8, 8);
+        std::vector<uint8_t> blocks;
+        CHECK(BCEncoder::CompressImage(image, DXGI_FORMAT_BC1_UNORM, blocks, true));
+        CHECK_EQ(blocks.size(), 4u * 8);
+
+        for (size_t b = 0; b < 4; ++b)
+        {
+            Texel texels[16];
+            DecodeBC1(&blocks[b * 8], texels);
+            const bool left = (b % 2) == 0;
+            for (const Texel& texel : texels)
+            {
+                CHECK_EQ(texel.Transparent, !left);
+                if (left)
+                {
+                    CHECK(std::abs(texel.R - 255) <= 8);
+                }
+            }
+        }
+
+        //一个块中只有部分像素透明
+        uint8_t rgba[64];
+        for (int i = 0; i < 16; ++i)
+        {
+            rgba[i * 4 + 0] = 40;
+            rgba[i * 4 + 1] = 80;
+            rgba[i * 4 + 2] = 200;
+            rgba[i * 4 + 3] = (i % 4 == 0) ? 0 : 255;
+        }
+        uint8_t block[8];
+        BCEncoder::EncodeBC1Block(rgba, block, true);
+        Texel texels[16];
+        DecodeBC1(block, texels);
+        for (int i = 0; i < 16; ++i)
+        {
+            CHECK_EQ(texels[i].Transparent, i % 4 == 0);
+        }
+
+        BCEncoder::EncodeBC1Block(rgba, block, false);
+        DecodeBC1(block, texels);
+        for (int i = 0; i < 16; ++i)
+        {
+            CHECK(!texels[i].Transparent);
+            CHECK(std::abs(texels[i].B - 200) <= 8);
+        }
+    }
+
+    void TestBC3()
+    {
+        uint8_t rgba[64];
+        MakeGradientBlock(rgba);
+        uint8_t block[16];
+        BCEncoder::EncodeBC3Block(rgba, block);
+
+        //前8字节为alpha块，后8字节为总是使用4色模式的颜色块
+        int alpha[16];
+        DecodeBC4(block, alpha);
+        Texel texels[16];
+        DecodeBC1(block + 8, texels);
+        for (int i = 0; i < 16; ++i)
+        {
+            CHECK(std::abs(alpha[i] - rgba[i * 4 + 3]) <= 16);
+            CHECK(!texels[i].Transparent);
+            CHECK(std::abs(texels[i].R - rgba[i * 4 + 0]) <= 24);
+            CHECK(std::abs(texels[i].G - rgba[i * 4 + 1]) <= 24);
+            CHECK(std::abs(texels[i].B - rgba[i * 4 + 2]) <= 8);
+        }
+    }
+
+    void TestBC4BC5()
+    {
+        uint8_t rgba[64];
+        MakeGradientBlock(rgba);
+
+        //端点为块内的最小值与最大值，8个等级之间的误差不超过间隔的一半
+        int values[16];
+        uint8_t block[16];
+        BCEncoder::EncodeBC4Block(rgba, 3, block);
+        CHECK(block[0] > block[1]);
+        DecodeBC4(block, values);
+        for (int i = 0; i < 16; ++i)
+        {
+            CHECK(std::abs(values[i] - rgba[i * 4 + 3]) <= (255 - 75) / 14 + 1);
+        }
+        CHECK_EQ(values[0], 255);
+        CHECK_EQ(values[15], 75);
+
+        //BC5的两个通道各自按BC4编码
+        BCEncoder::EncodeBC5Block(rgba, block);
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            const int range = std::abs(rgba[channel] - rgba[15 * 4 + channel]);
+            DecodeBC4(block + channel * 8, values);
+            for (int i = 0; i < 16; ++i)
+            {
+                CHECK(std::abs(values[i] - rgba[i * 4 + channel]) <= range / 14 + 1);
+            }
+        }
+
+        //单一值的块无论选择哪个模式都要精确还原
+        uint8_t flat[64];
+        for (int i = 0; i < 64; ++i)
+        {
+            flat[i] = 77;
+        }
+        BCEncoder::EncodeBC4Block(flat, 0, block);
+        DecodeBC4(block, values);
+        for (int i = 0; i < 16; ++i)
+        {
+            CHECK_EQ(values[i], 77);
+        }
+    }
+
+    void TestBC7()
+    {
+        uint8_t rgba[64];
+        MakeGradientBlock(rgba);
+        uint8_t block[16];
+        BCEncoder::EncodeBC7Block(rgba, block);
+
+        int decoded[64];
+        CHECK(DecodeBC7Mode6(block, decoded));
+        for (int i = 0; i < 64; ++i)
+        {
+            CHECK(std::abs(decoded[i] - rgba[i]) <= 12);
+        }
+
+        //不透明的单色块几乎无损
+        for (int i = 0; i < 16; ++i)
+        {
+            rgba[i * 4 + 0] = 12;
+            rgba[i * 4 + 1] = 150;
+            rgba[i * 4 + 2] = 233;
+            rgba[i * 4 + 3] = 255;
+        }
+        BCEncoder::EncodeBC7Block(rgba, block);
+        CHECK(DecodeBC7Mode6(block, decoded));
+        for (int i = 0; i < 64; ++i)
+        {
+            CHECK(std::abs(decoded[i] - rgba[i]) <= 1);
+        }
+    }
+
+    void TestEdgeBlocks()
+    {
+        //尺寸不是4的倍数时按块数向上取整
+        const MipLevel image = MakeImage(10, 6);
+        std::vector<uint8_t> blocks;
+        CHECK(BCEncoder::CompressImage(image, DXGI_FORMAT_BC1_UNORM, blocks));
+        CHECK_EQ(blocks.size(), 3u * 2 * 8);
+        CHECK(BCEncoder::CompressImage(image, DXGI_FORMAT_BC7_UNORM, blocks));
+        CHECK_EQ(blocks.size(), 3u * 2 * 16);
+        CHECK(!BCEncoder::CompressImage(image, DXGI_FORMAT_R8G8B8A8_UNORM, blocks));
+    }
+}
+
+int main()
+{
+    TestOpaqueByDefault();
+    TestPunchThrough();
+    TestBC3();
+    TestBC4BC5();
+    TestBC7();
+    TestEdgeBlocks();
+    return TestResult();
+}
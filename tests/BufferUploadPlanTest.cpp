@@ -0,0 +1,116 @@
+//BufferUploadPlanner：缓冲区在共享堆与上传缓冲区中的布局
+
+#include <random>
+#include "BufferUploadPlan.h"
+#include "TestCheck.h"
+
+namespace
+{
+    //检查对齐、互不重叠以及总大小
+    void CheckPlan(const std::vector<BufferUploadItem>& items, const BufferUploadPlan& plan)
+    {
+        CHECK_EQ(plan.Placements.size(), items.size());
+        CHECK_EQ(plan.HeapSize % plan.HeapAlignment, 0u);
+
+        for (size_t i = 0; i < items.size(); ++i)
+        {
+            const BufferUploadPlacement& a = plan.Placements[i];
+            CHECK_EQ(a.HeapOffset % items[i].Alignment, 0u);
+            CHECK_EQ(a.StagingOffset % BufferUploadPlanner::StagingAlignment, 0u);
+            CHECK(a.HeapOffset + items[i].AllocationSize <= plan.HeapSize);
+            CHECK(a.StagingOffset + items[i].Size <= plan.StagingSize);
+            CHECK(items[i].Alignment <= plan.HeapAlignment);
+
+            for (size_t j = i + 1; j < items.size(); ++j)
+            {
+                const BufferUploadPlacement& b = plan.Placements[j];
+                CHECK(a.HeapOffset + items[i].AllocationSize <= b.HeapOffset ||
+                      b.HeapOffset + items[j].AllocationSize <= a.HeapOffset);
+                CHECK(a.StagingOffset + items[i].Size <= b.StagingOffset ||
+                      b.StagingOffset + items[j].Size <= a.StagingOffset);
+            }
+        }
+    }
+
+    //BoxApp的三个缓冲区加上一个较大的缓冲区
+    void TestBoxBuffers()
+    {
+        const std::vector<BufferUploadItem> items = {
+            { 156, 65536, 65536 },
+            { 208, 65536, 65536 },
+            { 108, 65536, 65536 },
+            { 70000, 131072, 65536 },
+        };
+
+        BufferUploadPlan plan;
+        CHECK(BufferUploadPlanner::Build(items, plan));
+        CheckPlan(items, plan);
+
+        CHECK_EQ(plan.HeapAlignment, 65536u);
+        CHECK_EQ(plan.HeapSize, 327680u);
+        //上传缓冲区紧密排列，只在每段开头按16字节对齐
+        CHECK_EQ(plan.Placements[1].StagingOffset, 160u);
+        CHECK_EQ(plan.Placements[2].StagingOffset, 368u);
+        CHECK_EQ(plan.Placements[3].StagingOffset, 480u);
+        CHECK_EQ(plan.StagingSize, 70480u);
+    }
+
+    void TestMixedAlignment()
+    {
+        const std::vector<BufferUploadItem> items = {
+            { 100, 256, 256 },
+            { 100, 65536, 65536 },
+        };
+
+        BufferUploadPlan plan;
+        CHECK(BufferUploadPlanner::Build(items, plan));
+        CheckPlan(items, plan);
+        CHECK_EQ(plan.Placements[1].HeapOffset, 65536u);
+        CHECK_EQ(plan.HeapSize, 131072u);
+    }
+
+    void TestInvalidInput()
+    {
+        BufferUploadPlan plan;
+
+        //对齐不是2的幂
+        CHECK(!BufferUploadPlanner::Build({ { 10, 16, 3 } }, plan));
+        CHECK(!BufferUploadPlanner::Build({ { 10, 16, 0 } }, plan));
+        //初始数据比资源大
+        CHECK(!BufferUploadPlanner::Build({ { 32, 16, 16 } }, plan));
+        //堆大小溢出
+        CHECK(!BufferUploadPlanner::Build({ { 1, UINT64_MAX - 10, 1 }, { 1, 100, 1 } }, plan));
+
+        CHECK(BufferUploadPlanner::Build({}, plan));
+        CHECK_EQ(plan.HeapSize, 0u);
+        CHECK_EQ(plan.StagingSize, 0u);
+    }
+
+    void TestRandomPlans()
+    {
+        std::mt19937 rng(34);
+        for (int iteration = 0; iteration < 200; ++iteration)
+        {
+            std::vector<BufferUploadItem> items(1 + rng() % 24);
+            for (BufferUploadItem& item : items)
+            {
+                item.Alignment = uint64_t(1) << (rng() % 23);
+                item.Size = rng() % 300000;
+                item.AllocationSize = item.Size + rng() % 4096;
+            }
+
+            BufferUploadPlan plan;
+            CHECK(BufferUploadPlanner::Build(items, plan));
+            CheckPlan(items, plan);
+        }
+    }
+}
+
+int main()
+{
+    TestBoxBuffers();
+    TestMixedAlignment();
+    TestInvalidInput();
+    TestRandomPlans();
+    return TestResult();
+}
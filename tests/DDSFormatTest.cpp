@@ -0,0 +1,243 @@
+//DDSFormat的文件头解析、纹理描述与子资源布局
+
+#include <cstring>
+#include "DDSFormat.h"
+#include "DDSTestFiles.h"
+#include "DDSTranscoder.h"
+#include "TestCheck.h"
+
+namespace
+{
+    void TestSurfaceInfo()
+    {
+        CHECK_EQ(DDSFormat::BitsPerPixel(DXGI_FORMAT_R8G8B8A8_UNORM), 32u);
+        CHECK_EQ(DDSFormat::BitsPerPixel(DXGI_FORMAT_BC1_UNORM), 4u);
+        CHECK_EQ(DDSFormat::BitsPerPixel(DXGI_FORMAT_BC7_UNORM), 8u);
+        CHECK_EQ(DDSFormat::BitsPerPixel(DXGI_FORMAT_UNKNOWN), 0u);
+        CHECK(DDSFormat::IsCompressed(DXGI_FORMAT_BC3_UNORM));
+        CHECK(!DDSFormat::IsCompressed(DXGI_FORMAT_R16G16_FLOAT));
+
+        size_t numBytes = 0;
+        size_t rowBytes = 0;
+        size_t numRows = 0;
+        DDSFormat::GetSurfaceInfo(64, 32, DXGI_FORMAT_BC1_UNORM, &numBytes, &rowBytes, &numRows);
+        CHECK_EQ(numBytes, 1024u);
+        CHECK_EQ(rowBytes, 128u);
+        CHECK_EQ(numRows, 8u);
+
+        //不足一个块的尺寸按一个块计
+        DDSFormat::GetSurfaceInfo(1, 1, DXGI_FORMAT_BC7_UNORM, &numBytes, &rowBytes, &numRows);
+        CHECK_EQ(numBytes, 16u);
+        CHECK_EQ(numRows, 1u);
+
+        DDSFormat::GetSurfaceInfo(17, 9, DXGI_FORMAT_R8G8B8A8_UNORM, &numBytes, &rowBytes, &numRows);
+        CHECK_EQ(rowBytes, 68u);
+        CHECK_EQ(numBytes, 68u * 9);
+    }
+
+    void TestDX10Texture()
+    {
+        const std::vector<uint8_t> file = DDSTestFiles::MakeTexture2D(DXGI_FORMAT_BC1_UNORM, 64, 32, 1, 7);
+
+        const DDS_HEADER* header = nullptr;
+        size_t offset = 0;
+        CHECK(DDSFormat::ParseHeader(file.data(), file.size(), &header, &offset));
+        CHECK_EQ(offset, 4 + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10));
+
+        DDSTextureDesc desc;
+        CHECK(DDSFormat::GetTextureDesc(header, desc) == DDSParseResult::Ok);
+        CHECK_EQ(desc.Dimension, uint32_t(DDS_DIMENSION_TEXTURE2D));
+        CHECK_EQ(desc.Width, 64u);
+        CHECK_EQ(desc.Height, 32u);
+        CHECK_EQ(desc.MipCount, 7u);
+        CHECK_EQ(desc.ArraySize, 1u);
+        CHECK(desc.Format == DXGI_FORMAT_BC1_UNORM);
+        CHECK(!desc.IsCubeMap);
+
+        //1024 + 256 + 64 + 16 + 8 + 8 + 8
+        const size_t bitSize = file.size() - offset;
+        CHECK_EQ(bitSize, 1384u);
+
+        std::vector<DDSSubresourceLayout> layouts;
+        CHECK(DDSFormat::ComputeLayout(desc, bitSize, layouts));
+        CHECK_EQ(layouts.size(), 7u);
+        if (layouts.size() == 7)
+        {
+            CHECK_EQ(layouts[0].Offset, 0u);
+            CHECK_EQ(layouts[1].Offset, 1024u);
+            CHECK_EQ(layouts[6].Offset, 1376u);
+            CHECK_EQ(layouts[6].Width, 1u);
+            CHECK_EQ(layouts[6].Height, 1u);
+            CHECK_EQ(layouts[6].SlicePitch, 8u);
+        }
+
+        //少一个字节时整个布局都不成立
+        CHECK(!DDSFormat::ComputeLayout(desc, bitSize - 1, layouts));
+        CHECK(layouts.empty());
+    }
+
+    void TestTextureArray()
+    {
+        const std::vector<uint8_t> file = DDSTestFiles::MakeTexture2D(DXGI_FORMAT_R8G8B8A8_UNORM, 17, 9, 2, 5);
+
+        const DDS_HEADER* header = nullptr;
+        size_t offset = 0;
+        CHECK(DDSFormat::ParseHeader(file.data(), file.size(), &header, &offset));
+
+        DDSTextureDesc desc;
+        CHECK(DDSFormat::GetTextureDesc(header, desc) == DDSParseResult::Ok);
+        CHECK_EQ(desc.ArraySize, 2u);
+
+        std::vector<DDSSubresourceLayout> layouts;
+        CHECK(DDSFormat::ComputeLayout(desc, file.size() - offset, layouts));
+        CHECK_EQ(layouts.size(), 10u);
+        if (layouts.size() == 10)
+        {
+            //数组切片优先：第二个切片从第一个切片的整个mip链之后开始
+            const size_t sliceBytes = 17 * 9 * 4 + 8 * 4 * 4 + 4 * 2 * 4 + 2 * 1 * 4 + 1 * 1 * 4;
+            CHECK_EQ(layouts[5].Offset, sliceBytes);
+            CHECK_EQ(layouts[5].Width, 17u);
+            CHECK_EQ(layouts[4].Width, 1u);
+            CHECK_EQ(file.size() - offset, sliceBytes * 2);
+        }
+    }
+
+    void TestLegacyCubeAndVolume()
+    {
+        const std::vector<uint8_t> cube = DDSTestFiles::MakeLegacyFile(
+            DDSTestFiles::MakeFourCCFormat(MAKEFOURCC('D', 'X', 'T', '1')), 32, 32, 1, 6, true, 0);
+
+        const DDS_HEADER* header = nullptr;
+        size_t offset = 0;
+        CHECK(DDSFormat::ParseHeader(cube.data(), cube.size(), &header, &offset));
+        CHECK_EQ(offset, 4 + sizeof(DDS_HEADER));
+
+        DDSTextureDesc desc;
+        CHECK(DDSFormat::GetTextureDesc(header, desc) == DDSParseResult::Ok);
+        CHECK(desc.IsCubeMap);
+        CHECK_EQ(desc.ArraySize, 6u);
+        CHECK(desc.Format == DXGI_FORMAT_BC1_UNORM);
+
+        std::vector<DDSSubresourceLayout> layouts;
+        CHECK(DDSFormat::ComputeLayout(desc, cube.size() - offset, layouts));
+        CHECK_EQ(layouts.size(), 36u);
+
+        //缺少一个面的立方体贴图不受支持
+        std::vector<uint8_t> partial = cube;
+        DDS_HEADER modified;
+        std::memcpy(&modified, partial.data() + 4, sizeof(modified));
+        modified.caps2 = DDS_CUBEMAP_POSITIVEX | DDS_CUBEMAP_NEGATIVEX;
+        std::memcpy(partial.data() + 4, &modified, sizeof(modified));
+        CHECK(DDSFormat::ParseHeader(partial.data(), partial.size(), &header, &offset));
+        CHECK(DDSFormat::GetTextureDesc(header, desc) == DDSParseResult::NotSupported);
+
+        const std::vector<uint8_t> volume = DDSTestFiles::MakeLegacyFile(
+            DDSTestFiles::MakeFourCCFormat(MAKEFOURCC('D', 'X', 'T', '5')), 8, 8, 4, 4, false, 0);
+        CHECK(DDSFormat::ParseHeader(volume.data(), volume.size(), &header, &offset));
+        CHECK(DDSFormat::GetTextureDesc(header, desc) == DDSParseResult::Ok);
+        CHECK_EQ(desc.Dimension, uint32_t(DDS_DIMENSION_TEXTURE3D));
+        CHECK_EQ(desc.Depth, 4u);
+        CHECK(DDSFormat::ComputeLayout(desc, volume.size() - offset, layouts));
+        CHECK_EQ(layouts.size(), 4u);
+        if (layouts.size() == 4)
+        {
+            CHECK_EQ(layouts[0].Depth, 4u);
+            CHECK_EQ(layouts[1].Depth, 2u);
+            CHECK_EQ(layouts[2].Depth, 1u);
+            CHECK_EQ(layouts[3].Depth, 1u);
+            CHECK_EQ(layouts[1].Offset, 4u * 64);
+        }
+    }
+
+    void TestMalformedHeaders()
+    {
+        const std::vector<uint8_t> file = DDSTestFiles::MakeTexture2D(DXGI_FORMAT_R8G8B8A8_UNORM, 4, 4, 1, 1);
+        const DDS_HEADER* header = nullptr;
+        size_t offset = 0;
+
+        CHECK(!DDSFormat::ParseHeader(nullptr, file.size(), &header, &offset));
+        CHECK(!DDSFormat::ParseHeader(file.data(), 4 + sizeof(DDS_HEADER) - 1, &header, &offset));
+        //DX10扩展头不完整
+        CHECK(!DDSFormat::ParseHeader(file.data(), 4 + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10) - 1, &header, &offset));
+        CHECK(header == nullptr);
+
+        std::vector<uint8_t> badMagic = file;
+        badMagic[0] = 'X';
+        CHECK(!DDSFormat::ParseHeader(badMagic.data(), badMagic.size(), &header, &offset));
+
+        std::vector<uint8_t> badSize = file;
+        badSize[4] = 123;
+        CHECK(!DDSFormat::ParseHeader(badSize.data(), badSize.size(), &header, &offset));
+
+        //宽度为0或数组大小为0都是非法数据
+        DDS_HEADER modified;
+        std::vector<uint8_t> zeroWidth = file;
+        std::memcpy(&modified, zeroWidth.data() + 4, sizeof(modified));
+        modified.width = 0;
+        std::memcpy(zeroWidth.data() + 4, &modified, sizeof(modified));
+        DDSTextureDesc desc;
+        CHECK(DDSFormat::ParseHeader(zeroWidth.data(), zeroWidth.size(), &header, &offset));
+        CHECK(DDSFormat::GetTextureDesc(header, desc) == DDSParseResult::InvalidData);
+
+        std::vector<uint8_t> zeroArray = file;
+        const uint32_t zero = 0;
+        std::memcpy(zeroArray.data() + 4 + sizeof(DDS_HEADER) + offsetof(DDS_HEADER_DXT10, arraySize), &zero, sizeof(zero));
+        CHECK(DDSFormat::ParseHeader(zeroArray.data(), zeroArray.size(), &header, &offset));
+        CHECK(DDSFormat::GetTextureDesc(header, desc) == DDSParseResult::InvalidData);
+
+        //尺寸超过D3D12的限制
+        std::vector<uint8_t> huge = file;
+        std::memcpy(&modified, huge.data() + 4, sizeof(modified));
+        modified.width = 0x80000000u;
+        modified.height = 0x80000000u;
+        std::memcpy(huge.data() + 4, &modified, sizeof(modified));
+        CHECK(DDSFormat::ParseHeader(huge.data(), huge.size(), &header, &offset));
+        CHECK(DDSFormat::GetTextureDesc(header, desc) == DDSParseResult::NotSupported);
+    }
+
+    void TestLegacyFormatsNeedTranscode()
+    {
+        //24位RGB没有对应的DXGI格式，由转码器负责
+        const DDS_PIXELFORMAT rgb24 = DDSTestFiles::MakeRGBFormat(24, 0xff0000, 0x00ff00, 0x0000ff, 0);
+        CHECK(DDSFormat::GetDXGIFormat(rgb24) == DXGI_FORMAT_UNKNOWN);
+        CHECK(DDSTranscoder::GetTranscodedFormat(rgb24) != DXGI_FORMAT_UNKNOWN);
+
+        const DDS_PIXELFORMAT bgra = DDSTestFiles::MakeRGBFormat(32, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000);
+        CHECK(DDSFormat::GetDXGIFormat(bgra) == DXGI_FORMAT_B8G8R8A8_UNORM);
+        CHECK(DDSTranscoder::GetTranscodedFormat(bgra) == DXGI_FORMAT_UNKNOWN);
+
+        const std::vector<uint8_t> file = DDSTestFiles::MakeLegacyFile(rgb24, 13, 7, 1, 4, false, 24);
+        const DDS_HEADER* header = nullptr;
+        size_t offset = 0;
+        CHECK(DDSFormat::ParseHeader(file.data(), file.size(), &header, &offset));
+
+        std::vector<uint8_t> transcoded;
+        CHECK(DDSTranscoder::Transcode(*header, file.data() + offset, file.size() - offset, transcoded));
+        CHECK(DDSFormat::ParseHeader(transcoded.data(), transcoded.size(), &header, &offset));
+
+        DDSTextureDesc desc;
+        CHECK(DDSFormat::GetTextureDesc(header, desc) == DDSParseResult::Ok);
+        CHECK_EQ(desc.Width, 13u);
+        CHECK_EQ(desc.MipCount, 4u);
+        CHECK_EQ(DDSFormat::BitsPerPixel(desc.Format), 32u);
+
+        std::vector<DDSSubresourceLayout> layouts;
+        CHECK(DDSFormat::ComputeLayout(desc, transcoded.size() - offset, layouts));
+        CHECK_EQ(layouts.size(), 4u);
+
+        //源数据不足时拒绝转码
+        CHECK(DDSFormat::ParseHeader(file.data(), file.size(), &header, &offset));
+        CHECK(!DDSTranscoder::Transcode(*header, file.data() + offset, file.size() - offset - 1, transcoded));
+    }
+}
+
+int main()
+{
+    TestSurfaceInfo();
+    TestDX10Texture();
+    TestTextureArray();
+    TestLegacyCubeAndVolume();
+    TestMalformedHeaders();
+    TestLegacyFormatsNeedTranscode();
+    return TestResult();
+}
@@ -0,0 +1,208 @@
+//DDS文件头解析路径的模糊测试，与DDSTextureLoader::CreateTextureFromDDS12的顺序相同：
+//ParseHeader -> (旧格式转码 -> ParseHeader) -> GetTextureDesc -> ComputeLayout
+//解析成功时逐个访问子资源的首尾字节，越界会被AddressSanitizer或下面的检查发现
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "DDS.h"
+#include "DDSFormat.h"
+#include "DDSTranscoder.h"
+
+//fuzz目标中发现的错误直接终止，让libFuzzer保存触发问题的输入
+#define FUZZ_REQUIRE(expr)                                                                \
+    do                                                                                    \
+    {                                                                                     \
+        if (!(expr))                                                                      \
+        {                                                                                 \
+            std::fprintf(stderr, "%s(%d): FUZZ_REQUIRE(%s) failed\n", __FILE__, __LINE__, #expr); \
+            std::abort();                                                                 \
+        }                                                                                 \
+    } while (0)
+
+namespace
+{
+    volatile uint8_t gSink = 0;
+    size_t gAcceptedInputs = 0;     //解析出完整布局的输入数，回放时用来确认变异没有全部被提前拒绝
+
+    void CheckLayouts(const DDSTextureDesc& desc,
+                      const uint8_t* bitData,
+                      size_t bitSize,
+                      const std::vector<DDSSubresourceLayout>& layouts)
+    {
+        FUZZ_REQUIRE(layouts.size() == size_t(desc.MipCount) * desc.ArraySize);
+
+        size_t expectedOffset = 0;
+        for (const DDSSubresourceLayout& layout : layouts)
+        {
+            //子资源紧密排列，大小不会超出像素数据
+            FUZZ_REQUIRE(layout.Offset == expectedOffset);
+            FUZZ_REQUIRE(layout.RowPitch != 0 && layout.NumRows != 0 && layout.Depth != 0);
+            FUZZ_REQUIRE(layout.SlicePitch <= layout.RowPitch * layout.NumRows);
+            const size_t bytes = layout.SlicePitch * layout.Depth;
+            FUZZ_REQUIRE(layout.Offset <= bitSize && bytes <= bitSize - layout.Offset);
+
+            gSink = gSink + bitData[layout.Offset] + bitData[layout.Offset + bytes - 1];
+            expectedOffset = layout.Offset + bytes;
+        }
+        ++gAcceptedInputs;
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    const DDS_HEADER* header = nullptr;
+    size_t offset = 0;
+    if (!DDSFormat::ParseHeader(data, size, &header, &offset))
+    {
+        return 0;
+    }
+    FUZZ_REQUIRE(offset <= size);
+
+    //没有对应DXGI格式的旧格式先转码，转码结果必须总能被重新解析
+    std::vector<uint8_t> transcoded;
+    const bool isDXT10Header = (header->ddspf.flags & DDS_FOURCC) &&
+        (MAKEFOURCC('D', 'X', '1', '0') == header->ddspf.fourCC);
+    if (!isDXT10Header &&
+        DDSFormat::GetDXGIFormat(header->ddspf) == DXGI_FORMAT_UNKNOWN &&
+        DDSTranscoder::GetTranscodedFormat(header->ddspf) != DXGI_FORMAT_UNKNOWN)
+    {
+        if (!DDSTranscoder::Transcode(*header, data + offset, size - offset, transcoded))
+        {
+            return 0;
+        }
+        FUZZ_REQUIRE(DDSFormat::ParseHeader(transcoded.data(), transcoded.size(), &header, &offset));
+        data = transcoded.data();
+        size = transcoded.size();
+    }
+
+    DDSTextureDesc desc;
+    if (DDSFormat::GetTextureDesc(header, desc) != DDSParseResult::Ok)
+    {
+        return 0;
+    }
+    FUZZ_REQUIRE(desc.Width != 0 && desc.Height != 0 && desc.Depth != 0);
+    FUZZ_REQUIRE(desc.MipCount != 0 && desc.ArraySize != 0);
+    FUZZ_REQUIRE(DDSFormat::BitsPerPixel(desc.Format) != 0);
+
+    std::vector<DDSSubresourceLayout> layouts;
+    if (!DDSFormat::ComputeLayout(desc, size - offset, layouts))
+    {
+        FUZZ_REQUIRE(layouts.empty());
+        return 0;
+    }
+    CheckLayouts(desc, data + offset, size - offset, layouts);
+    return 0;
+}
+
+#ifndef RENDER_LIBFUZZER
+
+//不使用libFuzzer时的入口：
+//  DDSParseFuzz                     运行内置种子以及固定随机数种子下的变异输入
+//  DDSParseFuzz file...             回放指定的输入(例如libFuzzer保存的crash文件)
+//  DDSParseFuzz --write-seeds dir   把内置种子写入dir，作为libFuzzer的初始语料
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+#include "DDSTestFiles.h"
+#include "FileUtil.h"
+
+namespace
+{
+    std::wstring ToWide(const char* s)
+    {
+        return std::wstring(s, s + std::strlen(s));
+    }
+
+    //随机改写字节、截断或在文件头的字段中写入边界值
+    void Mutate(std::mt19937& rng, std::vector<uint8_t>& input)
+    {
+        static const uint32_t interesting[] = { 0, 1, 3, 4, 6, 0x7f, 0x80, 0xff, 0x100, 0x4000, 0x4001,
+                                                0x7fffffff, 0x80000000, 0xfffffffe, 0xffffffff };
+        const uint32_t kind = rng() % 4;
+        if (kind == 0 && !input.empty())
+        {
+            input.resize(rng() % input.size());
+        }
+        else if (kind == 1 && input.size() >= 8)
+        {
+            //只改写magic之后、DX10扩展头结束之前的32位字段
+            const size_t headerEnd = std::min<size_t>(input.size(), 4 + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10));
+            const size_t field = 4 + (rng() % ((headerEnd - 4) / 4)) * 4;
+            const uint32_t value = interesting[rng() % (sizeof(interesting) / sizeof(interesting[0]))];
+            std::memcpy(input.data() + field, &value, sizeof(value));
+        }
+        else
+        {
+            const uint32_t flips = 1 + rng() % 8;
+            for (uint32_t i = 0; i < flips && !input.empty(); ++i)
+            {
+                input[rng() % input.size()] ^= static_cast<uint8_t>(1u << (rng() % 8));
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc == 3 && std::string(argv[1]) == "--write-seeds")
+    {
+        const std::wstring dir = ToWide(argv[2]);
+        if (!FileUtil::EnsureDirectory(dir))
+        {
+            return 1;
+        }
+        const std::vector<std::vector<uint8_t>> seeds = DDSTestFiles::MakeSeedFiles();
+        for (size_t i = 0; i < seeds.size(); ++i)
+        {
+            const std::wstring path = dir + L"/seed" + std::to_wstring(i) + L".dds";
+            if (!FileUtil::WriteAllBytes(path, seeds[i].data(), seeds[i].size()))
+            {
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::vector<uint8_t> input;
+            if (!FileUtil::ReadAllBytes(ToWide(argv[i]), input))
+            {
+                std::fprintf(stderr, "cannot read %s\n", argv[i]);
+                return 1;
+            }
+            LLVMFuzzerTestOneInput(input.data(), input.size());
+        }
+        return 0;
+    }
+
+    const std::vector<std::vector<uint8_t>> seeds = DDSTestFiles::MakeSeedFiles();
+    for (const std::vector<uint8_t>& seed : seeds)
+    {
+        LLVMFuzzerTestOneInput(seed.data(), seed.size());
+    }
+
+    //变异的输入每次都从种子重新开始，再叠加若干次变异
+    std::mt19937 rng(29);
+    const uint32_t iterations = 200000;
+    for (uint32_t i = 0; i < iterations; ++i)
+    {
+        std::vector<uint8_t> input = seeds[rng() % seeds.size()];
+        const uint32_t rounds = 1 + rng() % 4;
+        for (uint32_t r = 0; r < rounds; ++r)
+        {
+            Mutate(rng, input);
+        }
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+    std::printf("%u mutated inputs, %zu produced a layout, no failures\n", iterations, gAcceptedInputs);
+    return gAcceptedInputs > seeds.size() ? 0 : 1;
+}
+
+#endif
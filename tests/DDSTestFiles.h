@@ -0,0 +1,143 @@
+#pragma once
+
+//测试与基准共用的DDS文件构造函数，像素数据为按位置生成的固定内容，便于比较
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "DDS.h"
+#include "DDSFormat.h"
+#include "DDSWriter.h"
+
+namespace DDSTestFiles
+{
+    inline DDS_PIXELFORMAT MakeRGBFormat(uint32_t bitCount, uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+    {
+        DDS_PIXELFORMAT ddpf = {};
+        ddpf.size = sizeof(DDS_PIXELFORMAT);
+        ddpf.flags = DDS_RGB | (a != 0 ? 0x1 /*DDPF_ALPHAPIXELS*/ : 0);
+        ddpf.RGBBitCount = bitCount;
+        ddpf.RBitMask = r;
+        ddpf.GBitMask = g;
+        ddpf.BBitMask = b;
+        ddpf.ABitMask = a;
+        return ddpf;
+    }
+
+    inline DDS_PIXELFORMAT MakeFourCCFormat(uint32_t fourCC)
+    {
+        DDS_PIXELFORMAT ddpf = {};
+        ddpf.size = sizeof(DDS_PIXELFORMAT);
+        ddpf.flags = DDS_FOURCC;
+        ddpf.fourCC = fourCC;
+        return ddpf;
+    }
+
+    //不带DX10扩展头的文件，bitsPerPixel为0时按BC格式的块大小计算(仅支持DXT1/DXT5)
+    //volume与cube互斥，cube时写入全部6个面
+    inline std::vector<uint8_t> MakeLegacyFile(const DDS_PIXELFORMAT& ddpf,
+                                               uint32_t width,
+                                               uint32_t height,
+                                               uint32_t depth,
+                                               uint32_t mipCount,
+                                               bool cube,
+                                               size_t bitsPerPixel)
+    {
+        DDS_HEADER header = {};
+        header.size = sizeof(DDS_HEADER);
+        header.flags = DDS_HEADER_FLAGS_TEXTURE | (mipCount > 1 ? DDS_HEADER_FLAGS_MIPMAP : 0) |
+                       (depth > 1 ? DDS_HEADER_FLAGS_VOLUME : 0);
+        header.width = width;
+        header.height = height;
+        header.depth = depth > 1 ? depth : 0;
+        header.mipMapCount = mipCount;
+        header.ddspf = ddpf;
+        header.caps = DDS_SURFACE_FLAGS_TEXTURE | (mipCount > 1 ? DDS_SURFACE_FLAGS_MIPMAP : 0);
+        header.caps2 = cube ? (DDS_CUBEMAP | DDS_CUBEMAP_ALLFACES) : 0;
+
+        size_t bitSize = 0;
+        for (uint32_t face = 0; face < (cube ? 6u : 1u); ++face)
+        {
+            uint32_t w = width;
+            uint32_t h = height;
+            uint32_t d = depth;
+            for (uint32_t mip = 0; mip < mipCount; ++mip)
+            {
+                size_t surface = 0;
+                if (bitsPerPixel == 0)
+                {
+                    const size_t blockBytes = ddpf.fourCC == MAKEFOURCC('D', 'X', 'T', '1') ? 8 : 16;
+                    surface = size_t((w + 3) / 4) * ((h + 3) / 4) * blockBytes;
+                }
+                else
+                {
+                    surface = size_t(w) * h * bitsPerPixel / 8;
+                }
+                bitSize += surface * d;
+                w = w > 1 ? w / 2 : 1;
+                h = h > 1 ? h / 2 : 1;
+                d = d > 1 ? d / 2 : 1;
+            }
+        }
+
+        std::vector<uint8_t> file(sizeof(uint32_t) + sizeof(DDS_HEADER) + bitSize);
+        std::memcpy(file.data(), &DDS_MAGIC, sizeof(uint32_t));
+        std::memcpy(file.data() + sizeof(uint32_t), &header, sizeof(DDS_HEADER));
+        for (size_t i = 0; i < bitSize; ++i)
+        {
+            file[sizeof(uint32_t) + sizeof(DDS_HEADER) + i] = static_cast<uint8_t>(i * 7 + 3);
+        }
+        return file;
+    }
+
+    //带DX10扩展头的2D纹理(数组)，mip链完整写入
+    inline std::vector<uint8_t> MakeTexture2D(DXGI_FORMAT format,
+                                              uint32_t width,
+                                              uint32_t height,
+                                              uint32_t arraySize,
+                                              uint32_t mipCount)
+    {
+        std::vector<std::vector<uint8_t>> subresources;
+        for (uint32_t slice = 0; slice < arraySize; ++slice)
+        {
+            uint32_t w = width;
+            uint32_t h = height;
+            for (uint32_t mip = 0; mip < mipCount; ++mip)
+            {
+                size_t numBytes = 0;
+                DDSFormat::GetSurfaceInfo(w, h, format, &numBytes, nullptr, nullptr);
+                std::vector<uint8_t> data(numBytes);
+                for (size_t i = 0; i < numBytes; ++i)
+                {
+                    data[i] = static_cast<uint8_t>(i + slice * 31 + mip * 17);
+                }
+                subresources.push_back(std::move(data));
+                w = w > 1 ? w / 2 : 1;
+                h = h > 1 ? h / 2 : 1;
+            }
+        }
+
+        std::vector<uint8_t> file;
+        DDSWriter::WriteTexture2D(format, width, height, arraySize, mipCount, subresources, file);
+        return file;
+    }
+
+    //覆盖DX10扩展头、旧格式、立方体贴图、体纹理以及需要转码的格式
+    inline std::vector<std::vector<uint8_t>> MakeSeedFiles()
+    {
+        std::vector<std::vector<uint8_t>> seeds;
+        seeds.push_back(MakeTexture2D(DXGI_FORMAT_BC1_UNORM, 64, 32, 1, 7));
+        seeds.push_back(MakeTexture2D(DXGI_FORMAT_BC7_UNORM_SRGB, 20, 12, 3, 3));
+        seeds.push_back(MakeTexture2D(DXGI_FORMAT_R8G8B8A8_UNORM, 17, 9, 2, 5));
+        seeds.push_back(MakeTexture2D(DXGI_FORMAT_R16G16B16A16_FLOAT, 8, 8, 1, 1));
+        seeds.push_back(MakeLegacyFile(MakeRGBFormat(32, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000), 16, 16, 1, 5, false, 32));
+        seeds.push_back(MakeLegacyFile(MakeFourCCFormat(MAKEFOURCC('D', 'X', 'T', '1')), 32, 32, 1, 6, true, 0));
+        seeds.push_back(MakeLegacyFile(MakeFourCCFormat(MAKEFOURCC('D', 'X', 'T', '5')), 8, 8, 4, 4, false, 0));
+        seeds.push_back(MakeLegacyFile(MakeRGBFormat(32, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000), 8, 4, 4, 3, false, 32));
+        //以下格式没有对应的DXGI格式，需要先转码
+        seeds.push_back(MakeLegacyFile(MakeRGBFormat(24, 0xff0000, 0x00ff00, 0x0000ff, 0), 13, 7, 1, 4, false, 24));
+        seeds.push_back(MakeLegacyFile(MakeRGBFormat(16, 0x7c00, 0x03e0, 0x001f, 0), 8, 8, 1, 1, true, 16));
+        seeds.push_back(MakeLegacyFile(MakeRGBFormat(8, 0xe0, 0x1c, 0x03, 0), 6, 5, 3, 2, false, 8));
+        return seeds;
+    }
+}
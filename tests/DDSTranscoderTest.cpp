@@ -0,0 +1,122 @@
+//DDSTranscoder：旧格式像素的转换结果，以及TranscodeCached按源文件的元数据命中磁盘缓存、命中时只映射缓存文件
+
+#include <cstring>
+#include "DDSTestFiles.h"
+#include "DDSTranscoder.h"
+#include "TestCheck.h"
+#include "TestFiles.h"
+
+namespace
+{
+    const size_t TranscodedDataOffset = sizeof(uint32_t) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10);
+
+    const DDS_HEADER* ParseLegacyFile(const std::vector<uint8_t>& file, size_t& offset)
+    {
+        const DDS_HEADER* header = nullptr;
+        CHECK(DDSFormat::ParseHeader(file.data(), file.size(), &header, &offset));
+        return header;
+    }
+
+    void TestRGB24()
+    {
+        //R8G8B8展开为R8G8B8A8，alpha为255
+        const std::vector<uint8_t> file = DDSTestFiles::MakeLegacyFile(
+            DDSTestFiles::MakeRGBFormat(24, 0xff0000, 0x00ff00, 0x0000ff, 0), 4, 2, 1, 1, false, 24);
+        size_t offset = 0;
+        const DDS_HEADER* header = ParseLegacyFile(file, offset);
+        CHECK(DDSTranscoder::GetTranscodedFormat(header->ddspf) == DXGI_FORMAT_R8G8B8A8_UNORM);
+
+        std::vector<uint8_t> transcoded;
+        CHECK(DDSTranscoder::Transcode(*header, file.data() + offset, file.size() - offset, transcoded));
+        CHECK_EQ(transcoded.size(), TranscodedDataOffset + 4u * 2u * 4u);
+
+        DDSTextureDesc desc;
+        const DDS_HEADER* transcodedHeader = nullptr;
+        size_t transcodedOffset = 0;
+        CHECK(DDSFormat::ParseHeader(transcoded.data(), transcoded.size(), &transcodedHeader, &transcodedOffset));
+        CHECK_EQ(transcodedOffset, TranscodedDataOffset);
+        CHECK(DDSFormat::GetTextureDesc(transcodedHeader, desc) == DDSParseResult::Ok);
+        CHECK(desc.Format == DXGI_FORMAT_R8G8B8A8_UNORM);
+
+        //源像素为小端的0xRRGGBB，即内存中的B、G、R
+        int wrong = 0;
+        for (size_t pixel = 0; pixel < 8 && transcoded.size() >= TranscodedDataOffset + 32; ++pixel)
+        {
+            const uint8_t* src = file.data() + offset + pixel * 3;
+            const uint8_t* dst = transcoded.data() + TranscodedDataOffset + pixel * 4;
+            wrong += dst[0] == src[2] && dst[1] == src[1] && dst[2] == src[0] && dst[3] == 255 ? 0 : 1;
+        }
+        CHECK_EQ(wrong, 0);
+    }
+
+    void TestX1R5G5B5()
+    {
+        //X1R5G5B5与B5G5R5A1的布局相同，只需把未使用的最高位设为不透明
+        const std::vector<uint8_t> file = DDSTestFiles::MakeLegacyFile(
+            DDSTestFiles::MakeRGBFormat(16, 0x7c00, 0x03e0, 0x001f, 0), 3, 3, 1, 2, false, 16);
+        size_t offset = 0;
+        const DDS_HEADER* header = ParseLegacyFile(file, offset);
+        std::vector<uint8_t> transcoded;
+        CHECK(DDSTranscoder::Transcode(*header, file.data() + offset, file.size() - offset, transcoded));
+        CHECK_EQ(transcoded.size(), TranscodedDataOffset + (file.size() - offset));
+
+        int wrong = 0;
+        for (size_t i = 0; i + 1 < file.size() - offset && TranscodedDataOffset + i + 1 < transcoded.size(); i += 2)
+        {
+            uint16_t src = 0;
+            uint16_t dst = 0;
+            std::memcpy(&src, file.data() + offset + i, sizeof(src));
+            std::memcpy(&dst, transcoded.data() + TranscodedDataOffset + i, sizeof(dst));
+            wrong += dst == (src | 0x8000) ? 0 : 1;
+        }
+        CHECK_EQ(wrong, 0);
+    }
+
+    void TestCache()
+    {
+        const std::wstring dir = MakeTestDirectory(L"DDSTranscoderTest");
+        const std::wstring cacheDir = dir + L"/cache";
+        const std::wstring sourcePath = dir + L"/legacy.dds";
+        const std::vector<uint8_t> file = DDSTestFiles::MakeLegacyFile(
+            DDSTestFiles::MakeRGBFormat(24, 0xff0000, 0x00ff00, 0x0000ff, 0), 13, 7, 1, 4, false, 24);
+        CHECK(FileUtil::WriteAllBytes(sourcePath, file.data(), file.size()));
+        size_t offset = 0;
+        const DDS_HEADER* header = ParseLegacyFile(file, offset);
+
+        //第一次转码，结果在内存中并写入缓存
+        DDSTranscodeResult result;
+        CHECK(DDSTranscoder::TranscodeCached(cacheDir, sourcePath, *header, file.data() + offset, file.size() - offset, result));
+        CHECK(!result.Mapped.IsOpen());
+        const std::vector<uint8_t> first(result.GetData(), result.GetData() + result.GetSize());
+        std::vector<uint8_t> direct;
+        CHECK(DDSTranscoder::Transcode(*header, file.data() + offset, file.size() - offset, direct));
+        CHECK(first == direct);
+
+        //命中时只映射缓存文件，不读取源像素(传入空指针也能成功)
+        CHECK(DDSTranscoder::TranscodeCached(cacheDir, sourcePath, *header, nullptr, 0, result));
+        CHECK(result.Mapped.IsOpen());
+        CHECK(result.GetSize() == first.size() && std::memcmp(result.GetData(), first.data(), first.size()) == 0);
+
+        //源文件被替换(大小改变)后不再命中
+        std::vector<uint8_t> replaced = file;
+        replaced.push_back(0);
+        CHECK(FileUtil::WriteAllBytes(sourcePath, replaced.data(), replaced.size()));
+        CHECK(!DDSTranscoder::TranscodeCached(cacheDir, sourcePath, *header, nullptr, 0, result));
+        CHECK(DDSTranscoder::TranscodeCached(cacheDir, sourcePath, *header, file.data() + offset, file.size() - offset, result));
+        CHECK(!result.Mapped.IsOpen());
+
+        //没有源文件路径(从内存加载)或没有缓存目录时不使用缓存
+        CHECK(DDSTranscoder::TranscodeCached(cacheDir, L"", *header, file.data() + offset, file.size() - offset, result));
+        CHECK(!result.Mapped.IsOpen() && result.GetSize() == first.size());
+        CHECK(DDSTranscoder::TranscodeCached(L"", sourcePath, *header, file.data() + offset, file.size() - offset, result));
+        CHECK(!result.Mapped.IsOpen());
+    }
+}
+
+int main()
+{
+    TestRGB24();
+    TestX1R5G5B5();
+    TestCache();
+    return TestResult();
+}
@@ -0,0 +1,125 @@
+//DescriptorFreeList：在假的描述符堆上分配得到的CPU/GPU地址、释放后相邻区间合并、堆用尽时分配失败，以及非着色器可见的堆没有GPU地址
+
+#include "DescriptorFreeList.h"
+#include "TestCheck.h"
+
+namespace
+{
+    //假的堆：起始地址与增量随意取，只用来核对地址的计算
+    DescriptorHeapDesc MakeHeap(uint32_t capacity, bool shaderVisible)
+    {
+        DescriptorHeapDesc heap;
+        heap.CpuStart = 0x10000;
+        heap.GpuStart = shaderVisible ? 0x7f0000000000ull : 0;
+        heap.DescriptorSize = 32;
+        heap.Capacity = capacity;
+        return heap;
+    }
+
+    void TestAllocate()
+    {
+        DescriptorFreeList freeList(MakeHeap(64, true));
+        DescriptorRange a;
+        DescriptorRange b;
+        CHECK(freeList.Allocate(4, a));
+        CHECK(freeList.Allocate(10, b));
+        CHECK(a.IsValid() && b.IsValid());
+        CHECK_EQ(a.Count, 4u);
+        CHECK_EQ(b.Count, 10u);
+
+        //地址是堆起始加上区间偏移乘以增量，CPU与GPU偏移相同
+        CHECK_EQ(a.Cpu, 0x10000ull + 32ull * a.Range.Offset);
+        CHECK_EQ(b.Cpu, 0x10000ull + 32ull * b.Range.Offset);
+        CHECK_EQ(b.Gpu - 0x7f0000000000ull, b.Cpu - 0x10000ull);
+        CHECK(a.Range.Offset + a.Count <= b.Range.Offset || b.Range.Offset + b.Count <= a.Range.Offset);
+        CHECK_EQ(freeList.GetAllocator().GetFreeSize(), 50u);
+
+        //释放后range被重置，再次释放不做任何事
+        freeList.Free(a);
+        CHECK(!a.IsValid());
+        freeList.Free(a);
+        CHECK_EQ(freeList.GetAllocator().GetFreeSize(), 54u);
+        CHECK_EQ(freeList.GetAllocator().GetAllocationCount(), 1u);
+
+        //count为0时失败
+        CHECK(!freeList.Allocate(0, a));
+        CHECK(!a.IsValid());
+    }
+
+    void TestNotShaderVisible()
+    {
+        DescriptorFreeList freeList(MakeHeap(8, false));
+        DescriptorRange range;
+        CHECK(freeList.Allocate(3, range));
+        CHECK_EQ(range.Gpu, 0u);
+        CHECK(range.Cpu >= 0x10000ull);
+    }
+
+    //三段相邻的区间以任意顺序释放后合并成一个，可以再分配整个堆
+    void TestCoalesce()
+    {
+        DescriptorFreeList freeList(MakeHeap(30, true));
+        DescriptorRange ranges[3];
+        for (DescriptorRange& range : ranges)
+        {
+            CHECK(freeList.Allocate(10, range));
+        }
+        CHECK_EQ(freeList.GetAllocator().GetFreeSize(), 0u);
+
+        freeList.Free(ranges[0]);
+        freeList.Free(ranges[2]);
+        //中间的区间仍在使用，两侧的空闲区间不相邻
+        CHECK_EQ(freeList.GetAllocator().GetFreeBlockCount(), 2u);
+        CHECK_EQ(freeList.GetAllocator().GetLargestFreeBlock(), 10u);
+        DescriptorRange all;
+        CHECK(!freeList.Allocate(20, all));
+
+        freeList.Free(ranges[1]);
+        CHECK_EQ(freeList.GetAllocator().GetFreeBlockCount(), 1u);
+        CHECK_EQ(freeList.GetAllocator().GetLargestFreeBlock(), 30u);
+        CHECK(freeList.Allocate(30, all));
+        CHECK_EQ(all.Cpu, 0x10000ull);
+        CHECK_EQ(all.Gpu, 0x7f0000000000ull);
+    }
+
+    //堆用尽时分配失败且不影响已有的分配，释放之后又可以分配
+    void TestExhaustion()
+    {
+        DescriptorFreeList freeList(MakeHeap(16, false));
+        DescriptorRange ranges[16];
+        for (DescriptorRange& range : ranges)
+        {
+            CHECK(freeList.Allocate(1, range));
+        }
+        DescriptorRange extra;
+        CHECK(!freeList.Allocate(1, extra));
+        CHECK(!extra.IsValid());
+        CHECK(!freeList.Allocate(17, extra));
+        CHECK_EQ(freeList.GetAllocator().GetAllocationCount(), 16u);
+
+        //16个描述符的地址各不相同且都在堆内
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            CHECK(ranges[i].Cpu < 0x10000ull + 16 * 32);
+            for (uint32_t j = 0; j < i; ++j)
+            {
+                CHECK(ranges[i].Cpu != ranges[j].Cpu);
+            }
+        }
+
+        const uint64_t freed = ranges[5].Cpu;
+        freeList.Free(ranges[5]);
+        CHECK(freeList.Allocate(1, extra));
+        CHECK_EQ(extra.Cpu, freed);
+        CHECK(!freeList.Allocate(1, ranges[5]));
+    }
+}
+
+int main()
+{
+    TestAllocate();
+    TestNotShaderVisible();
+    TestCoalesce();
+    TestExhaustion();
+    return TestResult();
+}
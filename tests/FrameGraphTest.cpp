@@ -0,0 +1,226 @@
+//FrameGraph：剔除、按依赖分层排序、状态转换与最终转换、临时资源的内存复用与aliasing barrier、编译结果的缓存，
+//以及执行顺序切块后在多个上下文中并行录制
+
+#include <cstdio>
+#include <string>
+#include <utility>
+#include "FrameGraph.h"
+#include "TestCheck.h"
+
+namespace
+{
+    //与D3D12_RESOURCE_STATES的取值一致
+    const uint32_t StatePresent = 0;
+    const uint32_t StateRenderTarget = 0x4;
+    const uint32_t StateDepthWrite = 0x10;
+    const uint32_t StateShaderResource = 0x40 | 0x80;
+
+    //记录pass的执行顺序与插入的屏障
+    struct RecordContext
+    {
+        std::vector<std::string> Log;
+        std::vector<ResourceTransition> Barriers;
+        std::vector<std::pair<const void*, const void*>> Aliasing;
+
+        void ResourceBarrier(uint32_t count, const ResourceTransition* transitions)
+        {
+            Barriers.insert(Barriers.end(), transitions, transitions + count);
+        }
+
+        void AliasingBarrier(const void* before, const void* after)
+        {
+            Aliasing.push_back(std::make_pair(before, after));
+        }
+    };
+
+    typedef FrameGraph<RecordContext> Graph;
+
+    Graph::PassFunc LogPass(const char* name)
+    {
+        return [name](RecordContext& context) { context.Log.push_back(name); };
+    }
+
+    void TestCompile()
+    {
+        int backBuffer = 0;
+        int depthBuffer = 0;
+        int hdrTexture = 0;
+        int bloomTexture = 0;
+        int debugTexture = 0;
+        int copyTexture = 0;
+        Graph graph;
+
+        //每帧重新声明相同的拓扑，只在第一帧编译
+        for (int frame = 0; frame < 3; ++frame)
+        {
+            graph.Reset();
+            const uint32_t back = graph.ImportResource("BackBuffer", &backBuffer, StatePresent, StatePresent);
+            const uint32_t depth = graph.ImportResource("DepthStencil", &depthBuffer, StateDepthWrite, StateDepthWrite);
+            TransientResourceDesc desc;
+            desc.Size = 1 << 20;
+            const uint32_t hdr = graph.CreateTransient("HDR", desc);
+            const uint32_t bloom = graph.CreateTransient("Bloom", desc);
+            const uint32_t debug = graph.CreateTransient("Debug", desc);
+            const uint32_t copy = graph.CreateTransient("Copy", desc);
+            graph.SetResource(hdr, &hdrTexture);
+            graph.SetResource(bloom, &bloomTexture);
+            graph.SetResource(debug, &debugTexture);
+            graph.SetResource(copy, &copyTexture);
+
+            //名称按内容比较，每帧构造的字符串也能命中缓存
+            const std::string sceneName = "Scene";
+            const uint32_t debugPass = graph.AddPass("Debug", { { debug, StateRenderTarget, true } }, LogPass("Debug"));
+            graph.AddPass(sceneName.c_str(), { { hdr, StateRenderTarget, true }, { depth, StateDepthWrite, true } }, LogPass("Scene"));
+            graph.AddPass("Bloom", { { hdr, StateShaderResource, false }, { bloom, StateRenderTarget, true } }, LogPass("Bloom"));
+            graph.AddPass("Copy", { { copy, StateRenderTarget, true } }, LogPass("Copy"));
+            graph.AddPass("Tonemap", { { hdr, StateShaderResource, false }, { bloom, StateShaderResource, false }, { back, StateRenderTarget, true } },
+                LogPass("Tonemap"));
+            graph.AddPass("Overlay", { { copy, StateShaderResource, false }, { back, StateRenderTarget, true } }, LogPass("Overlay"));
+
+            CHECK_EQ(graph.Compile(), frame == 0);
+
+            RecordContext context;
+            graph.Execute(context);
+            graph.RecordFinalTransitions(context);
+
+            //Debug的结果没有被使用，被剔除；Copy与Scene在同一层，按声明顺序排在Bloom之前
+            const std::vector<std::string> expected = { "Scene", "Copy", "Bloom", "Tonemap", "Overlay" };
+            CHECK(context.Log == expected);
+            CHECK(graph.IsCulled(debugPass));
+            CHECK_EQ(graph.GetLevelCount(), 4u);
+
+            //Bloom之前hdr转为着色器资源，Tonemap之前bloom与后台缓冲区，Overlay之前copy，最后后台缓冲区转回呈现状态
+            CHECK_EQ(context.Barriers.size(), 5u);
+            if (context.Barriers.size() == 5)
+            {
+                CHECK(context.Barriers[0].Resource == &hdrTexture);
+                CHECK_EQ(context.Barriers[0].StateBefore, StateRenderTarget);
+                CHECK_EQ(context.Barriers[0].StateAfter, StateShaderResource);
+                CHECK(context.Barriers.back().Resource == &backBuffer);
+                CHECK_EQ(context.Barriers.back().StateBefore, StateRenderTarget);
+                CHECK_EQ(context.Barriers.back().StateAfter, StatePresent);
+            }
+            CHECK_EQ(graph.GetTransientInitialState(hdr), StateRenderTarget);
+            CHECK(graph.IsTransient(hdr) && !graph.IsTransient(back));
+            CHECK_EQ(graph.GetMemoryPlan().Placements[debug].Heap, TransientMemoryPlan::NoHeap);
+            CHECK_EQ(graph.GetMemoryPlan().Placements[back].Heap, TransientMemoryPlan::NoHeap);
+        }
+        CHECK_EQ(graph.GetStats().Compiles, 1u);
+        CHECK_EQ(graph.GetStats().CacheHits, 2u);
+    }
+
+    void TestAliasing()
+    {
+        int backBuffer = 0;
+        int textures[3] = {};
+        Graph graph;
+        TransientResourceDesc desc;
+        desc.Size = 1 << 20;
+        uint32_t back = graph.ImportResource("BackBuffer", &backBuffer, StatePresent, StatePresent);
+        const uint32_t a = graph.CreateTransient("A", desc);
+        const uint32_t b = graph.CreateTransient("B", desc);
+        const uint32_t c = graph.CreateTransient("C", desc);
+        graph.SetResource(a, &textures[0]);
+        graph.SetResource(b, &textures[1]);
+        graph.SetResource(c, &textures[2]);
+        graph.AddPass("A", { { a, StateRenderTarget, true } }, LogPass("A"));
+        graph.AddPass("B", { { a, StateShaderResource, false }, { b, StateRenderTarget, true } }, LogPass("B"));
+        graph.AddPass("C", { { b, StateShaderResource, false }, { c, StateRenderTarget, true } }, LogPass("C"));
+        graph.AddPass("Output", { { c, StateShaderResource, false }, { back, StateRenderTarget, true } }, LogPass("Output"));
+        CHECK(graph.Compile());
+
+        //A与C的生存期不重叠，共用内存，C第一次使用之前插入aliasing barrier
+        RecordContext context;
+        graph.Execute(context);
+        CHECK_EQ(graph.GetMemoryPlan().TotalBytes, 2u << 20);
+        CHECK_EQ(context.Aliasing.size(), 1u);
+        if (context.Aliasing.size() == 1)
+        {
+            CHECK(context.Aliasing[0].first == &textures[0]);
+            CHECK(context.Aliasing[0].second == &textures[2]);
+        }
+
+        //拓扑变化(导入资源的最终状态不同)时重新编译
+        graph.Reset();
+        back = graph.ImportResource("BackBuffer", &backBuffer, StatePresent, StateRenderTarget);
+        graph.AddPass("Output", { { back, StateRenderTarget, true } }, LogPass("Output"));
+        CHECK(graph.Compile());
+        CHECK(graph.GetFinalTransitions().empty());
+        CHECK_EQ(graph.GetStats().Compiles, 2u);
+    }
+
+    //声明中任何一项变化都重新编译，恢复后再次编译，与上次相同时复用
+    void TestCacheInvalidation()
+    {
+        int backBuffer = 0;
+        int texture = 0;
+        Graph graph;
+        auto declare = [&](const char* passName, uint32_t readState, uint64_t size, uint32_t finalState)
+        {
+            graph.Reset();
+            TransientResourceDesc desc;
+            desc.Size = size;
+            const uint32_t back = graph.ImportResource("BackBuffer", &backBuffer, StatePresent, finalState);
+            const uint32_t color = graph.CreateTransient("Color", desc);
+            graph.SetResource(color, &texture);
+            graph.AddPass("Draw", { { color, StateRenderTarget, true } }, LogPass("Draw"));
+            graph.AddPass(passName, { { color, readState, false }, { back, StateRenderTarget, true } }, LogPass(passName));
+            return graph.Compile();
+        };
+
+        CHECK(declare("Resolve", StateShaderResource, 1 << 20, StatePresent));
+        CHECK(!declare("Resolve", StateShaderResource, 1 << 20, StatePresent));
+        CHECK(declare("Blit", StateShaderResource, 1 << 20, StatePresent));
+        CHECK(declare("Resolve", StateShaderResource, 1 << 20, StatePresent));
+        CHECK(declare("Resolve", 0x800, 1 << 20, StatePresent));
+        CHECK(declare("Resolve", StateShaderResource, 2 << 20, StatePresent));
+        CHECK(declare("Resolve", StateShaderResource, 1 << 20, StateRenderTarget));
+        CHECK(!declare("Resolve", StateShaderResource, 1 << 20, StateRenderTarget));
+        CHECK_EQ(graph.GetStats().Compiles, 6u);
+        CHECK_EQ(graph.GetStats().CacheHits, 2u);
+    }
+
+    void TestParallelExecute()
+    {
+        int backBuffer = 0;
+        JobSystem jobs(3);
+        Graph graph;
+        const int passCount = 64;
+        static char names[passCount][16];
+        const uint32_t back = graph.ImportResource("BackBuffer", &backBuffer, StatePresent, StatePresent);
+        for (int i = 0; i < passCount; ++i)
+        {
+            std::snprintf(names[i], sizeof(names[i]), "Pass%d", i);
+            graph.AddPass(names[i], { { back, StateRenderTarget, true } },
+                [i](RecordContext& context) { context.Log.push_back(std::to_string(i)); });
+        }
+        graph.Compile();
+
+        //按上下文的顺序拼接后与单线程录制的顺序相同，状态转换只出现在第一块
+        RecordContext contexts[4];
+        RecordContext* pointers[4] = { &contexts[0], &contexts[1], &contexts[2], &contexts[3] };
+        graph.Execute(jobs, pointers, 4);
+        int next = 0;
+        bool ordered = true;
+        for (const RecordContext& context : contexts)
+        {
+            for (const std::string& entry : context.Log)
+            {
+                ordered = ordered && entry == std::to_string(next++);
+            }
+        }
+        CHECK(ordered);
+        CHECK_EQ(next, passCount);
+        CHECK_EQ(contexts[0].Barriers.size(), 1u);
+        CHECK(contexts[1].Barriers.empty() && contexts[3].Barriers.empty());
+    }
+}
+
+int main()
+{
+    TestCompile();
+    TestAliasing();
+    TestCacheInvalidation();
+    TestParallelExecute();
+    return TestResult();
+}
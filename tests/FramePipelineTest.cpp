@@ -0,0 +1,159 @@
+//FramePipeline：录制阶段总是读到本帧的快照、模式切换与丢弃、模拟出错后重新模拟，以及流水线模式下两个阶段确实重叠
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include "FramePipeline.h"
+#include "TestCheck.h"
+
+namespace
+{
+    //双缓冲的渲染快照，只记录是哪一帧模拟的
+    struct Snapshot
+    {
+        uint64_t Frame = ~0ull;
+    };
+
+    void TestSnapshots(JobSystem& jobs)
+    {
+        FramePipeline pipeline(jobs);
+        Snapshot snapshots[FramePipeline::SlotCount];
+        std::vector<uint64_t> recorded;
+        const FramePipeline::StageFunc simulate = [&](uint64_t frame, uint32_t slot) { snapshots[slot].Frame = frame; };
+        const FramePipeline::StageFunc record = [&](uint64_t frame, uint32_t slot)
+        {
+            CHECK_EQ(snapshots[slot].Frame, frame);
+            CHECK_EQ(slot, FramePipeline::SlotOf(frame));
+            recorded.push_back(frame);
+        };
+
+        //每5帧切换一次模式，帧序号连续且不重复
+        for (int i = 0; i < 20; ++i)
+        {
+            pipeline.SetPipelined((i / 5) % 2 == 1);
+            pipeline.RunFrame(simulate, record);
+        }
+        CHECK_EQ(recorded.size(), 20u);
+        for (size_t i = 0; i < recorded.size(); ++i)
+        {
+            CHECK_EQ(recorded[i], i);
+        }
+        CHECK_EQ(pipeline.GetFrameIndex(), 20u);
+
+        //丢弃已经模拟的快照后，下一帧重新模拟
+        pipeline.SetPipelined(true);
+        pipeline.RunFrame(simulate, record);
+        snapshots[FramePipeline::SlotOf(pipeline.GetFrameIndex())].Frame = ~0ull;
+        pipeline.DiscardPending();
+        pipeline.RunFrame(simulate, record);
+        CHECK_EQ(recorded.back(), 21u);
+    }
+
+    void TestSimulateError(JobSystem& jobs)
+    {
+        FramePipeline pipeline(jobs);
+        pipeline.SetPipelined(true);
+        Snapshot snapshots[FramePipeline::SlotCount];
+        bool fail = false;
+        const FramePipeline::StageFunc simulate = [&](uint64_t frame, uint32_t slot)
+        {
+            if (fail)
+            {
+                throw std::runtime_error("simulate failed");
+            }
+            snapshots[slot].Frame = frame;
+        };
+        uint64_t lastRecorded = ~0ull;
+        const FramePipeline::StageFunc record = [&](uint64_t frame, uint32_t slot)
+        {
+            CHECK_EQ(snapshots[slot].Frame, frame);
+            lastRecorded = frame;
+        };
+
+        pipeline.RunFrame(simulate, record);
+        //第1帧照常录制，同时模拟的第2帧失败
+        fail = true;
+        bool thrown = false;
+        try
+        {
+            pipeline.RunFrame(simulate, record);
+        }
+        catch (const std::runtime_error&)
+        {
+            thrown = true;
+        }
+        CHECK(thrown);
+        CHECK_EQ(lastRecorded, 1u);
+
+        //失败的快照不会被录制，下一帧先重新模拟
+        fail = false;
+        pipeline.RunFrame(simulate, record);
+        CHECK_EQ(lastRecorded, 2u);
+    }
+
+    //两个阶段之间的握手：流水线模式下，录制第N帧时等待第N+1帧的模拟开始，模拟则等到录制看见它之后才结束，
+    //因此重叠不依赖线程何时被调度；超时只用于在没有重叠时让测试失败而不是挂起
+    struct StageHandshake
+    {
+        std::mutex Mutex;
+        std::condition_variable Changed;
+        uint64_t SimulateStarted = 0;       //已经开始模拟的帧数
+        uint64_t RecordObserved = 0;        //录制阶段已经看见其模拟开始的帧数
+        bool Simulating = false;
+    };
+
+    const std::chrono::seconds HandshakeTimeout(10);
+
+    void TestOverlap(JobSystem& jobs, bool pipelined)
+    {
+        FramePipeline pipeline(jobs);
+        pipeline.SetPipelined(pipelined);
+        StageHandshake handshake;
+        const FramePipeline::StageFunc simulate = [&](uint64_t frame, uint32_t)
+        {
+            std::unique_lock<std::mutex> lock(handshake.Mutex);
+            handshake.Simulating = true;
+            handshake.SimulateStarted = frame + 1;
+            handshake.Changed.notify_all();
+            //流水线模式下第0帧之后的模拟与上一帧的录制同时进行，等录制确认后再结束
+            if (pipelined && frame > 0)
+            {
+                handshake.Changed.wait_for(lock, HandshakeTimeout, [&]() { return handshake.RecordObserved > frame; });
+            }
+            handshake.Simulating = false;
+        };
+        int overlaps = 0;
+        const FramePipeline::StageFunc record = [&](uint64_t frame, uint32_t)
+        {
+            std::unique_lock<std::mutex> lock(handshake.Mutex);
+            if (pipelined)
+            {
+                handshake.Changed.wait_for(lock, HandshakeTimeout, [&]() { return handshake.SimulateStarted > frame + 1; });
+            }
+            if (handshake.Simulating)
+            {
+                ++overlaps;
+                handshake.RecordObserved = frame + 2;
+                handshake.Changed.notify_all();
+            }
+        };
+        const int frameCount = 10;
+        for (int i = 0; i < frameCount; ++i)
+        {
+            pipeline.RunFrame(simulate, record);
+        }
+        //流水线模式下每帧的录制都与下一帧的模拟同时进行，串行模式下从不重叠
+        CHECK_EQ(overlaps, pipelined ? frameCount : 0);
+    }
+}
+
+int main()
+{
+    JobSystem jobs(2);
+    TestSnapshots(jobs);
+    TestSimulateError(jobs);
+    TestOverlap(jobs, false);
+    TestOverlap(jobs, true);
+    return TestResult();
+}
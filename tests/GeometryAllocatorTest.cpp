@@ -0,0 +1,152 @@
+//GeometryAllocator：顶点与索引的子分配与释放、分配失败时的回滚、16位索引的顶点数限制，以及暂存数据与复制目标的记录
+
+#include <cstring>
+#include "GeometryAllocator.h"
+#include "TestCheck.h"
+
+namespace
+{
+    //位置流12字节、颜色流16字节
+    const std::vector<uint32_t> Strides = { 12, 16 };
+
+    void TestAllocateFree()
+    {
+        GeometryAllocator allocator(Strides, 100, 300, 2);
+        GeometryAllocation box;
+        GeometryAllocation pyramid;
+        CHECK(allocator.Allocate(8, 36, box));
+        CHECK(allocator.Allocate(5, 18, pyramid));
+        CHECK(box.IsValid() && pyramid.IsValid());
+
+        //两个网格的顶点与索引区间互不重叠
+        CHECK(box.Vertices.Offset + box.Vertices.Size <= pyramid.Vertices.Offset ||
+            pyramid.Vertices.Offset + pyramid.Vertices.Size <= box.Vertices.Offset);
+        CHECK(box.Indices.Offset + box.Indices.Size <= pyramid.Indices.Offset ||
+            pyramid.Indices.Offset + pyramid.Indices.Size <= box.Indices.Offset);
+        CHECK_EQ(pyramid.BaseVertexLocation(), (int32_t)pyramid.Vertices.Offset);
+        CHECK_EQ(pyramid.StartIndexLocation(), pyramid.Indices.Offset);
+        CHECK_EQ(allocator.GetVertexAllocator().GetFreeSize(), 87u);
+        CHECK_EQ(allocator.GetIndexAllocator().GetFreeSize(), 246u);
+
+        //释放后分配记录清空，空间全部归还并合并
+        allocator.Free(box);
+        CHECK(!box.IsValid());
+        allocator.Free(pyramid);
+        CHECK_EQ(allocator.GetVertexAllocator().GetFreeSize(), 100u);
+        CHECK_EQ(allocator.GetIndexAllocator().GetFreeSize(), 300u);
+        CHECK_EQ(allocator.GetVertexAllocator().GetAllocationCount(), 0u);
+        CHECK_EQ(allocator.GetIndexAllocator().GetFreeBlockCount(), 1u);
+        CHECK(allocator.Allocate(100, 300, box));
+    }
+
+    //索引空间不足时已经分配的顶点要归还
+    void TestRollback()
+    {
+        GeometryAllocator allocator(Strides, 100, 30, 2);
+        GeometryAllocation allocation;
+        CHECK(!allocator.Allocate(10, 31, allocation));
+        CHECK(!allocation.IsValid());
+        CHECK_EQ(allocator.GetVertexAllocator().GetFreeSize(), 100u);
+        CHECK_EQ(allocator.GetVertexAllocator().GetAllocationCount(), 0u);
+
+        CHECK(!allocator.Allocate(101, 3, allocation));
+        CHECK(!allocator.Allocate(0, 3, allocation));
+        CHECK_EQ(allocator.GetIndexAllocator().GetFreeSize(), 30u);
+    }
+
+    void TestIndexSizeLimit()
+    {
+        GeometryAllocation allocation;
+        GeometryAllocator allocator16(Strides, 100000, 300, 2);
+        CHECK(!allocator16.Allocate(65537, 3, allocation));
+        CHECK_EQ(allocator16.GetVertexAllocator().GetFreeSize(), 100000u);
+        CHECK(allocator16.Allocate(65536, 3, allocation));
+
+        GeometryAllocator allocator32(Strides, 100000, 300, 4);
+        CHECK(allocator32.Allocate(65537, 3, allocation));
+    }
+
+    //每个流与索引各记录一次复制：目标偏移按步长换算，暂存数据按对齐放置且内容与写入的一致
+    void TestWrite()
+    {
+        GeometryAllocator allocator(Strides, 100, 300, 2);
+        GeometryAllocation first;
+        GeometryAllocation second;
+        CHECK(allocator.Allocate(3, 3, first));
+        CHECK(allocator.Allocate(2, 6, second));
+        CHECK(!allocator.HasPendingCopies());
+
+        std::vector<uint8_t> positions(3 * 12);
+        std::vector<uint8_t> colors(3 * 16);
+        for (size_t i = 0; i < positions.size(); ++i)
+        {
+            positions[i] = (uint8_t)i;
+        }
+        for (size_t i = 0; i < colors.size(); ++i)
+        {
+            colors[i] = (uint8_t)(100 + i);
+        }
+        const uint16_t indices[] = { 0, 1, 2, 2, 1, 0 };
+        const void* streams[] = { positions.data(), colors.data() };
+        allocator.Write(second, streams, indices);
+
+        const std::vector<GeometryCopy>& copies = allocator.GetPendingCopies();
+        CHECK_EQ(copies.size(), 3u);
+        CHECK_EQ(copies[0].Target, 0u);
+        CHECK_EQ(copies[0].DstOffset, 12ull * second.Vertices.Offset);
+        CHECK_EQ(copies[0].Size, 24u);
+        CHECK_EQ(copies[1].Target, 1u);
+        CHECK_EQ(copies[1].DstOffset, 16ull * second.Vertices.Offset);
+        CHECK_EQ(copies[1].Size, 32u);
+        CHECK_EQ(copies[2].Target, 2u);
+        CHECK_EQ(copies[2].DstOffset, 2ull * second.Indices.Offset);
+        CHECK_EQ(copies[2].Size, sizeof(indices));
+
+        const std::vector<uint8_t>& staging = allocator.GetStagingData();
+        for (const GeometryCopy& copy : copies)
+        {
+            CHECK_EQ(copy.SrcOffset % GeometryAllocator::StagingAlignment, 0u);
+            CHECK(copy.SrcOffset + copy.Size <= staging.size());
+        }
+        CHECK(memcmp(staging.data() + copies[0].SrcOffset, positions.data(), 24) == 0);
+        CHECK(memcmp(staging.data() + copies[1].SrcOffset, colors.data(), 32) == 0);
+        CHECK(memcmp(staging.data() + copies[2].SrcOffset, indices, sizeof(indices)) == 0);
+
+        std::vector<bool> touched = allocator.GetTouchedTargets();
+        CHECK_EQ(touched.size(), 3u);
+        CHECK(touched[0] && touched[1] && touched[2]);
+
+        allocator.ClearPending();
+        CHECK(!allocator.HasPendingCopies());
+        CHECK(allocator.GetStagingData().empty());
+
+        //不同目标的大小：顶点缓冲区为步长乘以容量，索引缓冲区为索引大小乘以容量
+        CHECK_EQ(allocator.GetTargetSize(0), 1200u);
+        CHECK_EQ(allocator.GetTargetSize(1), 1600u);
+        CHECK_EQ(allocator.GetTargetSize(2), 600u);
+    }
+
+    //没有顶点流时只写索引缓冲区
+    void TestIndexOnly()
+    {
+        GeometryAllocator allocator(std::vector<uint32_t>(), 10, 10, 4);
+        GeometryAllocation allocation;
+        CHECK(allocator.Allocate(1, 3, allocation));
+        const uint32_t indices[] = { 0, 0, 0 };
+        allocator.Write(allocation, nullptr, indices);
+        std::vector<bool> touched = allocator.GetTouchedTargets();
+        CHECK_EQ(touched.size(), 1u);
+        CHECK(touched[0]);
+        CHECK_EQ(allocator.GetPendingCopies()[0].Size, 12u);
+    }
+}
+
+int main()
+{
+    TestAllocateFree();
+    TestRollback();
+    TestIndexSizeLimit();
+    TestWrite();
+    TestIndexOnly();
+    return TestResult();
+}
@@ -0,0 +1,183 @@
+//GpuProfiler：时间戳后端换成生成假时间戳的实现，检查slot的读取时机、嵌套区间、超出容量的丢弃、时钟换算以及与CPU时间线的合并
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include "GpuProfiler.h"
+#include "Profiler.h"
+#include "TestCheck.h"
+
+namespace
+{
+    //每次WriteTimestamp时GPU时钟前进100个计数；GPU频率1MHz，CPU频率1GHz，GPU时钟的1000000对应CPU的5000000000
+    class FakeTimestampBackend : public IGpuTimestampBackend
+    {
+    public:
+        FakeTimestampBackend(uint32_t queryCount, uint32_t slotCount) :
+            Queries(queryCount, 0),
+            Readback(slotCount, std::vector<uint64_t>(queryCount, 0))
+        {
+        }
+
+        void WriteTimestamp(uint32_t query) override
+        {
+            if (query >= Queries.size())
+            {
+                ++OutOfRange;
+                return;
+            }
+            GpuClock += 100;
+            Queries[query] = GpuClock;
+        }
+
+        void ResolveTimestamps(uint32_t slot, uint32_t firstQuery, uint32_t count) override
+        {
+            ++Resolves;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                Readback[slot][i] = Queries[firstQuery + i];
+            }
+        }
+
+        void ReadTimestamps(uint32_t slot, uint32_t count, uint64_t* timestamps) override
+        {
+            ++Reads;
+            std::memcpy(timestamps, Readback[slot].data(), count * sizeof(uint64_t));
+        }
+
+        GpuClockCalibration GetCalibration() override
+        {
+            ++Calibrations;
+            GpuClockCalibration calibration;
+            calibration.GpuTimestamp = 1000000;
+            calibration.CpuTicks = 5000000000ll;
+            calibration.GpuFrequency = 1000000;
+            calibration.CpuFrequency = 1000000000;
+            return calibration;
+        }
+
+        uint64_t GpuClock = 1000000;
+        std::vector<uint64_t> Queries;
+        std::vector<std::vector<uint64_t>> Readback;
+        int Resolves = 0;
+        int Reads = 0;
+        int Calibrations = 0;
+        int OutOfRange = 0;
+    };
+
+    //与BoxApp的帧结构相同：Clear与Draw两个区间，Draw中嵌套一个区间，extra个额外的区间用于超出容量
+    void RecordFrame(GpuProfiler& profiler, uint32_t slot, int extra)
+    {
+        profiler.BeginFrame(slot);
+        profiler.BeginZone("Clear");
+        profiler.EndZone();
+        profiler.BeginZone("Draw");
+        profiler.BeginZone("Inner");
+        profiler.EndZone();
+        for (int i = 0; i < extra; ++i)
+        {
+            profiler.BeginZone("Extra");
+            profiler.EndZone();
+        }
+        profiler.EndZone();
+        profiler.EndFrame();
+    }
+
+    void TestCalibration()
+    {
+        GpuClockCalibration calibration;
+        calibration.GpuTimestamp = 100;
+        calibration.CpuTicks = 1000;
+        calibration.GpuFrequency = 10;
+        calibration.CpuFrequency = 1000;
+        CHECK_EQ(calibration.ToCpuTicks(110), 2000);
+        //早于校准点的时间戳向前换算
+        CHECK_EQ(calibration.ToCpuTicks(90), 0);
+    }
+
+    void TestZones()
+    {
+        const uint32_t maxZones = 3;
+        const uint32_t slotCount = 2;
+        FakeTimestampBackend backend(GpuProfiler::GetTimestampsPerSlot(maxZones) * slotCount, slotCount);
+        GpuProfiler profiler(backend, slotCount, maxZones);
+        CHECK_EQ(profiler.GetQueryCount(), static_cast<uint32_t>(backend.Queries.size()));
+
+        //两个slot都还在GPU上执行时不读取
+        RecordFrame(profiler, 0, 0);
+        CHECK_EQ(backend.Reads, 0);
+        RecordFrame(profiler, 1, 2);
+        CHECK_EQ(backend.Reads, 0);
+        CHECK_EQ(backend.Resolves, 2);
+        //第二帧超出容量的两个区间被丢弃
+        CHECK_EQ(profiler.GetDroppedZones(), 2u);
+        CHECK_EQ(backend.OutOfRange, 0);
+
+        //再次使用slot 0时读取它上一帧的结果
+        RecordFrame(profiler, 0, 0);
+        CHECK_EQ(backend.Reads, 1);
+        const std::vector<GpuZoneResult>& results = profiler.GetLastResults();
+        CHECK_EQ(results.size(), 4u);
+        if (results.size() == 4)
+        {
+            CHECK(std::strcmp(results[0].Name, "GPU Frame") == 0 && results[0].Depth == 0);
+            CHECK(std::strcmp(results[1].Name, "Clear") == 0 && results[1].Depth == 1);
+            CHECK(std::strcmp(results[2].Name, "Draw") == 0 && results[2].Depth == 1);
+            CHECK(std::strcmp(results[3].Name, "Inner") == 0 && results[3].Depth == 2);
+            //第一帧的第一个时间戳为1000100，即校准点之后100us
+            CHECK_EQ(results[0].Start, 5000000000ll + 100 * 1000);
+            for (const GpuZoneResult& zone : results)
+            {
+                CHECK(zone.Start <= zone.End);
+                CHECK(zone.Start >= results[0].Start && zone.End <= results[0].End);
+            }
+            CHECK(results[3].Start >= results[2].Start && results[3].End <= results[2].End);
+        }
+
+        //确认GPU执行完毕后可以直接读取，同一个slot不会重复读取
+        profiler.Collect(1);
+        CHECK_EQ(backend.Reads, 2);
+        CHECK_EQ(profiler.GetLastResults().size(), 4u);
+        profiler.Collect(1);
+        CHECK_EQ(backend.Reads, 2);
+        //校准只在第一次读取时进行，之后每CalibrationInterval次读取一次
+        CHECK_EQ(backend.Calibrations, 1);
+    }
+
+    void TestCpuTimeline()
+    {
+        const uint32_t maxZones = 4;
+        FakeTimestampBackend backend(GpuProfiler::GetTimestampsPerSlot(maxZones), 1);
+        GpuProfiler profiler(backend, 1, maxZones);
+
+        //先结束一帧，取走之前的测试提交的区间
+        Profiler::Get().BeginFrame();
+        Profiler::Get().EndFrame();
+
+        //GPU区间作为单独的轨道出现在CPU的帧与导出的trace中
+        Profiler::Get().BeginFrame();
+        RecordFrame(profiler, 0, 0);
+        profiler.Collect(0);
+        Profiler::Get().EndFrame();
+
+        ProfileFrame frame;
+        CHECK(Profiler::Get().GetLastFrame(frame));
+        size_t gpuEvents = 0;
+        for (const ProfileEvent& event : frame.Events)
+        {
+            gpuEvents += event.Name != nullptr && (std::strcmp(event.Name, "GPU Frame") == 0 || std::strcmp(event.Name, "Inner") == 0) ? 1 : 0;
+        }
+        CHECK_EQ(gpuEvents, 2u);
+        const std::string trace = Profiler::Get().ExportChromeTrace();
+        CHECK(trace.find("\"GPU\"") != std::string::npos);
+        CHECK(trace.find("GPU Frame") != std::string::npos);
+    }
+}
+
+int main()
+{
+    TestCalibration();
+    TestZones();
+    TestCpuTimeline();
+    return TestResult();
+}
@@ -0,0 +1,179 @@
+//JobSystem：ParallelFor的覆盖、任务中嵌套的fork/join、依赖顺序、Submit的结果以及异常的传递
+
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include "JobSystem.h"
+#include "TestCheck.h"
+
+namespace
+{
+    void TestParallelFor(JobSystem& jobs)
+    {
+        //每个下标恰好执行一次
+        std::vector<std::atomic<int>> hits(10000);
+        for (std::atomic<int>& hit : hits)
+        {
+            hit = 0;
+        }
+        //CHECK不是线程安全的，工作线程中只记录结果
+        std::atomic<bool> oversized(false);
+        jobs.ParallelFor(hits.size(), 7, [&](size_t begin, size_t end)
+        {
+            if (end - begin > 7)
+            {
+                oversized = true;
+            }
+            for (size_t i = begin; i < end; ++i)
+            {
+                ++hits[i];
+            }
+        });
+        CHECK(!oversized);
+        int wrong = 0;
+        for (std::atomic<int>& hit : hits)
+        {
+            wrong += hit.load() == 1 ? 0 : 1;
+        }
+        CHECK_EQ(wrong, 0);
+
+        //count为0时不调用func，grain为0时按1处理
+        bool called = false;
+        jobs.ParallelFor(0, 1, [&](size_t, size_t) { called = true; });
+        CHECK(!called);
+        std::atomic<size_t> total(0);
+        jobs.ParallelFor(10, 0, [&](size_t begin, size_t end) { total += end - begin; });
+        CHECK_EQ(total.load(), 10u);
+    }
+
+    void TestNested(JobSystem& jobs)
+    {
+        //任务中再派生并等待，工作线程不会因为等待而耗尽
+        std::atomic<int> sum(0);
+        JobCounter outer;
+        for (int i = 0; i < 16; ++i)
+        {
+            jobs.Run(outer, [&]()
+            {
+                jobs.ParallelFor(100, 3, [&](size_t begin, size_t end) { sum += static_cast<int>(end - begin); });
+            });
+        }
+        jobs.Wait(outer);
+        CHECK_EQ(sum.load(), 1600);
+    }
+
+    void TestDependencies(JobSystem& jobs)
+    {
+        std::vector<int> order;
+        std::mutex mutex;
+        JobCounter a;
+        JobCounter b;
+        JobCounter c;
+        jobs.Run(a, [&]()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(1);
+        });
+        jobs.Run(b, [&]() { std::lock_guard<std::mutex> lock(mutex); order.push_back(2); }, a);
+        jobs.Run(c, [&]() { std::lock_guard<std::mutex> lock(mutex); order.push_back(3); }, b);
+        jobs.Wait(c);
+        CHECK_EQ(order.size(), 3u);
+        CHECK(order.size() == 3 && order[0] == 1 && order[1] == 2 && order[2] == 3);
+
+        //依赖已经完成时立即执行
+        JobCounter d;
+        int value = 0;
+        jobs.Run(d, [&]() { value = 5; }, a);
+        jobs.Wait(d);
+        CHECK_EQ(value, 5);
+    }
+
+    void TestSubmitAndErrors(JobSystem& jobs)
+    {
+        JobCounter counter;
+        std::future<int> answer = jobs.Submit(counter, []() { return 42; });
+        std::future<int> failed = jobs.Submit(counter, []() -> int { throw std::runtime_error("submit"); });
+        jobs.Wait(counter);
+        CHECK_EQ(answer.get(), 42);
+        bool thrown = false;
+        try
+        {
+            failed.get();
+        }
+        catch (const std::runtime_error&)
+        {
+            thrown = true;
+        }
+        CHECK(thrown);
+
+        //ParallelFor中任意一块的异常在全部块结束后抛出
+        thrown = false;
+        try
+        {
+            jobs.ParallelFor(100, 1, [](size_t begin, size_t) { if (begin == 57) throw std::runtime_error("chunk"); });
+        }
+        catch (const std::runtime_error&)
+        {
+            thrown = true;
+        }
+        CHECK(thrown);
+
+        //Run的任务抛出的异常在Wait中重新抛出，之后计数可以继续使用
+        JobCounter reused;
+        jobs.Run(reused, []() { throw std::logic_error("run"); });
+        thrown = false;
+        try
+        {
+            jobs.Wait(reused);
+        }
+        catch (const std::logic_error&)
+        {
+            thrown = true;
+        }
+        CHECK(thrown);
+        bool ran = false;
+        jobs.Run(reused, [&]() { ran = true; });
+        jobs.Wait(reused);
+        CHECK(ran && reused.IsDone());
+
+        //计数在Wait返回后立即销毁
+        for (int i = 0; i < 2000; ++i)
+        {
+            JobCounter local;
+            jobs.Run(local, []() {});
+            jobs.Wait(local);
+        }
+    }
+
+    void TestShutdown()
+    {
+        //析构前已经进入队列的任务都会执行
+        std::atomic<int> count(0);
+        {
+            JobSystem jobs(2);
+            JobCounter counter;
+            for (int i = 0; i < 100; ++i)
+            {
+                jobs.Run(counter, [&]() { ++count; });
+            }
+            jobs.Wait(counter);
+            CHECK_EQ(jobs.GetStats().Executed, 100u);
+        }
+        CHECK_EQ(count.load(), 100);
+        CHECK(JobSystem::GetDefault().GetThreadCount() >= 1);
+    }
+}
+
+int main()
+{
+    JobSystem jobs(4);
+    CHECK_EQ(jobs.GetThreadCount(), 4u);
+    TestParallelFor(jobs);
+    TestNested(jobs);
+    TestDependencies(jobs);
+    TestSubmitAndErrors(jobs);
+    TestShutdown();
+    return TestResult();
+}
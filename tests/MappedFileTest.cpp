@@ -0,0 +1,104 @@
+//MappedFile：普通文件映射的内容与大小、空文件可以打开但没有数据、不存在的文件返回错误码，以及移动与重新打开时释放原来的映射
+
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "FileUtil.h"
+#include "MappedFile.h"
+#include "TestCheck.h"
+
+namespace
+{
+    const std::wstring NormalPath = L"MappedFileTest_normal.bin";
+    const std::wstring EmptyPath = L"MappedFileTest_empty.bin";
+    const std::wstring MissingPath = L"MappedFileTest_missing.bin";
+
+    void TestNormalFile()
+    {
+        std::vector<uint8_t> bytes(10000);
+        for (size_t i = 0; i < bytes.size(); ++i)
+        {
+            bytes[i] = (uint8_t)(i * 7 + 3);
+        }
+        CHECK(FileUtil::WriteAllBytes(NormalPath, bytes.data(), bytes.size()));
+
+        MappedFile file;
+        CHECK(!file.IsOpen());
+        CHECK(file.Open(NormalPath));
+        CHECK(file.IsOpen());
+        CHECK_EQ(file.GetError(), 0u);
+        CHECK_EQ(file.GetSize(), bytes.size());
+        CHECK(file.GetData() != nullptr);
+        if (file.GetData() != nullptr && file.GetSize() == bytes.size())
+        {
+            CHECK(memcmp(file.GetData(), bytes.data(), bytes.size()) == 0);
+        }
+
+        file.Close();
+        CHECK(!file.IsOpen());
+        CHECK(file.GetData() == nullptr);
+        CHECK_EQ(file.GetSize(), 0u);
+    }
+
+    void TestEmptyFile()
+    {
+        CHECK(FileUtil::WriteAllBytes(EmptyPath, nullptr, 0));
+
+        MappedFile file;
+        CHECK(file.Open(EmptyPath));
+        CHECK(file.IsOpen());
+        CHECK_EQ(file.GetError(), 0u);
+        CHECK_EQ(file.GetSize(), 0u);
+        CHECK(file.GetData() == nullptr);
+    }
+
+    void TestMissingFile()
+    {
+        MappedFile file;
+        CHECK(!file.Open(MissingPath));
+        CHECK(!file.IsOpen());
+        CHECK(file.GetError() != 0);
+        CHECK(file.GetData() == nullptr);
+
+        //打开失败时原来的映射也已关闭
+        CHECK(file.Open(NormalPath));
+        CHECK(!file.Open(MissingPath));
+        CHECK(!file.IsOpen());
+        CHECK(file.GetData() == nullptr);
+
+        //再次成功打开时清除错误码
+        CHECK(file.Open(EmptyPath));
+        CHECK_EQ(file.GetError(), 0u);
+    }
+
+    void TestMove()
+    {
+        MappedFile file;
+        CHECK(file.Open(NormalPath));
+        const uint8_t* data = file.GetData();
+        const size_t size = file.GetSize();
+
+        MappedFile moved(std::move(file));
+        CHECK(!file.IsOpen());
+        CHECK(file.GetData() == nullptr);
+        CHECK(moved.IsOpen());
+        CHECK(moved.GetData() == data);
+        CHECK_EQ(moved.GetSize(), size);
+
+        MappedFile assigned;
+        CHECK(assigned.Open(EmptyPath));
+        assigned = std::move(moved);
+        CHECK(assigned.GetData() == data);
+        CHECK_EQ(assigned.GetSize(), size);
+        CHECK(assigned.GetData()[1] == 10);
+    }
+}
+
+int main()
+{
+    TestNormalFile();
+    TestEmptyFile();
+    TestMissingFile();
+    TestMove();
+    return TestResult();
+}
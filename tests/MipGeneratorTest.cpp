@@ -0,0 +1,143 @@
+//MipGenerator：mip级数与每级尺寸、盒式滤波的平均值、sRGB在线性空间滤波、行填充与级数限制，以及不支持的格式
+
+#include <cstdlib>
+#include "MipGenerator.h"
+#include "TestCheck.h"
+
+namespace
+{
+    //width x height的RGBA8图像，每行末尾有padding字节的填充，像素值由fill(x, y, channel)给出
+    template<typename Fill>
+    std::vector<uint8_t> MakeImage(uint32_t width, uint32_t height, size_t padding, Fill fill)
+    {
+        const size_t rowPitch = width * 4 + padding;
+        std::vector<uint8_t> pixels(rowPitch * height, 0xcd);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                for (uint32_t c = 0; c < 4; ++c)
+                {
+                    pixels[y * rowPitch + x * 4 + c] = fill(x, y, c);
+                }
+            }
+        }
+        return pixels;
+    }
+
+    void TestMipCount()
+    {
+        CHECK_EQ(MipGenerator::CalcMipCount(1, 1), 1u);
+        CHECK_EQ(MipGenerator::CalcMipCount(2, 2), 2u);
+        CHECK_EQ(MipGenerator::CalcMipCount(256, 256), 9u);
+        CHECK_EQ(MipGenerator::CalcMipCount(256, 1), 9u);
+        CHECK_EQ(MipGenerator::CalcMipCount(5, 3), 3u);
+        CHECK_EQ(MipGenerator::CalcMipCount(1000, 600), 10u);
+    }
+
+    //每一级的尺寸减半且不小于1，行紧密排列；第0级是去掉行填充后的原图
+    void TestLevelLayout()
+    {
+        const uint32_t width = 13;
+        const uint32_t height = 6;
+        const std::vector<uint8_t> pixels = MakeImage(width, height, 12,
+            [](uint32_t x, uint32_t y, uint32_t c) { return (uint8_t)(x * 16 + y * 3 + c); });
+        const std::vector<MipLevel> levels = MipGenerator::GenerateRGBA8(
+            pixels.data(), width, height, width * 4 + 12, false);
+        CHECK_EQ(levels.size(), 4u);
+
+        const uint32_t expected[][2] = { { 13, 6 }, { 6, 3 }, { 3, 1 }, { 1, 1 } };
+        for (size_t i = 0; i < levels.size(); ++i)
+        {
+            CHECK_EQ(levels[i].Width, expected[i][0]);
+            CHECK_EQ(levels[i].Height, expected[i][1]);
+            CHECK_EQ(levels[i].RowPitch, levels[i].Width * 4u);
+            CHECK_EQ(levels[i].Pixels.size(), levels[i].RowPitch * levels[i].Height);
+        }
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width * 4; ++x)
+            {
+                CHECK_EQ(levels[0].Pixels[y * width * 4 + x], pixels[y * (width * 4 + 12) + x]);
+            }
+        }
+
+        //级数限制
+        CHECK_EQ(MipGenerator::GenerateRGBA8(pixels.data(), width, height, width * 4 + 12, false,
+            MipFilter::Box, 2).size(), 2u);
+        CHECK_EQ(MipGenerator::GenerateRGBA8(pixels.data(), width, height, width * 4 + 12, false,
+            MipFilter::Box, 100).size(), 4u);
+    }
+
+    //2x2的盒式滤波为4个像素的平均值
+    void TestBoxAverage()
+    {
+        const uint8_t pixels[16] =
+        {
+            0, 40, 200, 255,    100, 40, 0, 255,
+            0, 80, 200, 0,      100, 80, 0, 0
+        };
+        const std::vector<MipLevel> levels = MipGenerator::GenerateRGBA8(pixels, 2, 2, 8, false);
+        CHECK_EQ(levels.size(), 2u);
+        const uint8_t* p = levels[1].Pixels.data();
+        CHECK(std::abs(p[0] - 50) <= 1);
+        CHECK(std::abs(p[1] - 60) <= 1);
+        CHECK(std::abs(p[2] - 100) <= 1);
+        CHECK(std::abs(p[3] - 128) <= 1);
+    }
+
+    //sRGB图像在线性空间平均：黑白各半的平均值是线性的0.5，编码回sRGB约为188，而不是128；alpha不做sRGB转换
+    void TestSRGB()
+    {
+        const std::vector<uint8_t> pixels = MakeImage(2, 2, 0,
+            [](uint32_t x, uint32_t, uint32_t c) { return (uint8_t)(c == 3 ? 128 : (x == 0 ? 0 : 255)); });
+        const std::vector<MipLevel> srgb = MipGenerator::GenerateRGBA8(pixels.data(), 2, 2, 8, true);
+        CHECK(std::abs(srgb[1].Pixels[0] - 188) <= 1);
+        CHECK(std::abs(srgb[1].Pixels[3] - 128) <= 1);
+
+        const std::vector<MipLevel> linear = MipGenerator::GenerateRGBA8(pixels.data(), 2, 2, 8, false);
+        CHECK(std::abs(linear[1].Pixels[0] - 128) <= 1);
+    }
+
+    //单色图像在任何滤波器、任何尺寸下都保持不变(滤波器权重归一化)
+    void TestConstantImage()
+    {
+        const std::vector<uint8_t> pixels = MakeImage(37, 11, 0,
+            [](uint32_t, uint32_t, uint32_t c) { return (uint8_t)(30 + c * 60); });
+        const MipFilter filters[] = { MipFilter::Box, MipFilter::Kaiser };
+        for (MipFilter filter : filters)
+        {
+            const std::vector<MipLevel> levels = MipGenerator::GenerateRGBA8(
+                pixels.data(), 37, 11, 37 * 4, false, filter);
+            CHECK_EQ(levels.size(), 6u);
+            for (const MipLevel& level : levels)
+            {
+                for (size_t i = 0; i < level.Pixels.size(); ++i)
+                {
+                    CHECK(std::abs(level.Pixels[i] - (30 + int(i % 4) * 60)) <= 1);
+                }
+            }
+        }
+    }
+
+    void TestUnsupported()
+    {
+        const uint8_t pixels[16] = {};
+        CHECK(MipGenerator::IsSupportedFormat(DXGI_FORMAT_R8G8B8A8_UNORM));
+        CHECK(!MipGenerator::IsSupportedFormat(DXGI_FORMAT_BC1_UNORM));
+        CHECK(MipGenerator::Generate(pixels, 2, 2, 8, DXGI_FORMAT_BC1_UNORM).empty());
+        CHECK(MipGenerator::GenerateRGBA8(pixels, 0, 2, 8, false).empty());
+        CHECK(MipGenerator::GenerateRGBA8(nullptr, 2, 2, 8, false).empty());
+    }
+}
+
+int main()
+{
+    TestMipCount();
+    TestLevelLayout();
+    TestBoxAverage();
+    TestSRGB();
+    TestConstantImage();
+    TestUnsupported();
+    return TestResult();
+}
@@ -0,0 +1,212 @@
+//空后端与HeadlessFrameLoop：调用的记录与统计、BoxApp一帧的调用序列、fence延迟、跨队列等待以及在途帧数的限制
+
+#include <chrono>
+#include "HeadlessFrameLoop.h"
+#include "NullRenderBackend.h"
+#include "TestCheck.h"
+
+namespace
+{
+    typedef RecordingCommandList::Op Op;
+
+    const NullRenderCommandList& AsNull(const std::unique_ptr<IRenderCommandList>& list)
+    {
+        return static_cast<const NullRenderCommandList&>(*list);
+    }
+
+    void TestStats()
+    {
+        NullRenderDevice device;
+        std::unique_ptr<IRenderQueue> queue = device.CreateQueue(RenderQueueType::Direct);
+        std::unique_ptr<IRenderCommandList> list = device.CreateCommandList(RenderQueueType::Direct);
+
+        list->Reset(5);
+        const float color[4] = {};
+        list->ClearRenderTargetView(1, color);
+        for (int i = 0; i < 10; ++i)
+        {
+            list->DrawIndexedInstanced(36, 1, 0, 0, 0);
+        }
+        ResourceTransition transitions[3] = {};
+        list->ResourceBarrier(3, transitions);
+        list->CopyBufferRegion(1, 0, 2, 0, 1000);
+        list->Close();
+
+        //提交之前不计入设备的统计
+        CHECK_EQ(device.GetStats().Draws, 0u);
+        IRenderCommandList* lists[] = { list.get() };
+        queue->ExecuteCommandLists(1, lists);
+        device.CopyDescriptorsSimple(4, 0, 0, 0);
+        char data[64] = {};
+        device.WriteUploadBuffer(0, 0, data, sizeof(data));
+
+        const RenderBackendStats stats = device.GetStats();
+        CHECK_EQ(stats.CommandListsExecuted, 1u);
+        //Reset的初始PSO也算一次调用
+        CHECK_EQ(stats.Calls, 14u);
+        CHECK_EQ(stats.Draws, 10u);
+        CHECK_EQ(stats.Barriers, 3u);
+        CHECK_EQ(stats.BarrierCalls, 1u);
+        CHECK_EQ(stats.DescriptorWrites, 4u);
+        CHECK_EQ(stats.BytesUploaded, 64u);
+        CHECK_EQ(stats.BytesCopied, 1000u);
+
+        const std::vector<RecordingCommandList::Command>& commands = AsNull(list).GetRecording().GetCommands();
+        CHECK_EQ(commands.size(), 14u);
+        CHECK(commands.front().Type == Op::SetPipelineState && commands.front().Args[0] == 5);
+        CHECK(commands.back().Type == Op::CopyBufferRegion && commands.back().Args[2] == 1000);
+
+        device.ResetStats();
+        CHECK_EQ(device.GetStats().Calls, 0u);
+    }
+
+    //与BoxApp::Draw相同的调用顺序：转换到渲染目标、清除、RecordScene设置全部状态后绘制、时间戳、转换回呈现状态
+    void TestBoxAppFrame()
+    {
+        NullRenderDevice device;
+        std::unique_ptr<IRenderCommandList> list = device.CreateCommandList(RenderQueueType::Direct);
+        const uint64_t rtv = 0x100;
+        const uint64_t dsv = 0x200;
+        const RenderHandle heaps[] = { 7 };
+        const RenderViewport viewport = { 0.0f, 0.0f, 800.0f, 600.0f, 0.0f, 1.0f };
+        const RenderRect scissor = { 0, 0, 800, 600 };
+        const RenderVertexBufferView vertexBuffers[2] = {};
+        RenderIndexBufferView indexBuffer;
+        indexBuffer.BufferLocation = 0x3000;
+        const float color[4] = { 0.69f, 0.77f, 0.87f, 1.0f };
+        ResourceTransition toRenderTarget = {};
+        ResourceTransition toPresent = {};
+
+        list->Reset(1);
+        list->ResourceBarrier(1, &toRenderTarget);
+        list->ClearRenderTargetView(rtv, color);
+        list->ClearDepthStencilView(dsv, 0x3, 1.0f, 0);
+        list->RSSetViewports(1, &viewport);
+        list->RSSetScissorRects(1, &scissor);
+        list->OMSetRenderTargets(1, &rtv, &dsv);
+        list->SetDescriptorHeaps(1, heaps);
+        list->SetGraphicsRootSignature(2);
+        list->IASetVertexBuffers(0, 2, vertexBuffers);
+        list->IASetIndexBuffer(&indexBuffer);
+        list->IASetPrimitiveTopology(4);
+        list->SetGraphicsRootDescriptorTable(0, 0x4000);
+        list->DrawIndexedInstanced(36, 1, 0, 0, 0);
+        list->DrawIndexedInstanced(18, 1, 36, 8, 0);
+        list->EndQuery(9, 2, 1);
+        list->ResourceBarrier(1, &toPresent);
+        list->Close();
+
+        const Op expected[] =
+        {
+            Op::SetPipelineState, Op::ResourceBarrier, Op::ClearRenderTargetView, Op::ClearDepthStencilView,
+            Op::RSSetViewports, Op::RSSetScissorRects, Op::OMSetRenderTargets, Op::SetDescriptorHeaps,
+            Op::SetGraphicsRootSignature, Op::IASetVertexBuffers, Op::IASetIndexBuffer, Op::IASetPrimitiveTopology,
+            Op::SetGraphicsRootDescriptorTable, Op::DrawIndexedInstanced, Op::DrawIndexedInstanced, Op::EndQuery,
+            Op::ResourceBarrier,
+        };
+        const RecordingCommandList& recording = AsNull(list).GetRecording();
+        const std::vector<RecordingCommandList::Command>& commands = recording.GetCommands();
+        CHECK(recording.IsClosed());
+        CHECK_EQ(commands.size(), sizeof(expected) / sizeof(expected[0]));
+        for (size_t i = 0; i < commands.size() && i < sizeof(expected) / sizeof(expected[0]); ++i)
+        {
+            CHECK(commands[i].Type == expected[i]);
+        }
+
+        //参数按D3D12的含义记录
+        CHECK_EQ(commands[3].Args[0], dsv);
+        CHECK_EQ(commands[3].Args[1], 0x3u);
+        CHECK_EQ(commands[6].Args[1], dsv);
+        CHECK_EQ(commands[9].Args[1], 2u);
+        CHECK_EQ(commands[10].Args[0], 0x3000u);
+        CHECK_EQ(commands[14].Args[2], 36u);
+        CHECK_EQ(commands[14].Args[3], 8u);
+        CHECK(commands[15].Args[0] == 9 && commands[15].Args[1] == 2 && commands[15].Args[2] == 1);
+
+        //不绑定深度缓冲区时记录为0
+        list->Reset(0);
+        list->OMSetRenderTargets(1, &rtv, nullptr);
+        list->Close();
+        CHECK_EQ(AsNull(list).GetRecording().GetCommands().size(), 1u);
+        CHECK_EQ(AsNull(list).GetRecording().GetCommands()[0].Args[1], 0u);
+    }
+
+    void TestFences()
+    {
+        NullRenderConfig config;
+        config.FenceLatencyNs = 20000000;
+        NullRenderDevice device(config);
+        std::unique_ptr<IRenderQueue> direct = device.CreateQueue(RenderQueueType::Direct);
+        std::unique_ptr<IRenderQueue> copy = device.CreateQueue(RenderQueueType::Copy);
+        std::unique_ptr<IRenderFence> fence = device.CreateFence(0);
+        std::unique_ptr<IRenderFence> directFence = device.CreateFence(0);
+
+        //Signal之后要经过设定的延迟才完成
+        direct->Signal(*fence, 1);
+        CHECK_EQ(fence->GetCompletedValue(), 0u);
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        fence->WaitForValue(1);
+        const double waitedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        CHECK_EQ(fence->GetCompletedValue(), 1u);
+        CHECK(waitedMs >= 15.0);
+
+        //graphics队列在GPU端等待复制队列，之后Signal的值不会早于被等待的值完成
+        copy->Signal(*fence, 2);
+        direct->Wait(*fence, 2);
+        direct->Signal(*directFence, 1);
+        directFence->WaitForValue(1);
+        CHECK_EQ(fence->GetCompletedValue(), 2u);
+
+        const RenderBackendStats stats = device.GetStats();
+        CHECK_EQ(stats.Signals, 3u);
+        CHECK_EQ(stats.QueueWaits, 1u);
+    }
+
+    void TestHeadlessFrameLoop()
+    {
+        NullRenderConfig config;
+        config.GpuNsPerDraw = 2000;
+        config.FenceLatencyNs = 100000;
+        NullRenderDevice device(config);
+        HeadlessFrameStats stats;
+        {
+            HeadlessFrameLoop loop(device, 2);
+            stats = loop.Run(50, [](IRenderCommandList& list, uint64_t)
+            {
+                const float color[4] = {};
+                list.ClearRenderTargetView(0, color);
+                for (uint32_t i = 0; i < 100; ++i)
+                {
+                    list.SetGraphicsRootDescriptorTable(0, i);
+                    list.DrawIndexedInstanced(36, 1, 0, 0, 0);
+                }
+            });
+        }
+        CHECK_EQ(stats.FrameCount, 50u);
+        CHECK(stats.P50Ms <= stats.P95Ms && stats.P95Ms <= stats.MaxMs);
+        CHECK(stats.MeanMs > 0.0 && stats.MeanMs <= stats.MaxMs);
+
+        const RenderBackendStats backend = device.GetStats();
+        CHECK_EQ(backend.CommandListsExecuted, 50u);
+        CHECK_EQ(backend.Draws, 5000u);
+        CHECK_EQ(backend.Calls, 50u * 201u);
+        CHECK_EQ(backend.Signals, 50u);
+
+        //每帧的GPU时间(10ms)远大于录制时间，在途帧数达到上限后每帧都要等待
+        NullRenderConfig slowConfig;
+        slowConfig.FenceLatencyNs = 10000000;
+        NullRenderDevice slowDevice(slowConfig);
+        HeadlessFrameLoop slowLoop(slowDevice, 2);
+        const HeadlessFrameStats slowStats = slowLoop.Run(6, [](IRenderCommandList& list, uint64_t) { list.DrawInstanced(3, 1, 0, 0); });
+        CHECK(slowStats.WaitMs >= 20.0);
+    }
+}
+
+int main()
+{
+    TestStats();
+    TestBoxAppFrame();
+    TestFences();
+    TestHeadlessFrameLoop();
+    return TestResult();
+}
@@ -0,0 +1,128 @@
+//ParallelRecord：按列表顺序拼接后的命令与单线程录制相同，块的异常在全部录制结束后传给调用者
+
+#include <memory>
+#include <stdexcept>
+#include "ParallelRecord.h"
+#include "RecordingCommandList.h"
+#include "TestCheck.h"
+
+namespace
+{
+    typedef RecordingCommandList::Op Op;
+
+    //与BoxApp一样，每个列表先设置自己的状态，再逐个绘制；第i个绘制的startIndexLocation为i*36
+    void RecordDraws(RecordingCommandList& list, size_t begin, size_t end)
+    {
+        list.SetPipelineState(1);
+        list.SetGraphicsRootSignature(2);
+        list.IASetVertexBuffers(0, 1);
+        list.IASetIndexBuffer(3);
+        for (size_t i = begin; i < end; ++i)
+        {
+            list.SetGraphicsRootDescriptorTable(0, static_cast<uint32_t>(i));
+            list.DrawIndexedInstanced(36, 1, static_cast<uint32_t>(i) * 36, 0, 0);
+        }
+    }
+
+    struct ListSet
+    {
+        explicit ListSet(size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                Lists.emplace_back(new RecordingCommandList());
+                Raw.push_back(Lists.back().get());
+            }
+        }
+
+        std::vector<std::unique_ptr<RecordingCommandList>> Lists;
+        std::vector<RecordingCommandList*> Raw;
+    };
+
+    void TestOrder(JobSystem& jobs)
+    {
+        for (size_t listCount : { 1u, 2u, 3u, 5u, 8u })
+        {
+            for (size_t itemCount : { 0u, 1u, 7u, 100u })
+            {
+                ListSet set(listCount);
+                ParallelRecord(jobs, set.Raw.data(), listCount, itemCount,
+                    [](RecordingCommandList& list, size_t, size_t begin, size_t end) { RecordDraws(list, begin, end); });
+
+                std::vector<uint32_t> draws;
+                for (RecordingCommandList* list : set.Raw)
+                {
+                    //每个列表都独立设置了状态
+                    CHECK(!list->GetCommands().empty() && list->GetCommands()[0].Type == Op::SetPipelineState);
+                    for (const RecordingCommandList::Command& command : list->GetCommands())
+                    {
+                        if (command.Type == Op::DrawIndexedInstanced)
+                        {
+                            draws.push_back(command.Args[2] / 36);
+                        }
+                    }
+                }
+                CHECK_EQ(draws.size(), itemCount);
+                for (size_t i = 0; i < draws.size(); ++i)
+                {
+                    CHECK_EQ(draws[i], i);
+                }
+            }
+        }
+    }
+
+    void TestBalancedChunks(JobSystem& jobs)
+    {
+        //块的大小最多相差一个
+        ListSet set(3);
+        ParallelRecord(jobs, set.Raw.data(), 3, 10,
+            [](RecordingCommandList& list, size_t, size_t begin, size_t end) { RecordDraws(list, begin, end); });
+        for (RecordingCommandList* list : set.Raw)
+        {
+            size_t draws = 0;
+            for (const RecordingCommandList::Command& command : list->GetCommands())
+            {
+                draws += command.Type == Op::DrawIndexedInstanced ? 1 : 0;
+            }
+            CHECK(draws == 3 || draws == 4);
+        }
+    }
+
+    void TestException(JobSystem& jobs)
+    {
+        ListSet set(4);
+        bool thrown = false;
+        try
+        {
+            ParallelRecord(jobs, set.Raw.data(), 4, 40, [](RecordingCommandList& list, size_t index, size_t begin, size_t end)
+            {
+                if (index == 2)
+                {
+                    throw std::runtime_error("record failed");
+                }
+                RecordDraws(list, begin, end);
+            });
+        }
+        catch (const std::runtime_error&)
+        {
+            thrown = true;
+        }
+        CHECK(thrown);
+        //其他块照常录制完成
+        CHECK(!set.Raw[0]->GetCommands().empty());
+        CHECK(!set.Raw[3]->GetCommands().empty());
+        CHECK(set.Raw[2]->GetCommands().empty());
+    }
+}
+
+int main()
+{
+    JobSystem jobs(3);
+    TestOrder(jobs);
+    TestBalancedChunks(jobs);
+    TestException(jobs);
+    //只有一个工作线程时调用线程也参与录制
+    JobSystem single(1);
+    TestOrder(single);
+    return TestResult();
+}
@@ -0,0 +1,252 @@
+//PipelineLibrary：键的构造、同一键只创建一次、驱动缓存写回磁盘以及创建失败不缓存
+//对象为shared_ptr<int>，值1表示由磁盘上的驱动缓存创建，值2表示从头创建；描述为字符串
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include "PipelineLibrary.h"
+#include "TestCheck.h"
+#include "TestFiles.h"
+
+namespace
+{
+    typedef std::shared_ptr<int> Pipeline;
+    typedef PipelineLibrary<Pipeline, std::string> Library;
+
+    const uint8_t BlobMagic = 42;
+
+    struct StubDriver
+    {
+        std::atomic<int> Creates{ 0 };
+        std::atomic<int> FromBlob{ 0 };
+
+        Library::CreateFunc MakeCreate()
+        {
+            return [this](const std::string&, const std::vector<uint8_t>& cachedBlob, std::vector<uint8_t>& newBlob)
+            {
+                //较长的创建时间让并发的请求有机会撞到同一个键
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                ++Creates;
+                if (!cachedBlob.empty() && cachedBlob[0] == BlobMagic)
+                {
+                    ++FromBlob;
+                    newBlob = cachedBlob;
+                    return std::make_shared<int>(1);
+                }
+                newBlob.assign(100, BlobMagic);
+                return std::make_shared<int>(2);
+            };
+        }
+    };
+
+    //同一个键总是对应同一个描述，测试碰撞时再人为构造不同的描述
+    Library::DescPtr Describe(uint64_t key)
+    {
+        return std::make_shared<const std::string>("pipeline " + std::to_string(key));
+    }
+
+    void TestKeyBuilder()
+    {
+        PipelineKeyBuilder a;
+        PipelineKeyBuilder b;
+        a.Add(1u).Add(2.0f).AddString("POSITION");
+        b.Add(1u).Add(2.0f).AddString("POSITION");
+        CHECK_EQ(a.GetKey(), b.GetKey());
+
+        PipelineKeyBuilder c;
+        c.Add(1u).Add(2.0f).AddString("POSITIOM");
+        CHECK(c.GetKey() != a.GetKey());
+
+        //相邻字符串交换边界后键不同
+        PipelineKeyBuilder d1;
+        PipelineKeyBuilder d2;
+        d1.AddString("ab").AddString("c");
+        d2.AddString("a").AddString("bc");
+        CHECK(d1.GetKey() != d2.GetKey());
+
+        PipelineKeyBuilder n1;
+        PipelineKeyBuilder n2;
+        n1.AddString(nullptr);
+        n2.AddString("");
+        CHECK(n1.GetKey() != n2.GetKey());
+
+        //种子不同键不同
+        CHECK(PipelineKeyBuilder(1).Add(0u).GetKey() != PipelineKeyBuilder(2).Add(0u).GetKey());
+    }
+
+    void TestConcurrentCreate(const std::wstring& dir)
+    {
+        StubDriver driver;
+        const Library::CreateFunc create = driver.MakeCreate();
+        Library library(dir);
+        {
+            JobSystem jobs(4);
+            JobCounter counter;
+            std::vector<std::shared_future<Pipeline>> futures;
+            for (int i = 0; i < 32; ++i)
+            {
+                futures.push_back(library.Precompile(100 + i % 8, Describe(100 + i % 8), create, jobs, counter));
+            }
+            //Precompile进行中的同时其他线程Get相同的键
+            std::vector<std::thread> threads;
+            std::atomic<int> missing(0);
+            for (int t = 0; t < 4; ++t)
+            {
+                threads.emplace_back([&]()
+                {
+                    for (int k = 0; k < 8; ++k)
+                    {
+                        if (!library.Get(100 + k, Describe(100 + k), create))
+                        {
+                            ++missing;
+                        }
+                    }
+                });
+            }
+            for (std::thread& thread : threads)
+            {
+                thread.join();
+            }
+            jobs.Wait(counter);
+            for (std::shared_future<Pipeline>& future : futures)
+            {
+                CHECK(future.get() && *future.get() == 2);
+            }
+            CHECK_EQ(missing.load(), 0);
+        }
+
+        CHECK_EQ(driver.Creates.load(), 8);
+        Pipeline pipeline;
+        CHECK(library.TryGet(103, *Describe(103), pipeline) && *pipeline == 2);
+        CHECK(!library.TryGet(999, *Describe(999), pipeline));
+
+        const PipelineLibraryStats stats = library.GetStats();
+        CHECK_EQ(stats.Created, 8u);
+        CHECK_EQ(stats.DiskHits, 0u);
+        CHECK_EQ(stats.CreateFailures, 0u);
+        //其余的请求要么命中内存，要么与正在进行的创建合并
+        CHECK(stats.MemoryHits + stats.Deduplicated > 0);
+
+        //已经创建的键再次Precompile直接返回结果
+        JobSystem jobs(1);
+        JobCounter counter;
+        std::shared_future<Pipeline> ready = library.Precompile(100, Describe(100), create, jobs, counter);
+        CHECK(ready.get() && *ready.get() == 2);
+        jobs.Wait(counter);
+        CHECK_EQ(driver.Creates.load(), 8);
+    }
+
+    void TestDiskBlobs(const std::wstring& dir)
+    {
+        //上一个库写回的驱动缓存在新库中使用
+        StubDriver driver;
+        Library library(dir);
+        for (int k = 0; k < 8; ++k)
+        {
+            Pipeline pipeline = library.Get(100 + k, Describe(100 + k), driver.MakeCreate());
+            CHECK(pipeline && *pipeline == 1);
+        }
+        CHECK_EQ(driver.FromBlob.load(), 8);
+        CHECK_EQ(library.GetStats().DiskHits, 8u);
+        CHECK_EQ(library.GetStats().Created, 0u);
+
+        //没有缓存目录时只使用内存缓存
+        StubDriver memoryDriver;
+        Library memoryOnly(L"");
+        CHECK(*memoryOnly.Get(100, Describe(100), memoryDriver.MakeCreate()) == 2);
+        CHECK(*memoryOnly.Get(100, Describe(100), memoryDriver.MakeCreate()) == 2);
+        CHECK_EQ(memoryDriver.Creates.load(), 1);
+        CHECK_EQ(memoryOnly.GetStats().MemoryHits, 1u);
+    }
+
+    void TestFailure()
+    {
+        Library library(L"");
+        int failures = 0;
+        const Library::CreateFunc fail = [&](const std::string&, const std::vector<uint8_t>&, std::vector<uint8_t>&)
+        {
+            ++failures;
+            return Pipeline();
+        };
+        //失败的结果不缓存，下次Get重新创建
+        CHECK(!library.Get(5, Describe(5), fail));
+        CHECK(!library.Get(5, Describe(5), fail));
+        CHECK_EQ(failures, 2);
+        CHECK_EQ(library.GetStats().CreateFailures, 2u);
+        Pipeline pipeline;
+        CHECK(!library.TryGet(5, *Describe(5), pipeline));
+
+        //create抛出的异常传给调用者，之后同一个键仍可以创建
+        bool thrown = false;
+        try
+        {
+            library.Get(6, Describe(6), [](const std::string&, const std::vector<uint8_t>&, std::vector<uint8_t>&) -> Pipeline
+            {
+                throw std::runtime_error("device removed");
+            });
+        }
+        catch (const std::runtime_error&)
+        {
+            thrown = true;
+        }
+        CHECK(thrown);
+        StubDriver driver;
+        CHECK(library.Get(6, Describe(6), driver.MakeCreate()));
+    }
+
+    void TestKeyCollision()
+    {
+        //两个不同的描述落在同一个键上：第二个照常创建，但不进入缓存，也不会拿到第一个的对象
+        StubDriver driver;
+        Library library(L"");
+        const auto first = std::make_shared<const std::string>("opaque");
+        const auto second = std::make_shared<const std::string>("transparent");
+
+        Pipeline a = library.Get(7, first, driver.MakeCreate());
+        Pipeline b = library.Get(7, second, driver.MakeCreate());
+        CHECK(a && b && a != b);
+        CHECK_EQ(library.GetStats().KeyCollisions, 1u);
+
+        Pipeline cached;
+        CHECK(library.TryGet(7, *first, cached) && cached == a);
+        CHECK(!library.TryGet(7, *second, cached));
+        CHECK(library.Get(7, first, driver.MakeCreate()) == a);
+
+        JobSystem jobs(1);
+        JobCounter counter;
+        Pipeline c = library.Precompile(7, second, driver.MakeCreate(), jobs, counter).get();
+        jobs.Wait(counter);
+        CHECK(c && c != a);
+        CHECK_EQ(library.GetStats().KeyCollisions, 2u);
+        CHECK_EQ(driver.Creates.load(), 3);
+    }
+
+    void TestPrecompileDedupAtSubmit()
+    {
+        //只有一个工作线程：同一个键的第二次Precompile直接拿到正在创建的future，不派生等待它的任务
+        StubDriver driver;
+        Library library(L"");
+        JobSystem jobs(1);
+        JobCounter counter;
+        std::shared_future<Pipeline> first = library.Precompile(9, Describe(9), driver.MakeCreate(), jobs, counter);
+        std::shared_future<Pipeline> second = library.Precompile(9, Describe(9), driver.MakeCreate(), jobs, counter);
+        jobs.Wait(counter);
+        CHECK(first.get() && first.get() == second.get());
+        CHECK_EQ(driver.Creates.load(), 1);
+        CHECK(jobs.GetStats().Executed <= 1u);
+    }
+}
+
+int main()
+{
+    const std::wstring dir = MakeTestDirectory(L"PipelineLibraryTest");
+    TestKeyBuilder();
+    TestConcurrentCreate(dir);
+    TestDiskBlobs(dir);
+    TestFailure();
+    TestKeyCollision();
+    TestPrecompileDedupAtSubmit();
+    return TestResult();
+}
@@ -0,0 +1,398 @@
+//Profiler：区间的嵌套层数、多个线程各自累加的计数器、线程缓冲区写满时的丢弃计数，以及导出的Chrome trace是合法的JSON
+
+#include <cctype>
+#include <cstring>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Profiler.h"
+#include "TestCheck.h"
+
+namespace
+{
+    //最小的JSON解析器，只验证语法并统计"ph":"X"的对象个数
+    class JsonChecker
+    {
+    public:
+        explicit JsonChecker(const std::string& text) : mText(text) {}
+
+        bool Parse()
+        {
+            SkipSpace();
+            if (!ParseValue())
+            {
+                return false;
+            }
+            SkipSpace();
+            return mPos == mText.size();
+        }
+
+        size_t GetCompleteEventCount() const { return mCompleteEvents; }
+
+    private:
+        void SkipSpace()
+        {
+            while (mPos < mText.size() && strchr(" \t\r\n", mText[mPos]) != nullptr)
+            {
+                ++mPos;
+            }
+        }
+
+        bool Consume(char c)
+        {
+            SkipSpace();
+            if (mPos < mText.size() && mText[mPos] == c)
+            {
+                ++mPos;
+                return true;
+            }
+            return false;
+        }
+
+        bool ParseValue()
+        {
+            SkipSpace();
+            if (mPos >= mText.size())
+            {
+                return false;
+            }
+            const char c = mText[mPos];
+            if (c == '{')
+            {
+                return ParseObject();
+            }
+            if (c == '[')
+            {
+                return ParseArray();
+            }
+            if (c == '"')
+            {
+                std::string value;
+                return ParseString(value);
+            }
+            return ParseNumber();
+        }
+
+        bool ParseObject()
+        {
+            ++mPos;
+            if (Consume('}'))
+            {
+                return true;
+            }
+            do
+            {
+                std::string key;
+                SkipSpace();
+                if (!ParseString(key) || !Consume(':'))
+                {
+                    return false;
+                }
+                SkipSpace();
+                if (key == "ph" && mText.compare(mPos, 3, "\"X\"") == 0)
+                {
+                    ++mCompleteEvents;
+                }
+                if (!ParseValue())
+                {
+                    return false;
+                }
+            } while (Consume(','));
+            return Consume('}');
+        }
+
+        bool ParseArray()
+        {
+            ++mPos;
+            if (Consume(']'))
+            {
+                return true;
+            }
+            do
+            {
+                if (!ParseValue())
+                {
+                    return false;
+                }
+            } while (Consume(','));
+            return Consume(']');
+        }
+
+        bool ParseString(std::string& value)
+        {
+            if (mPos >= mText.size() || mText[mPos] != '"')
+            {
+                return false;
+            }
+            for (++mPos; mPos < mText.size(); ++mPos)
+            {
+                const unsigned char c = mText[mPos];
+                if (c == '"')
+                {
+                    ++mPos;
+                    return true;
+                }
+                if (c < 0x20)
+                {
+                    return false;
+                }
+                if (c == '\\')
+                {
+                    if (++mPos >= mText.size())
+                    {
+                        return false;
+                    }
+                    const char e = mText[mPos];
+                    if (e == 'u')
+                    {
+                        for (int i = 0; i < 4; ++i)
+                        {
+                            if (++mPos >= mText.size() || !isxdigit((unsigned char)mText[mPos]))
+                            {
+                                return false;
+                            }
+                        }
+                    }
+                    else if (strchr("\"\\/bfnrt", e) == nullptr)
+                    {
+                        return false;
+                    }
+                    value += e;
+                    continue;
+                }
+                value += (char)c;
+            }
+            return false;
+        }
+
+        bool ParseNumber()
+        {
+            const size_t start = mPos;
+            if (mPos < mText.size() && mText[mPos] == '-')
+            {
+                ++mPos;
+            }
+            bool digits = false;
+            while (mPos < mText.size() && (isdigit((unsigned char)mText[mPos]) || mText[mPos] == '.' ||
+                mText[mPos] == 'e' || mText[mPos] == 'E' || mText[mPos] == '+' || mText[mPos] == '-'))
+            {
+                digits |= isdigit((unsigned char)mText[mPos]) != 0;
+                ++mPos;
+            }
+            return digits && mPos > start;
+        }
+
+    private:
+        const std::string& mText;
+        size_t mPos = 0;
+        size_t mCompleteEvents = 0;
+    };
+
+    //取出目前为止记录的全部内容，作为一帧
+    ProfileFrame CollectFrame()
+    {
+        Profiler& profiler = Profiler::Get();
+        profiler.BeginFrame();
+        profiler.EndFrame();
+        ProfileFrame frame;
+        CHECK(profiler.GetLastFrame(frame));
+        return frame;
+    }
+
+    const ProfileEvent* FindEvent(const ProfileFrame& frame, const char* name)
+    {
+        for (const ProfileEvent& event : frame.Events)
+        {
+            if (event.Name == name)
+            {
+                return &event;
+            }
+        }
+        return nullptr;
+    }
+
+    void TestNesting()
+    {
+        static const char* outerName = "Outer";
+        static const char* middleName = "Middle";
+        static const char* innerName = "Inner";
+        static const char* siblingName = "Sibling";
+        CollectFrame();
+        {
+            ProfileScope outer(outerName);
+            {
+                ProfileScope middle(middleName);
+                ProfileScope inner(innerName);
+            }
+            ProfileScope sibling(siblingName);
+        }
+        const ProfileFrame frame = CollectFrame();
+        CHECK_EQ(frame.Events.size(), 4u);
+
+        const ProfileEvent* outer = FindEvent(frame, outerName);
+        const ProfileEvent* middle = FindEvent(frame, middleName);
+        const ProfileEvent* inner = FindEvent(frame, innerName);
+        const ProfileEvent* sibling = FindEvent(frame, siblingName);
+        CHECK(outer != nullptr && middle != nullptr && inner != nullptr && sibling != nullptr);
+        if (outer == nullptr || middle == nullptr || inner == nullptr || sibling == nullptr)
+        {
+            return;
+        }
+        CHECK_EQ(outer->Depth, 0u);
+        CHECK_EQ(middle->Depth, 1u);
+        CHECK_EQ(inner->Depth, 2u);
+        CHECK_EQ(sibling->Depth, 1u);
+
+        //内层区间落在外层区间之内，事件按开始时间排序
+        CHECK(outer->Start <= middle->Start && middle->Start <= inner->Start);
+        CHECK(inner->End <= middle->End && middle->End <= sibling->Start && sibling->End <= outer->End);
+        for (size_t i = 1; i < frame.Events.size(); ++i)
+        {
+            CHECK(frame.Events[i - 1].Start <= frame.Events[i].Start);
+        }
+        CHECK_EQ(outer->Thread, inner->Thread);
+
+        //关闭时不记录
+        Profiler::Get().SetEnabled(false);
+        {
+            ProfileScope scope(outerName);
+            Profiler::Get().AddCounter(ProfileCounter::Draws, 1);
+        }
+        Profiler::Get().SetEnabled(true);
+        const ProfileFrame disabled = CollectFrame();
+        CHECK(disabled.Events.empty());
+        CHECK_EQ(disabled.Counters[(size_t)ProfileCounter::Draws], 0u);
+    }
+
+    //每个线程有自己的缓冲区与线程序号，计数器在EndFrame时合计并清零
+    void TestThreadCounters()
+    {
+        static const char* workName = "Work";
+        const int threadCount = 4;
+        const int callsPerThread = 100;
+        CollectFrame();
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadCount; ++t)
+        {
+            threads.emplace_back([t]()
+            {
+                for (int i = 0; i < callsPerThread; ++i)
+                {
+                    PROFILE_SCOPE(workName);
+                    Profiler::Get().AddCounter(ProfileCounter::Draws, 1);
+                    Profiler::Get().AddCounter(ProfileCounter::Triangles, t + 1);
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        Profiler::Get().AddCounter(ProfileCounter::Barriers, 7);
+
+        const ProfileFrame frame = CollectFrame();
+        CHECK_EQ(frame.Counters[(size_t)ProfileCounter::Draws], uint64_t(threadCount * callsPerThread));
+        CHECK_EQ(frame.Counters[(size_t)ProfileCounter::Triangles], uint64_t(callsPerThread * (1 + 2 + 3 + 4)));
+        CHECK_EQ(frame.Counters[(size_t)ProfileCounter::Barriers], 7u);
+        CHECK_EQ(frame.Counters[(size_t)ProfileCounter::Instances], 0u);
+        CHECK_EQ(frame.DroppedEvents, 0u);
+
+        std::set<uint32_t> threadIds;
+        size_t workEvents = 0;
+        for (const ProfileEvent& event : frame.Events)
+        {
+            if (event.Name == workName)
+            {
+                ++workEvents;
+                threadIds.insert(event.Thread);
+                CHECK_EQ(event.Depth, 0u);
+            }
+        }
+        CHECK_EQ(workEvents, size_t(threadCount * callsPerThread));
+        CHECK_EQ(threadIds.size(), size_t(threadCount));
+
+        const std::vector<ProfileZoneTotal> totals = Profiler::SummarizeZones(frame);
+        CHECK_EQ(totals.size(), 1u);
+        CHECK_EQ(totals[0].Calls, uint32_t(threadCount * callsPerThread));
+
+        //已经取出，下一帧为零
+        const ProfileFrame next = CollectFrame();
+        CHECK_EQ(next.Counters[(size_t)ProfileCounter::Draws], 0u);
+        CHECK(next.Events.empty());
+    }
+
+    //两次EndFrame之间记录的区间超过环形缓冲区容量时，多出的部分丢弃并计数，已经记录的不被覆盖
+    void TestDroppedEvents()
+    {
+        static const char* spamName = "Spam";
+        const uint32_t recorded = 20000;
+        CollectFrame();
+
+        std::thread producer([recorded]()
+        {
+            for (uint32_t i = 0; i < recorded; ++i)
+            {
+                PROFILE_SCOPE(spamName);
+            }
+        });
+        producer.join();
+
+        const ProfileFrame frame = CollectFrame();
+        CHECK(frame.DroppedEvents > 0);
+        CHECK_EQ(frame.Events.size() + frame.DroppedEvents, uint64_t(recorded));
+        for (size_t i = 1; i < frame.Events.size(); ++i)
+        {
+            CHECK(frame.Events[i - 1].End <= frame.Events[i].Start);
+        }
+
+        //丢弃计数按帧清零
+        CHECK_EQ(CollectFrame().DroppedEvents, 0u);
+    }
+
+    //导出的JSON可以解析；区间名中的引号、反斜杠与控制字符经过转义
+    void TestChromeTrace()
+    {
+        static const char* trickyName = "Quote\" Backslash\\ Tab\t";
+        static const char* trackName = "GPU \"Queue\"";
+        Profiler& profiler = Profiler::Get();
+        profiler.SetHistorySize(2);
+        profiler.SetThreadName("Main \"thread\"");
+
+        const uint32_t track = profiler.RegisterTrack(trackName);
+        profiler.BeginFrame();
+        {
+            ProfileScope scope(trickyName);
+        }
+        ProfileEvent gpu;
+        gpu.Name = trickyName;
+        gpu.Start = ProfilerClock::Now();
+        gpu.End = gpu.Start + 10;
+        gpu.Thread = track;
+        profiler.SubmitEvents(&gpu, 1);
+        profiler.AddCounter(ProfileCounter::BytesUploaded, 4096);
+        profiler.EndFrame();
+        profiler.BeginFrame();
+        profiler.EndFrame();
+
+        const std::string trace = profiler.ExportChromeTrace();
+        JsonChecker checker(trace);
+        CHECK(checker.Parse());
+        //历史中的两帧各一个帧区间，加上第一帧的CPU与GPU区间
+        CHECK_EQ(checker.GetCompleteEventCount(), 4u);
+        CHECK(trace.find("\"traceEvents\"") != std::string::npos);
+        CHECK(trace.find("Quote\\\" Backslash\\\\ Tab\\u0009") != std::string::npos);
+        CHECK(trace.find("\"BytesUploaded\":4096") != std::string::npos);
+        CHECK(trace.find("GPU \\\"Queue\\\"") != std::string::npos);
+    }
+}
+
+int main()
+{
+    TestNesting();
+    TestThreadCounters();
+    TestDroppedEvents();
+    TestChromeTrace();
+    return TestResult();
+}
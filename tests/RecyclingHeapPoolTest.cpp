@@ -0,0 +1,111 @@
+//RecyclingHeapPool：fence完成前不复用、按类别最小适配、浪费过多时不复用、新建容量按堆对齐取整，
+//以及模拟拖动窗口边框时深度缓冲区的堆大多可以复用
+
+#include <algorithm>
+#include <memory>
+#include "RecyclingHeapPool.h"
+#include "TestCheck.h"
+
+namespace
+{
+    void TestAcquireRelease()
+    {
+        RecyclingHeapPool<int> pool(1.25, 65536, 4.0);
+        int heap = 0;
+        uint64_t capacity = 0;
+        //没有空闲堆：新建容量为请求的1.25倍，按64KB取整
+        CHECK(!pool.Acquire(0, 100000, 0, 0, heap, capacity));
+        CHECK_EQ(capacity, 131072u);
+        pool.Release(0, 7, capacity, 5);
+
+        //fence未完成或类别不同时不复用
+        CHECK(!pool.Acquire(0, 100000, 0, 4, heap, capacity));
+        CHECK(!pool.Acquire(1, 100000, 0, 5, heap, capacity));
+        //余量之内的增长直接复用
+        CHECK(pool.Acquire(0, 120000, 0, 5, heap, capacity));
+        CHECK_EQ(heap, 7);
+        CHECK_EQ(capacity, 131072u);
+
+        //空闲堆超过请求的4倍时不复用
+        pool.Release(0, 8, 1 << 24, 6);
+        CHECK(!pool.Acquire(0, 1000, 0, 6, heap, capacity));
+        //多个可用时选择最小的
+        pool.Release(0, 9, 1 << 20, 6);
+        pool.Release(0, 10, 1 << 19, 6);
+        CHECK(pool.Acquire(0, 1 << 18, 0, 6, heap, capacity));
+        CHECK_EQ(heap, 10);
+
+        //先丢弃最大的，直到空闲容量不超过上限
+        pool.Trim(6, 1 << 20);
+        CHECK_EQ(pool.GetIdleCount(), 1u);
+        CHECK_EQ(pool.GetIdleBytes(), 1u << 20);
+        //fence未完成的堆不会被丢弃
+        pool.Release(0, 11, 1 << 22, 9);
+        pool.Trim(8, 0);
+        CHECK_EQ(pool.GetIdleCount(), 1u);
+        CHECK_EQ(pool.GetIdleBytes(), 1u << 22);
+
+        const RecyclingHeapPoolStats& stats = pool.GetStats();
+        CHECK_EQ(stats.Reused, 2u);
+        CHECK_EQ(stats.Created, 4u);
+    }
+
+    void TestAlignment()
+    {
+        //多重采样资源的堆要求4MB对齐，新建的容量必须是它的整数倍
+        const uint64_t msaaAlignment = 4ull << 20;
+        RecyclingHeapPool<int> pool;
+        int heap = 0;
+        uint64_t capacity = 0;
+        for (uint64_t size : { 1ull, 65536ull, 3ull << 20, 5ull << 20, (17ull << 20) + 1 })
+        {
+            CHECK(!pool.Acquire(2, size, msaaAlignment, 0, heap, capacity));
+            CHECK_EQ(capacity % msaaAlignment, 0u);
+            CHECK(capacity >= size);
+        }
+        //对齐小于取整单位时按取整单位
+        CHECK(!pool.Acquire(0, 1000, 4096, 0, heap, capacity));
+        CHECK_EQ(capacity, 65536u);
+    }
+
+    void TestWindowDrag()
+    {
+        //D24S8深度缓冲区，窗口从800x600拖动到1920x1080，每次调整前GPU已经执行完之前的帧
+        RecyclingHeapPool<std::unique_ptr<int>> pool;
+        std::unique_ptr<int> current;
+        uint64_t currentCapacity = 0;
+        uint64_t fence = 0;
+        uint32_t resizes = 0;
+        for (uint32_t width = 800, height = 600; width <= 1920; width += 8, height = std::min(1080u, height + 5))
+        {
+            const uint64_t size = (uint64_t(width) * height * 4 + 65535) / 65536 * 65536;
+            if (current)
+            {
+                pool.Release(0, std::move(current), currentCapacity, fence);
+            }
+            ++fence;
+            uint64_t capacity = 0;
+            std::unique_ptr<int> heap;
+            if (!pool.Acquire(0, size, 65536, fence, heap, capacity))
+            {
+                heap.reset(new int(0));
+            }
+            CHECK(capacity >= size);
+            current = std::move(heap);
+            currentCapacity = capacity;
+            pool.Trim(fence, currentCapacity);
+            ++resizes;
+        }
+        //每次只在超出余量时新建
+        CHECK(pool.GetStats().Created < resizes / 4);
+        CHECK(pool.GetIdleBytes() <= currentCapacity);
+    }
+}
+
+int main()
+{
+    TestAcquireRelease();
+    TestAlignment();
+    TestWindowDrag();
+    return TestResult();
+}
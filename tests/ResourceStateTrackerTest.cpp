@@ -0,0 +1,231 @@
+//ResourceStateTracker：省略、合并、子资源以及拆分屏障，Flush的目标为记录调用的替身
+
+#include "NullRenderBackend.h"
+#include "ResourceStateTracker.h"
+#include "TestCheck.h"
+
+namespace
+{
+    //与D3D12_RESOURCE_STATES的取值一致
+    const uint32_t StateCommon = 0;
+    const uint32_t StatePresent = 0;
+    const uint32_t StateRenderTarget = 0x4;
+    const uint32_t StateDepthWrite = 0x10;
+    const uint32_t StatePixelShaderResource = 0x80;
+    const uint32_t StateCopyDest = 0x400;
+    const uint32_t StateGenericRead = 0xac3;
+
+    //把每次ResourceBarrier调用的转换保存下来
+    struct BarrierRecorder
+    {
+        std::vector<std::vector<ResourceTransition>> Calls;
+
+        void ResourceBarrier(uint32_t count, const ResourceTransition* transitions)
+        {
+            Calls.emplace_back(transitions, transitions + count);
+        }
+    };
+
+    void TestSkipAndBatch()
+    {
+        int backBuffer = 0;
+        int depth = 0;
+        ResourceStateTracker tracker;
+        BarrierRecorder recorder;
+        tracker.Register(&backBuffer, 1, StatePresent);
+        tracker.Register(&depth, 1, StateDepthWrite);
+
+        tracker.Transition(&backBuffer, StateRenderTarget);
+        //状态相同，不产生转换
+        tracker.Transition(&depth, StateDepthWrite);
+        CHECK_EQ(tracker.GetPendingCount(), 1u);
+        tracker.Flush(recorder);
+        CHECK_EQ(recorder.Calls.size(), 1u);
+        CHECK_EQ(recorder.Calls[0].size(), 1u);
+        CHECK(recorder.Calls[0][0].Resource == &backBuffer);
+        CHECK_EQ(recorder.Calls[0][0].StateBefore, StatePresent);
+        CHECK_EQ(recorder.Calls[0][0].StateAfter, StateRenderTarget);
+        CHECK_EQ(tracker.GetState(&backBuffer), StateRenderTarget);
+
+        //没有转换时不调用ResourceBarrier
+        tracker.Flush(recorder);
+        CHECK_EQ(recorder.Calls.size(), 1u);
+
+        //同一批次中的多个资源用一次调用提交
+        tracker.Transition(&backBuffer, StatePresent);
+        tracker.Transition(&depth, StatePixelShaderResource);
+        tracker.Flush(recorder);
+        CHECK_EQ(recorder.Calls.size(), 2u);
+        CHECK_EQ(recorder.Calls[1].size(), 2u);
+
+        const ResourceStateStats& stats = tracker.GetStats();
+        CHECK_EQ(stats.Requested, 4u);
+        CHECK_EQ(stats.Skipped, 1u);
+        CHECK_EQ(stats.Emitted, 3u);
+        CHECK_EQ(stats.BarrierCalls, 2u);
+    }
+
+    void TestMerge()
+    {
+        int buffer = 0;
+        int target = 0;
+        ResourceStateTracker tracker;
+        BarrierRecorder recorder;
+        tracker.Register(&buffer, 1, StateCommon);
+        tracker.Register(&target, 1, StatePresent);
+
+        //A->B->C合并为A->C
+        tracker.Transition(&buffer, StateCopyDest);
+        tracker.Transition(&buffer, StateGenericRead);
+        CHECK_EQ(tracker.GetPendingCount(), 1u);
+
+        //A->B->A直接消去
+        tracker.Transition(&target, StateRenderTarget);
+        tracker.Transition(&target, StatePresent);
+        CHECK_EQ(tracker.GetPendingCount(), 1u);
+
+        tracker.Flush(recorder);
+        CHECK_EQ(recorder.Calls.size(), 1u);
+        CHECK_EQ(recorder.Calls[0].size(), 1u);
+        CHECK_EQ(recorder.Calls[0][0].StateBefore, StateCommon);
+        CHECK_EQ(recorder.Calls[0][0].StateAfter, StateGenericRead);
+        CHECK_EQ(tracker.GetStats().Merged, 2u);
+    }
+
+    void TestSubresources()
+    {
+        int texture = 0;
+        ResourceStateTracker tracker;
+        BarrierRecorder recorder;
+        tracker.Register(&texture, 4, StatePixelShaderResource);
+
+        tracker.Transition(&texture, StateRenderTarget, 2);
+        CHECK_EQ(tracker.GetState(&texture, 2), StateRenderTarget);
+        CHECK_EQ(tracker.GetState(&texture, 1), StatePixelShaderResource);
+        tracker.Flush(recorder);
+        CHECK_EQ(recorder.Calls.back().size(), 1u);
+        CHECK_EQ(recorder.Calls.back()[0].Subresource, 2u);
+
+        //子资源状态不一致时，整体转换按子资源分别产生
+        tracker.Transition(&texture, StateCopyDest);
+        tracker.Flush(recorder);
+        CHECK_EQ(recorder.Calls.back().size(), 4u);
+        for (const ResourceTransition& transition : recorder.Calls.back())
+        {
+            CHECK_EQ(transition.StateAfter, StateCopyDest);
+            CHECK_EQ(transition.StateBefore, transition.Subresource == 2 ? StateRenderTarget : StatePixelShaderResource);
+        }
+
+        //状态一致后只需一个针对全部子资源的转换
+        tracker.Transition(&texture, StatePixelShaderResource);
+        tracker.Flush(recorder);
+        CHECK_EQ(recorder.Calls.back().size(), 1u);
+        CHECK_EQ(recorder.Calls.back()[0].Subresource, ResourceStateTracker::AllSubresources);
+
+        //逐个转换全部子资源后，整体转换到同一状态不再产生转换
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            tracker.Transition(&texture, StateCopyDest, i);
+        }
+        tracker.Flush(recorder);
+        tracker.Transition(&texture, StateCopyDest);
+        CHECK_EQ(tracker.GetPendingCount(), 0u);
+    }
+
+    void TestSplitBarrier()
+    {
+        int shadowMap = 0;
+        ResourceStateTracker tracker;
+        BarrierRecorder recorder;
+        tracker.Register(&shadowMap, 1, StateDepthWrite);
+
+        tracker.BeginTransition(&shadowMap, StatePixelShaderResource);
+        tracker.Flush(recorder);
+        CHECK_EQ(recorder.Calls.back().size(), 1u);
+        CHECK(recorder.Calls.back()[0].Split == ResourceBarrierSplit::BeginOnly);
+        //转换完成前状态不变
+        CHECK_EQ(tracker.GetState(&shadowMap), StateDepthWrite);
+
+        tracker.EndTransition(&shadowMap);
+        tracker.Flush(recorder);
+        CHECK(recorder.Calls.back()[0].Split == ResourceBarrierSplit::EndOnly);
+        CHECK_EQ(recorder.Calls.back()[0].StateBefore, StateDepthWrite);
+        CHECK_EQ(recorder.Calls.back()[0].StateAfter, StatePixelShaderResource);
+        CHECK_EQ(tracker.GetState(&shadowMap), StatePixelShaderResource);
+
+        //开始与结束在同一批次中时不需要拆分
+        tracker.BeginTransition(&shadowMap, StatePixelShaderResource);
+        tracker.EndTransition(&shadowMap);
+        CHECK_EQ(tracker.GetPendingCount(), 0u);
+    }
+
+    void TestUnregister()
+    {
+        int resource = 0;
+        ResourceStateTracker tracker;
+        tracker.Register(&resource, 1, StatePresent);
+        CHECK(tracker.IsRegistered(&resource));
+        tracker.Transition(&resource, StateRenderTarget);
+        //资源释放时丢弃它未提交的转换
+        tracker.Unregister(&resource);
+        CHECK(!tracker.IsRegistered(&resource));
+        CHECK_EQ(tracker.GetPendingCount(), 0u);
+    }
+
+    //BoxApp一帧中的转换直接提交到空后端的命令列表：每个批次点一次ResourceBarrier
+    void TestRecordingCommandList()
+    {
+        int backBuffer = 0;
+        int vertexBuffer = 0;
+        int indexBuffer = 0;
+        ResourceStateTracker tracker;
+        NullRenderCommandList cmdList(0);
+        cmdList.Reset(0);
+
+        tracker.Register(&backBuffer, 1, StatePresent);
+        tracker.Register(&vertexBuffer, 1, StateCommon);
+        tracker.Register(&indexBuffer, 1, StateCommon);
+
+        tracker.Transition(&vertexBuffer, StateCopyDest);
+        tracker.Transition(&indexBuffer, StateCopyDest);
+        tracker.Flush(cmdList);
+        cmdList.CopyBufferRegion(1, 0, 2, 0, 64);
+        cmdList.CopyBufferRegion(3, 0, 4, 0, 64);
+        tracker.Transition(&vertexBuffer, StateGenericRead);
+        tracker.Transition(&indexBuffer, StateGenericRead);
+        tracker.Transition(&backBuffer, StateRenderTarget);
+        tracker.Flush(cmdList);
+        cmdList.DrawIndexedInstanced(36, 1, 0, 0, 0);
+        tracker.Transition(&backBuffer, StatePresent);
+        tracker.Flush(cmdList);
+        cmdList.Close();
+
+        const std::vector<RecordingCommandList::Command>& commands = cmdList.GetRecording().GetCommands();
+        uint32_t barrierCalls = 0;
+        uint32_t barriers = 0;
+        for (const RecordingCommandList::Command& command : commands)
+        {
+            if (command.Type == RecordingCommandList::Op::ResourceBarrier)
+            {
+                ++barrierCalls;
+                barriers += command.Args[0];
+            }
+        }
+        CHECK_EQ(barrierCalls, 3u);
+        CHECK_EQ(barriers, 6u);
+        CHECK_EQ(cmdList.GetStats().BarrierCalls, 3u);
+        CHECK_EQ(cmdList.GetStats().Barriers, 6u);
+        CHECK(commands.size() >= 2 && commands[0].Type == RecordingCommandList::Op::ResourceBarrier);
+    }
+}
+
+int main()
+{
+    TestSkipAndBatch();
+    TestMerge();
+    TestSubresources();
+    TestSplitBarrier();
+    TestUnregister();
+    TestRecordingCommandList();
+    return TestResult();
+}
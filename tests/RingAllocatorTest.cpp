@@ -0,0 +1,130 @@
+//RingAllocator：按帧回收、尾部跳过以及随机负载下分配之间不重叠
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "RingAllocator.h"
+#include "TestCheck.h"
+
+namespace
+{
+    void TestFrameReclaim()
+    {
+        RingAllocator ring(16);
+        CHECK_EQ(ring.Allocate(0), RingAllocator::InvalidOffset);
+        CHECK_EQ(ring.Allocate(17), RingAllocator::InvalidOffset);
+
+        CHECK_EQ(ring.Allocate(4), 0u);
+        CHECK_EQ(ring.Allocate(4), 4u);
+        ring.FinishFrame(1);
+        CHECK_EQ(ring.Allocate(6), 8u);
+        ring.FinishFrame(2);
+        CHECK_EQ(ring.GetUsedSize(), 14u);
+
+        //GPU仍在使用前两帧，空间不足
+        CHECK_EQ(ring.Allocate(4), RingAllocator::InvalidOffset);
+
+        //第1帧完成，尾部的2个放不下4个，跳过后从0开始，跳过的部分计入当前帧
+        ring.Reclaim(1);
+        CHECK_EQ(ring.GetUsedSize(), 6u);
+        CHECK_EQ(ring.Allocate(4), 0u);
+        CHECK_EQ(ring.GetUsedSize(), 12u);
+        ring.FinishFrame(3);
+
+        //fence值较小的帧先回收，跳过的尾部随第3帧一起回收
+        ring.Reclaim(2);
+        CHECK_EQ(ring.GetUsedSize(), 6u);
+        ring.Reclaim(3);
+        CHECK_EQ(ring.GetUsedSize(), 0u);
+
+        //环为空时从头开始，可以得到全部容量
+        CHECK_EQ(ring.Allocate(16), 0u);
+        ring.FinishFrame(4);
+        CHECK_EQ(ring.Allocate(1), RingAllocator::InvalidOffset);
+        ring.Reclaim(4);
+        CHECK_EQ(ring.GetUsedSize(), 0u);
+    }
+
+    void TestEmptyFrame()
+    {
+        RingAllocator ring(8);
+        //没有分配的帧不占用记录，也不影响回收
+        ring.FinishFrame(1);
+        CHECK_EQ(ring.Allocate(8), 0u);
+        ring.FinishFrame(2);
+        ring.Reclaim(1);
+        CHECK_EQ(ring.GetUsedSize(), 8u);
+        ring.Reclaim(2);
+        CHECK_EQ(ring.GetUsedSize(), 0u);
+    }
+
+    //以每个元素的所属帧作为参照模型，检查分配的区间在回收前不会被再次分配
+    void TestRandomFrames(uint32_t capacity)
+    {
+        std::mt19937 rng(39 + capacity);
+        RingAllocator ring(capacity);
+        std::vector<int64_t> owner(capacity, -1);
+        std::vector<std::vector<std::pair<uint32_t, uint32_t>>> frames(1);
+        uint64_t fence = 0;
+        uint64_t completed = 0;
+        const uint64_t latency = 3;
+        uint32_t allocations = 0;
+
+        for (int frame = 0; frame < 5000; ++frame)
+        {
+            const uint32_t count = rng() % 8;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const uint32_t size = 1 + rng() % std::max(1u, capacity / 4);
+                const uint32_t offset = ring.Allocate(size);
+                if (offset == RingAllocator::InvalidOffset)
+                {
+                    continue;
+                }
+                ++allocations;
+                CHECK(offset + size <= capacity);
+                for (uint32_t k = offset; k < offset + size; ++k)
+                {
+                    CHECK_EQ(owner[k], -1);
+                    owner[k] = static_cast<int64_t>(fence);
+                }
+                frames.back().push_back(std::make_pair(offset, size));
+            }
+
+            ++fence;
+            ring.FinishFrame(fence);
+            frames.emplace_back();
+
+            //GPU通常落后几帧，偶尔完全追上
+            uint64_t newCompleted = fence >= latency ? fence - latency : 0;
+            if (rng() % 5 == 0)
+            {
+                newCompleted = fence;
+            }
+            for (; completed < newCompleted; ++completed)
+            {
+                for (const std::pair<uint32_t, uint32_t>& range : frames[completed])
+                {
+                    std::fill(owner.begin() + range.first, owner.begin() + range.first + range.second, -1);
+                }
+            }
+            ring.Reclaim(completed);
+            if (completed == fence)
+            {
+                CHECK_EQ(ring.GetUsedSize(), 0u);
+            }
+        }
+        CHECK(allocations > 0);
+    }
+}
+
+int main()
+{
+    TestFrameReclaim();
+    TestEmptyFrame();
+    for (uint32_t capacity : { 1u, 7u, 64u, 1000u })
+    {
+        TestRandomFrames(capacity);
+    }
+    return TestResult();
+}
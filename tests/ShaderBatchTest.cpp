@@ -0,0 +1,174 @@
+//ShaderCache::CompileBatch：结果与排列一一对应、相同排列去重、失败结果的传递
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "ShaderCache.h"
+#include "TestCheck.h"
+#include "TestFiles.h"
+
+namespace
+{
+    //"字节码"的最后一个字节为第一个宏定义的值，便于检查结果是否对应正确的排列
+    class MockCompiler : public IShaderCompiler
+    {
+    public:
+        bool Compile(const ShaderCompileDesc& desc,
+                     const std::vector<uint8_t>& source,
+                     std::vector<uint8_t>& byteCode,
+                     std::string& errors) override
+        {
+            ++Calls;
+            //让同一批中的任务有机会同时进行
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            if (desc.Defines.empty() || desc.Defines[0].Definition == "fail")
+            {
+                errors = "error X1000: bad permutation";
+                return false;
+            }
+            byteCode = source;
+            byteCode.push_back(static_cast<uint8_t>(std::stoi(desc.Defines[0].Definition)));
+            return true;
+        }
+
+        std::atomic<int> Calls{ 0 };
+    };
+
+    ShaderCompileDesc MakePermutation(const std::wstring& path, const std::string& maxLights)
+    {
+        ShaderCompileDesc desc;
+        desc.Path = path;
+        desc.EntryPoint = "PS";
+        desc.Target = "ps_5_0";
+        desc.Defines.push_back({ "MaxLights", maxLights });
+        return desc;
+    }
+
+    void TestBatch(const std::wstring& path)
+    {
+        JobSystem jobs(4);
+        MockCompiler compiler;
+        ShaderCache cache(&compiler, L"");
+
+        //32种排列各出现两次
+        std::vector<ShaderCompileDesc> permutations;
+        for (int repeat = 0; repeat < 2; ++repeat)
+        {
+            for (int i = 0; i < 32; ++i)
+            {
+                permutations.push_back(MakePermutation(path, std::to_string(i)));
+            }
+        }
+
+        std::vector<std::shared_future<ShaderCompileResult>> results = cache.CompileBatch(permutations, jobs);
+        CHECK_EQ(results.size(), permutations.size());
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const ShaderCompileResult& result = results[i].get();
+            CHECK(result.ByteCode != nullptr);
+            CHECK(result.ByteCode && result.ByteCode->back() == uint8_t(i % 32));
+        }
+
+        //重复的排列只编译一次，共享同一份字节码
+        CHECK_EQ(compiler.Calls.load(), 32);
+        CHECK_EQ(cache.GetStats().Deduplicated, 32u);
+        CHECK(results[0].get().ByteCode == results[32].get().ByteCode);
+
+        //已经在内存缓存中的排列直接返回
+        std::vector<std::shared_future<ShaderCompileResult>> again = cache.CompileBatch(permutations, jobs);
+        for (size_t i = 0; i < again.size(); ++i)
+        {
+            CHECK(again[i].get().ByteCode == results[i].get().ByteCode);
+        }
+        CHECK_EQ(compiler.Calls.load(), 32);
+        CHECK(cache.GetStats().MemoryHits >= 32u);
+
+        //同步接口与批量接口共享缓存
+        CHECK(cache.Compile(permutations[5]) == results[5].get().ByteCode);
+        CHECK_EQ(compiler.Calls.load(), 32);
+    }
+
+    void TestInFlightDeduplication(const std::wstring& path)
+    {
+        JobSystem jobs(4);
+        MockCompiler compiler;
+        ShaderCache cache(&compiler, L"");
+
+        //连续提交的几批在前一批完成之前到达，同一个键只编译一次
+        const ShaderCompileDesc desc = MakePermutation(path, "7");
+        std::vector<std::shared_future<ShaderCompileResult>> futures;
+        for (int i = 0; i < 4; ++i)
+        {
+            futures.push_back(cache.CompileBatch({ desc }, jobs)[0]);
+        }
+        for (const auto& future : futures)
+        {
+            CHECK(future.get().ByteCode != nullptr);
+        }
+        CHECK_EQ(compiler.Calls.load(), 1);
+        const ShaderCacheStats stats = cache.GetStats();
+        CHECK_EQ(stats.Misses, 1u);
+        CHECK_EQ(stats.Deduplicated + stats.MemoryHits, 3u);
+    }
+
+    void TestSameSourceAtSubmit(const std::wstring& path, const std::wstring& copyPath)
+    {
+        //只有一个工作线程：内容相同的两个文件在提交时按缓存键合并，第二个排列不会派生出等待第一个的任务
+        JobSystem jobs(1);
+        MockCompiler compiler;
+        ShaderCache cache(&compiler, L"");
+
+        std::vector<std::shared_future<ShaderCompileResult>> results = cache.CompileBatch(
+            { MakePermutation(path, "3"), MakePermutation(copyPath, "3") }, jobs);
+        CHECK(results[0].get().ByteCode != nullptr);
+        CHECK(results[0].get().ByteCode == results[1].get().ByteCode);
+        CHECK_EQ(compiler.Calls.load(), 1);
+        CHECK_EQ(cache.GetStats().Deduplicated, 1u);
+        CHECK_EQ(jobs.GetStats().Executed, 1u);
+    }
+
+    void TestFailures(const std::wstring& path)
+    {
+        JobSystem jobs(2);
+        MockCompiler compiler;
+        ShaderCache cache(&compiler, L"");
+
+        std::vector<ShaderCompileDesc> permutations;
+        permutations.push_back(MakePermutation(path, "1"));
+        permutations.push_back(MakePermutation(path, "fail"));
+        permutations.push_back(MakePermutation(path + L".missing", "2"));
+
+        std::vector<std::shared_future<ShaderCompileResult>> results = cache.CompileBatch(permutations, jobs);
+        CHECK(results[0].get().ByteCode != nullptr);
+        CHECK(results[1].get().ByteCode == nullptr);
+        CHECK(results[1].get().Errors.find("X1000") != std::string::npos);
+        CHECK(results[2].get().ByteCode == nullptr);
+        CHECK(!results[2].get().Errors.empty());
+        CHECK_EQ(cache.GetStats().CompileFailures, 2u);
+    }
+
+    void TestEmptyBatch()
+    {
+        JobSystem jobs(1);
+        MockCompiler compiler;
+        ShaderCache cache(&compiler, L"");
+        CHECK(cache.CompileBatch({}, jobs).empty());
+        CHECK_EQ(compiler.Calls.load(), 0);
+    }
+}
+
+int main()
+{
+    const std::wstring dir = MakeTestDirectory(L"ShaderBatchTest");
+    const std::wstring path = dir + L"/lighting.hlsl";
+    const std::wstring copyPath = dir + L"/lighting_copy.hlsl";
+    WriteTextFile(path, "float4 PS() : SV_Target { return MaxLights; }\n");
+    WriteTextFile(copyPath, "float4 PS() : SV_Target { return MaxLights; }\n");
+
+    TestBatch(path);
+    TestInFlightDeduplication(path);
+    TestSameSourceAtSubmit(path, copyPath);
+    TestFailures(path);
+    TestEmptyBatch();
+    return TestResult();
+}
@@ -0,0 +1,203 @@
+//ShaderCache的缓存键、两级缓存以及失败处理，编译器为记录调用次数的桩
+
+#include <atomic>
+#include "ShaderCache.h"
+#include "TestCheck.h"
+#include "TestFiles.h"
+
+namespace
+{
+    //把源文件内容与宏定义的个数作为"字节码"，entryPoint为bad时编译失败
+    class StubCompiler : public IShaderCompiler
+    {
+    public:
+        bool Compile(const ShaderCompileDesc& desc,
+                     const std::vector<uint8_t>& source,
+                     std::vector<uint8_t>& byteCode,
+                     std::string& errors) override
+        {
+            ++Calls;
+            if (desc.EntryPoint == "bad")
+            {
+                errors = "error X3000: syntax error";
+                return false;
+            }
+            byteCode = source;
+            byteCode.push_back(static_cast<uint8_t>(desc.Defines.size()));
+            return true;
+        }
+
+        std::atomic<int> Calls{ 0 };
+    };
+
+    ShaderCompileDesc MakeDesc(const std::wstring& dir)
+    {
+        ShaderCompileDesc desc;
+        desc.Path = dir + L"/color.hlsl";
+        desc.EntryPoint = "VS";
+        desc.Target = "vs_5_0";
+        return desc;
+    }
+
+    void WriteSources(const std::wstring& dir)
+    {
+        FileUtil::EnsureDirectory(dir + L"/inc");
+        WriteTextFile(dir + L"/color.hlsl",
+                      "/* #include \"commented.h\" */\n"
+                      "#include \"inc/common.h\"\n"
+                      "// #include \"also_commented.h\"\n"
+                      "float4 VS(float3 p : POSITION) : SV_Position { return float4(p, 1); }\n");
+        //common.h包含自身，展开时不能无限递归
+        WriteTextFile(dir + L"/inc/common.h", "#pragma once\n#include \"lights.h\"\n#include \"common.h\"\n");
+        WriteTextFile(dir + L"/inc/lights.h", "#define MaxLights 16\n");
+    }
+
+    void TestKey(const std::wstring& dir)
+    {
+        ShaderCompileDesc desc = MakeDesc(dir);
+        std::vector<uint8_t> source;
+        uint64_t base = 0;
+        CHECK(ShaderCache::ComputeKey(desc, source, base));
+        CHECK(!source.empty());
+
+        uint64_t key = 0;
+        CHECK(ShaderCache::ComputeKey(desc, source, key));
+        CHECK_EQ(key, base);
+
+        //注释中的#include不影响键
+        WriteTextFile(dir + L"/commented.h", "int unused;\n");
+        WriteTextFile(dir + L"/also_commented.h", "int unused;\n");
+        CHECK(ShaderCache::ComputeKey(desc, source, key));
+        CHECK_EQ(key, base);
+
+        ShaderCompileDesc other = desc;
+        other.Defines.push_back({ "MaxLights", "8" });
+        CHECK(ShaderCache::ComputeKey(other, source, key));
+        CHECK(key != base);
+
+        //宏名与值的边界不同
+        ShaderCompileDesc split1 = desc;
+        split1.Defines.push_back({ "AB", "C" });
+        ShaderCompileDesc split2 = desc;
+        split2.Defines.push_back({ "A", "BC" });
+        uint64_t key1 = 0;
+        uint64_t key2 = 0;
+        CHECK(ShaderCache::ComputeKey(split1, source, key1));
+        CHECK(ShaderCache::ComputeKey(split2, source, key2));
+        CHECK(key1 != key2);
+
+        other = desc;
+        other.Target = "vs_5_1";
+        CHECK(ShaderCache::ComputeKey(other, source, key));
+        CHECK(key != base);
+
+        other = desc;
+        other.Flags = 1;
+        CHECK(ShaderCache::ComputeKey(other, source, key));
+        CHECK(key != base);
+
+        other = desc;
+        other.EntryPoint = "Main";
+        CHECK(ShaderCache::ComputeKey(other, source, key));
+        CHECK(key != base);
+
+        //间接包含的文件改变时键也改变
+        WriteTextFile(dir + L"/inc/lights.h", "#define MaxLights 32\n");
+        CHECK(ShaderCache::ComputeKey(desc, source, key));
+        CHECK(key != base);
+        WriteTextFile(dir + L"/inc/lights.h", "#define MaxLights 16\n");
+        CHECK(ShaderCache::ComputeKey(desc, source, key));
+        CHECK_EQ(key, base);
+
+        other = desc;
+        other.Path = dir + L"/missing.hlsl";
+        CHECK(!ShaderCache::ComputeKey(other, source, key));
+    }
+
+    void TestMemoryAndDiskCache(const std::wstring& dir)
+    {
+        StubCompiler compiler;
+        const std::wstring cacheDir = dir + L"/cache";
+        ShaderCompileDesc desc = MakeDesc(dir);
+
+        ShaderByteCode first;
+        {
+            ShaderCache cache(&compiler, cacheDir);
+            first = cache.Compile(desc);
+            CHECK(first != nullptr);
+            ShaderByteCode second = cache.Compile(desc);
+            CHECK(first == second);
+
+            const ShaderCacheStats stats = cache.GetStats();
+            CHECK_EQ(stats.Misses, 1u);
+            CHECK_EQ(stats.MemoryHits, 1u);
+            CHECK_EQ(stats.DiskHits, 0u);
+            CHECK_EQ(compiler.Calls.load(), 1);
+        }
+
+        //新的实例从磁盘缓存读取，不调用编译器
+        {
+            ShaderCache cache(&compiler, cacheDir);
+            ShaderByteCode loaded = cache.Compile(desc);
+            CHECK(loaded != nullptr);
+            CHECK(loaded && first && *loaded == *first);
+            CHECK_EQ(cache.GetStats().DiskHits, 1u);
+            CHECK_EQ(compiler.Calls.load(), 1);
+
+            //ClearMemory之后再次从磁盘读取
+            cache.ClearMemory();
+            CHECK(cache.Compile(desc) != nullptr);
+            CHECK_EQ(cache.GetStats().DiskHits, 2u);
+
+            ShaderCompileDesc permutation = desc;
+            permutation.Defines.push_back({ "MaxLights", "4" });
+            ShaderByteCode permuted = cache.Compile(permutation);
+            CHECK(permuted != nullptr);
+            CHECK(permuted && permuted->back() == 1);
+            CHECK_EQ(compiler.Calls.load(), 2);
+        }
+
+        //没有磁盘缓存目录时只有内存缓存
+        {
+            ShaderCache cache(&compiler, L"");
+            CHECK(cache.Compile(desc) != nullptr);
+            CHECK_EQ(cache.GetStats().Misses, 1u);
+            CHECK_EQ(compiler.Calls.load(), 3);
+        }
+    }
+
+    void TestFailures(const std::wstring& dir)
+    {
+        StubCompiler compiler;
+        ShaderCache cache(&compiler, dir + L"/cache");
+
+        ShaderCompileDesc desc = MakeDesc(dir);
+        desc.EntryPoint = "bad";
+        std::string errors;
+        CHECK(cache.Compile(desc, &errors) == nullptr);
+        CHECK(errors.find("X3000") != std::string::npos);
+        CHECK_EQ(cache.GetStats().CompileFailures, 1u);
+
+        //失败的结果不缓存，下次调用仍然交给编译器
+        CHECK(cache.Compile(desc, &errors) == nullptr);
+        CHECK_EQ(compiler.Calls.load(), 2);
+
+        desc = MakeDesc(dir);
+        desc.Path = dir + L"/missing.hlsl";
+        errors.clear();
+        CHECK(cache.Compile(desc, &errors) == nullptr);
+        CHECK(!errors.empty());
+        CHECK_EQ(compiler.Calls.load(), 2);
+    }
+}
+
+int main()
+{
+    const std::wstring dir = MakeTestDirectory(L"ShaderCacheTest");
+    WriteSources(dir);
+
+    TestKey(dir);
+    TestMemoryAndDiskCache(dir);
+    TestFailures(dir);
+    return TestResult();
+}
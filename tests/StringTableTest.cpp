@@ -0,0 +1,143 @@
+//StringTable的驻留与查找，以及NamedArray按名字登记、按句柄访问
+
+#include <thread>
+#include "NamedArray.h"
+#include "StringTable.h"
+#include "TestCheck.h"
+
+namespace
+{
+    struct Submesh
+    {
+        uint32_t IndexCount = 0;
+        uint32_t StartIndexLocation = 0;
+        int BaseVertexLocation = 0;
+    };
+
+    void TestIntern()
+    {
+        const StringId box = StringTable::Intern("StringTableTest.Box");
+        CHECK(box.IsValid());
+        CHECK(box == StringTable::Intern(std::string("StringTableTest.Box")));
+        CHECK(box != StringTable::Intern("StringTableTest.Pyramid"));
+        CHECK_EQ(StringTable::GetString(box), std::string("StringTableTest.Box"));
+
+        //Find不插入
+        CHECK(!StringTable::Find("StringTableTest.NeverInterned").IsValid());
+        CHECK(!StringTable::Find("StringTableTest.NeverInterned").IsValid());
+        CHECK(StringTable::Find("StringTableTest.Box") == box);
+
+        CHECK(StringTable::Intern("").IsValid());
+
+        //GetString返回的引用在之后大量驻留时仍然有效
+        const std::string& boxName = StringTable::GetString(box);
+        const char* boxData = boxName.c_str();
+        for (int i = 0; i < 10000; ++i)
+        {
+            StringTable::Intern("StringTableTest.Grow" + std::to_string(i));
+        }
+        CHECK(boxName.c_str() == boxData);
+        CHECK_EQ(boxName, std::string("StringTableTest.Box"));
+        CHECK(StringTable::Find("StringTableTest.Grow9999").IsValid());
+    }
+
+    //多个线程同时驻留同一组名字，得到的句柄必须一致
+    void TestConcurrentIntern()
+    {
+        const int threadCount = 4;
+        const int nameCount = 2000;
+        std::vector<std::vector<StringId>> ids(threadCount, std::vector<StringId>(nameCount));
+        std::vector<std::thread> threads;
+        for (int t = 0; t < threadCount; ++t)
+        {
+            threads.emplace_back([t, &ids]()
+            {
+                for (int i = 0; i < nameCount; ++i)
+                {
+                    //每个线程从不同的位置开始，以相同的步长遍历全部名字
+                    const int n = (i * 7 + t * 613) % nameCount;
+                    ids[t][n] = StringTable::Intern("StringTableTest.Concurrent" + std::to_string(n));
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        for (int i = 0; i < nameCount; ++i)
+        {
+            CHECK(ids[0][i].IsValid());
+            for (int t = 1; t < threadCount; ++t)
+            {
+                CHECK(ids[t][i] == ids[0][i]);
+            }
+            CHECK_EQ(StringTable::GetString(ids[0][i]), "StringTableTest.Concurrent" + std::to_string(i));
+        }
+    }
+
+    void TestNamedArray()
+    {
+        NamedArray<Submesh, SubmeshTag> submeshes;
+        CHECK(submeshes.Empty());
+
+        Submesh box;
+        box.IndexCount = 36;
+        Submesh pyramid;
+        pyramid.IndexCount = 18;
+        pyramid.StartIndexLocation = 36;
+        pyramid.BaseVertexLocation = 8;
+
+        const SubmeshHandle boxHandle = submeshes.Add("Box", box);
+        const SubmeshHandle pyramidHandle = submeshes.Add("Pyramid", pyramid);
+        CHECK(boxHandle.IsValid() && pyramidHandle.IsValid());
+        CHECK(boxHandle != pyramidHandle);
+        CHECK_EQ(submeshes.Size(), 2u);
+
+        CHECK(submeshes.Find("Pyramid") == pyramidHandle);
+        CHECK(submeshes.Find(StringTable::Intern("Box")) == boxHandle);
+        CHECK_EQ(submeshes[pyramidHandle].BaseVertexLocation, 8);
+        CHECK(submeshes.GetName(pyramidHandle) == StringTable::Intern("Pyramid"));
+
+        //查找不存在的名字不插入元素，也不驻留字符串
+        CHECK(!submeshes.Find("StringTableTest.NoSuchSubmesh").IsValid());
+        CHECK(!StringTable::Find("StringTableTest.NoSuchSubmesh").IsValid());
+        CHECK_EQ(submeshes.Size(), 2u);
+        //已驻留但不在数组中的名字
+        CHECK(!submeshes.Find("StringTableTest.Box").IsValid());
+
+        //同名覆盖，句柄不变
+        pyramid.IndexCount = 24;
+        CHECK(submeshes.Add("Pyramid", pyramid) == pyramidHandle);
+        CHECK_EQ(submeshes[pyramidHandle].IndexCount, 24u);
+        CHECK_EQ(submeshes.Size(), 2u);
+
+        //遍历顺序与添加顺序一致
+        uint32_t total = 0;
+        uint32_t first = 0;
+        for (const Submesh& submesh : submeshes)
+        {
+            if (total == 0)
+            {
+                first = submesh.IndexCount;
+            }
+            total += submesh.IndexCount;
+        }
+        CHECK_EQ(first, 36u);
+        CHECK_EQ(total, 60u);
+
+        //不同种类的数组各自编号
+        NamedArray<int, MaterialTag> materials;
+        const MaterialHandle material = materials.Add("Pyramid", 7);
+        CHECK_EQ(material.Index, 0u);
+        CHECK_EQ(materials[material], 7);
+    }
+}
+
+int main()
+{
+    TestIntern();
+    TestConcurrentIntern();
+    TestNamedArray();
+    return TestResult();
+}
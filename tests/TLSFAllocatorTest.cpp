@@ -0,0 +1,177 @@
+//TLSFAllocator：恰好填满空闲块的分配、相邻空闲块合并以及随机分配释放下的一致性
+
+#include <iterator>
+#include <map>
+#include <random>
+#include "TLSFAllocator.h"
+#include "TestCheck.h"
+
+namespace
+{
+    //请求向上取整到下一档后找不到空闲块时，仍然要能用上恰好够大的块
+    void TestExactFit()
+    {
+        {
+            TLSFAllocator allocator(1000);
+            TLSFAllocator::Allocation all = allocator.Allocate(1000);
+            CHECK(all.IsValid());
+            CHECK_EQ(all.Offset, 0u);
+            CHECK_EQ(all.Size, 1000u);
+            CHECK_EQ(allocator.GetFreeSize(), 0u);
+            CHECK(!allocator.Allocate(1).IsValid());
+        }
+
+        {
+            TLSFAllocator allocator(1000);
+            CHECK(allocator.Allocate(10).IsValid());
+            CHECK_EQ(allocator.GetLargestFreeBlock(), 990u);
+            CHECK(allocator.Allocate(980).IsValid());
+            CHECK(allocator.Allocate(10).IsValid());
+            CHECK(!allocator.Allocate(1).IsValid());
+            CHECK_EQ(allocator.GetFreeSize(), 0u);
+        }
+
+        const uint32_t capacities[] = { 1, 31, 32, 33, 65, 91, 1000, 4097, 100000, 0xffffffffu };
+        for (uint32_t capacity : capacities)
+        {
+            TLSFAllocator allocator(capacity);
+            TLSFAllocator::Allocation all = allocator.Allocate(capacity);
+            CHECK(all.IsValid());
+            CHECK_EQ(all.Size, capacity);
+            allocator.Free(all);
+            CHECK_EQ(allocator.GetFreeSize(), capacity);
+            CHECK_EQ(allocator.GetLargestFreeBlock(), capacity);
+            CHECK(!allocator.Allocate(capacity == 0xffffffffu ? 0 : capacity + 1).IsValid());
+        }
+
+        //释放中间的块后，恰好等于空洞大小的请求要放进这个空洞
+        {
+            TLSFAllocator allocator(300);
+            TLSFAllocator::Allocation a = allocator.Allocate(100);
+            TLSFAllocator::Allocation b = allocator.Allocate(100);
+            TLSFAllocator::Allocation c = allocator.Allocate(100);
+            CHECK(a.IsValid() && b.IsValid() && c.IsValid());
+            allocator.Free(b);
+            TLSFAllocator::Allocation hole = allocator.Allocate(100);
+            CHECK(hole.IsValid());
+            CHECK_EQ(hole.Offset, b.Offset);
+        }
+    }
+
+    void TestCoalescing()
+    {
+        TLSFAllocator allocator(4096);
+        std::vector<TLSFAllocator::Allocation> blocks;
+        for (int i = 0; i < 16; ++i)
+        {
+            blocks.push_back(allocator.Allocate(256));
+            CHECK(blocks.back().IsValid());
+        }
+        CHECK_EQ(allocator.GetFreeSize(), 0u);
+        CHECK_EQ(allocator.GetAllocationCount(), 16u);
+
+        //隔一个释放一个，空闲块之间不相邻
+        for (size_t i = 0; i < blocks.size(); i += 2)
+        {
+            allocator.Free(blocks[i]);
+        }
+        CHECK_EQ(allocator.GetFreeBlockCount(), 8u);
+        CHECK_EQ(allocator.GetLargestFreeBlock(), 256u);
+        CHECK(!allocator.Allocate(512).IsValid());
+
+        //释放其余的块后全部合并为一个
+        for (size_t i = 1; i < blocks.size(); i += 2)
+        {
+            allocator.Free(blocks[i]);
+        }
+        CHECK_EQ(allocator.GetFreeBlockCount(), 1u);
+        CHECK_EQ(allocator.GetLargestFreeBlock(), 4096u);
+        CHECK_EQ(allocator.GetAllocationCount(), 0u);
+
+        CHECK(allocator.Allocate(4000).IsValid());
+        allocator.Reset();
+        CHECK_EQ(allocator.GetFreeSize(), 4096u);
+        CHECK_EQ(allocator.GetAllocationCount(), 0u);
+        CHECK(allocator.Allocate(4096).IsValid());
+    }
+
+    void TestInvalidRequests()
+    {
+        TLSFAllocator allocator(1024);
+        CHECK(!allocator.Allocate(0).IsValid());
+        CHECK(!allocator.Allocate(1025).IsValid());
+        CHECK(!allocator.Allocate(0xffffffffu).IsValid());
+        CHECK_EQ(allocator.GetFreeSize(), 1024u);
+    }
+
+    //随机分配释放，与记录的区间比较：不重叠、不越界、空闲字节数一致
+    void TestRandomChurn()
+    {
+        const uint32_t capacity = 1000000;
+        TLSFAllocator allocator(capacity);
+        std::mt19937 rng(35);
+        std::vector<TLSFAllocator::Allocation> live;
+        std::map<uint32_t, uint32_t> ranges;
+        uint64_t liveBytes = 0;
+
+        for (int iteration = 0; iteration < 100000; ++iteration)
+        {
+            if (live.empty() || rng() % 100 < 55)
+            {
+                const uint32_t size = 1 + rng() % (rng() % 4 == 0 ? 20000 : 300);
+                TLSFAllocator::Allocation allocation = allocator.Allocate(size);
+                if (!allocation.IsValid())
+                {
+                    //只有在确实没有足够大的空闲块时才允许失败
+                    CHECK(allocator.GetLargestFreeBlock() < size);
+                    continue;
+                }
+                CHECK(allocation.Size >= size);
+                CHECK(allocation.Offset + allocation.Size <= capacity);
+
+                auto next = ranges.lower_bound(allocation.Offset);
+                CHECK(next == ranges.end() || next->first >= allocation.Offset + allocation.Size);
+                if (next != ranges.begin())
+                {
+                    auto prev = std::prev(next);
+                    CHECK(prev->first + prev->second <= allocation.Offset);
+                }
+                ranges[allocation.Offset] = allocation.Size;
+                live.push_back(allocation);
+                liveBytes += allocation.Size;
+            }
+            else
+            {
+                const size_t index = rng() % live.size();
+                allocator.Free(live[index]);
+                ranges.erase(live[index].Offset);
+                liveBytes -= live[index].Size;
+                live[index] = live.back();
+                live.pop_back();
+            }
+
+            if (iteration % 1000 == 0)
+            {
+                CHECK_EQ(liveBytes + allocator.GetFreeSize(), uint64_t(capacity));
+                CHECK_EQ(allocator.GetAllocationCount(), uint32_t(live.size()));
+            }
+        }
+
+        for (const TLSFAllocator::Allocation& allocation : live)
+        {
+            allocator.Free(allocation);
+        }
+        CHECK_EQ(allocator.GetFreeSize(), capacity);
+        CHECK_EQ(allocator.GetFreeBlockCount(), 1u);
+        CHECK_EQ(allocator.GetLargestFreeBlock(), capacity);
+    }
+}
+
+int main()
+{
+    TestExactFit();
+    TestCoalescing();
+    TestInvalidRequests();
+    TestRandomChurn();
+    return TestResult();
+}
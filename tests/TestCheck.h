@@ -0,0 +1,35 @@
+#pragma once
+
+//测试程序使用的检查宏，与assert不同，在Release(NDEBUG)下同样生效
+//检查失败时打印位置并继续执行，main最后返回TestResult()，由ctest根据返回值判断是否通过
+
+#include <cstdio>
+
+inline int& TestFailureCount()
+{
+    static int count = 0;
+    return count;
+}
+
+#define CHECK(expr)                                                                     \
+    do                                                                                  \
+    {                                                                                   \
+        if (!(expr))                                                                    \
+        {                                                                               \
+            std::fprintf(stderr, "%s(%d): CHECK(%s) failed\n", __FILE__, __LINE__, #expr); \
+            ++TestFailureCount();                                                       \
+        }                                                                               \
+    } while (0)
+
+#define CHECK_EQ(a, b) CHECK((a) == (b))
+
+inline int TestResult()
+{
+    if (TestFailureCount() != 0)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", TestFailureCount());
+        return 1;
+    }
+    std::printf("all checks passed\n");
+    return 0;
+}
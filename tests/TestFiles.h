@@ -0,0 +1,21 @@
+#pragma once
+
+//测试中使用的临时文件
+
+#include <cstring>
+#include <string>
+#include "FileUtil.h"
+#include "Profiler.h"
+
+//每次运行创建一个新目录(位于测试的工作目录，即构建目录下)，磁盘缓存的命中统计不受上次运行的影响
+inline std::wstring MakeTestDirectory(const wchar_t* name)
+{
+    const std::wstring path = std::wstring(L"tmp/") + name + L"_" + std::to_wstring(ProfilerClock::Now());
+    FileUtil::EnsureDirectory(path);
+    return path;
+}
+
+inline bool WriteTextFile(const std::wstring& path, const char* text)
+{
+    return FileUtil::WriteAllBytes(path, text, std::strlen(text));
+}
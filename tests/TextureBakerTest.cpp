@@ -0,0 +1,160 @@
+//TextureBaker -> DDSWriter -> DDSFormat的往返：烘焙出的DDS文件能被解析，描述与子资源布局与烘焙选项一致，像素数据与mip链/压缩结果一致
+
+#include <algorithm>
+#include "BCEncoder.h"
+#include "DDSFormat.h"
+#include "TextureBaker.h"
+#include "TestCheck.h"
+
+namespace
+{
+    std::vector<uint8_t> MakeImage(uint32_t width, uint32_t height)
+    {
+        std::vector<uint8_t> pixels(width * height * 4);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                uint8_t* p = &pixels[(y * width + x) * 4];
+                p[0] = (uint8_t)(x * 255 / width);
+                p[1] = (uint8_t)(y * 255 / height);
+                p[2] = (uint8_t)((x ^ y) * 8);
+                p[3] = 255;
+            }
+        }
+        return pixels;
+    }
+
+    //解析烘焙出的文件，返回像素数据的起始位置
+    const uint8_t* Parse(const std::vector<uint8_t>& ddsFile, DDSTextureDesc& desc, std::vector<DDSSubresourceLayout>& layouts)
+    {
+        const DDS_HEADER* header = nullptr;
+        size_t bitOffset = 0;
+        if (!DDSFormat::ParseHeader(ddsFile.data(), ddsFile.size(), &header, &bitOffset))
+        {
+            return nullptr;
+        }
+        if (DDSFormat::GetTextureDesc(header, desc) != DDSParseResult::Ok)
+        {
+            return nullptr;
+        }
+        if (!DDSFormat::ComputeLayout(desc, ddsFile.size() - bitOffset, layouts))
+        {
+            return nullptr;
+        }
+        return ddsFile.data() + bitOffset;
+    }
+
+    //非压缩格式：每一级都与MipGenerator的结果逐字节相同
+    void TestUncompressed()
+    {
+        const uint32_t width = 20;
+        const uint32_t height = 12;
+        const std::vector<uint8_t> pixels = MakeImage(width, height);
+        TextureBakeOptions options;
+        options.Format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+        std::vector<uint8_t> ddsFile;
+        CHECK(TextureBaker::BakeRGBA8(pixels.data(), width, height, width * 4, options, ddsFile));
+
+        DDSTextureDesc desc;
+        std::vector<DDSSubresourceLayout> layouts;
+        const uint8_t* bits = Parse(ddsFile, desc, layouts);
+        CHECK(bits != nullptr);
+        if (bits == nullptr)
+        {
+            return;
+        }
+        CHECK_EQ(desc.Dimension, (uint32_t)DDS_DIMENSION_TEXTURE2D);
+        CHECK_EQ(desc.Format, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB);
+        CHECK_EQ(desc.Width, width);
+        CHECK_EQ(desc.Height, height);
+        CHECK_EQ(desc.ArraySize, 1u);
+        CHECK(!desc.IsCubeMap);
+        CHECK_EQ(desc.MipCount, MipGenerator::CalcMipCount(width, height));
+
+        const std::vector<MipLevel> mips = MipGenerator::GenerateRGBA8(pixels.data(), width, height, width * 4, true);
+        CHECK_EQ(layouts.size(), mips.size());
+        for (size_t i = 0; i < layouts.size() && i < mips.size(); ++i)
+        {
+            CHECK_EQ(layouts[i].Width, mips[i].Width);
+            CHECK_EQ(layouts[i].Height, mips[i].Height);
+            CHECK_EQ(layouts[i].RowPitch, mips[i].RowPitch);
+            CHECK_EQ(layouts[i].SlicePitch, mips[i].Pixels.size());
+            CHECK(std::equal(mips[i].Pixels.begin(), mips[i].Pixels.end(), bits + layouts[i].Offset));
+        }
+        //最后一级紧接文件末尾
+        CHECK_EQ(bits + layouts.back().Offset + layouts.back().SlicePitch, ddsFile.data() + ddsFile.size());
+    }
+
+    //BC格式：布局以块为单位，每一级的块数据与直接压缩对应的mip相同
+    void TestCompressed()
+    {
+        const uint32_t width = 18;
+        const uint32_t height = 9;
+        const std::vector<uint8_t> pixels = MakeImage(width, height);
+        const DXGI_FORMAT formats[] =
+        {
+            DXGI_FORMAT_BC1_UNORM, DXGI_FORMAT_BC3_UNORM_SRGB, DXGI_FORMAT_BC4_UNORM,
+            DXGI_FORMAT_BC5_UNORM, DXGI_FORMAT_BC7_UNORM_SRGB
+        };
+        for (DXGI_FORMAT format : formats)
+        {
+            TextureBakeOptions options;
+            options.Format = format;
+            std::vector<uint8_t> ddsFile;
+            CHECK(TextureBaker::BakeRGBA8(pixels.data(), width, height, width * 4, options, ddsFile));
+
+            DDSTextureDesc desc;
+            std::vector<DDSSubresourceLayout> layouts;
+            const uint8_t* bits = Parse(ddsFile, desc, layouts);
+            CHECK(bits != nullptr);
+            if (bits == nullptr)
+            {
+                continue;
+            }
+            CHECK_EQ(desc.Format, format);
+            CHECK_EQ(desc.MipCount, MipGenerator::CalcMipCount(width, height));
+
+            const std::vector<MipLevel> mips = MipGenerator::GenerateRGBA8(pixels.data(), width, height, width * 4,
+                TextureBaker::IsSRGBFormat(format));
+            CHECK_EQ(layouts.size(), mips.size());
+            for (size_t i = 0; i < layouts.size() && i < mips.size(); ++i)
+            {
+                CHECK_EQ(layouts[i].NumRows, (mips[i].Height + 3) / 4u);
+                CHECK_EQ(layouts[i].RowPitch, (mips[i].Width + 3) / 4u * BCEncoder::BlockByteSize(format));
+
+                std::vector<uint8_t> blocks;
+                CHECK(BCEncoder::CompressImage(mips[i], format, blocks));
+                CHECK_EQ(layouts[i].SlicePitch, blocks.size());
+                CHECK(std::equal(blocks.begin(), blocks.end(), bits + layouts[i].Offset));
+            }
+        }
+    }
+
+    void TestOptions()
+    {
+        const std::vector<uint8_t> pixels = MakeImage(16, 16);
+        TextureBakeOptions options;
+        options.Format = DXGI_FORMAT_BC1_UNORM;
+        options.GenerateMips = false;
+        std::vector<uint8_t> ddsFile;
+        CHECK(TextureBaker::BakeRGBA8(pixels.data(), 16, 16, 64, options, ddsFile));
+        DDSTextureDesc desc;
+        std::vector<DDSSubresourceLayout> layouts;
+        CHECK(Parse(ddsFile, desc, layouts) != nullptr);
+        CHECK_EQ(desc.MipCount, 1u);
+        CHECK_EQ(layouts.size(), 1u);
+
+        //既不是BC格式也不是RGBA8时失败
+        options.Format = DXGI_FORMAT_R16G16B16A16_FLOAT;
+        CHECK(!TextureBaker::BakeRGBA8(pixels.data(), 16, 16, 64, options, ddsFile));
+    }
+}
+
+int main()
+{
+    TestUncompressed();
+    TestCompressed();
+    TestOptions();
+    return TestResult();
+}
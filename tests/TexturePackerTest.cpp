@@ -0,0 +1,255 @@
+//TexturePacker：尺寸相同的纹理合并为纹理数组、其余的打包为带保护边的小图集，纹理坐标的重映射、
+//不参与打包的输入，以及重映射表的保存与读取
+
+#include <cmath>
+#include "DDSFormat.h"
+#include "DDSWriter.h"
+#include "TexturePacker.h"
+#include "TestCheck.h"
+
+namespace
+{
+    //每个像素由纹理编号与坐标决定，便于在打包结果中核对
+    uint8_t PixelValue(uint32_t id, uint32_t x, uint32_t y, uint32_t c)
+    {
+        return (uint8_t)(id * 64 + y * 8 + x + c * 3);
+    }
+
+    TexturePackInput MakeInput(const char* name, uint32_t id, uint32_t width, uint32_t height,
+                               DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM)
+    {
+        std::vector<std::vector<uint8_t>> subresources(1);
+        if (format == DXGI_FORMAT_R8G8B8A8_UNORM)
+        {
+            subresources[0].resize(width * height * 4);
+            for (uint32_t y = 0; y < height; ++y)
+            {
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    for (uint32_t c = 0; c < 4; ++c)
+                    {
+                        subresources[0][(y * width + x) * 4 + c] = PixelValue(id, x, y, c);
+                    }
+                }
+            }
+        }
+        else
+        {
+            size_t numBytes = 0;
+            DDSFormat::GetSurfaceInfo(width, height, format, &numBytes, nullptr, nullptr);
+            subresources[0].assign(numBytes, (uint8_t)id);
+        }
+
+        TexturePackInput input;
+        input.Name = name;
+        CHECK(DDSWriter::WriteTexture2D(format, width, height, 1, 1, subresources, input.DdsFile));
+        return input;
+    }
+
+    const uint8_t* Parse(const std::vector<uint8_t>& ddsFile, DDSTextureDesc& desc, std::vector<DDSSubresourceLayout>& layouts)
+    {
+        const DDS_HEADER* header = nullptr;
+        size_t bitOffset = 0;
+        if (!DDSFormat::ParseHeader(ddsFile.data(), ddsFile.size(), &header, &bitOffset) ||
+            DDSFormat::GetTextureDesc(header, desc) != DDSParseResult::Ok ||
+            !DDSFormat::ComputeLayout(desc, ddsFile.size() - bitOffset, layouts))
+        {
+            return nullptr;
+        }
+        return ddsFile.data() + bitOffset;
+    }
+
+    bool Near(float a, float b)
+    {
+        return std::fabs(a - b) < 1e-6f;
+    }
+
+    //三张8x8的纹理成为一个纹理数组，切片依次排列，每个切片与原纹理逐字节相同
+    void TestArray()
+    {
+        std::vector<TexturePackInput> inputs;
+        inputs.push_back(MakeInput("a", 0, 8, 8));
+        inputs.push_back(MakeInput("b", 1, 8, 8));
+        inputs.push_back(MakeInput("c", 2, 8, 8));
+
+        std::vector<TexturePackPage> pages;
+        std::vector<TexturePackRemap> remap;
+        CHECK(TexturePacker::Pack(inputs, TexturePackOptions(), pages, remap));
+        CHECK_EQ(pages.size(), 1u);
+        CHECK_EQ(remap.size(), 3u);
+        if (pages.size() != 1 || remap.size() != 3)
+        {
+            return;
+        }
+        CHECK(!pages[0].IsAtlas);
+        CHECK_EQ(pages[0].ArraySize, 3u);
+
+        DDSTextureDesc desc;
+        std::vector<DDSSubresourceLayout> layouts;
+        const uint8_t* bits = Parse(pages[0].DdsFile, desc, layouts);
+        CHECK(bits != nullptr);
+        if (bits == nullptr)
+        {
+            return;
+        }
+        CHECK_EQ(desc.ArraySize, 3u);
+        CHECK_EQ(desc.Width, 8u);
+        CHECK_EQ(layouts.size(), 3u);
+        for (uint32_t slice = 0; slice < 3; ++slice)
+        {
+            CHECK_EQ(remap[slice].Page, 0);
+            CHECK_EQ(remap[slice].Slice, slice);
+            CHECK(Near(remap[slice].Scale.x, 1.0f) && Near(remap[slice].Offset.x, 0.0f));
+            const uint8_t* pixels = bits + layouts[slice].Offset;
+            CHECK_EQ(pixels[(3 * 8 + 5) * 4 + 1], PixelValue(slice, 5, 3, 1));
+        }
+    }
+
+    //尺寸不同的两张纹理放入一张图集：8x8与4x4的槽位加上4像素的保护边并排放在同一行
+    void TestAtlas()
+    {
+        std::vector<TexturePackInput> inputs;
+        inputs.push_back(MakeInput("small", 1, 4, 4));
+        inputs.push_back(MakeInput("large", 2, 8, 8));
+
+        TexturePackOptions options;
+        options.Padding = 4;
+        std::vector<TexturePackPage> pages;
+        std::vector<TexturePackRemap> remap;
+        CHECK(TexturePacker::Pack(inputs, options, pages, remap));
+        CHECK_EQ(pages.size(), 1u);
+        if (pages.size() != 1)
+        {
+            return;
+        }
+        const TexturePackPage& page = pages[0];
+        CHECK(page.IsAtlas);
+        CHECK_EQ(page.MipCount, 1u);
+        //按高度排序，大的在前：large占[0, 16)，small占[16, 28)
+        CHECK_EQ(page.Width, 28u);
+        CHECK_EQ(page.Height, 16u);
+
+        const TexturePackRemap& small = remap[0];
+        const TexturePackRemap& large = remap[1];
+        CHECK_EQ(small.Page, 0);
+        CHECK_EQ(large.Page, 0);
+        CHECK(Near(large.Scale.x, 8.0f / 28) && Near(large.Scale.y, 8.0f / 16));
+        CHECK(Near(large.Offset.x, 4.0f / 28) && Near(large.Offset.y, 4.0f / 16));
+        CHECK(Near(small.Scale.x, 4.0f / 28) && Near(small.Scale.y, 4.0f / 16));
+        CHECK(Near(small.Offset.x, 20.0f / 28) && Near(small.Offset.y, 4.0f / 16));
+
+        DDSTextureDesc desc;
+        std::vector<DDSSubresourceLayout> layouts;
+        const uint8_t* bits = Parse(page.DdsFile, desc, layouts);
+        CHECK(bits != nullptr);
+        if (bits == nullptr)
+        {
+            return;
+        }
+        CHECK_EQ(desc.Width, 28u);
+        CHECK_EQ(desc.Height, 16u);
+        auto atlas = [&](uint32_t x, uint32_t y, uint32_t c) { return bits[(y * 28 + x) * 4 + c]; };
+
+        //内容按重映射的偏移放置
+        for (uint32_t y = 0; y < 8; ++y)
+        {
+            for (uint32_t x = 0; x < 8; ++x)
+            {
+                CHECK_EQ(atlas(4 + x, 4 + y, 0), PixelValue(2, x, y, 0));
+            }
+        }
+        for (uint32_t y = 0; y < 4; ++y)
+        {
+            for (uint32_t x = 0; x < 4; ++x)
+            {
+                CHECK_EQ(atlas(20 + x, 4 + y, 2), PixelValue(1, x, y, 2));
+            }
+        }
+
+        //保护边复制最近的边缘像素，四角复制角上的像素
+        CHECK_EQ(atlas(0, 7, 0), PixelValue(2, 0, 3, 0));
+        CHECK_EQ(atlas(15, 7, 0), PixelValue(2, 7, 3, 0));
+        CHECK_EQ(atlas(9, 0, 0), PixelValue(2, 5, 0, 0));
+        CHECK_EQ(atlas(9, 15, 0), PixelValue(2, 5, 7, 0));
+        CHECK_EQ(atlas(0, 0, 1), PixelValue(2, 0, 0, 1));
+        CHECK_EQ(atlas(27, 11, 1), PixelValue(1, 3, 3, 1));
+
+        //small的槽位只有12行高，下面未使用的部分为0
+        CHECK_EQ(atlas(20, 13, 0), 0u);
+    }
+
+    //过大的纹理、无法解析的数据以及同一格式只有一张的纹理都不打包，页为-1
+    void TestUnpacked()
+    {
+        std::vector<TexturePackInput> inputs;
+        inputs.push_back(MakeInput("huge", 0, 512, 4));
+        inputs.push_back(MakeInput("lonely", 1, 8, 8, DXGI_FORMAT_BC1_UNORM));
+        TexturePackInput broken;
+        broken.Name = "broken";
+        broken.DdsFile.assign(64, 0xab);
+        inputs.push_back(broken);
+        inputs.push_back(MakeInput("x", 2, 4, 4));
+        inputs.push_back(MakeInput("y", 3, 8, 4));
+
+        std::vector<TexturePackPage> pages;
+        std::vector<TexturePackRemap> remap;
+        CHECK(TexturePacker::Pack(inputs, TexturePackOptions(), pages, remap));
+        CHECK_EQ(remap.size(), inputs.size());
+        CHECK_EQ(pages.size(), 1u);
+        CHECK_EQ(remap[0].Page, -1);
+        CHECK_EQ(remap[1].Page, -1);
+        CHECK_EQ(remap[2].Page, -1);
+        CHECK_EQ(remap[3].Page, 0);
+        CHECK_EQ(remap[4].Page, 0);
+
+        //没有输入时没有页
+        CHECK(TexturePacker::Pack(std::vector<TexturePackInput>(), TexturePackOptions(), pages, remap));
+        CHECK(pages.empty() && remap.empty());
+    }
+
+    void TestRemapTable()
+    {
+        std::vector<TexturePackInput> inputs(2);
+        inputs[0].Name = "textures/brick.dds";
+        inputs[1].Name = "textures/grass.dds";
+        std::vector<TexturePackRemap> remap(2);
+        remap[0].Page = 3;
+        remap[0].Slice = 7;
+        remap[1].Scale = DirectX::XMFLOAT2(0.25f, 0.125f);
+        remap[1].Offset = DirectX::XMFLOAT2(0.5f, 1.0f / 3);
+
+        const std::wstring path = L"TexturePackerTest_remap.txt";
+        CHECK(TexturePacker::SaveRemapTable(path, inputs, remap));
+        std::vector<std::string> names;
+        std::vector<TexturePackRemap> loaded;
+        CHECK(TexturePacker::LoadRemapTable(path, names, loaded));
+        CHECK_EQ(names.size(), 2u);
+        CHECK_EQ(loaded.size(), 2u);
+        if (loaded.size() != 2 || names.size() != 2)
+        {
+            return;
+        }
+        CHECK(names[0] == inputs[0].Name && names[1] == inputs[1].Name);
+        CHECK_EQ(loaded[0].Page, 3);
+        CHECK_EQ(loaded[0].Slice, 7u);
+        CHECK_EQ(loaded[1].Page, -1);
+        CHECK(Near(loaded[1].Scale.y, 0.125f) && Near(loaded[1].Offset.y, 1.0f / 3));
+
+        //数量不一致时不保存
+        remap.pop_back();
+        CHECK(!TexturePacker::SaveRemapTable(path, inputs, remap));
+
+        const DirectX::XMFLOAT4X4 m = TexturePacker::MakeUVTransform(loaded[1]);
+        CHECK(Near(m._11, 0.25f) && Near(m._22, 0.125f) && Near(m._41, 0.5f) && Near(m._42, 1.0f / 3));
+        CHECK(Near(m._33, 1.0f) && Near(m._44, 1.0f) && Near(m._12, 0.0f));
+    }
+}
+
+int main()
+{
+    TestArray();
+    TestAtlas();
+    TestUnpacked();
+    TestRemapTable();
+    return TestResult();
+}
@@ -0,0 +1,200 @@
+//TransferScheduler：复制队列与graphics队列都使用空后端，检查只在第一次使用尚未完成的传输时等待、多个资源合并为一次等待，
+//以及FencedPool按fence回收和多线程提交
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "NullRenderBackend.h"
+#include "TestCheck.h"
+#include "TransferScheduler.h"
+
+namespace
+{
+    typedef TransferScheduler::ResourceId ResourceId;
+
+    //与CopyQueue相同的提交流程：在复制队列上录制并执行复制，Signal之后登记目标资源；
+    //graphics队列使用资源前调用AcquireForUse，需要时在GPU端Wait
+    struct FakeQueues
+    {
+        explicit FakeQueues(uint64_t fenceLatencyNs) :
+            Device(MakeConfig(fenceLatencyNs)),
+            CopyQueue(Device.CreateQueue(RenderQueueType::Copy)),
+            DirectQueue(Device.CreateQueue(RenderQueueType::Direct)),
+            CopyList(Device.CreateCommandList(RenderQueueType::Copy)),
+            DirectList(Device.CreateCommandList(RenderQueueType::Direct)),
+            CopyFence(Device.CreateFence(0))
+        {
+        }
+
+        static NullRenderConfig MakeConfig(uint64_t fenceLatencyNs)
+        {
+            NullRenderConfig config;
+            config.FenceLatencyNs = fenceLatencyNs;
+            return config;
+        }
+
+        uint64_t Submit(std::vector<ResourceId> targets)
+        {
+            CopyList->Reset(0);
+            for (ResourceId target : targets)
+            {
+                CopyList->CopyBufferRegion(target, 0, 1, 0, 256);
+            }
+            CopyList->Close();
+            IRenderCommandList* lists[] = { CopyList.get() };
+            CopyQueue->ExecuteCommandLists(1, lists);
+            CopyQueue->Signal(*CopyFence, ++SubmittedValue);
+            Scheduler.OnSubmitted(SubmittedValue, targets.data(), targets.size());
+            return SubmittedValue;
+        }
+
+        //返回本次使用前等待的fence值，0表示没有等待
+        uint64_t Use(std::vector<ResourceId> resources)
+        {
+            const uint64_t wait = Scheduler.AcquireForUse(resources.data(), resources.size(), CopyFence->GetCompletedValue());
+            if (wait != 0)
+            {
+                DirectQueue->Wait(*CopyFence, wait);
+            }
+            DirectList->Reset(0);
+            DirectList->DrawInstanced(3, 1, 0, 0);
+            DirectList->Close();
+            IRenderCommandList* lists[] = { DirectList.get() };
+            DirectQueue->ExecuteCommandLists(1, lists);
+            return wait;
+        }
+
+        NullRenderDevice Device;
+        std::unique_ptr<IRenderQueue> CopyQueue;
+        std::unique_ptr<IRenderQueue> DirectQueue;
+        std::unique_ptr<IRenderCommandList> CopyList;
+        std::unique_ptr<IRenderCommandList> DirectList;
+        std::unique_ptr<IRenderFence> CopyFence;
+        TransferScheduler Scheduler;
+        uint64_t SubmittedValue = 0;
+    };
+
+    void TestFirstUseWaits()
+    {
+        //复制队列的fence在测试期间不会完成，每次需要时都必须在GPU端等待
+        FakeQueues queues(60ull * 1000000000ull);
+        queues.Submit({ 1, 2, 3 });
+        const uint64_t second = queues.Submit({ 4 });
+        CHECK(queues.Scheduler.IsPending(1));
+
+        //没有传输过的资源不需要等待
+        CHECK_EQ(queues.Use({ 7 }), 0u);
+        //多个资源合并为一次等待，等待最大的fence值
+        CHECK_EQ(queues.Use({ 1, 2, 4 }), second);
+        //已经等待过更大的值，3也随之可用
+        CHECK_EQ(queues.Use({ 3 }), 0u);
+        CHECK(!queues.Scheduler.IsPending(3));
+        //之后的帧不再等待
+        CHECK_EQ(queues.Use({ 1, 2, 3, 4 }), 0u);
+
+        //重新上传的资源再次需要等待
+        const uint64_t reupload = queues.Submit({ 1 });
+        CHECK(queues.Scheduler.IsPending(1));
+        CHECK_EQ(queues.Use({ 1 }), reupload);
+
+        CHECK_EQ(queues.Scheduler.GetWaitCount(), 2u);
+        CHECK_EQ(queues.Scheduler.GetWaitedValue(), reupload);
+        const RenderBackendStats stats = queues.Device.GetStats();
+        CHECK_EQ(stats.QueueWaits, 2u);
+        CHECK_EQ(stats.Signals, 3u);
+        CHECK_EQ(stats.BytesCopied, 5u * 256u);
+        CHECK_EQ(stats.CommandListsExecuted, 3u + 5u);
+    }
+
+    void TestCompletedTransfers()
+    {
+        //fence立即完成：CPU端已经看到完成的传输不需要GPU端等待
+        FakeQueues queues(0);
+        queues.Submit({ 5 });
+        queues.CopyFence->WaitForValue(queues.SubmittedValue);
+        CHECK_EQ(queues.Use({ 5 }), 0u);
+        CHECK_EQ(queues.Device.GetStats().QueueWaits, 0u);
+
+        //一直没有被使用的资源在完成后由Trim丢弃
+        const uint64_t first = queues.Submit({ 9 });
+        const uint64_t second = queues.Submit({ 10 });
+        queues.Scheduler.Trim(first);
+        CHECK(!queues.Scheduler.IsPending(9));
+        CHECK(queues.Scheduler.IsPending(10));
+        queues.Scheduler.Trim(second);
+        CHECK(!queues.Scheduler.IsPending(10));
+        CHECK_EQ(queues.Scheduler.GetWaitCount(), 0u);
+    }
+
+    void TestFencedPool()
+    {
+        FencedPool<std::string> pool;
+        pool.Release("a", 1);
+        pool.Release("b", 2);
+        std::string item;
+        CHECK(!pool.Acquire(0, item));
+        CHECK(pool.Acquire(1, item) && item == "a");
+        CHECK(!pool.Acquire(1, item));
+        CHECK_EQ(pool.GetSize(), 1u);
+        pool.Trim(2);
+        CHECK_EQ(pool.GetSize(), 0u);
+    }
+
+    void TestConcurrentSubmit()
+    {
+        //三个流式加载线程提交，使用者同时获取，等待的fence值单调递增
+        TransferScheduler scheduler;
+        std::mutex submitMutex;
+        uint64_t fence = 0;
+        std::atomic<bool> done(false);
+        std::atomic<bool> nonMonotonic(false);
+        std::vector<std::thread> producers;
+        for (int t = 0; t < 3; ++t)
+        {
+            producers.emplace_back([&, t]()
+            {
+                for (int i = 0; i < 2000; ++i)
+                {
+                    const ResourceId id = static_cast<ResourceId>(t * 100000 + i);
+                    std::lock_guard<std::mutex> lock(submitMutex);
+                    scheduler.OnSubmitted(++fence, &id, 1);
+                }
+            });
+        }
+        std::thread consumer([&]()
+        {
+            uint64_t last = 0;
+            while (!done)
+            {
+                for (int t = 0; t < 3; ++t)
+                {
+                    const ResourceId id = static_cast<ResourceId>(t * 100000 + 1999);
+                    const uint64_t wait = scheduler.AcquireForUse(&id, 1, 0);
+                    if (wait != 0)
+                    {
+                        nonMonotonic = nonMonotonic || wait <= last;
+                        last = wait;
+                    }
+                }
+            }
+        });
+        for (std::thread& producer : producers)
+        {
+            producer.join();
+        }
+        done = true;
+        consumer.join();
+        CHECK(!nonMonotonic);
+        CHECK(scheduler.GetWaitedValue() <= 6000u);
+    }
+}
+
+int main()
+{
+    TestFirstUseWaits();
+    TestCompletedTransfers();
+    TestFencedPool();
+    TestConcurrentSubmit();
+    return TestResult();
+}
@@ -0,0 +1,213 @@
+//TransientResourcePlanner：生存期不重叠的资源共用内存、堆按类别分开、aliasing barrier的位置，
+//以及随机的后处理链中生存期重叠的资源在内存上互不重叠
+
+#include <algorithm>
+#include <random>
+#include "TestCheck.h"
+#include "TransientResourcePlanner.h"
+
+namespace
+{
+    //对齐、堆的边界与类别，以及同一个堆中生存期重叠的资源内存不重叠
+    void CheckPlan(const std::vector<TransientResourceDesc>& descs, const TransientMemoryPlan& plan)
+    {
+        CHECK_EQ(plan.Placements.size(), descs.size());
+        uint64_t heapBytes = 0;
+        for (const TransientHeapDesc& heap : plan.Heaps)
+        {
+            heapBytes += heap.Size;
+        }
+        CHECK_EQ(plan.TotalBytes, heapBytes);
+
+        uint32_t overlaps = 0;
+        for (size_t i = 0; i < descs.size() && i < plan.Placements.size(); ++i)
+        {
+            const TransientPlacement& a = plan.Placements[i];
+            if (a.Heap == TransientMemoryPlan::NoHeap)
+            {
+                continue;
+            }
+            CHECK(a.Heap < plan.Heaps.size());
+            CHECK_EQ(a.Offset % descs[i].Alignment, 0u);
+            CHECK(a.Offset + descs[i].Size <= plan.Heaps[a.Heap].Size);
+            CHECK_EQ(plan.Heaps[a.Heap].HeapKind, descs[i].HeapKind);
+            CHECK(plan.Heaps[a.Heap].Alignment >= descs[i].Alignment);
+            for (size_t j = i + 1; j < descs.size(); ++j)
+            {
+                const TransientPlacement& b = plan.Placements[j];
+                if (b.Heap != a.Heap)
+                {
+                    continue;
+                }
+                const bool lifetimes = a.FirstPass <= b.LastPass && b.FirstPass <= a.LastPass;
+                const bool memory = a.Offset < b.Offset + descs[j].Size && b.Offset < a.Offset + descs[i].Size;
+                overlaps += lifetimes && memory ? 1 : 0;
+            }
+        }
+        CHECK_EQ(overlaps, 0u);
+
+        for (size_t i = 0; i < plan.Barriers.size(); ++i)
+        {
+            const TransientAliasingBarrier& barrier = plan.Barriers[i];
+            CHECK(i == 0 || plan.Barriers[i - 1].Pass <= barrier.Pass);
+            //在资源第一次使用的pass之前插入
+            CHECK(barrier.After < plan.Placements.size() && plan.Placements[barrier.After].FirstPass == barrier.Pass);
+        }
+    }
+
+    void TestChain()
+    {
+        //A(pass 0-1)、B(1-2)、C(2-3)大小相同：A与C共用内存
+        TransientResourcePlanner planner;
+        std::vector<TransientResourceDesc> descs(3);
+        for (TransientResourceDesc& desc : descs)
+        {
+            desc.Size = 1 << 20;
+        }
+        const uint32_t a = planner.AddResource(descs[0]);
+        const uint32_t b = planner.AddResource(descs[1]);
+        const uint32_t c = planner.AddResource(descs[2]);
+        const uint32_t pass0[] = { a };
+        const uint32_t pass1[] = { a, b };
+        const uint32_t pass2[] = { b, c };
+        const uint32_t pass3[] = { c };
+        planner.AddPass(pass0, 1);
+        planner.AddPass(pass1, 2);
+        planner.AddPass(pass2, 2);
+        planner.AddPass(pass3, 1);
+        CHECK_EQ(planner.GetResourceCount(), 3u);
+        CHECK_EQ(planner.GetPassCount(), 4u);
+
+        TransientMemoryPlan plan;
+        planner.Build(plan);
+        CheckPlan(descs, plan);
+        CHECK_EQ(plan.TotalBytes, 2u << 20);
+        CHECK_EQ(plan.NaiveBytes, 3u << 20);
+        CHECK_EQ(plan.Placements[a].Offset, plan.Placements[c].Offset);
+        CHECK(plan.Placements[a].FirstPass == 0 && plan.Placements[a].LastPass == 1);
+        CHECK_EQ(plan.Barriers.size(), 1u);
+        if (plan.Barriers.size() == 1)
+        {
+            CHECK_EQ(plan.Barriers[0].Pass, 2u);
+            CHECK_EQ(plan.Barriers[0].Before, a);
+            CHECK_EQ(plan.Barriers[0].After, c);
+        }
+
+        //Clear之后重新开始
+        planner.Clear();
+        CHECK_EQ(planner.GetResourceCount(), 0u);
+        CHECK_EQ(planner.GetPassCount(), 0u);
+        planner.Build(plan);
+        CHECK(plan.Placements.empty() && plan.Heaps.empty() && plan.TotalBytes == 0);
+    }
+
+    void TestHeapKinds()
+    {
+        //不同类别的资源不共用堆，没有被使用的资源不分配
+        TransientResourcePlanner planner;
+        std::vector<TransientResourceDesc> descs(3);
+        for (TransientResourceDesc& desc : descs)
+        {
+            desc.Size = 1000;
+            desc.Alignment = 256;
+        }
+        descs[1].HeapKind = 1;
+        descs[2].HeapKind = 1;
+        for (const TransientResourceDesc& desc : descs)
+        {
+            planner.AddResource(desc);
+        }
+        const uint32_t pass0[] = { 0 };
+        const uint32_t pass1[] = { 1 };
+        planner.AddPass(pass0, 1);
+        planner.AddPass(pass1, 1);
+
+        TransientMemoryPlan plan;
+        planner.Build(plan);
+        CheckPlan(descs, plan);
+        CHECK_EQ(plan.Heaps.size(), 2u);
+        CHECK_EQ(plan.Placements[2].Heap, TransientMemoryPlan::NoHeap);
+        CHECK(plan.Placements[0].Heap != plan.Placements[1].Heap);
+        CHECK(plan.Barriers.empty());
+    }
+
+    void TestMultipleBefore()
+    {
+        //两个小资源先后用完，大资源覆盖两者的内存：前一个占用者不唯一
+        TransientResourcePlanner planner;
+        std::vector<TransientResourceDesc> descs(3);
+        descs[0].Size = 65536;
+        descs[1].Size = 65536;
+        descs[2].Size = 2 * 65536;
+        for (const TransientResourceDesc& desc : descs)
+        {
+            planner.AddResource(desc);
+        }
+        const uint32_t pass0[] = { 0, 1 };
+        const uint32_t pass1[] = { 2 };
+        planner.AddPass(pass0, 2);
+        planner.AddPass(pass1, 1);
+
+        TransientMemoryPlan plan;
+        planner.Build(plan);
+        CheckPlan(descs, plan);
+        CHECK_EQ(plan.TotalBytes, 2u * 65536u);
+        CHECK_EQ(plan.Barriers.size(), 1u);
+        if (plan.Barriers.size() == 1)
+        {
+            CHECK_EQ(plan.Barriers[0].Before, TransientAliasingBarrier::AnyResource);
+            CHECK_EQ(plan.Barriers[0].After, 2u);
+        }
+    }
+
+    void TestRandomChains()
+    {
+        std::mt19937 rng(49);
+        for (int round = 0; round < 50; ++round)
+        {
+            const uint32_t passCount = 4 + rng() % 60;
+            const uint32_t resourceCount = 1 + rng() % 100;
+            TransientResourcePlanner planner;
+            std::vector<TransientResourceDesc> descs;
+            std::vector<std::vector<uint32_t>> passes(passCount);
+            for (uint32_t r = 0; r < resourceCount; ++r)
+            {
+                TransientResourceDesc desc;
+                desc.Alignment = rng() % 2 ? 65536 : 4 << 20;
+                desc.Size = (1 + rng() % 64) * 65536;
+                desc.HeapKind = rng() % 3;
+                descs.push_back(desc);
+                planner.AddResource(desc);
+
+                //少量资源不被任何pass使用
+                if (rng() % 10 == 0)
+                {
+                    continue;
+                }
+                const uint32_t first = rng() % passCount;
+                const uint32_t last = std::min(passCount - 1, first + static_cast<uint32_t>(rng() % 6));
+                for (uint32_t p = first; p <= last; ++p)
+                {
+                    passes[p].push_back(r);
+                }
+            }
+            for (const std::vector<uint32_t>& pass : passes)
+            {
+                planner.AddPass(pass.data(), pass.size());
+            }
+
+            TransientMemoryPlan plan;
+            planner.Build(plan);
+            CheckPlan(descs, plan);
+        }
+    }
+}
+
+int main()
+{
+    TestChain();
+    TestHeapKinds();
+    TestMultipleBefore();
+    TestRandomChains();
+    return TestResult();
+}
@@ -0,0 +1,170 @@
+//VertexLayout：由成员指针得到的偏移与格式、流的步长与流内偏移、Split与Interleave互逆，以及Select得到的子布局保持流索引与步长
+
+#include <cstddef>
+#include <cstring>
+#include "VertexLayout.h"
+#include "TestCheck.h"
+
+namespace
+{
+    struct TestVertex
+    {
+        DirectX::XMFLOAT3 Pos;
+        DirectX::XMFLOAT4 Color;
+        DirectX::XMFLOAT2 UV;
+        uint32_t Id;
+    };
+
+    //位置单独一个流，颜色与纹理坐标一个流，Id放在流3(流2不使用)
+    VertexLayout MakeLayout()
+    {
+        return VertexLayout::For<TestVertex>()
+            .Add(&TestVertex::Pos, "POSITION", 0)
+            .Add(&TestVertex::Color, "COLOR", 1)
+            .Add(&TestVertex::UV, "TEXCOORD", 1)
+            .Add(&TestVertex::Id, "TEXCOORD", 3, 1)
+            .Build();
+    }
+
+    std::vector<TestVertex> MakeVertices(size_t count)
+    {
+        std::vector<TestVertex> vertices(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float f = float(i);
+            vertices[i].Pos = DirectX::XMFLOAT3(f, f + 0.5f, -f);
+            vertices[i].Color = DirectX::XMFLOAT4(f * 0.1f, 0.2f, 0.3f, 1.0f);
+            vertices[i].UV = DirectX::XMFLOAT2(f * 0.25f, 1.0f - f * 0.25f);
+            vertices[i].Id = (uint32_t)(1000 + i);
+        }
+        return vertices;
+    }
+
+    void TestDescription()
+    {
+        const VertexLayout layout = MakeLayout();
+        CHECK_EQ(layout.GetSourceStride(), (uint32_t)sizeof(TestVertex));
+        CHECK_EQ(layout.GetStreamCount(), 4u);
+        CHECK_EQ(layout.GetStreamStride(0), 12u);
+        CHECK_EQ(layout.GetStreamStride(1), 24u);
+        CHECK_EQ(layout.GetStreamStride(2), 0u);
+        CHECK_EQ(layout.GetStreamStride(3), 4u);
+        CHECK_EQ(layout.GetStreamStride(4), 0u);
+        CHECK(layout.UsesStream(0) && layout.UsesStream(1) && !layout.UsesStream(2) && layout.UsesStream(3));
+        CHECK_EQ(layout.GetElements().size(), 4u);
+
+        //偏移与offsetof一致
+        const VertexElement* color = layout.FindElement(StringTable::Intern("COLOR"));
+        const VertexElement* uv = layout.FindElement(StringTable::Intern("TEXCOORD"));
+        const VertexElement* id = layout.FindElement(StringTable::Intern("TEXCOORD"), 1);
+        CHECK(color != nullptr && uv != nullptr && id != nullptr);
+        if (color == nullptr || uv == nullptr || id == nullptr)
+        {
+            return;
+        }
+        CHECK_EQ(layout.GetElements()[0].SourceOffset, (uint32_t)offsetof(TestVertex, Pos));
+        CHECK_EQ(color->SourceOffset, (uint32_t)offsetof(TestVertex, Color));
+        CHECK_EQ(uv->SourceOffset, (uint32_t)offsetof(TestVertex, UV));
+        CHECK_EQ(id->SourceOffset, (uint32_t)offsetof(TestVertex, Id));
+
+        CHECK_EQ(color->Format, DXGI_FORMAT_R32G32B32A32_FLOAT);
+        CHECK_EQ(uv->Format, DXGI_FORMAT_R32G32_FLOAT);
+        CHECK_EQ(id->Format, DXGI_FORMAT_R32_UINT);
+        CHECK_EQ(uv->Size, 8u);
+
+        //流内按添加顺序排列
+        CHECK_EQ(color->Stream, 1u);
+        CHECK_EQ(color->StreamOffset, 0u);
+        CHECK_EQ(uv->StreamOffset, 16u);
+        CHECK_EQ(id->Stream, 3u);
+        CHECK_EQ(id->StreamOffset, 0u);
+        CHECK(layout.FindElement(StringTable::Intern("NORMAL")) == nullptr);
+    }
+
+    void TestSplitInterleave()
+    {
+        const VertexLayout layout = MakeLayout();
+        const size_t count = 7;
+        const std::vector<TestVertex> vertices = MakeVertices(count);
+
+        std::vector<std::vector<uint8_t>> streams;
+        layout.Split(vertices.data(), count, streams);
+        CHECK_EQ(streams.size(), 4u);
+        CHECK_EQ(streams[0].size(), 12u * count);
+        CHECK_EQ(streams[1].size(), 24u * count);
+        CHECK(streams[2].empty());
+        CHECK_EQ(streams[3].size(), 4u * count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            CHECK(memcmp(&streams[0][i * 12], &vertices[i].Pos, 12) == 0);
+            CHECK(memcmp(&streams[1][i * 24], &vertices[i].Color, 16) == 0);
+            CHECK(memcmp(&streams[1][i * 24 + 16], &vertices[i].UV, 8) == 0);
+            CHECK(memcmp(&streams[3][i * 4], &vertices[i].Id, 4) == 0);
+        }
+
+        //合并回交错的顶点，每个成员都与原数据相同
+        std::vector<TestVertex> merged(count);
+        const void* streamData[] = { streams[0].data(), streams[1].data(), nullptr, streams[3].data() };
+        layout.Interleave(streamData, count, merged.data());
+        for (size_t i = 0; i < count; ++i)
+        {
+            CHECK(memcmp(&merged[i].Pos, &vertices[i].Pos, sizeof(vertices[i].Pos)) == 0);
+            CHECK(memcmp(&merged[i].Color, &vertices[i].Color, sizeof(vertices[i].Color)) == 0);
+            CHECK(memcmp(&merged[i].UV, &vertices[i].UV, sizeof(vertices[i].UV)) == 0);
+            CHECK_EQ(merged[i].Id, vertices[i].Id);
+        }
+    }
+
+    void TestSelect()
+    {
+        const VertexLayout layout = MakeLayout();
+
+        //只有位置：只剩流0
+        const VertexLayout positionOnly = layout.Select({ "POSITION" });
+        CHECK_EQ(positionOnly.GetStreamCount(), 1u);
+        CHECK_EQ(positionOnly.GetStreamStride(0), 12u);
+        CHECK_EQ(positionOnly.GetElements().size(), 1u);
+        CHECK_EQ(positionOnly.GetSourceStride(), layout.GetSourceStride());
+
+        //只有纹理坐标：流索引与步长不变，前面未使用的流保留步长但不再使用
+        const VertexLayout texcoords = layout.Select({ "TEXCOORD" });
+        CHECK_EQ(texcoords.GetElements().size(), 2u);
+        CHECK_EQ(texcoords.GetStreamCount(), 4u);
+        CHECK(!texcoords.UsesStream(0) && texcoords.UsesStream(1) && texcoords.UsesStream(3));
+        CHECK_EQ(texcoords.GetStreamStride(0), 12u);
+        CHECK_EQ(texcoords.GetStreamStride(1), 24u);
+        const VertexElement* uv = texcoords.FindElement(StringTable::Intern("TEXCOORD"));
+        CHECK(uv != nullptr && uv->Stream == 1 && uv->StreamOffset == 16);
+
+        //子布局拆分出的缓冲区与完整布局的布局相同，未选中的部分为0
+        const size_t count = 3;
+        const std::vector<TestVertex> vertices = MakeVertices(count);
+        std::vector<std::vector<uint8_t>> streams;
+        texcoords.Split(vertices.data(), count, streams);
+        CHECK_EQ(streams[1].size(), 24u * count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            CHECK(memcmp(&streams[1][i * 24 + 16], &vertices[i].UV, 8) == 0);
+            for (size_t b = 0; b < 16; ++b)
+            {
+                CHECK_EQ(streams[1][i * 24 + b], 0u);
+            }
+        }
+        for (uint8_t byte : streams[0])
+        {
+            CHECK_EQ(byte, 0u);
+        }
+
+        CHECK(layout.Select({ "NORMAL" }).GetElements().empty());
+        CHECK_EQ(layout.Select({ "NORMAL" }).GetStreamCount(), 0u);
+    }
+}
+
+int main()
+{
+    TestDescription();
+    TestSplitInterleave();
+    TestSelect();
+    return TestResult();
+}
@@ -0,0 +1,100 @@
+//把一组DDS纹理打包为纹理数组与图集：TexturePackTool <输出目录> <输入.dds>...
+//每一页写为输出目录中的page<序号>.dds，重映射表写为remap.txt，名字为命令行中给出的输入路径
+
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "FileUtil.h"
+#include "TexturePacker.h"
+
+namespace
+{
+    int Run(const std::vector<std::wstring>& args)
+    {
+        if (args.size() < 2)
+        {
+            fprintf(stderr, "usage: TexturePackTool <output-dir> <input.dds>...\n");
+            return 2;
+        }
+
+        const std::wstring outputDir = args[0];
+        std::vector<TexturePackInput> inputs(args.size() - 1);
+        for (size_t i = 0; i < inputs.size(); ++i)
+        {
+            inputs[i].Name = FileUtil::ToUtf8(args[i + 1]);
+            if (!FileUtil::ReadAllBytes(args[i + 1], inputs[i].DdsFile))
+            {
+                fprintf(stderr, "cannot read %s\n", inputs[i].Name.c_str());
+                return 1;
+            }
+        }
+
+        std::vector<TexturePackPage> pages;
+        std::vector<TexturePackRemap> remap;
+        if (!TexturePacker::Pack(inputs, TexturePackOptions(), pages, remap))
+        {
+            fprintf(stderr, "packing failed\n");
+            return 1;
+        }
+
+        if (!FileUtil::EnsureDirectory(outputDir))
+        {
+            fprintf(stderr, "cannot create %s\n", FileUtil::ToUtf8(outputDir).c_str());
+            return 1;
+        }
+        for (size_t i = 0; i < pages.size(); ++i)
+        {
+            const std::wstring path = outputDir + L"/page" + std::to_wstring(i) + L".dds";
+            if (!FileUtil::WriteAllBytes(path, pages[i].DdsFile.data(), pages[i].DdsFile.size()))
+            {
+                fprintf(stderr, "cannot write %s\n", FileUtil::ToUtf8(path).c_str());
+                return 1;
+            }
+            printf("page%zu.dds: %s %ux%u, %u slices, %u mips\n", i, pages[i].IsAtlas ? "atlas" : "array",
+                pages[i].Width, pages[i].Height, pages[i].ArraySize, pages[i].MipCount);
+        }
+        if (!TexturePacker::SaveRemapTable(outputDir + L"/remap.txt", inputs, remap))
+        {
+            fprintf(stderr, "cannot write remap.txt\n");
+            return 1;
+        }
+
+        size_t unpacked = 0;
+        for (const TexturePackRemap& r : remap)
+        {
+            unpacked += r.Page < 0 ? 1 : 0;
+        }
+        printf("%zu textures packed into %zu pages, %zu left unpacked\n", inputs.size() - unpacked, pages.size(), unpacked);
+        return 0;
+    }
+}
+
+#if defined(_WIN32)
+int wmain(int argc, wchar_t** argv)
+{
+    return Run(std::vector<std::wstring>(argv + 1, argv + argc));
+}
+#else
+int main(int argc, char** argv)
+{
+    //命令行参数按当前locale的多字节编码转换为宽字符串
+    setlocale(LC_ALL, "");
+    std::vector<std::wstring> args;
+    for (int i = 1; i < argc; ++i)
+    {
+        const size_t length = mbstowcs(nullptr, argv[i], 0);
+        if (length == size_t(-1))
+        {
+            fprintf(stderr, "invalid argument encoding: %s\n", argv[i]);
+            return 2;
+        }
+        std::wstring arg(length + 1, L'\0');
+        mbstowcs(&arg[0], argv[i], arg.size());
+        arg.resize(length);
+        args.push_back(arg);
+    }
+    return Run(args);
+}
+#endif